@@ -37,6 +37,9 @@
 #include "itkAdvancedCombinationTransform.h"
 
 #include "itkPlatformMultiThreader.h"
+#include "itkHotPathProfiler.h"
+
+#include <vector>
 
 namespace itk
 {
@@ -144,6 +147,7 @@ public:
   typedef typename ImageSamplerType::Pointer                      ImageSamplerPointer;
   typedef typename ImageSamplerType::OutputVectorContainerType    ImageSampleContainerType;
   typedef typename ImageSamplerType::OutputVectorContainerPointer ImageSampleContainerPointer;
+  typedef typename ImageSamplerType::ImageSampleGridType          ImageSampleGridType;
 
   /** Typedefs for Limiter support. */
   typedef LimiterFunctionBase< RealType, FixedImageDimension >  FixedImageLimiterType;
@@ -167,6 +171,7 @@ public:
   typedef typename BSplineOrder1TransformType::Pointer                             BSplineOrder1TransformPointer;
   typedef typename BSplineOrder2TransformType::Pointer                             BSplineOrder2TransformPointer;
   typedef typename BSplineOrder3TransformType::Pointer                             BSplineOrder3TransformPointer;
+  typedef AdvancedBSplineDeformableTransformBase< ScalarType, FixedImageDimension > BSplineTransformBaseType;
 
   /** Hessian type; for SelfHessian (experimental feature) */
   typedef typename DerivativeType::ValueType    HessianValueType;
@@ -254,6 +259,49 @@ public:
   itkSetMacro( MovingImageDerivativeScales, MovingImageDerivativeScalesType );
   itkGetConstReferenceMacro( MovingImageDerivativeScales, MovingImageDerivativeScalesType );
 
+  /** Select a memory-lean model of the moving image. When set, a B-spline
+   * interpolator with double coefficients is replaced by an equivalent one
+   * that stores its coefficients in float, and no gradient image is
+   * precomputed. For interpolators that do not provide derivatives, the
+   * central difference gradient is then evaluated on the fly.
+   * Default: false.
+   */
+  itkSetMacro( UseReducedMemoryImageModel, bool );
+  itkGetConstMacro( UseReducedMemoryImageModel, bool );
+  itkBooleanMacro( UseReducedMemoryImageModel );
+
+  /** Select lazy image sampling. When set, and both the metric and the image
+   * sampler support it, the full and grid samplers do not store the samples,
+   * but only describe the sample grid, over which the metric iterates
+   * directly. Default: false.
+   */
+  itkSetMacro( UseLazyImageSampling, bool );
+  itkGetConstMacro( UseLazyImageSampling, bool );
+  itkBooleanMacro( UseLazyImageSampling );
+
+  /** Returns true if UseLazyImageSampling is set, and the metric can iterate
+   * over the sample grid of the image sampler. An image sampler that is shared
+   * by several metrics should only use lazy sampling when this holds for all
+   * of them, see CombinationImageToImageMetric::Initialize().
+   */
+  virtual bool CanUseLazyImageSampling( void ) const
+  {
+    return this->m_UseLazyImageSampling && this->SupportsLazyImageSampling();
+  }
+
+
+  /** Select the B-spline sample weights cache. When set, and the transform
+   * is a B-spline transform that supports it, the interpolation weights and
+   * the support region offsets of the fixed image samples are stored once
+   * the same samples are used in two consecutive iterations. Afterwards,
+   * transforming a sample and computing its Jacobian only gather the
+   * coefficients. The cache costs ( SplineOrder + 1 ) * FixedImageDimension
+   * doubles and one offset per sample. Default: false.
+   */
+  itkSetMacro( UseBSplineSampleWeightsCache, bool );
+  itkGetConstMacro( UseBSplineSampleWeightsCache, bool );
+  itkBooleanMacro( UseBSplineSampleWeightsCache );
+
   /** Initialize the Metric by making sure that all the components
    *  are present and plugged together correctly.
    * \li Call the superclass' implementation
@@ -353,6 +401,10 @@ protected:
 
   CentralDifferenceGradientFilterPointer m_CentralDifferenceGradientFilter;
 
+  /** The float B-spline interpolator that replaces a double one when
+   * UseReducedMemoryImageModel is set. It is kept over the resolutions. */
+  BSplineInterpolatorFloatPointer m_ReducedMemoryBSplineInterpolator;
+
   /** Variables to store the AdvancedTransform. */
   bool m_TransformIsAdvanced;
   typename AdvancedTransformType::Pointer m_AdvancedTransform;
@@ -465,10 +517,38 @@ protected:
   /** Initialize variables related to the image sampler; called by Initialize. */
   virtual void InitializeImageSampler( void );
 
+  /** Give the image sampler the control point grid of a B-spline transform,
+   * by which it can sort its samples; called by Initialize.
+   */
+  virtual void InitializeImageSamplerOrderGrid( void );
+
   /** Inheriting classes can specify whether they use the image sampler functionality
    * Make sure to set it before calling Initialize; default: false. */
   itkSetMacro( UseImageSampler, bool );
 
+  /** Inheriting classes that can iterate over an ImageSampleGrid, instead of
+   * over the sample container, return true here; default: false. */
+  virtual bool SupportsLazyImageSampling( void ) const
+  {
+    return false;
+  }
+
+
+  /** Returns true if the fixed image samples of the current update are only
+   * described by the sample grid of the image sampler. */
+  virtual bool IsImageSampleGridUsed( void ) const
+  {
+    return this->m_UseImageSampler && this->GetImageSampler()->IsLazySamplingUsed();
+  }
+
+
+  /** The number of fixed image samples, to be used in CheckNumberOfSamples. */
+  virtual SizeValueType GetNumberOfFixedImageSamples( void ) const;
+
+  /** The number of positions to iterate over: the size of the sample container
+   * or the number of points of the sample grid, including points outside the mask. */
+  virtual SizeValueType GetNumberOfFixedImageSamplePositions( void ) const;
+
   /** Check if enough samples have been found to compute a reliable
    * estimate of the value/derivative; throws an exception if not. */
   virtual void CheckNumberOfSamples(
@@ -476,10 +556,28 @@ protected:
 
   /** Methods for image derivative evaluation support **********/
 
+  /** Replace a double B-spline interpolator by a float one, when the
+   * reduced memory image model is selected; called by Initialize,
+   * before the interpolator gets its input image. */
+  virtual void InitializeReducedMemoryImageModel( void );
+
   /** Initialize variables for image derivative computation; this
    * method is called by Initialize. */
   virtual void CheckForBSplineInterpolator( void );
 
+  /** Print the memory footprint of the precomputed moving image buffers,
+   * i.e. B-spline coefficients and gradient image; called by Initialize. */
+  virtual void PrintPrecomputedBufferMemory( void ) const;
+
+  /** Compute the central difference gradient of the moving image at the
+   * given index, without a precomputed gradient image. Used by the reduced
+   * memory image model. The result is identical to the gradient computed by
+   * the CentralDifferenceGradientFilterType.
+   */
+  virtual void EvaluateMovingImageCentralDifference(
+    const MovingImageIndexType & index,
+    MovingImageDerivativeType & gradient ) const;
+
   /** Compute the image value (and possibly derivative) at a transformed point.
    * Checks if the point lies within the moving image buffer (bool return).
    * If no gradient is wanted, set the gradient argument to 0.
@@ -532,6 +630,80 @@ protected:
     TransformJacobianType & jacobian,
     NonZeroJacobianIndicesType & nzji ) const;
 
+  /** Methods for the B-spline sample weights cache **********/
+
+  /** Check if the fixed image samples and the B-spline grid are the same as
+   * in the previous iteration, and (re)compute the sample weights cache if
+   * needed. Called by BeforeThreadedGetValueAndDerivative, after the image
+   * sampler has been updated.
+   */
+  virtual void UpdateBSplineSampleWeightsCache( void ) const;
+
+  /** Release the memory of the B-spline sample weights cache. */
+  virtual void ClearBSplineSampleWeightsCache( void ) const;
+
+  /** The position of the sample an iterator points to, in the sample
+   * container or in the sample grid. */
+  static SizeValueType GetSamplePosition(
+    const typename ImageSampleContainerType::ConstIterator & iter )
+  {
+    return iter.Index();
+  }
+
+
+  static SizeValueType GetSamplePosition(
+    const typename ImageSampleGridType::ConstIterator & iter )
+  {
+    return iter.GetPosition();
+  }
+
+
+  /** Variants of TransformPoint(), EvaluateTransformJacobian(), and the
+   * transform's EvaluateJacobianWithImageGradientProduct() for the fixed
+   * image sample at the given position. They use the B-spline sample
+   * weights cache when it is valid in the current iteration.
+   */
+  bool TransformSamplePoint(
+    const SizeValueType samplePosition,
+    const FixedImagePointType & fixedImagePoint,
+    MovingImagePointType & mappedPoint ) const;
+
+  bool EvaluateSampleTransformJacobian(
+    const SizeValueType samplePosition,
+    const FixedImagePointType & fixedImagePoint,
+    TransformJacobianType & jacobian,
+    NonZeroJacobianIndicesType & nzji ) const;
+
+  void EvaluateSampleJacobianWithImageGradientProduct(
+    const SizeValueType samplePosition,
+    const FixedImagePointType & fixedImagePoint,
+    const MovingImageDerivativeType & movingImageDerivative,
+    DerivativeType & imageJacobian,
+    NonZeroJacobianIndicesType & nzji ) const;
+
+  /** The B-spline sample weights cache, in a structure-of-arrays layout:
+   * the 1D interpolation weights of all sample positions, and the offsets of
+   * their support regions, where a negative offset marks a sample outside
+   * the valid region of the grid. The key members describe the samples and
+   * the grid for which the cache was computed. st_Transform is only set when
+   * the cache is valid in the current iteration.
+   */
+  typedef typename BSplineTransformBaseType::FixedParametersType BSplineGridParametersType;
+  struct BSplineSampleWeightsCacheType
+  {
+    const BSplineTransformBaseType * st_Transform;
+    unsigned int                     st_NumberOfWeights;
+    std::vector< double >            st_Weights;
+    std::vector< OffsetValueType >   st_Offsets;
+    const void *                     st_KeyTransform;
+    const void *                     st_KeySampler;
+    ModifiedTimeType                 st_KeySamplerMTime;
+    SizeValueType                    st_KeyNumberOfSamplePositions;
+    bool                             st_KeyUseSampleGrid;
+    BSplineGridParametersType        st_KeyGridParameters;
+  };
+  mutable BSplineSampleWeightsCacheType m_BSplineSampleWeightsCache;
+
   /** Convenience method: check if point is inside the moving mask. *****************/
   virtual bool IsInsideMovingMask( const MovingImagePointType & point ) const;
 
@@ -559,6 +731,9 @@ private:
   double m_RequiredRatioOfValidSamples;
   bool   m_UseMovingImageDerivativeScales;
   bool   m_ScaleGradientWithRespectToMovingImageOrientation;
+  bool   m_UseReducedMemoryImageModel;
+  bool   m_UseLazyImageSampling;
+  bool   m_UseBSplineSampleWeightsCache;
 
   MovingImageDerivativeScalesType m_MovingImageDerivativeScales;
 
@@ -61,10 +61,16 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
   this->m_InterpolatorIsBSplineFloat      = false;
   this->m_InterpolatorIsReducedBSpline    = false;
   this->m_CentralDifferenceGradientFilter = 0;
+  this->m_ReducedMemoryBSplineInterpolator = 0;
+  this->m_UseReducedMemoryImageModel       = false;
+  this->m_UseLazyImageSampling             = false;
+  this->m_UseBSplineSampleWeightsCache     = false;
 
   this->m_AdvancedTransform                                = 0;
   this->m_TransformIsAdvanced                              = false;
   this->m_TransformIsBSpline                               = false;
+  this->m_BSplineSampleWeightsCache.st_Transform           = nullptr;
+  this->m_BSplineSampleWeightsCache.st_NumberOfWeights     = 0;
   this->m_UseMovingImageDerivativeScales                   = false;
   this->m_ScaleGradientWithRespectToMovingImageOrientation = false;
   this->m_MovingImageDerivativeScales.Fill( 1.0 );
@@ -152,6 +158,9 @@ void
 AdvancedImageToImageMetric< TFixedImage, TMovingImage >
 ::Initialize( void )
 {
+  /** Possibly replace the interpolator, before it is initialized. */
+  this->InitializeReducedMemoryImageModel();
+
   /** Initialize transform, interpolator, etc. */
   Superclass::Initialize();
 
@@ -164,12 +173,21 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
   /** Check if the interpolator is a B-spline interpolator. */
   this->CheckForBSplineInterpolator();
 
+  /** Report the memory used by the precomputed moving image buffers. */
+  this->PrintPrecomputedBufferMemory();
+
   /** Check if the transform is an advanced transform. */
   this->CheckForAdvancedTransform();
 
   /** Check if the transform is a B-spline transform. */
   this->CheckForBSplineTransform();
 
+  /** Let the image sampler order its samples by the B-spline grid cells. */
+  this->InitializeImageSamplerOrderGrid();
+
+  /** The sample weights of the previous resolution are of no use. */
+  this->ClearBSplineSampleWeightsCache();
+
   /** Initialize some threading related parameters. */
   if( this->m_UseMultiThread )
   {
@@ -373,11 +391,124 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
     this->m_ImageSampler->SetInput( this->m_FixedImage );
     this->m_ImageSampler->SetMask( this->m_FixedImageMask );
     this->m_ImageSampler->SetInputImageRegion( this->GetFixedImageRegion() );
+    this->m_ImageSampler->SetUseLazySampling( this->CanUseLazyImageSampling() );
   }
 
 } // end InitializeImageSampler()
 
 
+/**
+ * ********************* InitializeImageSamplerOrderGrid ****************************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+AdvancedImageToImageMetric< TFixedImage, TMovingImage >
+::InitializeImageSamplerOrderGrid( void )
+{
+  if( !this->GetUseImageSampler() )
+  {
+    return;
+  }
+
+  /** Samples in the same grid cell have the same B-spline support region.
+   * With an initial transform, the cells are only approximately those of
+   * the fixed image, which is still good enough for the sample order.
+   */
+  const BSplineTransformBaseType * bsplineTransform
+    = dynamic_cast< const BSplineTransformBaseType * >( this->m_AdvancedTransform.GetPointer() );
+  const CombinationTransformType * combinationTransform
+    = dynamic_cast< const CombinationTransformType * >( this->m_AdvancedTransform.GetPointer() );
+  if( combinationTransform )
+  {
+    bsplineTransform = dynamic_cast< const BSplineTransformBaseType * >(
+      combinationTransform->GetCurrentTransform() );
+  }
+
+  if( bsplineTransform )
+  {
+    this->m_ImageSampler->SetSampleOrderGrid( bsplineTransform->GetGridOrigin(),
+      bsplineTransform->GetGridSpacing(), bsplineTransform->GetGridDirection() );
+  }
+  else
+  {
+    this->m_ImageSampler->RemoveSampleOrderGrid();
+  }
+
+} // end InitializeImageSamplerOrderGrid()
+
+
+/**
+ * ********************* GetNumberOfFixedImageSamples ****************************
+ */
+
+template< class TFixedImage, class TMovingImage >
+SizeValueType
+AdvancedImageToImageMetric< TFixedImage, TMovingImage >
+::GetNumberOfFixedImageSamples( void ) const
+{
+  if( this->IsImageSampleGridUsed() )
+  {
+    return this->GetImageSampler()->GetSampleGrid().GetNumberOfSamples();
+  }
+  return this->GetImageSampler()->GetOutput()->Size();
+
+} // end GetNumberOfFixedImageSamples()
+
+
+/**
+ * ********************* GetNumberOfFixedImageSamplePositions ****************************
+ */
+
+template< class TFixedImage, class TMovingImage >
+SizeValueType
+AdvancedImageToImageMetric< TFixedImage, TMovingImage >
+::GetNumberOfFixedImageSamplePositions( void ) const
+{
+  if( this->IsImageSampleGridUsed() )
+  {
+    return this->GetImageSampler()->GetSampleGrid().GetNumberOfGridPoints();
+  }
+  return this->GetImageSampler()->GetOutput()->Size();
+
+} // end GetNumberOfFixedImageSamplePositions()
+
+
+/**
+ * ****************** InitializeReducedMemoryImageModel **********************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+AdvancedImageToImageMetric< TFixedImage, TMovingImage >
+::InitializeReducedMemoryImageModel( void )
+{
+  if( !this->m_UseReducedMemoryImageModel )
+  {
+    return;
+  }
+
+  /** Only a B-spline interpolator with double coefficients is replaced.
+   * The replacement is set before the interpolator receives its input
+   * image, so that the double coefficient image is never computed.
+   */
+  BSplineInterpolatorType * testPtr
+    = dynamic_cast< BSplineInterpolatorType * >( this->m_Interpolator.GetPointer() );
+  if( !testPtr )
+  {
+    return;
+  }
+
+  if( this->m_ReducedMemoryBSplineInterpolator.IsNull() )
+  {
+    this->m_ReducedMemoryBSplineInterpolator = BSplineInterpolatorFloatType::New();
+  }
+  this->m_ReducedMemoryBSplineInterpolator->SetSplineOrder( testPtr->GetSplineOrder() );
+  this->SetInterpolator( this->m_ReducedMemoryBSplineInterpolator );
+
+} // end InitializeReducedMemoryImageModel()
+
+
 /**
  * ****************** CheckForBSplineInterpolator **********************
  */
@@ -479,7 +610,8 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
     if( !this->m_InterpolatorIsBSpline && !this->m_InterpolatorIsBSplineFloat
       && !this->m_InterpolatorIsReducedBSpline
       && !this->m_InterpolatorIsLinear
-      && !interpolatorIsRayCast )
+      && !interpolatorIsRayCast
+      && !this->m_UseReducedMemoryImageModel )
     {
       this->m_CentralDifferenceGradientFilter = CentralDifferenceGradientFilterType::New();
       this->m_CentralDifferenceGradientFilter->SetUseImageSpacing( true );
@@ -497,6 +629,60 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
 } // end CheckForBSplineInterpolator()
 
 
+/**
+ * ****************** PrintPrecomputedBufferMemory **********************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+AdvancedImageToImageMetric< TFixedImage, TMovingImage >
+::PrintPrecomputedBufferMemory( void ) const
+{
+  /** The B-spline coefficient images have the size of the moving image. */
+  const SizeValueType numberOfMovingPixels
+    = this->m_MovingImage->GetBufferedRegion().GetNumberOfPixels();
+
+  std::size_t coefficientBytes = 0;
+  std::string coefficientType  = "none";
+  if( this->m_InterpolatorIsBSpline )
+  {
+    coefficientBytes = numberOfMovingPixels
+      * sizeof( typename BSplineInterpolatorType::CoefficientDataType );
+    coefficientType = "double";
+  }
+  else if( this->m_InterpolatorIsBSplineFloat )
+  {
+    coefficientBytes = numberOfMovingPixels
+      * sizeof( typename BSplineInterpolatorFloatType::CoefficientDataType );
+    coefficientType = "float";
+  }
+  else if( this->m_InterpolatorIsReducedBSpline )
+  {
+    coefficientBytes = numberOfMovingPixels
+      * sizeof( typename ReducedBSplineInterpolatorType::CoefficientDataType );
+    coefficientType = "double";
+  }
+
+  std::size_t gradientBytes = 0;
+  if( this->m_GradientImage.IsNotNull() )
+  {
+    gradientBytes = this->m_GradientImage->GetBufferedRegion().GetNumberOfPixels()
+      * sizeof( GradientPixelType );
+  }
+
+  const double MB = 1024.0 * 1024.0;
+  elxout << "  Precomputed moving image buffers:\n"
+         << "    B-spline coefficients (" << coefficientType << "): "
+         << static_cast< double >( coefficientBytes ) / MB << " MB\n"
+         << "    Gradient image: "
+         << static_cast< double >( gradientBytes ) / MB << " MB\n"
+         << "    Total: "
+         << static_cast< double >( coefficientBytes + gradientBytes ) / MB
+         << " MB" << std::endl;
+
+} // end PrintPrecomputedBufferMemory()
+
+
 /**
  * ****************** CheckForAdvancedTransform **********************
  */
@@ -586,6 +772,8 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
   RealType & movingImageValue,
   MovingImageDerivativeType * gradient ) const
 {
+  elxProfileScope( InterpolationPhase );
+
   /** Check if mapped point inside image buffer. */
   MovingImageContinuousIndexType cindex;
   this->m_Interpolator->ConvertPointToContinuousIndex( mappedPoint, cindex );
@@ -624,7 +812,9 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
       else
       {
         /** Get the gradient by NearestNeighboorInterpolation of the gradient image.
-         * It is assumed that the gradient image is computed.
+         * It is assumed that the gradient image is computed, unless the reduced
+         * memory image model is used. In that case the central difference is
+         * evaluated on the fly.
          */
         movingImageValue = this->m_Interpolator->EvaluateAtContinuousIndex( cindex );
         MovingImageIndexType index;
@@ -632,7 +822,14 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
         {
           index[ j ] = static_cast< long >( Math::Round< double >( cindex[ j ] ) );
         }
-        ( *gradient ) = this->m_GradientImage->GetPixel( index );
+        if( this->m_GradientImage.IsNotNull() )
+        {
+          ( *gradient ) = this->m_GradientImage->GetPixel( index );
+        }
+        else
+        {
+          this->EvaluateMovingImageCentralDifference( index, *gradient );
+        }
       }
 
       /** The moving image gradient is multiplied with its scales, when requested. */
@@ -686,6 +883,56 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
 } // end EvaluateMovingImageValueAndDerivative()
 
 
+/**
+ * ******************* EvaluateMovingImageCentralDifference ******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+AdvancedImageToImageMetric< TFixedImage, TMovingImage >
+::EvaluateMovingImageCentralDifference(
+  const MovingImageIndexType & index,
+  MovingImageDerivativeType & gradient ) const
+{
+  typedef typename MovingImageIndexType::IndexValueType MovingImageIndexValueType;
+
+  const MovingImageRegionType &                region  = this->m_MovingImage->GetBufferedRegion();
+  const typename MovingImageType::SpacingType & spacing = this->m_MovingImage->GetSpacing();
+
+  /** Central differences, with a zero flux Neumann boundary condition,
+   * like the GradientImageFilter does.
+   */
+  MovingImageDerivativeType localGradient;
+  for( unsigned int i = 0; i < MovingImageDimension; ++i )
+  {
+    const MovingImageIndexValueType first = region.GetIndex()[ i ];
+    const MovingImageIndexValueType last
+      = first + static_cast< MovingImageIndexValueType >( region.GetSize()[ i ] ) - 1;
+
+    MovingImageIndexType indexMinus = index;
+    MovingImageIndexType indexPlus  = index;
+    indexMinus[ i ] = std::max( index[ i ] - 1, first );
+    indexPlus[ i ]  = std::min( index[ i ] + 1, last );
+
+    const RealType valueMinus = static_cast< RealType >( this->m_MovingImage->GetPixel( indexMinus ) );
+    const RealType valuePlus  = static_cast< RealType >( this->m_MovingImage->GetPixel( indexPlus ) );
+    localGradient[ i ] = 0.5 * ( valuePlus - valueMinus ) / spacing[ i ];
+  }
+
+  /** Express the gradient in physical coordinates. */
+  const typename MovingImageType::DirectionType & direction = this->m_MovingImage->GetDirection();
+  for( unsigned int i = 0; i < MovingImageDimension; ++i )
+  {
+    gradient[ i ] = 0.0;
+    for( unsigned int j = 0; j < MovingImageDimension; ++j )
+    {
+      gradient[ i ] += direction[ i ][ j ] * localGradient[ j ];
+    }
+  }
+
+} // end EvaluateMovingImageCentralDifference()
+
+
 /**
  * *************** EvaluateTransformJacobianInnerProduct ****************
  */
@@ -698,6 +945,8 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
   const MovingImageDerivativeType & movingImageDerivative,
   DerivativeType & imageJacobian ) const
 {
+  elxProfileScope( DerivativeAccumulationPhase );
+
   typedef typename TransformJacobianType::const_iterator JacobianIteratorType;
   typedef typename DerivativeType::iterator              DerivativeIteratorType;
 
@@ -781,6 +1030,9 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
   TransformJacobianType & jacobian,
   NonZeroJacobianIndicesType & nzji ) const
 {
+  elxProfileScope( TransformJacobianPhase );
+  elxProfileCount( JacobianEvaluationsCounter, 1 );
+
   /** Advanced transform: generic sparse Jacobian support */
   this->m_AdvancedTransform->GetJacobian(
     fixedImagePoint, jacobian, nzji );
@@ -792,6 +1044,235 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
 } // end EvaluateTransformJacobian()
 
 
+/**
+ * *************** ClearBSplineSampleWeightsCache ****************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+AdvancedImageToImageMetric< TFixedImage, TMovingImage >
+::ClearBSplineSampleWeightsCache( void ) const
+{
+  BSplineSampleWeightsCacheType & cache = this->m_BSplineSampleWeightsCache;
+  cache.st_Transform                  = nullptr;
+  cache.st_NumberOfWeights            = 0;
+  cache.st_KeyTransform               = nullptr;
+  cache.st_KeySampler                 = nullptr;
+  cache.st_KeySamplerMTime            = 0;
+  cache.st_KeyNumberOfSamplePositions = 0;
+  cache.st_KeyUseSampleGrid           = false;
+  cache.st_KeyGridParameters          = BSplineGridParametersType();
+
+  /** Swap with empty vectors, to really release the memory. */
+  std::vector< double >().swap( cache.st_Weights );
+  std::vector< OffsetValueType >().swap( cache.st_Offsets );
+
+} // end ClearBSplineSampleWeightsCache()
+
+
+/**
+ * *************** UpdateBSplineSampleWeightsCache ****************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+AdvancedImageToImageMetric< TFixedImage, TMovingImage >
+::UpdateBSplineSampleWeightsCache( void ) const
+{
+  BSplineSampleWeightsCacheType & cache = this->m_BSplineSampleWeightsCache;
+  cache.st_Transform = nullptr;
+  if( !this->m_UseBSplineSampleWeightsCache || !this->m_UseImageSampler )
+  {
+    return;
+  }
+
+  /** Only a B-spline transform without initial transform is supported,
+   * because only then the B-spline is evaluated at the fixed image samples.
+   */
+  const BSplineTransformBaseType * bsplineTransform
+    = dynamic_cast< const BSplineTransformBaseType * >( this->m_AdvancedTransform.GetPointer() );
+  const CombinationTransformType * combinationTransform
+    = dynamic_cast< const CombinationTransformType * >( this->m_AdvancedTransform.GetPointer() );
+  if( combinationTransform && combinationTransform->GetInitialTransform() == nullptr )
+  {
+    bsplineTransform = dynamic_cast< const BSplineTransformBaseType * >(
+      combinationTransform->GetCurrentTransform() );
+  }
+  if( bsplineTransform == nullptr || bsplineTransform->GetNumberOfSampleWeights() == 0 )
+  {
+    this->ClearBSplineSampleWeightsCache();
+    return;
+  }
+
+  /** Check if the samples and the grid are the same as in the previous iteration. */
+  ImageSamplerType *  sampler           = this->GetImageSampler();
+  const SizeValueType numberOfPositions = this->GetNumberOfFixedImageSamplePositions();
+  const bool          useSampleGrid     = this->IsImageSampleGridUsed();
+  const bool          sameKey
+    = cache.st_KeyTransform == bsplineTransform
+    && cache.st_KeySampler == sampler
+    && cache.st_KeySamplerMTime == sampler->GetMTime()
+    && cache.st_KeyNumberOfSamplePositions == numberOfPositions
+    && cache.st_KeyUseSampleGrid == useSampleGrid
+    && cache.st_KeyGridParameters == bsplineTransform->GetFixedParameters();
+
+  /** Samples that are seen for the first time are probably not reused,
+   * for example when new samples are selected every iteration. Only remember
+   * them, and postpone computing the cache to the next iteration.
+   */
+  if( !sameKey )
+  {
+    this->ClearBSplineSampleWeightsCache();
+    cache.st_KeyTransform               = bsplineTransform;
+    cache.st_KeySampler                 = sampler;
+    cache.st_KeySamplerMTime            = sampler->GetMTime();
+    cache.st_KeyNumberOfSamplePositions = numberOfPositions;
+    cache.st_KeyUseSampleGrid           = useSampleGrid;
+    cache.st_KeyGridParameters          = bsplineTransform->GetFixedParameters();
+    return;
+  }
+
+  /** Compute the weights and offsets of all sample positions, once. */
+  if( cache.st_Offsets.size() != numberOfPositions )
+  {
+    const unsigned int numberOfWeights = bsplineTransform->GetNumberOfSampleWeights();
+    cache.st_NumberOfWeights = numberOfWeights;
+    cache.st_Weights.resize( numberOfPositions * numberOfWeights );
+    cache.st_Offsets.resize( numberOfPositions );
+
+    double *          weights = cache.st_Weights.data();
+    OffsetValueType * offsets = cache.st_Offsets.data();
+
+    MultiThreaderBase::Pointer threader = MultiThreaderBase::New();
+    threader->SetNumberOfWorkUnits( Self::GetNumberOfWorkUnits() );
+    if( useSampleGrid )
+    {
+      const ImageSampleGridType & sampleGrid = sampler->GetSampleGrid();
+      threader->ParallelizeArray( 0, numberOfPositions,
+        [ &sampleGrid, bsplineTransform, weights, offsets, numberOfWeights ]( SizeValueType i )
+        {
+          FixedImageIndexType index;
+          FixedImagePointType point;
+          sampleGrid.ComputeIndex( i, index );
+          sampleGrid.GetImage()->TransformIndexToPhysicalPoint( index, point );
+          bsplineTransform->ComputeSampleWeights( point, weights + i * numberOfWeights, offsets[ i ] );
+        },
+        nullptr );
+    }
+    else
+    {
+      const ImageSampleContainerType * sampleContainer = sampler->GetOutput();
+      threader->ParallelizeArray( 0, numberOfPositions,
+        [ sampleContainer, bsplineTransform, weights, offsets, numberOfWeights ]( SizeValueType i )
+        {
+          bsplineTransform->ComputeSampleWeights( sampleContainer->ElementAt( i ).m_ImageCoordinates,
+            weights + i * numberOfWeights, offsets[ i ] );
+        },
+        nullptr );
+    }
+  }
+
+  cache.st_Transform = bsplineTransform;
+
+} // end UpdateBSplineSampleWeightsCache()
+
+
+/**
+ * *************** TransformSamplePoint ****************
+ */
+
+template< class TFixedImage, class TMovingImage >
+bool
+AdvancedImageToImageMetric< TFixedImage, TMovingImage >
+::TransformSamplePoint(
+  const SizeValueType samplePosition,
+  const FixedImagePointType & fixedImagePoint,
+  MovingImagePointType & mappedPoint ) const
+{
+  const BSplineSampleWeightsCacheType & cache = this->m_BSplineSampleWeightsCache;
+  if( cache.st_Transform == nullptr )
+  {
+    return this->TransformPoint( fixedImagePoint, mappedPoint );
+  }
+
+  mappedPoint = cache.st_Transform->TransformPointUsingSampleWeights( fixedImagePoint,
+    cache.st_Weights.data() + samplePosition * cache.st_NumberOfWeights,
+    cache.st_Offsets[ samplePosition ] );
+
+  /** For future use: return whether the sample is valid */
+  const bool valid = true;
+  return valid;
+
+} // end TransformSamplePoint()
+
+
+/**
+ * *************** EvaluateSampleTransformJacobian ****************
+ */
+
+template< class TFixedImage, class TMovingImage >
+bool
+AdvancedImageToImageMetric< TFixedImage, TMovingImage >
+::EvaluateSampleTransformJacobian(
+  const SizeValueType samplePosition,
+  const FixedImagePointType & fixedImagePoint,
+  TransformJacobianType & jacobian,
+  NonZeroJacobianIndicesType & nzji ) const
+{
+  const BSplineSampleWeightsCacheType & cache = this->m_BSplineSampleWeightsCache;
+  if( cache.st_Transform == nullptr )
+  {
+    return this->EvaluateTransformJacobian( fixedImagePoint, jacobian, nzji );
+  }
+
+  elxProfileScope( TransformJacobianPhase );
+  elxProfileCount( JacobianEvaluationsCounter, 1 );
+
+  cache.st_Transform->GetJacobianUsingSampleWeights(
+    cache.st_Weights.data() + samplePosition * cache.st_NumberOfWeights,
+    cache.st_Offsets[ samplePosition ], jacobian, nzji );
+
+  /** For future use: return whether the sample is valid */
+  const bool valid = true;
+  return valid;
+
+} // end EvaluateSampleTransformJacobian()
+
+
+/**
+ * *************** EvaluateSampleJacobianWithImageGradientProduct ****************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+AdvancedImageToImageMetric< TFixedImage, TMovingImage >
+::EvaluateSampleJacobianWithImageGradientProduct(
+  const SizeValueType samplePosition,
+  const FixedImagePointType & fixedImagePoint,
+  const MovingImageDerivativeType & movingImageDerivative,
+  DerivativeType & imageJacobian,
+  NonZeroJacobianIndicesType & nzji ) const
+{
+  /** The Jacobian is not stored, so its product with the image gradient
+   * is included in the Jacobian time. */
+  elxProfileScope( TransformJacobianPhase );
+  elxProfileCount( JacobianEvaluationsCounter, 1 );
+
+  const BSplineSampleWeightsCacheType & cache = this->m_BSplineSampleWeightsCache;
+  if( cache.st_Transform == nullptr )
+  {
+    this->m_AdvancedTransform->EvaluateJacobianWithImageGradientProduct(
+      fixedImagePoint, movingImageDerivative, imageJacobian, nzji );
+    return;
+  }
+
+  cache.st_Transform->EvaluateJacobianWithImageGradientProductUsingSampleWeights(
+    cache.st_Weights.data() + samplePosition * cache.st_NumberOfWeights,
+    cache.st_Offsets[ samplePosition ], movingImageDerivative, imageJacobian, nzji );
+
+} // end EvaluateSampleJacobianWithImageGradientProduct()
+
+
 /**
  * ************************** IsInsideMovingMask *************************
  */
@@ -856,6 +1337,7 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
     {
       this->GetImageSampler()->Update();
     }
+    this->UpdateBSplineSampleWeightsCache();
   }
 
 } // end BeforeThreadedGetValueAndDerivative()
@@ -1001,6 +1483,7 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
   unsigned long wanted, unsigned long found ) const
 {
   this->m_NumberOfPixelsCounted = found;
+  elxProfileCount( SamplesInsideMaskCounter, found );
   if( found < wanted * this->GetRequiredRatioOfValidSamples() )
   {
     itkExceptionMacro( "Too many samples map outside moving image buffer: "
@@ -1071,6 +1554,10 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
      << this->m_BSplineInterpolatorFloat.GetPointer() << std::endl;
   os << indent.GetNextIndent() << "CentralDifferenceGradientFilter: "
      << this->m_CentralDifferenceGradientFilter.GetPointer() << std::endl;
+  os << indent.GetNextIndent() << "UseReducedMemoryImageModel: "
+     << this->m_UseReducedMemoryImageModel << std::endl;
+  os << indent.GetNextIndent() << "UseLazyImageSampling: "
+     << this->m_UseLazyImageSampling << std::endl;
 
   /** Variables used when the transform is a B-spline transform. */
   os << indent << "Variables store the transform as an AdvancedTransform: " << std::endl;
@@ -21,6 +21,8 @@
 #include "itkAdvancedImageToImageMetric.h"
 #include "itkKernelFunctionBase2.h"
 
+#include <vector>
+
 
 namespace itk
 {
@@ -311,8 +313,7 @@ protected:
 
   struct ParzenWindowHistogramGetValueAndDerivativePerThreadStruct
   {
-    SizeValueType   st_NumberOfPixelsCounted;
-    JointPDFPointer st_JointPDF;
+    SizeValueType st_NumberOfPixelsCounted;
   };
   itkPadStruct( ITK_CACHE_LINE_ALIGNMENT, ParzenWindowHistogramGetValueAndDerivativePerThreadStruct,
     PaddedParzenWindowHistogramGetValueAndDerivativePerThreadStruct );
@@ -321,6 +322,23 @@ protected:
   mutable AlignedParzenWindowHistogramGetValueAndDerivativePerThreadStruct * m_ParzenWindowHistogramGetValueAndDerivativePerThreadVariables;
   mutable ThreadIdType                                                       m_ParzenWindowHistogramGetValueAndDerivativePerThreadVariablesSize;
 
+  /** The joint PDFs of the threads, stored as plain arrays in one buffer.
+   * Each joint PDF starts at a cache line, at a distance of m_ThreaderJointPDFsStride
+   * elements from the previous one. The stride is padded with an extra cache
+   * line, so that the same bins of different threads do not map to the same
+   * cache sets.
+   */
+  mutable std::vector< PDFValueType > m_ThreaderJointPDFsBuffer;
+  mutable SizeValueType               m_ThreaderJointPDFsOffset;
+  mutable SizeValueType               m_ThreaderJointPDFsStride;
+
+  /** Get the joint PDF of a thread. */
+  PDFValueType * GetThreaderJointPDF( ThreadIdType threadId ) const
+  {
+    return const_cast< PDFValueType * >( this->m_ThreaderJointPDFsBuffer.data() )
+           + this->m_ThreaderJointPDFsOffset + threadId * this->m_ThreaderJointPDFsStride;
+  }
+
   /** Initialize threading related parameters. */
   void InitializeThreadingParameters( void ) const override;
 
@@ -347,6 +365,28 @@ protected:
     const KernelFunctionType * kernel,
     ParzenValueContainerType & parzenValues ) const;
 
+  /** Update the joint PDF with a pixel pair, for the given fixed and moving
+   * kernel B-spline orders. The joint PDF is a plain array with the moving
+   * bins contiguous, like the buffer of m_JointPDF. The Parzen values are
+   * computed at once by the non-virtual kernels, into fixed size arrays.
+   * This function is used by ComputePDFs(), instead of UpdateJointPDFAndDerivatives().
+   */
+  template< unsigned int VFixedKernelOrder, unsigned int VMovingKernelOrder >
+  void UpdateJointPDFBuffer(
+    const RealType & fixedImageValue,
+    const RealType & movingImageValue,
+    PDFValueType * jointPDF ) const;
+
+  /** Pointer to an UpdateJointPDFBuffer() specialization. */
+  typedef void ( Self::* UpdateJointPDFBufferFunctionType )(
+    const RealType &, const RealType &, PDFValueType * ) const;
+
+  /** Select the UpdateJointPDFBuffer() specialization for the kernel orders. */
+  UpdateJointPDFBufferFunctionType GetUpdateJointPDFBufferFunction( void ) const;
+
+  template< unsigned int VFixedKernelOrder >
+  UpdateJointPDFBufferFunctionType GetUpdateJointPDFBufferFunctionForFixedKernelOrder( void ) const;
+
   /** Update the joint PDF with a pixel pair; on demand also updates the
    * pdf derivatives (if the Jacobian pointers are nonzero).
    */
@@ -26,6 +26,8 @@
 #include "itkImageScanlineIterator.h"
 #include "vnl/vnl_math.h"
 
+#include <algorithm>
+
 namespace itk
 {
 
@@ -75,6 +77,8 @@ ParzenWindowHistogramImageToImageMetric< TFixedImage, TMovingImage >
   // Multi-threading structs
   this->m_ParzenWindowHistogramGetValueAndDerivativePerThreadVariables     = nullptr;
   this->m_ParzenWindowHistogramGetValueAndDerivativePerThreadVariablesSize = 0;
+  this->m_ThreaderJointPDFsOffset                                          = 0;
+  this->m_ThreaderJointPDFsStride                                          = 0;
 
 } // end Constructor
 
@@ -460,16 +464,6 @@ ParzenWindowHistogramImageToImageMetric< TFixedImage, TMovingImage >
    * which has performance benefits for larger vector sizes.
    */
 
-  /** Construct regions for the joint histograms. */
-  JointPDFRegionType jointPDFRegion;
-  JointPDFIndexType  jointPDFIndex;
-  JointPDFSizeType   jointPDFSize;
-  jointPDFIndex.Fill( 0 );
-  jointPDFSize[ 0 ] = this->m_NumberOfMovingHistogramBins;
-  jointPDFSize[ 1 ] = this->m_NumberOfFixedHistogramBins;
-  jointPDFRegion.SetIndex( jointPDFIndex );
-  jointPDFRegion.SetSize( jointPDFSize );
-
   const ThreadIdType numberOfThreads = Self::GetNumberOfWorkUnits();
 
   /** Only resize the array of structs when needed. */
@@ -486,16 +480,25 @@ ParzenWindowHistogramImageToImageMetric< TFixedImage, TMovingImage >
   for( ThreadIdType i = 0; i < numberOfThreads; ++i )
   {
     this->m_ParzenWindowHistogramGetValueAndDerivativePerThreadVariables[ i ].st_NumberOfPixelsCounted = NumericTraits< SizeValueType >::Zero;
+  }
 
-    // Initialize the joint pdf
-    JointPDFPointer & jointPDF = this->m_ParzenWindowHistogramGetValueAndDerivativePerThreadVariables[ i ].st_JointPDF;
-    if( jointPDF.IsNull() ) { jointPDF = JointPDFType::New(); }
-    if( jointPDF->GetLargestPossibleRegion() != jointPDFRegion )
-    {
-      jointPDF->SetRegions( jointPDFRegion );
-      jointPDF->Allocate();
-    }
+  /** Allocate the joint pdfs of the threads in one buffer, with some slack to
+   * let the first one start at a cache line.
+   */
+  const SizeValueType cacheLineSize = ITK_CACHE_LINE_ALIGNMENT / sizeof( PDFValueType );
+  const SizeValueType numberOfBins
+    = this->m_NumberOfFixedHistogramBins * this->m_NumberOfMovingHistogramBins;
+  this->m_ThreaderJointPDFsStride
+    = ( ( numberOfBins + cacheLineSize - 1 ) / cacheLineSize + 1 ) * cacheLineSize;
+  const SizeValueType bufferSize = this->m_ThreaderJointPDFsStride * numberOfThreads + cacheLineSize;
+  if( this->m_ThreaderJointPDFsBuffer.size() != bufferSize )
+  {
+    this->m_ThreaderJointPDFsBuffer.resize( bufferSize );
   }
+  const std::size_t misalignment
+    = reinterpret_cast< std::size_t >( this->m_ThreaderJointPDFsBuffer.data() ) % ITK_CACHE_LINE_ALIGNMENT;
+  this->m_ThreaderJointPDFsOffset = misalignment == 0
+    ? 0 : ( ITK_CACHE_LINE_ALIGNMENT - misalignment ) / sizeof( PDFValueType );
 
 } // end InitializeThreadingParameters()
 
@@ -554,6 +557,118 @@ ParzenWindowHistogramImageToImageMetric< TFixedImage, TMovingImage >
 } // end EvaluateParzenValues()
 
 
+/**
+ * ********************** UpdateJointPDFBuffer ***************
+ */
+
+template< class TFixedImage, class TMovingImage >
+template< unsigned int VFixedKernelOrder, unsigned int VMovingKernelOrder >
+void
+ParzenWindowHistogramImageToImageMetric< TFixedImage, TMovingImage >
+::UpdateJointPDFBuffer(
+  const RealType & fixedImageValue,
+  const RealType & movingImageValue,
+  PDFValueType * jointPDF ) const
+{
+  typedef BSplineKernelFunction2< VFixedKernelOrder >  FixedKernelType;
+  typedef BSplineKernelFunction2< VMovingKernelOrder > MovingKernelType;
+
+  /** Determine Parzen window arguments (see eq. 6 of Mattes paper [2]). */
+  const double fixedImageParzenWindowTerm
+    = fixedImageValue / this->m_FixedImageBinSize - this->m_FixedImageNormalizedMin;
+  const double movingImageParzenWindowTerm
+    = movingImageValue / this->m_MovingImageBinSize - this->m_MovingImageNormalizedMin;
+
+  /** The lowest bin numbers affected by this pixel: */
+  const OffsetValueType fixedImageParzenWindowIndex
+    = static_cast< OffsetValueType >( std::floor(
+    fixedImageParzenWindowTerm + this->m_FixedParzenTermToIndexOffset ) );
+  const OffsetValueType movingImageParzenWindowIndex
+    = static_cast< OffsetValueType >( std::floor(
+    movingImageParzenWindowTerm + this->m_MovingParzenTermToIndexOffset ) );
+
+  /** The Parzen values. The kernels are called non-virtually, so that
+   * all values of the support are computed inline.
+   */
+  double fixedParzenValues[ VFixedKernelOrder + 1 ];
+  double movingParzenValues[ VMovingKernelOrder + 1 ];
+  static_cast< const FixedKernelType * >( this->m_FixedKernel.GetPointer() )->FixedKernelType::Evaluate(
+    static_cast< double >( fixedImageParzenWindowIndex ) - fixedImageParzenWindowTerm, fixedParzenValues );
+  static_cast< const MovingKernelType * >( this->m_MovingKernel.GetPointer() )->MovingKernelType::Evaluate(
+    static_cast< double >( movingImageParzenWindowIndex ) - movingImageParzenWindowTerm, movingParzenValues );
+
+  /** Loop over the Parzen window region and increment the values. */
+  const OffsetValueType numberOfMovingBins = this->m_NumberOfMovingHistogramBins;
+  PDFValueType *        pdfPtr             = jointPDF
+    + fixedImageParzenWindowIndex * numberOfMovingBins + movingImageParzenWindowIndex;
+  for( unsigned int f = 0; f <= VFixedKernelOrder; ++f )
+  {
+    const double fv = fixedParzenValues[ f ];
+    for( unsigned int m = 0; m <= VMovingKernelOrder; ++m )
+    {
+      pdfPtr[ m ] += static_cast< PDFValueType >( fv * movingParzenValues[ m ] );
+    }
+    pdfPtr += numberOfMovingBins;
+  }
+
+} // end UpdateJointPDFBuffer()
+
+
+/**
+ * ********************** GetUpdateJointPDFBufferFunction ***************
+ */
+
+template< class TFixedImage, class TMovingImage >
+typename ParzenWindowHistogramImageToImageMetric< TFixedImage, TMovingImage >::UpdateJointPDFBufferFunctionType
+ParzenWindowHistogramImageToImageMetric< TFixedImage, TMovingImage >
+::GetUpdateJointPDFBufferFunction( void ) const
+{
+  switch( this->m_FixedKernelBSplineOrder )
+  {
+    case 0:
+      return this->template GetUpdateJointPDFBufferFunctionForFixedKernelOrder< 0 >();
+    case 1:
+      return this->template GetUpdateJointPDFBufferFunctionForFixedKernelOrder< 1 >();
+    case 2:
+      return this->template GetUpdateJointPDFBufferFunctionForFixedKernelOrder< 2 >();
+    case 3:
+      return this->template GetUpdateJointPDFBufferFunctionForFixedKernelOrder< 3 >();
+    default:
+      itkExceptionMacro( << "The following FixedKernelBSplineOrder is not implemented: "
+                         << this->m_FixedKernelBSplineOrder );
+  }
+
+} // end GetUpdateJointPDFBufferFunction()
+
+
+/**
+ * ********************** GetUpdateJointPDFBufferFunctionForFixedKernelOrder ***************
+ */
+
+template< class TFixedImage, class TMovingImage >
+template< unsigned int VFixedKernelOrder >
+typename ParzenWindowHistogramImageToImageMetric< TFixedImage, TMovingImage >::UpdateJointPDFBufferFunctionType
+ParzenWindowHistogramImageToImageMetric< TFixedImage, TMovingImage >
+::GetUpdateJointPDFBufferFunctionForFixedKernelOrder( void ) const
+{
+  switch( this->m_MovingKernelBSplineOrder )
+  {
+    case 0:
+      return &Self::template UpdateJointPDFBuffer< VFixedKernelOrder, 0 >;
+    case 1:
+      return &Self::template UpdateJointPDFBuffer< VFixedKernelOrder, 1 >;
+    case 2:
+      return &Self::template UpdateJointPDFBuffer< VFixedKernelOrder, 2 >;
+    case 3:
+      return &Self::template UpdateJointPDFBuffer< VFixedKernelOrder, 3 >;
+    default:
+      itkExceptionMacro( << "The following MovingKernelBSplineOrder is not implemented: "
+                         << this->m_MovingKernelBSplineOrder );
+  }
+
+} // end GetUpdateJointPDFBufferFunctionForFixedKernelOrder()
+
+
 /**
  * ********************** UpdateJointPDFAndDerivatives ***************
  */
@@ -1050,6 +1165,10 @@ ParzenWindowHistogramImageToImageMetric< TFixedImage, TMovingImage >
   /** Get a handle to the sample container. */
   ImageSampleContainerPointer sampleContainer = this->GetImageSampler()->GetOutput();
 
+  /** The joint PDF update for the kernel orders. */
+  const UpdateJointPDFBufferFunctionType updateJointPDF = this->GetUpdateJointPDFBufferFunction();
+  PDFValueType *                         jointPDF       = this->m_JointPDF->GetBufferPointer();
+
   /** Create iterator over the sample container. */
   typename ImageSampleContainerType::ConstIterator fiter;
   typename ImageSampleContainerType::ConstIterator fbegin = sampleContainer->Begin();
@@ -1064,7 +1183,8 @@ ParzenWindowHistogramImageToImageMetric< TFixedImage, TMovingImage >
     MovingImagePointType        mappedPoint;
 
     /** Transform point and check if it is inside the B-spline support region. */
-    bool sampleOk = this->TransformPoint( fixedPoint, mappedPoint );
+    const SizeValueType samplePosition = this->GetSamplePosition( fiter );
+    bool                sampleOk       = this->TransformSamplePoint( samplePosition, fixedPoint, mappedPoint );
 
     /** Check if point is inside mask. */
     if( sampleOk )
@@ -1093,8 +1213,7 @@ ParzenWindowHistogramImageToImageMetric< TFixedImage, TMovingImage >
       movingImageValue = this->GetMovingImageLimiter()->Evaluate( movingImageValue );
 
       /** Compute this sample's contribution to the joint distributions. */
-      this->UpdateJointPDFAndDerivatives(
-        fixedImageValue, movingImageValue, 0, 0, this->m_JointPDF.GetPointer() );
+      ( this->*updateJointPDF )( fixedImageValue, movingImageValue, jointPDF );
     }
 
   } // end iterating over fixed image spatial sample container for loop
@@ -1160,8 +1279,12 @@ ParzenWindowHistogramImageToImageMetric< TFixedImage, TMovingImage >
    * The initialization is performed here, so that it is done multi-threadedly
    * instead of sequentially in InitializeThreadingParameters().
    */
-  JointPDFPointer & jointPDF = this->m_ParzenWindowHistogramGetValueAndDerivativePerThreadVariables[ threadId ].st_JointPDF;
-  jointPDF->FillBuffer( NumericTraits< PDFValueType >::ZeroValue() );
+  PDFValueType * jointPDF = this->GetThreaderJointPDF( threadId );
+  std::fill( jointPDF, jointPDF + this->m_NumberOfFixedHistogramBins * this->m_NumberOfMovingHistogramBins,
+    NumericTraits< PDFValueType >::ZeroValue() );
+
+  /** The joint PDF update for the kernel orders. */
+  const UpdateJointPDFBufferFunctionType updateJointPDF = this->GetUpdateJointPDFBufferFunction();
 
   /** Get a handle to the sample container. */
   ImageSampleContainerPointer sampleContainer     = this->GetImageSampler()->GetOutput();
@@ -1196,7 +1319,8 @@ ParzenWindowHistogramImageToImageMetric< TFixedImage, TMovingImage >
     MovingImagePointType        mappedPoint;
 
     /** Transform point and check if it is inside the B-spline support region. */
-    bool sampleOk = this->TransformPoint( fixedPoint, mappedPoint );
+    const SizeValueType samplePosition = this->GetSamplePosition( fiter );
+    bool                sampleOk       = this->TransformSamplePoint( samplePosition, fixedPoint, mappedPoint );
 
     /** Check if point is inside mask. */
     if( sampleOk )
@@ -1225,9 +1349,7 @@ ParzenWindowHistogramImageToImageMetric< TFixedImage, TMovingImage >
       movingImageValue = this->GetMovingImageLimiter()->Evaluate( movingImageValue );
 
       /** Compute this sample's contribution to the joint distributions. */
-      this->UpdateJointPDFAndDerivatives(
-        fixedImageValue, movingImageValue, 0, 0,
-        jointPDF.GetPointer() );
+      ( this->*updateJointPDF )( fixedImageValue, movingImageValue, jointPDF );
     }
   } // end iterating over fixed image spatial sample container for loop
 
@@ -1268,36 +1390,18 @@ ParzenWindowHistogramImageToImageMetric< TFixedImage, TMovingImage >
   /** Compute alpha. */
   this->m_Alpha = 1.0 / static_cast< double >( this->m_NumberOfPixelsCounted );
 
-  /** Accumulate joint histogram. */
-  // could be multi-threaded too, by each thread updating only a part of the JointPDF.
-  typedef ImageScanlineIterator< JointPDFType > JointPDFIteratorType;
-  JointPDFIteratorType                it( this->m_JointPDF, this->m_JointPDF->GetBufferedRegion() );
-  std::vector< JointPDFIteratorType > itT( numberOfThreads );
-  for( ThreadIdType i = 0; i < numberOfThreads; ++i )
-  {
-    itT[ i ] = JointPDFIteratorType(
-      this->m_ParzenWindowHistogramGetValueAndDerivativePerThreadVariables[ i ].st_JointPDF,
-      this->m_JointPDF->GetBufferedRegion() );
-  }
-
-  PDFValueType sum;
-  while( !it.IsAtEnd() )
+  /** Accumulate joint histogram, thread by thread, over the contiguous buffers. */
+  const SizeValueType numberOfBins
+    = this->m_NumberOfFixedHistogramBins * this->m_NumberOfMovingHistogramBins;
+  PDFValueType *       jointPDF       = this->m_JointPDF->GetBufferPointer();
+  const PDFValueType * threadJointPDF = this->GetThreaderJointPDF( 0 );
+  std::copy( threadJointPDF, threadJointPDF + numberOfBins, jointPDF );
+  for( ThreadIdType i = 1; i < numberOfThreads; ++i )
   {
-    while( !it.IsAtEndOfLine() )
-    {
-      sum = NumericTraits< PDFValueType >::Zero;
-      for( ThreadIdType i = 0; i < numberOfThreads; ++i )
-      {
-        sum += itT[ i ].Value();
-        ++itT[ i ];
-      }
-      it.Set( sum );
-      ++it;
-    }
-    it.NextLine();
-    for( ThreadIdType i = 0; i < numberOfThreads; ++i )
+    threadJointPDF = this->GetThreaderJointPDF( i );
+    for( SizeValueType k = 0; k < numberOfBins; ++k )
     {
-      itT[ i ].NextLine();
+      jointPDF[ k ] += threadJointPDF[ k ];
     }
   }
 
@@ -1399,7 +1503,8 @@ ParzenWindowHistogramImageToImageMetric< TFixedImage, TMovingImage >
     MovingImageDerivativeType   movingImageDerivative;
 
     /** Transform point and check if it is inside the B-spline support region. */
-    bool sampleOk = this->TransformPoint( fixedPoint, mappedPoint );
+    const SizeValueType samplePosition = this->GetSamplePosition( fiter );
+    bool                sampleOk       = this->TransformSamplePoint( samplePosition, fixedPoint, mappedPoint );
 
     /** Check if point is inside mask. */
     if( sampleOk )
@@ -1429,7 +1534,7 @@ ParzenWindowHistogramImageToImageMetric< TFixedImage, TMovingImage >
         movingImageValue, movingImageDerivative );
 
       /** Get the TransformJacobian dT/dmu. */
-      this->EvaluateTransformJacobian( fixedPoint, jacobian, nzji );
+      this->EvaluateSampleTransformJacobian( samplePosition, fixedPoint, jacobian, nzji );
 
       /** Compute the inner product (dM/dx)^T (dT/dmu). */
       this->EvaluateTransformJacobianInnerProduct(
@@ -1519,8 +1624,9 @@ ParzenWindowHistogramImageToImageMetric< TFixedImage, TMovingImage >
     /** Transform point and check if it is inside the B-spline support region.
      * if not, skip this sample.
      */
+    const SizeValueType  samplePosition = this->GetSamplePosition( fiter );
     MovingImagePointType mappedPoint;
-    bool                 sampleOk = this->TransformPoint( fixedPoint, mappedPoint );
+    bool                 sampleOk = this->TransformSamplePoint( samplePosition, fixedPoint, mappedPoint );
 
     if( sampleOk )
     {
@@ -1570,7 +1676,7 @@ ParzenWindowHistogramImageToImageMetric< TFixedImage, TMovingImage >
        * function of its parameters, so that we can evaluate T(x;\mu+delta_ek)
        * as T(x) + delta * dT/dmu_k.
        */
-      this->EvaluateTransformJacobian( fixedPoint, jacobian, nzji );
+      this->EvaluateSampleTransformJacobian( samplePosition, fixedPoint, jacobian, nzji );
 
       MovingImagePointType mappedPointRight;
       MovingImagePointType mappedPointLeft;
@@ -19,6 +19,7 @@
 #define __itkScaledSingleValuedCostFunction_cxx
 
 #include "itkScaledSingleValuedCostFunction.h"
+#include "itkParameterVectorOperations.h"
 #include "vnl/vnl_math.h"
 
 namespace itk
@@ -101,11 +102,10 @@ ScaledSingleValuedCostFunction
     this->ConvertScaledToUnscaledParameters( scaledParameters );
     this->m_UnscaledCostFunction->GetDerivative( scaledParameters, derivative );
 
-    const ScalesType & scales = this->GetScales();
-    for( unsigned int i = 0; i < numberOfParameters; ++i )
-    {
-      derivative[ i ] /= scales[ i ];
-    }
+    /** The parameter vector operations in this class get no threader: the
+     * cost function contexts of an optimizer may evaluate concurrently.
+     */
+    ParameterVectorOperations::Divide( this->GetScales(), derivative );
   }
   else
   {
@@ -114,7 +114,7 @@ ScaledSingleValuedCostFunction
 
   if( this->GetNegateCostFunction() )
   {
-    derivative = -derivative;
+    ParameterVectorOperations::Scale( -1.0, derivative );
   }
 
 } // end GetDerivative()
@@ -147,11 +147,7 @@ ScaledSingleValuedCostFunction
     this->ConvertScaledToUnscaledParameters( scaledParameters );
     this->m_UnscaledCostFunction->GetValueAndDerivative( scaledParameters, value, derivative );
 
-    const ScalesType & scales = this->GetScales();
-    for( unsigned int i = 0; i < numberOfParameters; ++i )
-    {
-      derivative[ i ] /= scales[ i ];
-    }
+    ParameterVectorOperations::Divide( this->GetScales(), derivative );
   }
   else
   {
@@ -161,7 +157,7 @@ ScaledSingleValuedCostFunction
   if( this->GetNegateCostFunction() )
   {
     value      = -value;
-    derivative = -derivative;
+    ParameterVectorOperations::Scale( -1.0, derivative );
   }
 
 } // end GetValueAndDerivative()
@@ -241,10 +237,7 @@ ScaledSingleValuedCostFunction
       itkExceptionMacro( << "Number of scales is not correct." );
     }
 
-    for( unsigned int i = 0; i < numberOfParameters; ++i )
-    {
-      parameters[ i ] /= scales[ i ];
-    }
+    ParameterVectorOperations::Divide( scales, parameters );
 
   } // end if use scales
 
@@ -268,10 +261,7 @@ ScaledSingleValuedCostFunction
       itkExceptionMacro( << "Number of scales is not correct." );
     }
 
-    for( unsigned int i = 0; i < numberOfParameters; ++i )
-    {
-      parameters[ i ] *= scales[ i ];
-    }
+    ParameterVectorOperations::Multiply( scales, parameters );
 
   } // end if use scales
 
@@ -0,0 +1,211 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+ // First include the header file to be tested:
+#include "itkAdvancedImageToImageMetric.h"
+
+#include "AdvancedMeanSquares/itkAdvancedMeanSquaresImageToImageMetric.h"
+#include "itkAdvancedSimilarity2DTransform.h"
+#include "itkImageFullSampler.h"
+
+#include <itkBSplineInterpolateImageFunction.h>
+#include <itkGradientImageFilter.h>
+#include <itkImage.h>
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIterator.h>
+#include <itkLinearInterpolateImageFunction.h>
+
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+  using ImageType = itk::Image<float, 2>;
+  using TransformType = itk::AdvancedSimilarity2DTransform<double>;
+
+
+  // Exposes the on-the-fly central difference of the reduced memory image model.
+  class TestMetric : public itk::AdvancedMeanSquaresImageToImageMetric<ImageType, ImageType>
+  {
+  public:
+    using Self = TestMetric;
+    using Superclass = itk::AdvancedMeanSquaresImageToImageMetric<ImageType, ImageType>;
+    using Pointer = itk::SmartPointer<Self>;
+
+    itkNewMacro(Self);
+
+    using GradientType = Superclass::MovingImageDerivativeType;
+    using Superclass::EvaluateMovingImageCentralDifference;
+  };
+
+  using ParametersType = TestMetric::ParametersType;
+  using DerivativeType = TestMetric::DerivativeType;
+  using MeasureType = TestMetric::MeasureType;
+
+
+  // A smooth blob with a ramp, on a grid with anisotropic spacing that is
+  // rotated by 30 degrees.
+  ImageType::Pointer CreateImage(const double centreX, const double centreY)
+  {
+    const auto image = ImageType::New();
+    image->SetRegions(itk::Size<2>{ { 17, 14 } });
+    const double spacing[] = { 0.8, 1.25 };
+    image->SetSpacing(spacing);
+    const double origin[] = { -3.0, 2.0 };
+    image->SetOrigin(origin);
+    ImageType::DirectionType direction;
+    const double angle = std::acos(-1.0) / 6.0;
+    direction[0][0] = std::cos(angle);
+    direction[0][1] = -std::sin(angle);
+    direction[1][0] = std::sin(angle);
+    direction[1][1] = std::cos(angle);
+    image->SetDirection(direction);
+    image->Allocate();
+    for (itk::ImageRegionIterator<ImageType> it(image, image->GetBufferedRegion()); !it.IsAtEnd(); ++it)
+    {
+      const auto index = it.GetIndex();
+      const double dx = index[0] - centreX;
+      const double dy = index[1] - centreY;
+      it.Set(static_cast<float>(100.0 * std::exp(-(dx * dx + 2.0 * dy * dy) / 18.0) + 3.0 * index[0] - index[1]));
+    }
+    return image;
+  }
+
+
+  // Creates a mean squares metric, with or without the reduced memory image model.
+  TestMetric::Pointer CreateMetric(const bool useReducedMemoryImageModel,
+    TestMetric::InterpolatorType* const interpolator, ParametersType& parameters)
+  {
+    const auto fixedImage = CreateImage(8.0, 7.0);
+    const auto movingImage = CreateImage(9.0, 6.5);
+
+    const auto transform = TransformType::New();
+    TransformType::InputPointType centre;
+    fixedImage->TransformIndexToPhysicalPoint(itk::Index<2>{ { 8, 7 } }, centre);
+    transform->SetCenter(centre);
+    parameters.SetSize(transform->GetNumberOfParameters());
+    parameters[0] = 1.03;
+    parameters[1] = 0.05;
+    parameters[2] = 0.4;
+    parameters[3] = -0.3;
+    transform->SetParameters(parameters);
+
+    const auto metric = TestMetric::New();
+    metric->SetFixedImage(fixedImage);
+    metric->SetFixedImageRegion(fixedImage->GetBufferedRegion());
+    metric->SetMovingImage(movingImage);
+    metric->SetTransform(transform);
+    metric->SetInterpolator(interpolator);
+    metric->SetImageSampler(itk::ImageFullSampler<ImageType>::New());
+    metric->SetUseReducedMemoryImageModel(useReducedMemoryImageModel);
+    metric->Initialize();
+    return metric;
+  }
+
+
+  // Expects that the reduced memory image model does not change the value
+  // and derivative of a metric with the specified interpolator type.
+  template <typename TInterpolator>
+  void Expect_reduced_memory_image_model_gives_same_value_and_derivative(const double relativeTolerance)
+  {
+    ParametersType parameters;
+    const auto metric = CreateMetric(false, TInterpolator::New(), parameters);
+    MeasureType expectedValue = 0.0;
+    DerivativeType expectedDerivative;
+    metric->GetValueAndDerivative(parameters, expectedValue, expectedDerivative);
+    ASSERT_GT(expectedDerivative.inf_norm(), 0.0);
+
+    const auto reducedMetric = CreateMetric(true, TInterpolator::New(), parameters);
+    MeasureType value = 0.0;
+    DerivativeType derivative;
+    reducedMetric->GetValueAndDerivative(parameters, value, derivative);
+    ASSERT_EQ(derivative.GetSize(), expectedDerivative.GetSize());
+
+    EXPECT_NEAR(value, expectedValue, relativeTolerance * std::abs(expectedValue));
+    for (unsigned int i = 0; i < derivative.GetSize(); ++i)
+    {
+      EXPECT_NEAR(derivative[i], expectedDerivative[i], relativeTolerance * expectedDerivative.inf_norm())
+        << "at parameter " << i;
+    }
+  }
+}
+
+
+// Tests that the on-the-fly central difference equals the gradient image
+// that is otherwise precomputed, including the clamped boundary voxels.
+GTEST_TEST(AdvancedImageToImageMetric, CentralDifferenceEqualsGradientImageFilter)
+{
+  const auto image = CreateImage(9.0, 6.5);
+
+  const auto filter = itk::GradientImageFilter<ImageType, double, double>::New();
+  filter->SetUseImageSpacing(true);
+  filter->SetUseImageDirection(true);
+  filter->SetInput(image);
+  filter->Update();
+  const auto gradientImage = filter->GetOutput();
+
+  const auto metric = TestMetric::New();
+  metric->SetMovingImage(image);
+
+  const auto region = image->GetBufferedRegion();
+  unsigned int numberOfBoundaryVoxels = 0;
+  for (itk::ImageRegionConstIterator<ImageType> it(image, region); !it.IsAtEnd(); ++it)
+  {
+    const auto index = it.GetIndex();
+    TestMetric::GradientType gradient;
+    metric->EvaluateMovingImageCentralDifference(index, gradient);
+
+    const auto expectedGradient = gradientImage->GetPixel(index);
+    const double tolerance = 1e-12 * (1.0 + expectedGradient.GetNorm());
+    for (unsigned int i = 0; i < 2; ++i)
+    {
+      EXPECT_NEAR(gradient[i], expectedGradient[i], tolerance) << "at index " << index;
+    }
+
+    for (unsigned int i = 0; i < 2; ++i)
+    {
+      if (index[i] == region.GetIndex()[i] ||
+        index[i] == region.GetIndex()[i] + static_cast<itk::IndexValueType>(region.GetSize()[i]) - 1)
+      {
+        ++numberOfBoundaryVoxels;
+        break;
+      }
+    }
+  }
+  EXPECT_EQ(numberOfBoundaryVoxels, 2u * (17u + 14u) - 4u);
+}
+
+
+// Without B-spline interpolator, the reduced memory image model only replaces
+// the precomputed gradient image by the on-the-fly central difference.
+GTEST_TEST(AdvancedImageToImageMetric, ReducedMemoryImageModelEqualsGradientImage)
+{
+  Expect_reduced_memory_image_model_gives_same_value_and_derivative<
+    itk::LinearInterpolateImageFunction<ImageType, double>>(1e-10);
+}
+
+
+// With a B-spline interpolator, the reduced memory image model stores the
+// coefficients in float, which only adds rounding errors.
+GTEST_TEST(AdvancedImageToImageMetric, ReducedMemoryImageModelEqualsDoubleBSplineCoefficients)
+{
+  Expect_reduced_memory_image_model_gives_same_value_and_derivative<
+    itk::BSplineInterpolateImageFunction<ImageType, double, double>>(1e-4);
+}
@@ -0,0 +1,302 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+ // First include the header file to be tested:
+#include "itkConcurrentCostFunctionEvaluator.h"
+
+#include "itkScaledSingleValuedNonLinearOptimizer.h"
+
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+  using EvaluatorType = itk::ConcurrentCostFunctionEvaluator;
+  using ParametersType = EvaluatorType::ParametersType;
+  using ParametersListType = EvaluatorType::ParametersListType;
+  using MeasureListType = EvaluatorType::MeasureListType;
+
+  // Counts the evaluations that run at the same time, shared by all copies.
+  struct ActivityCounter
+  {
+    std::atomic<int> m_Active{ 0 };
+    std::atomic<int> m_MaximumActive{ 0 };
+  };
+
+
+  // A weighted sum of squares, that fails for a negative first parameter.
+  class QuadraticCostFunction : public itk::SingleValuedCostFunction
+  {
+  public:
+    using Self = QuadraticCostFunction;
+    using Pointer = itk::SmartPointer<Self>;
+
+    itkNewMacro(Self);
+
+    ActivityCounter* m_Counter = nullptr;
+    unsigned int m_SleepMilliseconds = 0;
+
+    MeasureType GetValue(const ParametersType& parameters) const override
+    {
+      if (m_Counter != nullptr)
+      {
+        const int active = ++m_Counter->m_Active;
+        int maximumActive = m_Counter->m_MaximumActive;
+        while (active > maximumActive &&
+          !m_Counter->m_MaximumActive.compare_exchange_weak(maximumActive, active))
+        {
+        }
+      }
+      if (m_SleepMilliseconds > 0)
+      {
+        std::this_thread::sleep_for(std::chrono::milliseconds(m_SleepMilliseconds));
+      }
+      if (m_Counter != nullptr)
+      {
+        --m_Counter->m_Active;
+      }
+
+      if (parameters[0] < 0.0)
+      {
+        itkExceptionMacro("Negative first parameter: " << parameters[0]);
+      }
+      MeasureType value = 0.0;
+      for (unsigned int i = 0; i < parameters.GetSize(); ++i)
+      {
+        value += (i + 1.0) * (parameters[i] - 0.5) * (parameters[i] - 0.5);
+      }
+      return value;
+    }
+
+    void GetDerivative(const ParametersType&, DerivativeType&) const override
+    {
+      itkExceptionMacro("Not implemented");
+    }
+
+    unsigned int GetNumberOfParameters() const override
+    {
+      return 3;
+    }
+  };
+
+
+  // Exposes the batched evaluation of the optimizer.
+  class TestOptimizer : public itk::ScaledSingleValuedNonLinearOptimizer
+  {
+  public:
+    using Self = TestOptimizer;
+    using Pointer = itk::SmartPointer<Self>;
+
+    itkNewMacro(Self);
+
+    using itk::ScaledSingleValuedNonLinearOptimizer::GetScaledValue;
+    using itk::ScaledSingleValuedNonLinearOptimizer::GetScaledValues;
+  };
+
+
+  ParametersListType CreateRandomPositions(const std::size_t numberOfPositions, const unsigned int seed)
+  {
+    std::mt19937 randomNumberEngine(seed);
+    std::uniform_real_distribution<double> distribution(0.0, 2.0);
+    ParametersListType positions(numberOfPositions, ParametersType(3));
+    for (auto& position : positions)
+    {
+      for (unsigned int i = 0; i < 3; ++i)
+      {
+        position[i] = distribution(randomNumberEngine);
+      }
+    }
+    return positions;
+  }
+
+
+  EvaluatorType::Pointer CreateEvaluator(const unsigned int numberOfContexts,
+    ActivityCounter* counter = nullptr, const unsigned int sleepMilliseconds = 0)
+  {
+    const auto evaluator = EvaluatorType::New();
+    for (unsigned int i = 0; i <= numberOfContexts; ++i)
+    {
+      const auto costFunction = QuadraticCostFunction::New();
+      costFunction->m_Counter = counter;
+      costFunction->m_SleepMilliseconds = sleepMilliseconds;
+      if (i == 0)
+      {
+        evaluator->SetCostFunction(costFunction);
+      }
+      else
+      {
+        evaluator->AddContext(costFunction);
+      }
+    }
+    return evaluator;
+  }
+}
+
+
+GTEST_TEST(ConcurrentCostFunctionEvaluator, ValuesAreIndependentOfTheNumberOfContexts)
+{
+  const auto positions = CreateRandomPositions(25, 1);
+  const auto costFunction = QuadraticCostFunction::New();
+
+  for (const unsigned int numberOfContexts : { 0u, 1u, 3u, 7u })
+  {
+    const auto evaluator = CreateEvaluator(numberOfContexts);
+    EXPECT_EQ(evaluator->GetNumberOfContexts(), numberOfContexts);
+
+    MeasureListType values;
+    evaluator->GetValues(positions, values);
+    ASSERT_EQ(values.size(), positions.size());
+    for (std::size_t i = 0; i < positions.size(); ++i)
+    {
+      EXPECT_EQ(values[i], costFunction->GetValue(positions[i]));
+    }
+  }
+}
+
+
+GTEST_TEST(ConcurrentCostFunctionEvaluator, FailedEvaluationsAreReportedPerPosition)
+{
+  auto positions = CreateRandomPositions(10, 2);
+  positions[3][0] = -1.0;
+  positions[6][0] = -2.0;
+
+  const auto evaluator = CreateEvaluator(3);
+  MeasureListType values;
+  EvaluatorType::EvaluationStatusListType succeeded;
+  EvaluatorType::ExceptionListType errors;
+  evaluator->GetValues(positions, values, succeeded, errors);
+
+  ASSERT_EQ(succeeded.size(), positions.size());
+  ASSERT_EQ(errors.size(), positions.size());
+  for (std::size_t i = 0; i < positions.size(); ++i)
+  {
+    const bool shouldFail = (i == 3) || (i == 6);
+    EXPECT_EQ(succeeded[i] == 0, shouldFail);
+    if (shouldFail)
+    {
+      EXPECT_NE(std::string(errors[i].GetDescription()).find("Negative first parameter"), std::string::npos);
+    }
+  }
+
+  // The throwing overload passes the error of the first failed position.
+  try
+  {
+    evaluator->GetValues(positions, values);
+    FAIL() << "GetValues should have thrown an exception";
+  }
+  catch (const itk::ExceptionObject& excp)
+  {
+    EXPECT_NE(std::string(excp.GetDescription()).find(": -1"), std::string::npos);
+  }
+}
+
+
+GTEST_TEST(ConcurrentCostFunctionEvaluator, ContextsAreEvaluatedConcurrently)
+{
+  const auto positions = CreateRandomPositions(16, 3);
+
+  ActivityCounter sequentialCounter;
+  MeasureListType values;
+  CreateEvaluator(0, &sequentialCounter, 5)->GetValues(positions, values);
+  EXPECT_EQ(sequentialCounter.m_MaximumActive, 1);
+
+  ActivityCounter concurrentCounter;
+  CreateEvaluator(3, &concurrentCounter, 5)->GetValues(positions, values);
+  EXPECT_GT(concurrentCounter.m_MaximumActive, 1);
+  EXPECT_LE(concurrentCounter.m_MaximumActive, 4);
+}
+
+
+// Without evaluating the first position first, also a batch of two positions
+// (one perturbation of SimultaneousPerturbation) is evaluated concurrently.
+GTEST_TEST(ConcurrentCostFunctionEvaluator, TwoPositionsAreEvaluatedConcurrentlyWithoutFirstPositionFirst)
+{
+  const auto positions = CreateRandomPositions(2, 5);
+  const auto costFunction = QuadraticCostFunction::New();
+
+  ActivityCounter firstPositionFirstCounter;
+  const auto firstPositionFirstEvaluator = CreateEvaluator(1, &firstPositionFirstCounter, 20);
+  EXPECT_TRUE(firstPositionFirstEvaluator->GetEvaluateFirstPositionFirst());
+  MeasureListType values;
+  firstPositionFirstEvaluator->GetValues(positions, values);
+  EXPECT_EQ(firstPositionFirstCounter.m_MaximumActive, 1);
+
+  ActivityCounter concurrentCounter;
+  const auto concurrentEvaluator = CreateEvaluator(1, &concurrentCounter, 20);
+  concurrentEvaluator->EvaluateFirstPositionFirstOff();
+  concurrentEvaluator->GetValues(positions, values);
+  EXPECT_EQ(concurrentCounter.m_MaximumActive, 2);
+  ASSERT_EQ(values.size(), positions.size());
+  for (std::size_t i = 0; i < positions.size(); ++i)
+  {
+    EXPECT_EQ(values[i], costFunction->GetValue(positions[i]));
+  }
+}
+
+
+GTEST_TEST(ScaledSingleValuedNonLinearOptimizer, ConcurrentValuesEqualSequentialValuesWithScales)
+{
+  const auto positions = CreateRandomPositions(13, 4);
+
+  TestOptimizer::ScalesType scales(3);
+  scales[0] = 4.0;
+  scales[1] = 0.25;
+  scales[2] = 100.0;
+
+  const auto optimizer = TestOptimizer::New();
+  optimizer->SetCostFunction(QuadraticCostFunction::New());
+  optimizer->SetScales(scales);
+  optimizer->SetUseScales(true);
+  optimizer->InitializeScales();
+
+  MeasureListType sequentialValues;
+  optimizer->GetScaledValues(positions, sequentialValues);
+  for (std::size_t i = 0; i < positions.size(); ++i)
+  {
+    EXPECT_EQ(sequentialValues[i], optimizer->GetScaledValue(positions[i]));
+  }
+
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    optimizer->AddCostFunctionContext(QuadraticCostFunction::New());
+  }
+  EXPECT_EQ(optimizer->GetNumberOfCostFunctionContexts(), 3u);
+
+  MeasureListType concurrentValues;
+  optimizer->GetScaledValues(positions, concurrentValues);
+  EXPECT_EQ(concurrentValues, sequentialValues);
+
+  // Contexts follow later changes of the scales and the maximize flag.
+  scales[1] = 9.0;
+  optimizer->SetScales(scales);
+  optimizer->InitializeScales();
+  optimizer->MaximizeOn();
+  optimizer->GetScaledValues(positions, concurrentValues);
+  for (std::size_t i = 0; i < positions.size(); ++i)
+  {
+    EXPECT_EQ(concurrentValues[i], optimizer->GetScaledValue(positions[i]));
+  }
+
+  optimizer->RemoveCostFunctionContexts();
+  EXPECT_EQ(optimizer->GetNumberOfCostFunctionContexts(), 0u);
+}
@@ -0,0 +1,143 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+ // First include the header file to be tested:
+#include "itkConvergenceMonitor.h"
+
+#include <cmath>
+#include <random>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+  using VectorType = itk::ConvergenceMonitor::VectorType;
+
+  // Runs a one-parameter optimization of f(p) = value(p), with the given
+  // values per iteration, and returns the iteration at which the monitor
+  // reported convergence, or 0 when it did not.
+  template <typename TValueFunction>
+  unsigned long RunMonitor(itk::ConvergenceMonitor& monitor,
+    const unsigned long numberOfIterations, TValueFunction valueFunction)
+  {
+    monitor.Initialize();
+    VectorType gradient(1);
+    VectorType parameters(1);
+    for (unsigned long k = 0; k < numberOfIterations; ++k)
+    {
+      double value = 0.0;
+      valueFunction(k, value, gradient[0], parameters[0]);
+      if (monitor.Update(value, gradient, parameters))
+      {
+        return monitor.GetNumberOfIterations();
+      }
+    }
+    return 0;
+  }
+}
+
+
+GTEST_TEST(ConvergenceMonitor, SteadyDecreaseDoesNotConverge)
+{
+  itk::ConvergenceMonitor monitor;
+  monitor.SetWindowSize(10);
+
+  const auto iteration = RunMonitor(monitor, 1000,
+    [](const unsigned long k, double& value, double& gradient, double& parameter)
+  {
+    value = 1000.0 - static_cast<double>(k);
+    gradient = 1.0;
+    parameter = static_cast<double>(k);
+  });
+  EXPECT_EQ(iteration, 0);
+  EXPECT_FALSE(monitor.GetConverged());
+}
+
+
+GTEST_TEST(ConvergenceMonitor, ConvergedValueIsDetectedAtTheEndOfAWindow)
+{
+  itk::ConvergenceMonitor monitor;
+  monitor.SetWindowSize(10);
+
+  // Converges exponentially, so that value, gradient and parameters stall
+  // within the second window. The third window is the first whose mean value
+  // did not decrease with respect to the previous window.
+  const auto iteration = RunMonitor(monitor, 1000,
+    [](const unsigned long k, double& value, double& gradient, double& parameter)
+  {
+    const double decay = std::exp(-static_cast<double>(k));
+    value = 1.0 + decay;
+    gradient = decay;
+    parameter = 1.0 - decay;
+  });
+  EXPECT_EQ(iteration, 30);
+  EXPECT_TRUE(monitor.GetConverged());
+  EXPECT_FALSE(monitor.GetStopConditionDescription().empty());
+}
+
+
+GTEST_TEST(ConvergenceMonitor, NoisyConstantValueConvergesWhenStochastic)
+{
+  itk::ConvergenceMonitor monitor;
+  monitor.SetWindowSize(50);
+  monitor.SetStochastic(true);
+
+  std::mt19937 randomGenerator(1);
+  std::normal_distribution<double> noise(0.0, 0.1);
+  const auto iteration = RunMonitor(monitor, 10000,
+    [&randomGenerator, &noise](const unsigned long, double& value, double& gradient, double& parameter)
+  {
+    value = 1.0 + noise(randomGenerator);
+    gradient = noise(randomGenerator);
+    parameter = 0.01 * noise(randomGenerator);
+  });
+  EXPECT_GT(iteration, 0);
+  EXPECT_TRUE(monitor.GetConverged());
+
+  // Without taking the noise into account, the optimization goes on.
+  monitor.SetStochastic(false);
+  randomGenerator.seed(1);
+  const auto deterministicIteration = RunMonitor(monitor, 10000,
+    [&randomGenerator, &noise](const unsigned long, double& value, double& gradient, double& parameter)
+  {
+    value = 1.0 + noise(randomGenerator);
+    gradient = noise(randomGenerator);
+    parameter = 0.01 * noise(randomGenerator);
+  });
+  EXPECT_TRUE(deterministicIteration == 0 || deterministicIteration > iteration);
+}
+
+
+GTEST_TEST(ConvergenceMonitor, NoisySteadyDecreaseDoesNotConverge)
+{
+  itk::ConvergenceMonitor monitor;
+  monitor.SetWindowSize(50);
+  monitor.SetStochastic(true);
+
+  std::mt19937 randomGenerator(2);
+  std::normal_distribution<double> noise(0.0, 0.1);
+  const auto iteration = RunMonitor(monitor, 5000,
+    [&randomGenerator, &noise](const unsigned long k, double& value, double& gradient, double& parameter)
+  {
+    value = 100.0 - 0.01 * static_cast<double>(k) + noise(randomGenerator);
+    gradient = 1.0 + noise(randomGenerator);
+    parameter = 0.01 * static_cast<double>(k);
+  });
+  EXPECT_EQ(iteration, 0);
+}
@@ -0,0 +1,117 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+ // First include the header file to be tested:
+#include "itkHotPathProfiler.h"
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+  using ProfilerType = itk::HotPathProfiler;
+}
+
+
+GTEST_TEST(HotPathProfiler, CountsOfAllThreadsAreSummed)
+{
+  const unsigned int numberOfThreads = 8;
+  const unsigned int countsPerThread = 1000;
+
+  const ProfilerType::SnapshotType before = ProfilerType::GetSnapshot();
+
+  std::vector<std::thread> threads;
+  for (unsigned int t = 0; t < numberOfThreads; ++t)
+  {
+    threads.emplace_back([]
+    {
+      for (unsigned int i = 0; i < countsPerThread; ++i)
+      {
+        ProfilerType::AddCount(ProfilerType::SamplesDrawnCounter, 1);
+        ProfilerType::AddCount(ProfilerType::JacobianEvaluationsCounter, 2);
+      }
+    });
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  // The counts of finished threads are kept.
+  const ProfilerType::SnapshotType difference = ProfilerType::GetSnapshot() - before;
+  EXPECT_EQ(difference.m_Counts[ProfilerType::SamplesDrawnCounter], numberOfThreads * countsPerThread);
+  EXPECT_EQ(difference.m_Counts[ProfilerType::JacobianEvaluationsCounter], 2 * numberOfThreads * countsPerThread);
+  EXPECT_EQ(difference.m_Counts[ProfilerType::SamplesInsideMaskCounter], 0u);
+}
+
+
+GTEST_TEST(HotPathProfiler, ScopedTimerAddsItsTimeOnce)
+{
+  const ProfilerType::SnapshotType before = ProfilerType::GetSnapshot();
+  {
+    itk::HotPathScopedTimer timer(ProfilerType::LoggingPhase);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    timer.Stop();
+
+    // Neither a second Stop(), nor the destructor adds time again.
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    timer.Stop();
+  }
+  const ProfilerType::SnapshotType difference = ProfilerType::GetSnapshot() - before;
+
+  EXPECT_GE(difference.m_Seconds[ProfilerType::LoggingPhase], 0.020);
+  EXPECT_LT(difference.m_Seconds[ProfilerType::LoggingPhase], 0.200);
+  EXPECT_EQ(difference.m_Seconds[ProfilerType::SamplerPhase], 0.0);
+}
+
+
+GTEST_TEST(HotPathProfiler, AddTimeIsConvertedToSeconds)
+{
+  const ProfilerType::SnapshotType before = ProfilerType::GetSnapshot();
+  ProfilerType::AddTime(ProfilerType::OptimizerUpdatePhase, 1500000000u);
+  const ProfilerType::SnapshotType difference = ProfilerType::GetSnapshot() - before;
+
+  EXPECT_DOUBLE_EQ(difference.m_Seconds[ProfilerType::OptimizerUpdatePhase], 1.5);
+}
+
+
+GTEST_TEST(HotPathProfiler, NamesAreUnique)
+{
+  std::vector<std::string> names;
+  for (unsigned int i = 0; i < ProfilerType::NumberOfPhases; ++i)
+  {
+    names.push_back(ProfilerType::GetPhaseName(static_cast<ProfilerType::PhaseType>(i)));
+  }
+  for (unsigned int i = 0; i < ProfilerType::NumberOfCounters; ++i)
+  {
+    names.push_back(ProfilerType::GetCounterName(static_cast<ProfilerType::CounterType>(i)));
+  }
+  for (std::size_t i = 0; i < names.size(); ++i)
+  {
+    EXPECT_NE(names[i], "Unknown");
+    for (std::size_t j = 0; j < i; ++j)
+    {
+      EXPECT_NE(names[i], names[j]);
+    }
+  }
+}
@@ -0,0 +1,177 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+ // First include the header file to be tested:
+#include "itkImageSampleGrid.h"
+
+#include "itkImageFullSampler.h"
+#include "itkImageGridSampler.h"
+
+#include <itkImage.h>
+#include <itkImageMaskSpatialObject.h>
+#include <itkImageRegionIteratorWithIndex.h>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+  using MaskPixelType = unsigned char;
+
+  template <typename TImage>
+  typename TImage::Pointer CreateImage(const typename TImage::SizeType& imageSize)
+  {
+    const auto image = TImage::New();
+    image->SetRegions(imageSize);
+    image->Allocate();
+
+    // A non-trivial geometry, to test the incremental computation of the points.
+    typename TImage::SpacingType spacing;
+    typename TImage::PointType origin;
+    for (unsigned int d = 0; d < TImage::ImageDimension; ++d)
+    {
+      spacing[d] = 0.5 + d;
+      origin[d] = -1.25 * d;
+    }
+    typename TImage::DirectionType direction;
+    direction.SetIdentity();
+    direction[0][0] = 0.6;
+    direction[0][1] = -0.8;
+    direction[1][0] = 0.8;
+    direction[1][1] = 0.6;
+    image->SetSpacing(spacing);
+    image->SetOrigin(origin);
+    image->SetDirection(direction);
+
+    const auto numberOfPixels = image->GetLargestPossibleRegion().GetNumberOfPixels();
+    for (std::size_t i = 0; i < numberOfPixels; ++i)
+    {
+      image->GetBufferPointer()[i] = static_cast<typename TImage::PixelType>(i);
+    }
+    return image;
+  }
+
+
+  template <typename TImage>
+  typename itk::ImageMaskSpatialObject<TImage::ImageDimension>::Pointer CreateSphereMask(const TImage& image)
+  {
+    constexpr auto ImageDimension = TImage::ImageDimension;
+    const auto maskImage = itk::Image<MaskPixelType, ImageDimension>::New();
+    maskImage->CopyInformation(&image);
+    maskImage->SetRegions(image.GetLargestPossibleRegion());
+    maskImage->Allocate(true);
+
+    const auto size = image.GetLargestPossibleRegion().GetSize();
+    itk::ImageRegionIteratorWithIndex<itk::Image<MaskPixelType, ImageDimension>> it(maskImage, maskImage->GetLargestPossibleRegion());
+    for (; !it.IsAtEnd(); ++it)
+    {
+      double distance = 0.0;
+      for (unsigned int d = 0; d < ImageDimension; ++d)
+      {
+        const double r = (it.GetIndex()[d] - 0.5 * size[d]) / (0.4 * size[d]);
+        distance += r * r;
+      }
+      it.Set(distance < 1.0 ? 1 : 0);
+    }
+
+    const auto mask = itk::ImageMaskSpatialObject<ImageDimension>::New();
+    mask->SetImage(maskImage);
+    mask->Update();
+    return mask;
+  }
+
+
+  // Expects the lazily generated samples to be equal to the stored ones.
+  template <typename TSampler>
+  void Expect_lazy_samples_equal_to_stored_samples(TSampler& sampler)
+  {
+    sampler.SetUseLazySampling(false);
+    sampler.Update();
+    const auto storedSamples = sampler.GetOutput()->CastToSTLContainer();
+    ASSERT_FALSE(storedSamples.empty());
+
+    sampler.SetUseLazySampling(true);
+    sampler.Update();
+    ASSERT_TRUE(sampler.IsLazySamplingUsed());
+    EXPECT_TRUE(sampler.GetOutput()->CastToSTLContainer().empty());
+
+    const auto& grid = sampler.GetSampleGrid();
+    ASSERT_EQ(grid.GetNumberOfSamples(), storedSamples.size());
+
+    const auto numberOfGridPoints = grid.GetNumberOfGridPoints();
+    std::size_t i = 0;
+    for (auto it = grid.Begin(0, numberOfGridPoints); it != grid.End(numberOfGridPoints); ++it, ++i)
+    {
+      ASSERT_LT(i, storedSamples.size());
+      EXPECT_EQ((*it).Value().m_ImageValue, storedSamples[i].m_ImageValue);
+      for (unsigned int d = 0; d < TSampler::InputImageDimension; ++d)
+      {
+        EXPECT_NEAR((*it).Value().m_ImageCoordinates[d], storedSamples[i].m_ImageCoordinates[d], 1e-9);
+      }
+    }
+    EXPECT_EQ(i, storedSamples.size());
+
+    // Iterating over chunks must yield the same number of samples.
+    std::size_t numberOfSamplesInChunks = 0;
+    const std::size_t numberOfChunks = 7;
+    for (std::size_t chunk = 0; chunk < numberOfChunks; ++chunk)
+    {
+      const auto begin = chunk * numberOfGridPoints / numberOfChunks;
+      const auto end = (chunk + 1) * numberOfGridPoints / numberOfChunks;
+      for (auto it = grid.Begin(begin, end); it != grid.End(end); ++it)
+      {
+        ++numberOfSamplesInChunks;
+      }
+    }
+    EXPECT_EQ(numberOfSamplesInChunks, storedSamples.size());
+  }
+
+} // End of namespace.
+
+
+GTEST_TEST(ImageSampleGrid, FullSamplerLazyEqualsStored)
+{
+  using ImageType = itk::Image<float, 3>;
+  const auto image = CreateImage<ImageType>({ {9, 8, 7} });
+
+  const auto sampler = itk::ImageFullSampler<ImageType>::New();
+  sampler->SetInput(image);
+  Expect_lazy_samples_equal_to_stored_samples(*sampler);
+
+  sampler->SetMask(CreateSphereMask(*image));
+  Expect_lazy_samples_equal_to_stored_samples(*sampler);
+}
+
+
+GTEST_TEST(ImageSampleGrid, GridSamplerLazyEqualsStored)
+{
+  using ImageType = itk::Image<float, 3>;
+  const auto image = CreateImage<ImageType>({ {11, 10, 9} });
+
+  const auto sampler = itk::ImageGridSampler<ImageType>::New();
+  sampler->SetInput(image);
+  itk::ImageGridSampler<ImageType>::SampleGridSpacingType gridSpacing;
+  gridSpacing[0] = 2;
+  gridSpacing[1] = 3;
+  gridSpacing[2] = 1;
+  sampler->SetSampleGridSpacing(gridSpacing);
+  Expect_lazy_samples_equal_to_stored_samples(*sampler);
+
+  sampler->SetMask(CreateSphereMask(*image));
+  Expect_lazy_samples_equal_to_stored_samples(*sampler);
+}
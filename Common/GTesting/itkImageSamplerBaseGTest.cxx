@@ -0,0 +1,164 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+ // First include the header file to be tested:
+#include "itkImageSamplerBase.h"
+
+#include "itkImageFullSampler.h"
+#include "itkImageRandomSampler.h"
+
+#include <itkImage.h>
+#include <itkMersenneTwisterRandomVariateGenerator.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <set>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+  using ImageType = itk::Image<float, 3>;
+  using SamplerBaseType = itk::ImageSamplerBase<ImageType>;
+  using SampleVectorType = SamplerBaseType::ImageSampleContainerType::STLContainerType;
+  using CellType = std::array<long, 3>;
+
+  ImageType::Pointer CreateImage()
+  {
+    const auto image = ImageType::New();
+    image->SetRegions(ImageType::SizeType{ {20, 24, 16} });
+    image->Allocate();
+
+    const auto numberOfPixels = image->GetLargestPossibleRegion().GetNumberOfPixels();
+    for (std::size_t i = 0; i < numberOfPixels; ++i)
+    {
+      image->GetBufferPointer()[i] = static_cast<float>(i);
+    }
+    return image;
+  }
+
+
+  // A grid like that of a B-spline transform: the origin is outside the image.
+  void SetSampleOrderGrid(SamplerBaseType& sampler)
+  {
+    ImageType::PointType origin;
+    ImageType::SpacingType spacing;
+    for (unsigned int d = 0; d < 3; ++d)
+    {
+      origin[d] = -3.5;
+      spacing[d] = 5.0;
+    }
+    ImageType::DirectionType direction;
+    direction.SetIdentity();
+    sampler.SetSampleOrderGrid(origin, spacing, direction);
+  }
+
+
+  CellType GetCell(const SamplerBaseType::ImageSampleType& sample)
+  {
+    CellType cell;
+    for (unsigned int d = 0; d < 3; ++d)
+    {
+      cell[d] = static_cast<long>(std::floor((sample.m_ImageCoordinates[d] + 3.5) / 5.0));
+    }
+    return cell;
+  }
+
+
+  // Sorts samples by their coordinates, to compare sets of samples.
+  SampleVectorType SortByCoordinates(SampleVectorType samples)
+  {
+    std::sort(samples.begin(), samples.end(), [](const SamplerBaseType::ImageSampleType& a, const SamplerBaseType::ImageSampleType& b)
+      {
+        return std::lexicographical_compare(a.m_ImageCoordinates.Begin(), a.m_ImageCoordinates.End(),
+          b.m_ImageCoordinates.Begin(), b.m_ImageCoordinates.End());
+      });
+    return samples;
+  }
+
+
+  void Expect_equal_samples(const SampleVectorType& samples1, const SampleVectorType& samples2)
+  {
+    ASSERT_EQ(samples1.size(), samples2.size());
+    for (std::size_t i = 0; i < samples1.size(); ++i)
+    {
+      EXPECT_EQ(samples1[i].m_ImageCoordinates, samples2[i].m_ImageCoordinates);
+      EXPECT_EQ(samples1[i].m_ImageValue, samples2[i].m_ImageValue);
+    }
+  }
+}
+
+
+GTEST_TEST(ImageSamplerBase, SortingByGridCellMakesTheSamplesOfACellConsecutive)
+{
+  const auto sampler = itk::ImageFullSampler<ImageType>::New();
+  sampler->SetInput(CreateImage());
+  SetSampleOrderGrid(*sampler);
+  sampler->Update();
+  const SampleVectorType unsortedSamples = sampler->GetOutput()->CastToSTLContainer();
+
+  sampler->SortSamplesByGridCellOn();
+  sampler->Update();
+  const SampleVectorType sortedSamples = sampler->GetOutput()->CastToSTLContainer();
+
+  // The samples are the same, only their order differs.
+  Expect_equal_samples(SortByCoordinates(sortedSamples), SortByCoordinates(unsortedSamples));
+
+  // Once a cell is left, it is never visited again.
+  std::set<CellType> finishedCells;
+  for (std::size_t i = 1; i < sortedSamples.size(); ++i)
+  {
+    const CellType previousCell = GetCell(sortedSamples[i - 1]);
+    const CellType cell = GetCell(sortedSamples[i]);
+    if (cell != previousCell)
+    {
+      finishedCells.insert(previousCell);
+      EXPECT_EQ(finishedCells.count(cell), 0u);
+    }
+  }
+  EXPECT_GT(finishedCells.size(), 1u);
+}
+
+
+GTEST_TEST(ImageSamplerBase, SortingByGridCellKeepsTheRandomSamples)
+{
+  const auto generator = itk::Statistics::MersenneTwisterRandomVariateGenerator::GetInstance();
+  const auto sampler = itk::ImageRandomSampler<ImageType>::New();
+  sampler->SetInput(CreateImage());
+  sampler->SetNumberOfSamples(2000);
+  SetSampleOrderGrid(*sampler);
+
+  generator->Initialize(121212);
+  sampler->Update();
+  const SampleVectorType unsortedSamples = sampler->GetOutput()->CastToSTLContainer();
+
+  sampler->SortSamplesByGridCellOn();
+  generator->Initialize(121212);
+  sampler->Update();
+  const SampleVectorType sortedSamples = sampler->GetOutput()->CastToSTLContainer();
+
+  Expect_equal_samples(SortByCoordinates(sortedSamples), SortByCoordinates(unsortedSamples));
+
+  // Without a grid, the samples are not sorted.
+  sampler->RemoveSampleOrderGrid();
+  generator->Initialize(121212);
+  sampler->Update();
+  Expect_equal_samples(sampler->GetOutput()->CastToSTLContainer(), unsortedSamples);
+}
@@ -0,0 +1,115 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+ // First include the header file to be tested:
+#include "itkMemoryMappedFile.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+  const char* const fileName = "itkMemoryMappedFileGTest.dat";
+
+  std::vector<double> ReadDoubles(const char* const name)
+  {
+    std::ifstream file(name, std::ios::binary);
+    std::vector<double> values;
+    double value = 0.0;
+    while (file.read(reinterpret_cast<char*>(&value), sizeof(value)))
+    {
+      values.push_back(value);
+    }
+    return values;
+  }
+}
+
+
+GTEST_TEST(MemoryMappedFile, MapsTheContentOfTheFile)
+{
+  const std::vector<double> values{ 1.5, -2.0, 3.25, 1e300 };
+  {
+    std::ofstream file(fileName, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(double));
+  }
+
+  itk::MemoryMappedFile mappedFile;
+  EXPECT_EQ(mappedFile.GetPointer(), nullptr);
+  ASSERT_TRUE(mappedFile.Map(fileName));
+  ASSERT_NE(mappedFile.GetPointer(), nullptr);
+  ASSERT_EQ(mappedFile.GetSize(), values.size() * sizeof(double));
+
+  double* const data = static_cast<double*>(mappedFile.GetPointer());
+  EXPECT_EQ(std::vector<double>(data, data + values.size()), values);
+
+  // The mapping is copy-on-write: the file is not modified.
+  data[1] = 42.0;
+  EXPECT_EQ(data[1], 42.0);
+  mappedFile.Unmap();
+  EXPECT_EQ(mappedFile.GetPointer(), nullptr);
+  EXPECT_EQ(mappedFile.GetSize(), 0u);
+  EXPECT_EQ(ReadDoubles(fileName), values);
+
+  std::remove(fileName);
+}
+
+
+GTEST_TEST(MemoryMappedFile, MapFailsForEmptyOrMissingFiles)
+{
+  itk::MemoryMappedFile mappedFile;
+  {
+    std::ofstream file(fileName, std::ios::binary);
+  }
+  EXPECT_FALSE(mappedFile.Map(fileName));
+  EXPECT_EQ(mappedFile.GetPointer(), nullptr);
+  std::remove(fileName);
+
+  EXPECT_FALSE(mappedFile.Map("itkMemoryMappedFileGTest.missing"));
+  EXPECT_EQ(mappedFile.GetPointer(), nullptr);
+  EXPECT_EQ(mappedFile.GetSize(), 0u);
+}
+
+
+GTEST_TEST(MemoryMappedFile, MappingAnotherFileReplacesTheMapping)
+{
+  const char* const otherFileName = "itkMemoryMappedFileGTest.other.dat";
+  {
+    std::ofstream file(fileName, std::ios::binary);
+    file << "first";
+    std::ofstream otherFile(otherFileName, std::ios::binary);
+    otherFile << "second file";
+  }
+
+  itk::MemoryMappedFile mappedFile;
+  ASSERT_TRUE(mappedFile.Map(fileName));
+  EXPECT_EQ(std::string(static_cast<const char*>(mappedFile.GetPointer()), mappedFile.GetSize()), "first");
+  ASSERT_TRUE(mappedFile.Map(otherFileName));
+  EXPECT_EQ(std::string(static_cast<const char*>(mappedFile.GetPointer()), mappedFile.GetSize()), "second file");
+
+  // A failed mapping leaves no mapping behind.
+  EXPECT_FALSE(mappedFile.Map("itkMemoryMappedFileGTest.missing"));
+  EXPECT_EQ(mappedFile.GetPointer(), nullptr);
+
+  std::remove(fileName);
+  std::remove(otherFileName);
+}
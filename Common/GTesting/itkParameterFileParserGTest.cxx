@@ -0,0 +1,256 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+ // First include the header file to be tested:
+#include "itkParameterFileParser.h"
+
+#include "itkParameterMapInterface.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+  using ParserType = itk::ParameterFileParser;
+  using InterfaceType = itk::ParameterMapInterface;
+
+  const char* const parameterFileName = "itkParameterFileParserGTest.txt";
+
+  // Writes a parameter file with a long numeric parameter, in a variety of notations.
+  std::vector<std::string> WriteParameterFile(const std::size_t numberOfValues)
+  {
+    const char* const notations[] = { "1", "-2.5", "0.125", "1e-3", "-7.25E+2", "3.", ".5", "+4",
+      "0.10000000000000001", "123456789012345678901234567890" };
+    std::vector<std::string> values;
+    std::ofstream file(parameterFileName);
+    file << "(Transform \"BSplineTransform\")\n(NumberOfParameters " << numberOfValues << ")\n(TransformParameters";
+    for (std::size_t i = 0; i < numberOfValues; ++i)
+    {
+      values.push_back(notations[i % (sizeof(notations) / sizeof(notations[0]))]);
+      file << ((i % 7 == 0) ? "\t  " : " ") << values.back();
+    }
+    file << ")\n";
+    return values;
+  }
+
+
+  ParserType::Pointer ReadParameterFile(const std::size_t threshold, const bool useCache = false)
+  {
+    const auto parser = ParserType::New();
+    parser->SetParameterFileName(parameterFileName);
+    parser->SetNumericParameterThreshold(threshold);
+    parser->SetUseCache(useCache);
+    parser->ReadParameterFile();
+    return parser;
+  }
+}
+
+
+// Tests that a long numeric parameter is stored as numbers, and that it reads the same as when stored as strings.
+GTEST_TEST(ParameterFileParser, NumericParameterReadsLikeStrings)
+{
+  const std::size_t numberOfValues = 200000;
+  const auto values = WriteParameterFile(numberOfValues);
+
+  const auto stringParser = ReadParameterFile(0);
+  const auto numericParser = ReadParameterFile(1024);
+  std::remove(parameterFileName);
+
+  EXPECT_EQ(stringParser->GetNumericParameterMap().size(), 0u);
+  EXPECT_EQ(stringParser->GetParameterMap().at("TransformParameters"), values);
+  ASSERT_EQ(numericParser->GetNumericParameterMap().size(), 1u);
+  EXPECT_EQ(numericParser->GetParameterMap().count("TransformParameters"), 0u);
+  EXPECT_EQ(numericParser->GetParameterMap().at("Transform").front(), "BSplineTransform");
+  EXPECT_EQ(numericParser->GetParameterMap().at("NumberOfParameters").front(), std::to_string(numberOfValues));
+
+  const auto stringInterface = InterfaceType::New();
+  stringInterface->SetParameterMap(stringParser->GetParameterMap());
+  const auto numericInterface = InterfaceType::New();
+  numericInterface->SetParameterMap(numericParser->GetParameterMap());
+  numericInterface->SetNumericParameterMap(numericParser->GetNumericParameterMap());
+
+  EXPECT_EQ(numericInterface->CountNumberOfParameterEntries("TransformParameters"), numberOfValues);
+  EXPECT_EQ(stringInterface->GetNumericParameterValues("TransformParameters"), nullptr);
+
+  std::string errorMessage;
+  std::vector<double> expected(numberOfValues);
+  std::vector<double> actual(numberOfValues);
+  stringInterface->ReadParameter(expected, "TransformParameters", 0, numberOfValues - 1, true, errorMessage);
+  numericInterface->ReadParameter(actual, "TransformParameters", 0, numberOfValues - 1, true, errorMessage);
+  EXPECT_EQ(actual, expected);
+  EXPECT_EQ(*numericInterface->GetNumericParameterValues("TransformParameters"), expected);
+
+  float single = 0.0f;
+  EXPECT_TRUE(numericInterface->ReadParameter(single, "TransformParameters", 1, false, errorMessage));
+  EXPECT_EQ(single, -2.5f);
+
+  std::string text;
+  EXPECT_TRUE(numericInterface->ReadParameter(text, "TransformParameters", 4, false, errorMessage));
+  EXPECT_EQ(text, "-725");
+}
+
+
+// Tests that parameters with non-numeric values, or with fewer values than the threshold, are stored as strings.
+GTEST_TEST(ParameterFileParser, NonNumericParameterIsStoredAsStrings)
+{
+  {
+    std::ofstream file(parameterFileName);
+    file << "(Short 1 2 3)\n(Mixed";
+    for (unsigned int i = 0; i < 2000; ++i)
+    {
+      file << ' ' << i;
+    }
+    file << " nan)\n";
+  }
+  const auto parser = ReadParameterFile(1024);
+  std::remove(parameterFileName);
+
+  EXPECT_EQ(parser->GetNumericParameterMap().size(), 0u);
+  EXPECT_EQ(parser->GetParameterMap().at("Short").size(), 3u);
+  EXPECT_EQ(parser->GetParameterMap().at("Mixed").size(), 2001u);
+  EXPECT_EQ(parser->GetParameterMap().at("Mixed").back(), "nan");
+}
+
+
+// Tests that numbers are only read as integers when they can be represented exactly.
+GTEST_TEST(ParameterMapInterface, NumericCastDoesNotTruncate)
+{
+  const auto parameterMapInterface = InterfaceType::New();
+  parameterMapInterface->SetParameterMap({ { "Name", { "value" } } });
+  parameterMapInterface->SetNumericParameterMap({ { "Numbers", { 3.0, 2.5, -1.0, 1e10 } } });
+
+  std::string errorMessage;
+  int integer = 0;
+  EXPECT_TRUE(parameterMapInterface->ReadParameter(integer, "Numbers", 0, false, errorMessage));
+  EXPECT_EQ(integer, 3);
+  EXPECT_THROW(parameterMapInterface->ReadParameter(integer, "Numbers", 1, false, errorMessage),
+    itk::ExceptionObject);
+  EXPECT_EQ(integer, 3);
+  EXPECT_TRUE(parameterMapInterface->ReadParameter(integer, "Numbers", 2, false, errorMessage));
+  EXPECT_EQ(integer, -1);
+  EXPECT_THROW(parameterMapInterface->ReadParameter(integer, "Numbers", 3, false, errorMessage),
+    itk::ExceptionObject);
+
+  unsigned int unsignedInteger = 0;
+  EXPECT_THROW(parameterMapInterface->ReadParameter(unsignedInteger, "Numbers", 2, false, errorMessage),
+    itk::ExceptionObject);
+  long long longInteger = 0;
+  EXPECT_TRUE(parameterMapInterface->ReadParameter(longInteger, "Numbers", 3, false, errorMessage));
+  EXPECT_EQ(longInteger, 10000000000LL);
+
+  std::vector<int> integers(4);
+  EXPECT_THROW(parameterMapInterface->ReadParameter(integers, "Numbers", 0, 1, false, errorMessage),
+    itk::ExceptionObject);
+  std::vector<double> reals(4);
+  EXPECT_TRUE(parameterMapInterface->ReadParameter(reals, "Numbers", 0, 3, false, errorMessage));
+  EXPECT_EQ(reals[1], 2.5);
+}
+
+
+// Tests that setting a new parameter map removes the numbers of the previous one.
+GTEST_TEST(ParameterMapInterface, SetParameterMapClearsNumericParameterMap)
+{
+  const auto parameterMapInterface = InterfaceType::New();
+  parameterMapInterface->SetParameterMap({ { "Name", { "value" } } });
+  parameterMapInterface->SetNumericParameterMap({ { "TransformParameters", { 1.0, 2.0 } } });
+  EXPECT_EQ(parameterMapInterface->CountNumberOfParameterEntries("TransformParameters"), 2u);
+
+  parameterMapInterface->SetParameterMap({ { "TransformParameters", { "3", "4", "5" } } });
+  EXPECT_EQ(parameterMapInterface->GetNumericParameterValues("TransformParameters"), nullptr);
+  EXPECT_EQ(parameterMapInterface->CountNumberOfParameterEntries("TransformParameters"), 3u);
+
+  std::string errorMessage;
+  double value = 0.0;
+  EXPECT_TRUE(parameterMapInterface->ReadParameter(value, "TransformParameters", 0, false, errorMessage));
+  EXPECT_EQ(value, 3.0);
+}
+
+
+// Tests that the cache returns the parsed file, and that a changed file is parsed again.
+GTEST_TEST(ParameterFileParser, CacheIsUpdatedWhenFileChanges)
+{
+  ParserType::ClearCache();
+  {
+    std::ofstream file(parameterFileName);
+    file << "(Transform \"AffineTransform\")\n";
+  }
+  const auto parser = ParserType::New();
+  parser->SetParameterFileName(parameterFileName);
+  parser->SetUseCache(true);
+  parser->ReadParameterFile();
+  EXPECT_EQ(parser->GetParameterMap().at("Transform").front(), "AffineTransform");
+
+  const auto cachedParser = ParserType::New();
+  cachedParser->SetParameterFileName(parameterFileName);
+  cachedParser->UseCacheOn();
+  cachedParser->ReadParameterFile();
+  EXPECT_EQ(cachedParser->GetParameterMap(), parser->GetParameterMap());
+
+  {
+    std::ofstream file(parameterFileName);
+    file << "(Transform \"BSplineTransform\")\n";
+  }
+  cachedParser->ReadParameterFile();
+  std::remove(parameterFileName);
+  EXPECT_EQ(cachedParser->GetParameterMap().at("Transform").front(), "BSplineTransform");
+
+  ParserType::SetMaximumNumberOfCachedFiles(0);
+  EXPECT_EQ(ParserType::GetMaximumNumberOfCachedFiles(), 0u);
+  ParserType::SetMaximumNumberOfCachedFiles(16);
+  ParserType::ClearCache();
+}
+
+
+// Tests that a file that is rewritten with the same length is parsed again, and that a cache hit shares the numbers.
+GTEST_TEST(ParameterFileParser, CacheComparesTheContent)
+{
+  ParserType::ClearCache();
+  const auto writeParameterFile = [](const char* const value)
+  {
+    std::ofstream file(parameterFileName);
+    file << "(Value " << value << ")\n(TransformParameters";
+    for (unsigned int i = 0; i < 2000; ++i)
+    {
+      file << ' ' << i;
+    }
+    file << ")\n";
+  };
+
+  writeParameterFile("1");
+  const auto parser = ReadParameterFile(1024, true);
+  const auto cachedParser = ReadParameterFile(1024, true);
+  EXPECT_EQ(cachedParser->GetParameterMap().at("Value").front(), "1");
+  EXPECT_EQ(&cachedParser->GetNumericParameterMap(), &parser->GetNumericParameterMap());
+
+  // The modification time and the length of the file may be unchanged.
+  writeParameterFile("2");
+  cachedParser->ReadParameterFile();
+  EXPECT_EQ(cachedParser->GetParameterMap().at("Value").front(), "2");
+  EXPECT_NE(&cachedParser->GetNumericParameterMap(), &parser->GetNumericParameterMap());
+
+  // The numbers of the first parser are not affected by the second file.
+  EXPECT_EQ(parser->GetParameterMap().at("Value").front(), "1");
+  EXPECT_EQ(parser->GetNumericParameterMap().at("TransformParameters").size(), 2000u);
+  std::remove(parameterFileName);
+  ParserType::ClearCache();
+}
@@ -0,0 +1,166 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+ // First include the header file to be tested:
+#include "itkParameterVectorOperations.h"
+
+#include <atomic>
+#include <cmath>
+#include <random>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+  using Operations = itk::ParameterVectorOperations;
+  using VectorType = Operations::VectorType;
+
+  // Sizes below one block, of a few blocks, and large enough to be multi-threaded.
+  const std::size_t testSizes[] = { 0, 1, 7, 1000, 3 * Operations::BlockSize + 5, 2 * Operations::MinimumParallelSize + 3 };
+
+  VectorType CreateRandomVector(const std::size_t size, const unsigned int seed)
+  {
+    std::mt19937 randomNumberEngine(seed);
+    std::uniform_real_distribution<double> distribution(0.5, 2.0);
+    VectorType vector(static_cast<unsigned int>(size));
+    for (std::size_t i = 0; i < size; ++i)
+    {
+      vector[i] = distribution(randomNumberEngine);
+    }
+    return vector;
+  }
+
+
+  // A threader with the specified number of work units.
+  itk::MultiThreaderBase::Pointer CreateThreader(const itk::ThreadIdType numberOfWorkUnits)
+  {
+    const auto threader = itk::MultiThreaderBase::New();
+    threader->SetNumberOfWorkUnits(numberOfWorkUnits);
+    return threader;
+  }
+}
+
+
+GTEST_TEST(ParameterVectorOperations, ElementwiseOperationsEqualPlainLoops)
+{
+  const auto threader = CreateThreader(4);
+  for (const std::size_t size : testSizes)
+  {
+    const VectorType x = CreateRandomVector(size, 1);
+    const VectorType y = CreateRandomVector(size, 2);
+
+    VectorType axpy = y;
+    VectorType scale = y;
+    VectorType addScaled(static_cast<unsigned int>(size));
+    VectorType multiply = y;
+    VectorType divide = y;
+    Operations::Axpy(0.25, x, axpy, threader);
+    Operations::Scale(-3.0, scale, threader);
+    Operations::AddScaled(x, -0.5, y, addScaled, threader);
+    Operations::Multiply(x, multiply, threader);
+    Operations::Divide(x, divide, threader);
+
+    for (std::size_t i = 0; i < size; ++i)
+    {
+      EXPECT_DOUBLE_EQ(axpy[i], y[i] + 0.25 * x[i]);
+      EXPECT_DOUBLE_EQ(scale[i], -3.0 * y[i]);
+      EXPECT_DOUBLE_EQ(addScaled[i], x[i] + -0.5 * y[i]);
+      EXPECT_DOUBLE_EQ(multiply[i], y[i] * x[i]);
+      EXPECT_DOUBLE_EQ(divide[i], y[i] / x[i]);
+    }
+  }
+}
+
+
+GTEST_TEST(ParameterVectorOperations, AddScaledSupportsInPlaceUpdate)
+{
+  const auto threader = CreateThreader(4);
+  for (const std::size_t size : testSizes)
+  {
+    const VectorType gradient = CreateRandomVector(size, 3);
+    const VectorType currentPosition = CreateRandomVector(size, 4);
+
+    VectorType position = currentPosition;
+    Operations::AddScaled(position, -0.1, gradient, position, threader);
+
+    for (std::size_t i = 0; i < size; ++i)
+    {
+      EXPECT_DOUBLE_EQ(position[i], currentPosition[i] - 0.1 * gradient[i]);
+    }
+  }
+}
+
+
+GTEST_TEST(ParameterVectorOperations, ReductionsEqualPlainLoops)
+{
+  const auto threader = CreateThreader(4);
+  for (const std::size_t size : testSizes)
+  {
+    const VectorType x = CreateRandomVector(size, 5);
+    const VectorType y = CreateRandomVector(size, 6);
+
+    double dot = 0.0;
+    double squaredNorm = 0.0;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+      dot += x[i] * y[i];
+      squaredNorm += x[i] * x[i];
+    }
+
+    // The summation order differs from the plain loop.
+    const double tolerance = 1e-12 * (1.0 + static_cast<double>(size));
+    EXPECT_NEAR(Operations::Dot(x, y, threader), dot, tolerance * dot + 1e-300);
+    EXPECT_NEAR(Operations::SquaredNorm(x, threader), squaredNorm, tolerance * squaredNorm + 1e-300);
+    EXPECT_NEAR(Operations::Norm(x, threader), std::sqrt(squaredNorm), tolerance * std::sqrt(squaredNorm) + 1e-300);
+  }
+}
+
+
+GTEST_TEST(ParameterVectorOperations, ReductionsDoNotDependOnTheNumberOfWorkUnits)
+{
+  const std::size_t size = 3 * Operations::MinimumParallelSize + 11;
+  const VectorType x = CreateRandomVector(size, 7);
+  const VectorType y = CreateRandomVector(size, 8);
+
+  const double dotWithoutThreader = Operations::Dot(x, y);
+  for (const itk::ThreadIdType numberOfWorkUnits : { 1u, 3u, 4u })
+  {
+    EXPECT_EQ(Operations::Dot(x, y, CreateThreader(numberOfWorkUnits)), dotWithoutThreader)
+      << numberOfWorkUnits << " work units";
+  }
+}
+
+
+GTEST_TEST(ParameterVectorOperations, ParallelForUsesTheWorkUnitsOfTheThreader)
+{
+  const std::size_t size = 2 * Operations::MinimumParallelSize;
+  const auto countRanges = [size](itk::MultiThreaderBase* const threader)
+  {
+    std::atomic<unsigned int> numberOfRanges(0);
+    Operations::ParallelFor(size, [&numberOfRanges](const std::size_t, const std::size_t)
+      {
+        ++numberOfRanges;
+      }, threader);
+    return numberOfRanges.load();
+  };
+
+  EXPECT_EQ(countRanges(nullptr), 1u);
+  EXPECT_EQ(countRanges(CreateThreader(1)), 1u);
+  EXPECT_EQ(countRanges(CreateThreader(3)), 3u);
+}
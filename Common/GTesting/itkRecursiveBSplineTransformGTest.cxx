@@ -0,0 +1,148 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+ // First include the header file to be tested:
+#include "itkRecursiveBSplineTransform.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace
+{
+  template <unsigned int VSplineOrder>
+  typename itk::RecursiveBSplineTransform<double, 3, VSplineOrder>::Pointer CreateTransform()
+  {
+    using TransformType = itk::RecursiveBSplineTransform<double, 3, VSplineOrder>;
+    const auto transform = TransformType::New();
+
+    typename TransformType::RegionType gridRegion;
+    gridRegion.SetSize({ {8, 7, 6} });
+    typename TransformType::SpacingType gridSpacing;
+    typename TransformType::OriginType gridOrigin;
+    for (unsigned int d = 0; d < 3; ++d)
+    {
+      gridSpacing[d] = 4.0 + d;
+      gridOrigin[d] = -10.0 + 2.5 * d;
+    }
+    typename TransformType::DirectionType gridDirection;
+    gridDirection.SetIdentity();
+    gridDirection[0][0] = 0.6;
+    gridDirection[0][1] = -0.8;
+    gridDirection[1][0] = 0.8;
+    gridDirection[1][1] = 0.6;
+
+    transform->SetGridOrigin(gridOrigin);
+    transform->SetGridSpacing(gridSpacing);
+    transform->SetGridDirection(gridDirection);
+    transform->SetGridRegion(gridRegion);
+
+    typename TransformType::ParametersType parameters(transform->GetNumberOfParameters());
+    for (unsigned int i = 0; i < parameters.GetSize(); ++i)
+    {
+      parameters[i] = 0.01 * static_cast<double>((i * 37) % 101) - 0.5;
+    }
+    transform->SetParametersByValue(parameters);
+    return transform;
+  }
+
+
+  // Expects the methods that use precomputed sample weights to give the same
+  // results as the methods that compute the weights themselves.
+  template <unsigned int VSplineOrder>
+  void Expect_sample_weights_results_equal_to_direct_results()
+  {
+    using TransformType = itk::RecursiveBSplineTransform<double, 3, VSplineOrder>;
+    const auto transform = CreateTransform<VSplineOrder>();
+
+    const unsigned int numberOfWeights = transform->GetNumberOfSampleWeights();
+    ASSERT_EQ(numberOfWeights, (VSplineOrder + 1) * 3);
+
+    const auto nnzji = transform->GetNumberOfNonZeroJacobianIndices();
+    typename TransformType::MovingImageGradientType movingImageGradient;
+    movingImageGradient[0] = 0.3;
+    movingImageGradient[1] = -1.2;
+    movingImageGradient[2] = 0.7;
+
+    unsigned int numberOfInsidePoints = 0;
+    unsigned int numberOfOutsidePoints = 0;
+    for (double x = -20.0; x < 40.0; x += 3.7)
+    {
+      for (double y = -15.0; y < 35.0; y += 4.1)
+      {
+        typename TransformType::InputPointType point;
+        point[0] = x;
+        point[1] = y;
+        point[2] = 0.3 * x + 1.0;
+
+        std::vector<double> weights(numberOfWeights);
+        itk::OffsetValueType offset;
+        const bool inside = transform->ComputeSampleWeights(point, weights.data(), offset);
+        EXPECT_EQ(inside, offset >= 0);
+        inside ? ++numberOfInsidePoints : ++numberOfOutsidePoints;
+
+        const auto expectedPoint = transform->TransformPoint(point);
+        const auto cachedPoint = transform->TransformPointUsingSampleWeights(point, weights.data(), offset);
+        EXPECT_EQ(cachedPoint, expectedPoint);
+
+        typename TransformType::JacobianType expectedJacobian, cachedJacobian;
+        typename TransformType::NonZeroJacobianIndicesType expectedNzji, cachedNzji;
+        transform->GetJacobian(point, expectedJacobian, expectedNzji);
+        transform->GetJacobianUsingSampleWeights(weights.data(), offset, cachedJacobian, cachedNzji);
+        EXPECT_EQ(cachedNzji, expectedNzji);
+        if (inside)
+        {
+          EXPECT_EQ(cachedJacobian, expectedJacobian);
+        }
+
+        typename TransformType::DerivativeType expectedImageJacobian(nnzji), cachedImageJacobian(nnzji);
+        expectedImageJacobian.Fill(0.0);
+        cachedImageJacobian.Fill(0.0);
+        transform->EvaluateJacobianWithImageGradientProduct(point, movingImageGradient, expectedImageJacobian, expectedNzji);
+        transform->EvaluateJacobianWithImageGradientProductUsingSampleWeights(
+          weights.data(), offset, movingImageGradient, cachedImageJacobian, cachedNzji);
+        EXPECT_EQ(cachedNzji, expectedNzji);
+        EXPECT_EQ(cachedImageJacobian, expectedImageJacobian);
+      }
+    }
+
+    // The test points should cover both cases.
+    EXPECT_GT(numberOfInsidePoints, 0u);
+    EXPECT_GT(numberOfOutsidePoints, 0u);
+  }
+
+} // End of namespace.
+
+
+GTEST_TEST(RecursiveBSplineTransform, SampleWeightsFirstOrder)
+{
+  Expect_sample_weights_results_equal_to_direct_results<1>();
+}
+
+
+GTEST_TEST(RecursiveBSplineTransform, SampleWeightsSecondOrder)
+{
+  Expect_sample_weights_results_equal_to_direct_results<2>();
+}
+
+
+GTEST_TEST(RecursiveBSplineTransform, SampleWeightsThirdOrder)
+{
+  Expect_sample_weights_results_equal_to_direct_results<3>();
+}
@@ -0,0 +1,151 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __ImageCopySampler_h
+#define __ImageCopySampler_h
+
+#include "itkImageSamplerBase.h"
+#include "itkCommand.h"
+
+namespace itk
+{
+/** \class ImageCopySampler
+ *
+ * \brief Provides a copy of the samples of another sampler.
+ *
+ * This sampler does not select samples itself. It holds a snapshot of the
+ * samples of the source sampler, which is taken when the source sampler is
+ * set, and every time the source has generated new samples (on its
+ * EndEvent). Update() only uses the snapshot, and never reads or updates
+ * the source sampler. It is used by independent copies of a metric (cost
+ * function contexts), which should use the same samples as the original
+ * metric, while they are evaluated concurrently with it. The source
+ * sampler must therefore only generate new samples while the copies are
+ * not evaluated, like in the first, sequential, evaluation of
+ * ConcurrentCostFunctionEvaluator::GetValues().
+ *
+ * When the source uses lazy sampling, only its sample grid is copied.
+ *
+ * \ingroup ImageSamplers
+ */
+
+template< class TInputImage >
+class ImageCopySampler :
+  public ImageSamplerBase< TInputImage >
+{
+public:
+
+  /** Standard ITK-stuff. */
+  typedef ImageCopySampler                Self;
+  typedef ImageSamplerBase< TInputImage > Superclass;
+  typedef SmartPointer< Self >            Pointer;
+  typedef SmartPointer< const Self >      ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( ImageCopySampler, ImageSamplerBase );
+
+  /** Typedefs inherited from the superclass. */
+  typedef typename Superclass::InputImageType              InputImageType;
+  typedef typename Superclass::ImageSampleContainerType    ImageSampleContainerType;
+  typedef typename Superclass::ImageSampleContainerPointer ImageSampleContainerPointer;
+
+  /** The input image dimension. */
+  itkStaticConstMacro( InputImageDimension, unsigned int,
+    Superclass::InputImageDimension );
+
+  /** Set the sampler whose samples are copied, and take a snapshot of its
+   * current samples. Must be called from the thread that updates the source.
+   */
+  virtual void SetSourceSampler( Superclass * sourceSampler );
+
+  /** Get the sampler whose samples are copied. */
+  itkGetModifiableObjectMacro( SourceSampler, Superclass );
+
+  /** The snapshot of the samples is the output; there is nothing to update. */
+  void Update( void ) override;
+
+  /** Selecting new samples is up to the source sampler. */
+  bool SelectNewSamplesOnUpdate( void ) override
+  {
+    return false;
+  }
+
+
+  /** Returns whether the sampler supports SelectNewSamplesOnUpdate(). */
+  bool SelectingNewSamplesOnUpdateSupported( void ) const override
+  {
+    return false;
+  }
+
+
+  /** The copy may consist of only the sample grid of the source. */
+  bool SupportsLazySampling( void ) const override
+  {
+    return true;
+  }
+
+
+  /** Returns true if the snapshot of the source only has its sample grid. */
+  bool IsLazySamplingUsed( void ) const override
+  {
+    return this->m_UseLazySampling;
+  }
+
+
+protected:
+
+  /** The constructor. */
+  ImageCopySampler();
+  /** The destructor. */
+  ~ImageCopySampler() override;
+
+  /** PrintSelf. */
+  void PrintSelf( std::ostream & os, Indent indent ) const override;
+
+  /** Function that does the work: take a snapshot of the samples of the
+   * source sampler.
+   */
+  void GenerateData( void ) override;
+
+private:
+
+  /** The private constructor. */
+  ImageCopySampler( const Self & );     // purposely not implemented
+  /** The private copy constructor. */
+  void operator=( const Self & );       // purposely not implemented
+
+  /** Removes the observer of the source sampler, if any. */
+  void RemoveSourceSamplerObserver( void );
+
+  typename Superclass::Pointer m_SourceSampler;
+
+  /** The observer of the EndEvent of the source sampler. */
+  unsigned long m_SourceSamplerObserverTag;
+  bool          m_HasSourceSamplerObserver;
+
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkImageCopySampler.hxx"
+#endif
+
+#endif // end #ifndef __ImageCopySampler_h
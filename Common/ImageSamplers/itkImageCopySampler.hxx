@@ -0,0 +1,171 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __ImageCopySampler_hxx
+#define __ImageCopySampler_hxx
+
+#include "itkImageCopySampler.h"
+
+namespace itk
+{
+
+/**
+ * ******************* Constructor *******************
+ */
+
+template< class TInputImage >
+ImageCopySampler< TInputImage >
+::ImageCopySampler()
+{
+  this->m_SourceSamplerObserverTag = 0;
+  this->m_HasSourceSamplerObserver = false;
+
+} // end Constructor()
+
+
+/**
+ * ******************* Destructor *******************
+ */
+
+template< class TInputImage >
+ImageCopySampler< TInputImage >
+::~ImageCopySampler()
+{
+  this->RemoveSourceSamplerObserver();
+
+} // end Destructor()
+
+
+/**
+ * ******************* SetSourceSampler *******************
+ */
+
+template< class TInputImage >
+void
+ImageCopySampler< TInputImage >
+::SetSourceSampler( Superclass * sourceSampler )
+{
+  if( this->m_SourceSampler == sourceSampler )
+  {
+    return;
+  }
+
+  this->RemoveSourceSamplerObserver();
+  this->m_SourceSampler = sourceSampler;
+  if( sourceSampler != nullptr )
+  {
+    /** Take a new snapshot every time the source generated new samples. */
+    typedef SimpleMemberCommand< Self > CommandType;
+    typename CommandType::Pointer command = CommandType::New();
+    command->SetCallbackFunction( this, &Self::GenerateData );
+    this->m_SourceSamplerObserverTag = sourceSampler->AddObserver( EndEvent(), command );
+    this->m_HasSourceSamplerObserver = true;
+
+    this->GenerateData();
+  }
+  this->Modified();
+
+} // end SetSourceSampler()
+
+
+/**
+ * ******************* RemoveSourceSamplerObserver *******************
+ */
+
+template< class TInputImage >
+void
+ImageCopySampler< TInputImage >
+::RemoveSourceSamplerObserver( void )
+{
+  if( this->m_HasSourceSamplerObserver )
+  {
+    this->m_SourceSampler->RemoveObserver( this->m_SourceSamplerObserverTag );
+    this->m_HasSourceSamplerObserver = false;
+  }
+
+} // end RemoveSourceSamplerObserver()
+
+
+/**
+ * ******************* Update *******************
+ */
+
+template< class TInputImage >
+void
+ImageCopySampler< TInputImage >
+::Update( void )
+{
+  if( this->m_SourceSampler.IsNull() )
+  {
+    itkExceptionMacro( << "No source sampler has been set." );
+  }
+
+} // end Update()
+
+
+/**
+ * ******************* GenerateData *******************
+ */
+
+template< class TInputImage >
+void
+ImageCopySampler< TInputImage >
+::GenerateData( void )
+{
+  Superclass * source = this->m_SourceSampler;
+  if( source == nullptr )
+  {
+    itkExceptionMacro( << "No source sampler has been set." );
+  }
+
+  this->m_NumberOfSamples = source->GetNumberOfSamples();
+  this->m_UseLazySampling = source->IsLazySamplingUsed();
+  this->m_SampleGrid      = source->GetSampleGrid();
+
+  /** With lazy sampling the source output is empty. */
+  typename ImageSampleContainerType::Pointer sampleContainer = this->GetOutput();
+  if( this->m_UseLazySampling )
+  {
+    sampleContainer->Initialize();
+  }
+  else
+  {
+    sampleContainer->CastToSTLContainer() = source->GetOutput()->CastToSTLConstContainer();
+  }
+
+} // end GenerateData()
+
+
+/**
+ * ******************* PrintSelf *******************
+ */
+
+template< class TInputImage >
+void
+ImageCopySampler< TInputImage >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "SourceSampler: " << this->m_SourceSampler.GetPointer() << std::endl;
+
+} // end PrintSelf()
+
+
+} // end namespace itk
+
+#endif // end #ifndef __ImageCopySampler_hxx
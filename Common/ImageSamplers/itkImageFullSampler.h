@@ -82,6 +82,13 @@ public:
   }
 
 
+  /** This sampler can describe its samples by an ImageSampleGrid. */
+  bool SupportsLazySampling( void ) const override
+  {
+    return true;
+  }
+
+
   /** Returns whether the sampler supports SelectNewSamplesOnUpdate(). */
   bool SelectingNewSamplesOnUpdateSupported( void ) const override
   {
@@ -34,6 +34,17 @@ void
 ImageFullSampler< TInputImage >
 ::GenerateData( void )
 {
+  /** With lazy sampling only the voxel grid of the cropped region is described. */
+  if( this->IsLazySamplingUsed() )
+  {
+    typename InputImageType::OffsetType gridSpacing;
+    gridSpacing.Fill( 1 );
+    this->GetOutput()->Initialize();
+    this->InitializeSampleGrid( this->GetCroppedInputImageRegion().GetIndex(),
+      this->GetCroppedInputImageRegion().GetSize(), gridSpacing );
+    return;
+  }
+
   /** If desired we exercise a multi-threaded version. */
   if( this->m_UseMultiThread )
   {
@@ -105,6 +105,13 @@ ImageGridSampler< TInputImage >
     numberOfSamplesOnGrid *= sampleGridSize[ dim ];
   }
 
+  /** With lazy sampling only the grid is described. */
+  if( this->IsLazySamplingUsed() )
+  {
+    this->InitializeSampleGrid( sampleGridIndex, sampleGridSize, this->m_SampleGridSpacing );
+    return;
+  }
+
   /** Prepare for looping over the grid. */
   unsigned int dim_z = 1;
   unsigned int dim_t = 1;
@@ -20,7 +20,8 @@
 
 #include "itkImageRandomSamplerBase.h"
 #include "itkMersenneTwisterRandomVariateGenerator.h"
-#include "itkImageFullSampler.h"
+
+#include <vector>
 
 namespace itk
 {
@@ -31,6 +32,13 @@ namespace itk
  * This version takes into account that the mask may be very small.
  * Also, it may be more efficient when very many different sample sets
  * of the same input image are required, because it does some precomputation.
+ *
+ * The precomputation is a compact list with the buffer offsets of all voxels
+ * within the mask. It is built once, and only rebuilt when the input image,
+ * the mask or the cropped input image region changes, so typically once per
+ * resolution. Drawing a new sample set then only costs O(number of samples),
+ * and is done multi-threaded when UseMultiThread is set.
+ *
  * \ingroup ImageSamplers
  */
 
@@ -78,10 +86,19 @@ public:
   typedef itk::Statistics::MersenneTwisterRandomVariateGenerator RandomGeneratorType;
   typedef typename RandomGeneratorType::Pointer                  RandomGeneratorPointer;
 
-protected:
+  /** The sparse representation of the mask: the buffer offsets of all voxels
+   * of the cropped input image region that are inside the mask.
+   */
+  typedef std::vector< OffsetValueType > MaskOffsetListType;
+
+  /** Get the number of voxels within the mask, as found in the last update. */
+  virtual SizeValueType GetNumberOfValidSamples( void ) const
+  {
+    return static_cast< SizeValueType >( this->m_MaskOffsetList.size() );
+  }
 
-  typedef itk::ImageFullSampler< InputImageType >   InternalFullSamplerType;
-  typedef typename InternalFullSamplerType::Pointer InternalFullSamplerPointer;
+
+protected:
 
   /** The constructor. */
   ImageRandomSamplerSparseMask();
@@ -94,15 +111,13 @@ protected:
   /** Function that does the work. */
   void GenerateData( void ) override;
 
-  /** Multi-threaded functionality that does the work. */
-  void BeforeThreadedGenerateData( void ) override;
+  /** (Re)build the list of voxels within the mask, if the input image,
+   * the mask or the cropped input image region changed since the last call.
+   */
+  virtual void UpdateMaskOffsetList( void );
 
-  void ThreadedGenerateData(
-    const InputImageRegionType & inputRegionForThread,
-    ThreadIdType threadId ) override;
-
-  RandomGeneratorPointer     m_RandomGenerator;
-  InternalFullSamplerPointer m_InternalFullSampler;
+  RandomGeneratorPointer m_RandomGenerator;
+  MaskOffsetListType     m_MaskOffsetList;
 
 private:
 
@@ -111,6 +126,13 @@ private:
   /** The private copy constructor. */
   void operator=( const Self & );                // purposely not implemented
 
+  /** What the mask offset list was computed from. */
+  const InputImageType * m_MaskOffsetListInput;
+  const MaskType *       m_MaskOffsetListMask;
+  ModifiedTimeType       m_MaskOffsetListInputMTime;
+  ModifiedTimeType       m_MaskOffsetListMaskMTime;
+  InputImageRegionType   m_MaskOffsetListRegion;
+
 };
 
 } // end namespace itk
@@ -20,6 +20,11 @@
 
 #include "itkImageRandomSamplerSparseMask.h"
 
+#include "itkImageRegionConstIteratorWithIndex.h"
+
+#include <map>
+#include <mutex>
+
 namespace itk
 {
 
@@ -34,166 +39,180 @@ ImageRandomSamplerSparseMask< TInputImage >
   /** Setup random generator. */
   this->m_RandomGenerator = RandomGeneratorType::GetInstance();
 
-  this->m_InternalFullSampler = InternalFullSamplerType::New();
+  this->m_MaskOffsetListInput      = nullptr;
+  this->m_MaskOffsetListMask       = nullptr;
+  this->m_MaskOffsetListInputMTime = 0;
+  this->m_MaskOffsetListMaskMTime  = 0;
 
 } // end Constructor
 
 
 /**
- * ******************* GenerateData *******************
+ * ******************* UpdateMaskOffsetList *******************
  */
 
 template< class TInputImage >
 void
 ImageRandomSamplerSparseMask< TInputImage >
-::GenerateData( void )
+::UpdateMaskOffsetList( void )
 {
-  /** Get a handle to the mask. */
-  typename MaskType::ConstPointer mask = this->GetMask();
-
-  /** Sanity check. */
-  if( mask.IsNull() )
+  InputImageConstPointer          inputImage = this->GetInput();
+  typename MaskType::ConstPointer mask       = this->GetMask();
+  const InputImageRegionType &    region     = this->GetCroppedInputImageRegion();
+
+  /** Nothing to do if the list is still valid. */
+  if( inputImage.GetPointer() == this->m_MaskOffsetListInput
+    && mask.GetPointer() == this->m_MaskOffsetListMask
+    && inputImage->GetMTime() == this->m_MaskOffsetListInputMTime
+    && mask->GetMTime() == this->m_MaskOffsetListMaskMTime
+    && region == this->m_MaskOffsetListRegion )
   {
-    itkExceptionMacro( << "ERROR: do not call this function when no mask is supplied." );
+    return;
   }
 
-  /** Get handles to the input image and output sample container. */
-  InputImageConstPointer      inputImage      = this->GetInput();
-  ImageSampleContainerPointer sampleContainer = this->GetOutput();
-
-  /** Clear the container. */
-  sampleContainer->Initialize();
+  if( mask->GetSource() )
+  {
+    mask->GetSource()->Update();
+  }
 
-  /** Make sure the internal full sampler is up-to-date. */
-  this->m_InternalFullSampler->SetInput( inputImage );
-  this->m_InternalFullSampler->SetMask( mask );
-  this->m_InternalFullSampler->SetInputImageRegion( this->GetCroppedInputImageRegion() );
+  /** Scan the cropped region multi-threaded. Every work unit stores the
+   * offsets of its chunk, keyed by the offset of the first voxel of the chunk,
+   * such that the final list is in the usual image iteration order.
+   */
+  typedef std::map< OffsetValueType, MaskOffsetListType > ChunkMapType;
+  ChunkMapType chunks;
+  std::mutex   chunksMutex;
 
-  /** Use try/catch, since the full sampler may crash, due to insufficient memory. */
+  this->m_MaskOffsetList.clear();
   try
   {
-    this->m_InternalFullSampler->Update();
-  }
-  catch( ExceptionObject & err )
-  {
-    std::string message = "ERROR: This ImageSampler internally uses the "
-      "ImageFullSampler. Updating of this internal sampler raised the "
-      "exception:\n";
-    message += err.GetDescription();
-
-    std::string            fullSamplerMessage = err.GetDescription();
-    std::string::size_type loc                = fullSamplerMessage.find(
-      "ERROR: failed to allocate memory for the sample container", 0 );
-    if( loc != std::string::npos && this->GetMask() == 0 )
+    this->GetMultiThreader()->template ParallelizeImageRegion< InputImageDimension >(
+      region,
+      [ &inputImage, &mask, &chunks, &chunksMutex ]( const InputImageRegionType & chunkRegion )
+      {
+        MaskOffsetListType  chunkOffsets;
+        InputImagePointType point;
+        ImageRegionConstIteratorWithIndex< InputImageType > iter( inputImage, chunkRegion );
+        for( iter.GoToBegin(); !iter.IsAtEnd(); ++iter )
+        {
+          const InputImageIndexType & index = iter.GetIndex();
+          inputImage->TransformIndexToPhysicalPoint( index, point );
+          if( mask->IsInsideInWorldSpace( point ) )
+          {
+            chunkOffsets.push_back( inputImage->ComputeOffset( index ) );
+          }
+        }
+
+        std::lock_guard< std::mutex > lock( chunksMutex );
+        chunks[ inputImage->ComputeOffset( chunkRegion.GetIndex() ) ].swap( chunkOffsets );
+      },
+      nullptr );
+
+    SizeValueType numberOfValidSamples = 0;
+    for( typename ChunkMapType::const_iterator it = chunks.begin(); it != chunks.end(); ++it )
     {
-      message += "\nYou are using the ImageRandomSamplerSparseMask sampler, "
-        "but you did not set a mask. The internal ImageFullSampler therefore "
-        "requires a lot of memory. Consider using the ImageRandomSampler "
-        "instead.";
+      numberOfValidSamples += it->second.size();
+    }
+    this->m_MaskOffsetList.reserve( numberOfValidSamples );
+    for( typename ChunkMapType::const_iterator it = chunks.begin(); it != chunks.end(); ++it )
+    {
+      this->m_MaskOffsetList.insert( this->m_MaskOffsetList.end(),
+        it->second.begin(), it->second.end() );
     }
-    const char * message2 = message.c_str();
-    itkExceptionMacro( << message2 );
   }
-
-  /** If desired we exercise a multi-threaded version. */
-  if( this->m_UseMultiThread )
+  catch( std::bad_alloc & excp )
   {
-    /** Calls ThreadedGenerateData(). */
-    return Superclass::GenerateData();
+    std::string message = "std: ";
+    message += excp.what();
+    message += "\nERROR: failed to allocate memory for the list of voxels within the mask.";
+    const char * message2 = message.c_str();
+    itkExceptionMacro( << message2 );
   }
 
-  /** Get a handle to the full sampler output. */
-  typename ImageSampleContainerType::Pointer allValidSamples
-    = this->m_InternalFullSampler->GetOutput();
-  unsigned long numberOfValidSamples = allValidSamples->Size();
-
-  /** Take random samples from the allValidSamples-container. */
-  for( unsigned int i = 0; i < this->GetNumberOfSamples(); ++i )
-  {
-    unsigned long randomIndex
-      = this->m_RandomGenerator->GetIntegerVariate( numberOfValidSamples - 1 );
-    sampleContainer->push_back( allValidSamples->ElementAt( randomIndex ) );
-  }
+  this->m_MaskOffsetListInput      = inputImage.GetPointer();
+  this->m_MaskOffsetListMask       = mask.GetPointer();
+  this->m_MaskOffsetListInputMTime = inputImage->GetMTime();
+  this->m_MaskOffsetListMaskMTime  = mask->GetMTime();
+  this->m_MaskOffsetListRegion     = region;
 
-} // end GenerateData()
+} // end UpdateMaskOffsetList()
 
 
 /**
- * ******************* BeforeThreadedGenerateData *******************
+ * ******************* GenerateData *******************
  */
 
 template< class TInputImage >
 void
 ImageRandomSamplerSparseMask< TInputImage >
-::BeforeThreadedGenerateData( void )
+::GenerateData( void )
 {
-  /** Clear the random number list. */
-  this->m_RandomNumberList.resize( 0 );
-  this->m_RandomNumberList.reserve( this->m_NumberOfSamples );
-
-  /** Get a handle to the full sampler output size. */
-  const unsigned long numberOfValidSamples
-    = this->m_InternalFullSampler->GetOutput()->Size();
-
-  /** Fill the list with random numbers. */
-  for( unsigned int i = 0; i < this->GetNumberOfSamples(); ++i )
-  {
-    unsigned long randomIndex
-      = this->m_RandomGenerator->GetIntegerVariate( numberOfValidSamples - 1 );
-    this->m_RandomNumberList.push_back( randomIndex );
-  }
+  /** Get a handle to the mask. */
+  typename MaskType::ConstPointer mask = this->GetMask();
 
-  /** Initialize variables needed for threads. */
-  this->m_ThreaderSampleContainer.clear();
-  this->m_ThreaderSampleContainer.resize( this->GetNumberOfWorkUnits() );
-  for( std::size_t i = 0; i < this->GetNumberOfWorkUnits(); i++ )
+  /** Sanity check. */
+  if( mask.IsNull() )
   {
-    this->m_ThreaderSampleContainer[ i ] = ImageSampleContainerType::New();
+    itkExceptionMacro( << "ERROR: do not call this function when no mask is supplied." );
   }
 
-} // end BeforeThreadedGenerateData()
-
+  /** Get handles to the input image and output sample container. */
+  InputImageConstPointer      inputImage      = this->GetInput();
+  ImageSampleContainerPointer sampleContainer = this->GetOutput();
 
-/**
- * ******************* ThreadedGenerateData *******************
- */
+  /** Clear the container. */
+  sampleContainer->Initialize();
 
-template< class TInputImage >
-void
-ImageRandomSamplerSparseMask< TInputImage >
-::ThreadedGenerateData( const InputImageRegionType &, ThreadIdType threadId )
-{
-  /** Get a handle to the full sampler output. */
-  typename ImageSampleContainerType::Pointer allValidSamples
-    = this->m_InternalFullSampler->GetOutput();
-
-  /** Figure out which samples to process. */
-  unsigned long chunkSize   = this->GetNumberOfSamples() / this->GetNumberOfWorkUnits();
-  unsigned long sampleStart = threadId * chunkSize;
-  if( threadId == this->GetNumberOfWorkUnits() - 1 )
+  /** Make sure the list of voxels within the mask is up-to-date. */
+  this->UpdateMaskOffsetList();
+  const unsigned long numberOfValidSamples = this->m_MaskOffsetList.size();
+  if( numberOfValidSamples == 0 )
   {
-    chunkSize = this->GetNumberOfSamples()
-      - ( ( this->GetNumberOfWorkUnits() - 1 ) * chunkSize );
+    itkExceptionMacro( << "ERROR: the mask does not contain any voxel of the input image region." );
   }
 
-  /** Get a reference to the output and reserve memory for it. */
-  ImageSampleContainerPointer & sampleContainerThisThread
-    = this->m_ThreaderSampleContainer[ threadId ];
-  sampleContainerThisThread->Reserve( chunkSize );
+  /** Draw the random numbers. This is done sequentially, such that the
+   * samples do not depend on the number of threads.
+   */
+  const unsigned long numberOfSamples = this->GetNumberOfSamples();
+  if( numberOfSamples == 0 )
+  {
+    return;
+  }
+  this->m_RandomNumberList.resize( numberOfSamples );
+  for( unsigned long i = 0; i < numberOfSamples; ++i )
+  {
+    this->m_RandomNumberList[ i ] = static_cast< double >(
+      this->m_RandomGenerator->GetIntegerVariate( numberOfValidSamples - 1 ) );
+  }
 
-  /** Setup an iterator over the sampleContainerThisThread. */
-  typename ImageSampleContainerType::Iterator iter;
-  typename ImageSampleContainerType::ConstIterator end = sampleContainerThisThread->End();
+  /** Convert the drawn voxels to samples. */
+  sampleContainer->CastToSTLContainer().resize( numberOfSamples );
+  ImageSampleType *       samples    = &( sampleContainer->CastToSTLContainer()[ 0 ] );
+  const OffsetValueType * offsets    = &( this->m_MaskOffsetList[ 0 ] );
+  const double *          randomList = &( this->m_RandomNumberList[ 0 ] );
+  const InputImageType *  image      = inputImage.GetPointer();
+  const auto fillSample = [ samples, offsets, randomList, image ]( SizeValueType i )
+  {
+    const InputImageIndexType index = image->ComputeIndex(
+      offsets[ static_cast< unsigned long >( randomList[ i ] ) ] );
+    image->TransformIndexToPhysicalPoint( index, samples[ i ].m_ImageCoordinates );
+    samples[ i ].m_ImageValue = image->GetPixel( index );
+  };
 
-  /** Take random samples from the allValidSamples-container. */
-  unsigned long sampleId = sampleStart;
-  for( iter = sampleContainerThisThread->Begin(); iter != end; ++iter, sampleId++ )
+  if( this->m_UseMultiThread )
+  {
+    this->GetMultiThreader()->ParallelizeArray( 0, numberOfSamples, fillSample, nullptr );
+  }
+  else
   {
-    unsigned long randomIndex = static_cast< unsigned long >( this->m_RandomNumberList[ sampleId ] );
-    ( *iter ).Value() = allValidSamples->ElementAt( randomIndex );
+    for( unsigned long i = 0; i < numberOfSamples; ++i )
+    {
+      fillSample( i );
+    }
   }
 
-} // end ThreadedGenerateData()
+} // end GenerateData()
 
 
 /**
@@ -207,7 +226,7 @@ ImageRandomSamplerSparseMask< TInputImage >
 {
   Superclass::PrintSelf( os, indent );
 
-  os << indent << "InternalFullSampler: " << this->m_InternalFullSampler.GetPointer() << std::endl;
+  os << indent << "NumberOfValidSamples: " << this->m_MaskOffsetList.size() << std::endl;
   os << indent << "RandomGenerator: " << this->m_RandomGenerator.GetPointer() << std::endl;
 
 } // end PrintSelf()
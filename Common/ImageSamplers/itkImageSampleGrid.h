@@ -0,0 +1,292 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __ImageSampleGrid_h
+#define __ImageSampleGrid_h
+
+#include "itkImageSample.h"
+#include "itkSpatialObject.h"
+
+namespace itk
+{
+
+/** \class ImageSampleGrid
+ *
+ * \brief A class that describes image samples on a regular grid of voxels,
+ * without storing them.
+ *
+ * The grid is given by a start index, the number of grid points in each
+ * dimension, and an integer grid spacing (in voxels). If a mask is given,
+ * only the grid points inside the mask are samples. The ConstIterator
+ * generates the samples on the fly: along a grid line the coordinates are
+ * updated incrementally, so the index-to-point matrix multiplication is only
+ * done once per grid line.
+ *
+ * Grid and full samplers fill such a description when lazy sampling is
+ * requested, so that metrics can iterate over the samples directly instead
+ * of over a materialized sample container.
+ *
+ * \ingroup ImageSamplers
+ */
+
+template< class TImage >
+class ImageSampleGrid
+{
+public:
+
+  /** Typedef's. */
+  typedef ImageSampleGrid                     Self;
+  typedef TImage                              ImageType;
+  typedef ImageSample< ImageType >            ImageSampleType;
+  typedef typename ImageType::IndexType       IndexType;
+  typedef typename ImageType::SizeType        SizeType;
+  typedef typename ImageType::OffsetType      GridSpacingType;
+  typedef typename ImageType::PointType       PointType;
+  typedef typename PointType::VectorType      VectorType;
+  typedef typename ImageSampleType::RealType  RealType;
+
+  itkStaticConstMacro( ImageDimension, unsigned int, ImageType::ImageDimension );
+
+  typedef SpatialObject< itkGetStaticConstMacro( ImageDimension ) > MaskType;
+
+  ImageSampleGrid()
+  {
+    this->m_Image = nullptr;
+    this->m_Mask  = nullptr;
+    this->m_StartIndex.Fill( 0 );
+    this->m_GridSize.Fill( 0 );
+    this->m_GridSpacing.Fill( 1 );
+    this->m_NumberOfGridPoints = 0;
+    this->m_NumberOfSamples    = 0;
+  }
+
+
+  ~ImageSampleGrid() {}
+
+  /** Define the grid. The image and the mask should outlive the grid. */
+  void Initialize( const ImageType * image, const MaskType * mask,
+    const IndexType & startIndex, const SizeType & gridSize,
+    const GridSpacingType & gridSpacing )
+  {
+    this->m_Image       = image;
+    this->m_Mask        = mask;
+    this->m_StartIndex  = startIndex;
+    this->m_GridSize    = gridSize;
+    this->m_GridSpacing = gridSpacing;
+
+    this->m_NumberOfGridPoints = 1;
+    for( unsigned int d = 0; d < ImageDimension; ++d )
+    {
+      this->m_NumberOfGridPoints *= gridSize[ d ];
+    }
+
+    /** The physical step from one grid point to the next along a grid line. */
+    PointType origin, next;
+    IndexType nextIndex = startIndex;
+    nextIndex[ 0 ] += gridSpacing[ 0 ];
+    image->TransformIndexToPhysicalPoint( startIndex, origin );
+    image->TransformIndexToPhysicalPoint( nextIndex, next );
+    this->m_LineStep = next - origin;
+
+    /** Without a mask all grid points are samples. */
+    this->m_NumberOfSamples = mask ? 0 : this->m_NumberOfGridPoints;
+  }
+
+
+  /** Get the image and the mask. */
+  const ImageType * GetImage( void ) const { return this->m_Image; }
+  const MaskType * GetMask( void ) const { return this->m_Mask; }
+
+  /** Get the grid definition. */
+  const IndexType & GetStartIndex( void ) const { return this->m_StartIndex; }
+  const SizeType & GetGridSize( void ) const { return this->m_GridSize; }
+  const GridSpacingType & GetGridSpacing( void ) const { return this->m_GridSpacing; }
+
+  /** The number of grid points, including the ones outside the mask. */
+  SizeValueType GetNumberOfGridPoints( void ) const { return this->m_NumberOfGridPoints; }
+
+  /** The number of grid points inside the mask. It is set by the sampler,
+   * which may count the samples in parallel, using the ConstIterator.
+   */
+  void SetNumberOfSamples( SizeValueType n ) { this->m_NumberOfSamples = n; }
+  SizeValueType GetNumberOfSamples( void ) const { return this->m_NumberOfSamples; }
+
+  /** Compute the image index of a grid point, given its linear position. */
+  void ComputeIndex( SizeValueType position, IndexType & index ) const
+  {
+    for( unsigned int d = 0; d < ImageDimension; ++d )
+    {
+      const SizeValueType gridIndex = position % this->m_GridSize[ d ];
+      position /= this->m_GridSize[ d ];
+      index[ d ] = this->m_StartIndex[ d ]
+        + static_cast< IndexValueType >( gridIndex ) * this->m_GridSpacing[ d ];
+    }
+  }
+
+
+  /** \class ConstIterator
+   * \brief Iterates over the samples of a range of grid points.
+   *
+   * The iterator skips grid points outside the mask, but never moves beyond
+   * the end position it was constructed with. Dereferencing gives access to
+   * the current sample via Value(), like an iterator over an
+   * ImageSampleContainer does, so metrics can use the same loop for both.
+   */
+  class ConstIterator
+  {
+public:
+
+    ConstIterator( const Self & grid, SizeValueType position, SizeValueType endPosition ) :
+      m_Grid( &grid ), m_Position( position ), m_EndPosition( endPosition )
+    {
+      if( this->m_Position < this->m_EndPosition )
+      {
+        this->m_Grid->ComputeIndex( this->m_Position, this->m_Index );
+        this->m_Grid->GetImage()->TransformIndexToPhysicalPoint(
+          this->m_Index, this->m_Sample.m_ImageCoordinates );
+        this->SkipOutsideMask();
+      }
+    }
+
+
+    /** Move to the next sample, or to the end position. */
+    ConstIterator & operator++( void )
+    {
+      this->Step();
+      this->SkipOutsideMask();
+      return *this;
+    }
+
+
+    /** Access to the current sample, mimicking ImageSampleContainer::ConstIterator. */
+    const ConstIterator & operator*( void ) const { return *this; }
+    const ImageSampleType & Value( void ) const { return this->m_Sample; }
+
+    /** Get the image index of the current sample. */
+    const IndexType & GetIndex( void ) const { return this->m_Index; }
+
+    /** Get the linear grid position of the iterator. */
+    SizeValueType GetPosition( void ) const { return this->m_Position; }
+
+    bool operator==( const ConstIterator & other ) const
+    {
+      return this->m_Position == other.m_Position;
+    }
+
+
+    bool operator!=( const ConstIterator & other ) const
+    {
+      return this->m_Position != other.m_Position;
+    }
+
+
+private:
+
+    /** Go to the next grid point. Along a grid line the point is updated
+     * incrementally; at the start of a new line it is recomputed from the
+     * index, to avoid the accumulation of rounding errors.
+     */
+    void Step( void )
+    {
+      ++this->m_Position;
+      if( this->m_Position >= this->m_EndPosition )
+      {
+        this->m_Position = this->m_EndPosition;
+        return;
+      }
+
+      const SizeType &        gridSize    = this->m_Grid->GetGridSize();
+      const IndexType &       startIndex  = this->m_Grid->GetStartIndex();
+      const GridSpacingType & gridSpacing = this->m_Grid->GetGridSpacing();
+
+      this->m_Index[ 0 ] += gridSpacing[ 0 ];
+      if( this->m_Index[ 0 ] < startIndex[ 0 ]
+        + static_cast< IndexValueType >( gridSize[ 0 ] ) * gridSpacing[ 0 ] )
+      {
+        this->m_Sample.m_ImageCoordinates += this->m_Grid->m_LineStep;
+        return;
+      }
+
+      /** Carry to the next grid line. */
+      this->m_Index[ 0 ] = startIndex[ 0 ];
+      for( unsigned int d = 1; d < ImageDimension; ++d )
+      {
+        this->m_Index[ d ] += gridSpacing[ d ];
+        if( this->m_Index[ d ] < startIndex[ d ]
+          + static_cast< IndexValueType >( gridSize[ d ] ) * gridSpacing[ d ] )
+        {
+          break;
+        }
+        this->m_Index[ d ] = startIndex[ d ];
+      }
+      this->m_Grid->GetImage()->TransformIndexToPhysicalPoint(
+        this->m_Index, this->m_Sample.m_ImageCoordinates );
+    }
+
+
+    /** Step until a grid point inside the mask is found, then read its value. */
+    void SkipOutsideMask( void )
+    {
+      const MaskType * mask = this->m_Grid->GetMask();
+      while( this->m_Position < this->m_EndPosition )
+      {
+        if( !mask || mask->IsInsideInWorldSpace( this->m_Sample.m_ImageCoordinates ) )
+        {
+          this->m_Sample.m_ImageValue = static_cast< RealType >(
+            this->m_Grid->GetImage()->GetPixel( this->m_Index ) );
+          return;
+        }
+        this->Step();
+      }
+    }
+
+
+    const Self *    m_Grid;
+    SizeValueType   m_Position;
+    SizeValueType   m_EndPosition;
+    IndexType       m_Index;
+    ImageSampleType m_Sample;
+  };
+
+  /** Iterators over the grid points [begin, end). */
+  ConstIterator Begin( SizeValueType begin, SizeValueType end ) const
+  {
+    return ConstIterator( *this, begin, end );
+  }
+
+
+  ConstIterator End( SizeValueType end ) const
+  {
+    return ConstIterator( *this, end, end );
+  }
+
+
+private:
+
+  const ImageType * m_Image;
+  const MaskType *  m_Mask;
+  IndexType         m_StartIndex;
+  SizeType          m_GridSize;
+  GridSpacingType   m_GridSpacing;
+  VectorType        m_LineStep;
+  SizeValueType     m_NumberOfGridPoints;
+  SizeValueType     m_NumberOfSamples;
+};
+
+} // end namespace itk
+
+#endif // end #ifndef __ImageSampleGrid_h
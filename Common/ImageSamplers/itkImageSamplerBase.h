@@ -20,8 +20,10 @@
 
 #include "itkImageToVectorContainerFilter.h"
 #include "itkImageSample.h"
+#include "itkImageSampleGrid.h"
 #include "itkVectorDataContainer.h"
 #include "itkSpatialObject.h"
+#include "itkHotPathProfiler.h"
 
 namespace itk
 {
@@ -80,6 +82,8 @@ public:
   typedef typename InputImageType::SizeType                     InputImageSizeType;
   typedef typename InputImageType::IndexType                    InputImageIndexType;
   typedef typename InputImageType::PointType                    InputImagePointType;
+  typedef typename InputImageType::SpacingType                  InputImageSpacingType;
+  typedef typename InputImageType::DirectionType                InputImageDirectionType;
   typedef typename InputImagePointType::ValueType               InputImagePointValueType;
   typedef typename ImageSampleType::RealType                    ImageSampleValueType;
   typedef SpatialObject< Self::InputImageDimension >            MaskType;
@@ -87,6 +91,7 @@ public:
   typedef typename MaskType::ConstPointer                       MaskConstPointer;
   typedef std::vector< MaskConstPointer >                       MaskVectorType;
   typedef std::vector< InputImageRegionType >                   InputImageRegionVectorType;
+  typedef ImageSampleGrid< InputImageType >                     ImageSampleGridType;
 
   /** ******************** Masks ******************** */
 
@@ -171,6 +176,58 @@ public:
   /** \todo: Temporary, should think about interface. */
   itkSetMacro( UseMultiThread, bool );
 
+  /** Returns whether the sampler can describe its samples by an
+   * ImageSampleGrid, see SetUseLazySampling().
+   */
+  virtual bool SupportsLazySampling( void ) const
+  {
+    return false;
+  }
+
+
+  /** Set/Get whether the samples are only described by the sample grid,
+   * instead of stored in the output sample container. In that case the
+   * output container is left empty, and the user should iterate over
+   * GetSampleGrid(). This saves O(samples) memory. Only has effect if
+   * SupportsLazySampling() returns true. Default: false.
+   */
+  itkSetMacro( UseLazySampling, bool );
+  itkGetConstMacro( UseLazySampling, bool );
+  itkBooleanMacro( UseLazySampling );
+
+  /** Get the sample grid, valid after an update with lazy sampling. */
+  itkGetConstReferenceMacro( SampleGrid, ImageSampleGridType );
+
+  /** Returns true if the last update only filled the sample grid. */
+  virtual bool IsLazySamplingUsed( void ) const
+  {
+    return this->m_UseLazySampling && this->SupportsLazySampling();
+  }
+
+
+  /** Set/Get whether the output samples are sorted by the cell of the
+   * sample order grid that they are in, see SetSampleOrderGrid(). The
+   * samples of one cell are then consecutive, and the cells follow a
+   * Morton (Z-order) curve, so that consecutive samples, and the samples
+   * of one thread, are close to each other. Only the order of the samples
+   * changes, not the samples themselves. Has no effect with lazy sampling,
+   * or when no grid is set. Default: false.
+   */
+  itkSetMacro( SortSamplesByGridCell, bool );
+  itkGetConstMacro( SortSamplesByGridCell, bool );
+  itkBooleanMacro( SortSamplesByGridCell );
+
+  /** Set the grid by whose cells the samples are sorted, typically the
+   * control point grid of a B-spline transform. The cells have the size
+   * of the spacing, and are aligned to the origin.
+   */
+  virtual void SetSampleOrderGrid( const InputImagePointType & origin,
+    const InputImageSpacingType & spacing, const InputImageDirectionType & direction );
+
+  /** Remove the sample order grid. */
+  virtual void RemoveSampleOrderGrid( void );
+
+
 protected:
 
   /** The constructor. */
@@ -185,6 +242,14 @@ protected:
   /** GenerateInputRequestedRegion. */
   void GenerateInputRequestedRegion( void ) override;
 
+  /** Sort the samples after they are generated, see SetSortSamplesByGridCell(),
+   * and record the time spent in the sampler and the number of samples drawn.
+   */
+  void UpdateOutputData( DataObject * output ) override;
+
+  /** Sort the output samples by the cells of the sample order grid. */
+  virtual void SortOutputSamples( void );
+
   /** IsInsideAllMasks. */
   virtual bool IsInsideAllMasks( const InputImagePointType & point ) const;
 
@@ -199,6 +264,13 @@ protected:
   /** Compute the intersection of the InputImageRegion and the bounding box of the mask. */
   void CropInputImageRegion( void );
 
+  /** Fill m_SampleGrid and count the grid points inside the mask,
+   * multi-threaded. For lazy sampling.
+   */
+  virtual void InitializeSampleGrid( const InputImageIndexType & startIndex,
+    const InputImageSizeType & gridSize,
+    const typename InputImageType::OffsetType & gridSpacing );
+
   /** Multi-threaded function that does the work. */
   void BeforeThreadedGenerateData( void ) override;
 
@@ -211,6 +283,19 @@ protected:
   //tmp?
   bool m_UseMultiThread;
 
+  /** Lazy sampling support. */
+  bool                m_UseLazySampling;
+  ImageSampleGridType m_SampleGrid;
+
+  /** Sample order support. The grid matrix maps a point minus the grid
+   * origin to its continuous cell index.
+   */
+  typedef Matrix< double, Self::InputImageDimension, Self::InputImageDimension > SampleOrderGridMatrixType;
+  bool                      m_SortSamplesByGridCell;
+  bool                      m_UseSampleOrderGrid;
+  InputImagePointType       m_SampleOrderGridOrigin;
+  SampleOrderGridMatrixType m_SampleOrderGridMatrix;
+
 private:
 
   /** The private constructor. */
@@ -20,6 +20,11 @@
 
 #include "itkImageSamplerBase.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+
 namespace itk
 {
 
@@ -37,7 +42,12 @@ ImageSamplerBase< TInputImage >
   this->m_NumberOfSamples           = 0;
 
   //tmp?
-  this->m_UseMultiThread = false;
+  this->m_UseMultiThread        = false;
+  this->m_UseLazySampling       = false;
+  this->m_SortSamplesByGridCell = false;
+  this->m_UseSampleOrderGrid    = false;
+  this->m_SampleOrderGridOrigin.Fill( 0.0 );
+  this->m_SampleOrderGridMatrix.SetIdentity();
 
 } // end Constructor()
 
@@ -406,6 +416,62 @@ ImageSamplerBase< TInputImage >
 } // end CropInputImageRegion()
 
 
+/**
+ * ******************* InitializeSampleGrid *******************
+ */
+
+template< class TInputImage >
+void
+ImageSamplerBase< TInputImage >
+::InitializeSampleGrid( const InputImageIndexType & startIndex,
+  const InputImageSizeType & gridSize,
+  const typename InputImageType::OffsetType & gridSpacing )
+{
+  typename MaskType::ConstPointer mask = this->GetMask();
+  if( mask.IsNotNull() && mask->GetSource() )
+  {
+    mask->GetSource()->Update();
+  }
+
+  this->m_SampleGrid.Initialize( this->GetInput(), mask.GetPointer(),
+    startIndex, gridSize, gridSpacing );
+  if( mask.IsNull() )
+  {
+    return;
+  }
+
+  /** Count the samples inside the mask, in parallel over chunks of grid points. */
+  const SizeValueType numberOfGridPoints = this->m_SampleGrid.GetNumberOfGridPoints();
+  const SizeValueType numberOfChunks     = std::max< SizeValueType >( 1,
+    std::min< SizeValueType >( this->GetNumberOfWorkUnits(), numberOfGridPoints ) );
+  std::vector< SizeValueType > chunkCounts( numberOfChunks, 0 );
+
+  const ImageSampleGridType & grid = this->m_SampleGrid;
+  this->GetMultiThreader()->ParallelizeArray( 0, numberOfChunks,
+    [ &grid, &chunkCounts, numberOfGridPoints, numberOfChunks ]( SizeValueType chunk )
+    {
+      const SizeValueType begin = chunk * numberOfGridPoints / numberOfChunks;
+      const SizeValueType end   = ( chunk + 1 ) * numberOfGridPoints / numberOfChunks;
+      SizeValueType       count = 0;
+      for( typename ImageSampleGridType::ConstIterator it = grid.Begin( begin, end );
+        it != grid.End( end ); ++it )
+      {
+        ++count;
+      }
+      chunkCounts[ chunk ] = count;
+    },
+    nullptr );
+
+  SizeValueType numberOfSamples = 0;
+  for( SizeValueType i = 0; i < numberOfChunks; ++i )
+  {
+    numberOfSamples += chunkCounts[ i ];
+  }
+  this->m_SampleGrid.SetNumberOfSamples( numberOfSamples );
+
+} // end InitializeSampleGrid()
+
+
 /**
  * ******************* BeforeThreadedGenerateData *******************
  */
@@ -485,10 +551,146 @@ ImageSamplerBase< TInputImage >
     os << indent.GetNextIndent() << this->m_InputImageRegionVector[ i ] << std::endl;
   }
   os << indent << "CroppedInputImageRegion" << this->m_CroppedInputImageRegion << std::endl;
+  os << indent << "UseLazySampling: " << this->m_UseLazySampling << std::endl;
+  os << indent << "SortSamplesByGridCell: " << this->m_SortSamplesByGridCell << std::endl;
+  os << indent << "UseSampleOrderGrid: " << this->m_UseSampleOrderGrid << std::endl;
 
 } // end PrintSelf()
 
 
+/**
+ * ******************* SetSampleOrderGrid *******************
+ */
+
+template< class TInputImage >
+void
+ImageSamplerBase< TInputImage >
+::SetSampleOrderGrid( const InputImagePointType & origin,
+  const InputImageSpacingType & spacing, const InputImageDirectionType & direction )
+{
+  /** The continuous cell index of a point p is S^-1 D^-1 ( p - origin ). */
+  SampleOrderGridMatrixType matrix( direction.GetInverse() );
+  for( unsigned int i = 0; i < InputImageDimension; ++i )
+  {
+    for( unsigned int j = 0; j < InputImageDimension; ++j )
+    {
+      matrix[ i ][ j ] /= spacing[ i ];
+    }
+  }
+
+  if( !this->m_UseSampleOrderGrid
+    || this->m_SampleOrderGridOrigin != origin
+    || this->m_SampleOrderGridMatrix != matrix )
+  {
+    this->m_UseSampleOrderGrid    = true;
+    this->m_SampleOrderGridOrigin = origin;
+    this->m_SampleOrderGridMatrix = matrix;
+    this->Modified();
+  }
+
+} // end SetSampleOrderGrid()
+
+
+/**
+ * ******************* RemoveSampleOrderGrid *******************
+ */
+
+template< class TInputImage >
+void
+ImageSamplerBase< TInputImage >
+::RemoveSampleOrderGrid( void )
+{
+  if( this->m_UseSampleOrderGrid )
+  {
+    this->m_UseSampleOrderGrid = false;
+    this->Modified();
+  }
+
+} // end RemoveSampleOrderGrid()
+
+
+/**
+ * ******************* SortOutputSamples *******************
+ */
+
+template< class TInputImage >
+void
+ImageSamplerBase< TInputImage >
+::SortOutputSamples( void )
+{
+  if( !this->m_SortSamplesByGridCell || !this->m_UseSampleOrderGrid
+    || this->IsLazySamplingUsed() )
+  {
+    return;
+  }
+
+  typedef typename ImageSampleContainerType::STLContainerType SampleVectorType;
+  SampleVectorType & samples         = this->GetOutput()->CastToSTLContainer();
+  const std::size_t  numberOfSamples = samples.size();
+  if( numberOfSamples < 2 )
+  {
+    return;
+  }
+
+  /** The Morton code of a cell interleaves the bits of its cell indices.
+   * The cell indices are clamped to [0, 2^bitsPerDimension), which covers
+   * the grid of a B-spline transform, since its origin is at a corner.
+   */
+  const unsigned int bitsPerDimension = std::min( 64u / InputImageDimension, 16u );
+  const double       maximumCellIndex = static_cast< double >( ( 1u << bitsPerDimension ) - 1 );
+
+  typedef std::pair< std::uint64_t, std::size_t > SortKeyType;
+  std::vector< SortKeyType > sortKeys( numberOfSamples );
+  for( std::size_t i = 0; i < numberOfSamples; ++i )
+  {
+    const typename InputImagePointType::VectorType cell
+      = this->m_SampleOrderGridMatrix * ( samples[ i ].m_ImageCoordinates - this->m_SampleOrderGridOrigin );
+
+    std::uint64_t code = 0;
+    for( unsigned int d = 0; d < InputImageDimension; ++d )
+    {
+      const std::uint64_t cellIndex = static_cast< std::uint64_t >(
+        std::min( std::max( std::floor( cell[ d ] ), 0.0 ), maximumCellIndex ) );
+      for( unsigned int b = 0; b < bitsPerDimension; ++b )
+      {
+        code |= ( ( cellIndex >> b ) & 1u ) << ( b * InputImageDimension + d );
+      }
+    }
+    sortKeys[ i ] = SortKeyType( code, i );
+  }
+
+  /** Sort by cell. Within a cell, the original order is kept. */
+  std::sort( sortKeys.begin(), sortKeys.end() );
+
+  SampleVectorType sortedSamples;
+  sortedSamples.reserve( numberOfSamples );
+  for( std::size_t i = 0; i < numberOfSamples; ++i )
+  {
+    sortedSamples.push_back( samples[ sortKeys[ i ].second ] );
+  }
+  samples.swap( sortedSamples );
+
+} // end SortOutputSamples()
+
+
+/**
+ * ******************* UpdateOutputData *******************
+ */
+
+template< class TInputImage >
+void
+ImageSamplerBase< TInputImage >
+::UpdateOutputData( DataObject * output )
+{
+  elxProfileScope( SamplerPhase );
+  this->Superclass::UpdateOutputData( output );
+  this->SortOutputSamples();
+  elxProfileCount( SamplesDrawnCounter, this->IsLazySamplingUsed()
+    ? this->m_SampleGrid.GetNumberOfSamples() : this->GetOutput()->Size() );
+
+} // end UpdateOutputData()
+
+
 } // end namespace itk
 
 #endif // end #ifndef __ImageSamplerBase_hxx
@@ -24,6 +24,7 @@
 #include "itkMetaDataObject.h"
 #include "itkVersion.h"
 #include "itkNumericTraits.h"
+#include "itkMultiThreaderBase.h"
 
 // developed using gdcm 2.0 and libtiff 3.8.2
 #include "gdcmAttribute.h"
@@ -44,6 +45,7 @@
 #include "gdcmException.h"
 #include "gdcmFileMetaInformation.h"
 
+#include <algorithm>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -76,6 +78,7 @@ MevisDicomTiffImageIO
   m_TileLength( 0 ),
   m_TileDepth( 0 ),
   m_NumberOfTiles( 0 ),
+  m_NumberOfSlicesToWrite( 0 ),
   m_RescaleSlope( NumericTraits< double >::OneValue() ),
   m_RescaleIntercept( NumericTraits< double >::ZeroValue() ),
   m_GantryTilt( NumericTraits< double >::ZeroValue() ),
@@ -130,6 +133,7 @@ MevisDicomTiffImageIO::PrintSelf( std::ostream & os, Indent indent ) const
   os << indent << "TileLength       : " << m_TileLength << std::endl;
   os << indent << "TileDepth        : " << m_TileDepth << std::endl;
   os << indent << "NumberOfTiles    : " << m_NumberOfTiles << std::endl;
+  os << indent << "SlicesToWrite    : " << m_NumberOfSlicesToWrite << std::endl;
   os << indent << "RescaleIntercept : " << m_RescaleIntercept << std::endl;
   os << indent << "RescaleSlope     : " << m_RescaleSlope << std::endl;
   os << indent << "GantryTilt       : " << m_GantryTilt << std::endl;
@@ -827,7 +831,7 @@ MevisDicomTiffImageIO::Read( void * buffer )
   // note *buffer goes in scanline order!
   // very inconvenient if the tiff image is tiled, which damned
   // is the case for mevislab images!
-  // note buffer is already allocated, according to size!
+  // note buffer is already allocated, according to the size of the io region!
 
   short int p;
   if( !TIFFGetField( m_TIFFImage, TIFFTAG_PLANARCONFIG, &p ) )
@@ -843,357 +847,161 @@ MevisDicomTiffImageIO::Read( void * buffer )
     }
   }
 
-  if( m_IsTiled )
+  if( !m_IsTiled )
   {
-    // only works for tile depth == 1 (used by mevislab),
-    // therefore in z-direction we do not need to do checking
-    // if the volume is multiple of tile.
-    if( m_TIFFDimension == 3 && m_TileDepth != 1 )
-    {
-      itkExceptionMacro( << "mevisIO:read(): unsupported tiledepth (should be one)! " );
-      return;
-    }
+    // if not tiled then img is stripped
+    itkExceptionMacro( << "mevisIO:read(): non-tiled dcm/tiff reading not (yet) implemented" );
+    return;
+  }
 
-    // buffer pointer is scanline based (one dimensional array)
-    // tile is positioned on x,y,z; we read each tile, and fill
-    // the corresponding positions in the onedimensional array
-    unsigned char * vol = reinterpret_cast< unsigned char * >( buffer );
+  // only works for tile depth == 1 (used by mevislab),
+  // therefore in z-direction we do not need to do checking
+  // if the volume is multiple of tile.
+  if( m_TIFFDimension == 3 && m_TileDepth != 1 )
+  {
+    itkExceptionMacro( << "mevisIO:read(): unsupported tiledepth (should be one)! " );
+    return;
+  }
 
-    const unsigned int tilesize       = TIFFTileSize( m_TIFFImage );
-    const unsigned int tilerowbytes   = TIFFTileRowSize( m_TIFFImage );
-    const unsigned int bytespersample = m_BitsPerSample / 8;
+  // the buffer only holds the requested io region. Only the tiles
+  // that intersect this region are read; the part of the tile inside
+  // the region is copied row by row into the buffer. Tiles that are
+  // larger than the image, or that lie on the right/bottom boundary,
+  // are handled by the same intersection.
+  std::vector< unsigned int > slices;
+  this->GetTIFFSlicesOfIORegion( slices );
 
-    unsigned char * tilebuf = static_cast< unsigned char * >( _TIFFmalloc( tilesize ) );
+  const unsigned int regionx0 = m_IORegion.GetIndex( 0 );
+  const unsigned int regiony0 = m_IORegion.GetIndex( 1 );
+  const unsigned int regionx1 = regionx0 + m_IORegion.GetSize( 0 );
+  const unsigned int regiony1 = regiony0 + m_IORegion.GetSize( 1 );
+  if( regionx1 > m_Width || regiony1 > m_Length )
+  {
+    itkExceptionMacro( << "mevisIO:read(): requested region lies outside the image" );
+  }
 
-    //
-    // special cases, if the tilexy is larger than or equal to the image
-    // size itself, treat as three separate cases, both are larger/equal,
-    // or only direction
-    //
-    bool tileoversized( false );
+  const unsigned int tilex0                = regionx0 / m_TileWidth;
+  const unsigned int tiley0                = regiony0 / m_TileLength;
+  const unsigned int numberOfTilesX        = ( regionx1 + m_TileWidth - 1 ) / m_TileWidth - tilex0;
+  const unsigned int numberOfTilesY        = ( regiony1 + m_TileLength - 1 ) / m_TileLength - tiley0;
+  const unsigned int numberOfTilesPerSlice = numberOfTilesX * numberOfTilesY;
+  const std::size_t  numberOfTiles         = numberOfTilesPerSlice * slices.size();
+  if( numberOfTiles == 0 )
+  {
+    return;
+  }
 
-    if( m_TileLength >= m_Length || m_TileWidth >= m_Width )
-    {
-      tileoversized = true;
+  const unsigned int tilesize       = TIFFTileSize( m_TIFFImage );
+  const unsigned int tilerowbytes   = TIFFTileRowSize( m_TIFFImage );
+  const unsigned int bytespersample = m_BitsPerSample / 8;
+  const std::size_t  volrowbytes    = m_IORegion.GetSize( 0 ) * bytespersample;
+  const std::size_t  volslicebytes  = volrowbytes * m_IORegion.GetSize( 1 );
 
-      // case one both x,y is larger
-      if( m_TileLength >= m_Length && m_TileWidth >= m_Width )
-      {
-        for( unsigned int z0 = 0; z0 < ( m_TIFFDimension == 3 ? m_Depth : 1 ); z0++ )
-        {
-          if( TIFFReadTile( m_TIFFImage, tilebuf, 0, 0, z0, 0 ) < 0 )
-          {
-            _TIFFfree( tilebuf );
-            itkExceptionMacro( << "mevisIO:read(): error reading tile (topleft)" );
-            return;
-          }
-          else
-          {
-            // do row based copy of tile into volume
-            const unsigned     lenx       = m_Width;
-            const unsigned     leny       = m_Length;
-            const unsigned int tilexbytes = lenx * bytespersample;
-
-            unsigned char *    pv = vol;
-            const unsigned int p  = z0 * m_Length * m_Width;
-            pv += p * bytespersample;
-
-            unsigned char * pb = tilebuf;
-            for( unsigned int r = 0; r < leny; ++r )
-            {
-              memcpy( pv, pb, tilexbytes );
-              pv += tilexbytes;
-              pb += tilerowbytes;
-            }
-          }
-        }
-      } // end case one
+  unsigned char * vol = reinterpret_cast< unsigned char * >( buffer );
 
-      // case two, larger x, smaller y
-      if( m_TileWidth >= m_Width && m_TileLength < m_Length )
-      {
+  // a tiff handle can not be shared between threads, therefore
+  // the tiles are divided into contiguous chunks, and each chunk
+  // is decoded using its own handle. The first chunk uses the
+  // handle that was opened by CanReadFile().
+  MultiThreaderBase::Pointer threader       = MultiThreaderBase::New();
+  const unsigned int         numberOfChunks = static_cast< unsigned int >(
+    std::min< std::size_t >( threader->GetNumberOfWorkUnits(), numberOfTiles ) );
+  std::vector< unsigned char > chunkfailed( numberOfChunks, 0 );
 
-        const unsigned     lenx       = m_Width;
-        const unsigned int tilexbytes = lenx * bytespersample;
+  threader->ParallelizeArray( 0, numberOfChunks,
+    [ &, this ]( SizeValueType chunk )
+    {
+      TIFF * tif = ( chunk == 0 ) ? m_TIFFImage : TIFFOpen( m_TiffFileName.c_str(), "rc" );
+      if( tif == nullptr )
+      {
+        chunkfailed[ chunk ] = 1;
+        return;
+      }
+      unsigned char * tilebuf = static_cast< unsigned char * >( _TIFFmalloc( tilesize ) );
 
-        const bool my = ( m_Length % m_TileLength == 0 ) ? true : false;
-        for( unsigned int z0 = 0; z0 < ( m_TIFFDimension == 3 ? m_Depth : 1 ); z0++ )
+      const std::size_t first = chunk * numberOfTiles / numberOfChunks;
+      const std::size_t last  = ( chunk + 1 ) * numberOfTiles / numberOfChunks;
+      for( std::size_t t = first; t < last && tilebuf != nullptr; ++t )
+      {
+        // x0,y0,z0 is position of tile in volume, top left corner
+        const std::size_t  s  = t / numberOfTilesPerSlice;
+        const unsigned int i  = t % numberOfTilesPerSlice;
+        const unsigned int x0 = ( tilex0 + i % numberOfTilesX ) * m_TileWidth;
+        const unsigned int y0 = ( tiley0 + i / numberOfTilesX ) * m_TileLength;
+        const unsigned int z0 = slices[ s ];
+
+        if( TIFFReadTile( tif, tilebuf, x0, y0, z0, 0 ) < 0 )
         {
-          for( unsigned int y0 = 0; y0 < ( my ? m_Length : m_Length - m_TileLength ); y0 += m_TileLength )
-          {
-            if( TIFFReadTile( m_TIFFImage, tilebuf, 0, y0, z0, 0 ) < 0 )
-            {
-              _TIFFfree( tilebuf );
-              itkExceptionMacro( << "mevisIO:read(): error reading tile (top image)" );
-              return;
-            }
-            else
-            {
-
-              unsigned char *    pb = tilebuf;
-              unsigned char *    pv = vol;
-              const unsigned int p  = z0 * m_Length * m_Width + y0 * m_Width;
-              pv += p * bytespersample;
-
-              for( unsigned int r = 0; r < m_TileLength; ++r )
-              {
-                memcpy( pv, pb, tilerowbytes );
-                pv += tilexbytes;
-                pb += tilerowbytes;
-              }
-            }
-          }
-
-          if( !my )
-          {
-            const unsigned     leny = m_Length % m_TileLength;
-            const unsigned int y0   = m_Length - leny;
-
-            if( TIFFReadTile( m_TIFFImage, tilebuf, 0, y0, z0, 0 ) < 0 )
-            {
-              _TIFFfree( tilebuf );
-              itkExceptionMacro( << "mevisIO:read(): error reading tile (strip bottom)" );
-              return;
-            }
-            else
-            {
-              unsigned char *    pb = tilebuf;
-              unsigned char *    pv = vol;
-              const unsigned int p  = z0 * m_Length * m_Width + y0 * m_Width;
-              pv += p * bytespersample;
-
-              for( unsigned int r = 0; r < leny; ++r )
-              {
-                memcpy( pv, pb, tilexbytes );
-                pv += tilexbytes;
-                pb += tilerowbytes;
-              }
-            }
-          }
+          chunkfailed[ chunk ] = 1;
+          break;
         }
 
-      } // end case two
-
-      // case three, smaller x, larger y
-      if( m_TileWidth < m_Width && m_TileLength >= m_Length )
-      {
-
-        const unsigned leny = m_Length;
-        const bool     mx   = ( m_Width % m_TileWidth == 0 ) ? true : false;
-
-        for( unsigned int z0 = 0; z0 < ( m_TIFFDimension == 3 ? m_Depth : 1 ); z0++ )
+        // part of the tile inside the region
+        const unsigned int xb         = std::max( x0, regionx0 );
+        const unsigned int xe         = std::min( x0 + m_TileWidth, regionx1 );
+        const unsigned int yb         = std::max( y0, regiony0 );
+        const unsigned int ye         = std::min( y0 + m_TileLength, regiony1 );
+        const std::size_t  tilexbytes = ( xe - xb ) * bytespersample;
+
+        // do row based copy of tile into volume
+        const unsigned char * pb = tilebuf + ( yb - y0 ) * tilerowbytes + ( xb - x0 ) * bytespersample;
+        unsigned char *       pv = vol + s * volslicebytes + ( yb - regiony0 ) * volrowbytes
+          + ( xb - regionx0 ) * bytespersample;
+        for( unsigned int r = yb; r < ye; ++r )
         {
-          for( unsigned int x0 = 0; x0 < ( mx ? m_Width : m_Width - m_TileWidth ); x0 += m_TileWidth )
-          {
-            // read tile
-            if( TIFFReadTile( m_TIFFImage, tilebuf, x0, 0, z0, 0 ) < 0 )
-            {
-              _TIFFfree( tilebuf );
-              itkExceptionMacro( << "mevisIO:read(): error reading tile (top image)" );
-              return;
-            }
-            else
-            {
-              unsigned char *    pb = tilebuf;
-              unsigned char *    pv = vol;
-              const unsigned int p  = z0 * m_Length * m_Width + x0;
-              pv += p * bytespersample;
-
-              for( unsigned int r = 0; r < leny; ++r )
-              {
-                memcpy( pv, pb, tilerowbytes );
-                pv += m_Width * bytespersample;
-                pb += tilerowbytes;
-              }
-            }
-          }
-          // fill strip right
-          if( !mx )
-          {
-            const unsigned     lenx       = m_Width % m_TileWidth;
-            const unsigned int x0         = m_Width - lenx;
-            const unsigned int tilexbytes = lenx * bytespersample;
-
-            if( TIFFReadTile( m_TIFFImage, tilebuf, x0, 0, z0, 0 ) < 0 )
-            {
-              _TIFFfree( tilebuf );
-              itkExceptionMacro( << "mevisIO:read(): error reading tile (strip right)" );
-              return;
-            }
-            else
-            {
-              unsigned char *    pb = tilebuf;
-              unsigned char *    pv = vol;
-              const unsigned int p  = z0 * m_Length * m_Width + x0;
-              pv += p * bytespersample;
-
-              for( unsigned int r = 0; r < leny; ++r )
-              {
-                memcpy( pv, pb, tilexbytes );
-                pv += m_Width * bytespersample;
-                pb += tilerowbytes;
-              }
-            }
-          }
+          memcpy( pv, pb, tilexbytes );
+          pv += volrowbytes;
+          pb += tilerowbytes;
         }
+      }
 
-      } // end case three
-
-    } // end oversized tile
-
-    //
-    // normal case, tile is smaller than image
-    //
-    if( !tileoversized )
-    {
-      // is volume direction a multiple of tiledirection?
-      const bool mx = ( m_Width % m_TileWidth == 0 ) ? true : false;
-      const bool my = ( m_Length % m_TileLength == 0 ) ? true : false;
-
-      // fill everything inside ie from topleft
-      for( unsigned int z0 = 0; z0 < ( m_TIFFDimension == 3 ? m_Depth : 1 ); z0++ )
+      if( tilebuf == nullptr )
       {
-        for( unsigned int y0 = 0; y0 < ( my ? m_Length : m_Length - m_TileLength ); y0 += m_TileLength )
-        {
-          for( unsigned int x0 = 0; x0 < ( mx ? m_Width : m_Width - m_TileWidth ); x0 += m_TileWidth )
-          {
-            // x0,y0,z0 is position of tile in volume, top left corner
-            // pointer to volume (at 0,0,0)
-            unsigned char * pv = vol;
-
-            // set pointer of volume to y0,x0,z0 position
-            const unsigned int p = z0 * m_Length * m_Width + y0 * m_Width + x0;
-            pv += p * bytespersample;
-
-            // read tile
-            if( TIFFReadTile( m_TIFFImage, tilebuf, x0, y0, z0, 0 ) < 0 )
-            {
-              _TIFFfree( tilebuf );
-              itkExceptionMacro( << "mevisIO:read(): error reading tile (topleft image)" );
-              return;
-            }
-            else
-            {
-              // do row based copy of tile into volume
-              unsigned char * pb = tilebuf;
-              for( unsigned int r = 0; r < m_TileLength; ++r )
-              {
-                memcpy( pv, pb, tilerowbytes );
-                // move pointers
-                // x remain same, y is one complete vol line
-                // (ie width of image)
-                pv += m_Width * bytespersample;
-                pb += tilerowbytes;
-              }
-            }
+        chunkfailed[ chunk ] = 1;
+      }
+      else
+      {
+        _TIFFfree( tilebuf );
+      }
+      if( chunk != 0 )
+      {
+        TIFFClose( tif );
+      }
+    },
+    nullptr );
 
-          }
-        }
-        // fill boundaries
-        if( !mx )
-        {
-          // x is fixed
-          const unsigned     lenx       = m_Width % m_TileWidth;
-          const unsigned int x0         = m_Width - lenx;
-          const unsigned int tilexbytes = lenx * bytespersample;
+  for( unsigned int chunk = 0; chunk < numberOfChunks; ++chunk )
+  {
+    if( chunkfailed[ chunk ] )
+    {
+      itkExceptionMacro( << "mevisIO:read(): error reading tile" );
+    }
+  }
+}
 
-          for( unsigned int y0 = 0; y0 < ( my ? m_Length : m_Length - m_TileLength ); y0 += m_TileLength )
-          {
-            unsigned char *    pv = vol;
-            const unsigned int p  = z0 * m_Length * m_Width + y0 * m_Width + x0;
-            pv += p * bytespersample;
-
-            if( TIFFReadTile( m_TIFFImage, tilebuf, x0, y0, z0, 0 ) < 0 )
-            {
-              _TIFFfree( tilebuf );
-              itkExceptionMacro( << "mevisIO:read(): error reading tile (ydirection)" );
-              return;
-            }
-            else
-            {
-              unsigned char * pb = tilebuf;
-              for( unsigned int r = 0; r < m_TileLength; ++r )
-              {
-                memcpy( pv, pb, tilexbytes );
-                pv += m_Width * bytespersample;
-                pb += tilerowbytes;
-              }
-            }
-          }
-        }
-        if( !my )
-        {
-          // y is fixed
-          const unsigned     leny = m_Length % m_TileLength;
-          const unsigned int y0   = m_Length - leny;
 
-          for( unsigned int x0 = 0; x0 < ( mx ? m_Width : m_Width - m_TileWidth ); x0 += m_TileWidth )
-          {
-            unsigned char *    pv = vol;
-            const unsigned int p  = z0 * m_Length * m_Width + y0 * m_Width + x0;
-            pv += p * bytespersample;
-
-            if( TIFFReadTile( m_TIFFImage, tilebuf, x0, y0, z0, 0 ) < 0 )
-            {
-              _TIFFfree( tilebuf );
-              itkExceptionMacro( << "mevisIO:read(): error reading tile (x-direction)" );
-              return;
-            }
-            else
-            {
-              unsigned char * pb = tilebuf;
-              for( unsigned int r = 0; r < leny; ++r )
-              {
-                memcpy( pv, pb, tilerowbytes );
-                pv += m_Width * bytespersample;
-                pb += tilerowbytes;
-              }
-            }
-          }
-        }
-        // fill corner bottom
-        if( !mx && !my )
-        {
-          // x0,y0 is fixed
-          const unsigned     lenx       = m_Width % m_TileWidth;
-          const unsigned int x0         = m_Width - lenx;
-          const unsigned int tilexbytes = lenx * bytespersample;
-          const unsigned     leny       = m_Length % m_TileLength;
-          const unsigned int y0         = m_Length - leny;
-
-          unsigned char *    pv = vol;
-          const unsigned int p  = z0 * m_Length * m_Width + y0 * m_Width + x0;
-          pv += p * bytespersample;
-
-          if( TIFFReadTile( m_TIFFImage, tilebuf, x0, y0, z0, 0 ) < 0 )
-          {
-            _TIFFfree( tilebuf );
-            itkExceptionMacro( << "mevisIO:read(): error reading tile (corner bottom)" );
-            return;
-          }
-          else
-          {
-            unsigned char * pb = tilebuf;
-            for( unsigned int r = 0; r < leny; ++r )
-            {
-              memcpy( pv, pb, tilexbytes );
-              pv += m_Width * bytespersample;
-              pb += tilerowbytes;
-            }
-          }
-        }
-      }
+// gettiffslicesofioregion
+void
+MevisDicomTiffImageIO::GetTIFFSlicesOfIORegion( std::vector< unsigned int > & slices ) const
+{
+  // the tiff image is always 2D or 3D; for 4D images
+  // the slices of all time points are stacked in z
+  const unsigned int dim = m_IORegion.GetImageDimension();
+  const unsigned int z2  = dim > 2 ? m_IORegion.GetIndex( 2 ) : 0;
+  const unsigned int n2  = dim > 2 ? m_IORegion.GetSize( 2 ) : 1;
+  const unsigned int z3  = dim > 3 ? m_IORegion.GetIndex( 3 ) : 0;
+  const unsigned int n3  = dim > 3 ? m_IORegion.GetSize( 3 ) : 1;
+  const unsigned int d2  = dim > 2 ? m_Dimensions[ 2 ] : 1;
+
+  slices.clear();
+  slices.reserve( n2 * n3 );
+  for( unsigned int k3 = z3; k3 < z3 + n3; ++k3 )
+  {
+    for( unsigned int k2 = z2; k2 < z2 + n2; ++k2 )
+    {
+      slices.push_back( k3 * d2 + k2 );
     }
-
-    _TIFFfree( tilebuf );
-  }
-  else
-  {
-    // if not tiled then img is stripped
-    itkExceptionMacro( << "mevisIO:read(): non-tiled dcm/tiff reading not (yet) implemented" );
-    return;
   }
-  return;
 }
 
 
@@ -1281,6 +1089,23 @@ MevisDicomTiffImageIO
     itkExceptionMacro( << "mevisIO:write(): dcm/tiff writer only supports 2D/3D/4D" );
   }
 
+  // the tiles of a slice are written at once, so the
+  // io region must consist of complete slices
+  if( m_IORegion.GetIndex( 0 ) != 0 || m_IORegion.GetIndex( 1 ) != 0
+    || m_IORegion.GetSize( 0 ) != m_Dimensions[ 0 ]
+    || m_IORegion.GetSize( 1 ) != m_Dimensions[ 1 ] )
+  {
+    itkExceptionMacro( << "mevisIO:write(): io region should consist of complete slices" );
+  }
+
+  // a streamed write is in progress: the dcm header and
+  // the tiff tags have been written by the first call
+  if( m_NumberOfSlicesToWrite > 0 )
+  {
+    this->WriteTiles( buffer );
+    return;
+  }
+
   std::ofstream dcmfile( m_DcmFileName.c_str(), std::ios::out | std::ios::binary );
   if( !dcmfile.is_open() )
   {
@@ -1714,6 +1539,7 @@ MevisDicomTiffImageIO
   {
     itkExceptionMacro( << "mevisIO:write(): error opening tiff file for writing" );
   }
+  m_IsOpen = true;
 
   // software comment
   if( !TIFFSetField( m_TIFFImage, TIFFTAG_SOFTWARE, c.c_str() ) )
@@ -1985,154 +1811,123 @@ MevisDicomTiffImageIO
     // now left open.
 
     TIFFClose( m_TIFFImage );
+    m_IsOpen = false;
     itkExceptionMacro( << "mevisIO:write(): image x,y smaller than tilesize (16)! Consider different layout for tif (eg scanline layout)" );
     return;
   }
-  else
-  {
-    const unsigned int tilesize       = TIFFTileSize( m_TIFFImage );
-    const unsigned int tilerowbytes   = TIFFTileRowSize( m_TIFFImage );
-    const unsigned int bytespersample = m_BitsPerSample / 8;
 
-    const unsigned char * vol     = reinterpret_cast< const unsigned char * >( buffer );
-    unsigned char *       tilebuf = static_cast< unsigned char * >( _TIFFmalloc( tilesize ) );
+  // when streaming, the following calls to Write() add
+  // the tiles of the remaining slices to the open tiff file
+  m_NumberOfSlicesToWrite = ( m_TIFFDimension == 3 ? m_Depth : 1 );
+  this->WriteTiles( buffer );
 
-    // is volume direction a multiple of tiledirection?
-    const bool mx = ( m_Width % m_TileWidth == 0 ) ? true : false;
-    const bool my = ( m_Length % m_TileLength == 0 ) ? true : false;
-
-    for( unsigned int z0 = 0; z0 < ( m_TIFFDimension == 3 ? m_Depth : 1 ); z0++ )
-    {
-      for( unsigned int y0 = 0; y0 < ( my ? m_Length : m_Length - m_TileLength ); y0 += m_TileLength )
-      {
-        for( unsigned int x0 = 0; x0 < ( mx ? m_Width : m_Width - m_TileWidth ); x0 += m_TileWidth )
-        {
-          // set bufferpointer to begin of tile
-          const unsigned char * pv = vol;
-          const unsigned int    p  = z0 * m_Length * m_Width + y0 * m_Width + x0;
-          pv += p * bytespersample;
-
-          // fill tile
-          unsigned char * pb = tilebuf;
-          for( unsigned int r = 0; r < m_TileLength; ++r )
-          {
-            memcpy( pb, pv, tilerowbytes );
-            pv += m_Width * bytespersample;
-            pb += tilerowbytes;
-          }
-          // write tile
-          if( TIFFWriteTile( m_TIFFImage, tilebuf, x0, y0, z0, 0 ) < 0 )
-          {
-
-            _TIFFfree( tilebuf );
-            TIFFClose( m_TIFFImage );
-            itkExceptionMacro( << "mevisIO:write(): error writing tile." );
-            return;
-          }
-        }
-      }
-      // boundaries
-      if( !mx )
-      {
-        // x is fixed
-        const unsigned     lenx       = m_Width % m_TileWidth;
-        const unsigned int x0         = m_Width - lenx;
-        const unsigned int tilexbytes = lenx * bytespersample;
-
-        for( unsigned int y0 = 0; y0 < ( my ? m_Length : m_Length - m_TileLength ); y0 += m_TileLength )
-        {
-          const unsigned char * pv = vol;
-          const unsigned int    p  = z0 * m_Length * m_Width + y0 * m_Width + x0;
-          pv += p * bytespersample;
+  return;
+}
 
-          unsigned char * pb = tilebuf;
-          memset( pb, 0, tilesize );
 
-          // fill tile
-          for( unsigned int r = 0; r < m_TileLength; ++r )
-          {
-            memcpy( pb, pv, tilexbytes );
-            pv += m_Width * bytespersample;
-            pb += tilerowbytes;
-          }
-
-          if( TIFFWriteTile( m_TIFFImage, tilebuf, x0, y0, z0, 0 ) < 0 )
-          {
-            _TIFFfree( tilebuf );
-            TIFFClose( m_TIFFImage );
-            itkExceptionMacro( << "mevisIO:write(): error writing tile (ydirection)" );
-            return;
-          }
-        }
-      }
-      if( !my )
+// writetiles
+void
+MevisDicomTiffImageIO::WriteTiles( const void * buffer )
+{
+  // now filling the image with buffer provided
+  // the provided buffer is one dimensional array holding
+  // complete slices. Boundary tiles are padded with zeros,
+  // to prevent assessing memblocks outside the array
+  std::vector< unsigned int > slices;
+  this->GetTIFFSlicesOfIORegion( slices );
+
+  const unsigned int tilesize              = TIFFTileSize( m_TIFFImage );
+  const unsigned int tilerowbytes          = TIFFTileRowSize( m_TIFFImage );
+  const unsigned int bytespersample        = m_BitsPerSample / 8;
+  const unsigned int numberOfTilesX        = ( m_Width + m_TileWidth - 1 ) / m_TileWidth;
+  const unsigned int numberOfTilesY        = ( m_Length + m_TileLength - 1 ) / m_TileLength;
+  const unsigned int numberOfTilesPerSlice = numberOfTilesX * numberOfTilesY;
+  const std::size_t  volrowbytes           = static_cast< std::size_t >( m_Width ) * bytespersample;
+  const std::size_t  volslicebytes         = volrowbytes * m_Length;
+
+  const unsigned char *        vol = reinterpret_cast< const unsigned char * >( buffer );
+  std::vector< unsigned char > tilebufs( static_cast< std::size_t >( numberOfTilesPerSlice ) * tilesize );
+
+  // the tiles of a slice are gathered in parallel. The compression
+  // is done by libtiff inside TIFFWriteTile, on the single tiff
+  // handle, so the tiles are subsequently written one by one.
+  MultiThreaderBase::Pointer threader = MultiThreaderBase::New();
+  for( std::size_t s = 0; s < slices.size(); ++s )
+  {
+    const unsigned char * slice = vol + s * volslicebytes;
+
+    threader->ParallelizeArray( 0, numberOfTilesPerSlice,
+      [ &, this ]( SizeValueType i )
       {
-        const unsigned     leny = m_Length % m_TileLength;
-        const unsigned int y0   = m_Length - leny;
+        const unsigned int x0   = ( i % numberOfTilesX ) * m_TileWidth;
+        const unsigned int y0   = ( i / numberOfTilesX ) * m_TileLength;
+        const unsigned int lenx = std::min( m_TileWidth, m_Width - x0 );
+        const unsigned int leny = std::min( m_TileLength, m_Length - y0 );
 
-        for( unsigned int x0 = 0; x0 < ( mx ? m_Width : m_Width - m_TileWidth ); x0 += m_TileWidth )
+        unsigned char * pb = &tilebufs[ i * tilesize ];
+        if( lenx < m_TileWidth || leny < m_TileLength )
         {
-          const unsigned char * pv = vol;
-          const unsigned int    p  = z0 * m_Length * m_Width + y0 * m_Width + x0;
-          pv += p * bytespersample;
-
-          unsigned char * pb = tilebuf;
           memset( pb, 0, tilesize );
-
-          for( unsigned int r = 0; r < leny; ++r )
-          {
-            memcpy( pb, pv, tilerowbytes );
-            pv += m_Width * bytespersample;
-            pb += tilerowbytes;
-          }
-
-          if( TIFFWriteTile( m_TIFFImage, tilebuf, x0, y0, z0, 0 ) < 0 )
-          {
-            _TIFFfree( tilebuf );
-            TIFFClose( m_TIFFImage );
-            itkExceptionMacro( << "mevisIO:write(): error writing tile (x-direction)" );
-            return;
-          }
         }
-      }
-      if( !mx && !my )
-      {
-        // x0,y0 is fixed
-        const unsigned     lenx       = m_Width % m_TileWidth;
-        const unsigned int x0         = m_Width - lenx;
-        const unsigned int tilexbytes = lenx * bytespersample;
-        const unsigned     leny       = m_Length % m_TileLength;
-        const unsigned int y0         = m_Length - leny;
-
-        const unsigned char * pv = vol;
-        const unsigned int    p  = z0 * m_Length * m_Width + y0 * m_Width + x0;
-        pv += p * bytespersample;
-
-        unsigned char * pb = tilebuf;
-        memset( pb, 0, tilesize );
 
+        // fill tile
+        const unsigned char * pv = slice + y0 * volrowbytes + x0 * bytespersample;
         for( unsigned int r = 0; r < leny; ++r )
         {
-          memcpy( pb, pv, tilexbytes );
-          pv += m_Width * bytespersample;
+          memcpy( pb, pv, lenx * bytespersample );
+          pv += volrowbytes;
           pb += tilerowbytes;
         }
+      },
+      nullptr );
 
-        if( TIFFWriteTile( m_TIFFImage, tilebuf, x0, y0, z0, 0 ) < 0 )
-        {
-          _TIFFfree( tilebuf );
-          TIFFClose( m_TIFFImage );
-          itkExceptionMacro( << "mevisIO:write(): error writing tile (corner bottom)" );
-          return;
-        }
+    for( unsigned int i = 0; i < numberOfTilesPerSlice; ++i )
+    {
+      const unsigned int x0 = ( i % numberOfTilesX ) * m_TileWidth;
+      const unsigned int y0 = ( i / numberOfTilesX ) * m_TileLength;
+      if( TIFFWriteTile( m_TIFFImage, &tilebufs[ i * tilesize ], x0, y0, slices[ s ], 0 ) < 0 )
+      {
+        TIFFClose( m_TIFFImage );
+        m_IsOpen                = false;
+        m_NumberOfSlicesToWrite = 0;
+        itkExceptionMacro( << "mevisIO:write(): error writing tile." );
+        return;
       }
-    } // end z
-    _TIFFfree( tilebuf );
+    }
   }
 
-  TIFFClose( m_TIFFImage );
+  // close the tiff file after its last slice
+  m_NumberOfSlicesToWrite -= std::min< unsigned int >( m_NumberOfSlicesToWrite, slices.size() );
+  if( m_NumberOfSlicesToWrite == 0 )
+  {
+    TIFFClose( m_TIFFImage );
+    m_IsOpen = false;
+  }
+}
 
-  return;
+
+// getactualnumberofsplitsforwriting
+unsigned int
+MevisDicomTiffImageIO::GetActualNumberOfSplitsForWriting(
+  unsigned int numberOfRequestedSplits,
+  const ImageIORegion & pasteRegion,
+  const ImageIORegion & largestPossibleRegion )
+{
+  if( pasteRegion != largestPossibleRegion )
+  {
+    itkExceptionMacro( << "mevisIO:write(): pasting into an existing dcm/tiff file is not supported" );
+  }
+
+  // the image is only split over the slices (and time points),
+  // since the tiles of one slice are written at once
+  unsigned int numberOfSlices = 1;
+  for( unsigned int i = 2; i < largestPossibleRegion.GetImageDimension(); ++i )
+  {
+    numberOfSlices *= largestPossibleRegion.GetSize( i );
+  }
+
+  return Superclass::GetActualNumberOfSplitsForWriting(
+    std::min( numberOfRequestedSplits, numberOfSlices ), pasteRegion, largestPossibleRegion );
 }
 
 
@@ -29,6 +29,7 @@
 
 #include <fstream>
 #include <string>
+#include <vector>
 
 namespace itk
 {
@@ -67,6 +68,10 @@ namespace itk
  *    (double is not accepted by MevisLab)
  *  - writing defaults is tiled tiff, tilesize is 128, 128,
  *    LZW compression and cm metric system
+ *  - streamed reading: only the tiles that intersect the requested region
+ *    are decoded, in parallel, each thread using its own tiff handle
+ *  - streamed writing in complete slices; the tiles of a slice are gathered
+ *    in parallel, but encoded and written by the single tiff handle
  *  - default extension for tiff-image is ".tif" to comply with mevislab
  *    standards
  *  - gdcm header during reading is stored as (global) metadata
@@ -132,18 +137,31 @@ public:
 
   virtual void Write( const void * buffer );
 
+  /** Reading is streamed: only the tiles that intersect the requested
+   * region are decoded, in parallel.
+   */
   virtual bool CanStreamRead()
   {
-    return false;
+    return true;
   }
 
 
+  /** Writing is streamed in complete slices of the tiff image. */
   virtual bool CanStreamWrite()
   {
-    return false;
+    return true;
   }
 
 
+  /** Restrict the streamed writing to splits over the slices, and reject
+   * pasting into an existing file.
+   */
+  virtual unsigned int GetActualNumberOfSplitsForWriting(
+    unsigned int numberOfRequestedSplits,
+    const ImageIORegion & pasteRegion,
+    const ImageIORegion & largestPossibleRegion );
+
+
 protected:
 
   MevisDicomTiffImageIO();
@@ -158,6 +176,12 @@ private:
   bool FindElement( const gdcm::DataSet ds, const gdcm::Tag tag, gdcm::DataElement & de,
     const bool breadthfirstsearch );
 
+  /** Get the tiff slices (z) covered by the io region, in buffer order. */
+  void GetTIFFSlicesOfIORegion( std::vector< unsigned int > & slices ) const;
+
+  /** Write the tiles of the io region, and close the tiff file after its last slice. */
+  void WriteTiles( const void * buffer );
+
   // the following may include the pathname
   std::string m_DcmFileName;
   std::string m_TiffFileName;
@@ -175,6 +199,7 @@ private:
   unsigned int   m_TileLength;
   unsigned int   m_TileDepth;
   unsigned short m_NumberOfTiles;
+  unsigned int   m_NumberOfSlicesToWrite;
 
   double m_RescaleSlope;
   double m_RescaleIntercept;
@@ -21,14 +21,232 @@
 
 #include "itkParameterFileParser.h"
 
+#include "itkMultiThreaderBase.h"
+
 #include <itksys/SystemTools.hxx>
 #include <itksys/RegularExpression.hxx>
 
+#include <algorithm>
+#include <cstdint>
 #include <fstream>
+#include <locale>
+#include <memory>
+#include <mutex>
+#include <sstream>
 
 namespace itk
 {
 
+namespace
+{
+
+/** Parse the number between begin and end, independent of the locale.
+ * Numbers with at most 19 significant digits whose value is exactly
+ * representable after scaling by a power of ten up to 1e22 are computed
+ * directly, which is correctly rounded. The other numbers are passed to a
+ * stream with the classic locale. Returns false if it is not a number.
+ */
+bool
+ParseNumber( const char * begin, const char * end, double & value )
+{
+  static const double powersOfTen[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+  };
+
+  const char * p        = begin;
+  const bool   negative = ( p != end && *p == '-' );
+  if( p != end && ( *p == '-' || *p == '+' ) )
+  {
+    ++p;
+  }
+
+  std::uint64_t mantissa          = 0;
+  int           exponent          = 0;
+  unsigned int  numberOfDigits    = 0;
+  unsigned int  significantDigits = 0;
+  bool          truncated         = false;
+  for( ; p != end && *p >= '0' && *p <= '9'; ++p, ++numberOfDigits )
+  {
+    if( significantDigits < 19 )
+    {
+      mantissa = mantissa * 10 + static_cast< unsigned int >( *p - '0' );
+      significantDigits += ( mantissa != 0 );
+    }
+    else
+    {
+      ++exponent;
+      truncated |= ( *p != '0' );
+    }
+  }
+  if( p != end && *p == '.' )
+  {
+    for( ++p; p != end && *p >= '0' && *p <= '9'; ++p, ++numberOfDigits )
+    {
+      if( significantDigits < 19 )
+      {
+        mantissa = mantissa * 10 + static_cast< unsigned int >( *p - '0' );
+        significantDigits += ( mantissa != 0 );
+        --exponent;
+      }
+      else
+      {
+        truncated |= ( *p != '0' );
+      }
+    }
+  }
+  if( numberOfDigits == 0 )
+  {
+    return false;
+  }
+  if( p != end && ( *p == 'e' || *p == 'E' ) )
+  {
+    ++p;
+    const bool negativeExponent = ( p != end && *p == '-' );
+    if( p != end && ( *p == '-' || *p == '+' ) )
+    {
+      ++p;
+    }
+    if( p == end || *p < '0' || *p > '9' )
+    {
+      return false;
+    }
+    int explicitExponent = 0;
+    for( ; p != end && *p >= '0' && *p <= '9'; ++p )
+    {
+      explicitExponent = std::min( explicitExponent * 10 + ( *p - '0' ), 100000 );
+    }
+    exponent += negativeExponent ? -explicitExponent : explicitExponent;
+  }
+  if( p != end )
+  {
+    return false;
+  }
+
+  /** The fast path. */
+  if( !truncated && mantissa <= ( std::uint64_t( 1 ) << 53 )
+    && exponent >= -22 && exponent <= 22 )
+  {
+    value = static_cast< double >( mantissa );
+    value = exponent < 0 ? value / powersOfTen[ -exponent ] : value * powersOfTen[ exponent ];
+    value = negative ? -value : value;
+    return true;
+  }
+
+  /** The slow path, for correct rounding. */
+  std::istringstream stream( std::string( begin, end ) );
+  stream.imbue( std::locale::classic() );
+  stream >> value;
+  return !stream.fail();
+
+} // end ParseNumber()
+
+
+/** Parse the space separated numbers between begin and end, and append
+ * them to values. Returns false if one of them is not a number.
+ */
+bool
+ParseNumbers( const char * begin, const char * end,
+  ParameterFileParser::NumericParameterValuesType & values )
+{
+  const char * p = begin;
+  while( true )
+  {
+    while( p != end && *p == ' ' )
+    {
+      ++p;
+    }
+    if( p == end )
+    {
+      return true;
+    }
+
+    const char * tokenEnd = std::find( p, end, ' ' );
+    double       value    = 0.0;
+    if( !ParseNumber( p, tokenEnd, value ) )
+    {
+      return false;
+    }
+    values.push_back( value );
+    p = tokenEnd;
+  }
+
+} // end ParseNumbers()
+
+
+/** The 64-bit FNV-1a hash of the content of a file. */
+std::uint64_t
+HashContent( const std::string & content )
+{
+  std::uint64_t hash = 14695981039346656037ULL;
+  for( std::string::const_iterator it = content.begin(); it != content.end(); ++it )
+  {
+    hash ^= static_cast< unsigned char >( *it );
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+
+} // end HashContent()
+
+
+/** The cache of parsed parameter files, keyed by the full path. A file
+ * is identified by its length and the hash of its content, because the
+ * modification time may not change when a file is rewritten quickly.
+ */
+struct CachedParameterFileType
+{
+  std::size_t                                                     m_Length;
+  std::uint64_t                                                   m_Hash;
+  std::size_t                                                     m_NumericParameterThreshold;
+  ParameterFileParser::ParameterMapType                           m_ParameterMap;
+  std::shared_ptr< ParameterFileParser::NumericParameterMapType > m_NumericParameterMap;
+};
+
+struct CacheEntryType
+{
+  std::shared_ptr< const CachedParameterFileType > m_File;
+  unsigned long long                               m_LastUse;
+};
+
+struct CacheType
+{
+  std::mutex                              m_Mutex;
+  std::map< std::string, CacheEntryType > m_Entries;
+  std::size_t                             m_MaximumNumberOfFiles{ 16 };
+  unsigned long long                      m_Clock{ 0 };
+};
+
+CacheType &
+GetCache( void )
+{
+  static CacheType cache;
+  return cache;
+}
+
+
+/** Remove the least recently used files, until there are at most
+ * maximumNumberOfFiles. The mutex must be locked. */
+void
+ShrinkCache( CacheType & cache, const std::size_t maximumNumberOfFiles )
+{
+  while( cache.m_Entries.size() > maximumNumberOfFiles )
+  {
+    std::map< std::string, CacheEntryType >::iterator oldest = cache.m_Entries.begin();
+    for( std::map< std::string, CacheEntryType >::iterator it = cache.m_Entries.begin();
+      it != cache.m_Entries.end(); ++it )
+    {
+      if( it->second.m_LastUse < oldest->second.m_LastUse )
+      {
+        oldest = it;
+      }
+    }
+    cache.m_Entries.erase( oldest );
+  }
+
+} // end ShrinkCache()
+
+} // end namespace
+
 /**
  * **************** Constructor ***************
  */
@@ -58,6 +276,19 @@ ParameterFileParser
 } // end GetParameterMap()
 
 
+/**
+ * **************** GetNumericParameterMap ***************
+ */
+
+const ParameterFileParser::NumericParameterMapType &
+ParameterFileParser
+::GetNumericParameterMap( void ) const
+{
+  return *this->m_NumericParameterMap;
+
+} // end GetNumericParameterMap()
+
+
 /**
  * **************** ReadParameterFile ***************
  */
@@ -69,8 +300,22 @@ ParameterFileParser
   /** Perform some basic checks. */
   this->BasicFileChecking();
 
-  /** Open the parameter file for reading. */
-  std::ifstream parameterFile( this->m_ParameterFileName );
+  /** Open the parameter file for reading. With the cache, the content is
+   * read at once, to compare it with the cached file, and parsed from memory.
+   */
+  std::ifstream      parameterFile;
+  std::istringstream parameterString;
+  std::string        cacheKey;
+  std::size_t        length = 0;
+  std::uint64_t      hash   = 0;
+  if( this->m_UseCache )
+  {
+    parameterFile.open( this->m_ParameterFileName, std::ios::in | std::ios::binary );
+  }
+  else
+  {
+    parameterFile.open( this->m_ParameterFileName );
+  }
 
   /** Check if it opened. */
   if( !parameterFile.is_open() )
@@ -80,32 +325,143 @@ ParameterFileParser
                        << " for reading." );
   }
 
-  /** Clear the map. */
+  /** Take the maps from the cache, if the file did not change. */
+  if( this->m_UseCache )
+  {
+    std::string content;
+    parameterFile.seekg( 0, std::ios::end );
+    content.resize( static_cast< std::size_t >( parameterFile.tellg() ) );
+    parameterFile.seekg( 0, std::ios::beg );
+    parameterFile.read( &content[ 0 ], content.size() );
+    parameterFile.close();
+
+    cacheKey = itksys::SystemTools::CollapseFullPath( this->m_ParameterFileName );
+    length   = content.size();
+    hash     = HashContent( content );
+
+    std::shared_ptr< const CachedParameterFileType > cachedFile;
+    {
+      CacheType &                  cache = GetCache();
+      std::lock_guard< std::mutex > lock( cache.m_Mutex );
+      std::map< std::string, CacheEntryType >::iterator it = cache.m_Entries.find( cacheKey );
+      if( it != cache.m_Entries.end() )
+      {
+        it->second.m_LastUse = ++cache.m_Clock;
+        cachedFile           = it->second.m_File;
+      }
+    }
+
+    if( cachedFile && cachedFile->m_Length == length && cachedFile->m_Hash == hash
+      && cachedFile->m_NumericParameterThreshold == this->m_NumericParameterThreshold )
+    {
+      /** The numbers are shared, not copied. */
+      this->m_ParameterMap        = cachedFile->m_ParameterMap;
+      this->m_NumericParameterMap = cachedFile->m_NumericParameterMap;
+      return;
+    }
+
+    parameterString.str( content );
+  }
+  std::istream & parameterStream = this->m_UseCache
+    ? static_cast< std::istream & >( parameterString ) : parameterFile;
+
+  /** Clear the maps. A shared numeric map is replaced, not cleared. */
   this->m_ParameterMap.clear();
+  this->m_NumericParameterMap = std::make_shared< NumericParameterMapType >();
 
   /** Loop over the parameter file, line by line. */
   std::string lineIn;
   std::string lineOut;
-  while( parameterFile.good() )
+  while( parameterStream.good() )
   {
     /** Extract a line. */
-    itksys::SystemTools::GetLineFromStream( parameterFile, lineIn );
+    itksys::SystemTools::GetLineFromStream( parameterStream, lineIn );
 
     /** Check this line. */
     const bool validLine = this->CheckLine( lineIn, lineOut );
 
     if( validLine )
     {
-      /** Get the parameter name from this line and store it. */
-      this->GetParameterFromLine( lineIn, lineOut );
+      /** Get the parameter name from this line and store it, as numbers
+       * if possible, and otherwise as strings. */
+      if( this->m_NumericParameterThreshold == 0
+        || !this->GetNumericParameterFromLine( lineOut ) )
+      {
+        this->GetParameterFromLine( lineIn, lineOut );
+      }
     }
     // Otherwise, we simply ignore this line
 
   }
 
+  /** Store the maps in the cache. */
+  if( this->m_UseCache )
+  {
+    std::shared_ptr< CachedParameterFileType > cachedFile
+      = std::make_shared< CachedParameterFileType >();
+    cachedFile->m_Length                    = length;
+    cachedFile->m_Hash                      = hash;
+    cachedFile->m_NumericParameterThreshold = this->m_NumericParameterThreshold;
+    cachedFile->m_ParameterMap              = this->m_ParameterMap;
+    cachedFile->m_NumericParameterMap       = this->m_NumericParameterMap;
+
+    CacheType &                  cache = GetCache();
+    std::lock_guard< std::mutex > lock( cache.m_Mutex );
+    CacheEntryType &             entry = cache.m_Entries[ cacheKey ];
+    entry.m_File    = cachedFile;
+    entry.m_LastUse = ++cache.m_Clock;
+    ShrinkCache( cache, cache.m_MaximumNumberOfFiles );
+  }
+
 } // end ReadParameterFile()
 
 
+/**
+ * **************** SetMaximumNumberOfCachedFiles ***************
+ */
+
+void
+ParameterFileParser
+::SetMaximumNumberOfCachedFiles( std::size_t number )
+{
+  CacheType &                  cache = GetCache();
+  std::lock_guard< std::mutex > lock( cache.m_Mutex );
+  cache.m_MaximumNumberOfFiles = number;
+  ShrinkCache( cache, number );
+
+} // end SetMaximumNumberOfCachedFiles()
+
+
+/**
+ * **************** GetMaximumNumberOfCachedFiles ***************
+ */
+
+std::size_t
+ParameterFileParser
+::GetMaximumNumberOfCachedFiles( void )
+{
+  CacheType &                  cache = GetCache();
+  std::lock_guard< std::mutex > lock( cache.m_Mutex );
+  return cache.m_MaximumNumberOfFiles;
+
+} // end GetMaximumNumberOfCachedFiles()
+
+
+/**
+ * **************** ClearCache ***************
+ */
+
+void
+ParameterFileParser
+::ClearCache( void )
+{
+  CacheType &                  cache = GetCache();
+  std::lock_guard< std::mutex > lock( cache.m_Mutex );
+  cache.m_Entries.clear();
+
+} // end ClearCache()
+
+
 /**
  * **************** BasicFileChecking ***************
  */
@@ -305,7 +661,8 @@ ParameterFileParser
   }
 
   /** 6) Insert this combination in the parameter map. */
-  if( this->m_ParameterMap.count( parameterName ) )
+  if( this->m_ParameterMap.count( parameterName )
+    || this->m_NumericParameterMap->count( parameterName ) )
   {
     const std::string hint = "The parameter \""
       + parameterName
@@ -320,6 +677,91 @@ ParameterFileParser
 } // end GetParameterFromLine()
 
 
+/**
+ * **************** GetNumericParameterFromLine ***************
+ */
+
+bool
+ParameterFileParser
+::GetNumericParameterFromLine( const std::string & line )
+{
+  /** Only lines without strings qualify. Each value takes at least two
+   * characters, including the separating space.
+   */
+  const std::size_t nameEnd = line.find( ' ' );
+  if( line.empty() || line[ 0 ] == ' ' || nameEnd == std::string::npos
+    || line.size() - nameEnd < 2 * this->m_NumericParameterThreshold
+    || line.find( '"' ) != std::string::npos )
+  {
+    return false;
+  }
+
+  /** Invalid and duplicate parameter names are reported by GetParameterFromLine(). */
+  const std::string         parameterName = line.substr( 0, nameEnd );
+  itksys::RegularExpression reInvalidCharacters( "[.,:;!@#$%^&-+|<>?]" );
+  if( reInvalidCharacters.find( parameterName )
+    || this->m_ParameterMap.count( parameterName )
+    || this->m_NumericParameterMap->count( parameterName ) )
+  {
+    return false;
+  }
+
+  /** Split the values in chunks of at least 64 kB, ending at a space. */
+  const char * const begin  = line.data() + nameEnd;
+  const char * const end    = line.data() + line.size();
+  const std::size_t  length = end - begin;
+  const std::size_t  numberOfChunks = std::max< std::size_t >( 1, std::min< std::size_t >(
+    4 * MultiThreaderBase::GetGlobalDefaultNumberOfThreads(), length / 65536 ) );
+
+  std::vector< const char * > chunkBegins( numberOfChunks + 1, end );
+  chunkBegins[ 0 ] = begin;
+  for( std::size_t i = 1; i < numberOfChunks; ++i )
+  {
+    chunkBegins[ i ] = std::find(
+      std::max( begin + i * length / numberOfChunks, chunkBegins[ i - 1 ] ), end, ' ' );
+  }
+
+  /** Parse the chunks in parallel. */
+  std::vector< NumericParameterValuesType > chunkValues( numberOfChunks );
+  std::vector< unsigned char >              chunkSucceeded( numberOfChunks, 0 );
+  MultiThreaderBase::Pointer                threader = MultiThreaderBase::New();
+  threader->ParallelizeArray( 0, numberOfChunks,
+    [ &chunkBegins, &chunkValues, &chunkSucceeded ]( SizeValueType chunk )
+    {
+      chunkValues[ chunk ].reserve(
+        ( chunkBegins[ chunk + 1 ] - chunkBegins[ chunk ] ) / 8 );
+      chunkSucceeded[ chunk ] = ParseNumbers(
+        chunkBegins[ chunk ], chunkBegins[ chunk + 1 ], chunkValues[ chunk ] );
+    },
+    nullptr );
+
+  std::size_t numberOfValues = 0;
+  for( std::size_t i = 0; i < numberOfChunks; ++i )
+  {
+    if( !chunkSucceeded[ i ] )
+    {
+      return false;
+    }
+    numberOfValues += chunkValues[ i ].size();
+  }
+  if( numberOfValues < this->m_NumericParameterThreshold )
+  {
+    return false;
+  }
+
+  /** Concatenate the chunks. */
+  NumericParameterValuesType & values = ( *this->m_NumericParameterMap )[ parameterName ];
+  values.reserve( numberOfValues );
+  for( std::size_t i = 0; i < numberOfChunks; ++i )
+  {
+    values.insert( values.end(), chunkValues[ i ].begin(), chunkValues[ i ].end() );
+  }
+
+  return true;
+
+} // end GetNumericParameterFromLine()
+
+
 /**
  * **************** SplitLine ***************
  */
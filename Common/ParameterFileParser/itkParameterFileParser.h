@@ -23,6 +23,7 @@
 #include "itkMacro.h"
 
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -72,6 +73,23 @@ namespace itk
  *
  * parser->GetParameterMap();
  *
+ * Parameters with many values, like the TransformParameters of a B-spline
+ * transform, can be stored as numbers instead of strings. When the
+ * NumericParameterThreshold is set, a parameter with at least that number
+ * of values, which are all unquoted numbers, is parsed in parallel chunks
+ * by a fast, locale independent number parser. It is stored in the numeric
+ * parameter map (GetNumericParameterMap()) instead of the parameter map.
+ * Values that the fast parser does not accept are parsed as strings, as
+ * before.
+ *
+ * When UseCache is on, the parsed maps are kept in a cache that is shared
+ * by all parsers in the process. A file is parsed again only when its
+ * content has changed, which is detected by its length and a 64-bit hash
+ * of the content; the file is still read, but not parsed. A cache hit
+ * shares the numbers with the cache, instead of copying them. This is
+ * useful when the same chain of transform parameter files is read many
+ * times.
+ *
  * \sa itk::ParameterMapInterface
  */
 
@@ -96,6 +114,10 @@ public:
   typedef std::map<
     std::string,
     ParameterValuesType >                 ParameterMapType;
+  typedef std::vector< double > NumericParameterValuesType;
+  typedef std::map<
+    std::string,
+    NumericParameterValuesType >          NumericParameterMapType;
 
   /** Set the name of the file containing the parameters. */
   itkSetStringMacro( ParameterFileName );
@@ -104,6 +126,28 @@ public:
   /** Return the parameter map. */
   virtual const ParameterMapType & GetParameterMap( void ) const;
 
+  /** Return the map of parameters that are stored as numbers. */
+  virtual const NumericParameterMapType & GetNumericParameterMap( void ) const;
+
+  /** Set the minimum number of values of a parameter to store it as numbers.
+   * The default is 0, which means that all parameters are stored as strings. */
+  itkSetMacro( NumericParameterThreshold, std::size_t );
+  itkGetConstMacro( NumericParameterThreshold, std::size_t );
+
+  /** Use the cache of parsed parameter files. Default: false. */
+  itkSetMacro( UseCache, bool );
+  itkGetConstMacro( UseCache, bool );
+  itkBooleanMacro( UseCache );
+
+  /** Set/Get the maximum number of files in the cache. When it is
+   * exceeded, the least recently used file is removed. Default: 16. */
+  static void SetMaximumNumberOfCachedFiles( std::size_t number );
+
+  static std::size_t GetMaximumNumberOfCachedFiles( void );
+
+  /** Remove all files from the cache. */
+  static void ClearCache( void );
+
   /** Read the parameters in the parameter map. */
   void ReadParameterFile( void );
 
@@ -141,6 +185,12 @@ private:
   void GetParameterFromLine( const std::string & fullLine,
     const std::string & line );
 
+  /** Stores the parameter in m_NumericParameterMap, if it has at least
+   * m_NumericParameterThreshold values that are all numbers. Returns false
+   * if it is not stored, and the line should be parsed as strings.
+   */
+  bool GetNumericParameterFromLine( const std::string & line );
+
   /** Splits a line in parameter name and values. */
   void SplitLine( const std::string & fullLine, const std::string & line,
     std::vector< std::string > & splittedLine ) const;
@@ -150,9 +200,16 @@ private:
    */
   void ThrowException( const std::string & line, const std::string & hint ) const;
 
-  /** Member variables. */
-  std::string      m_ParameterFileName;
-  ParameterMapType m_ParameterMap;
+  /** Member variables. The numeric parameter map may be shared with the
+   * cache, so a map is never modified after parsing: each file is parsed
+   * into a new one.
+   */
+  std::string                                m_ParameterFileName;
+  ParameterMapType                           m_ParameterMap;
+  std::shared_ptr< NumericParameterMapType > m_NumericParameterMap{
+    std::make_shared< NumericParameterMapType >() };
+  std::size_t                                m_NumericParameterThreshold{ 0 };
+  bool                                       m_UseCache{ false };
 
 };
 
@@ -18,6 +18,9 @@
 
 #include "itkParameterMapInterface.h"
 
+#include <iomanip>
+#include <locale>
+
 namespace itk
 {
 
@@ -53,6 +56,9 @@ void
 ParameterMapInterface
 ::SetParameterMap( const ParameterMapType & parMap )
 {
+  /** Numbers of a previous parameter file must not shadow the new map. */
+  this->m_NumericParameterMap.clear();
+
   if( !parMap.empty() )
   {
     this->m_ParameterMap = parMap;
@@ -61,6 +67,38 @@ ParameterMapInterface
 } // end SetParameterMap()
 
 
+/**
+ * **************** SetNumericParameterMap ***************
+ */
+
+void
+ParameterMapInterface
+::SetNumericParameterMap( const NumericParameterMapType & parMap )
+{
+  this->m_NumericParameterMap = parMap;
+
+} // end SetNumericParameterMap()
+
+
+/**
+ * **************** GetNumericParameterValues ***************
+ */
+
+const ParameterMapInterface::NumericParameterValuesType *
+ParameterMapInterface
+::GetNumericParameterValues( const std::string & parameterName ) const
+{
+  const NumericParameterMapType::const_iterator it
+    = this->m_NumericParameterMap.find( parameterName );
+  if( it != this->m_NumericParameterMap.end() )
+  {
+    return &( it->second );
+  }
+  return nullptr;
+
+} // end GetNumericParameterValues()
+
+
 /**
  * **************** CountNumberOfParameterEntries ***************
  */
@@ -74,6 +112,12 @@ ParameterMapInterface
   {
     return this->m_ParameterMap.find( parameterName )->second.size();
   }
+  const NumericParameterValuesType * numericValues
+    = this->GetNumericParameterValues( parameterName );
+  if( numericValues )
+  {
+    return numericValues->size();
+  }
   return 0;
 
 } // end CountNumberOfParameterEntries()
@@ -146,6 +190,23 @@ ParameterMapInterface
 } // end StringCast()
 
 
+/**
+ * **************** NumericCast ***************
+ */
+
+bool
+ParameterMapInterface
+::NumericCast( const double parameterValue, std::string & casted ) const
+{
+  std::ostringstream ss;
+  ss.imbue( std::locale::classic() );
+  ss << std::setprecision( 17 ) << parameterValue;
+  casted = ss.str();
+  return true;
+
+} // end NumericCast()
+
+
 /**
  * **************** ReadParameter ***************
  */
@@ -206,6 +267,19 @@ ParameterMapInterface
     itkExceptionMacro( << ss.str() );
   }
 
+  /** Parameters stored as numbers are formatted. */
+  const NumericParameterValuesType * numericValues
+    = this->GetNumericParameterValues( parameterName );
+  if( numericValues )
+  {
+    parameterValues.resize( entry_nr_end - entry_nr_start + 1 );
+    for( unsigned int i = entry_nr_start; i < entry_nr_end + 1; ++i )
+    {
+      this->NumericCast( ( *numericValues )[ i ], parameterValues[ i - entry_nr_start ] );
+    }
+    return true;
+  }
+
   /** Get the vector of parameters. */
   const ParameterValuesType & vec = this->m_ParameterMap.find( parameterName )->second;
 
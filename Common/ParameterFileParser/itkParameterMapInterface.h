@@ -26,7 +26,9 @@
 
 #include "itkParameterFileParser.h"
 
+#include <cmath>
 #include <iostream>
+#include <limits>
 
 namespace itk
 {
@@ -64,6 +66,10 @@ namespace itk
  *   "ParameterName", index, printWarning, errorMessage );
  *
  *
+ * Parameters can also be stored as numbers, see SetNumericParameterMap().
+ * They are read in the same way, without converting them to strings; a
+ * range of them can be read directly with GetNumericParameterValues().
+ *
  * Note that some of the templated functions are defined in the header to
  * get it compiling on some platforms.
  *
@@ -87,12 +93,25 @@ public:
   itkTypeMacro( ParameterMapInterface, Object );
 
   /** Typedefs. */
-  typedef ParameterFileParser::ParameterValuesType ParameterValuesType;
-  typedef ParameterFileParser::ParameterMapType    ParameterMapType;
+  typedef ParameterFileParser::ParameterValuesType        ParameterValuesType;
+  typedef ParameterFileParser::ParameterMapType           ParameterMapType;
+  typedef ParameterFileParser::NumericParameterValuesType NumericParameterValuesType;
+  typedef ParameterFileParser::NumericParameterMapType    NumericParameterMapType;
 
-  /** Set the parameter map. */
+  /** Set the parameter map. This also removes the numbers of a previous
+   * SetNumericParameterMap() call. */
   void SetParameterMap( const ParameterMapType & parMap );
 
+  /** Set the map of parameters that are stored as numbers, in addition to
+   * the parameter map, after calling SetParameterMap().
+   * See ParameterFileParser::GetNumericParameterMap(). */
+  void SetNumericParameterMap( const NumericParameterMapType & parMap );
+
+  /** Get the values of a parameter that is stored as numbers, or a null
+   * pointer if it is not stored as numbers. */
+  const NumericParameterValuesType * GetNumericParameterValues(
+    const std::string & parameterName ) const;
+
   /** Option to print error and warning messages to a stream.
    * The default is true. If set to false no messages are printed.
    */
@@ -150,9 +169,6 @@ public:
       return false;
     }
 
-    /** Get the vector of parameters. */
-    const ParameterValuesType & vec = this->m_ParameterMap.find( parameterName )->second;
-
     /** Check if it exists at the requested entry number. */
     if( entry_nr >= numberOfEntries )
     {
@@ -168,6 +184,29 @@ public:
       return false;
     }
 
+    /** Parameters stored as numbers are converted directly. */
+    const NumericParameterValuesType * numericValues
+      = this->GetNumericParameterValues( parameterName );
+    if( numericValues )
+    {
+      if( !this->NumericCast( ( *numericValues )[ entry_nr ], parameterValue ) )
+      {
+        std::stringstream ss;
+        ss << "ERROR: Casting entry number " << entry_nr
+           << " for the parameter \"" << parameterName
+           << "\" failed!\n"
+           << "  You tried to cast " << ( *numericValues )[ entry_nr ]
+           << " to " << typeid( parameterValue ).name()
+           << ", which cannot represent it." << std::endl;
+
+        itkExceptionMacro( << ss.str() );
+      }
+      return true;
+    }
+
+    /** Get the vector of parameters. */
+    const ParameterValuesType & vec = this->m_ParameterMap.find( parameterName )->second;
+
     /** Cast the string to type T. */
     bool castSuccesful = this->StringCast( vec[ entry_nr ], parameterValue );
 
@@ -339,6 +378,29 @@ public:
       itkExceptionMacro( << ss.str() );
     }
 
+    /** Parameters stored as numbers are converted directly. */
+    const NumericParameterValuesType * numericValues
+      = this->GetNumericParameterValues( parameterName );
+    if( numericValues )
+    {
+      for( unsigned int i = entry_nr_start; i < entry_nr_end + 1; ++i )
+      {
+        if( !this->NumericCast( ( *numericValues )[ i ], parameterValues[ i - entry_nr_start ] ) )
+        {
+          std::stringstream ss;
+          ss << "ERROR: Casting entry number " << i
+             << " for the parameter \"" << parameterName
+             << "\" failed!\n"
+             << "  You tried to cast " << ( *numericValues )[ i ]
+             << " to " << typeid( parameterValues[ 0 ] ).name()
+             << ", which cannot represent it." << std::endl;
+
+          itkExceptionMacro( << ss.str() );
+        }
+      }
+      return true;
+    }
+
     /** Get the vector of parameters. */
     const ParameterValuesType & vec = this->m_ParameterMap.find( parameterName )->second;
 
@@ -394,8 +456,9 @@ private:
   ParameterMapInterface( const Self & ); // purposely not implemented
   void operator=( const Self & );        // purposely not implemented
 
-  /** Member variable to store the parameters. */
-  ParameterMapType m_ParameterMap;
+  /** Member variables to store the parameters. */
+  ParameterMapType        m_ParameterMap;
+  NumericParameterMapType m_NumericParameterMap;
 
   bool m_PrintErrorMessages;
 
@@ -429,6 +492,35 @@ private:
    */
   bool StringCast( const std::string & parameterValue, std::string & casted ) const;
 
+  /** Cast a parameter that is stored as a number to a type T.
+   * Returns false, leaving casted unchanged, when T is an integer type that
+   * cannot represent the number exactly: fractions and numbers out of range
+   * are not truncated.
+   */
+  template< class T >
+  bool NumericCast( const double parameterValue, T & casted ) const
+  {
+    if( std::numeric_limits< T >::is_integer )
+    {
+      /** The bounds are powers of two, so they are exact as double. */
+      const double upperBound = std::ldexp( 1.0, std::numeric_limits< T >::digits );
+      const double lowerBound = std::numeric_limits< T >::is_signed ? -upperBound : 0.0;
+      if( !( parameterValue >= lowerBound && parameterValue < upperBound )
+        || parameterValue != std::floor( parameterValue ) )
+      {
+        return false;
+      }
+    }
+    casted = static_cast< T >( parameterValue );
+    return true;
+
+  } // end NumericCast()
+
+
+  /** Provide a specialization for std::string, which formats the number
+   * with enough digits to read it back exactly. */
+  bool NumericCast( const double parameterValue, std::string & casted ) const;
+
 };
 
 } // end of namespace itk
@@ -280,6 +280,60 @@ public:
 
   NumberOfParametersType GetNumberOfNonZeroJacobianIndices( void ) const override = 0;
 
+  /** Support for caching the interpolation weights of points that are
+   * evaluated repeatedly, like the fixed image samples of a metric that
+   * reuses its samples. The weights and the offset of the support region
+   * in the coefficient images only depend on the point and on the grid,
+   * not on the coefficients, so the caller may store them and pass them
+   * to the *UsingSampleWeights() methods instead of the point.
+   *
+   * GetNumberOfSampleWeights() returns the number of weights per point,
+   * or zero when the transform does not support this.
+   * ComputeSampleWeights() fills the weights and the offset, and returns
+   * false (and a negative offset) if the support region of the point does
+   * not lie totally within the grid. The *UsingSampleWeights() methods then
+   * assume zero displacement and zero Jacobian, like their counterparts.
+   * The results are only valid as long as the grid is not changed.
+   */
+  virtual unsigned int GetNumberOfSampleWeights( void ) const
+  {
+    return 0;
+  }
+
+
+  virtual bool ComputeSampleWeights( const InputPointType &,
+    double *, OffsetValueType & ) const
+  {
+    itkExceptionMacro( << "Sample weights are not supported by this transform." );
+    return false;
+  }
+
+
+  virtual OutputPointType TransformPointUsingSampleWeights(
+    const InputPointType &, const double *, const OffsetValueType ) const
+  {
+    itkExceptionMacro( << "Sample weights are not supported by this transform." );
+    return OutputPointType();
+  }
+
+
+  virtual void GetJacobianUsingSampleWeights(
+    const double *, const OffsetValueType,
+    JacobianType &, NonZeroJacobianIndicesType & ) const
+  {
+    itkExceptionMacro( << "Sample weights are not supported by this transform." );
+  }
+
+
+  virtual void EvaluateJacobianWithImageGradientProductUsingSampleWeights(
+    const double *, const OffsetValueType,
+    const MovingImageGradientType &, DerivativeType &,
+    NonZeroJacobianIndicesType & ) const
+  {
+    itkExceptionMacro( << "Sample weights are not supported by this transform." );
+  }
+
+
   /** This typedef should be equal to the typedef used
    * in derived classes based on the weights function.
    */
@@ -335,6 +335,12 @@ protected:
   /** Destructor. */
   ~AdvancedCombinationTransform() override{}
 
+  /** Returns a plain AdvancedCombinationTransform, also for subclasses, with
+   * the same combination method, the same initial transform, and a clone of
+   * the current transform. So its parameters can be changed independently.
+   */
+  typename LightObject::Pointer InternalClone( void ) const override;
+
   /** Declaration of members. */
   InitialTransformPointer m_InitialTransform;
   CurrentTransformPointer m_CurrentTransform;
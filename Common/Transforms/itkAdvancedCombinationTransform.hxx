@@ -575,6 +575,42 @@ AdvancedCombinationTransform< TScalarType, NDimensions >
 } // end SetCurrentTransform()
 
 
+/**
+ * ******************* InternalClone **********************
+ */
+
+template< typename TScalarType, unsigned int NDimensions >
+typename LightObject::Pointer
+AdvancedCombinationTransform< TScalarType, NDimensions >
+::InternalClone( void ) const
+{
+  if( this->m_CurrentTransform.IsNull() )
+  {
+    this->NoCurrentTransformSet();
+  }
+
+  /** Clone the current transform, which also copies its parameters. */
+  typename LightObject::Pointer currentClone = this->m_CurrentTransform->Clone().GetPointer();
+  CurrentTransformType *        current      = dynamic_cast< CurrentTransformType * >( currentClone.GetPointer() );
+  if( current == nullptr )
+  {
+    itkExceptionMacro( << "Failed to clone the current transform "
+                       << this->m_CurrentTransform->GetNameOfClass() );
+  }
+
+  /** The initial transform is not changed during the registration, so it is shared. */
+  Pointer clone = Self::New();
+  clone->SetUseComposition( this->m_UseComposition );
+  clone->SetUseAddition( this->m_UseAddition );
+  clone->SetInitialTransform( this->m_InitialTransform );
+  clone->SetCurrentTransform( current );
+
+  typename LightObject::Pointer loPtr = clone.GetPointer();
+  return loPtr;
+
+} // end InternalClone()
+
+
 /**
  * ********************** SetUseAddition **********************
  */
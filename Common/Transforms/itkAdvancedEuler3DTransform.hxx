@@ -124,6 +124,26 @@ AdvancedEuler3DTransform< TScalarType >
 }
 
 
+// Clone
+template< class TScalarType >
+typename LightObject::Pointer
+AdvancedEuler3DTransform< TScalarType >
+::InternalClone( void ) const
+{
+  typename LightObject::Pointer loPtr = Superclass::InternalClone();
+  Self *                        rval  = dynamic_cast< Self * >( loPtr.GetPointer() );
+  if( rval == nullptr )
+  {
+    itkExceptionMacro( << "Downcast to type " << this->GetNameOfClass() << " failed." );
+  }
+
+  // The matrix depends on the order of the computation
+  rval->SetComputeZYX( this->m_ComputeZYX );
+  rval->SetParameters( this->GetParameters() );
+  return loPtr;
+}
+
+
 // Get Parameters
 template< class TScalarType >
 const typename AdvancedEuler3DTransform< TScalarType >::ParametersType
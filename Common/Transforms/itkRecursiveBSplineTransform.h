@@ -148,6 +148,34 @@ public:
     DerivativeType & imageJacobian,
     NonZeroJacobianIndicesType & nonZeroJacobianIndices ) const override;
 
+  /** Support for cached interpolation weights, see the superclass.
+   * The weights are the SpaceDimension sets of 1D weights of the
+   * recursive implementation, so only ( SplineOrder + 1 ) * SpaceDimension
+   * values are stored per point.
+   */
+  unsigned int GetNumberOfSampleWeights( void ) const override
+  {
+    return RecursiveBSplineWeightFunctionType::NumberOfWeights;
+  }
+
+
+  bool ComputeSampleWeights( const InputPointType & ipp,
+    double * weights1D, OffsetValueType & totalOffsetToSupportIndex ) const override;
+
+  OutputPointType TransformPointUsingSampleWeights( const InputPointType & ipp,
+    const double * weights1D, const OffsetValueType totalOffsetToSupportIndex ) const override;
+
+  void GetJacobianUsingSampleWeights(
+    const double * weights1D, const OffsetValueType totalOffsetToSupportIndex,
+    JacobianType & jacobian,
+    NonZeroJacobianIndicesType & nonZeroJacobianIndices ) const override;
+
+  void EvaluateJacobianWithImageGradientProductUsingSampleWeights(
+    const double * weights1D, const OffsetValueType totalOffsetToSupportIndex,
+    const MovingImageGradientType & movingImageGradient,
+    DerivativeType & imageJacobian,
+    NonZeroJacobianIndicesType & nonZeroJacobianIndices ) const override;
+
   /** Compute the spatial Jacobian of the transformation. */
   void GetSpatialJacobian(
     const InputPointType & ipp,
@@ -203,6 +231,16 @@ protected:
     NonZeroJacobianIndicesType & nonZeroJacobianIndices,
     const RegionType & supportRegion ) const override;
 
+  /** Compute the nonzero Jacobian indices, given the offset of the support
+   * region in the coefficient images. */
+  void ComputeNonZeroJacobianIndices(
+    NonZeroJacobianIndicesType & nonZeroJacobianIndices,
+    const OffsetValueType totalOffsetToSupportIndex ) const;
+
+  /** Fill the nonzero Jacobian indices for a point outside the valid region. */
+  void SetTrivialNonZeroJacobianIndices(
+    NonZeroJacobianIndicesType & nonZeroJacobianIndices ) const;
+
 private:
 
   RecursiveBSplineTransform( const Self & ); // purposely not implemented
@@ -51,50 +51,145 @@ typename RecursiveBSplineTransform< TScalar, NDimensions, VSplineOrder >
 RecursiveBSplineTransform< TScalar, NDimensions, VSplineOrder >
 ::TransformPoint( const InputPointType & point ) const
 {
-  /** Define some constants. */
-  const unsigned int numberOfWeights = RecursiveBSplineWeightFunctionType::NumberOfWeights;
-
-  /** Initialize output point. */
-  OutputPointType outputPoint;
-
-  /** Allocate weights on the stack: */
-  typename WeightsType::ValueType weightsArray1D[ numberOfWeights ];
-  WeightsType weights1D( weightsArray1D, numberOfWeights, false );
-
   /** Check if the coefficient image has been set. */
   if( !this->m_CoefficientImages[ 0 ] )
   {
     itkWarningMacro( << "B-spline coefficients have not been set" );
-    outputPoint = point;
-    return outputPoint;
+    return point;
   }
 
-  /** Convert to continuous index. */
+  /** Compute the interpolation weights and the offset to the support index.
+   * NOTE: if the support region does not lie totally within the grid
+   * we assume zero displacement and return the input point.
+   */
+  const unsigned int numberOfWeights = RecursiveBSplineWeightFunctionType::NumberOfWeights;
+  double             weightsArray1D[ numberOfWeights ];
+  OffsetValueType    totalOffsetToSupportIndex;
+  this->ComputeSampleWeights( point, weightsArray1D, totalOffsetToSupportIndex );
+
+  return this->TransformPointUsingSampleWeights( point, weightsArray1D, totalOffsetToSupportIndex );
+
+} // end TransformPoint()
+
+
+/**
+ * ********************* GetJacobian ****************************
+ */
+
+template< class TScalar, unsigned int NDimensions, unsigned int VSplineOrder >
+void
+RecursiveBSplineTransform< TScalar, NDimensions, VSplineOrder >
+::GetJacobian( const InputPointType & ipp, JacobianType & jacobian,
+  NonZeroJacobianIndicesType & nonZeroJacobianIndices ) const
+{
+  /** Compute the interpolation weights.
+   * In contrast to the normal B-spline weights function, the recursive version
+   * returns the individual weights instead of the multiplied ones.
+   */
+  const unsigned int numberOfWeights = RecursiveBSplineWeightFunctionType::NumberOfWeights;
+  double             weightsArray1D[ numberOfWeights ];
+  OffsetValueType    totalOffsetToSupportIndex;
+  this->ComputeSampleWeights( ipp, weightsArray1D, totalOffsetToSupportIndex );
+
+  this->GetJacobianUsingSampleWeights( weightsArray1D, totalOffsetToSupportIndex,
+    jacobian, nonZeroJacobianIndices );
+
+} // end GetJacobian()
+
+
+/**
+ * ********************* EvaluateJacobianAndImageGradientProduct ****************************
+ */
+
+template< class TScalar, unsigned int NDimensions, unsigned int VSplineOrder >
+void
+RecursiveBSplineTransform< TScalar, NDimensions, VSplineOrder >
+::EvaluateJacobianWithImageGradientProduct(
+  const InputPointType & ipp,
+  const MovingImageGradientType & movingImageGradient,
+  DerivativeType & imageJacobian,
+  NonZeroJacobianIndicesType & nonZeroJacobianIndices ) const
+{
+  /** Compute the interpolation weights.
+   * In contrast to the normal B-spline weights function, the recursive version
+   * returns the individual weights instead of the multiplied ones.
+   */
+  const unsigned int numberOfWeights = RecursiveBSplineWeightFunctionType::NumberOfWeights;
+  double             weightsArray1D[ numberOfWeights ];
+  OffsetValueType    totalOffsetToSupportIndex;
+  this->ComputeSampleWeights( ipp, weightsArray1D, totalOffsetToSupportIndex );
+
+  this->EvaluateJacobianWithImageGradientProductUsingSampleWeights(
+    weightsArray1D, totalOffsetToSupportIndex,
+    movingImageGradient, imageJacobian, nonZeroJacobianIndices );
+
+} // end EvaluateJacobianWithImageGradientProduct()
+
+
+/**
+ * ********************* ComputeSampleWeights ****************************
+ */
+
+template< class TScalar, unsigned int NDimensions, unsigned int VSplineOrder >
+bool
+RecursiveBSplineTransform< TScalar, NDimensions, VSplineOrder >
+::ComputeSampleWeights( const InputPointType & ipp,
+  double * weightsArray1D, OffsetValueType & totalOffsetToSupportIndex ) const
+{
+  /** Convert the physical point to a continuous index, which
+   * is needed for the 'Evaluate()' functions below.
+   */
   ContinuousIndexType cindex;
-  this->TransformPointToContinuousGridIndex( point, cindex );
+  this->TransformPointToContinuousGridIndex( ipp, cindex );
 
-  // NOTE: if the support region does not lie totally within the grid
-  // we assume zero displacement and return the input point
-  bool inside = this->InsideValidRegion( cindex );
-  if( !inside )
+  /** A negative offset marks points whose support region does
+   * not lie totally within the grid.
+   */
+  if( !this->InsideValidRegion( cindex ) )
   {
-    outputPoint = point;
-    return outputPoint;
+    totalOffsetToSupportIndex = -1;
+    return false;
   }
 
-  // Compute interpolation weighs and store them in weights1D
-  IndexType supportIndex;
+  /** Compute the interpolation weights and store them in weightsArray1D. */
+  const unsigned int numberOfWeights = RecursiveBSplineWeightFunctionType::NumberOfWeights;
+  WeightsType        weights1D( weightsArray1D, numberOfWeights, false );
+  IndexType          supportIndex;
   this->m_RecursiveBSplineWeightFunction->Evaluate( cindex, weights1D, supportIndex );
 
-  /** Initialize (helper) variables. */
-  const OffsetValueType * bsplineOffsetTable        = this->m_CoefficientImages[ 0 ]->GetOffsetTable();
-  OffsetValueType         totalOffsetToSupportIndex = 0;
+  /** Compute the offset to the start index. */
+  const OffsetValueType * bsplineOffsetTable = this->m_CoefficientImages[ 0 ]->GetOffsetTable();
+  totalOffsetToSupportIndex = 0;
   for( unsigned int j = 0; j < SpaceDimension; ++j )
   {
     totalOffsetToSupportIndex += supportIndex[ j ] * bsplineOffsetTable[ j ];
   }
 
-  ScalarType * mu[ SpaceDimension ];
+  return true;
+
+} // end ComputeSampleWeights()
+
+
+/**
+ * ********************* TransformPointUsingSampleWeights ****************************
+ */
+
+template< class TScalar, unsigned int NDimensions, unsigned int VSplineOrder >
+typename RecursiveBSplineTransform< TScalar, NDimensions, VSplineOrder >
+::OutputPointType
+RecursiveBSplineTransform< TScalar, NDimensions, VSplineOrder >
+::TransformPointUsingSampleWeights( const InputPointType & ipp,
+  const double * weightsArray1D, const OffsetValueType totalOffsetToSupportIndex ) const
+{
+  /** Zero displacement outside the valid region. */
+  if( totalOffsetToSupportIndex < 0 )
+  {
+    return ipp;
+  }
+
+  /** Get handles to the mu's. */
+  const OffsetValueType * bsplineOffsetTable = this->m_CoefficientImages[ 0 ]->GetOffsetTable();
+  ScalarType *            mu[ SpaceDimension ];
   for( unsigned int j = 0; j < SpaceDimension; ++j )
   {
     mu[ j ] = this->m_CoefficientImages[ j ]->GetBufferPointer() + totalOffsetToSupportIndex;
@@ -106,31 +201,29 @@ RecursiveBSplineTransform< TScalar, NDimensions, VSplineOrder >
     ::TransformPoint( displacement, mu, bsplineOffsetTable, weightsArray1D );
 
   // The output point is the start point + displacement.
+  OutputPointType outputPoint;
   for( unsigned int j = 0; j < SpaceDimension; ++j )
   {
-    outputPoint[ j ] = displacement[ j ] + point[ j ];
+    outputPoint[ j ] = displacement[ j ] + ipp[ j ];
   }
 
   return outputPoint;
-} // end TransformPoint()
+
+} // end TransformPointUsingSampleWeights()
 
 
 /**
- * ********************* GetJacobian ****************************
+ * ********************* GetJacobianUsingSampleWeights ****************************
  */
 
 template< class TScalar, unsigned int NDimensions, unsigned int VSplineOrder >
 void
 RecursiveBSplineTransform< TScalar, NDimensions, VSplineOrder >
-::GetJacobian( const InputPointType & ipp, JacobianType & jacobian,
+::GetJacobianUsingSampleWeights(
+  const double * weightsArray1D, const OffsetValueType totalOffsetToSupportIndex,
+  JacobianType & jacobian,
   NonZeroJacobianIndicesType & nonZeroJacobianIndices ) const
 {
-  /** Convert the physical point to a continuous index, which
-   * is needed for the 'Evaluate()' functions below.
-   */
-  ContinuousIndexType cindex;
-  this->TransformPointToContinuousGridIndex( ipp, cindex );
-
   /** Initialize. */
   const NumberOfParametersType nnzji = this->GetNumberOfNonZeroJacobianIndices();
   if( ( jacobian.cols() != nnzji ) || ( jacobian.rows() != SpaceDimension ) )
@@ -142,26 +235,12 @@ RecursiveBSplineTransform< TScalar, NDimensions, VSplineOrder >
   /** NOTE: if the support region does not lie totally within the grid
    * we assume zero displacement and zero Jacobian.
    */
-  if( !this->InsideValidRegion( cindex ) )
+  if( totalOffsetToSupportIndex < 0 )
   {
-    nonZeroJacobianIndices.resize( this->GetNumberOfNonZeroJacobianIndices() );
-    for( NumberOfParametersType i = 0; i < this->GetNumberOfNonZeroJacobianIndices(); ++i )
-    {
-      nonZeroJacobianIndices[ i ] = i;
-    }
+    this->SetTrivialNonZeroJacobianIndices( nonZeroJacobianIndices );
     return;
   }
 
-  /** Compute the interpolation weights.
-   * In contrast to the normal B-spline weights function, the recursive version
-   * returns the individual weights instead of the multiplied ones.
-   */
-  const unsigned int numberOfWeights = RecursiveBSplineWeightFunctionType::NumberOfWeights;
-  typename WeightsType::ValueType weightsArray1D[ numberOfWeights ];
-  WeightsType weights1D( weightsArray1D, numberOfWeights, false );
-  IndexType   supportIndex;
-  this->m_RecursiveBSplineWeightFunction->Evaluate( cindex, weights1D, supportIndex );
-
   /** Recursively compute the first numberOfIndices entries of the Jacobian.
    * They are directly written in the Jacobian matrix memory block.
    * The pointer has changed after this function call.
@@ -173,57 +252,33 @@ RecursiveBSplineTransform< TScalar, NDimensions, VSplineOrder >
   /** Compute the nonzero Jacobian indices.
    * Takes a significant portion of the computation time of this function.
    */
-  RegionType supportRegion;
-  supportRegion.SetSize( this->m_SupportSize );
-  supportRegion.SetIndex( supportIndex );
-  this->ComputeNonZeroJacobianIndices( nonZeroJacobianIndices, supportRegion );
+  this->ComputeNonZeroJacobianIndices( nonZeroJacobianIndices, totalOffsetToSupportIndex );
 
-} // end GetJacobian()
+} // end GetJacobianUsingSampleWeights()
 
 
 /**
- * ********************* EvaluateJacobianAndImageGradientProduct ****************************
+ * ********************* EvaluateJacobianWithImageGradientProductUsingSampleWeights ****************************
  */
 
 template< class TScalar, unsigned int NDimensions, unsigned int VSplineOrder >
 void
 RecursiveBSplineTransform< TScalar, NDimensions, VSplineOrder >
-::EvaluateJacobianWithImageGradientProduct(
-  const InputPointType & ipp,
+::EvaluateJacobianWithImageGradientProductUsingSampleWeights(
+  const double * weightsArray1D, const OffsetValueType totalOffsetToSupportIndex,
   const MovingImageGradientType & movingImageGradient,
   DerivativeType & imageJacobian,
   NonZeroJacobianIndicesType & nonZeroJacobianIndices ) const
 {
-  /** Convert the physical point to a continuous index, which
-   * is needed for the 'Evaluate()' functions below.
-   */
-  ContinuousIndexType cindex;
-  this->TransformPointToContinuousGridIndex( ipp, cindex );
-
   /** NOTE: if the support region does not lie totally within the grid
    * we assume zero displacement and zero Jacobian.
    */
-  const NumberOfParametersType nnzji = this->GetNumberOfNonZeroJacobianIndices();
-  if( !this->InsideValidRegion( cindex ) )
+  if( totalOffsetToSupportIndex < 0 )
   {
-    nonZeroJacobianIndices.resize( nnzji );
-    for( NumberOfParametersType i = 0; i < nnzji; ++i )
-    {
-      nonZeroJacobianIndices[ i ] = i;
-    }
+    this->SetTrivialNonZeroJacobianIndices( nonZeroJacobianIndices );
     return;
   }
 
-  /** Compute the interpolation weights.
-   * In contrast to the normal B-spline weights function, the recursive version
-   * returns the individual weights instead of the multiplied ones.
-   */
-  const unsigned int numberOfWeights = RecursiveBSplineWeightFunctionType::NumberOfWeights;
-  typename WeightsType::ValueType weightsArray1D[ numberOfWeights ];
-  WeightsType weights1D( weightsArray1D, numberOfWeights, false );
-  IndexType   supportIndex;
-  this->m_RecursiveBSplineWeightFunction->Evaluate( cindex, weights1D, supportIndex );
-
   /** Recursively compute the inner product of the Jacobian and the moving image gradient.
    * The pointer has changed after this function call.
    */
@@ -237,17 +292,12 @@ RecursiveBSplineTransform< TScalar, NDimensions, VSplineOrder >
   RecursiveBSplineTransformImplementation< SpaceDimension, SpaceDimension, SplineOrder, TScalar >
     ::EvaluateJacobianWithImageGradientProduct( imageJacobianPointer, migArray, weightsArray1D, 1.0 );
 
-  /** Setup support region needed for the nonZeroJacobianIndices. */
-  RegionType supportRegion;
-  supportRegion.SetSize( this->m_SupportSize );
-  supportRegion.SetIndex( supportIndex );
-
   /** Compute the nonzero Jacobian indices.
    * Takes a significant portion of the computation time of this function.
    */
-  this->ComputeNonZeroJacobianIndices( nonZeroJacobianIndices, supportRegion );
+  this->ComputeNonZeroJacobianIndices( nonZeroJacobianIndices, totalOffsetToSupportIndex );
 
-} // end EvaluateJacobianWithImageGradientProduct()
+} // end EvaluateJacobianWithImageGradientProductUsingSampleWeights()
 
 
 /**
@@ -665,10 +715,6 @@ RecursiveBSplineTransform< TScalar, NDimensions, VSplineOrder >
   NonZeroJacobianIndicesType & nonZeroJacobianIndices,
   const RegionType & supportRegion ) const
 {
-  /** Initialize some helper variables. */
-  const unsigned long parametersPerDim = this->GetNumberOfParametersPerDimension();
-  nonZeroJacobianIndices.resize( this->GetNumberOfNonZeroJacobianIndices() );
-
   /** Compute total offset at start index. */
   const IndexType         startIndex                = supportRegion.GetIndex();
   const OffsetValueType * gridOffsetTable           = this->m_CoefficientImages[ 0 ]->GetOffsetTable();
@@ -678,6 +724,27 @@ RecursiveBSplineTransform< TScalar, NDimensions, VSplineOrder >
     totalOffsetToSupportIndex += startIndex[ j ] * gridOffsetTable[ j ];
   }
 
+  this->ComputeNonZeroJacobianIndices( nonZeroJacobianIndices, totalOffsetToSupportIndex );
+
+} // end ComputeNonZeroJacobianIndices()
+
+
+/**
+ * ********************* ComputeNonZeroJacobianIndices ****************************
+ */
+
+template< class TScalar, unsigned int NDimensions, unsigned int VSplineOrder >
+void
+RecursiveBSplineTransform< TScalar, NDimensions, VSplineOrder >
+::ComputeNonZeroJacobianIndices(
+  NonZeroJacobianIndicesType & nonZeroJacobianIndices,
+  const OffsetValueType totalOffsetToSupportIndex ) const
+{
+  /** Initialize some helper variables. */
+  const unsigned long     parametersPerDim = this->GetNumberOfParametersPerDimension();
+  const OffsetValueType * gridOffsetTable  = this->m_CoefficientImages[ 0 ]->GetOffsetTable();
+  nonZeroJacobianIndices.resize( this->GetNumberOfNonZeroJacobianIndices() );
+
   /** Call the recursive implementation. */
   unsigned long currentIndex = totalOffsetToSupportIndex;
   unsigned long * nzjiPointer = &nonZeroJacobianIndices[ 0 ];
@@ -688,6 +755,25 @@ RecursiveBSplineTransform< TScalar, NDimensions, VSplineOrder >
 } // end ComputeNonZeroJacobianIndices()
 
 
+/**
+ * ********************* SetTrivialNonZeroJacobianIndices ****************************
+ */
+
+template< class TScalar, unsigned int NDimensions, unsigned int VSplineOrder >
+void
+RecursiveBSplineTransform< TScalar, NDimensions, VSplineOrder >
+::SetTrivialNonZeroJacobianIndices( NonZeroJacobianIndicesType & nonZeroJacobianIndices ) const
+{
+  const NumberOfParametersType nnzji = this->GetNumberOfNonZeroJacobianIndices();
+  nonZeroJacobianIndices.resize( nnzji );
+  for( NumberOfParametersType i = 0; i < nnzji; ++i )
+  {
+    nonZeroJacobianIndices[ i ] = i;
+  }
+
+} // end SetTrivialNonZeroJacobianIndices()
+
+
 } // end namespace itk
 
 #endif
@@ -94,6 +94,11 @@ public:
   /** Set the B-spline order. */
   itkSetMacro( BSplineOrder, unsigned int );
 
+  /** Set/Get the number of work units used for upsampling. When zero,
+   * the global default number of threads is used. Default: 0. */
+  itkSetMacro( NumberOfWorkUnits, ThreadIdType );
+  itkGetConstMacro( NumberOfWorkUnits, ThreadIdType );
+
   /** Compute the output parameter array. */
   virtual void UpsampleParameters( const ArrayType & param_in,
     ArrayType & param_out );
@@ -127,6 +132,7 @@ private:
   DirectionType m_RequiredGridDirection;
   RegionType    m_RequiredGridRegion;
   unsigned int  m_BSplineOrder;
+  ThreadIdType  m_NumberOfWorkUnits;
 
 };
 
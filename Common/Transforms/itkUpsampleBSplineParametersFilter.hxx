@@ -21,8 +21,9 @@
 #include "itkUpsampleBSplineParametersFilter.h"
 
 #include "itkBSplineResampleImageFunction.h"
-#include "itkBSplineDecompositionImageFilter.h"
+#include "itkMultiOrderBSplineDecompositionImageFilter.h"
 #include "itkResampleImageFilter.h"
+#include "itkMultiThreaderBase.h"
 
 namespace itk
 {
@@ -35,7 +36,8 @@ template< class TArray, class TImage >
 UpsampleBSplineParametersFilter< TArray, TImage >
 ::UpsampleBSplineParametersFilter()
 {
-  this->m_BSplineOrder = 3;
+  this->m_BSplineOrder      = 3;
+  this->m_NumberOfWorkUnits = 0;
 
   // Initialize grid settings.
   this->m_CurrentGridOrigin.Fill( 0.0 );
@@ -69,7 +71,7 @@ UpsampleBSplineParametersFilter< TArray, TImage >
     ImageType, ImageType >                        UpsampleFilterType;
   typedef itk::BSplineResampleImageFunction<
     ImageType, ValueType >                        CoefficientUpsampleFunctionType;
-  typedef itk::BSplineDecompositionImageFilter<
+  typedef itk::MultiOrderBSplineDecompositionImageFilter<
     ImageType, ImageType >                        DecompositionFilterType;
 
   /** Get the number of parameters. */
@@ -87,20 +89,20 @@ UpsampleBSplineParametersFilter< TArray, TImage >
   PixelType * outputDataPointer
     = const_cast< PixelType * >( parameters_out.data_block() );
 
-  /** The input parameters are represented as a coefficient image. */
-  ImagePointer coeffs_in = ImageType::New();
-  coeffs_in->SetOrigin(  this->m_CurrentGridOrigin );
-  coeffs_in->SetSpacing( this->m_CurrentGridSpacing );
-  coeffs_in->SetDirection( this->m_CurrentGridDirection );
-  coeffs_in->SetRegions( this->m_CurrentGridRegion );
-
-  /** Loop over dimension: each direction is upsampled separately. */
-  for( unsigned int j = 0; j < Dimension; j++ )
+  /** Upsample the coefficients of one direction, using the given number of work units. */
+  auto upsampleDirection = [ this, inputDataPointer, outputDataPointer,
+    currentNumberOfPixels, requiredNumberOfPixels ]( const unsigned int j, const ThreadIdType numberOfWorkUnits )
   {
-    /** Fill the coefficient image with parameter data. */
+    /** The input parameters are represented as a coefficient image,
+     * which is filled with the parameter data of this direction.
+     */
+    ImagePointer coeffs_in = ImageType::New();
+    coeffs_in->SetOrigin(  this->m_CurrentGridOrigin );
+    coeffs_in->SetSpacing( this->m_CurrentGridSpacing );
+    coeffs_in->SetDirection( this->m_CurrentGridDirection );
+    coeffs_in->SetRegions( this->m_CurrentGridRegion );
     coeffs_in->GetPixelContainer()->SetImportPointer(
-      inputDataPointer, currentNumberOfPixels );
-    inputDataPointer += currentNumberOfPixels;
+      inputDataPointer + currentNumberOfPixels * j, currentNumberOfPixels );
 
     /** Set the coefficient image as the input of the upsampler filter.
      * The upsampler samples the deformation field at the locations
@@ -127,18 +129,19 @@ UpsampleBSplineParametersFilter< TArray, TImage >
     upsampler->SetOutputOrigin( this->m_RequiredGridOrigin );
     upsampler->SetOutputDirection( this->m_RequiredGridDirection );
     upsampler->SetInput( coeffs_in );
+    upsampler->SetNumberOfWorkUnits( numberOfWorkUnits );
 
-    /** Setup the decomposition filter. */
+    /** Setup the decomposition filter. The multi-order variant is used,
+     * since it is multi-threaded over the scanlines.
+     */
     decompositionFilter->SetSplineOrder( this->m_BSplineOrder );
     decompositionFilter->SetInput( upsampler->GetOutput() );
+    decompositionFilter->SetNumberOfWorkUnits( numberOfWorkUnits );
 
     /** Do the upsampling. */
     try
     {
       decompositionFilter->UpdateLargestPossibleRegion();
-      // \todo: the decomposition filter could be multi-threaded
-      // by deriving it from the RecursiveSeparableImageFilter,
-      // similar to the SmoothingRecursiveGaussianImageFilter.
     }
     catch( itk::ExceptionObject & excp )
     {
@@ -158,8 +161,34 @@ UpsampleBSplineParametersFilter< TArray, TImage >
     /** Copy the contents of coeffs_out in a ParametersType array. */
     std::copy( coeffs_out, coeffs_out + requiredNumberOfPixels,
       outputDataPointer + requiredNumberOfPixels * j );
-
-  } // end for dimension loop
+  };
+
+  /** Each direction is upsampled separately, and independently. To avoid
+   * nested multi-threading, either the directions are processed concurrently
+   * by single-threaded pipelines, or one after another by multi-threaded
+   * pipelines. The first is only beneficial when there are at least as
+   * many directions as work units.
+   */
+  const ThreadIdType numberOfWorkUnits = this->m_NumberOfWorkUnits > 0
+    ? this->m_NumberOfWorkUnits : MultiThreaderBase::GetGlobalDefaultNumberOfThreads();
+  if( numberOfWorkUnits > 1 && numberOfWorkUnits <= Dimension )
+  {
+    MultiThreaderBase::Pointer threader = MultiThreaderBase::New();
+    threader->SetNumberOfWorkUnits( numberOfWorkUnits );
+    threader->ParallelizeArray( 0, Dimension,
+      [ &upsampleDirection ]( SizeValueType j )
+      {
+        upsampleDirection( static_cast< unsigned int >( j ), 1 );
+      },
+      nullptr );
+  }
+  else
+  {
+    for( unsigned int j = 0; j < Dimension; j++ )
+    {
+      upsampleDirection( j, numberOfWorkUnits );
+    }
+  }
 
 } // end UpsampleParameters()
 
@@ -205,6 +234,7 @@ UpsampleBSplineParametersFilter< TArray, TImage >
   os << indent << "RequiredGridRegion: "  << this->m_RequiredGridRegion << std::endl;
 
   os << indent << "BSplineOrder: " << this->m_BSplineOrder << std::endl;
+  os << indent << "NumberOfWorkUnits: " << this->m_NumberOfWorkUnits << std::endl;
 
 } // end PrintSelf()
 
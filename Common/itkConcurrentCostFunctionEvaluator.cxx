@@ -0,0 +1,238 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkConcurrentCostFunctionEvaluator.h"
+#include "itkNumericTraits.h"
+
+namespace itk
+{
+
+/**
+ * ******************** Constructor *******************************
+ */
+
+ConcurrentCostFunctionEvaluator
+::ConcurrentCostFunctionEvaluator()
+{
+  this->m_EvaluateFirstPositionFirst = true;
+
+} // end Constructor()
+
+
+/**
+ * ******************** AddContext *******************************
+ */
+
+void
+ConcurrentCostFunctionEvaluator
+::AddContext( const CostFunctionType * costFunction )
+{
+  if( costFunction == nullptr )
+  {
+    itkExceptionMacro( << "Cannot add a null cost function context." );
+  }
+  this->m_Contexts.push_back( costFunction );
+  this->Modified();
+
+} // end AddContext()
+
+
+/**
+ * ******************** RemoveContexts *******************************
+ */
+
+void
+ConcurrentCostFunctionEvaluator
+::RemoveContexts( void )
+{
+  if( !this->m_Contexts.empty() )
+  {
+    this->m_Contexts.clear();
+    this->Modified();
+  }
+
+} // end RemoveContexts()
+
+
+/**
+ * ******************** GetValues *******************************
+ */
+
+void
+ConcurrentCostFunctionEvaluator
+::GetValues( const ParametersListType & positions,
+  MeasureListType & values, EvaluationStatusListType & succeeded,
+  ExceptionListType & errors ) const
+{
+  const std::size_t numberOfPositions = positions.size();
+  values.assign( numberOfPositions, NumericTraits< MeasureType >::ZeroValue() );
+  succeeded.assign( numberOfPositions, 0 );
+  errors.assign( numberOfPositions, ExceptionObject() );
+  if( numberOfPositions == 0 )
+  {
+    return;
+  }
+  if( this->m_CostFunction.IsNull() )
+  {
+    itkExceptionMacro( << "No cost function has been set." );
+  }
+
+  /** Evaluate sequentially, if there is nothing to run concurrently. */
+  if( this->m_Contexts.empty() || numberOfPositions == 1 )
+  {
+    this->ThreadedGetValues( 0, 1, 0, numberOfPositions,
+      positions, values, succeeded, errors );
+    return;
+  }
+
+  /** Evaluate the first position on the cost function itself, before the
+   * contexts are started, if requested.
+   */
+  std::size_t begin = 0;
+  if( this->m_EvaluateFirstPositionFirst )
+  {
+    this->ThreadedGetValues( 0, 1, 0, 1, positions, values, succeeded, errors );
+    begin = 1;
+  }
+
+  /** Fill the threader parameter struct with information. */
+  MultiThreaderParameterType temp;
+  temp.st_Evaluator = this;
+  temp.st_Positions = &positions;
+  temp.st_Values    = &values;
+  temp.st_Succeeded = &succeeded;
+  temp.st_Errors    = &errors;
+  temp.st_Begin     = begin;
+
+  /** Launch one work unit per context. */
+  typedef PlatformMultiThreader ThreaderType;
+  ThreaderType::Pointer threader = ThreaderType::New();
+  threader->SetNumberOfWorkUnits( this->GetNumberOfContexts() + 1 );
+  temp.st_NumberOfContexts = threader->GetNumberOfWorkUnits();
+  threader->SetSingleMethod( GetValuesThreaderCallback, &temp );
+  threader->SingleMethodExecute();
+
+} // end GetValues()
+
+
+/**
+ * ******************** GetValues *******************************
+ */
+
+void
+ConcurrentCostFunctionEvaluator
+::GetValues( const ParametersListType & positions, MeasureListType & values ) const
+{
+  EvaluationStatusListType succeeded;
+  ExceptionListType        errors;
+  this->GetValues( positions, values, succeeded, errors );
+
+  /** Pass the first error to the caller. */
+  for( std::size_t i = 0; i < positions.size(); ++i )
+  {
+    if( !succeeded[ i ] )
+    {
+      throw errors[ i ];
+    }
+  }
+
+} // end GetValues()
+
+
+/**
+ * ******************** GetValuesThreaderCallback *******************************
+ */
+
+ITK_THREAD_RETURN_TYPE
+ConcurrentCostFunctionEvaluator
+::GetValuesThreaderCallback( void * arg )
+{
+  /** Get the current thread id and user data. */
+  PlatformMultiThreader::WorkUnitInfo * infoStruct
+    = static_cast< PlatformMultiThreader::WorkUnitInfo * >( arg );
+  const ThreadIdType           threadId = infoStruct->WorkUnitID;
+  MultiThreaderParameterType * temp
+    = static_cast< MultiThreaderParameterType * >( infoStruct->UserData );
+
+  /** Call the real implementation. */
+  temp->st_Evaluator->ThreadedGetValues( threadId, temp->st_NumberOfContexts,
+    temp->st_Begin, temp->st_Positions->size(), *temp->st_Positions,
+    *temp->st_Values, *temp->st_Succeeded, *temp->st_Errors );
+
+  return ITK_THREAD_RETURN_DEFAULT_VALUE;
+
+} // end GetValuesThreaderCallback()
+
+
+/**
+ * ******************** ThreadedGetValues *******************************
+ */
+
+void
+ConcurrentCostFunctionEvaluator
+::ThreadedGetValues( unsigned int contextId, unsigned int numberOfContexts,
+  std::size_t begin, std::size_t end, const ParametersListType & positions,
+  MeasureListType & values, EvaluationStatusListType & succeeded,
+  ExceptionListType & errors ) const
+{
+  const CostFunctionType * costFunction = contextId == 0
+    ? this->m_CostFunction.GetPointer()
+    : this->m_Contexts[ contextId - 1 ].GetPointer();
+
+  /** Static assignment of the positions to the contexts, so that a
+   * position is always evaluated by the same context.
+   */
+  std::size_t i = begin + ( contextId + numberOfContexts - begin % numberOfContexts ) % numberOfContexts;
+  for( ; i < end; i += numberOfContexts )
+  {
+    try
+    {
+      values[ i ]    = costFunction->GetValue( positions[ i ] );
+      succeeded[ i ] = 1;
+    }
+    catch( ExceptionObject & err )
+    {
+      errors[ i ] = err;
+    }
+    catch( std::exception & err )
+    {
+      errors[ i ] = ExceptionObject( __FILE__, __LINE__, err.what(), ITK_LOCATION );
+    }
+  }
+
+} // end ThreadedGetValues()
+
+
+/**
+ * ******************** PrintSelf *******************************
+ */
+
+void
+ConcurrentCostFunctionEvaluator
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "CostFunction: " << this->m_CostFunction.GetPointer() << std::endl;
+  os << indent << "NumberOfContexts: " << this->m_Contexts.size() << std::endl;
+  os << indent << "EvaluateFirstPositionFirst: "
+     << ( this->m_EvaluateFirstPositionFirst ? "true" : "false" ) << std::endl;
+
+} // end PrintSelf()
+
+
+} // end namespace itk
@@ -0,0 +1,166 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkConcurrentCostFunctionEvaluator_h
+#define __itkConcurrentCostFunctionEvaluator_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkSingleValuedCostFunction.h"
+#include "itkPlatformMultiThreader.h"
+#include <vector>
+
+namespace itk
+{
+
+/**
+ * \class ConcurrentCostFunctionEvaluator
+ * \brief Evaluates a cost function at a batch of positions, concurrently
+ * on independent copies (contexts) of the cost function.
+ *
+ * Optimizers that need many independent function values per iteration
+ * (population based or derivative free methods) use this class to evaluate
+ * them in one batch. Without contexts, the batch is evaluated sequentially
+ * with the cost function. When contexts are added with AddContext(), every
+ * context runs in its own thread of a PlatformMultiThreader. A platform
+ * threader is used, since the cost functions may use the global thread
+ * pool themselves.
+ *
+ * The contexts must compute the same function as the cost function, and
+ * must not share mutable state with it, or with each other.
+ *
+ * By default, the first position is evaluated on the cost function itself,
+ * before the contexts are started. This brings lazily updated state of the
+ * cost function up to date on the calling thread, for example the samples
+ * of an image sampler, of which the contexts take a snapshot (see
+ * ImageCopySampler). Callers that bring this state up to date themselves
+ * can switch this off with EvaluateFirstPositionFirstOff(), so that also
+ * a batch of two positions is evaluated concurrently. Every other position
+ * i is evaluated by context i modulo (number of contexts + 1), where 0
+ * denotes the cost function itself. So, every position is always evaluated by the same context, and
+ * the results are reproducible.
+ *
+ * \ingroup Optimizers
+ */
+
+class ConcurrentCostFunctionEvaluator : public Object
+{
+public:
+
+  /** Standard ITK-stuff. */
+  typedef ConcurrentCostFunctionEvaluator Self;
+  typedef Object                          Superclass;
+  typedef SmartPointer< Self >            Pointer;
+  typedef SmartPointer< const Self >      ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( ConcurrentCostFunctionEvaluator, Object );
+
+  /** Typedefs of the cost function. */
+  typedef SingleValuedCostFunction         CostFunctionType;
+  typedef CostFunctionType::ConstPointer   CostFunctionConstPointer;
+  typedef CostFunctionType::ParametersType ParametersType;
+  typedef CostFunctionType::MeasureType    MeasureType;
+
+  /** Typedefs for the batched evaluation. */
+  typedef std::vector< ParametersType >           ParametersListType;
+  typedef std::vector< MeasureType >              MeasureListType;
+  typedef std::vector< unsigned char >            EvaluationStatusListType;
+  typedef std::vector< ExceptionObject >          ExceptionListType;
+  typedef std::vector< CostFunctionConstPointer > CostFunctionContainerType;
+
+  /** Set/Get the cost function, which is also context 0. */
+  itkSetConstObjectMacro( CostFunction, CostFunctionType );
+  itkGetConstObjectMacro( CostFunction, CostFunctionType );
+
+  /** Add an independent cost function context. */
+  virtual void AddContext( const CostFunctionType * costFunction );
+
+  /** Remove all additional cost function contexts. */
+  virtual void RemoveContexts( void );
+
+  /** Get the number of additional cost function contexts. */
+  unsigned int GetNumberOfContexts( void ) const
+  { return static_cast< unsigned int >( this->m_Contexts.size() ); }
+
+  /** Set/Get whether the first position is evaluated on the cost function,
+   * before the contexts are started. Default true.
+   */
+  itkSetMacro( EvaluateFirstPositionFirst, bool );
+  itkGetConstMacro( EvaluateFirstPositionFirst, bool );
+  itkBooleanMacro( EvaluateFirstPositionFirst );
+
+  /** Evaluate the cost function at a batch of positions. Evaluations that
+   * throw an exception are marked with a zero in succeeded, and their
+   * exception is stored in errors; the other values are stored in values.
+   */
+  virtual void GetValues( const ParametersListType & positions,
+    MeasureListType & values, EvaluationStatusListType & succeeded,
+    ExceptionListType & errors ) const;
+
+  /** Evaluate the cost function at a batch of positions. The exception of
+   * the first failed position, in position order, is passed to the caller.
+   */
+  virtual void GetValues( const ParametersListType & positions,
+    MeasureListType & values ) const;
+
+protected:
+
+  ConcurrentCostFunctionEvaluator();
+  ~ConcurrentCostFunctionEvaluator() override {}
+
+  /** PrintSelf. */
+  void PrintSelf( std::ostream & os, Indent indent ) const override;
+
+private:
+
+  ConcurrentCostFunctionEvaluator( const Self & ); // purposely not implemented
+  void operator=( const Self & );                  // purposely not implemented
+
+  CostFunctionConstPointer  m_CostFunction;
+  CostFunctionContainerType m_Contexts;
+  bool                      m_EvaluateFirstPositionFirst;
+
+  /** The struct passed to the threader callback. */
+  struct MultiThreaderParameterType
+  {
+    const Self *               st_Evaluator;
+    const ParametersListType * st_Positions;
+    MeasureListType *          st_Values;
+    EvaluationStatusListType * st_Succeeded;
+    ExceptionListType *        st_Errors;
+    std::size_t                st_Begin;
+    unsigned int               st_NumberOfContexts;
+  };
+
+  /** The callback function for the concurrent evaluation. */
+  static ITK_THREAD_RETURN_TYPE GetValuesThreaderCallback( void * arg );
+
+  /** Evaluate the positions in [begin, end) assigned to a single context. */
+  void ThreadedGetValues( unsigned int contextId, unsigned int numberOfContexts,
+    std::size_t begin, std::size_t end, const ParametersListType & positions,
+    MeasureListType & values, EvaluationStatusListType & succeeded,
+    ExceptionListType & errors ) const;
+
+};
+
+} // end namespace itk
+
+#endif // end #ifndef __itkConcurrentCostFunctionEvaluator_h
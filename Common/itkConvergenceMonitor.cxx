@@ -0,0 +1,215 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkConvergenceMonitor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace itk
+{
+
+/**
+ * ********************* Constructor ****************************
+ */
+
+ConvergenceMonitor::ConvergenceMonitor() :
+  m_WindowSize( 50 ),
+  m_ValueTolerance( 1e-4 ),
+  m_GradientTolerance( 1e-3 ),
+  m_ParameterChangeTolerance( 0.01 ),
+  m_Stochastic( false )
+{
+  this->Initialize();
+
+} // end Constructor
+
+
+/**
+ * ********************* SetWindowSize ****************************
+ */
+
+void
+ConvergenceMonitor::SetWindowSize( const unsigned int windowSize )
+{
+  this->m_WindowSize = std::max( windowSize, 1u );
+
+} // end SetWindowSize()
+
+
+/**
+ * ********************* Initialize ****************************
+ */
+
+void
+ConvergenceMonitor::Initialize( void )
+{
+  this->m_NumberOfIterations = 0;
+  this->m_Converged          = false;
+  this->m_StopConditionDescription.clear();
+  this->m_ValueSum                = 0.0;
+  this->m_ValueSquaredSum         = 0.0;
+  this->m_PreviousValueSum        = 0.0;
+  this->m_PreviousValueSquaredSum = 0.0;
+  this->m_HasPreviousWindow       = false;
+  this->m_GradientSum.SetSize( 0 );
+  this->m_GradientMagnitudeSum   = 0.0;
+  this->m_LastGradientMagnitude  = 0.0;
+  this->m_FirstGradientMagnitude = 0.0;
+  this->m_FirstParameters.SetSize( 0 );
+  this->m_WindowStartParameters.SetSize( 0 );
+
+} // end Initialize()
+
+
+/**
+ * ********************* Update ****************************
+ */
+
+bool
+ConvergenceMonitor::Update( const double value,
+  const VectorType & gradient, const VectorType & parameters )
+{
+  if( this->m_NumberOfIterations == 0 )
+  {
+    this->m_FirstParameters        = parameters;
+    this->m_WindowStartParameters  = parameters;
+    this->m_FirstGradientMagnitude = gradient.magnitude();
+  }
+  ++this->m_NumberOfIterations;
+
+  /** Accumulate the statistics of this window. */
+  this->m_ValueSum        += value;
+  this->m_ValueSquaredSum += value * value;
+  if( gradient.GetSize() > 0 )
+  {
+    if( this->m_GradientSum.GetSize() != gradient.GetSize() )
+    {
+      this->m_GradientSum.SetSize( gradient.GetSize() );
+      this->m_GradientSum.Fill( 0.0 );
+    }
+    this->m_GradientSum          += gradient;
+    this->m_LastGradientMagnitude = gradient.magnitude();
+    this->m_GradientMagnitudeSum += this->m_LastGradientMagnitude;
+  }
+
+  /** Test at the end of the window, and start a new one. */
+  if( this->m_NumberOfIterations % this->m_WindowSize == 0 )
+  {
+    this->m_Converged = this->m_Converged || this->CheckConvergence( parameters );
+
+    this->m_PreviousValueSum        = this->m_ValueSum;
+    this->m_PreviousValueSquaredSum = this->m_ValueSquaredSum;
+    this->m_ValueSum                = 0.0;
+    this->m_ValueSquaredSum         = 0.0;
+    this->m_HasPreviousWindow       = true;
+    this->m_GradientSum.Fill( 0.0 );
+    this->m_GradientMagnitudeSum  = 0.0;
+    this->m_WindowStartParameters = parameters;
+  }
+
+  return this->m_Converged;
+
+} // end Update()
+
+
+/**
+ * ********************* CheckConvergence ****************************
+ */
+
+bool
+ConvergenceMonitor::CheckConvergence( const VectorType & parameters )
+{
+  if( !this->m_HasPreviousWindow )
+  {
+    return false;
+  }
+  const double windowSize = static_cast< double >( this->m_WindowSize );
+
+  /** The value test. For stochastic values, a decrease within two standard
+   * errors of the difference of the means is not significant.
+   */
+  const double previousMean = this->m_PreviousValueSum / windowSize;
+  const double mean         = this->m_ValueSum / windowSize;
+  double       valueThreshold = this->m_ValueTolerance * std::abs( previousMean );
+  if( this->m_Stochastic )
+  {
+    const double previousVariance = std::max( 0.0,
+      this->m_PreviousValueSquaredSum / windowSize - previousMean * previousMean );
+    const double variance = std::max( 0.0,
+      this->m_ValueSquaredSum / windowSize - mean * mean );
+    valueThreshold = std::max( valueThreshold,
+      2.0 * std::sqrt( ( previousVariance + variance ) / windowSize ) );
+  }
+  const bool valueStalled = previousMean - mean <= valueThreshold;
+  if( !valueStalled )
+  {
+    return false;
+  }
+
+  /** The gradient test. The mean of N gradients that are pure noise has an
+   * expected magnitude of about their mean magnitude over sqrt( N ).
+   */
+  bool gradientStalled = false;
+  if( this->m_GradientSum.GetSize() > 0 )
+  {
+    double gradientMagnitude = this->m_LastGradientMagnitude;
+    double gradientThreshold = this->m_GradientTolerance * this->m_FirstGradientMagnitude;
+    if( this->m_Stochastic )
+    {
+      gradientMagnitude = this->m_GradientSum.magnitude() / windowSize;
+      gradientThreshold = std::max( gradientThreshold,
+        2.0 * this->m_GradientMagnitudeSum / windowSize / std::sqrt( windowSize ) );
+    }
+    gradientStalled = gradientMagnitude <= gradientThreshold;
+  }
+
+  /** The parameter test. */
+  const double parameterChange = ( parameters - this->m_WindowStartParameters ).magnitude();
+  const double totalChange     = ( parameters - this->m_FirstParameters ).magnitude();
+  const bool   parametersStalled
+    = parameterChange <= this->m_ParameterChangeTolerance * totalChange;
+
+  if( !gradientStalled && !parametersStalled )
+  {
+    return false;
+  }
+
+  /** Describe the satisfied tests. */
+  std::ostringstream description;
+  description << "the mean metric value changed from " << previousMean
+              << " to " << mean << " in the last " << this->m_WindowSize << " iterations";
+  if( gradientStalled )
+  {
+    description << ( this->m_Stochastic
+      ? ", the mean gradient is within the gradient noise"
+      : ", the gradient magnitude has (nearly) vanished" );
+  }
+  if( parametersStalled )
+  {
+    description << ", and the parameters changed " << parameterChange
+                << " of a total change of " << totalChange;
+  }
+  this->m_StopConditionDescription = description.str();
+
+  return true;
+
+} // end CheckConvergence()
+
+
+} // end namespace itk
@@ -0,0 +1,198 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkConvergenceMonitor_h
+#define __itkConvergenceMonitor_h
+
+#include "itkArray.h"
+
+#include <string>
+
+namespace itk
+{
+
+/**
+ * \class ConvergenceMonitor
+ * \brief Detects that an iterative optimization has stopped making progress.
+ *
+ * The monitor is updated every iteration with the metric value, the
+ * gradient (optional) and the parameters. The iterations are divided in
+ * windows of WindowSize iterations. At the end of every window, from the
+ * second one on, the following tests are done:
+ *
+ * \li The value test: the mean value of this window is less than
+ *   ValueTolerance times the absolute mean value of the previous window
+ *   below it.
+ * \li The gradient test: the magnitude of the gradient is less than
+ *   GradientTolerance times the magnitude of the first gradient.
+ * \li The parameter test: the parameters changed less than
+ *   ParameterChangeTolerance times their total change since the first
+ *   iteration, during this window.
+ *
+ * The optimization has converged when the value test and the gradient test
+ * or the parameter test are satisfied.
+ *
+ * For stochastic optimizations, the metric values and gradients are noisy.
+ * The value test then also accepts decreases of the mean value that are
+ * within two standard errors of the mean values. The gradient test then
+ * uses the mean of the gradients of the window, and also accepts means
+ * that are within twice their expected magnitude for gradients that are
+ * pure noise, which is the mean gradient magnitude over sqrt( WindowSize ).
+ *
+ * \ingroup Common
+ */
+
+class ConvergenceMonitor
+{
+public:
+
+  typedef Array< double > VectorType;
+
+  ConvergenceMonitor();
+  ~ConvergenceMonitor() {}
+
+  /** Set/Get the number of iterations per window. Default: 50. */
+  void SetWindowSize( const unsigned int windowSize );
+
+  unsigned int GetWindowSize( void ) const
+  {
+    return this->m_WindowSize;
+  }
+
+
+  /** Set/Get the relative decrease of the mean value per window that is
+   * considered a stall. Default: 1e-4. */
+  void SetValueTolerance( const double tolerance )
+  {
+    this->m_ValueTolerance = tolerance;
+  }
+
+
+  double GetValueTolerance( void ) const
+  {
+    return this->m_ValueTolerance;
+  }
+
+
+  /** Set/Get the gradient magnitude, relative to the first gradient, that is
+   * considered a stall. Default: 1e-3. */
+  void SetGradientTolerance( const double tolerance )
+  {
+    this->m_GradientTolerance = tolerance;
+  }
+
+
+  double GetGradientTolerance( void ) const
+  {
+    return this->m_GradientTolerance;
+  }
+
+
+  /** Set/Get the change of the parameters per window, relative to their
+   * total change, that is considered a stall. Default: 0.01. */
+  void SetParameterChangeTolerance( const double tolerance )
+  {
+    this->m_ParameterChangeTolerance = tolerance;
+  }
+
+
+  double GetParameterChangeTolerance( void ) const
+  {
+    return this->m_ParameterChangeTolerance;
+  }
+
+
+  /** Set/Get whether the values and gradients are stochastic. Default: false. */
+  void SetStochastic( const bool stochastic )
+  {
+    this->m_Stochastic = stochastic;
+  }
+
+
+  bool GetStochastic( void ) const
+  {
+    return this->m_Stochastic;
+  }
+
+
+  /** Forget all previous iterations, for example at a new resolution. */
+  void Initialize( void );
+
+  /** Add an iteration. The gradient may be empty, for optimizers without
+   * gradient, in which case the gradient test is not done. Returns true
+   * when the optimization has converged. */
+  bool Update( const double value, const VectorType & gradient, const VectorType & parameters );
+
+  /** Get whether the optimization has converged. */
+  bool GetConverged( void ) const
+  {
+    return this->m_Converged;
+  }
+
+
+  /** Get the number of iterations since Initialize(). */
+  unsigned long GetNumberOfIterations( void ) const
+  {
+    return this->m_NumberOfIterations;
+  }
+
+
+  /** Get a description of the tests that were satisfied at convergence. */
+  const std::string & GetStopConditionDescription( void ) const
+  {
+    return this->m_StopConditionDescription;
+  }
+
+
+private:
+
+  ConvergenceMonitor( const ConvergenceMonitor & ); // purposely not implemented
+  void operator=( const ConvergenceMonitor & );     // purposely not implemented
+
+  /** Do the tests at the end of a window. */
+  bool CheckConvergence( const VectorType & parameters );
+
+  /** Settings. */
+  unsigned int m_WindowSize;
+  double       m_ValueTolerance;
+  double       m_GradientTolerance;
+  double       m_ParameterChangeTolerance;
+  bool         m_Stochastic;
+
+  /** The state. The value sums are of the current and the previous window,
+   * the parameters of the first iteration and the end of the previous window.
+   */
+  unsigned long m_NumberOfIterations;
+  bool          m_Converged;
+  std::string   m_StopConditionDescription;
+  double        m_ValueSum;
+  double        m_ValueSquaredSum;
+  double        m_PreviousValueSum;
+  double        m_PreviousValueSquaredSum;
+  bool          m_HasPreviousWindow;
+  VectorType    m_GradientSum;
+  double        m_GradientMagnitudeSum;
+  double        m_LastGradientMagnitude;
+  double        m_FirstGradientMagnitude;
+  VectorType    m_FirstParameters;
+  VectorType    m_WindowStartParameters;
+
+};
+
+} // end namespace itk
+
+#endif // end #ifndef __itkConvergenceMonitor_h
@@ -20,6 +20,7 @@
 
 #include "itkImageToImageFilter.h"
 #include "itkMultiResolutionPyramidImageFilter.h"
+#include "itkParabolicErodeImageFilter.h"
 
 namespace itk
 {
@@ -92,6 +93,12 @@ public:
     InputImageType, OutputImageType >                    ImagePyramidFilterType;
   typedef typename ImagePyramidFilterType::ScheduleType ScheduleType;
 
+  /** Typedefs for the erosion filter that does the actual work. */
+  typedef ParabolicErodeImageFilter<
+    InputImageType, OutputImageType >               ErodeFilterType;
+  typedef typename ErodeFilterType::RadiusType     RadiusType;
+  typedef typename ErodeFilterType::ScalarRealType ScalarRealType;
+
   /** Set/Get the pyramid schedule used to downsample the image whose
    * mask is the input of the ErodeMaskImageFilter
    * Default: filled with ones, one resolution.
@@ -117,6 +124,12 @@ public:
   itkSetMacro( ResolutionLevel, unsigned int );
   itkGetConstMacro( ResolutionLevel, unsigned int );
 
+  /** Compute the scales of the parabolic erosion, from the schedule, the
+   * resolution level and the IsMovingMask setting. Two filters with the same
+   * input and the same erosion scales produce the same output.
+   */
+  virtual RadiusType ComputeErosionScales( void ) const;
+
 #ifdef ITK_USE_CONCEPT_CHECKING
   /** Begin concept checking */
   itkConceptMacro( SameDimensionCheck,
@@ -19,7 +19,6 @@
 #define _itkErodeMaskImageFilter_hxx
 
 #include "itkErodeMaskImageFilter.h"
-#include "itkParabolicErodeImageFilter.h"
 //#include "itkThresholdImageFilter.h"
 
 namespace itk
@@ -44,21 +43,14 @@ ErodeMaskImageFilter< TImage >
 
 
 /**
- * ************* GenerateData *******************
+ * ************* ComputeErosionScales *******************
  */
 
 template< class TImage >
-void
+typename ErodeMaskImageFilter< TImage >::RadiusType
 ErodeMaskImageFilter< TImage >
-::GenerateData( void )
+::ComputeErosionScales( void ) const
 {
-  /** Typedefs. */
-  //typedef itk::ThresholdImageFilter<InputImageType> ThresholdFilterType;
-  typedef itk::ParabolicErodeImageFilter<
-    InputImageType, OutputImageType >               ErodeFilterType;
-  typedef typename ErodeFilterType::RadiusType     RadiusType;
-  typedef typename ErodeFilterType::ScalarRealType ScalarRealType;
-
   /** Get the correct radius. */
   RadiusType     radiusarray;
   ScalarRealType radius   = 0.0;
@@ -81,6 +73,26 @@ ErodeMaskImageFilter< TImage >
     radiusarray.SetElement( i, radius );
   }
 
+  return radiusarray;
+
+} // end ComputeErosionScales()
+
+
+/**
+ * ************* GenerateData *******************
+ */
+
+template< class TImage >
+void
+ErodeMaskImageFilter< TImage >
+::GenerateData( void )
+{
+  /** Typedefs. */
+  //typedef itk::ThresholdImageFilter<InputImageType> ThresholdFilterType;
+
+  /** Get the correct radius. */
+  const RadiusType radiusarray = this->ComputeErosionScales();
+
   /** Threshold the data first. Every voxel with intensity >= 1 is used.
   // Not needed since IsInside of a mask checks for != 0.
   typename ThresholdFilterType::Pointer threshold = ThresholdFilterType::New();
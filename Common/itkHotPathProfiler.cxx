@@ -0,0 +1,204 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkHotPathProfiler.h"
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+
+namespace itk
+{
+
+namespace
+{
+
+/** The accumulators of a single thread. The padding on both sides keeps
+ * the accumulators of different threads on different cache lines, without
+ * relying on the alignment of the elements of the deque below: before
+ * C++17 its allocator does not honour alignas for over-aligned types. */
+struct ThreadAccumulatorType
+{
+  char                         m_PaddingBefore[ 64 ];
+  std::atomic< std::uint64_t > m_Nanoseconds[ HotPathProfiler::NumberOfPhases ];
+  std::atomic< std::uint64_t > m_Counts[ HotPathProfiler::NumberOfCounters ];
+  char                         m_PaddingAfter[ 64 ];
+
+  ThreadAccumulatorType( void )
+  {
+    for( unsigned int i = 0; i < HotPathProfiler::NumberOfPhases; ++i )
+    {
+      this->m_Nanoseconds[ i ] = 0;
+    }
+    for( unsigned int i = 0; i < HotPathProfiler::NumberOfCounters; ++i )
+    {
+      this->m_Counts[ i ] = 0;
+    }
+  }
+};
+
+/** All accumulators ever created. A deque does not move its elements,
+ * so the accumulators stay valid after their thread has finished. */
+std::mutex                          g_AccumulatorsMutex;
+std::deque< ThreadAccumulatorType > g_Accumulators;
+
+ThreadAccumulatorType &
+GetThreadAccumulator( void )
+{
+  thread_local ThreadAccumulatorType * accumulator = nullptr;
+  if( accumulator == nullptr )
+  {
+    std::lock_guard< std::mutex > lock( g_AccumulatorsMutex );
+    g_Accumulators.emplace_back();
+    accumulator = &g_Accumulators.back();
+  }
+  return *accumulator;
+}
+
+} // end anonymous namespace
+
+
+/**
+ * ********************* SnapshotType ****************************
+ */
+
+HotPathProfiler::SnapshotType::SnapshotType( void )
+{
+  for( unsigned int i = 0; i < NumberOfPhases; ++i )
+  {
+    this->m_Seconds[ i ] = 0.0;
+  }
+  for( unsigned int i = 0; i < NumberOfCounters; ++i )
+  {
+    this->m_Counts[ i ] = 0;
+  }
+
+} // end SnapshotType()
+
+
+HotPathProfiler::SnapshotType
+HotPathProfiler::SnapshotType::operator-( const SnapshotType & other ) const
+{
+  SnapshotType difference;
+  for( unsigned int i = 0; i < NumberOfPhases; ++i )
+  {
+    difference.m_Seconds[ i ] = this->m_Seconds[ i ] - other.m_Seconds[ i ];
+  }
+  for( unsigned int i = 0; i < NumberOfCounters; ++i )
+  {
+    difference.m_Counts[ i ] = this->m_Counts[ i ] - other.m_Counts[ i ];
+  }
+  return difference;
+
+} // end operator-()
+
+
+/**
+ * ********************* AddTime ****************************
+ */
+
+void
+HotPathProfiler::AddTime( PhaseType phase, std::uint64_t nanoseconds )
+{
+  GetThreadAccumulator().m_Nanoseconds[ phase ].fetch_add(
+    nanoseconds, std::memory_order_relaxed );
+
+} // end AddTime()
+
+
+/**
+ * ********************* AddCount ****************************
+ */
+
+void
+HotPathProfiler::AddCount( CounterType counter, std::uint64_t count )
+{
+  GetThreadAccumulator().m_Counts[ counter ].fetch_add(
+    count, std::memory_order_relaxed );
+
+} // end AddCount()
+
+
+/**
+ * ********************* GetSnapshot ****************************
+ */
+
+HotPathProfiler::SnapshotType
+HotPathProfiler::GetSnapshot( void )
+{
+  SnapshotType snapshot;
+
+  std::lock_guard< std::mutex > lock( g_AccumulatorsMutex );
+  for( std::deque< ThreadAccumulatorType >::const_iterator it = g_Accumulators.begin();
+    it != g_Accumulators.end(); ++it )
+  {
+    for( unsigned int i = 0; i < NumberOfPhases; ++i )
+    {
+      snapshot.m_Seconds[ i ] += 1e-9 * static_cast< double >(
+        it->m_Nanoseconds[ i ].load( std::memory_order_relaxed ) );
+    }
+    for( unsigned int i = 0; i < NumberOfCounters; ++i )
+    {
+      snapshot.m_Counts[ i ] += it->m_Counts[ i ].load( std::memory_order_relaxed );
+    }
+  }
+
+  return snapshot;
+
+} // end GetSnapshot()
+
+
+/**
+ * ********************* GetPhaseName ****************************
+ */
+
+const char *
+HotPathProfiler::GetPhaseName( PhaseType phase )
+{
+  switch( phase )
+  {
+    case SamplerPhase:                return "Sampler";
+    case TransformJacobianPhase:      return "Jacobian";
+    case InterpolationPhase:          return "Interpolation";
+    case DerivativeAccumulationPhase: return "Accumulation";
+    case OptimizerUpdatePhase:        return "OptimizerUpdate";
+    case LoggingPhase:                return "Logging";
+    default:                          return "Unknown";
+  }
+
+} // end GetPhaseName()
+
+
+/**
+ * ********************* GetCounterName ****************************
+ */
+
+const char *
+HotPathProfiler::GetCounterName( CounterType counter )
+{
+  switch( counter )
+  {
+    case SamplesDrawnCounter:        return "SamplesDrawn";
+    case SamplesInsideMaskCounter:   return "SamplesInsideMask";
+    case JacobianEvaluationsCounter: return "JacobianEvaluations";
+    default:                         return "Unknown";
+  }
+
+} // end GetCounterName()
+
+
+} // end namespace itk
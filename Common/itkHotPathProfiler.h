@@ -0,0 +1,162 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkHotPathProfiler_h
+#define __itkHotPathProfiler_h
+
+#include <chrono>
+#include <cstdint>
+
+namespace itk
+{
+
+/**
+ * \class HotPathProfiler
+ * \brief Records the time spent in the phases of a registration
+ * iteration, and some counters.
+ *
+ * The profiler accumulates, per phase, the time measured by
+ * HotPathScopedTimer objects, and, per counter, the counts added with
+ * AddCount(). Every thread accumulates into its own cache lines, so
+ * instrumented code that runs multi-threaded does not contend. As a
+ * consequence, the time of a phase that runs in several threads is the
+ * summed thread time. GetSnapshot() returns the totals since the start
+ * of the program; the difference of two snapshots gives the totals of
+ * an interval, such as an iteration or a resolution.
+ *
+ * Instrumented code should use the elxProfileScope(), elxProfileScopeEnd()
+ * and elxProfileCount() macros. These expand to nothing, unless elastix
+ * is built with ELASTIX_USE_PROFILING.
+ *
+ * \ingroup Common
+ */
+
+class HotPathProfiler
+{
+public:
+
+  /** The instrumented phases. The TransformJacobianPhase includes the
+   * product with the image gradient, when a metric evaluates both at once
+   * (EvaluateJacobianWithImageGradientProduct). The OptimizerUpdatePhase
+   * is recorded by the optimizers that implement their own update step.
+   */
+  typedef enum {
+    SamplerPhase = 0,
+    TransformJacobianPhase,
+    InterpolationPhase,
+    DerivativeAccumulationPhase,
+    OptimizerUpdatePhase,
+    LoggingPhase,
+    NumberOfPhases
+  } PhaseType;
+
+  /** The counters. */
+  typedef enum {
+    SamplesDrawnCounter = 0,
+    SamplesInsideMaskCounter,
+    JacobianEvaluationsCounter,
+    NumberOfCounters
+  } CounterType;
+
+  /** The accumulated times (in seconds) and counts. */
+  struct SnapshotType
+  {
+    double        m_Seconds[ NumberOfPhases ];
+    std::uint64_t m_Counts[ NumberOfCounters ];
+
+    SnapshotType( void );
+    SnapshotType operator-( const SnapshotType & other ) const;
+  };
+
+  /** Add time to a phase of the calling thread. */
+  static void AddTime( PhaseType phase, std::uint64_t nanoseconds );
+
+  /** Add a count to a counter of the calling thread. */
+  static void AddCount( CounterType counter, std::uint64_t count );
+
+  /** Get the totals of all threads. */
+  static SnapshotType GetSnapshot( void );
+
+  /** Get the name of a phase or counter, as used in the log. */
+  static const char * GetPhaseName( PhaseType phase );
+
+  static const char * GetCounterName( CounterType counter );
+
+};
+
+/**
+ * \class HotPathScopedTimer
+ * \brief Adds the time between its construction and its destruction
+ * (or Stop()) to a phase of the HotPathProfiler.
+ */
+
+class HotPathScopedTimer
+{
+public:
+
+  typedef std::chrono::steady_clock ClockType;
+
+  explicit HotPathScopedTimer( HotPathProfiler::PhaseType phase ) :
+    m_Phase( phase ), m_Running( true ), m_Start( ClockType::now() )
+  {}
+
+  ~HotPathScopedTimer()
+  {
+    this->Stop();
+  }
+
+  /** Stop the timer before the end of the scope. */
+  void Stop( void )
+  {
+    if( this->m_Running )
+    {
+      this->m_Running = false;
+      const ClockType::duration elapsed = ClockType::now() - this->m_Start;
+      HotPathProfiler::AddTime( this->m_Phase, static_cast< std::uint64_t >(
+        std::chrono::duration_cast< std::chrono::nanoseconds >( elapsed ).count() ) );
+    }
+  }
+
+private:
+
+  HotPathScopedTimer( const HotPathScopedTimer & ); // purposely not implemented
+  void operator=( const HotPathScopedTimer & );     // purposely not implemented
+
+  HotPathProfiler::PhaseType m_Phase;
+  bool                       m_Running;
+  ClockType::time_point      m_Start;
+
+};
+
+} // end namespace itk
+
+/** Instrumentation macros. At most one elxProfileScope per block. */
+#ifdef ELASTIX_USE_PROFILING
+#define elxProfileScope( phase ) \
+  ::itk::HotPathScopedTimer elxProfileScopedTimer( ::itk::HotPathProfiler::phase )
+#define elxProfileScopeEnd() \
+  elxProfileScopedTimer.Stop()
+#define elxProfileCount( counter, count ) \
+  ::itk::HotPathProfiler::AddCount( ::itk::HotPathProfiler::counter, \
+    static_cast< std::uint64_t >( count ) )
+#else
+#define elxProfileScope( phase )
+#define elxProfileScopeEnd()
+#define elxProfileCount( counter, count )
+#endif
+
+#endif // end #ifndef __itkHotPathProfiler_h
@@ -0,0 +1,152 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkMemoryMappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace itk
+{
+
+/**
+ * ********************* Constructor ****************************
+ */
+
+MemoryMappedFile::MemoryMappedFile() :
+  m_Pointer( nullptr ),
+  m_Size( 0 )
+#ifdef _WIN32
+  , m_FileHandle( INVALID_HANDLE_VALUE ),
+  m_MappingHandle( nullptr )
+#endif
+{} // end Constructor
+
+
+/**
+ * ********************* Destructor *****************************
+ */
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+  this->Unmap();
+
+} // end Destructor
+
+
+/**
+ * ************************** Map *******************************
+ */
+
+bool
+MemoryMappedFile::Map( const std::string & fileName )
+{
+  this->Unmap();
+
+#ifdef _WIN32
+  HANDLE file = CreateFileA( fileName.c_str(), GENERIC_READ, FILE_SHARE_READ,
+    nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+  if( file == INVALID_HANDLE_VALUE )
+  {
+    return false;
+  }
+  LARGE_INTEGER size;
+  if( !GetFileSizeEx( file, &size ) || size.QuadPart == 0 )
+  {
+    CloseHandle( file );
+    return false;
+  }
+  HANDLE mapping = CreateFileMappingA( file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr );
+  void * pointer = mapping ? MapViewOfFile( mapping, FILE_MAP_COPY, 0, 0, 0 ) : nullptr;
+  if( pointer == nullptr )
+  {
+    if( mapping )
+    {
+      CloseHandle( mapping );
+    }
+    CloseHandle( file );
+    return false;
+  }
+  this->m_FileHandle    = file;
+  this->m_MappingHandle = mapping;
+  this->m_Pointer       = pointer;
+  this->m_Size          = static_cast< std::size_t >( size.QuadPart );
+#else
+  const int file = open( fileName.c_str(), O_RDONLY );
+  if( file < 0 )
+  {
+    return false;
+  }
+  struct stat status;
+  if( fstat( file, &status ) != 0 || status.st_size <= 0 )
+  {
+    close( file );
+    return false;
+  }
+  const std::size_t size = static_cast< std::size_t >( status.st_size );
+  void * pointer = mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0 );
+
+  /** The mapping keeps its own reference to the file. */
+  close( file );
+  if( pointer == MAP_FAILED )
+  {
+    return false;
+  }
+  this->m_Pointer = pointer;
+  this->m_Size    = size;
+#endif
+
+  return true;
+
+} // end Map()
+
+
+/**
+ * ************************* Unmap ******************************
+ */
+
+void
+MemoryMappedFile::Unmap( void )
+{
+  if( this->m_Pointer == nullptr )
+  {
+    return;
+  }
+
+#ifdef _WIN32
+  UnmapViewOfFile( this->m_Pointer );
+  CloseHandle( this->m_MappingHandle );
+  CloseHandle( this->m_FileHandle );
+  this->m_MappingHandle = nullptr;
+  this->m_FileHandle    = INVALID_HANDLE_VALUE;
+#else
+  munmap( this->m_Pointer, this->m_Size );
+#endif
+
+  this->m_Pointer = nullptr;
+  this->m_Size    = 0;
+
+} // end Unmap()
+
+
+} // end namespace itk
@@ -0,0 +1,84 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkMemoryMappedFile_h
+#define __itkMemoryMappedFile_h
+
+#include <cstddef>
+#include <string>
+
+namespace itk
+{
+
+/**
+ * \class MemoryMappedFile
+ * \brief Maps a file into memory.
+ *
+ * The file is mapped copy-on-write: the memory may be modified, but the
+ * modifications are not written to the file. Pages are read from the
+ * file when they are first accessed. The mapping stays valid until
+ * Unmap() is called, another file is mapped, or the object is destroyed.
+ *
+ * \ingroup Common
+ */
+
+class MemoryMappedFile
+{
+public:
+
+  MemoryMappedFile();
+  ~MemoryMappedFile();
+
+  /** Map the file. A previously mapped file is unmapped first. Returns
+   * false if the file could not be mapped, for example when it is empty. */
+  bool Map( const std::string & fileName );
+
+  /** Unmap the file, if any. */
+  void Unmap( void );
+
+  /** Get the address of the mapped file, or a null pointer. */
+  void * GetPointer( void ) const
+  {
+    return this->m_Pointer;
+  }
+
+
+  /** Get the size of the mapped file in bytes. */
+  std::size_t GetSize( void ) const
+  {
+    return this->m_Size;
+  }
+
+
+private:
+
+  MemoryMappedFile( const MemoryMappedFile & ); // purposely not implemented
+  void operator=( const MemoryMappedFile & );   // purposely not implemented
+
+  void *      m_Pointer;
+  std::size_t m_Size;
+
+#ifdef _WIN32
+  void * m_FileHandle;
+  void * m_MappingHandle;
+#endif
+
+};
+
+} // end namespace itk
+
+#endif // end #ifndef __itkMemoryMappedFile_h
@@ -71,11 +71,15 @@ namespace itk
  *               Uses mirror boundary conditions.
  *               Can only process LargestPossibleRegion
  *
+ * The recursive prefilter is applied along one dimension at a time. The
+ * scanlines along that dimension are independent, and are distributed over
+ * the threads, each thread using its own scratch buffer.
+ *
  * \sa itkBSplineInterpolateImageFunction
  *
  *  ***TODO: Is this an ImageFilter?  or does it belong to another group?
  * \ingroup ImageFilters
- * \ingroup SingleThreaded
+ * \ingroup MultiThreaded
  * \ingroup CannotBeStreamed
  */
 template< class TInputImage, class TOutputImage >
@@ -112,6 +116,9 @@ public:
   /** Iterator typedef support */
   typedef ImageLinearIteratorWithIndex< TOutputImage > OutputLinearIterator;
 
+  /** Typedef for the scratch buffer that holds one scanline. */
+  typedef std::vector< CoeffType > ScratchType;
+
   /** Get/Sets the Spline Order, supports 0th - 5th order splines. The default
    *  is a 3rd order spline. */
   void SetSplineOrder( unsigned int order );
@@ -153,7 +160,6 @@ protected:
   void EnlargeOutputRequestedRegion( DataObject * output ) override;
 
   /** These are needed by the smoothing spline routine. */
-  std::vector< CoeffType > m_Scratch;             // temp storage for processing of Coefficients
   typename TInputImage::SizeType m_DataLength;    // Image size
 
   unsigned int m_SplineOrder[ ImageDimension ];            // User specified spline order per dimension (3rd or cubic is the default)
@@ -171,26 +177,31 @@ private:
   virtual void SetPoles( unsigned int dimension );
 
   /** Converts a vector of data to a vector of Spline coefficients. */
-  virtual bool DataToCoefficients1D();
+  virtual bool DataToCoefficients1D( ScratchType & scratch ) const;
 
   /** Converts an N-dimension image of data to an equivalent sized image
    *    of spline coefficients. */
   void DataToCoefficientsND();
 
+  /** Converts all scanlines in the given region, along m_IteratorDirection.
+   * The region has size 1 in the iterator direction; it is called from
+   * multiple threads for disjoint regions. */
+  void DataToCoefficientsLines( const typename TOutputImage::RegionType & lineRegion );
+
   /** Determines the first coefficient for the causal filtering of the data. */
-  virtual void SetInitialCausalCoefficient( double z );
+  virtual void SetInitialCausalCoefficient( double z, ScratchType & scratch ) const;
 
   /** Determines the first coefficient for the anti-causal filtering of the data. */
-  virtual void SetInitialAntiCausalCoefficient( double z );
+  virtual void SetInitialAntiCausalCoefficient( double z, ScratchType & scratch ) const;
 
   /** Used to initialize the Coefficients image before calculation. */
   void CopyImageToImage();
 
-  /** Copies a vector of data from the Coefficients image to the m_Scratch vector. */
-  void CopyCoefficientsToScratch( OutputLinearIterator & );
+  /** Copies a vector of data from the Coefficients image to the scratch vector. */
+  void CopyCoefficientsToScratch( OutputLinearIterator &, ScratchType & scratch ) const;
 
-  /** Copies a vector of data from m_Scratch to the Coefficients image. */
-  void CopyScratchToCoefficients( OutputLinearIterator & );
+  /** Copies a vector of data from the scratch vector to the Coefficients image. */
+  void CopyScratchToCoefficients( OutputLinearIterator &, const ScratchType & scratch ) const;
 
 };
 
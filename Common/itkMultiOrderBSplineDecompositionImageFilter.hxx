@@ -38,9 +38,8 @@
 #define __itkMultiOrderBSplineDecompositionImageFilter_hxx
 
 #include "itkMultiOrderBSplineDecompositionImageFilter.h"
-#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionConstIterator.h"
 #include "itkImageRegionIterator.h"
-#include "itkProgressReporter.h"
 #include "itkVector.h"
 
 namespace itk
@@ -87,7 +86,7 @@ MultiOrderBSplineDecompositionImageFilter< TInputImage, TOutputImage >
 template< class TInputImage, class TOutputImage >
 bool
 MultiOrderBSplineDecompositionImageFilter< TInputImage, TOutputImage >
-::DataToCoefficients1D()
+::DataToCoefficients1D( ScratchType & scratch ) const
 {
 
   // See Unser, 1993, Part II, Equation 2.5,
@@ -95,7 +94,8 @@ MultiOrderBSplineDecompositionImageFilter< TInputImage, TOutputImage >
 
   double c0 = 1.0;
 
-  if( m_DataLength[ m_IteratorDirection ] == 1 ) //Required by mirror boundaries
+  const unsigned long dataLength = m_DataLength[ m_IteratorDirection ];
+  if( dataLength == 1 ) //Required by mirror boundaries
   {
     return false;
   }
@@ -108,28 +108,28 @@ MultiOrderBSplineDecompositionImageFilter< TInputImage, TOutputImage >
   }
 
   // apply the gain
-  for( unsigned int n = 0; n < m_DataLength[ m_IteratorDirection ]; n++ )
+  for( unsigned int n = 0; n < dataLength; n++ )
   {
-    m_Scratch[ n ] *= c0;
+    scratch[ n ] *= c0;
   }
 
   // loop over all poles
   for( int k = 0; k < m_NumberOfPoles; k++ )
   {
     // causal initialization
-    this->SetInitialCausalCoefficient( m_SplinePoles[ k ] );
+    this->SetInitialCausalCoefficient( m_SplinePoles[ k ], scratch );
     // causal recursion
-    for( unsigned int n = 1; n < m_DataLength[ m_IteratorDirection ]; n++ )
+    for( unsigned int n = 1; n < dataLength; n++ )
     {
-      m_Scratch[ n ] += m_SplinePoles[ k ] * m_Scratch[ n - 1 ];
+      scratch[ n ] += m_SplinePoles[ k ] * scratch[ n - 1 ];
     }
 
     // anticausal initialization
-    this->SetInitialAntiCausalCoefficient( m_SplinePoles[ k ] );
+    this->SetInitialAntiCausalCoefficient( m_SplinePoles[ k ], scratch );
     // anticausal recursion
-    for( int n = m_DataLength[ m_IteratorDirection ] - 2; 0 <= n; n-- )
+    for( int n = dataLength - 2; 0 <= n; n-- )
     {
-      m_Scratch[ n ] = m_SplinePoles[ k ] * ( m_Scratch[ n + 1 ] - m_Scratch[ n ] );
+      scratch[ n ] = m_SplinePoles[ k ] * ( scratch[ n + 1 ] - scratch[ n ] );
     }
   }
   return true;
@@ -225,7 +225,7 @@ MultiOrderBSplineDecompositionImageFilter< TInputImage, TOutputImage >
 template< class TInputImage, class TOutputImage >
 void
 MultiOrderBSplineDecompositionImageFilter< TInputImage, TOutputImage >
-::SetInitialCausalCoefficient( double z )
+::SetInitialCausalCoefficient( double z, ScratchType & scratch ) const
 {
   /* begining InitialCausalCoefficient */
   /* See Unser, 1999, Box 2 for explaination */
@@ -243,28 +243,28 @@ MultiOrderBSplineDecompositionImageFilter< TInputImage, TOutputImage >
   if( horizon < m_DataLength[ m_IteratorDirection ] )
   {
     /* accelerated loop */
-    sum = m_Scratch[ 0 ];   // verify this
+    sum = scratch[ 0 ];   // verify this
     for( unsigned int n = 1; n < horizon; n++ )
     {
-      sum += zn * m_Scratch[ n ];
+      sum += zn * scratch[ n ];
       zn  *= z;
     }
-    m_Scratch[ 0 ] = sum;
+    scratch[ 0 ] = sum;
   }
   else
   {
     /* full loop */
     iz   = 1.0 / z;
     z2n  = std::pow( z, (double)( m_DataLength[ m_IteratorDirection ] - 1L ) );
-    sum  = m_Scratch[ 0 ] + z2n * m_Scratch[ m_DataLength[ m_IteratorDirection ] - 1L ];
+    sum  = scratch[ 0 ] + z2n * scratch[ m_DataLength[ m_IteratorDirection ] - 1L ];
     z2n *= z2n * iz;
     for( unsigned int n = 1; n <= ( m_DataLength[ m_IteratorDirection ] - 2 ); n++ )
     {
-      sum += ( zn + z2n ) * m_Scratch[ n ];
+      sum += ( zn + z2n ) * scratch[ n ];
       zn  *= z;
       z2n *= iz;
     }
-    m_Scratch[ 0 ] = sum / ( 1.0 - zn * zn );
+    scratch[ 0 ] = sum / ( 1.0 - zn * zn );
   }
 }
 
@@ -272,14 +272,14 @@ MultiOrderBSplineDecompositionImageFilter< TInputImage, TOutputImage >
 template< class TInputImage, class TOutputImage >
 void
 MultiOrderBSplineDecompositionImageFilter< TInputImage, TOutputImage >
-::SetInitialAntiCausalCoefficient( double z )
+::SetInitialAntiCausalCoefficient( double z, ScratchType & scratch ) const
 {
   // this initialization corresponds to mirror boundaries
   /* See Unser, 1999, Box 2 for explaination */
   //  Also see erratum at http://bigwww.epfl.ch/publications/unser9902.html
-  m_Scratch[ m_DataLength[ m_IteratorDirection ] - 1 ]
+  scratch[ m_DataLength[ m_IteratorDirection ] - 1 ]
     = ( z / ( z * z - 1.0 ) )
-    * ( z * m_Scratch[ m_DataLength[ m_IteratorDirection ] - 2 ] + m_Scratch[ m_DataLength[ m_IteratorDirection ] - 1 ] );
+    * ( z * scratch[ m_DataLength[ m_IteratorDirection ] - 2 ] + scratch[ m_DataLength[ m_IteratorDirection ] - 1 ] );
 }
 
 
@@ -288,13 +288,9 @@ void
 MultiOrderBSplineDecompositionImageFilter< TInputImage, TOutputImage >
 ::DataToCoefficientsND()
 {
-  OutputImagePointer output = this->GetOutput();
-
-  Size< ImageDimension > size = output->GetBufferedRegion().GetSize();
+  typedef typename TOutputImage::RegionType OutputRegionType;
 
-  unsigned int count = output->GetBufferedRegion().GetNumberOfPixels() / size[ 0 ] * ImageDimension;
-
-  ProgressReporter progress( this, 0, count, 10 );
+  OutputImagePointer output = this->GetOutput();
 
   // Initialize coeffient array
   this->CopyImageToImage();   // Coefficients are initialized to the input data
@@ -307,68 +303,110 @@ MultiOrderBSplineDecompositionImageFilter< TInputImage, TOutputImage >
     // Compute poles for this dimension
     this->SetPoles( n );
 
-    // Initialize iterators
-    OutputLinearIterator CIterator( output, output->GetBufferedRegion() );
-    CIterator.SetDirection( m_IteratorDirection );
-    // For each data vector
-    while( !CIterator.IsAtEnd() )
-    {
-      // Copy coefficients to scratch
-      this->CopyCoefficientsToScratch( CIterator );
-
-      // Perform 1D BSpline calculations
-      this->DataToCoefficients1D();
-
-      // Copy scratch back to coefficients.
-      // Brings us back to the end of the line we were working on.
-      CIterator.GoToBeginOfLine();
-      this->CopyScratchToCoefficients( CIterator ); // m_Scratch = m_Image;
-      CIterator.NextLine();
-      progress.CompletedPixel();
-    }
+    // The scanlines along this dimension are independent. They are
+    // represented by a region that is collapsed in the iterator direction,
+    // which is split over the threads.
+    OutputRegionType lineRegion = output->GetBufferedRegion();
+    lineRegion.SetSize( n, 1 );
+
+    this->GetMultiThreader()->template ParallelizeImageRegion< ImageDimension >(
+      lineRegion,
+      [ this ]( const OutputRegionType & subRegion )
+      {
+        this->DataToCoefficientsLines( subRegion );
+      },
+      nullptr );
+
+    this->UpdateProgress( static_cast< float >( n + 1 ) / static_cast< float >( ImageDimension ) );
   }
 }
 
 
 /**
- * Copy the input image into the output image
+ * Convert all scanlines starting in the given region
  */
 template< class TInputImage, class TOutputImage >
 void
 MultiOrderBSplineDecompositionImageFilter< TInputImage, TOutputImage >
-::CopyImageToImage()
+::DataToCoefficientsLines( const typename TOutputImage::RegionType & lineRegion )
 {
-  typedef ImageRegionConstIteratorWithIndex< TInputImage > InputIterator;
-  typedef ImageRegionIterator< TOutputImage >              OutputIterator;
-  typedef typename TOutputImage::PixelType                 OutputPixelType;
+  // Expand the region to the full scanlines along the iterator direction
+  typename TOutputImage::RegionType region = lineRegion;
+  region.SetIndex( m_IteratorDirection,
+    this->GetOutput()->GetBufferedRegion().GetIndex( m_IteratorDirection ) );
+  region.SetSize( m_IteratorDirection, m_DataLength[ m_IteratorDirection ] );
+
+  // Each thread has its own scratch buffer
+  ScratchType scratch( m_DataLength[ m_IteratorDirection ] );
+
+  // Initialize iterators
+  OutputLinearIterator CIterator( this->GetOutput(), region );
+  CIterator.SetDirection( m_IteratorDirection );
+  // For each data vector
+  while( !CIterator.IsAtEnd() )
+  {
+    // Copy coefficients to scratch
+    this->CopyCoefficientsToScratch( CIterator, scratch );
 
-  InputIterator  inIt( this->GetInput(), this->GetInput()->GetBufferedRegion() );
-  OutputIterator outIt( this->GetOutput(), this->GetOutput()->GetBufferedRegion() );
+    // Perform 1D BSpline calculations
+    this->DataToCoefficients1D( scratch );
 
-  inIt.GoToBegin();
-  outIt.GoToBegin();
-  while( !outIt.IsAtEnd() )
-  {
-    outIt.Set( static_cast< OutputPixelType >( inIt.Get() ) );
-    ++inIt;
-    ++outIt;
+    // Copy scratch back to coefficients.
+    // Brings us back to the end of the line we were working on.
+    CIterator.GoToBeginOfLine();
+    this->CopyScratchToCoefficients( CIterator, scratch );
+    CIterator.NextLine();
   }
 }
 
 
+/**
+ * Copy the input image into the output image
+ */
+template< class TInputImage, class TOutputImage >
+void
+MultiOrderBSplineDecompositionImageFilter< TInputImage, TOutputImage >
+::CopyImageToImage()
+{
+  typedef ImageRegionConstIterator< TInputImage > InputIterator;
+  typedef ImageRegionIterator< TOutputImage >     OutputIterator;
+  typedef typename TOutputImage::PixelType        OutputPixelType;
+  typedef typename TOutputImage::RegionType       OutputRegionType;
+
+  const TInputImage * input  = this->GetInput();
+  TOutputImage *      output = this->GetOutput();
+
+  // Input and output buffered regions are equal
+  this->GetMultiThreader()->template ParallelizeImageRegion< ImageDimension >(
+    output->GetBufferedRegion(),
+    [ input, output ]( const OutputRegionType & subRegion )
+    {
+      InputIterator  inIt( input, subRegion );
+      OutputIterator outIt( output, subRegion );
+      while( !outIt.IsAtEnd() )
+      {
+        outIt.Set( static_cast< OutputPixelType >( inIt.Get() ) );
+        ++inIt;
+        ++outIt;
+      }
+    },
+    nullptr );
+}
+
+
 /**
  * Copy the scratch to one line of the output image
  */
 template< class TInputImage, class TOutputImage >
 void
 MultiOrderBSplineDecompositionImageFilter< TInputImage, TOutputImage >
-::CopyScratchToCoefficients( OutputLinearIterator & Iter )
+::CopyScratchToCoefficients( OutputLinearIterator & Iter, const ScratchType & scratch ) const
 {
   typedef typename TOutputImage::PixelType OutputPixelType;
   unsigned long j = 0;
   while( !Iter.IsAtEndOfLine() )
   {
-    Iter.Set( static_cast< OutputPixelType >( m_Scratch[ j ] ) );
+    Iter.Set( static_cast< OutputPixelType >( scratch[ j ] ) );
     ++Iter;
     ++j;
   }
@@ -382,12 +420,12 @@ MultiOrderBSplineDecompositionImageFilter< TInputImage, TOutputImage >
 template< class TInputImage, class TOutputImage >
 void
 MultiOrderBSplineDecompositionImageFilter< TInputImage, TOutputImage >
-::CopyCoefficientsToScratch( OutputLinearIterator & Iter )
+::CopyCoefficientsToScratch( OutputLinearIterator & Iter, ScratchType & scratch ) const
 {
   unsigned long j = 0;
   while( !Iter.IsAtEndOfLine() )
   {
-    m_Scratch[ j ] = static_cast< CoeffType >( Iter.Get() );
+    scratch[ j ] = static_cast< CoeffType >( Iter.Get() );
     ++Iter;
     ++j;
   }
@@ -443,31 +481,22 @@ MultiOrderBSplineDecompositionImageFilter< TInputImage, TOutputImage >
 ::GenerateData()
 {
 
-  // Allocate scratch memory
+  // The scratch memory is allocated per thread, per dimension
   InputImageConstPointer inputPtr = this->GetInput();
   m_DataLength = inputPtr->GetBufferedRegion().GetSize();
 
-  unsigned long maxLength = 0;
-  for( unsigned int n = 0; n < ImageDimension; n++ )
-  {
-    if( m_DataLength[ n ] > maxLength )
-    {
-      maxLength = m_DataLength[ n ];
-    }
-  }
-  m_Scratch.resize( maxLength );
-
   // Allocate memory for output image
   OutputImagePointer outputPtr = this->GetOutput();
   outputPtr->SetBufferedRegion( outputPtr->GetRequestedRegion() );
   outputPtr->Allocate();
 
+  // GenerateData is not called by the threader, so pass on the
+  // requested number of work units explicitly
+  this->GetMultiThreader()->SetNumberOfWorkUnits( this->GetNumberOfWorkUnits() );
+
   // Calculate actual output
   this->DataToCoefficientsND();
 
-  // Clean up
-  m_Scratch.clear();
-
 }
 
 
@@ -0,0 +1,207 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkParameterVectorOperations.h"
+
+#include <cmath>
+
+namespace itk
+{
+
+const std::size_t ParameterVectorOperations::BlockSize;
+const std::size_t ParameterVectorOperations::MinimumParallelSize;
+
+namespace
+{
+
+/** The inner product of x and y over [first, last). Four partial sums break
+ * the dependency chain of the additions, and allow vectorization. They add
+ * the products in a different order than a plain loop, but the order only
+ * depends on first and last, so not on the number of threads.
+ */
+inline double
+DotBlock( const double * x, const double * y, const std::size_t first, const std::size_t last )
+{
+  double      sum0 = 0.0;
+  double      sum1 = 0.0;
+  double      sum2 = 0.0;
+  double      sum3 = 0.0;
+  std::size_t i    = first;
+  for( ; i + 4 <= last; i += 4 )
+  {
+    sum0 += x[ i ] * y[ i ];
+    sum1 += x[ i + 1 ] * y[ i + 1 ];
+    sum2 += x[ i + 2 ] * y[ i + 2 ];
+    sum3 += x[ i + 3 ] * y[ i + 3 ];
+  }
+  for( ; i < last; ++i )
+  {
+    sum0 += x[ i ] * y[ i ];
+  }
+  return ( sum0 + sum1 ) + ( sum2 + sum3 );
+}
+
+} // end namespace
+
+
+/**
+ * ********************* Axpy ****************************
+ */
+
+void
+ParameterVectorOperations::Axpy( const double a, const VectorType & x, VectorType & y,
+  MultiThreaderBase * threader )
+{
+  const double * xp = x.data_block();
+  double *       yp = y.data_block();
+  ParallelFor( y.GetSize(), [ a, xp, yp ]( const std::size_t first, const std::size_t last )
+    {
+      for( std::size_t i = first; i < last; ++i )
+      {
+        yp[ i ] += a * xp[ i ];
+      }
+    }, threader );
+
+} // end Axpy()
+
+
+/**
+ * ********************* Scale ****************************
+ */
+
+void
+ParameterVectorOperations::Scale( const double a, VectorType & x, MultiThreaderBase * threader )
+{
+  double * xp = x.data_block();
+  ParallelFor( x.GetSize(), [ a, xp ]( const std::size_t first, const std::size_t last )
+    {
+      for( std::size_t i = first; i < last; ++i )
+      {
+        xp[ i ] *= a;
+      }
+    }, threader );
+
+} // end Scale()
+
+
+/**
+ * ********************* AddScaled ****************************
+ */
+
+void
+ParameterVectorOperations::AddScaled( const VectorType & x, const double a,
+  const VectorType & y, VectorType & z, MultiThreaderBase * threader )
+{
+  const double * xp = x.data_block();
+  const double * yp = y.data_block();
+  double *       zp = z.data_block();
+  ParallelFor( z.GetSize(), [ xp, a, yp, zp ]( const std::size_t first, const std::size_t last )
+    {
+      for( std::size_t i = first; i < last; ++i )
+      {
+        zp[ i ] = xp[ i ] + a * yp[ i ];
+      }
+    }, threader );
+
+} // end AddScaled()
+
+
+/**
+ * ********************* Multiply ****************************
+ */
+
+void
+ParameterVectorOperations::Multiply( const VectorType & x, VectorType & y,
+  MultiThreaderBase * threader )
+{
+  const double * xp = x.data_block();
+  double *       yp = y.data_block();
+  ParallelFor( y.GetSize(), [ xp, yp ]( const std::size_t first, const std::size_t last )
+    {
+      for( std::size_t i = first; i < last; ++i )
+      {
+        yp[ i ] *= xp[ i ];
+      }
+    }, threader );
+
+} // end Multiply()
+
+
+/**
+ * ********************* Divide ****************************
+ */
+
+void
+ParameterVectorOperations::Divide( const VectorType & x, VectorType & y,
+  MultiThreaderBase * threader )
+{
+  const double * xp = x.data_block();
+  double *       yp = y.data_block();
+  ParallelFor( y.GetSize(), [ xp, yp ]( const std::size_t first, const std::size_t last )
+    {
+      for( std::size_t i = first; i < last; ++i )
+      {
+        yp[ i ] /= xp[ i ];
+      }
+    }, threader );
+
+} // end Divide()
+
+
+/**
+ * ********************* Dot ****************************
+ */
+
+double
+ParameterVectorOperations::Dot( const VectorType & x, const VectorType & y,
+  MultiThreaderBase * threader )
+{
+  const double * xp = x.data_block();
+  const double * yp = y.data_block();
+  return ParallelSum( x.GetSize(), [ xp, yp ]( const std::size_t first, const std::size_t last )
+    {
+      return DotBlock( xp, yp, first, last );
+    }, threader );
+
+} // end Dot()
+
+
+/**
+ * ********************* SquaredNorm ****************************
+ */
+
+double
+ParameterVectorOperations::SquaredNorm( const VectorType & x, MultiThreaderBase * threader )
+{
+  return Dot( x, x, threader );
+
+} // end SquaredNorm()
+
+
+/**
+ * ********************* Norm ****************************
+ */
+
+double
+ParameterVectorOperations::Norm( const VectorType & x, MultiThreaderBase * threader )
+{
+  return std::sqrt( Dot( x, x, threader ) );
+
+} // end Norm()
+
+
+} // end namespace itk
@@ -0,0 +1,160 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkParameterVectorOperations_h
+#define __itkParameterVectorOperations_h
+
+#include "itkArray.h"
+#include "itkMultiThreaderBase.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace itk
+{
+
+/**
+ * \class ParameterVectorOperations
+ * \brief Vector operations on parameter and derivative vectors, for the optimizers.
+ *
+ * The optimizers do a few vector operations on the parameters and the
+ * gradient every iteration. With B-spline transforms of millions of
+ * parameters, these should not become noticeable compared to the metric.
+ *
+ * The vectors are processed in blocks of BlockSize elements. Vectors of at
+ * least MinimumParallelSize elements are divided over the work units of the
+ * threader that is passed, which is typically owned by the optimizer. Without
+ * a threader, the operations are single-threaded. The loops are simple
+ * enough to be vectorized by the compiler. The sums are computed per block,
+ * and then added in a fixed order, so that the results do not depend on the
+ * number of threads.
+ *
+ * All vectors of one operation should have the same size. The output
+ * vector may be one of the input vectors.
+ *
+ * \ingroup Common
+ */
+
+class ParameterVectorOperations
+{
+public:
+
+  typedef Array< double > VectorType;
+
+  /** The number of elements per block. */
+  static const std::size_t BlockSize = 8192;
+
+  /** The minimum number of elements to use multi-threading for. */
+  static const std::size_t MinimumParallelSize = 131072;
+
+  /** y = y + a * x */
+  static void Axpy( const double a, const VectorType & x, VectorType & y,
+    MultiThreaderBase * threader = nullptr );
+
+  /** x = a * x */
+  static void Scale( const double a, VectorType & x, MultiThreaderBase * threader = nullptr );
+
+  /** z = x + a * y, for example newPosition = currentPosition - learningRate * gradient. */
+  static void AddScaled( const VectorType & x, const double a, const VectorType & y, VectorType & z,
+    MultiThreaderBase * threader = nullptr );
+
+  /** y = x .* y, elementwise. */
+  static void Multiply( const VectorType & x, VectorType & y, MultiThreaderBase * threader = nullptr );
+
+  /** y = y ./ x, elementwise. */
+  static void Divide( const VectorType & x, VectorType & y, MultiThreaderBase * threader = nullptr );
+
+  /** Returns the inner product of x and y. */
+  static double Dot( const VectorType & x, const VectorType & y, MultiThreaderBase * threader = nullptr );
+
+  /** Returns the squared magnitude of x. */
+  static double SquaredNorm( const VectorType & x, MultiThreaderBase * threader = nullptr );
+
+  /** Returns the magnitude of x. */
+  static double Norm( const VectorType & x, MultiThreaderBase * threader = nullptr );
+
+  /** Call function( first, last ) for consecutive ranges of [0, size),
+   * that start at a multiple of BlockSize, in parallel on the work units of
+   * the threader, if any. Use it for fused operations that have no named
+   * function above.
+   */
+  template< class TFunction >
+  static void ParallelFor( const std::size_t size, const TFunction & function,
+    MultiThreaderBase * threader )
+  {
+    if( threader == nullptr || size < MinimumParallelSize )
+    {
+      function( 0, size );
+      return;
+    }
+
+    const std::size_t numberOfBlocks = ( size + BlockSize - 1 ) / BlockSize;
+    const std::size_t numberOfChunks = std::min< std::size_t >(
+      threader->GetNumberOfWorkUnits(), numberOfBlocks );
+    threader->ParallelizeArray( 0, numberOfChunks,
+      [ &function, size, numberOfBlocks, numberOfChunks ]( SizeValueType chunk )
+      {
+        const std::size_t first = chunk * numberOfBlocks / numberOfChunks * BlockSize;
+        const std::size_t last  = std::min( size, ( chunk + 1 ) * numberOfBlocks / numberOfChunks * BlockSize );
+        function( first, last );
+      },
+      nullptr );
+  }
+
+
+  /** Returns the sum of function( first, last ) over the blocks of [0, size),
+   * computed as by ParallelFor(), and added in order.
+   */
+  template< class TFunction >
+  static double ParallelSum( const std::size_t size, const TFunction & function,
+    MultiThreaderBase * threader )
+  {
+    if( size <= BlockSize )
+    {
+      return function( 0, size );
+    }
+
+    std::vector< double > blockSums( ( size + BlockSize - 1 ) / BlockSize );
+    ParallelFor( size, [ &function, &blockSums ]( const std::size_t first, const std::size_t last )
+      {
+        for( std::size_t block = first; block < last; block += BlockSize )
+        {
+          blockSums[ block / BlockSize ] = function( block, std::min( block + BlockSize, last ) );
+        }
+      }, threader );
+
+    double sum = 0.0;
+    for( std::size_t b = 0; b < blockSums.size(); ++b )
+    {
+      sum += blockSums[ b ];
+    }
+    return sum;
+  }
+
+
+private:
+
+  ParameterVectorOperations();                                      // purposely not implemented
+  ParameterVectorOperations( const ParameterVectorOperations & );   // purposely not implemented
+  void operator=( const ParameterVectorOperations & );              // purposely not implemented
+
+};
+
+} // end namespace itk
+
+#endif // end #ifndef __itkParameterVectorOperations_h
@@ -33,6 +33,9 @@ ScaledSingleValuedNonLinearOptimizer
   this->m_Maximize           = false;
   this->m_ScaledCostFunction = ScaledCostFunctionType::New();
 
+  this->m_CostFunctionEvaluator = ConcurrentCostFunctionEvaluator::New();
+  this->m_CostFunctionEvaluator->SetCostFunction( this->m_ScaledCostFunction );
+
 } // end Constructor
 
 
@@ -48,6 +51,10 @@ ScaledSingleValuedNonLinearOptimizer
    * as squared scales (following the ITK convention)!
    */
   this->m_ScaledCostFunction->SetSquaredScales( this->GetScales() );
+  for( unsigned int i = 0; i < this->m_ScaledCostFunctionContexts.size(); ++i )
+  {
+    this->m_ScaledCostFunctionContexts[ i ]->SetSquaredScales( this->GetScales() );
+  }
   this->Modified();
 
 } // end InitializeScales()
@@ -76,6 +83,10 @@ ScaledSingleValuedNonLinearOptimizer
 ::SetUseScales( bool arg )
 {
   this->m_ScaledCostFunction->SetUseScales( arg );
+  for( unsigned int i = 0; i < this->m_ScaledCostFunctionContexts.size(); ++i )
+  {
+    this->m_ScaledCostFunctionContexts[ i ]->SetUseScales( arg );
+  }
   this->Modified();
 
 } // end SetUseScales()
@@ -226,11 +237,92 @@ ScaledSingleValuedNonLinearOptimizer
   {
     this->m_Maximize = _arg;
     this->m_ScaledCostFunction->SetNegateCostFunction( _arg );
+    for( unsigned int i = 0; i < this->m_ScaledCostFunctionContexts.size(); ++i )
+    {
+      this->m_ScaledCostFunctionContexts[ i ]->SetNegateCostFunction( _arg );
+    }
     this->Modified();
   }
 }  // end SetMaximize()
 
 
+/**
+ * ******************** AddCostFunctionContext *******************************
+ */
+
+void
+ScaledSingleValuedNonLinearOptimizer
+::AddCostFunctionContext( CostFunctionType * costFunction )
+{
+  if( costFunction == nullptr )
+  {
+    itkExceptionMacro( << "Cannot add a null cost function context." );
+  }
+
+  /** Wrap the context in a scaled cost function with the same settings. */
+  ScaledCostFunctionPointer context = ScaledCostFunctionType::New();
+  context->SetUnscaledCostFunction( costFunction );
+  context->SetUseScales( this->m_ScaledCostFunction->GetUseScales() );
+  context->SetSquaredScales( this->m_ScaledCostFunction->GetSquaredScales() );
+  context->SetNegateCostFunction( this->m_Maximize );
+
+  this->m_ScaledCostFunctionContexts.push_back( context );
+  this->m_CostFunctionEvaluator->AddContext( context );
+  this->Modified();
+
+}  // end AddCostFunctionContext()
+
+
+/**
+ * ******************** RemoveCostFunctionContexts *******************************
+ */
+
+void
+ScaledSingleValuedNonLinearOptimizer
+::RemoveCostFunctionContexts( void )
+{
+  if( !this->m_ScaledCostFunctionContexts.empty() )
+  {
+    this->m_ScaledCostFunctionContexts.clear();
+    this->m_CostFunctionEvaluator->RemoveContexts();
+    this->Modified();
+  }
+
+}  // end RemoveCostFunctionContexts()
+
+
+/**
+ * ********************* GetScaledValues *****************************
+ */
+
+void
+ScaledSingleValuedNonLinearOptimizer
+::GetScaledValues(
+  const ParametersListType & parameters,
+  MeasureListType & values,
+  EvaluationStatusListType & succeeded,
+  ExceptionListType & errors ) const
+{
+  this->m_CostFunctionEvaluator->GetValues( parameters, values, succeeded, errors );
+
+} // end GetScaledValues()
+
+
+/**
+ * ********************* GetScaledValues *****************************
+ */
+
+void
+ScaledSingleValuedNonLinearOptimizer
+::GetScaledValues(
+  const ParametersListType & parameters,
+  MeasureListType & values ) const
+{
+  this->m_CostFunctionEvaluator->GetValues( parameters, values );
+
+} // end GetScaledValues()
+
+
 /**
  * ******************** PrintSelf *******************************
  */
@@ -250,6 +342,8 @@ ScaledSingleValuedNonLinearOptimizer
      << this->m_ScaledCostFunction.GetPointer() << std::endl;
   os << indent << "Maximize: "
      << ( this->m_Maximize ? "true" : "false" ) << std::endl;
+  os << indent << "NumberOfCostFunctionContexts: "
+     << this->m_ScaledCostFunctionContexts.size() << std::endl;
 
 } // end PrintSelf()
 
@@ -20,6 +20,8 @@
 
 #include "itkSingleValuedNonLinearOptimizer.h"
 #include "itkScaledSingleValuedCostFunction.h"
+#include "itkConcurrentCostFunctionEvaluator.h"
+#include <vector>
 
 namespace itk
 {
@@ -57,6 +59,15 @@ namespace itk
  * So, if you want a scaling s, you must call SetScales(\f$s.*s\f$) (where .*
  * symbolises the element-wise product of \f$s\f$ with \f$s\f$)
  *
+ * Optimizers that need many independent function values per iteration
+ * (population based or derivative free methods) may use GetScaledValues()
+ * to evaluate a batch of positions. By default the batch is evaluated
+ * sequentially with the cost function. When additional cost function
+ * contexts are added with AddCostFunctionContext(), the batch is evaluated
+ * concurrently by a ConcurrentCostFunctionEvaluator. Every context is
+ * wrapped in its own scaled cost function, sharing the scales and the
+ * maximize flag of the main one.
+ *
  */
 
 class ScaledSingleValuedNonLinearOptimizer :
@@ -87,6 +98,13 @@ public:
   typedef ScaledSingleValuedCostFunction  ScaledCostFunctionType;
   typedef ScaledCostFunctionType::Pointer ScaledCostFunctionPointer;
 
+  /** Typedefs for the batched evaluation of the cost function. */
+  typedef std::vector< ParametersType >            ParametersListType;
+  typedef std::vector< MeasureType >               MeasureListType;
+  typedef std::vector< unsigned char >             EvaluationStatusListType;
+  typedef std::vector< ExceptionObject >           ExceptionListType;
+  typedef std::vector< ScaledCostFunctionPointer > ScaledCostFunctionContainerType;
+
   /** Configure the scaled cost function. This function
    * sets the current scales in the ScaledCostFunction.
    * NB: it assumes that the scales entered by the user
@@ -126,6 +144,20 @@ public:
 
   itkGetConstMacro( Maximize, bool );
 
+  /** Add an independent cost function context that may be evaluated
+   * concurrently with the main cost function in GetScaledValues().
+   * The context must compute the same function as the main cost function
+   * and must not share mutable state with it.
+   */
+  virtual void AddCostFunctionContext( CostFunctionType * costFunction );
+
+  /** Remove all additional cost function contexts. */
+  virtual void RemoveCostFunctionContexts( void );
+
+  /** Get the number of additional cost function contexts. */
+  unsigned int GetNumberOfCostFunctionContexts( void ) const
+  { return static_cast< unsigned int >( this->m_ScaledCostFunctionContexts.size() ); }
+
 protected:
 
   /** The constructor. */
@@ -176,6 +208,23 @@ protected:
     MeasureType & value,
     DerivativeType & derivative ) const;
 
+  /** Evaluate the scaled cost function for a batch of (scaled) positions.
+   * Evaluations that throw an exception are marked with a zero in
+   * succeeded, and their exception is stored in errors; the other values
+   * are stored in values. The batch is evaluated concurrently when cost
+   * function contexts are available, see ConcurrentCostFunctionEvaluator.
+   */
+  virtual void GetScaledValues(
+    const ParametersListType & parameters,
+    MeasureListType & values,
+    EvaluationStatusListType & succeeded,
+    ExceptionListType & errors ) const;
+
+  /** Idem, but passes the exception of the first failed position to the caller. */
+  virtual void GetScaledValues(
+    const ParametersListType & parameters,
+    MeasureListType & values ) const;
+
 private:
 
   /** The private constructor. */
@@ -190,6 +239,12 @@ private:
   mutable ParametersType m_UnscaledCurrentPosition;
   bool                   m_Maximize;
 
+  /** The additional scaled cost functions, one per context. */
+  ScaledCostFunctionContainerType m_ScaledCostFunctionContexts;
+
+  /** Evaluates the batches on the scaled cost function and its contexts. */
+  ConcurrentCostFunctionEvaluator::Pointer m_CostFunctionEvaluator;
+
 };
 
 } // end namespace itk
@@ -0,0 +1,179 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkScanlineResampleImageFilter_h
+#define __itkScanlineResampleImageFilter_h
+
+#include "itkResampleImageFilter.h"
+#include "itkAdvancedBSplineDeformableTransformBase.h"
+
+namespace itk
+{
+
+/** \class ScanlineResampleImageFilter
+ * \brief Resample an image, stepping along the output scanlines by
+ * constant increments where the transform allows it.
+ *
+ * The generic itk::ResampleImageFilter calls the transform and the
+ * conversion to a continuous input index for every output voxel. This
+ * filter inspects the transform before resampling, and distinguishes:
+ * \li Linear transforms (matrix-offset transforms, or combinations of
+ *   them). The continuous input index is an affine function of the
+ *   output index, and is stepped along each scanline.
+ * \li B-spline transforms, optionally combined with a linear initial
+ *   transform, by composition or addition. If the B-spline grid is
+ *   aligned with the output scanlines, the B-spline weights in the other
+ *   dimensions are constant along a scanline. The coefficients are then
+ *   contracted with these weights once per scanline, after which every
+ *   voxel only needs the weights along the scanline.
+ * \li Other transforms, or a B-spline grid that is not aligned with the
+ *   output scanlines, are resampled by the superclass.
+ *
+ * The output is divided in slabs over the threads.
+ *
+ * \sa ResampleImageFilter
+ * \ingroup GeometricTransform
+ */
+
+template< typename TInputImage, typename TOutputImage,
+typename TInterpolatorPrecisionType = double >
+class ScanlineResampleImageFilter :
+  public ResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType >
+{
+public:
+
+  /** Standard class typedefs. */
+  typedef ScanlineResampleImageFilter Self;
+  typedef ResampleImageFilter<
+    TInputImage, TOutputImage, TInterpolatorPrecisionType > Superclass;
+  typedef SmartPointer< Self >       Pointer;
+  typedef SmartPointer< const Self > ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( ScanlineResampleImageFilter, ResampleImageFilter );
+
+  /** Dimension of the images. */
+  itkStaticConstMacro( ImageDimension, unsigned int, TOutputImage::ImageDimension );
+
+  /** Typedefs from the superclass. */
+  typedef typename Superclass::InputImageType        InputImageType;
+  typedef typename Superclass::OutputImageType       OutputImageType;
+  typedef typename Superclass::OutputImageRegionType OutputImageRegionType;
+  typedef typename Superclass::TransformType         TransformType;
+  typedef typename Superclass::InterpolatorType      InterpolatorType;
+  typedef typename Superclass::IndexType             IndexType;
+  typedef typename Superclass::PointType             PointType;
+  typedef typename Superclass::PixelType             PixelType;
+
+  /** Typedefs for the transforms that are recognized. */
+  typedef AdvancedBSplineDeformableTransformBase<
+    TInterpolatorPrecisionType,
+    itkGetStaticConstMacro( ImageDimension ) >        BSplineTransformBaseType;
+
+  /** Affine maps, from an output index to another space. */
+  typedef Matrix< double,
+    itkGetStaticConstMacro( ImageDimension ),
+    itkGetStaticConstMacro( ImageDimension ) >        AffineMatrixType;
+  typedef Vector< double,
+    itkGetStaticConstMacro( ImageDimension ) >        AffineVectorType;
+
+  /** Ways in which the output can be resampled. */
+  typedef enum {
+    GenericResampling,
+    LinearResampling,
+    BSplineResampling
+  } ResamplingMethodType;
+
+  /** Get the way in which the last output was resampled. */
+  itkGetConstMacro( ResamplingMethod, ResamplingMethodType );
+
+protected:
+
+  /** The constructor. */
+  ScanlineResampleImageFilter();
+
+  /** The destructor. */
+  ~ScanlineResampleImageFilter() override {}
+
+  /** Inspect the transform, and set up the affine maps. */
+  void BeforeThreadedGenerateData( void ) override;
+
+  /** Resample a slab of the output. */
+  void DynamicThreadedGenerateData( const OutputImageRegionType & outputRegionForThread ) override;
+
+  /** Resample a slab for a linear transform. */
+  void LinearScanlineGenerateData( const OutputImageRegionType & outputRegionForThread ) const;
+
+  /** Resample a slab for a B-spline transform of the given order. */
+  template< unsigned int VSplineOrder >
+  void BSplineScanlineGenerateData( const OutputImageRegionType & outputRegionForThread ) const;
+
+  /** Interpolate the input at a continuous index, and cast to the output pixel type. */
+  PixelType InterpolateAtContinuousIndex( const InterpolatorType * interpolator,
+    const double * cindex ) const;
+
+  /** Print the object. */
+  void PrintSelf( std::ostream & os, Indent indent ) const override;
+
+private:
+
+  /** The private constructor. */
+  ScanlineResampleImageFilter( const Self & ); // purposely not implemented
+  /** The private copy constructor. */
+  void operator=( const Self & );              // purposely not implemented
+
+  /** Determine the affine map of an output index, by evaluating at a
+   * start index and at its neighbours in each dimension.
+   */
+  template< typename TFunction >
+  static void ComputeAffineMap( const TFunction & function, const IndexType & startIndex,
+    AffineMatrixType & matrix, AffineVectorType & offset );
+
+  ResamplingMethodType m_ResamplingMethod;
+
+  /** Output index to the point that the displacement is added to. For linear
+   * transforms this is the transformed point.
+   */
+  AffineMatrixType m_IndexToBasePointMatrix;
+  AffineVectorType m_IndexToBasePointOffset;
+
+  /** Physical point to continuous index of the input image. */
+  AffineMatrixType m_PointToInputIndexMatrix;
+  AffineVectorType m_PointToInputIndexOffset;
+
+  /** Output index to continuous index of the B-spline grid. */
+  AffineMatrixType m_IndexToGridIndexMatrix;
+  AffineVectorType m_IndexToGridIndexOffset;
+
+  /** The B-spline transform and its valid region, in grid indices. */
+  const BSplineTransformBaseType * m_BSplineTransform;
+  unsigned int                     m_BSplineOrder;
+  AffineVectorType                 m_ValidGridIndexBegin;
+  AffineVectorType                 m_ValidGridIndexEnd;
+
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkScanlineResampleImageFilter.hxx"
+#endif
+
+#endif // end #ifndef __itkScanlineResampleImageFilter_h
@@ -0,0 +1,592 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkScanlineResampleImageFilter_hxx
+#define __itkScanlineResampleImageFilter_hxx
+
+#include "itkScanlineResampleImageFilter.h"
+
+#include "itkAdvancedBSplineDeformableTransform.h"
+#include "itkAdvancedCombinationTransform.h"
+#include "itkBSplineKernelFunction2.h"
+#include "itkImageScanlineIterator.h"
+
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace itk
+{
+
+/**
+ * ******************* Constructor ***********************
+ */
+
+template< typename TInputImage, typename TOutputImage, typename TInterpolatorPrecisionType >
+ScanlineResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType >
+::ScanlineResampleImageFilter()
+{
+  this->m_ResamplingMethod = GenericResampling;
+  this->m_BSplineTransform = nullptr;
+  this->m_BSplineOrder     = 0;
+
+  this->m_IndexToBasePointMatrix.Fill( 0.0 );
+  this->m_IndexToBasePointOffset.Fill( 0.0 );
+  this->m_PointToInputIndexMatrix.Fill( 0.0 );
+  this->m_PointToInputIndexOffset.Fill( 0.0 );
+  this->m_IndexToGridIndexMatrix.Fill( 0.0 );
+  this->m_IndexToGridIndexOffset.Fill( 0.0 );
+  this->m_ValidGridIndexBegin.Fill( 0.0 );
+  this->m_ValidGridIndexEnd.Fill( 0.0 );
+
+} // end Constructor
+
+
+/**
+ * ******************* ComputeAffineMap ***********************
+ */
+
+template< typename TInputImage, typename TOutputImage, typename TInterpolatorPrecisionType >
+template< typename TFunction >
+void
+ScanlineResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType >
+::ComputeAffineMap( const TFunction & function, const IndexType & startIndex,
+  AffineMatrixType & matrix, AffineVectorType & offset )
+{
+  const auto p0 = function( startIndex );
+  for( unsigned int k = 0; k < ImageDimension; ++k )
+  {
+    IndexType index = startIndex;
+    ++index[ k ];
+    const auto p = function( index );
+    for( unsigned int i = 0; i < ImageDimension; ++i )
+    {
+      matrix[ i ][ k ] = p[ i ] - p0[ i ];
+    }
+  }
+
+  for( unsigned int i = 0; i < ImageDimension; ++i )
+  {
+    offset[ i ] = p0[ i ];
+    for( unsigned int k = 0; k < ImageDimension; ++k )
+    {
+      offset[ i ] -= matrix[ i ][ k ] * startIndex[ k ];
+    }
+  }
+
+} // end ComputeAffineMap()
+
+
+/**
+ * ******************* BeforeThreadedGenerateData ***********************
+ */
+
+template< typename TInputImage, typename TOutputImage, typename TInterpolatorPrecisionType >
+void
+ScanlineResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType >
+::BeforeThreadedGenerateData( void )
+{
+  this->Superclass::BeforeThreadedGenerateData();
+
+  this->m_ResamplingMethod = GenericResampling;
+  this->m_BSplineTransform = nullptr;
+  this->m_BSplineOrder     = 0;
+
+  /** The scanline resampling is only done for scalar images without extrapolator. */
+  const TransformType *  transform = this->GetTransform();
+  const InputImageType * inputPtr  = this->GetInput();
+  OutputImageType *      outputPtr = this->GetOutput();
+  if( transform == nullptr || this->GetExtrapolator() != nullptr
+    || !std::is_arithmetic< PixelType >::value )
+  {
+    return;
+  }
+
+  /** Physical point to continuous index of the input image. */
+  typename InputImageType::DirectionType inputScale;
+  inputScale.Fill( 0.0 );
+  for( unsigned int i = 0; i < ImageDimension; ++i )
+  {
+    inputScale[ i ][ i ] = inputPtr->GetSpacing()[ i ];
+  }
+  this->m_PointToInputIndexMatrix = AffineMatrixType(
+    ( inputPtr->GetDirection() * inputScale ).GetInverse() );
+  this->m_PointToInputIndexOffset = -( this->m_PointToInputIndexMatrix
+    * inputPtr->GetOrigin().GetVectorFromOrigin() );
+
+  /** The affine maps are evaluated around the start of the requested region. */
+  const IndexType startIndex   = outputPtr->GetRequestedRegion().GetIndex();
+  const auto      indexToPoint = [ outputPtr ]( const IndexType & index )
+    {
+      PointType point;
+      outputPtr->TransformIndexToPhysicalPoint( index, point );
+      return point;
+    };
+
+  /** Linear transforms: the transformed point is an affine function of the index. */
+  if( transform->IsLinear() )
+  {
+    ComputeAffineMap( [ transform, &indexToPoint ]( const IndexType & index )
+      {
+        return transform->TransformPoint( indexToPoint( index ) );
+      },
+      startIndex, this->m_IndexToBasePointMatrix, this->m_IndexToBasePointOffset );
+
+    this->m_ResamplingMethod = LinearResampling;
+    return;
+  }
+
+  /** Split a combination transform in a linear initial and a B-spline current transform. */
+  typedef AdvancedCombinationTransform<
+    TInterpolatorPrecisionType, ImageDimension >      CombinationTransformType;
+  const TransformType *            currentTransform = transform;
+  const TransformType *            initialTransform = nullptr;
+  bool                             useAddition      = false;
+  const CombinationTransformType * combinationTransform
+    = dynamic_cast< const CombinationTransformType * >( transform );
+  if( combinationTransform != nullptr )
+  {
+    currentTransform = combinationTransform->GetCurrentTransform();
+    initialTransform = combinationTransform->GetInitialTransform();
+    useAddition      = combinationTransform->GetUseAddition();
+  }
+  if( currentTransform == nullptr
+    || ( initialTransform != nullptr && !initialTransform->IsLinear() ) )
+  {
+    return;
+  }
+
+  /** Only the plain B-spline transforms; derived transforms like the cyclic
+   * B-spline transform evaluate differently.
+   */
+  const BSplineTransformBaseType * bsplineTransform
+    = dynamic_cast< const BSplineTransformBaseType * >( currentTransform );
+  if( bsplineTransform == nullptr || bsplineTransform->GetCoefficientImages()[ 0 ].IsNull()
+    || ( strcmp( bsplineTransform->GetNameOfClass(), "AdvancedBSplineDeformableTransform" ) != 0
+    && strcmp( bsplineTransform->GetNameOfClass(), "RecursiveBSplineTransform" ) != 0 ) )
+  {
+    return;
+  }
+  unsigned int splineOrder = 0;
+  if( dynamic_cast< const AdvancedBSplineDeformableTransform<
+    TInterpolatorPrecisionType, ImageDimension, 1 > * >( bsplineTransform ) != nullptr )
+  {
+    splineOrder = 1;
+  }
+  else if( dynamic_cast< const AdvancedBSplineDeformableTransform<
+    TInterpolatorPrecisionType, ImageDimension, 2 > * >( bsplineTransform ) != nullptr )
+  {
+    splineOrder = 2;
+  }
+  else if( dynamic_cast< const AdvancedBSplineDeformableTransform<
+    TInterpolatorPrecisionType, ImageDimension, 3 > * >( bsplineTransform ) != nullptr )
+  {
+    splineOrder = 3;
+  }
+  else
+  {
+    return;
+  }
+
+  /** The displacement is added to the initially transformed point. With
+   * composition the B-spline is evaluated at this point as well, with
+   * addition at the output point itself.
+   */
+  AffineMatrixType pointMatrix;
+  AffineVectorType pointOffset;
+  ComputeAffineMap( indexToPoint, startIndex, pointMatrix, pointOffset );
+  if( initialTransform != nullptr )
+  {
+    ComputeAffineMap( [ initialTransform, &indexToPoint ]( const IndexType & index )
+      {
+        return initialTransform->TransformPoint( indexToPoint( index ) );
+      },
+      startIndex, this->m_IndexToBasePointMatrix, this->m_IndexToBasePointOffset );
+  }
+  else
+  {
+    this->m_IndexToBasePointMatrix = pointMatrix;
+    this->m_IndexToBasePointOffset = pointOffset;
+  }
+  if( !useAddition )
+  {
+    pointMatrix = this->m_IndexToBasePointMatrix;
+    pointOffset = this->m_IndexToBasePointOffset;
+  }
+
+  /** Physical point to continuous grid index, as in the B-spline transform. */
+  typename BSplineTransformBaseType::DirectionType gridScale;
+  gridScale.Fill( 0.0 );
+  for( unsigned int i = 0; i < ImageDimension; ++i )
+  {
+    gridScale[ i ][ i ] = bsplineTransform->GetGridSpacing()[ i ];
+  }
+  const AffineMatrixType pointToGridIndex(
+    ( bsplineTransform->GetGridDirection() * gridScale ).GetInverse() );
+  this->m_IndexToGridIndexMatrix = pointToGridIndex * pointMatrix;
+  this->m_IndexToGridIndexOffset = pointToGridIndex
+    * ( pointOffset - bsplineTransform->GetGridOrigin().GetVectorFromOrigin() );
+
+  /** The weights in the other dimensions are only constant along a scanline
+   * if the grid is aligned with it.
+   */
+  const double step = std::abs( this->m_IndexToGridIndexMatrix[ 0 ][ 0 ] );
+  if( step == 0.0 )
+  {
+    return;
+  }
+  for( unsigned int i = 1; i < ImageDimension; ++i )
+  {
+    if( std::abs( this->m_IndexToGridIndexMatrix[ i ][ 0 ] ) > 1e-8 * step )
+    {
+      return;
+    }
+    this->m_IndexToGridIndexMatrix[ i ][ 0 ] = 0.0;
+  }
+
+  /** The valid region, as in AdvancedBSplineDeformableTransform::SetGridRegion(). */
+  const typename BSplineTransformBaseType::RegionType gridRegion = bsplineTransform->GetGridRegion();
+  for( unsigned int i = 0; i < ImageDimension; ++i )
+  {
+    this->m_ValidGridIndexBegin[ i ] = static_cast< double >( gridRegion.GetIndex()[ i ] )
+      + ( static_cast< double >( splineOrder ) - 1.0 ) / 2.0;
+    this->m_ValidGridIndexEnd[ i ] = static_cast< double >( gridRegion.GetIndex()[ i ] )
+      + static_cast< double >( gridRegion.GetSize()[ i ] - 1 )
+      - ( static_cast< double >( splineOrder ) - 1.0 ) / 2.0;
+  }
+
+  this->m_BSplineTransform = bsplineTransform;
+  this->m_BSplineOrder     = splineOrder;
+  this->m_ResamplingMethod = BSplineResampling;
+
+} // end BeforeThreadedGenerateData()
+
+
+/**
+ * ******************* DynamicThreadedGenerateData ***********************
+ */
+
+template< typename TInputImage, typename TOutputImage, typename TInterpolatorPrecisionType >
+void
+ScanlineResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType >
+::DynamicThreadedGenerateData( const OutputImageRegionType & outputRegionForThread )
+{
+  if( outputRegionForThread.GetNumberOfPixels() == 0 )
+  {
+    return;
+  }
+
+  if( this->m_ResamplingMethod == LinearResampling )
+  {
+    this->LinearScanlineGenerateData( outputRegionForThread );
+  }
+  else if( this->m_ResamplingMethod == BSplineResampling && this->m_BSplineOrder == 1 )
+  {
+    this->template BSplineScanlineGenerateData< 1 >( outputRegionForThread );
+  }
+  else if( this->m_ResamplingMethod == BSplineResampling && this->m_BSplineOrder == 2 )
+  {
+    this->template BSplineScanlineGenerateData< 2 >( outputRegionForThread );
+  }
+  else if( this->m_ResamplingMethod == BSplineResampling && this->m_BSplineOrder == 3 )
+  {
+    this->template BSplineScanlineGenerateData< 3 >( outputRegionForThread );
+  }
+  else
+  {
+    this->Superclass::DynamicThreadedGenerateData( outputRegionForThread );
+  }
+
+} // end DynamicThreadedGenerateData()
+
+
+/**
+ * ******************* InterpolateAtContinuousIndex ***********************
+ */
+
+template< typename TInputImage, typename TOutputImage, typename TInterpolatorPrecisionType >
+typename ScanlineResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType >::PixelType
+ScanlineResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType >
+::InterpolateAtContinuousIndex( const InterpolatorType * interpolator, const double * cindex ) const
+{
+  typename InterpolatorType::ContinuousIndexType inputIndex;
+  for( unsigned int i = 0; i < ImageDimension; ++i )
+  {
+    inputIndex[ i ] = cindex[ i ];
+  }
+
+  if( !interpolator->IsInsideBuffer( inputIndex ) )
+  {
+    return this->GetDefaultPixelValue();
+  }
+
+  /** Cast with bounds checking, as in the superclass. */
+  const double value    = static_cast< double >( interpolator->EvaluateAtContinuousIndex( inputIndex ) );
+  const double minValue = static_cast< double >( NumericTraits< PixelType >::NonpositiveMin() );
+  const double maxValue = static_cast< double >( NumericTraits< PixelType >::max() );
+  if( value <= minValue )
+  {
+    return NumericTraits< PixelType >::NonpositiveMin();
+  }
+  if( value >= maxValue )
+  {
+    return NumericTraits< PixelType >::max();
+  }
+  return static_cast< PixelType >( value );
+
+} // end InterpolateAtContinuousIndex()
+
+
+/**
+ * ******************* LinearScanlineGenerateData ***********************
+ */
+
+template< typename TInputImage, typename TOutputImage, typename TInterpolatorPrecisionType >
+void
+ScanlineResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType >
+::LinearScanlineGenerateData( const OutputImageRegionType & outputRegionForThread ) const
+{
+  OutputImageType *        outputPtr    = const_cast< Self * >( this )->GetOutput();
+  const InterpolatorType * interpolator = this->GetInterpolator();
+
+  /** The continuous input index is an affine function of the output index. */
+  const AffineMatrixType indexToInputIndexMatrix
+    = this->m_PointToInputIndexMatrix * this->m_IndexToBasePointMatrix;
+  const AffineVectorType indexToInputIndexOffset
+    = this->m_PointToInputIndexMatrix * this->m_IndexToBasePointOffset + this->m_PointToInputIndexOffset;
+  AffineVectorType inputIndexStep;
+  for( unsigned int i = 0; i < ImageDimension; ++i )
+  {
+    inputIndexStep[ i ] = indexToInputIndexMatrix[ i ][ 0 ];
+  }
+
+  ImageScanlineIterator< OutputImageType > it( outputPtr, outputRegionForThread );
+  while( !it.IsAtEnd() )
+  {
+    AffineVectorType index;
+    for( unsigned int i = 0; i < ImageDimension; ++i )
+    {
+      index[ i ] = it.GetIndex()[ i ];
+    }
+    const AffineVectorType inputIndex0 = indexToInputIndexMatrix * index + indexToInputIndexOffset;
+
+    /** Step along the scanline; the start is not accumulated, to avoid drift. */
+    double inputIndex[ ImageDimension ];
+    for( SizeValueType x = 0; !it.IsAtEndOfLine(); ++it, ++x )
+    {
+      for( unsigned int i = 0; i < ImageDimension; ++i )
+      {
+        inputIndex[ i ] = inputIndex0[ i ] + x * inputIndexStep[ i ];
+      }
+      it.Set( this->InterpolateAtContinuousIndex( interpolator, inputIndex ) );
+    }
+    it.NextLine();
+  }
+
+} // end LinearScanlineGenerateData()
+
+
+/**
+ * ******************* BSplineScanlineGenerateData ***********************
+ */
+
+template< typename TInputImage, typename TOutputImage, typename TInterpolatorPrecisionType >
+template< unsigned int VSplineOrder >
+void
+ScanlineResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType >
+::BSplineScanlineGenerateData( const OutputImageRegionType & outputRegionForThread ) const
+{
+  typedef BSplineKernelFunction2< VSplineOrder >            KernelType;
+  typedef typename BSplineTransformBaseType::ImageType      CoefficientImageType;
+  typedef typename CoefficientImageType::PixelType          CoefficientPixelType;
+  typedef typename CoefficientImageType::IndexType          CoefficientIndexType;
+  const unsigned int SupportSize = VSplineOrder + 1;
+
+  OutputImageType *                      outputPtr    = const_cast< Self * >( this )->GetOutput();
+  const InterpolatorType *               interpolator = this->GetInterpolator();
+  const typename KernelType::Pointer     kernel       = KernelType::New();
+
+  /** Get handles to the coefficients. */
+  const typename BSplineTransformBaseType::ImagePointer * coefficientImages
+    = this->m_BSplineTransform->GetCoefficientImages();
+  const CoefficientPixelType * coefficients[ ImageDimension ];
+  for( unsigned int j = 0; j < ImageDimension; ++j )
+  {
+    coefficients[ j ] = coefficientImages[ j ]->GetBufferPointer();
+  }
+  const OffsetValueType *    offsetTable = coefficientImages[ 0 ]->GetOffsetTable();
+  const CoefficientIndexType gridStart   = coefficientImages[ 0 ]->GetBufferedRegion().GetIndex();
+  const SizeValueType        gridSizeX   = coefficientImages[ 0 ]->GetBufferedRegion().GetSize()[ 0 ];
+
+  /** The products of the weights in the other dimensions, with the offsets
+   * of the corresponding coefficients; constant along a scanline.
+   */
+  unsigned int numberOfCrossWeights = 1;
+  for( unsigned int i = 1; i < ImageDimension; ++i )
+  {
+    numberOfCrossWeights *= SupportSize;
+  }
+  std::vector< double >          crossWeights( numberOfCrossWeights );
+  std::vector< OffsetValueType > crossOffsets( numberOfCrossWeights );
+
+  /** The coefficients contracted with the cross weights, per grid column.
+   * A column is contracted on first use in a scanline.
+   */
+  std::vector< double >        contracted( gridSizeX * ImageDimension );
+  std::vector< SizeValueType > contractedScanline( gridSizeX, 0 );
+  SizeValueType                scanline = 0;
+
+  /** The steps along a scanline. */
+  const AffineMatrixType & pointToInputIndex = this->m_PointToInputIndexMatrix;
+  AffineVectorType         basePointStep;
+  for( unsigned int i = 0; i < ImageDimension; ++i )
+  {
+    basePointStep[ i ] = this->m_IndexToBasePointMatrix[ i ][ 0 ];
+  }
+  const AffineVectorType inputIndexStep = pointToInputIndex * basePointStep;
+  const double           gridIndexStep  = this->m_IndexToGridIndexMatrix[ 0 ][ 0 ];
+
+  ImageScanlineIterator< OutputImageType > it( outputPtr, outputRegionForThread );
+  while( !it.IsAtEnd() )
+  {
+    ++scanline;
+    AffineVectorType index;
+    for( unsigned int i = 0; i < ImageDimension; ++i )
+    {
+      index[ i ] = it.GetIndex()[ i ];
+    }
+    const AffineVectorType basePoint0  = this->m_IndexToBasePointMatrix * index + this->m_IndexToBasePointOffset;
+    const AffineVectorType gridIndex0  = this->m_IndexToGridIndexMatrix * index + this->m_IndexToGridIndexOffset;
+    const AffineVectorType inputIndex0 = pointToInputIndex * basePoint0 + this->m_PointToInputIndexOffset;
+
+    /** Compute the cross weights, if the scanline passes the valid region. */
+    bool insideScanline = true;
+    for( unsigned int i = 1; i < ImageDimension; ++i )
+    {
+      if( gridIndex0[ i ] < this->m_ValidGridIndexBegin[ i ] || gridIndex0[ i ] >= this->m_ValidGridIndexEnd[ i ] )
+      {
+        insideScanline = false;
+      }
+    }
+    if( insideScanline )
+    {
+      double          weights1D[ ImageDimension ][ SupportSize ];
+      OffsetValueType startOffset[ ImageDimension ];
+      for( unsigned int i = 1; i < ImageDimension; ++i )
+      {
+        const OffsetValueType start = Math::Floor< OffsetValueType >( gridIndex0[ i ] + 0.5 - VSplineOrder / 2.0 );
+        kernel->Evaluate( gridIndex0[ i ] - static_cast< double >( start ), weights1D[ i ] );
+        startOffset[ i ] = ( start - gridStart[ i ] ) * offsetTable[ i ];
+      }
+      for( unsigned int k = 0; k < numberOfCrossWeights; ++k )
+      {
+        unsigned int    rest   = k;
+        double          weight = 1.0;
+        OffsetValueType offset = 0;
+        for( unsigned int i = 1; i < ImageDimension; ++i )
+        {
+          const unsigned int ki = rest % SupportSize;
+          rest   /= SupportSize;
+          weight *= weights1D[ i ][ ki ];
+          offset += startOffset[ i ] + ki * offsetTable[ i ];
+        }
+        crossWeights[ k ] = weight;
+        crossOffsets[ k ] = offset;
+      }
+    }
+
+    /** Step along the scanline. */
+    double inputIndex[ ImageDimension ];
+    double weightsX[ SupportSize ];
+    for( SizeValueType x = 0; !it.IsAtEndOfLine(); ++it, ++x )
+    {
+      for( unsigned int i = 0; i < ImageDimension; ++i )
+      {
+        inputIndex[ i ] = inputIndex0[ i ] + x * inputIndexStep[ i ];
+      }
+
+      /** Zero displacement outside the valid region, as in the transform. */
+      const double gridIndexX = gridIndex0[ 0 ] + x * gridIndexStep;
+      if( insideScanline
+        && gridIndexX >= this->m_ValidGridIndexBegin[ 0 ] && gridIndexX < this->m_ValidGridIndexEnd[ 0 ] )
+      {
+        const OffsetValueType start = Math::Floor< OffsetValueType >( gridIndexX + 0.5 - VSplineOrder / 2.0 );
+        kernel->Evaluate( gridIndexX - static_cast< double >( start ), weightsX );
+
+        double displacement[ ImageDimension ] = {};
+        for( unsigned int k = 0; k < SupportSize; ++k )
+        {
+          const OffsetValueType column = start + k - gridStart[ 0 ];
+          double *              c      = &contracted[ column * ImageDimension ];
+          if( contractedScanline[ column ] != scanline )
+          {
+            contractedScanline[ column ] = scanline;
+            for( unsigned int j = 0; j < ImageDimension; ++j )
+            {
+              const CoefficientPixelType * mu  = coefficients[ j ] + column * offsetTable[ 0 ];
+              double                       sum = 0.0;
+              for( unsigned int m = 0; m < numberOfCrossWeights; ++m )
+              {
+                sum += crossWeights[ m ] * mu[ crossOffsets[ m ] ];
+              }
+              c[ j ] = sum;
+            }
+          }
+          for( unsigned int j = 0; j < ImageDimension; ++j )
+          {
+            displacement[ j ] += weightsX[ k ] * c[ j ];
+          }
+        }
+
+        for( unsigned int i = 0; i < ImageDimension; ++i )
+        {
+          for( unsigned int j = 0; j < ImageDimension; ++j )
+          {
+            inputIndex[ i ] += pointToInputIndex[ i ][ j ] * displacement[ j ];
+          }
+        }
+      }
+
+      it.Set( this->InterpolateAtContinuousIndex( interpolator, inputIndex ) );
+    }
+    it.NextLine();
+  }
+
+} // end BSplineScanlineGenerateData()
+
+
+/**
+ * ******************* PrintSelf ***********************
+ */
+
+template< typename TInputImage, typename TOutputImage, typename TInterpolatorPrecisionType >
+void
+ScanlineResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "ResamplingMethod: " << this->m_ResamplingMethod << std::endl;
+  os << indent << "BSplineOrder: " << this->m_BSplineOrder << std::endl;
+
+} // end PrintSelf()
+
+
+} // end namespace itk
+
+#endif // end #ifndef __itkScanlineResampleImageFilter_hxx
@@ -28,6 +28,9 @@
 #include <ostream>
 #include <map>
 #include <string>
+#include <vector>
+#include <sstream>
+#include <type_traits>
 
 namespace xoutlibrary
 {
@@ -66,6 +69,22 @@ public:
   typedef typename CStreamMapType::value_type     CStreamMapEntryType;
   typedef typename XStreamMapType::value_type     XStreamMapEntryType;
 
+  typedef basic_string< charT, traits > string_type;
+
+  /** A value that was sent to a cell, stored without formatting it.
+   * Arithmetic values are stored as a number, strings (and everything
+   * else that produces output) as text. */
+  struct TypedValueType
+  {
+    enum { EmptyValue = 0, NumberValue = 1, TextValue = 2 };
+    unsigned char m_Type{ EmptyValue };
+    double        m_Number{ 0.0 };
+    string_type   m_Text;
+  };
+
+  typedef std::vector< TypedValueType > TypedValueContainerType;
+  typedef std::vector< std::string >    NameContainerType;
+
   /** Constructors */
   xoutbase() = default;
 
@@ -147,6 +166,26 @@ public:
 
   virtual const XStreamMapType & GetXOutputs( void );
 
+  /** Set whether the values sent with << are stored as typed values,
+   * see TypedValueType. False by default. */
+  virtual void SetCaptureTypedValues( bool _arg );
+
+  /** Set whether the values sent with << are formatted and passed to
+   * the target cells. When false, only the typed values are captured
+   * (if enabled). True by default. */
+  virtual void SetFormatText( bool _arg );
+
+  /** Move the captured typed values of the target cells to values,
+   * one per target cell, in the order of the cell names. The cells
+   * are emptied. */
+  virtual void GetTypedValues( TypedValueContainerType & values );
+
+  /** Move the typed value captured by this object to value, and empty it. */
+  virtual void ExtractTypedValue( TypedValueType & value );
+
+  /** Get the names of the target cells, in the order used by GetTypedValues(). */
+  virtual void GetTargetCellNames( NameContainerType & names ) const;
+
 protected:
 
   /** Returns a target cell. */
@@ -168,10 +207,27 @@ protected:
   /** Called each time << is used, but only when m_Call == true; */
   virtual void Callback( void ){}
 
+  /** Booleans that say whether the input of << is captured as typed value
+   * and whether it is passed to the target cells. */
+  bool m_CaptureTypedValues{ false };
+  bool m_FormatText{ true };
+
+  /** Called each time << is used with a number or text, but only when
+   * m_CaptureTypedValues == true. */
+  virtual void StoreTypedValue( double ){}
+  virtual void StoreTypedText( const string_type & ){}
+
   template< class T >
   Self & SendToTargets( const T & _arg )
   {
-    Send< T >::ToTargets( const_cast< T & >( _arg ), m_CTargetCells, m_XTargetCells );
+    if( m_CaptureTypedValues )
+    {
+      this->CaptureTypedValue( _arg, CaptureCategory< T >() );
+    }
+    if( m_FormatText )
+    {
+      Send< T >::ToTargets( const_cast< T & >( _arg ), m_CTargetCells, m_XTargetCells );
+    }
     /** Call the callback method. */
     if( m_Call )
     {
@@ -183,6 +239,48 @@ protected:
 
 private:
 
+  /** Determines how a value is captured: 0 = ignored (manipulators like
+   * std::endl), 1 = number, 2 = text, 3 = formatted to text. Single
+   * characters are formatted. */
+  template< class T >
+  struct CaptureCategory : public std::integral_constant< int,
+    ( std::is_pointer< T >::value
+    && std::is_function< typename std::remove_pointer< T >::type >::value ) ? 0 :
+    ( std::is_arithmetic< T >::value && !std::is_same< T, charT >::value
+    && !std::is_same< T, char >::value ) ? 1 :
+    std::is_convertible< const T &, string_type >::value ? 2 : 3 >
+  {};
+
+  template< class T >
+  void CaptureTypedValue( const T &, std::integral_constant< int, 0 > ){}
+
+  template< class T >
+  void CaptureTypedValue( const T & _arg, std::integral_constant< int, 1 > )
+  {
+    this->StoreTypedValue( static_cast< double >( _arg ) );
+  }
+
+
+  template< class T >
+  void CaptureTypedValue( const T & _arg, std::integral_constant< int, 2 > )
+  {
+    this->StoreTypedText( string_type( _arg ) );
+  }
+
+
+  /** Manipulators like std::setprecision produce no output and are ignored. */
+  template< class T >
+  void CaptureTypedValue( const T & _arg, std::integral_constant< int, 3 > )
+  {
+    basic_ostringstream< charT, traits > formatted;
+    formatted << _arg;
+    if( !formatted.str().empty() )
+    {
+      this->StoreTypedText( formatted.str() );
+    }
+  }
+
+
   template< class T >
   class Send
   {
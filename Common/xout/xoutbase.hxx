@@ -319,6 +319,87 @@ const typename xoutbase< charT, traits >::CStreamMapType
 
 } // end GetOutputs
 
+
+/**
+ * ******************* SetCaptureTypedValues ********************
+ */
+
+template< class charT, class traits >
+void
+xoutbase< charT, traits >::SetCaptureTypedValues( bool _arg )
+{
+  this->m_CaptureTypedValues = _arg;
+
+} // end SetCaptureTypedValues
+
+
+/**
+ * ************************ SetFormatText ***********************
+ */
+
+template< class charT, class traits >
+void
+xoutbase< charT, traits >::SetFormatText( bool _arg )
+{
+  this->m_FormatText = _arg;
+
+} // end SetFormatText
+
+
+/**
+ * *********************** GetTypedValues ***********************
+ */
+
+template< class charT, class traits >
+void
+xoutbase< charT, traits >::GetTypedValues( TypedValueContainerType & values )
+{
+  /** Resizing keeps the strings of a reused container allocated. */
+  values.resize( this->m_XTargetCells.size() );
+
+  std::size_t i = 0;
+  for( XStreamMapIteratorType xit = this->m_XTargetCells.begin();
+    xit != this->m_XTargetCells.end(); ++xit, ++i )
+  {
+    xit->second->ExtractTypedValue( values[ i ] );
+  }
+
+} // end GetTypedValues
+
+
+/**
+ * ********************* ExtractTypedValue **********************
+ */
+
+template< class charT, class traits >
+void
+xoutbase< charT, traits >::ExtractTypedValue( TypedValueType & value )
+{
+  /** Nothing is stored here; only cells keep a typed value. */
+  value.m_Type = TypedValueType::EmptyValue;
+  value.m_Text.clear();
+
+} // end ExtractTypedValue
+
+
+/**
+ * ********************* GetTargetCellNames *********************
+ */
+
+template< class charT, class traits >
+void
+xoutbase< charT, traits >::GetTargetCellNames( NameContainerType & names ) const
+{
+  names.clear();
+  for( typename XStreamMapType::const_iterator xit = this->m_XTargetCells.begin();
+    xit != this->m_XTargetCells.end(); ++xit )
+  {
+    names.push_back( xit->first );
+  }
+
+} // end GetTargetCellNames
+
+
 } // end namespace xoutlibrary
 
 #endif // end #ifndef __xoutbase_hxx
@@ -59,6 +59,9 @@ public:
   typedef typename Superclass::CStreamMapEntryType    CStreamMapEntryType;
   typedef typename Superclass::XStreamMapEntryType    XStreamMapEntryType;
 
+  typedef typename Superclass::string_type    string_type;
+  typedef typename Superclass::TypedValueType TypedValueType;
+
   typedef std::basic_ostringstream< charT, traits > InternalBufferType;
 
   /** Constructors */
@@ -67,12 +70,23 @@ public:
   /** Destructor */
   ~xoutcell() override;
 
-  /** Write the buffered cell data to the outputs. */
+  /** Write the buffered cell data to the outputs. This also empties
+   * the captured typed value. */
   void WriteBufferedData( void ) override;
 
+  /** Move the captured typed value to value, and empty it. */
+  void ExtractTypedValue( TypedValueType & value ) override;
+
 protected:
 
+  /** Store a typed value. When the cell already holds a value, the new
+   * value is appended to it as text. */
+  void StoreTypedValue( double _arg ) override;
+
+  void StoreTypedText( const string_type & _arg ) override;
+
   InternalBufferType m_InternalBuffer;
+  TypedValueType     m_TypedValue;
 
 };
 
@@ -82,10 +82,79 @@ xoutcell< charT, traits >::WriteBufferedData( void )
 
   /** Empty the internal buffer */
   this->m_InternalBuffer.str( string( "" ) );
+  this->m_TypedValue.m_Type = TypedValueType::EmptyValue;
 
 } // end WriteBufferedData
 
 
+/**
+ * ********************* ExtractTypedValue **********************
+ */
+
+template< class charT, class traits >
+void
+xoutcell< charT, traits >::ExtractTypedValue( TypedValueType & value )
+{
+  value.m_Type   = this->m_TypedValue.m_Type;
+  value.m_Number = this->m_TypedValue.m_Number;
+  value.m_Text.swap( this->m_TypedValue.m_Text );
+
+  this->m_TypedValue.m_Type = TypedValueType::EmptyValue;
+  this->m_TypedValue.m_Text.clear();
+
+} // end ExtractTypedValue
+
+
+/**
+ * ********************** StoreTypedValue ***********************
+ */
+
+template< class charT, class traits >
+void
+xoutcell< charT, traits >::StoreTypedValue( double _arg )
+{
+  if( this->m_TypedValue.m_Type == TypedValueType::EmptyValue )
+  {
+    this->m_TypedValue.m_Type   = TypedValueType::NumberValue;
+    this->m_TypedValue.m_Number = _arg;
+  }
+  else
+  {
+    basic_ostringstream< charT, traits > formatted;
+    formatted.precision( 17 );
+    formatted << _arg;
+    this->StoreTypedText( formatted.str() );
+  }
+
+} // end StoreTypedValue
+
+
+/**
+ * *********************** StoreTypedText ***********************
+ */
+
+template< class charT, class traits >
+void
+xoutcell< charT, traits >::StoreTypedText( const string_type & _arg )
+{
+  if( this->m_TypedValue.m_Type == TypedValueType::NumberValue )
+  {
+    basic_ostringstream< charT, traits > formatted;
+    formatted.precision( 17 );
+    formatted << this->m_TypedValue.m_Number;
+    this->m_TypedValue.m_Text = formatted.str();
+  }
+  else if( this->m_TypedValue.m_Type == TypedValueType::EmptyValue )
+  {
+    this->m_TypedValue.m_Text.clear();
+  }
+
+  this->m_TypedValue.m_Type = TypedValueType::TextValue;
+  this->m_TypedValue.m_Text += _arg;
+
+} // end StoreTypedText
+
+
 } // end namespace xoutlibrary
 
 #endif // end #ifndef __xoutcell_hxx
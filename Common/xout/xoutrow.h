@@ -107,6 +107,14 @@ public:
 
   void SetOutputs( const XStreamMapType & outputmap ) override;
 
+  /** In addition to the behaviour of the Superclass's methods, these functions
+   * set the capture and format modes of the TargetCells as well. Cells that
+   * are added later get the same modes.
+   */
+  void SetCaptureTypedValues( bool _arg ) override;
+
+  void SetFormatText( bool _arg ) override;
+
 protected:
 
   /** Returns a target cell.
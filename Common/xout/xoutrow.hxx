@@ -108,6 +108,10 @@ xoutrow< charT, traits >
     cell->SetOutputs( this->m_COutputs );
     cell->SetOutputs( this->m_XOutputs );
 
+    /** And the capture and format modes. */
+    cell->SetCaptureTypedValues( this->m_CaptureTypedValues );
+    cell->SetFormatText( this->m_FormatText );
+
     /** Stored in a map, to make sure that later we can
      * delete all memory, assigned in this function.
      */
@@ -305,6 +309,52 @@ xoutrow< charT, traits >
 } // end SetOutputs()
 
 
+/**
+ * ****************** SetCaptureTypedValues *********************
+ */
+
+template< class charT, class traits >
+void
+xoutrow< charT, traits >
+::SetCaptureTypedValues( bool _arg )
+{
+  XStreamMapIteratorType xit;
+
+  /** Set the mode in all cells. */
+  for( xit = this->m_XTargetCells.begin(); xit != this->m_XTargetCells.end(); ++xit )
+  {
+    xit->second->SetCaptureTypedValues( _arg );
+  }
+
+  /** Call the Superclass's implementation. */
+  this->Superclass::SetCaptureTypedValues( _arg );
+
+} // end SetCaptureTypedValues()
+
+
+/**
+ * ********************** SetFormatText *************************
+ */
+
+template< class charT, class traits >
+void
+xoutrow< charT, traits >
+::SetFormatText( bool _arg )
+{
+  XStreamMapIteratorType xit;
+
+  /** Set the mode in all cells. */
+  for( xit = this->m_XTargetCells.begin(); xit != this->m_XTargetCells.end(); ++xit )
+  {
+    xit->second->SetFormatText( _arg );
+  }
+
+  /** Call the Superclass's implementation. */
+  this->Superclass::SetFormatText( _arg );
+
+} // end SetFormatText()
+
+
 /**
  * ******************** WriteHeaders ****************************
  */
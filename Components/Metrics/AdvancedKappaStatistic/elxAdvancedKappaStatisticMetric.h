@@ -144,12 +144,11 @@ public:
    */
   void Initialize( void ) override;
 
-  /**
-   * Do some things before registration:
-   * \li Set the UseComplement setting
-   * \li Set the ForeGroundvalue setting
+  /** The settings are only read in ReadAdvancedMetricParameters(), so
+   * this metric can be copied by CreateCostFunctionContext().
    */
-  void BeforeRegistration( void ) override;
+  bool SupportsCostFunctionContexts( void ) const override
+  { return true; }
 
 protected:
 
@@ -158,6 +157,13 @@ protected:
   /** The destructor. */
   ~AdvancedKappaStatisticMetric() override {}
 
+  /**
+   * Read the settings before each resolution:
+   * \li Set the UseComplement setting
+   * \li Set the ForeGroundvalue setting
+   */
+  void ReadAdvancedMetricParameters( void ) override;
+
 private:
 
   /** The private constructor. */
@@ -46,14 +46,17 @@ AdvancedKappaStatisticMetric< TElastix >
 
 
 /**
- * ***************** BeforeRegistration ***********************
+ * ***************** ReadAdvancedMetricParameters ***********************
  */
 
 template< class TElastix >
 void
 AdvancedKappaStatisticMetric< TElastix >
-::BeforeRegistration( void )
+::ReadAdvancedMetricParameters( void )
 {
+  /** Read the settings of all advanced metrics. */
+  this->Superclass2::ReadAdvancedMetricParameters();
+
   /** Get and set taking the complement. */
   bool useComplement = true;
   this->GetConfiguration()->ReadParameter( useComplement,
@@ -75,7 +78,7 @@ AdvancedKappaStatisticMetric< TElastix >
     "ForegroundValue", this->GetComponentLabel(), 0, -1 );
   this->SetForegroundValue( foreground );
 
-} // end BeforeRegistration()
+} // end ReadAdvancedMetricParameters()
 
 
 } // end namespace elastix
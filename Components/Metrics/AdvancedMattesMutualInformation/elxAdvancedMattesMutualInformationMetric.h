@@ -91,6 +91,15 @@ namespace elastix
  *    B-spline grids.
  *    example: <tt>(UseFastAndLowMemoryVersion "false")</tt> \n
  *    The default is "true".
+ * \parameter UseSparsePDFDerivatives: Only used when UseFastAndLowMemoryVersion
+ *    is "true". Loop over the samples once instead of twice, by storing for
+ *    each sample the few terms of its contribution to the joint histogram
+ *    derivative. The memory use is proportional to the number of samples times
+ *    the number of affected B-spline parameters per sample. Faster when the
+ *    transform and moving image are expensive to evaluate. Requires
+ *    multi-threading, and is not combined with UseJacobianPreconditioning.\n
+ *    example: <tt>(UseSparsePDFDerivatives "true")</tt> \n
+ *    The default is "false".
  *
  * \sa ParzenWindowMutualInformationImageToImageMetric
  * \ingroup Metrics
@@ -191,13 +200,6 @@ public:
   typedef typename Superclass2::RegistrationPointer  RegistrationPointer;
   typedef typename Superclass2::ITKBaseType          ITKBaseType;
 
-  /** Execute stuff before each new pyramid resolution:
-   * \li Set the number of histogram bins.
-   * \li Set the CheckNumberOfSamples option.
-   * \li Set the fixed/moving LimitRangeRatio
-   * \li Set the fixed/moving limiter. */
-  void BeforeEachResolution( void ) override;
-
   /** Update the CurrenIteration. This is only important
    * if a finite difference derivative estimation is used
    * (selected by the experimental parameter FiniteDifferenceDerivative)  */
@@ -219,6 +221,12 @@ public:
   itkSetMacro( CurrentIteration, unsigned int );
   itkGetConstMacro( CurrentIteration, unsigned int );
 
+  /** The settings are only read in ReadAdvancedMetricParameters(), so
+   * this metric can be copied by CreateCostFunctionContext().
+   */
+  bool SupportsCostFunctionContexts( void ) const override
+  { return true; }
+
 protected:
 
   /** The constructor. */
@@ -227,6 +235,13 @@ protected:
   /** The destructor. */
   ~AdvancedMattesMutualInformationMetric() override {}
 
+  /** Read the settings before each new pyramid resolution:
+   * \li Set the number of histogram bins.
+   * \li Set the CheckNumberOfSamples option.
+   * \li Set the fixed/moving LimitRangeRatio
+   * \li Set the fixed/moving limiter. */
+  void ReadAdvancedMetricParameters( void ) override;
+
   unsigned long m_CurrentIteration;
 
   /** A function to compute the finite difference perturbation in each iteration */
@@ -65,14 +65,17 @@ AdvancedMattesMutualInformationMetric< TElastix >
 
 
 /**
- * ***************** BeforeEachResolution ***********************
+ * ***************** ReadAdvancedMetricParameters ***********************
  */
 
 template< class TElastix >
 void
 AdvancedMattesMutualInformationMetric< TElastix >
-::BeforeEachResolution( void )
+::ReadAdvancedMetricParameters( void )
 {
+  /** Read the settings of all advanced metrics. */
+  this->Superclass2::ReadAdvancedMetricParameters();
+
   /** Get the current resolution level. */
   unsigned int level
     = ( this->m_Registration->GetAsITKBaseType() )->GetCurrentLevel();
@@ -125,6 +128,12 @@ AdvancedMattesMutualInformationMetric< TElastix >
     "UseFastAndLowMemoryVersion", this->GetComponentLabel(), level, 0 );
   this->SetUseExplicitPDFDerivatives( !useFastAndLowMemoryVersion );
 
+  /** Set whether the low memory version should store the sparse pdf derivatives. */
+  bool useSparsePDFDerivatives = false;
+  this->GetConfiguration()->ReadParameter( useSparsePDFDerivatives,
+    "UseSparsePDFDerivatives", this->GetComponentLabel(), level, 0 );
+  this->SetUseSparsePDFDerivatives( useSparsePDFDerivatives );
+
   /** Set whether to use Nick Tustison's preconditioning technique. */
   bool useJacobianPreconditioning = false;
   this->GetConfiguration()->ReadParameter( useJacobianPreconditioning,
@@ -152,7 +161,7 @@ AdvancedMattesMutualInformationMetric< TElastix >
     this->SetFiniteDifferencePerturbation( this->Compute_c( 0 ) );
   }
 
-} // end BeforeEachResolution()
+} // end ReadAdvancedMetricParameters()
 
 
 /**
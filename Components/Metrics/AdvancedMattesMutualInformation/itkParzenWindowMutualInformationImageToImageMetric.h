@@ -22,6 +22,8 @@
 
 #include "itkArray2D.h"
 
+#include <vector>
+
 namespace itk
 {
 
@@ -157,6 +159,13 @@ public:
   itkGetConstMacro( UseJacobianPreconditioning, bool );
   itkSetMacro( UseJacobianPreconditioning, bool );
 
+  /** Set/get whether to compute the derivative in a single pass over the samples,
+   * storing per sample only the sparse terms of the joint histogram derivative.
+   * Only used when UseExplicitPDFDerivatives == false; default: false.
+   */
+  itkGetConstMacro( UseSparsePDFDerivatives, bool );
+  itkSetMacro( UseSparsePDFDerivatives, bool );
+
 protected:
 
   /** The constructor. */
@@ -192,6 +201,7 @@ protected:
   typedef typename Superclass::ParzenValueContainerType            ParzenValueContainerType;
   typedef typename Superclass::KernelFunctionType                  KernelFunctionType;
   typedef typename Superclass::NonZeroJacobianIndicesType          NonZeroJacobianIndicesType;
+  typedef typename Superclass::UpdateJointPDFBufferFunctionType    UpdateJointPDFBufferFunctionType;
 
   /**  Get the value and analytic derivative.
    * Called by GetValueAndDerivative if UseFiniteDifferenceDerivative == false.
@@ -217,6 +227,26 @@ protected:
     const ParametersType & parameters,
     MeasureType & value, DerivativeType & derivative ) const;
 
+  /** Get the value and analytic derivative.
+   * Called by GetValueAndDerivative if UseFiniteDifferenceDerivative == false,
+   * UseExplicitPDFDerivatives == false and UseSparsePDFDerivatives == true.
+   *
+   * Implements a version that loops once over the samples, without the large
+   * memory allocation of the explicit joint histogram derivative. The derivative
+   * of the joint histogram to the parameters is the product of the Parzen values
+   * and (dM/dx)^T (dT/dmu), so for each sample only these factors are stored,
+   * per thread. The memory is proportional to the number of samples times the
+   * number of nonzero Jacobian indices. When the joint histogram is complete,
+   * the derivative is computed from these sparse terms, as in the low memory
+   * version, but without evaluating the transform and moving image again.
+   *
+   * Falls back to the low memory version when multi-threading is off, or when
+   * Jacobian preconditioning is used.
+   */
+  virtual void GetValueAndAnalyticDerivativeSparse(
+    const ParametersType & parameters,
+    MeasureType & value, DerivativeType & derivative ) const;
+
   /**  Get the value and finite difference derivative.
    * Called by GetValueAndDerivative if UseFiniteDifferenceDerivative == true.
    *
@@ -256,6 +286,24 @@ protected:
   /** Helper function to launch the threads. */
   void LaunchComputeDerivativeLowMemoryThreaderCallback( void ) const;
 
+  /** Multi-threadedly compute the joint PDF and store the sparse derivative terms. */
+  inline void ThreadedComputePDFsAndSparsePDFDerivatives( ThreadIdType threadId );
+
+  /** Helper function to launch the threads. */
+  static ITK_THREAD_RETURN_TYPE ComputePDFsAndSparsePDFDerivativesThreaderCallback( void * arg );
+
+  /** Helper function to launch the threads. */
+  void LaunchComputePDFsAndSparsePDFDerivativesThreaderCallback( void ) const;
+
+  /** Multi-threadedly compute the derivative from the sparse derivative terms. */
+  inline void ThreadedComputeDerivativeSparse( ThreadIdType threadId );
+
+  /** Helper function to launch the threads. */
+  static ITK_THREAD_RETURN_TYPE ComputeDerivativeSparseThreaderCallback( void * arg );
+
+  /** Helper function to launch the threads. */
+  void LaunchComputeDerivativeSparseThreaderCallback( void ) const;
+
 private:
 
   /** The private constructor. */
@@ -268,8 +316,25 @@ private:
   typedef Array2D< PRatioType > PRatioArrayType;
   mutable PRatioArrayType m_PRatioArray;
 
-  /** Setting */
+  /** Settings */
   bool m_UseJacobianPreconditioning;
+  bool m_UseSparsePDFDerivatives;
+
+  /** The sparse joint histogram derivative terms of the samples of a thread.
+   * For each valid sample, in this order, the lowest fixed and moving Parzen
+   * window indices, the fixed Parzen values followed by the moving Parzen
+   * derivative values, and the (dM/dx)^T (dT/dmu) values with their parameter
+   * indices. The vectors only grow, so that they are allocated once.
+   */
+  struct SparsePDFDerivativesPerThreadStruct
+  {
+    SizeValueType                      st_NumberOfSamples;
+    std::vector< OffsetValueType >     st_ParzenWindowIndices;
+    std::vector< PDFValueType >        st_ParzenValues;
+    std::vector< DerivativeValueType > st_ImageJacobians;
+    NonZeroJacobianIndicesType         st_NonZeroJacobianIndices;
+  };
+  mutable std::vector< SparsePDFDerivativesPerThreadStruct > m_SparsePDFDerivativesPerThreadVariables;
 
   /** Helper function to compute the derivative for the low memory variant. */
   void ComputeDerivativeLowMemorySingleThreaded( DerivativeType & derivative ) const;
@@ -27,6 +27,8 @@
 #include "vnl/vnl_inverse.h"
 #include "vnl/vnl_det.h"
 
+#include <algorithm>
+
 #ifdef ELASTIX_USE_OPENMP
 #include <omp.h>
 #endif
@@ -42,6 +44,7 @@ ParzenWindowMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
 ::ParzenWindowMutualInformationImageToImageMetric()
 {
   this->m_UseJacobianPreconditioning = false;
+  this->m_UseSparsePDFDerivatives    = false;
 
   /** Initialize the m_ParzenWindowHistogramThreaderParameters. */
   this->m_ParzenWindowMutualInformationThreaderParameters.m_Metric = this;
@@ -150,11 +153,19 @@ ParzenWindowMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
   MeasureType & value,
   DerivativeType & derivative ) const
 {
-  /** Low memory variant. */
+  /** Low memory variants. */
   if( !this->GetUseExplicitPDFDerivatives() )
   {
-    this->GetValueAndAnalyticDerivativeLowMemory(
-      parameters, value, derivative );
+    if( this->GetUseSparsePDFDerivatives() )
+    {
+      this->GetValueAndAnalyticDerivativeSparse(
+        parameters, value, derivative );
+    }
+    else
+    {
+      this->GetValueAndAnalyticDerivativeLowMemory(
+        parameters, value, derivative );
+    }
     return;
   }
 
@@ -286,6 +297,65 @@ ParzenWindowMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
 } // end GetValueAndAnalyticDerivativeLowMemory()
 
 
+/**
+ * ******************** GetValueAndAnalyticDerivativeSparse *******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+ParzenWindowMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
+::GetValueAndAnalyticDerivativeSparse(
+  const ParametersType & parameters,
+  MeasureType & value,
+  DerivativeType & derivative ) const
+{
+  /** The sparse terms are stored per thread, and the Jacobian preconditioning
+   * is only implemented in the low memory variant.
+   */
+  if( !this->m_UseMultiThread || this->GetUseJacobianPreconditioning() )
+  {
+    this->GetValueAndAnalyticDerivativeLowMemory( parameters, value, derivative );
+    return;
+  }
+
+  /** Call non-thread-safe stuff, such as:
+   *   this->SetTransformParameters( parameters );
+   *   this->GetImageSampler()->Update();
+   */
+  this->BeforeThreadedGetValueAndDerivative( parameters );
+
+  /** Only resize the array of sparse terms when needed. */
+  const ThreadIdType numberOfThreads = Self::GetNumberOfWorkUnits();
+  if( this->m_SparsePDFDerivativesPerThreadVariables.size() != numberOfThreads )
+  {
+    this->m_SparsePDFDerivativesPerThreadVariables.resize( numberOfThreads );
+  }
+
+  /** Construct the JointPDF and Alpha, and store the sparse derivative terms.
+   * This is the only loop over the samples.
+   */
+  this->LaunchComputePDFsAndSparsePDFDerivativesThreaderCallback();
+  this->AfterThreadedComputePDFs();
+
+  /** Normalize the joint histogram by alpha. */
+  this->NormalizeJointPDF( this->m_JointPDF, this->m_Alpha );
+
+  /** Compute the fixed and moving marginal pdf by summing over the histogram. */
+  this->ComputeMarginalPDF( this->m_JointPDF, this->m_FixedImageMarginalPDF, 0 );
+  this->ComputeMarginalPDF( this->m_JointPDF, this->m_MovingImageMarginalPDF, 1 );
+
+  /** Compute the metric value and the intermediate m_PRatioArray. */
+  double MI = 0.0;
+  this->ComputeValueAndPRatioArray( MI );
+  value = static_cast< MeasureType >( -1.0 * MI );
+
+  /** Compute the derivative from the sparse terms, and gather the results. */
+  this->LaunchComputeDerivativeSparseThreaderCallback();
+  this->AfterThreadedComputeDerivativeLowMemory( derivative );
+
+} // end GetValueAndAnalyticDerivativeSparse()
+
+
 /**
  * ******************** ComputeDerivativeLowMemorySingleThreaded *******************
  */
@@ -329,7 +399,8 @@ ParzenWindowMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
     MovingImagePointType        mappedPoint;
 
     /** Transform point and check if it is inside the B-spline support region. */
-    bool sampleOk = this->TransformPoint( fixedPoint, mappedPoint );
+    const SizeValueType samplePosition = this->GetSamplePosition( fiter );
+    bool                sampleOk       = this->TransformSamplePoint( samplePosition, fixedPoint, mappedPoint );
 
     /** Check if the point is inside the moving mask. */
     if( sampleOk )
@@ -358,7 +429,7 @@ ParzenWindowMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
         ->Evaluate( movingImageValue, movingImageDerivative );
 
       /** Get the transform Jacobian dT/dmu. */
-      this->EvaluateTransformJacobian( fixedPoint, jacobian, nzji );
+      this->EvaluateSampleTransformJacobian( samplePosition, fixedPoint, jacobian, nzji );
 
       /** Compute the inner product (dM/dx)^T (dT/dmu). */
       this->EvaluateTransformJacobianInnerProduct(
@@ -495,7 +566,8 @@ ParzenWindowMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
     MovingImagePointType        mappedPoint;
 
     /** Transform point and check if it is inside the B-spline support region. */
-    bool sampleOk = this->TransformPoint( fixedPoint, mappedPoint );
+    const SizeValueType samplePosition = this->GetSamplePosition( fiter );
+    bool                sampleOk       = this->TransformSamplePoint( samplePosition, fixedPoint, mappedPoint );
 
     /** Check if the point is inside the moving mask. */
     if( sampleOk )
@@ -531,7 +603,7 @@ ParzenWindowMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
         jacobian, movingImageDerivative, imageJacobian );
 #else
       /** Compute the inner product of the transform Jacobian dT/dmu and the moving image gradient dM/dx. */
-      this->m_AdvancedTransform->EvaluateJacobianWithImageGradientProduct(
+      this->EvaluateSampleJacobianWithImageGradientProduct( samplePosition,
         fixedPoint, movingImageDerivative, imageJacobian, nzji );
 #endif
 
@@ -539,7 +611,7 @@ ParzenWindowMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
       TransformJacobianType jacobian;
       if( this->GetUseJacobianPreconditioning() )
       {
-        this->EvaluateTransformJacobian( fixedPoint, jacobian, nzji );
+        this->EvaluateSampleTransformJacobian( samplePosition, fixedPoint, jacobian, nzji );
 
         this->ComputeJacobianPreconditioner( jacobian, nzji,
           jacobianPreconditioner, preconditioningDivisor );
@@ -680,6 +752,311 @@ ParzenWindowMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
 } // end LaunchComputeDerivativeLowMemoryThreaderCallback()
 
 
+/**
+ * ******************* ThreadedComputePDFsAndSparsePDFDerivatives *******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+ParzenWindowMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
+::ThreadedComputePDFsAndSparsePDFDerivatives( ThreadIdType threadId )
+{
+  /** Get a handle to the pre-allocated joint PDF for the current thread. */
+  PDFValueType * jointPDF = this->GetThreaderJointPDF( threadId );
+  std::fill( jointPDF, jointPDF + this->m_NumberOfFixedHistogramBins * this->m_NumberOfMovingHistogramBins,
+    NumericTraits< PDFValueType >::ZeroValue() );
+
+  /** The joint PDF update for the kernel orders. */
+  const UpdateJointPDFBufferFunctionType updateJointPDF = this->GetUpdateJointPDFBufferFunction();
+
+  /** Initialize array that stores dM(x)/dmu, and the sparse Jacobian + indices. */
+  const NumberOfParametersType nnzji = this->m_AdvancedTransform->GetNumberOfNonZeroJacobianIndices();
+  NonZeroJacobianIndicesType   nzji  = NonZeroJacobianIndicesType( nnzji );
+  DerivativeType               imageJacobian( nzji.size() );
+
+  /** The sizes of the fixed and moving Parzen windows. */
+  const unsigned int fixedParzenWindowSize  = this->m_JointPDFWindow.GetSize()[ 1 ];
+  const unsigned int movingParzenWindowSize = this->m_JointPDFWindow.GetSize()[ 0 ];
+  const unsigned int parzenValuesSize       = fixedParzenWindowSize + movingParzenWindowSize;
+
+  /** Get a handle to the sample container. */
+  ImageSampleContainerPointer sampleContainer     = this->GetImageSampler()->GetOutput();
+  const unsigned long         sampleContainerSize = sampleContainer->Size();
+
+  /** Get the samples for this thread. */
+  const unsigned long nrOfSamplesPerThreads
+    = static_cast< unsigned long >( std::ceil( static_cast< double >( sampleContainerSize )
+    / static_cast< double >( Self::GetNumberOfWorkUnits() ) ) );
+
+  unsigned long pos_begin = nrOfSamplesPerThreads * threadId;
+  unsigned long pos_end   = nrOfSamplesPerThreads * ( threadId + 1 );
+  pos_begin = ( pos_begin > sampleContainerSize ) ? sampleContainerSize : pos_begin;
+  pos_end   = ( pos_end > sampleContainerSize ) ? sampleContainerSize : pos_end;
+
+  /** Make sure the sparse terms of all samples of this thread fit. */
+  SparsePDFDerivativesPerThreadStruct & sparseTerms = this->m_SparsePDFDerivativesPerThreadVariables[ threadId ];
+  const SizeValueType                   maxNumberOfSamples = pos_end - pos_begin;
+  if( sparseTerms.st_ParzenWindowIndices.size() < 2 * maxNumberOfSamples )
+  {
+    sparseTerms.st_ParzenWindowIndices.resize( 2 * maxNumberOfSamples );
+  }
+  if( sparseTerms.st_ParzenValues.size() < parzenValuesSize * maxNumberOfSamples )
+  {
+    sparseTerms.st_ParzenValues.resize( parzenValuesSize * maxNumberOfSamples );
+  }
+  if( sparseTerms.st_ImageJacobians.size() < nnzji * maxNumberOfSamples )
+  {
+    sparseTerms.st_ImageJacobians.resize( nnzji * maxNumberOfSamples );
+    sparseTerms.st_NonZeroJacobianIndices.resize( nnzji * maxNumberOfSamples );
+  }
+  OffsetValueType *     parzenWindowIndices    = sparseTerms.st_ParzenWindowIndices.data();
+  PDFValueType *        parzenValues           = sparseTerms.st_ParzenValues.data();
+  DerivativeValueType * imageJacobians         = sparseTerms.st_ImageJacobians.data();
+  unsigned long *       nonZeroJacobianIndices = sparseTerms.st_NonZeroJacobianIndices.data();
+
+  /** Create iterator over the sample container. */
+  typename ImageSampleContainerType::ConstIterator fiter;
+  typename ImageSampleContainerType::ConstIterator fbegin = sampleContainer->Begin();
+  typename ImageSampleContainerType::ConstIterator fend   = sampleContainer->Begin();
+  fbegin                                                 += (int)pos_begin;
+  fend                                                   += (int)pos_end;
+
+  /** Create variables to store intermediate results. circumvent false sharing */
+  unsigned long numberOfPixelsCounted = 0;
+
+  /** Loop over sample container and compute contribution of each sample to pdfs. */
+  for( fiter = fbegin; fiter != fend; ++fiter )
+  {
+    /** Read fixed coordinates and create some variables. */
+    const FixedImagePointType & fixedPoint = ( *fiter ).Value().m_ImageCoordinates;
+    RealType                    movingImageValue;
+    MovingImageDerivativeType   movingImageDerivative;
+    MovingImagePointType        mappedPoint;
+
+    /** Transform point and check if it is inside the B-spline support region. */
+    const SizeValueType samplePosition = this->GetSamplePosition( fiter );
+    bool                sampleOk       = this->TransformSamplePoint( samplePosition, fixedPoint, mappedPoint );
+
+    /** Check if the point is inside the moving mask. */
+    if( sampleOk )
+    {
+      sampleOk = this->IsInsideMovingMask( mappedPoint );
+    }
+
+    /** Compute the moving image value, its derivative, and check
+     * if the point is inside the moving image buffer.
+     */
+    if( sampleOk )
+    {
+      sampleOk = this->EvaluateMovingImageValueAndDerivative(
+        mappedPoint, movingImageValue, &movingImageDerivative );
+    }
+
+    if( sampleOk )
+    {
+      numberOfPixelsCounted++;
+
+      /** Get the fixed image value. */
+      RealType fixedImageValue = static_cast< RealType >( ( *fiter ).Value().m_ImageValue );
+
+      /** Make sure the values fall within the histogram range. */
+      fixedImageValue  = this->GetFixedImageLimiter()->Evaluate( fixedImageValue );
+      movingImageValue = this->GetMovingImageLimiter()
+        ->Evaluate( movingImageValue, movingImageDerivative );
+
+      /** Compute this sample's contribution to the joint distributions. */
+      ( this->*updateJointPDF )( fixedImageValue, movingImageValue, jointPDF );
+
+      /** Compute the inner product of the transform Jacobian dT/dmu and the moving image gradient dM/dx. */
+      this->EvaluateSampleJacobianWithImageGradientProduct( samplePosition,
+        fixedPoint, movingImageDerivative, imageJacobian, nzji );
+
+      /** Determine the Parzen windows, as in UpdateDerivativeLowMemory(). */
+      const double fixedImageParzenWindowTerm
+        = fixedImageValue / this->m_FixedImageBinSize - this->m_FixedImageNormalizedMin;
+      const double movingImageParzenWindowTerm
+        = movingImageValue / this->m_MovingImageBinSize - this->m_MovingImageNormalizedMin;
+      const OffsetValueType fixedParzenWindowIndex
+        = static_cast< OffsetValueType >( std::floor(
+        fixedImageParzenWindowTerm + this->m_FixedParzenTermToIndexOffset ) );
+      const OffsetValueType movingParzenWindowIndex
+        = static_cast< OffsetValueType >( std::floor(
+        movingImageParzenWindowTerm + this->m_MovingParzenTermToIndexOffset ) );
+
+      /** Store the sparse terms of this sample. */
+      parzenWindowIndices[ 0 ] = fixedParzenWindowIndex;
+      parzenWindowIndices[ 1 ] = movingParzenWindowIndex;
+      this->m_FixedKernel->Evaluate(
+        static_cast< double >( fixedParzenWindowIndex ) - fixedImageParzenWindowTerm, parzenValues );
+      this->m_DerivativeMovingKernel->Evaluate(
+        static_cast< double >( movingParzenWindowIndex ) - movingImageParzenWindowTerm,
+        parzenValues + fixedParzenWindowSize );
+      std::copy( imageJacobian.begin(), imageJacobian.end(), imageJacobians );
+      std::copy( nzji.begin(), nzji.end(), nonZeroJacobianIndices );
+
+      parzenWindowIndices    += 2;
+      parzenValues           += parzenValuesSize;
+      imageJacobians         += nnzji;
+      nonZeroJacobianIndices += nnzji;
+
+    } // end sampleOk
+  } // end loop over sample container
+
+  /** Only update these variables at the end to prevent unnecessary "false sharing". */
+  this->m_ParzenWindowHistogramGetValueAndDerivativePerThreadVariables[ threadId ].st_NumberOfPixelsCounted = numberOfPixelsCounted;
+  sparseTerms.st_NumberOfSamples = numberOfPixelsCounted;
+
+} // end ThreadedComputePDFsAndSparsePDFDerivatives()
+
+
+/**
+ * **************** ComputePDFsAndSparsePDFDerivativesThreaderCallback *******
+ */
+
+template< class TFixedImage, class TMovingImage >
+ITK_THREAD_RETURN_TYPE
+ParzenWindowMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
+::ComputePDFsAndSparsePDFDerivativesThreaderCallback( void * arg )
+{
+  ThreadInfoType * infoStruct = static_cast< ThreadInfoType * >( arg );
+  ThreadIdType     threadId   = infoStruct->WorkUnitID;
+
+  ParzenWindowMutualInformationMultiThreaderParameterType * temp
+    = static_cast< ParzenWindowMutualInformationMultiThreaderParameterType * >( infoStruct->UserData );
+
+  temp->m_Metric->ThreadedComputePDFsAndSparsePDFDerivatives( threadId );
+
+  return itk::ITK_THREAD_RETURN_DEFAULT_VALUE;
+
+} // end ComputePDFsAndSparsePDFDerivativesThreaderCallback()
+
+
+/**
+ * *********************** LaunchComputePDFsAndSparsePDFDerivativesThreaderCallback***************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+ParzenWindowMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
+::LaunchComputePDFsAndSparsePDFDerivativesThreaderCallback( void ) const
+{
+  /** Setup threader. */
+  this->m_Threader->SetSingleMethod( this->ComputePDFsAndSparsePDFDerivativesThreaderCallback,
+    const_cast< void * >( static_cast< const void * >(
+      &this->m_ParzenWindowMutualInformationThreaderParameters ) ) );
+
+  /** Launch. */
+  this->m_Threader->SingleMethodExecute();
+
+} // end LaunchComputePDFsAndSparsePDFDerivativesThreaderCallback()
+
+
+/**
+ * ******************* ThreadedComputeDerivativeSparse *******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+ParzenWindowMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
+::ThreadedComputeDerivativeSparse( ThreadIdType threadId )
+{
+  /** Get a handle to the pre-allocated derivative for the current thread.
+   * It is reset by the accumulate functions, see ThreadedComputeDerivativeLowMemory().
+   */
+  DerivativeType & derivative = this->m_GetValueAndDerivativePerThreadVariables[ threadId ].st_Derivative;
+
+  /** The sizes of the stored terms. */
+  const NumberOfParametersType nnzji                  = this->m_AdvancedTransform->GetNumberOfNonZeroJacobianIndices();
+  const unsigned int           fixedParzenWindowSize  = this->m_JointPDFWindow.GetSize()[ 1 ];
+  const unsigned int           movingParzenWindowSize = this->m_JointPDFWindow.GetSize()[ 0 ];
+
+  /** Get a handle to the sparse terms of the samples of this thread. */
+  const SparsePDFDerivativesPerThreadStruct & sparseTerms = this->m_SparsePDFDerivativesPerThreadVariables[ threadId ];
+  const OffsetValueType *                     parzenWindowIndices    = sparseTerms.st_ParzenWindowIndices.data();
+  const PDFValueType *                        parzenValues           = sparseTerms.st_ParzenValues.data();
+  const DerivativeValueType *                 imageJacobians         = sparseTerms.st_ImageJacobians.data();
+  const unsigned long *                       nonZeroJacobianIndices = sparseTerms.st_NonZeroJacobianIndices.data();
+
+  /** Get the moving image bin size. */
+  const double et = static_cast< double >( this->m_MovingImageBinSize );
+
+  /** Loop over the samples, see UpdateDerivativeLowMemory(). */
+  for( SizeValueType s = 0; s < sparseTerms.st_NumberOfSamples; ++s )
+  {
+    const OffsetValueType fixedParzenWindowIndex       = parzenWindowIndices[ 0 ];
+    const OffsetValueType movingParzenWindowIndex      = parzenWindowIndices[ 1 ];
+    const PDFValueType *  derivativeMovingParzenValues = parzenValues + fixedParzenWindowSize;
+
+    /** Loop over the Parzen window region and increment sum. */
+    PDFValueType sum = 0.0;
+    for( unsigned int f = 0; f < fixedParzenWindowSize; ++f )
+    {
+      const double fv_et = parzenValues[ f ] / et;
+      for( unsigned int m = 0; m < movingParzenWindowSize; ++m )
+      {
+        sum += this->m_PRatioArray[ f + fixedParzenWindowIndex ][ m + movingParzenWindowIndex ]
+          * fv_et * derivativeMovingParzenValues[ m ];
+      }
+    }
+
+    /** Now compute derivative -= sum * imageJacobian. */
+    for( unsigned int i = 0; i < nnzji; ++i )
+    {
+      derivative[ nonZeroJacobianIndices[ i ] ] += static_cast< DerivativeValueType >(
+        imageJacobians[ i ] * sum );
+    }
+
+    parzenWindowIndices    += 2;
+    parzenValues           += fixedParzenWindowSize + movingParzenWindowSize;
+    imageJacobians         += nnzji;
+    nonZeroJacobianIndices += nnzji;
+  }
+
+} // end ThreadedComputeDerivativeSparse()
+
+
+/**
+ * **************** ComputeDerivativeSparseThreaderCallback *******
+ */
+
+template< class TFixedImage, class TMovingImage >
+ITK_THREAD_RETURN_TYPE
+ParzenWindowMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
+::ComputeDerivativeSparseThreaderCallback( void * arg )
+{
+  ThreadInfoType * infoStruct = static_cast< ThreadInfoType * >( arg );
+  ThreadIdType     threadId   = infoStruct->WorkUnitID;
+
+  ParzenWindowMutualInformationMultiThreaderParameterType * temp
+    = static_cast< ParzenWindowMutualInformationMultiThreaderParameterType * >( infoStruct->UserData );
+
+  temp->m_Metric->ThreadedComputeDerivativeSparse( threadId );
+
+  return itk::ITK_THREAD_RETURN_DEFAULT_VALUE;
+
+} // end ComputeDerivativeSparseThreaderCallback()
+
+
+/**
+ * *********************** LaunchComputeDerivativeSparseThreaderCallback***************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+ParzenWindowMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
+::LaunchComputeDerivativeSparseThreaderCallback( void ) const
+{
+  /** Setup threader. */
+  this->m_Threader->SetSingleMethod( this->ComputeDerivativeSparseThreaderCallback,
+    const_cast< void * >( static_cast< const void * >(
+      &this->m_ParzenWindowMutualInformationThreaderParameters ) ) );
+
+  /** Launch. */
+  this->m_Threader->SingleMethodExecute();
+
+} // end LaunchComputeDerivativeSparseThreaderCallback()
+
+
 /**
  * ******************* ComputeValueAndPRatioArray *******************
  */
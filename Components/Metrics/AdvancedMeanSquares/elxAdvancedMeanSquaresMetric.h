@@ -140,12 +140,11 @@ public:
    */
   void Initialize( void ) override;
 
-  /**
-   * Do some things before each resolution:
-   * \li Set CheckNumberOfSamples setting
-   * \li Set UseNormalization setting
+  /** The settings are only read in ReadAdvancedMetricParameters(), so
+   * this metric can be copied by CreateCostFunctionContext().
    */
-  void BeforeEachResolution( void ) override;
+  bool SupportsCostFunctionContexts( void ) const override
+  { return true; }
 
 protected:
 
@@ -154,6 +153,13 @@ protected:
   /** The destructor. */
   ~AdvancedMeanSquaresMetric() override {}
 
+  /**
+   * Read the settings before each resolution:
+   * \li Set CheckNumberOfSamples setting
+   * \li Set UseNormalization setting
+   */
+  void ReadAdvancedMetricParameters( void ) override;
+
 private:
 
   /** The private constructor. */
@@ -44,14 +44,17 @@ AdvancedMeanSquaresMetric< TElastix >
 
 
 /**
- * ***************** BeforeEachResolution ***********************
+ * ***************** ReadAdvancedMetricParameters ***********************
  */
 
 template< class TElastix >
 void
 AdvancedMeanSquaresMetric< TElastix >
-::BeforeEachResolution( void )
+::ReadAdvancedMetricParameters( void )
 {
+  /** Read the settings of all advanced metrics. */
+  this->Superclass2::ReadAdvancedMetricParameters();
+
   /** Get the current resolution level. */
   unsigned int level
     = ( this->m_Registration->GetAsITKBaseType() )->GetCurrentLevel();
@@ -89,7 +92,7 @@ AdvancedMeanSquaresMetric< TElastix >
     this->SetUseOpenMP( true );
   }
 
-} // end BeforeEachResolution()
+} // end ReadAdvancedMetricParameters()
 
 
 } // end namespace elastix
@@ -108,6 +108,7 @@ public:
   typedef typename Superclass::ImageSamplerType           ImageSamplerType;
   typedef typename Superclass::ImageSamplerPointer        ImageSamplerPointer;
   typedef typename Superclass::ImageSampleContainerType   ImageSampleContainerType;
+  typedef typename ImageSamplerType::ImageSampleGridType  ImageSampleGridType;
   typedef typename
     Superclass::ImageSampleContainerPointer ImageSampleContainerPointer;
   typedef typename Superclass::FixedImageLimiterType  FixedImageLimiterType;
@@ -237,6 +238,26 @@ protected:
     const NonZeroJacobianIndicesType & nzji,
     HessianType & H ) const;
 
+  /** This metric can iterate over the sample grid of the full and grid samplers. */
+  bool SupportsLazyImageSampling( void ) const override
+  {
+    return true;
+  }
+
+
+  /** Accumulate the measure over the samples [fbegin, fend). The iterator is
+   * either an ImageSampleContainer::ConstIterator or an
+   * ImageSampleGrid::ConstIterator. */
+  template< class TSampleIterator >
+  void AccumulateValue( TSampleIterator fbegin, TSampleIterator fend,
+    MeasureType & measure, unsigned long & numberOfPixelsCounted ) const;
+
+  /** Accumulate the measure and derivative over the samples [fbegin, fend). */
+  template< class TSampleIterator >
+  void AccumulateValueAndDerivative( TSampleIterator fbegin, TSampleIterator fend,
+    MeasureType & measure, DerivativeType & derivative,
+    unsigned long & numberOfPixelsCounted ) const;
+
   /** Get value for each thread. */
   inline void ThreadedGetValue( ThreadIdType threadID ) override;
 
@@ -174,43 +174,18 @@ AdvancedMeanSquaresImageToImageMetric< TFixedImage, TMovingImage >
 
 
 /**
- * ******************* GetValueSingleThreaded *******************
+ * ******************* AccumulateValue *******************
  */
 
 template< class TFixedImage, class TMovingImage >
-typename AdvancedMeanSquaresImageToImageMetric< TFixedImage, TMovingImage >::MeasureType
+template< class TSampleIterator >
+void
 AdvancedMeanSquaresImageToImageMetric< TFixedImage, TMovingImage >
-::GetValueSingleThreaded( const TransformParametersType & parameters ) const
+::AccumulateValue( TSampleIterator fbegin, TSampleIterator fend,
+  MeasureType & measure, unsigned long & numberOfPixelsCounted ) const
 {
-  /** Initialize some variables. */
-  this->m_NumberOfPixelsCounted = 0;
-  MeasureType measure = NumericTraits< MeasureType >::Zero;
-
-  /** Call non-thread-safe stuff, such as:
-   *   this->SetTransformParameters( parameters );
-   *   this->GetImageSampler()->Update();
-   * Because of these calls GetValueAndDerivative itself is not thread-safe,
-   * so cannot be called multiple times simultaneously.
-   * This is however needed in the CombinationImageToImageMetric.
-   * In that case, you need to:
-   * - switch the use of this function to on, using m_UseMetricSingleThreaded = true
-   * - call BeforeThreadedGetValueAndDerivative once (single-threaded) before
-   *   calling GetValueAndDerivative
-   * - switch the use of this function to off, using m_UseMetricSingleThreaded = false
-   * - Now you can call GetValueAndDerivative multi-threaded.
-   */
-  this->BeforeThreadedGetValueAndDerivative( parameters );
-
-  /** Get a handle to the sample container. */
-  ImageSampleContainerPointer sampleContainer = this->GetImageSampler()->GetOutput();
-
-  /** Create iterator over the sample container. */
-  typename ImageSampleContainerType::ConstIterator fiter;
-  typename ImageSampleContainerType::ConstIterator fbegin = sampleContainer->Begin();
-  typename ImageSampleContainerType::ConstIterator fend   = sampleContainer->End();
-
   /** Loop over the fixed image samples to calculate the mean squares. */
-  for( fiter = fbegin; fiter != fend; ++fiter )
+  for( TSampleIterator fiter = fbegin; fiter != fend; ++fiter )
   {
     /** Read fixed coordinates and initialize some variables. */
     const FixedImagePointType & fixedPoint = ( *fiter ).Value().m_ImageCoordinates;
@@ -218,7 +193,8 @@ AdvancedMeanSquaresImageToImageMetric< TFixedImage, TMovingImage >
     MovingImagePointType        mappedPoint;
 
     /** Transform point and check if it is inside the B-spline support region. */
-    bool sampleOk = this->TransformPoint( fixedPoint, mappedPoint );
+    const SizeValueType samplePosition = this->GetSamplePosition( fiter );
+    bool                sampleOk       = this->TransformSamplePoint( samplePosition, fixedPoint, mappedPoint );
 
     /** Check if point is inside mask. */
     if( sampleOk )
@@ -226,8 +202,8 @@ AdvancedMeanSquaresImageToImageMetric< TFixedImage, TMovingImage >
       sampleOk = this->IsInsideMovingMask( mappedPoint );
     }
 
-    /** Compute the moving image value and check if the point is
-     * inside the moving image buffer.
+    /** Compute the moving image value M(T(x)) and check if
+     * the point is inside the moving image buffer.
      */
     if( sampleOk )
     {
@@ -237,10 +213,11 @@ AdvancedMeanSquaresImageToImageMetric< TFixedImage, TMovingImage >
 
     if( sampleOk )
     {
-      this->m_NumberOfPixelsCounted++;
+      numberOfPixelsCounted++;
 
       /** Get the fixed image value. */
-      const RealType & fixedImageValue = static_cast< double >( ( *fiter ).Value().m_ImageValue );
+      const RealType & fixedImageValue
+        = static_cast< RealType >( ( *fiter ).Value().m_ImageValue );
 
       /** The difference squared. */
       const RealType diff = movingImageValue - fixedImageValue;
@@ -250,9 +227,138 @@ AdvancedMeanSquaresImageToImageMetric< TFixedImage, TMovingImage >
 
   } // end for loop over the image sample container
 
+} // end AccumulateValue()
+
+
+/**
+ * ******************* AccumulateValueAndDerivative *******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+template< class TSampleIterator >
+void
+AdvancedMeanSquaresImageToImageMetric< TFixedImage, TMovingImage >
+::AccumulateValueAndDerivative( TSampleIterator fbegin, TSampleIterator fend,
+  MeasureType & measure, DerivativeType & derivative,
+  unsigned long & numberOfPixelsCounted ) const
+{
+  /** Initialize array that stores dM(x)/dmu, and the sparse Jacobian + indices. */
+  const NumberOfParametersType nnzji = this->m_AdvancedTransform->GetNumberOfNonZeroJacobianIndices();
+  NonZeroJacobianIndicesType   nzji  = NonZeroJacobianIndicesType( nnzji );
+  DerivativeType               imageJacobian( nnzji );
+
+  /** Loop over the fixed image samples to calculate the mean squares. */
+  for( TSampleIterator fiter = fbegin; fiter != fend; ++fiter )
+  {
+    /** Read fixed coordinates and initialize some variables. */
+    const FixedImagePointType & fixedPoint = ( *fiter ).Value().m_ImageCoordinates;
+    RealType                    movingImageValue;
+    MovingImagePointType        mappedPoint;
+    MovingImageDerivativeType   movingImageDerivative;
+
+    /** Transform point and check if it is inside the B-spline support region. */
+    const SizeValueType samplePosition = this->GetSamplePosition( fiter );
+    bool                sampleOk       = this->TransformSamplePoint( samplePosition, fixedPoint, mappedPoint );
+
+    /** Check if point is inside mask. */
+    if( sampleOk )
+    {
+      sampleOk = this->IsInsideMovingMask( mappedPoint );
+    }
+
+    /** Compute the moving image value M(T(x)) and derivative dM/dx and check if
+     * the point is inside the moving image buffer.
+     */
+    if( sampleOk )
+    {
+      sampleOk = this->EvaluateMovingImageValueAndDerivative(
+        mappedPoint, movingImageValue, &movingImageDerivative );
+    }
+
+    if( sampleOk )
+    {
+      numberOfPixelsCounted++;
+
+      /** Get the fixed image value. */
+      const RealType & fixedImageValue
+        = static_cast< RealType >( ( *fiter ).Value().m_ImageValue );
+
+#if 0
+      /** Get the TransformJacobian dT/dmu. */
+      this->EvaluateTransformJacobian( fixedPoint, jacobian, nzji );
+
+      /** Compute the inner products (dM/dx)^T (dT/dmu). */
+      this->EvaluateTransformJacobianInnerProduct(
+        jacobian, movingImageDerivative, imageJacobian );
+#else
+      /** Compute the inner product of the transform Jacobian dT/dmu and the moving image gradient dM/dx. */
+      this->EvaluateSampleJacobianWithImageGradientProduct( samplePosition,
+        fixedPoint, movingImageDerivative, imageJacobian, nzji );
+#endif
+
+      /** Compute this pixel's contribution to the measure and derivatives. */
+      this->UpdateValueAndDerivativeTerms(
+        fixedImageValue, movingImageValue,
+        imageJacobian, nzji,
+        measure, derivative );
+
+    } // end if sampleOk
+
+  } // end for loop over the image sample container
+
+} // end AccumulateValueAndDerivative()
+
+
+/**
+ * ******************* GetValueSingleThreaded *******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+typename AdvancedMeanSquaresImageToImageMetric< TFixedImage, TMovingImage >::MeasureType
+AdvancedMeanSquaresImageToImageMetric< TFixedImage, TMovingImage >
+::GetValueSingleThreaded( const TransformParametersType & parameters ) const
+{
+  /** Initialize some variables. */
+  this->m_NumberOfPixelsCounted = 0;
+  MeasureType measure = NumericTraits< MeasureType >::Zero;
+
+  /** Call non-thread-safe stuff, such as:
+   *   this->SetTransformParameters( parameters );
+   *   this->GetImageSampler()->Update();
+   * Because of these calls GetValueAndDerivative itself is not thread-safe,
+   * so cannot be called multiple times simultaneously.
+   * This is however needed in the CombinationImageToImageMetric.
+   * In that case, you need to:
+   * - switch the use of this function to on, using m_UseMetricSingleThreaded = true
+   * - call BeforeThreadedGetValueAndDerivative once (single-threaded) before
+   *   calling GetValueAndDerivative
+   * - switch the use of this function to off, using m_UseMetricSingleThreaded = false
+   * - Now you can call GetValueAndDerivative multi-threaded.
+   */
+  this->BeforeThreadedGetValueAndDerivative( parameters );
+
+  /** Loop over the fixed image samples to calculate the mean squares. */
+  unsigned long numberOfPixelsCounted = 0;
+  if( this->IsImageSampleGridUsed() )
+  {
+    const ImageSampleGridType & sampleGrid = this->GetImageSampler()->GetSampleGrid();
+    const SizeValueType         numberOfGridPoints = sampleGrid.GetNumberOfGridPoints();
+    this->AccumulateValue( sampleGrid.Begin( 0, numberOfGridPoints ),
+      sampleGrid.End( numberOfGridPoints ), measure, numberOfPixelsCounted );
+  }
+  else
+  {
+    ImageSampleContainerPointer sampleContainer = this->GetImageSampler()->GetOutput();
+    const typename ImageSampleContainerType::ConstIterator fbegin = sampleContainer->Begin();
+    const typename ImageSampleContainerType::ConstIterator fend   = sampleContainer->End();
+    this->AccumulateValue( fbegin, fend,
+      measure, numberOfPixelsCounted );
+  }
+  this->m_NumberOfPixelsCounted = numberOfPixelsCounted;
+
   /** Check if enough samples were valid. */
   this->CheckNumberOfSamples(
-    sampleContainer->Size(), this->m_NumberOfPixelsCounted );
+    this->GetNumberOfFixedImageSamples(), this->m_NumberOfPixelsCounted );
 
   /** Update measure value. */
   double normal_sum = 0.0;
@@ -319,9 +425,8 @@ void
 AdvancedMeanSquaresImageToImageMetric< TFixedImage, TMovingImage >
 ::ThreadedGetValue( ThreadIdType threadId )
 {
-  /** Get a handle to the sample container. */
-  ImageSampleContainerPointer sampleContainer     = this->GetImageSampler()->GetOutput();
-  const unsigned long         sampleContainerSize = sampleContainer->Size();
+  /** Get the number of sample positions. */
+  const unsigned long sampleContainerSize = this->GetNumberOfFixedImageSamplePositions();
 
   /** Get the samples for this thread. */
   const unsigned long nrOfSamplesPerThreads
@@ -333,59 +438,26 @@ AdvancedMeanSquaresImageToImageMetric< TFixedImage, TMovingImage >
   pos_begin = ( pos_begin > sampleContainerSize ) ? sampleContainerSize : pos_begin;
   pos_end   = ( pos_end > sampleContainerSize ) ? sampleContainerSize : pos_end;
 
-  /** Create iterator over the sample container. */
-  typename ImageSampleContainerType::ConstIterator threader_fiter;
-  typename ImageSampleContainerType::ConstIterator threader_fbegin = sampleContainer->Begin();
-  typename ImageSampleContainerType::ConstIterator threader_fend   = sampleContainer->Begin();
-
-  threader_fbegin += (int)pos_begin;
-  threader_fend   += (int)pos_end;
-
   /** Create variables to store intermediate results. circumvent false sharing */
   unsigned long numberOfPixelsCounted = 0;
   MeasureType   measure               = NumericTraits< MeasureType >::Zero;
 
   /** Loop over the fixed image to calculate the mean squares. */
-  for( threader_fiter = threader_fbegin; threader_fiter != threader_fend; ++threader_fiter )
+  if( this->IsImageSampleGridUsed() )
   {
-    /** Read fixed coordinates and initialize some variables. */
-    const FixedImagePointType & fixedPoint = ( *threader_fiter ).Value().m_ImageCoordinates;
-    RealType                    movingImageValue;
-    MovingImagePointType        mappedPoint;
-
-    /** Transform point and check if it is inside the B-spline support region. */
-    bool sampleOk = this->TransformPoint( fixedPoint, mappedPoint );
-
-    /** Check if point is inside mask. */
-    if( sampleOk )
-    {
-      sampleOk = this->IsInsideMovingMask( mappedPoint ); // thread-safe?
-    }
-
-    /** Compute the moving image value M(T(x)) and check if
-     * the point is inside the moving image buffer.
-     */
-    if( sampleOk )
-    {
-      sampleOk = this->EvaluateMovingImageValueAndDerivative(
-        mappedPoint, movingImageValue, 0 );
-    }
-
-    if( sampleOk )
-    {
-      numberOfPixelsCounted++;
-
-      /** Get the fixed image value. */
-      const RealType & fixedImageValue
-        = static_cast< RealType >( ( *threader_fiter ).Value().m_ImageValue );
-
-      /** The difference squared. */
-      const RealType diff = movingImageValue - fixedImageValue;
-      measure += diff * diff;
-
-    } // end if sampleOk
-
-  } // end for loop over the image sample container
+    const ImageSampleGridType & sampleGrid = this->GetImageSampler()->GetSampleGrid();
+    this->AccumulateValue( sampleGrid.Begin( pos_begin, pos_end ),
+      sampleGrid.End( pos_end ), measure, numberOfPixelsCounted );
+  }
+  else
+  {
+    ImageSampleContainerPointer sampleContainer = this->GetImageSampler()->GetOutput();
+    typename ImageSampleContainerType::ConstIterator threader_fbegin = sampleContainer->Begin();
+    typename ImageSampleContainerType::ConstIterator threader_fend   = sampleContainer->Begin();
+    threader_fbegin += (int)pos_begin;
+    threader_fend   += (int)pos_end;
+    this->AccumulateValue( threader_fbegin, threader_fend, measure, numberOfPixelsCounted );
+  }
 
   /** Only update these variables at the end to prevent unnecessary "false sharing". */
   this->m_GetValueAndDerivativePerThreadVariables[ threadId ].st_NumberOfPixelsCounted = numberOfPixelsCounted;
@@ -416,9 +488,8 @@ AdvancedMeanSquaresImageToImageMetric< TFixedImage, TMovingImage >
   }
 
   /** Check if enough samples were valid. */
-  ImageSampleContainerPointer sampleContainer = this->GetImageSampler()->GetOutput();
   this->CheckNumberOfSamples(
-    sampleContainer->Size(), this->m_NumberOfPixelsCounted );
+    this->GetNumberOfFixedImageSamples(), this->m_NumberOfPixelsCounted );
 
   /** The normalization factor. */
   DerivativeValueType normal_sum = this->m_NormalizationFactor
@@ -479,12 +550,6 @@ AdvancedMeanSquaresImageToImageMetric< TFixedImage, TMovingImage >
   derivative = DerivativeType( this->GetNumberOfParameters() );
   derivative.Fill( NumericTraits< DerivativeValueType >::ZeroValue() );
 
-  /** Array that stores dM(x)/dmu, and the sparse jacobian+indices. */
-  NonZeroJacobianIndicesType nzji(
-    this->m_AdvancedTransform->GetNumberOfNonZeroJacobianIndices() );
-  DerivativeType        imageJacobian( nzji.size() );
-  TransformJacobianType jacobian;
-
   /** Call non-thread-safe stuff, such as:
    *   this->SetTransformParameters( parameters );
    *   this->GetImageSampler()->Update();
@@ -500,76 +565,28 @@ AdvancedMeanSquaresImageToImageMetric< TFixedImage, TMovingImage >
    */
   this->BeforeThreadedGetValueAndDerivative( parameters );
 
-  /** Get a handle to the sample container. */
-  ImageSampleContainerPointer sampleContainer = this->GetImageSampler()->GetOutput();
-
-  /** Create iterator over the sample container. */
-  typename ImageSampleContainerType::ConstIterator fiter;
-  typename ImageSampleContainerType::ConstIterator fbegin = sampleContainer->Begin();
-  typename ImageSampleContainerType::ConstIterator fend   = sampleContainer->End();
-
   /** Loop over the fixed image to calculate the mean squares. */
-  for( fiter = fbegin; fiter != fend; ++fiter )
+  unsigned long numberOfPixelsCounted = 0;
+  if( this->IsImageSampleGridUsed() )
   {
-    /** Read fixed coordinates and initialize some variables. */
-    const FixedImagePointType & fixedPoint = ( *fiter ).Value().m_ImageCoordinates;
-    RealType                    movingImageValue;
-    MovingImagePointType        mappedPoint;
-    MovingImageDerivativeType   movingImageDerivative;
-
-    /** Transform point and check if it is inside the B-spline support region. */
-    bool sampleOk = this->TransformPoint( fixedPoint, mappedPoint );
-
-    /** Check if point is inside mask. */
-    if( sampleOk )
-    {
-      sampleOk = this->IsInsideMovingMask( mappedPoint );
-    }
-
-    /** Compute the moving image value M(T(x)) and derivative dM/dx and check if
-     * the point is inside the moving image buffer.
-     */
-    if( sampleOk )
-    {
-      sampleOk = this->EvaluateMovingImageValueAndDerivative(
-        mappedPoint, movingImageValue, &movingImageDerivative );
-    }
-
-    if( sampleOk )
-    {
-      this->m_NumberOfPixelsCounted++;
-
-      /** Get the fixed image value. */
-      const RealType & fixedImageValue
-        = static_cast< RealType >( ( *fiter ).Value().m_ImageValue );
-
-#if 0
-      /** Get the TransformJacobian dT/dmu. */
-      this->EvaluateTransformJacobian( fixedPoint, jacobian, nzji );
-
-      /** Compute the inner products (dM/dx)^T (dT/dmu). */
-      this->EvaluateTransformJacobianInnerProduct(
-        jacobian, movingImageDerivative, imageJacobian );
-#else
-      /** Compute the inner product of the transform Jacobian and the moving image gradient. */
-      this->m_AdvancedTransform->EvaluateJacobianWithImageGradientProduct(
-        fixedPoint, movingImageDerivative,
-        imageJacobian, nzji );
-#endif
-
-      /** Compute this pixel's contribution to the measure and derivatives. */
-      this->UpdateValueAndDerivativeTerms(
-        fixedImageValue, movingImageValue,
-        imageJacobian, nzji,
-        measure, derivative );
-
-    } // end if sampleOk
-
-  } // end for loop over the image sample container
+    const ImageSampleGridType & sampleGrid = this->GetImageSampler()->GetSampleGrid();
+    const SizeValueType         numberOfGridPoints = sampleGrid.GetNumberOfGridPoints();
+    this->AccumulateValueAndDerivative( sampleGrid.Begin( 0, numberOfGridPoints ),
+      sampleGrid.End( numberOfGridPoints ), measure, derivative, numberOfPixelsCounted );
+  }
+  else
+  {
+    ImageSampleContainerPointer sampleContainer = this->GetImageSampler()->GetOutput();
+    const typename ImageSampleContainerType::ConstIterator fbegin = sampleContainer->Begin();
+    const typename ImageSampleContainerType::ConstIterator fend   = sampleContainer->End();
+    this->AccumulateValueAndDerivative( fbegin, fend,
+      measure, derivative, numberOfPixelsCounted );
+  }
+  this->m_NumberOfPixelsCounted = numberOfPixelsCounted;
 
   /** Check if enough samples were valid. */
   this->CheckNumberOfSamples(
-    sampleContainer->Size(), this->m_NumberOfPixelsCounted );
+    this->GetNumberOfFixedImageSamples(), this->m_NumberOfPixelsCounted );
 
   /** Compute the measure value and derivative. */
   double normal_sum = 0.0;
@@ -638,11 +655,6 @@ void
 AdvancedMeanSquaresImageToImageMetric< TFixedImage, TMovingImage >
 ::ThreadedGetValueAndDerivative( ThreadIdType threadId )
 {
-  /** Initialize array that stores dM(x)/dmu, and the sparse Jacobian + indices. */
-  const NumberOfParametersType nnzji = this->m_AdvancedTransform->GetNumberOfNonZeroJacobianIndices();
-  NonZeroJacobianIndicesType   nzji  = NonZeroJacobianIndicesType( nnzji );
-  DerivativeType               imageJacobian( nnzji );
-
   /** Get a handle to the pre-allocated derivative for the current thread.
    * The initialization is performed at the beginning of each resolution in
    * InitializeThreadingParameters(), and at the end of each iteration in
@@ -650,9 +662,8 @@ AdvancedMeanSquaresImageToImageMetric< TFixedImage, TMovingImage >
    */
   DerivativeType & derivative = this->m_GetValueAndDerivativePerThreadVariables[ threadId ].st_Derivative;
 
-  /** Get a handle to the sample container. */
-  ImageSampleContainerPointer sampleContainer     = this->GetImageSampler()->GetOutput();
-  const unsigned long         sampleContainerSize = sampleContainer->Size();
+  /** Get the number of sample positions. */
+  const unsigned long sampleContainerSize = this->GetNumberOfFixedImageSamplePositions();
 
   /** Get the samples for this thread. */
   const unsigned long nrOfSamplesPerThreads
@@ -664,75 +675,27 @@ AdvancedMeanSquaresImageToImageMetric< TFixedImage, TMovingImage >
   pos_begin = ( pos_begin > sampleContainerSize ) ? sampleContainerSize : pos_begin;
   pos_end   = ( pos_end > sampleContainerSize ) ? sampleContainerSize : pos_end;
 
-  /** Create iterator over the sample container. */
-  typename ImageSampleContainerType::ConstIterator threader_fiter;
-  typename ImageSampleContainerType::ConstIterator threader_fbegin = sampleContainer->Begin();
-  typename ImageSampleContainerType::ConstIterator threader_fend   = sampleContainer->Begin();
-
-  threader_fbegin += (int)pos_begin;
-  threader_fend   += (int)pos_end;
-
   /** Create variables to store intermediate results. circumvent false sharing */
   unsigned long numberOfPixelsCounted = 0;
   MeasureType   measure               = NumericTraits< MeasureType >::Zero;
 
   /** Loop over the fixed image to calculate the mean squares. */
-  for( threader_fiter = threader_fbegin; threader_fiter != threader_fend; ++threader_fiter )
+  if( this->IsImageSampleGridUsed() )
   {
-    /** Read fixed coordinates and initialize some variables. */
-    const FixedImagePointType & fixedPoint = ( *threader_fiter ).Value().m_ImageCoordinates;
-    RealType                    movingImageValue;
-    MovingImagePointType        mappedPoint;
-    MovingImageDerivativeType   movingImageDerivative;
-
-    /** Transform point and check if it is inside the B-spline support region. */
-    bool sampleOk = this->TransformPoint( fixedPoint, mappedPoint );
-
-    /** Check if point is inside mask. */
-    if( sampleOk )
-    {
-      sampleOk = this->IsInsideMovingMask( mappedPoint ); // thread-safe?
-    }
-
-    /** Compute the moving image value M(T(x)) and derivative dM/dx and check if
-     * the point is inside the moving image buffer.
-     */
-    if( sampleOk )
-    {
-      sampleOk = this->EvaluateMovingImageValueAndDerivative(
-        mappedPoint, movingImageValue, &movingImageDerivative );
-    }
-
-    if( sampleOk )
-    {
-      numberOfPixelsCounted++;
-
-      /** Get the fixed image value. */
-      const RealType & fixedImageValue
-        = static_cast< RealType >( ( *threader_fiter ).Value().m_ImageValue );
-
-#if 0
-      /** Get the TransformJacobian dT/dmu. */
-      this->EvaluateTransformJacobian( fixedPoint, jacobian, nzji );
-
-      /** Compute the inner products (dM/dx)^T (dT/dmu). */
-      this->EvaluateTransformJacobianInnerProduct(
-        jacobian, movingImageDerivative, imageJacobian );
-#else
-      /** Compute the inner product of the transform Jacobian dT/dmu and the moving image gradient dM/dx. */
-      this->m_AdvancedTransform->EvaluateJacobianWithImageGradientProduct(
-        fixedPoint, movingImageDerivative, imageJacobian, nzji );
-#endif
-
-      /** Compute this pixel's contribution to the measure and derivatives. */
-      this->UpdateValueAndDerivativeTerms(
-        fixedImageValue, movingImageValue,
-        imageJacobian, nzji,
-        measure, derivative );
-
-    } // end if sampleOk
-
-  } // end for loop over the image sample container
+    const ImageSampleGridType & sampleGrid = this->GetImageSampler()->GetSampleGrid();
+    this->AccumulateValueAndDerivative( sampleGrid.Begin( pos_begin, pos_end ),
+      sampleGrid.End( pos_end ), measure, derivative, numberOfPixelsCounted );
+  }
+  else
+  {
+    ImageSampleContainerPointer sampleContainer = this->GetImageSampler()->GetOutput();
+    typename ImageSampleContainerType::ConstIterator threader_fbegin = sampleContainer->Begin();
+    typename ImageSampleContainerType::ConstIterator threader_fend   = sampleContainer->Begin();
+    threader_fbegin += (int)pos_begin;
+    threader_fend   += (int)pos_end;
+    this->AccumulateValueAndDerivative( threader_fbegin, threader_fend,
+      measure, derivative, numberOfPixelsCounted );
+  }
 
   /** Only update these variables at the end to prevent unnecessary "false sharing". */
   this->m_GetValueAndDerivativePerThreadVariables[ threadId ].st_NumberOfPixelsCounted = numberOfPixelsCounted;
@@ -764,9 +727,8 @@ AdvancedMeanSquaresImageToImageMetric< TFixedImage, TMovingImage >
   }
 
   /** Check if enough samples were valid. */
-  ImageSampleContainerPointer sampleContainer = this->GetImageSampler()->GetOutput();
   this->CheckNumberOfSamples(
-    sampleContainer->Size(), this->m_NumberOfPixelsCounted );
+    this->GetNumberOfFixedImageSamples(), this->m_NumberOfPixelsCounted );
 
   /** The normalization factor. */
   DerivativeValueType normal_sum = this->m_NormalizationFactor
@@ -134,17 +134,17 @@ public:
   typedef typename Superclass2::RegistrationPointer  RegistrationPointer;
   typedef typename Superclass2::ITKBaseType          ITKBaseType;
 
-  /** Execute stuff before each new pyramid resolution:
-   * \li Set the flag to subtract the mean.
-   * \li Set the CheckNumberOfSamples setting.
-   */
-  void BeforeEachResolution( void ) override;
-
   /** Sets up a timer to measure the initialization time and
    * calls the Superclass' implementation.
    */
   void Initialize( void ) override;
 
+  /** The settings are only read in ReadAdvancedMetricParameters(), so
+   * this metric can be copied by CreateCostFunctionContext().
+   */
+  bool SupportsCostFunctionContexts( void ) const override
+  { return true; }
+
 protected:
 
   /** The constructor. */
@@ -152,6 +152,12 @@ protected:
   /** The destructor. */
   ~AdvancedNormalizedCorrelationMetric() override {}
 
+  /** Read the settings before each new pyramid resolution:
+   * \li Set the flag to subtract the mean.
+   * \li Set the CheckNumberOfSamples setting.
+   */
+  void ReadAdvancedMetricParameters( void ) override;
+
 private:
 
   /** The private constructor. */
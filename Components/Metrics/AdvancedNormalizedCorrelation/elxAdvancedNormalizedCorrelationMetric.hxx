@@ -25,14 +25,17 @@ namespace elastix
 {
 
 /**
- * ***************** BeforeEachResolution ***********************
+ * ***************** ReadAdvancedMetricParameters ***********************
  */
 
 template< class TElastix >
 void
 AdvancedNormalizedCorrelationMetric< TElastix >
-::BeforeEachResolution( void )
+::ReadAdvancedMetricParameters( void )
 {
+  /** Read the settings of all advanced metrics. */
+  this->Superclass2::ReadAdvancedMetricParameters();
+
   /** Get the current resolution level. */
   unsigned int level
     = ( this->m_Registration->GetAsITKBaseType() )->GetCurrentLevel();
@@ -43,7 +46,7 @@ AdvancedNormalizedCorrelationMetric< TElastix >
     this->GetComponentLabel(), level, 0 );
   this->SetSubtractMean( subtractMean );
 
-} // end BeforeEachResolution()
+} // end ReadAdvancedMetricParameters()
 
 
 /**
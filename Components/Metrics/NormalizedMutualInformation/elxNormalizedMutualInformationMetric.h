@@ -164,17 +164,16 @@ public:
   typedef typename Superclass2::RegistrationPointer  RegistrationPointer;
   typedef typename Superclass2::ITKBaseType          ITKBaseType;
 
-  /** Execute stuff before each new pyramid resolution:
-   * \li Set the number of histogram bins.
-   * \li Set the CheckNumberOfSamples option.
-   * \li Set the fixed/moving LimitRangeRatio
-   * \li Set the fixed/moving limiter. */
-  void BeforeEachResolution( void ) override;
-
   /** Set up a timer to measure the initialization time and
    * call the Superclass' implementation. */
   void Initialize( void ) override;
 
+  /** The settings are only read in ReadAdvancedMetricParameters(), so
+   * this metric can be copied by CreateCostFunctionContext().
+   */
+  bool SupportsCostFunctionContexts( void ) const override
+  { return true; }
+
 protected:
 
   /** The constructor. */
@@ -187,6 +186,13 @@ protected:
   /** The destructor. */
   ~NormalizedMutualInformationMetric() override {}
 
+  /** Read the settings before each new pyramid resolution:
+   * \li Set the number of histogram bins.
+   * \li Set the CheckNumberOfSamples option.
+   * \li Set the fixed/moving LimitRangeRatio
+   * \li Set the fixed/moving limiter. */
+  void ReadAdvancedMetricParameters( void ) override;
+
 private:
 
   /** The private constructor. */
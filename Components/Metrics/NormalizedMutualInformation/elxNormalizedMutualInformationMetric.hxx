@@ -48,14 +48,17 @@ NormalizedMutualInformationMetric< TElastix >
 
 
 /**
- * ***************** BeforeEachResolution ***********************
+ * ***************** ReadAdvancedMetricParameters ***********************
  */
 
 template< class TElastix >
 void
 NormalizedMutualInformationMetric< TElastix >
-::BeforeEachResolution( void )
+::ReadAdvancedMetricParameters( void )
 {
+  /** Read the settings of all advanced metrics. */
+  this->Superclass2::ReadAdvancedMetricParameters();
+
   /** Get the current resolution level. */
   unsigned int level
     = ( this->m_Registration->GetAsITKBaseType() )->GetCurrentLevel();
@@ -102,7 +105,7 @@ NormalizedMutualInformationMetric< TElastix >
   this->SetFixedKernelBSplineOrder( fixedKernelBSplineOrder );
   this->SetMovingKernelBSplineOrder( movingKernelBSplineOrder );
 
-} // end BeforeEachResolution()
+} // end ReadAdvancedMetricParameters()
 
 
 } // end namespace elastix
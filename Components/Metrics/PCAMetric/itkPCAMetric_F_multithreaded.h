@@ -167,6 +167,18 @@ protected:
     const MovingImageDerivativeType & movingImageDerivative,
     DerivativeType & imageJacobian ) const override;
 
+  /** Evaluates the moving image at the samples [begin, end[, at each last
+   * dimension position. The positions are the outer loop, so that
+   * consecutive points are mapped by the same sub-transform of a stack
+   * transform. The samples that are valid at every position are stored in
+   * the first rows of datablock, in their original order, and their fixed
+   * points are appended to approvedSamples. Returns their number. */
+  unsigned int EvaluateSamplesGroupedByLastDimension(
+    const typename ImageSampleContainerType::ConstIterator & begin,
+    const typename ImageSampleContainerType::ConstIterator & end,
+    MatrixType & datablock,
+    std::vector< FixedImagePointType > & approvedSamples ) const;
+
   struct PCAMetricMultiThreaderParameterType
   {
     Self * m_Metric;
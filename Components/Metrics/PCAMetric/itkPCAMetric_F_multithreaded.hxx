@@ -181,72 +181,44 @@ PCAMetric< TFixedImage, TMovingImage >
 
 
 /**
- * ******************* GetValue *******************
+ * ************* EvaluateSamplesGroupedByLastDimension *************
  */
 
 template< class TFixedImage, class TMovingImage >
-typename PCAMetric< TFixedImage, TMovingImage >::MeasureType
+unsigned int
 PCAMetric< TFixedImage, TMovingImage >
-::GetValue( const TransformParametersType & parameters ) const
+::EvaluateSamplesGroupedByLastDimension(
+  const typename ImageSampleContainerType::ConstIterator & begin,
+  const typename ImageSampleContainerType::ConstIterator & end,
+  MatrixType & datablock,
+  std::vector< FixedImagePointType > & approvedSamples ) const
 {
-  itkDebugMacro( "GetValue( " << parameters << " ) " );
-
-  /** Call non-thread-safe stuff, such as:
-   *   this->SetTransformParameters( parameters );
-   *   this->GetImageSampler()->Update();
-   * Because of these calls GetValueAndDerivative itself is not thread-safe,
-   * so cannot be called multiple times simultaneously.
-   * This is however needed in the CombinationImageToImageMetric.
-   * In that case, you need to:
-   * - switch the use of this function to on, using m_UseMetricSingleThreaded = true
-   * - call BeforeThreadedGetValueAndDerivative once (single-threaded) before
-   *   calling GetValueAndDerivative
-   * - switch the use of this function to off, using m_UseMetricSingleThreaded = false
-   * - Now you can call GetValueAndDerivative multi-threaded.
-   */
-  this->BeforeThreadedGetValueAndDerivative( parameters );
-
-  /** Initialize some variables */
-  this->m_NumberOfPixelsCounted = 0;
-  MeasureType measure = NumericTraits< MeasureType >::Zero;
-
-  /** Update the imageSampler and get a handle to the sample container. */
-  ImageSampleContainerPointer sampleContainer = this->GetImageSampler()->GetOutput();
-
-  /** Create iterator over the sample container. */
-  typename ImageSampleContainerType::ConstIterator fiter;
-  typename ImageSampleContainerType::ConstIterator fbegin = sampleContainer->Begin();
-  typename ImageSampleContainerType::ConstIterator fend   = sampleContainer->End();
-
-  /** The rows of the ImageSampleMatrix contain the samples of the images of the stack */
-  const unsigned int numberOfSamples = sampleContainer->Size();
-  MatrixType         datablock( numberOfSamples, this->m_G );
-
-  /** Initialize dummy loop variable */
-  unsigned int pixelIndex = 0;
-
-  /** Initialize image sample matrix . */
-  datablock.fill( itk::NumericTraits< RealType >::Zero );
-
-  for( fiter = fbegin; fiter != fend; ++fiter )
+  /** Transform the sampled points to voxel coordinates. */
+  std::vector< FixedImagePointType >           fixedPoints;
+  std::vector< FixedImageContinuousIndexType > voxelCoords;
+  for( typename ImageSampleContainerType::ConstIterator fiter = begin; fiter != end; ++fiter )
   {
-    /** Read fixed coordinates. */
-    FixedImagePointType fixedPoint = ( *fiter ).Value().m_ImageCoordinates;
-
-    /** Transform sampled point to voxel coordinates. */
     FixedImageContinuousIndexType voxelCoord;
-    this->GetFixedImage()->TransformPhysicalPointToContinuousIndex( fixedPoint, voxelCoord );
-
-    unsigned int numSamplesOk = 0;
+    fixedPoints.push_back( ( *fiter ).Value().m_ImageCoordinates );
+    this->GetFixedImage()->TransformPhysicalPointToContinuousIndex( fixedPoints.back(), voxelCoord );
+    voxelCoords.push_back( voxelCoord );
+  }
+  const std::size_t           numberOfSamples = fixedPoints.size();
+  std::vector< unsigned int > numSamplesOk( numberOfSamples, 0 );
 
-    /** Loop over t */
-    for( unsigned int d = 0; d < this->m_G; ++d )
+  /** Loop over t, and then over the samples, so that consecutive points
+   * are mapped by the same sub-transform of a stack transform. */
+  for( unsigned int d = 0; d < this->m_G; ++d )
+  {
+    for( std::size_t sampleIndex = 0; sampleIndex < numberOfSamples; ++sampleIndex )
     {
       /** Initialize some variables. */
       RealType             movingImageValue;
       MovingImagePointType mappedPoint;
+      FixedImagePointType  fixedPoint;
 
       /** Set fixed point's last dimension to lastDimPosition. */
+      FixedImageContinuousIndexType voxelCoord = voxelCoords[ sampleIndex ];
       voxelCoord[ this->m_LastDimIndex ] = d;
 
       /** Transform sampled point back to world coordinates. */
@@ -269,19 +241,74 @@ PCAMetric< TFixedImage, TMovingImage >
 
       if( sampleOk )
       {
-        numSamplesOk++;
-        datablock( pixelIndex, d ) = movingImageValue;
+        numSamplesOk[ sampleIndex ]++;
+        datablock( sampleIndex, d ) = movingImageValue;
       }
 
-    } /** end loop over t */
+    } // end loop over the samples
+  } // end loop over t
 
-    if( numSamplesOk == this->m_G )
+  /** Keep the samples that are valid for each t, in their original order. */
+  unsigned int pixelIndex = 0;
+  for( std::size_t sampleIndex = 0; sampleIndex < numberOfSamples; ++sampleIndex )
+  {
+    if( numSamplesOk[ sampleIndex ] == this->m_G )
     {
+      datablock.set_row( pixelIndex, datablock.get_row( sampleIndex ) );
+      approvedSamples.push_back( fixedPoints[ sampleIndex ] );
       pixelIndex++;
-      this->m_NumberOfPixelsCounted++;
     }
+  }
+
+  return pixelIndex;
 
-  } /** end first loop over image sample container */
+} // end EvaluateSamplesGroupedByLastDimension()
+
+
+/**
+ * ******************* GetValue *******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+typename PCAMetric< TFixedImage, TMovingImage >::MeasureType
+PCAMetric< TFixedImage, TMovingImage >
+::GetValue( const TransformParametersType & parameters ) const
+{
+  itkDebugMacro( "GetValue( " << parameters << " ) " );
+
+  /** Call non-thread-safe stuff, such as:
+   *   this->SetTransformParameters( parameters );
+   *   this->GetImageSampler()->Update();
+   * Because of these calls GetValueAndDerivative itself is not thread-safe,
+   * so cannot be called multiple times simultaneously.
+   * This is however needed in the CombinationImageToImageMetric.
+   * In that case, you need to:
+   * - switch the use of this function to on, using m_UseMetricSingleThreaded = true
+   * - call BeforeThreadedGetValueAndDerivative once (single-threaded) before
+   *   calling GetValueAndDerivative
+   * - switch the use of this function to off, using m_UseMetricSingleThreaded = false
+   * - Now you can call GetValueAndDerivative multi-threaded.
+   */
+  this->BeforeThreadedGetValueAndDerivative( parameters );
+
+  /** Initialize some variables */
+  this->m_NumberOfPixelsCounted = 0;
+  MeasureType measure = NumericTraits< MeasureType >::Zero;
+
+  /** Update the imageSampler and get a handle to the sample container. */
+  ImageSampleContainerPointer sampleContainer = this->GetImageSampler()->GetOutput();
+
+  /** The rows of the ImageSampleMatrix contain the samples of the images of the stack */
+  const unsigned int numberOfSamples = sampleContainer->Size();
+  MatrixType         datablock( numberOfSamples, this->m_G );
+
+  /** Initialize image sample matrix . */
+  datablock.fill( itk::NumericTraits< RealType >::Zero );
+
+  /** Evaluate the samples at all last dimension positions. */
+  std::vector< FixedImagePointType > SamplesOK;
+  this->m_NumberOfPixelsCounted = this->EvaluateSamplesGroupedByLastDimension(
+    sampleContainer->Begin(), sampleContainer->End(), datablock, SamplesOK );
 
   /** Check if enough samples were valid. */
   this->CheckNumberOfSamples( numberOfSamples, this->m_NumberOfPixelsCounted );
@@ -397,77 +424,17 @@ PCAMetric< TFixedImage, TMovingImage >
 
   ImageSampleContainerPointer sampleContainer = this->GetImageSampler()->GetOutput();
 
-  /** Create iterator over the sample container. */
-  typename ImageSampleContainerType::ConstIterator fiter;
-  typename ImageSampleContainerType::ConstIterator fbegin = sampleContainer->Begin();
-  typename ImageSampleContainerType::ConstIterator fend   = sampleContainer->End();
-
-  std::vector< FixedImagePointType > SamplesOK;
-
   /** The rows of the ImageSampleMatrix contain the samples of the images of the stack */
   const unsigned int numberOfSamples = sampleContainer->Size();
   MatrixType         datablock( numberOfSamples, this->m_G );
 
-  /** Initialize dummy loop variables */
-  unsigned int pixelIndex = 0;
-
   /** Initialize image sample matrix . */
   datablock.fill( itk::NumericTraits< RealType >::Zero );
 
-  for( fiter = fbegin; fiter != fend; ++fiter )
-  {
-    /** Read fixed coordinates. */
-    FixedImagePointType fixedPoint = ( *fiter ).Value().m_ImageCoordinates;
-
-    /** Transform sampled point to voxel coordinates. */
-    FixedImageContinuousIndexType voxelCoord;
-    this->GetFixedImage()->TransformPhysicalPointToContinuousIndex( fixedPoint, voxelCoord );
-
-    unsigned int numSamplesOk = 0;
-
-    /** Loop over t */
-    for( unsigned int d = 0; d < this->m_G; ++d )
-    {
-      /** Initialize some variables. */
-      RealType             movingImageValue;
-      MovingImagePointType mappedPoint;
-
-      /** Set fixed point's last dimension to lastDimPosition. */
-      voxelCoord[ this->m_LastDimIndex ] = d;
-
-      /** Transform sampled point back to world coordinates. */
-      this->GetFixedImage()->TransformContinuousIndexToPhysicalPoint( voxelCoord, fixedPoint );
-
-      /** Transform point and check if it is inside the B-spline support region. */
-      bool sampleOk = this->TransformPoint( fixedPoint, mappedPoint );
-      /** Check if point is inside mask. */
-      if( sampleOk )
-      {
-        sampleOk = this->IsInsideMovingMask( mappedPoint );
-      }
-
-      if( sampleOk )
-
-      {
-        sampleOk = this->EvaluateMovingImageValueAndDerivative(
-          mappedPoint, movingImageValue, 0 );
-      }
-
-      if( sampleOk )
-      {
-        numSamplesOk++;
-        datablock( pixelIndex, d ) = movingImageValue;
-      } // end if sampleOk
-
-    } // end loop over t
-    if( numSamplesOk == this->m_G )
-    {
-      SamplesOK.push_back( fixedPoint );
-      pixelIndex++;
-      this->m_NumberOfPixelsCounted++;
-    }
-
-  } /** end first loop over image sample container */
+  /** Evaluate the samples at all last dimension positions. */
+  std::vector< FixedImagePointType > SamplesOK;
+  this->m_NumberOfPixelsCounted = this->EvaluateSamplesGroupedByLastDimension(
+    sampleContainer->Begin(), sampleContainer->End(), datablock, SamplesOK );
 
   /** Check if enough samples were valid. */
   this->CheckNumberOfSamples( sampleContainer->Size(), this->m_NumberOfPixelsCounted );
@@ -552,17 +519,19 @@ PCAMetric< TFixedImage, TMovingImage >
   DerivativeMatrixType Sv( S * eigenVectorMatrix );
   DerivativeMatrixType vdSdmu_part1( eigenVectorMatrixTranspose * dSdmu_part1 );
 
-  /** Second loop over fixed image samples. */
-  for( pixelIndex = 0; pixelIndex < SamplesOK.size(); ++pixelIndex )
+  /** Transform the approved samples to voxel coordinates. */
+  std::vector< FixedImageContinuousIndexType > voxelCoords( SamplesOK.size() );
+  for( unsigned int i = 0; i < SamplesOK.size(); ++i )
   {
-    /** Read fixed coordinates. */
-    FixedImagePointType fixedPoint = SamplesOK[ pixelIndex ];
-
-    /** Transform sampled point to voxel coordinates. */
-    FixedImageContinuousIndexType voxelCoord;
-    this->GetFixedImage()->TransformPhysicalPointToContinuousIndex( fixedPoint, voxelCoord );
+    this->GetFixedImage()->TransformPhysicalPointToContinuousIndex( SamplesOK[ i ], voxelCoords[ i ] );
+  }
 
-    for( unsigned int d = 0; d < this->m_G; ++d )
+  /** Second loop over fixed image samples. The loop over t is the outer
+   * loop, so that consecutive points are mapped by the same sub-transform
+   * of a stack transform. */
+  for( unsigned int d = 0; d < this->m_G; ++d )
+  {
+    for( unsigned int pixelIndex = 0; pixelIndex < SamplesOK.size(); ++pixelIndex )
     {
       /** Initialize some variables. */
       RealType                  movingImageValue;
@@ -570,9 +539,11 @@ PCAMetric< TFixedImage, TMovingImage >
       MovingImageDerivativeType movingImageDerivative;
 
       /** Set fixed point's last dimension to lastDimPosition. */
+      FixedImageContinuousIndexType voxelCoord = voxelCoords[ pixelIndex ];
       voxelCoord[ this->m_LastDimIndex ] = d;
 
       /** Transform sampled point back to world coordinates. */
+      FixedImagePointType fixedPoint;
       this->GetFixedImage()->TransformContinuousIndexToPhysicalPoint( voxelCoord, fixedPoint );
       this->TransformPoint( fixedPoint, mappedPoint );
 
@@ -599,9 +570,9 @@ PCAMetric< TFixedImage, TMovingImage >
 
       } //end loop over non-zero jacobian indices
 
-    } //end loop over last dimension
+    } // end second for loop over sample container
 
-  } // end second for loop over sample container
+  } //end loop over last dimension
 
   derivative *= -( 2.0 / ( DerivativeValueType( this->m_NumberOfPixelsCounted ) - 1.0 ) ); //normalize
   measure     = this->m_G - sumEigenValuesUsed;
@@ -754,7 +725,6 @@ PCAMetric< TFixedImage, TMovingImage >
   pos_end   = ( pos_end > sampleContainerSize ) ? sampleContainerSize : pos_end;
 
   /** Create iterator over the sample container. */
-  typename ImageSampleContainerType::ConstIterator threader_fiter;
   typename ImageSampleContainerType::ConstIterator threader_fbegin = sampleContainer->Begin();
   typename ImageSampleContainerType::ConstIterator threader_fend   = sampleContainer->Begin();
   threader_fbegin                                                 += (int)pos_begin;
@@ -763,60 +733,9 @@ PCAMetric< TFixedImage, TMovingImage >
   std::vector< FixedImagePointType > SamplesOK;
   MatrixType                         datablock( nrOfSamplesPerThreads, this->m_G );
 
-  unsigned int pixelIndex = 0;
-  for( threader_fiter = threader_fbegin; threader_fiter != threader_fend; ++threader_fiter )
-  {
-    /** Read fixed coordinates. */
-    FixedImagePointType fixedPoint = ( *threader_fiter ).Value().m_ImageCoordinates;
-
-    /** Transform sampled point to voxel coordinates. */
-    FixedImageContinuousIndexType voxelCoord;
-    this->GetFixedImage()->TransformPhysicalPointToContinuousIndex( fixedPoint, voxelCoord );
-
-    unsigned int numSamplesOk = 0;
-
-    /** Loop over t */
-    for( unsigned int d = 0; d < this->m_G; ++d )
-    {
-      /** Initialize some variables. */
-      RealType             movingImageValue;
-      MovingImagePointType mappedPoint;
-
-      /** Set fixed point's last dimension to lastDimPosition. */
-      voxelCoord[ this->m_LastDimIndex ] = d;
-
-      /** Transform sampled point back to world coordinates. */
-      this->GetFixedImage()->TransformContinuousIndexToPhysicalPoint( voxelCoord, fixedPoint );
-
-      /** Transform point and check if it is inside the B-spline support region. */
-      bool sampleOk = this->TransformPoint( fixedPoint, mappedPoint );
-      /** Check if point is inside mask. */
-      if( sampleOk )
-      {
-        sampleOk = this->IsInsideMovingMask( mappedPoint );
-      }
-
-      if( sampleOk )
-
-      {
-        sampleOk = this->EvaluateMovingImageValueAndDerivative(
-          mappedPoint, movingImageValue, 0 );
-      }
-
-      if( sampleOk )
-      {
-        numSamplesOk++;
-        datablock( pixelIndex, d ) = movingImageValue;
-      } // end if sampleOk
-
-    } // end loop over t
-    if( numSamplesOk == m_G )
-    {
-      SamplesOK.push_back( fixedPoint );
-      pixelIndex++;
-    }
-
-  } /** end first loop over image sample container */
+  /** Evaluate the samples at all last dimension positions. */
+  const unsigned int pixelIndex = this->EvaluateSamplesGroupedByLastDimension(
+    threader_fbegin, threader_fend, datablock, SamplesOK );
 
   /** Only update these variables at the end to prevent unnecessary "false sharing". */
   this->m_PCAMetricGetSamplesPerThreadVariables[ threadId ].st_NumberOfPixelsCounted = pixelIndex;
@@ -995,25 +914,30 @@ PCAMetric< TFixedImage, TMovingImage >
   DerivativeType             imageJacobian( this->m_AdvancedTransform->GetNumberOfNonZeroJacobianIndices() );
   NonZeroJacobianIndicesType nzjis( this->m_AdvancedTransform->GetNumberOfNonZeroJacobianIndices() );
 
-  unsigned int dummyindex = 0;
-  /** Second loop over fixed image samples. */
-  for( unsigned int pixelIndex = this->m_PixelStartIndex[ threadId ];
-    pixelIndex < ( this->m_PixelStartIndex[ threadId ] + this->m_PCAMetricGetSamplesPerThreadVariables[ threadId ].st_ApprovedSamples.size() );
-    ++pixelIndex )
+  /** Transform the approved samples to voxel coordinates. */
+  const std::vector< FixedImagePointType > & approvedSamples
+    = this->m_PCAMetricGetSamplesPerThreadVariables[ threadId ].st_ApprovedSamples;
+  std::vector< FixedImageContinuousIndexType > voxelCoords( approvedSamples.size() );
+  for( unsigned int i = 0; i < approvedSamples.size(); ++i )
   {
-    /** Read fixed coordinates. */
-    FixedImagePointType fixedPoint = this->m_PCAMetricGetSamplesPerThreadVariables[ threadId ].st_ApprovedSamples[ dummyindex ];
-
-    /** Transform sampled point to voxel coordinates. */
-    FixedImageContinuousIndexType voxelCoord;
-    this->GetFixedImage()->TransformPhysicalPointToContinuousIndex( fixedPoint, voxelCoord );
+    this->GetFixedImage()->TransformPhysicalPointToContinuousIndex( approvedSamples[ i ], voxelCoords[ i ] );
+  }
 
-    for( unsigned int d = 0; d < this->m_G; ++d )
+  /** Second loop over fixed image samples. The loop over t is the outer
+   * loop, so that consecutive points are mapped by the same sub-transform
+   * of a stack transform. */
+  for( unsigned int d = 0; d < this->m_G; ++d )
+  {
+    for( unsigned int i = 0; i < approvedSamples.size(); ++i )
     {
+      const unsigned int pixelIndex = this->m_PixelStartIndex[ threadId ] + i;
+
       /** Set fixed point's last dimension to lastDimPosition. */
+      FixedImageContinuousIndexType voxelCoord = voxelCoords[ i ];
       voxelCoord[ this->m_LastDimIndex ] = d;
 
       /** Transform sampled point back to world coordinates. */
+      FixedImagePointType fixedPoint;
       this->GetFixedImage()->TransformContinuousIndexToPhysicalPoint( voxelCoord, fixedPoint );
       this->TransformPoint( fixedPoint, mappedPoint );
 
@@ -1039,10 +963,8 @@ PCAMetric< TFixedImage, TMovingImage >
         derivative[ nzjis[ p ] ] += tmp;
       } //end loop over non-zero jacobian indices
 
-    } //end loop over last dimension
-    dummyindex++;
-
-  } // end second for loop over sample container
+    } // end second for loop over sample container
+  } //end loop over last dimension
 
 } // end ThreadedGetValueAndDerivative()
 
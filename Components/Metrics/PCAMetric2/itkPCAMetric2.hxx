@@ -147,90 +147,49 @@ PCAMetric2< TFixedImage, TMovingImage >
 
 
 /**
- * ******************* GetValue *******************
+ * ************* EvaluateSamplesGroupedByLastDimension *************
  */
 
 template< class TFixedImage, class TMovingImage >
-typename PCAMetric2< TFixedImage, TMovingImage >::MeasureType
+unsigned int
 PCAMetric2< TFixedImage, TMovingImage >
-::GetValue( const TransformParametersType & parameters ) const
+::EvaluateSamplesGroupedByLastDimension(
+  const typename ImageSampleContainerType::ConstIterator & begin,
+  const typename ImageSampleContainerType::ConstIterator & end,
+  MatrixType & datablock,
+  std::vector< FixedImagePointType > & approvedSamples ) const
 {
-  itkDebugMacro( "GetValue( " << parameters << " ) " );
-  bool UseGetValueAndDerivative = false;
-
-  if( UseGetValueAndDerivative )
-  {
-    typedef typename DerivativeType::ValueType DerivativeValueType;
-    const unsigned int P               = this->GetNumberOfParameters();
-    MeasureType        dummymeasure    = NumericTraits< MeasureType >::Zero;
-    DerivativeType     dummyderivative = DerivativeType( P );
-    dummyderivative.Fill( NumericTraits< DerivativeValueType >::Zero );
-
-    this->GetValueAndDerivative( parameters, dummymeasure, dummyderivative );
-    return dummymeasure;
-  }
-
-  /** Make sure the transform parameters are up to date. */
-  this->SetTransformParameters( parameters );
-
-  /** Initialize some variables */
-  this->m_NumberOfPixelsCounted = 0;
-  MeasureType measure = NumericTraits< MeasureType >::Zero;
-
-  /** Update the imageSampler and get a handle to the sample container. */
-  this->GetImageSampler()->Update();
-  ImageSampleContainerPointer sampleContainer = this->GetImageSampler()->GetOutput();
-
-  /** Create iterator over the sample container. */
-  typename ImageSampleContainerType::ConstIterator fiter;
-  typename ImageSampleContainerType::ConstIterator fbegin = sampleContainer->Begin();
-  typename ImageSampleContainerType::ConstIterator fend   = sampleContainer->End();
-
   /** Retrieve slowest varying dimension and its size. */
   const unsigned int lastDim = this->GetFixedImage()->GetImageDimension() - 1;
   const unsigned int G       = this->GetFixedImage()->GetLargestPossibleRegion().GetSize( lastDim );
 
-  typedef vnl_matrix< RealType > MatrixType;
-
-  /** The rows of the ImageSampleMatrix contain the samples of the images of the stack */
-  const unsigned int numberOfSamples = sampleContainer->Size();
-  MatrixType         datablock( numberOfSamples, G );
-
-  /** Vector containing last dimension positions to use: initialize on all positions when random sampling turned off. */
-  std::vector< int > lastDimPositions;
-
-  /** Determine random last dimension positions if needed. */
-  for( unsigned int i = 0; i < G; ++i )
+  /** Transform the sampled points to voxel coordinates. */
+  std::vector< FixedImagePointType >           fixedPoints;
+  std::vector< FixedImageContinuousIndexType > voxelCoords;
+  for( typename ImageSampleContainerType::ConstIterator fiter = begin; fiter != end; ++fiter )
   {
-    lastDimPositions.push_back( i );
+    FixedImageContinuousIndexType voxelCoord;
+    fixedPoints.push_back( ( *fiter ).Value().m_ImageCoordinates );
+    this->GetFixedImage()->TransformPhysicalPointToContinuousIndex( fixedPoints.back(), voxelCoord );
+    voxelCoords.push_back( voxelCoord );
   }
+  const std::size_t           numberOfSamples = fixedPoints.size();
+  std::vector< unsigned int > numSamplesOk( numberOfSamples, 0 );
 
-  /** Initialize dummy loop variable */
-  unsigned int pixelIndex = 0;
-
-  /** Initialize image sample matrix . */
-  datablock.fill( itk::NumericTraits< RealType >::Zero );
-
-  for( fiter = fbegin; fiter != fend; ++fiter )
+  /** Loop over t, and then over the samples, so that consecutive points
+   * are mapped by the same sub-transform of a stack transform. */
+  for( unsigned int d = 0; d < G; ++d )
   {
-    /** Read fixed coordinates. */
-    FixedImagePointType fixedPoint = ( *fiter ).Value().m_ImageCoordinates;
-
-    /** Transform sampled point to voxel coordinates. */
-    FixedImageContinuousIndexType voxelCoord;
-    this->GetFixedImage()->TransformPhysicalPointToContinuousIndex( fixedPoint, voxelCoord );
-
-    unsigned int numSamplesOk = 0;
-
-    /** Loop over t */
-    for( unsigned int d = 0; d < G; ++d )
+    for( std::size_t sampleIndex = 0; sampleIndex < numberOfSamples; ++sampleIndex )
     {
       /** Initialize some variables. */
       RealType             movingImageValue;
       MovingImagePointType mappedPoint;
+      FixedImagePointType  fixedPoint;
 
       /** Set fixed point's last dimension to lastDimPosition. */
-      voxelCoord[ lastDim ] = lastDimPositions[ d ];
+      FixedImageContinuousIndexType voxelCoord = voxelCoords[ sampleIndex ];
+      voxelCoord[ lastDim ] = d;
 
       /** Transform sampled point back to world coordinates. */
       this->GetFixedImage()->TransformContinuousIndexToPhysicalPoint( voxelCoord, fixedPoint );
@@ -252,19 +211,80 @@ PCAMetric2< TFixedImage, TMovingImage >
 
       if( sampleOk )
       {
-        numSamplesOk++;
-        datablock( pixelIndex, d ) = movingImageValue;
+        numSamplesOk[ sampleIndex ]++;
+        datablock( sampleIndex, d ) = movingImageValue;
       }
 
-    } /** end loop over t */
+    } // end loop over the samples
+  } // end loop over t
 
-    if( numSamplesOk == G )
+  /** Keep the samples that are valid for each t, in their original order. */
+  unsigned int pixelIndex = 0;
+  for( std::size_t sampleIndex = 0; sampleIndex < numberOfSamples; ++sampleIndex )
+  {
+    if( numSamplesOk[ sampleIndex ] == G )
     {
+      datablock.set_row( pixelIndex, datablock.get_row( sampleIndex ) );
+      approvedSamples.push_back( fixedPoints[ sampleIndex ] );
       pixelIndex++;
-      this->m_NumberOfPixelsCounted++;
     }
+  }
+
+  return pixelIndex;
+
+} // end EvaluateSamplesGroupedByLastDimension()
+
+
+/**
+ * ******************* GetValue *******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+typename PCAMetric2< TFixedImage, TMovingImage >::MeasureType
+PCAMetric2< TFixedImage, TMovingImage >
+::GetValue( const TransformParametersType & parameters ) const
+{
+  itkDebugMacro( "GetValue( " << parameters << " ) " );
+  bool UseGetValueAndDerivative = false;
 
-  } /** end first loop over image sample container */
+  if( UseGetValueAndDerivative )
+  {
+    typedef typename DerivativeType::ValueType DerivativeValueType;
+    const unsigned int P               = this->GetNumberOfParameters();
+    MeasureType        dummymeasure    = NumericTraits< MeasureType >::Zero;
+    DerivativeType     dummyderivative = DerivativeType( P );
+    dummyderivative.Fill( NumericTraits< DerivativeValueType >::Zero );
+
+    this->GetValueAndDerivative( parameters, dummymeasure, dummyderivative );
+    return dummymeasure;
+  }
+
+  /** Make sure the transform parameters are up to date. */
+  this->SetTransformParameters( parameters );
+
+  /** Initialize some variables */
+  this->m_NumberOfPixelsCounted = 0;
+  MeasureType measure = NumericTraits< MeasureType >::Zero;
+
+  /** Update the imageSampler and get a handle to the sample container. */
+  this->GetImageSampler()->Update();
+  ImageSampleContainerPointer sampleContainer = this->GetImageSampler()->GetOutput();
+
+  /** Retrieve slowest varying dimension and its size. */
+  const unsigned int lastDim = this->GetFixedImage()->GetImageDimension() - 1;
+  const unsigned int G       = this->GetFixedImage()->GetLargestPossibleRegion().GetSize( lastDim );
+
+  /** The rows of the ImageSampleMatrix contain the samples of the images of the stack */
+  const unsigned int numberOfSamples = sampleContainer->Size();
+  MatrixType         datablock( numberOfSamples, G );
+
+  /** Initialize image sample matrix . */
+  datablock.fill( itk::NumericTraits< RealType >::Zero );
+
+  /** Evaluate the samples at all last dimension positions. */
+  std::vector< FixedImagePointType > SamplesOK;
+  this->m_NumberOfPixelsCounted = this->EvaluateSamplesGroupedByLastDimension(
+    sampleContainer->Begin(), sampleContainer->End(), datablock, SamplesOK );
 
   /** Check if enough samples were valid. */
   this->CheckNumberOfSamples( numberOfSamples, this->m_NumberOfPixelsCounted );
@@ -388,94 +408,23 @@ PCAMetric2< TFixedImage, TMovingImage >
   this->GetImageSampler()->Update();
   ImageSampleContainerPointer sampleContainer = this->GetImageSampler()->GetOutput();
 
-  /** Create iterator over the sample container. */
-  typename ImageSampleContainerType::ConstIterator fiter;
-  typename ImageSampleContainerType::ConstIterator fbegin = sampleContainer->Begin();
-  typename ImageSampleContainerType::ConstIterator fend   = sampleContainer->End();
-
   /** Retrieve slowest varying dimension and its size. */
   const unsigned int lastDim = this->GetFixedImage()->GetImageDimension() - 1;
   const unsigned int G       = this->GetFixedImage()->GetLargestPossibleRegion().GetSize( lastDim );
 
-  typedef vnl_matrix< RealType >            MatrixType;
   typedef vnl_matrix< DerivativeValueType > DerivativeMatrixType;
 
-  std::vector< FixedImagePointType > SamplesOK;
-
   /** The rows of the ImageSampleMatrix contain the samples of the images of the stack */
   const unsigned int numberOfSamples = sampleContainer->Size();
   MatrixType         datablock( numberOfSamples, G );
 
-  /** Initialize dummy loop variables */
-  unsigned int pixelIndex = 0;
-
   /** Initialize image sample matrix . */
   datablock.fill( itk::NumericTraits< RealType >::Zero );
 
-  /** Determine random last dimension positions if needed. */
-  /** Vector containing last dimension positions to use: initialize on all positions when random sampling turned off. */
-  /** Vector containing last dimension positions to use: initialize on all positions when random sampling turned off. */
-  std::vector< int > lastDimPositions;
-
-  for( unsigned int i = 0; i < G; ++i )
-  {
-    lastDimPositions.push_back( i );
-  }
-
-  for( fiter = fbegin; fiter != fend; ++fiter )
-  {
-    /** Read fixed coordinates. */
-    FixedImagePointType fixedPoint = ( *fiter ).Value().m_ImageCoordinates;
-
-    /** Transform sampled point to voxel coordinates. */
-    FixedImageContinuousIndexType voxelCoord;
-    this->GetFixedImage()->TransformPhysicalPointToContinuousIndex( fixedPoint, voxelCoord );
-
-    unsigned int numSamplesOk = 0;
-
-    /** Loop over t */
-    for( unsigned int d = 0; d < G; ++d )
-    {
-      /** Initialize some variables. */
-      RealType             movingImageValue;
-      MovingImagePointType mappedPoint;
-
-      /** Set fixed point's last dimension to lastDimPosition. */
-      voxelCoord[ lastDim ] = lastDimPositions[ d ];
-
-      /** Transform sampled point back to world coordinates. */
-      this->GetFixedImage()->TransformContinuousIndexToPhysicalPoint( voxelCoord, fixedPoint );
-
-      /** Transform point and check if it is inside the B-spline support region. */
-      bool sampleOk = this->TransformPoint( fixedPoint, mappedPoint );
-
-      /** Check if point is inside mask. */
-      if( sampleOk )
-      {
-        sampleOk = this->IsInsideMovingMask( mappedPoint );
-      }
-
-      if( sampleOk )
-
-      {
-        sampleOk = this->EvaluateMovingImageValueAndDerivative(
-          mappedPoint, movingImageValue, 0 );
-      }
-
-      if( sampleOk )
-      {
-        numSamplesOk++;
-        datablock( pixelIndex, d ) = movingImageValue;
-      } // end if sampleOk
-
-    } // end loop over gradient images
-    if( numSamplesOk == G )
-    {
-      SamplesOK.push_back( fixedPoint );
-      pixelIndex++;
-      this->m_NumberOfPixelsCounted++;
-    }
-  }
+  /** Evaluate the samples at all last dimension positions. */
+  std::vector< FixedImagePointType > SamplesOK;
+  this->m_NumberOfPixelsCounted = this->EvaluateSamplesGroupedByLastDimension(
+    sampleContainer->Begin(), sampleContainer->End(), datablock, SamplesOK );
 
   /** Check if enough samples were valid. */
   this->CheckNumberOfSamples( sampleContainer->Size(), this->m_NumberOfPixelsCounted );
@@ -547,9 +496,6 @@ PCAMetric2< TFixedImage, TMovingImage >
   /** Sub components of metric derivative */
   vnl_diag_matrix< DerivativeValueType > dSdmu_part1( G );
 
-  unsigned int startSamplesOK;
-  startSamplesOK = 0;
-
   for( unsigned int d = 0; d < G; d++ )
   {
     double S_sqr = S( d, d ) * S( d, d );
@@ -562,20 +508,19 @@ PCAMetric2< TFixedImage, TMovingImage >
   DerivativeMatrixType Sv( S * eigenVectorMatrix );
   DerivativeMatrixType vdSdmu_part1( eigenVectorMatrixTranspose * dSdmu_part1 );
 
-  /** Second loop over fixed image samples. */
-  for( pixelIndex = 0; pixelIndex < SamplesOK.size(); ++pixelIndex )
+  /** Transform the approved samples to voxel coordinates. */
+  std::vector< FixedImageContinuousIndexType > voxelCoords( SamplesOK.size() );
+  for( unsigned int i = 0; i < SamplesOK.size(); ++i )
   {
-    /** Read fixed coordinates. */
-    FixedImagePointType fixedPoint = SamplesOK[ startSamplesOK ];
-    startSamplesOK++;
-
-    /** Transform sampled point to voxel coordinates. */
-    FixedImageContinuousIndexType voxelCoord;
-    this->GetFixedImage()->TransformPhysicalPointToContinuousIndex( fixedPoint, voxelCoord );
-
-    const unsigned int G = lastDimPositions.size();
+    this->GetFixedImage()->TransformPhysicalPointToContinuousIndex( SamplesOK[ i ], voxelCoords[ i ] );
+  }
 
-    for( unsigned int d = 0; d < G; ++d )
+  /** Second loop over fixed image samples. The loop over t is the outer
+   * loop, so that consecutive points are mapped by the same sub-transform
+   * of a stack transform. */
+  for( unsigned int d = 0; d < G; ++d )
+  {
+    for( unsigned int pixelIndex = 0; pixelIndex < SamplesOK.size(); ++pixelIndex )
     {
       /** Initialize some variables. */
       RealType                  movingImageValue;
@@ -583,9 +528,11 @@ PCAMetric2< TFixedImage, TMovingImage >
       MovingImageDerivativeType movingImageDerivative;
 
       /** Set fixed point's last dimension to lastDimPosition. */
-      voxelCoord[ lastDim ] = lastDimPositions[ d ];
+      FixedImageContinuousIndexType voxelCoord = voxelCoords[ pixelIndex ];
+      voxelCoord[ lastDim ] = d;
 
       /** Transform sampled point back to world coordinates. */
+      FixedImagePointType fixedPoint;
       this->GetFixedImage()->TransformContinuousIndexToPhysicalPoint( voxelCoord, fixedPoint );
       this->TransformPoint( fixedPoint, mappedPoint );
 
@@ -613,9 +560,9 @@ PCAMetric2< TFixedImage, TMovingImage >
 
       } //end loop over non-zero jacobian indices
 
-    } //end loop over last dimension
+    } // end second for loop over sample container
 
-  } // end second for loop over sample container
+  } //end loop over last dimension
 
   derivative *= ( 2.0 / ( DerivativeValueType( N ) - 1.0 ) ); //normalize
   measure     = sumWeightedEigenValues;
@@ -127,6 +127,8 @@ public:
     Superclass::MovingImageLimiterOutputType MovingImageLimiterOutputType;
   typedef typename
     Superclass::MovingImageDerivativeScalesType MovingImageDerivativeScalesType;
+  typedef typename Superclass::AdvancedTransformType  AdvancedTransformType;
+  typedef typename Superclass::NumberOfParametersType NumberOfParametersType;
 
   /** The fixed image dimension. */
   itkStaticConstMacro( FixedImageDimension, unsigned int,
@@ -182,6 +184,46 @@ protected:
     const MovingImageDerivativeType & movingImageDerivative,
     DerivativeType & imageJacobian ) const override;
 
+  /** The evaluation of a fixed image sample at one last dimension position. */
+  struct LastDimensionSampleType
+  {
+    FixedImagePointType       m_FixedPoint;
+    unsigned int              m_LastDimPosition;
+    bool                      m_IsValid;
+    RealType                  m_MovingImageValue;
+    MovingImageDerivativeType m_MovingImageDerivative;
+  };
+
+  typedef std::vector< LastDimensionSampleType > LastDimensionSampleContainerType;
+
+  /** Evaluates a block of fixed image samples, starting at fiter, at each of
+   * their last dimension positions, and advances fiter past the block. The
+   * evaluations of sample i are stored contiguously, in the order of the
+   * last dimension positions, so that each time series is contiguous. The
+   * evaluations are grouped by last dimension position, which selects the
+   * sub-transform of a stack transform. The groups are distributed over the
+   * work units of threader, or evaluated in the calling thread when threader
+   * is null. Returns the number of evaluations in the block. */
+  std::size_t EvaluateLastDimensionSamples(
+    typename ImageSampleContainerType::ConstIterator & fiter,
+    const typename ImageSampleContainerType::ConstIterator & fend,
+    std::vector< int > & lastDimPositions,
+    LastDimensionSampleContainerType & samples,
+    const bool computeDerivative,
+    MultiThreaderBase * threader ) const;
+
+  /** Adds the variances of the time series in the evaluations [begin, end[
+   * to measure and numberOfPixelsCounted, and, when derivative is not null,
+   * their derivatives to derivative. The transform Jacobian of a stack of
+   * B-spline transforms is computed once per time series, see
+   * m_TransformJacobianIsSharedOverLastDimension. */
+  void AccumulateLastDimensionSamples(
+    const LastDimensionSampleContainerType & samples,
+    const std::size_t begin, const std::size_t end,
+    const unsigned int numberOfLastDimPositions,
+    MeasureType & measure, SizeValueType & numberOfPixelsCounted,
+    DerivativeType * derivative ) const;
+
 private:
 
   VarianceOverLastDimensionImageMetric( const Self & ); // purposely not implemented
@@ -208,6 +250,20 @@ private:
   /** Bool to indicate if the transform used is a stacktransform. Set by elx files. */
   bool m_TransformIsStackTransform;
 
+  /** The sub-transforms of a stack of B-spline transforms with the same grid
+   * have the same Jacobian at the spatial part of a point, so all points of a
+   * time series have the same transform Jacobian, apart from an offset of the
+   * nonzero Jacobian indices per sub-transform. Determined in Initialize().
+   */
+  bool                   m_TransformJacobianIsSharedOverLastDimension;
+  unsigned int           m_NumberOfSubTransforms;
+  NumberOfParametersType m_SubTransformNumberOfParameters;
+  double                 m_StackOrigin;
+  double                 m_StackSpacing;
+
+  /** The sub-transform of the stack transform for a fixed image point. */
+  unsigned int GetSubTransformIndex( const FixedImagePointType & fixedPoint ) const;
+
 };
 
 } // end namespace itk
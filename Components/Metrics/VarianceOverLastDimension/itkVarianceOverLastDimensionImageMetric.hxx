@@ -19,8 +19,12 @@
 #define __itkVarianceOverLastDimensionImageMetric_hxx
 
 #include "itkVarianceOverLastDimensionImageMetric.h"
+#include "itkAdvancedCombinationTransform.h"
 #include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkMultiThreaderBase.h"
+#include "itkStackTransform.h"
 #include "vnl/algo/vnl_matrix_update.h"
+#include <algorithm>
 #include <numeric>
 
 namespace itk
@@ -36,7 +40,12 @@ VarianceOverLastDimensionImageMetric< TFixedImage, TMovingImage >
   m_SampleLastDimensionRandomly( false ),
   m_NumSamplesLastDimension( 10 ),
   m_SubtractMean( false ),
-  m_TransformIsStackTransform( false )
+  m_TransformIsStackTransform( false ),
+  m_TransformJacobianIsSharedOverLastDimension( false ),
+  m_NumberOfSubTransforms( 0 ),
+  m_SubTransformNumberOfParameters( 0 ),
+  m_StackOrigin( 0.0 ),
+  m_StackSpacing( 1.0 )
 {
   this->SetUseImageSampler( true );
   this->SetUseFixedImageLimiter( false );
@@ -108,6 +117,46 @@ VarianceOverLastDimensionImageMetric< TFixedImage, TMovingImage >
     this->m_InitialVariance = sumvar / static_cast< float >( num );
   }
 
+  /** Check if the transform is a stack of B-spline transforms with the same
+   * grid, without initial transform, and if the points of a time series
+   * differ only in their last coordinate. Then all points of a time series
+   * have the same transform Jacobian, apart from the sub-transform offset.
+   */
+  typedef typename AdvancedTransformType::ScalarType                              ScalarType;
+  typedef AdvancedCombinationTransform< ScalarType, FixedImageDimension >         CombinationTransformType;
+  typedef StackTransform< ScalarType, FixedImageDimension, MovingImageDimension > StackTransformType;
+  typedef typename StackTransformType::SubTransformType                           SubTransformType;
+
+  this->m_TransformJacobianIsSharedOverLastDimension = false;
+  StackTransformType *       stackTransform       = dynamic_cast< StackTransformType * >( this->m_AdvancedTransform.GetPointer() );
+  CombinationTransformType * combinationTransform = dynamic_cast< CombinationTransformType * >( this->m_AdvancedTransform.GetPointer() );
+  if( combinationTransform && combinationTransform->GetInitialTransform() == nullptr )
+  {
+    stackTransform = dynamic_cast< StackTransformType * >( combinationTransform->GetModifiableCurrentTransform() );
+  }
+  if( stackTransform && stackTransform->GetNumberOfSubTransforms() > 0 )
+  {
+    const SubTransformType * firstSubTransform = stackTransform->GetSubTransform( 0 ).GetPointer();
+    bool                     isShared          = true;
+    for( unsigned int t = 0; t < stackTransform->GetNumberOfSubTransforms() && isShared; ++t )
+    {
+      const SubTransformType * subTransform = stackTransform->GetSubTransform( t ).GetPointer();
+      isShared = subTransform != nullptr
+        && subTransform->GetTransformCategory() == SubTransformType::BSpline
+        && subTransform->GetFixedParameters() == firstSubTransform->GetFixedParameters();
+    }
+    for( unsigned int d = 0; d < lastDim; ++d )
+    {
+      isShared &= this->GetFixedImage()->GetDirection()[ d ][ lastDim ] == 0.0;
+    }
+
+    this->m_TransformJacobianIsSharedOverLastDimension = isShared;
+    this->m_NumberOfSubTransforms                      = stackTransform->GetNumberOfSubTransforms();
+    this->m_SubTransformNumberOfParameters             = firstSubTransform->GetNumberOfParameters();
+    this->m_StackOrigin                                = stackTransform->GetStackOrigin();
+    this->m_StackSpacing                               = stackTransform->GetStackSpacing();
+  }
+
 } // end Initialize()
 
 
@@ -192,6 +241,246 @@ VarianceOverLastDimensionImageMetric< TFixedImage, TMovingImage >
 } // end EvaluateTransformJacobianInnerProduct()
 
 
+/**
+ * *************** GetSubTransformIndex ****************
+ */
+
+template< class TFixedImage, class TMovingImage >
+unsigned int
+VarianceOverLastDimensionImageMetric< TFixedImage, TMovingImage >
+::GetSubTransformIndex( const FixedImagePointType & fixedPoint ) const
+{
+  /** As in StackTransform::GetJacobian(). */
+  return std::min( this->m_NumberOfSubTransforms - 1, static_cast< unsigned int >(
+    std::max( 0, vnl_math::rnd(
+    ( fixedPoint[ FixedImageDimension - 1 ] - this->m_StackOrigin ) / this->m_StackSpacing ) ) ) );
+
+} // end GetSubTransformIndex()
+
+
+/**
+ * *************** EvaluateLastDimensionSamples ****************
+ */
+
+template< class TFixedImage, class TMovingImage >
+std::size_t
+VarianceOverLastDimensionImageMetric< TFixedImage, TMovingImage >
+::EvaluateLastDimensionSamples(
+  typename ImageSampleContainerType::ConstIterator & fiter,
+  const typename ImageSampleContainerType::ConstIterator & fend,
+  std::vector< int > & lastDimPositions,
+  LastDimensionSampleContainerType & samples,
+  const bool computeDerivative,
+  MultiThreaderBase * threader ) const
+{
+  /** Retrieve slowest varying dimension and its size. */
+  const unsigned int lastDim     = this->GetFixedImage()->GetImageDimension() - 1;
+  const unsigned int lastDimSize = this->GetFixedImage()->GetLargestPossibleRegion().GetSize( lastDim );
+
+  /** The step of a fixed image point along the last dimension. The points
+   * of a time series follow from its first point by this step. */
+  typename FixedImagePointType::VectorType lastDimStep;
+  for( unsigned int d = 0; d < FixedImageDimension; ++d )
+  {
+    lastDimStep[ d ] = this->GetFixedImage()->GetDirection()[ d ][ lastDim ]
+      * this->GetFixedImage()->GetSpacing()[ lastDim ];
+  }
+
+  /** Collect a block of samples, at each of their last dimension positions.
+   * The block is small enough to keep the evaluations in cache. */
+  const std::size_t maximumNumberOfEvaluations = 8192;
+  std::size_t       numberOfEvaluations        = 0;
+  for( ; fiter != fend && numberOfEvaluations < maximumNumberOfEvaluations; ++fiter )
+  {
+    /** Determine random last dimension positions if needed. */
+    if( this->m_SampleLastDimensionRandomly )
+    {
+      this->SampleRandom( this->m_NumSamplesLastDimension, lastDimSize, lastDimPositions );
+    }
+
+    /** Transform sampled point to voxel coordinates, and back to world
+     * coordinates at last dimension position 0. */
+    FixedImageContinuousIndexType voxelCoord;
+    this->GetFixedImage()->TransformPhysicalPointToContinuousIndex(
+      ( *fiter ).Value().m_ImageCoordinates, voxelCoord );
+    voxelCoord[ lastDim ] = 0.0;
+    FixedImagePointType firstPoint;
+    this->GetFixedImage()->TransformContinuousIndexToPhysicalPoint( voxelCoord, firstPoint );
+
+    if( samples.size() < numberOfEvaluations + lastDimPositions.size() )
+    {
+      samples.resize( numberOfEvaluations + lastDimPositions.size() );
+    }
+    for( unsigned int d = 0; d < lastDimPositions.size(); ++d, ++numberOfEvaluations )
+    {
+      /** Set fixed point's last dimension to lastDimPosition. */
+      samples[ numberOfEvaluations ].m_FixedPoint
+        = firstPoint + lastDimStep * static_cast< double >( lastDimPositions[ d ] );
+      samples[ numberOfEvaluations ].m_LastDimPosition = std::min(
+        static_cast< unsigned int >( lastDimPositions[ d ] ), lastDimSize - 1 );
+    }
+  }
+
+  /** Group the evaluations by last dimension position. */
+  std::vector< std::vector< std::size_t > > groups( lastDimSize );
+  for( std::size_t i = 0; i < numberOfEvaluations; ++i )
+  {
+    groups[ samples[ i ].m_LastDimPosition ].push_back( i );
+  }
+
+  /** Evaluate each group in one go, so that consecutive points use the
+   * coefficients of the same sub-transform. The transform Jacobians are
+   * computed per time series, in AccumulateLastDimensionSamples(). */
+  const auto evaluateGroup = [ this, &groups, &samples, computeDerivative ]( SizeValueType t )
+  {
+    MovingImagePointType mappedPoint;
+
+    for( const std::size_t i : groups[ t ] )
+    {
+      LastDimensionSampleType & sample = samples[ i ];
+
+      /** Transform point and check if it is inside the B-spline support region. */
+      bool sampleOk = this->TransformPoint( sample.m_FixedPoint, mappedPoint );
+
+      /** Check if point is inside mask. */
+      if( sampleOk )
+      {
+        sampleOk = this->IsInsideMovingMask( mappedPoint );
+      }
+
+      /** Compute the moving image value and check if the point is
+       * inside the moving image buffer. */
+      if( sampleOk )
+      {
+        sampleOk = this->EvaluateMovingImageValueAndDerivative( mappedPoint,
+          sample.m_MovingImageValue, computeDerivative ? &sample.m_MovingImageDerivative : 0 );
+      }
+
+      sample.m_IsValid = sampleOk;
+    }
+  };
+
+  /** Distribute the groups over the threads, if any. */
+  if( threader != nullptr )
+  {
+    threader->ParallelizeArray( 0, lastDimSize, evaluateGroup, nullptr );
+  }
+  else
+  {
+    for( unsigned int t = 0; t < lastDimSize; ++t )
+    {
+      evaluateGroup( t );
+    }
+  }
+
+  return numberOfEvaluations;
+
+} // end EvaluateLastDimensionSamples()
+
+
+/**
+ * *************** AccumulateLastDimensionSamples ****************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+VarianceOverLastDimensionImageMetric< TFixedImage, TMovingImage >
+::AccumulateLastDimensionSamples(
+  const LastDimensionSampleContainerType & samples,
+  const std::size_t begin, const std::size_t end,
+  const unsigned int numberOfLastDimPositions,
+  MeasureType & measure, SizeValueType & numberOfPixelsCounted,
+  DerivativeType * derivative ) const
+{
+  /** Create variables to store intermediate results. */
+  const NumberOfParametersType nnzji = this->m_AdvancedTransform->GetNumberOfNonZeroJacobianIndices();
+  TransformJacobianType        jacobian;
+  NonZeroJacobianIndicesType   nzji( nnzji );
+  NonZeroJacobianIndicesType   sharedNzji( nnzji );
+  DerivativeType               imageJacobian( nnzji );
+
+  /** Loop over the time series. */
+  for( std::size_t first = begin; first < end; first += numberOfLastDimPositions )
+  {
+    /** Loop over the slowest varying dimension. */
+    float        sumValues        = 0.0;
+    float        sumValuesSquared = 0.0;
+    unsigned int numSamplesOk     = 0;
+    for( unsigned int d = 0; d < numberOfLastDimPositions; ++d )
+    {
+      const LastDimensionSampleType & sample = samples[ first + d ];
+      if( sample.m_IsValid )
+      {
+        numSamplesOk++;
+        sumValues        += sample.m_MovingImageValue;
+        sumValuesSquared += sample.m_MovingImageValue * sample.m_MovingImageValue;
+      }
+    } // end for loop over last dimension
+
+    if( numSamplesOk == 0 )
+    {
+      continue;
+    }
+    numberOfPixelsCounted++;
+
+    /** Add this variance to the variance sum. */
+    const float expectedValue        = sumValues / static_cast< float >( numSamplesOk );
+    const float expectedSquaredValue = sumValuesSquared / static_cast< float >( numSamplesOk );
+    measure += expectedSquaredValue - expectedValue * expectedValue;
+
+    if( derivative == nullptr )
+    {
+      continue;
+    }
+
+    /** Second loop over t: update derivative. */
+    bool         jacobianIsComputed = false;
+    unsigned int sharedSubTransform = 0;
+    for( unsigned int d = 0; d < numberOfLastDimPositions; ++d )
+    {
+      const LastDimensionSampleType & sample = samples[ first + d ];
+      if( !sample.m_IsValid )
+      {
+        continue;
+      }
+
+      /** Get the TransformJacobian dT/dmu, or shift the indices of the shared one. */
+      if( !this->m_TransformJacobianIsSharedOverLastDimension || !jacobianIsComputed )
+      {
+        this->EvaluateTransformJacobian( sample.m_FixedPoint, jacobian, nzji );
+        if( this->m_TransformJacobianIsSharedOverLastDimension )
+        {
+          sharedNzji         = nzji;
+          sharedSubTransform = this->GetSubTransformIndex( sample.m_FixedPoint );
+          jacobianIsComputed = true;
+        }
+      }
+      else
+      {
+        const unsigned int subTransform = this->GetSubTransformIndex( sample.m_FixedPoint );
+        for( unsigned int j = 0; j < nnzji; ++j )
+        {
+          nzji[ j ] = sharedNzji[ j ] - sharedSubTransform * this->m_SubTransformNumberOfParameters
+            + subTransform * this->m_SubTransformNumberOfParameters;
+        }
+      }
+
+      /** Compute the innerproduct (dM/dx)^T (dT/dmu). */
+      this->EvaluateTransformJacobianInnerProduct(
+        jacobian, sample.m_MovingImageDerivative, imageJacobian );
+
+      for( unsigned int j = 0; j < nnzji; ++j )
+      {
+        ( *derivative )[ nzji[ j ] ]
+          += ( 2.0 * ( sample.m_MovingImageValue - expectedValue ) * imageJacobian[ j ] )
+          / static_cast< float >( numSamplesOk );
+      }
+    }
+  }
+
+} // end AccumulateLastDimensionSamples()
+
+
 /**
  * ******************* GetValue *******************
  */
@@ -226,14 +515,12 @@ VarianceOverLastDimensionImageMetric< TFixedImage, TMovingImage >
   ImageSampleContainerPointer sampleContainer = this->GetImageSampler()->GetOutput();
 
   /** Create iterator over the sample container. */
-  typename ImageSampleContainerType::ConstIterator fiter;
-  typename ImageSampleContainerType::ConstIterator fbegin = sampleContainer->Begin();
-  typename ImageSampleContainerType::ConstIterator fend   = sampleContainer->End();
+  typename ImageSampleContainerType::ConstIterator fiter = sampleContainer->Begin();
+  typename ImageSampleContainerType::ConstIterator fend  = sampleContainer->End();
 
   /** Retrieve slowest varying dimension and its size. */
-  const unsigned int lastDim           = this->GetFixedImage()->GetImageDimension() - 1;
-  const unsigned int lastDimSize       = this->GetFixedImage()->GetLargestPossibleRegion().GetSize( lastDim );
-  const unsigned int numLastDimSamples = this->m_NumSamplesLastDimension;
+  const unsigned int lastDim     = this->GetFixedImage()->GetImageDimension() - 1;
+  const unsigned int lastDimSize = this->GetFixedImage()->GetLargestPossibleRegion().GetSize( lastDim );
 
   /** Vector containing last dimension positions to use:
    * initialize on all positions when random sampling turned off.
@@ -247,75 +534,30 @@ VarianceOverLastDimensionImageMetric< TFixedImage, TMovingImage >
     }
   }
 
-  /** Loop over the fixed image samples to calculate the variance over time for every sample position. */
-  for( fiter = fbegin; fiter != fend; ++fiter )
-  {
-    /** Read fixed coordinates. */
-    FixedImagePointType fixedPoint = ( *fiter ).Value().m_ImageCoordinates;
-
-    /** Determine random last dimension positions if needed. */
-    if( this->m_SampleLastDimensionRandomly )
-    {
-      this->SampleRandom( numLastDimSamples, lastDimSize, lastDimPositions );
-    }
-
-    /** Transform sampled point to voxel coordinates. */
-    FixedImageContinuousIndexType voxelCoord;
-    this->GetFixedImage()->TransformPhysicalPointToContinuousIndex( fixedPoint, voxelCoord );
-
-    /** Loop over the slowest varying dimension. */
-    float              sumValues               = 0.0;
-    float              sumValuesSquared        = 0.0;
-    unsigned int       numSamplesOk            = 0;
-    const unsigned int realNumLastDimPositions = lastDimPositions.size();
-    for( unsigned int d = 0; d < realNumLastDimPositions; ++d )
-    {
-      /** Initialize some variables. */
-      RealType             movingImageValue;
-      MovingImagePointType mappedPoint;
-
-      /** Set fixed point's last dimension to lastDimPosition. */
-      voxelCoord[ lastDim ] = lastDimPositions[ d ];
-
-      /** Transform sampled point back to world coordinates. */
-      this->GetFixedImage()->TransformContinuousIndexToPhysicalPoint( voxelCoord, fixedPoint );
-
-      /** Transform point and check if it is inside the B-spline support region. */
-      bool sampleOk = this->TransformPoint( fixedPoint, mappedPoint );
-
-      /** Check if point is inside mask. */
-      if( sampleOk )
-      {
-        sampleOk = this->IsInsideMovingMask( mappedPoint );
-      }
-
-      /** Compute the moving image value and check if the point is
-       * inside the moving image buffer.
-       */
-      if( sampleOk )
-      {
-        sampleOk = this->EvaluateMovingImageValueAndDerivative(
-          mappedPoint, movingImageValue, 0 );
-      }
-
-      if( sampleOk )
-      {
-        numSamplesOk++;
-        sumValues        += movingImageValue;
-        sumValuesSquared += movingImageValue * movingImageValue;
-      } // end if sampleOk
-    } // end for loop over last dimension
+  /** Get real last dim samples. */
+  const unsigned int realNumLastDimPositions
+    = this->m_SampleLastDimensionRandomly
+    ? this->m_NumSamplesLastDimension + this->m_NumAdditionalSamplesFixed
+    : lastDimSize;
 
-    if( numSamplesOk > 0 )
-    {
-      this->m_NumberOfPixelsCounted++;
+  /** The groups of evaluations of a block are divided over the threads. */
+  MultiThreaderBase::Pointer threader;
+  if( this->m_UseMultiThread )
+  {
+    threader = MultiThreaderBase::New();
+    threader->SetNumberOfWorkUnits( Self::GetNumberOfWorkUnits() );
+  }
 
-      /** Add this variance to the variance sum. */
-      const float expectedValue        = sumValues / static_cast< float >( numSamplesOk );
-      const float expectedSquaredValue = sumValuesSquared / static_cast< float >( numSamplesOk );
-      measure += expectedSquaredValue - expectedValue * expectedValue;
-    }
+  /** Loop over blocks of fixed image samples to calculate the variance over time for every sample position. */
+  LastDimensionSampleContainerType samples;
+  while( fiter != fend )
+  {
+    const std::size_t numberOfEvaluations = this->EvaluateLastDimensionSamples(
+      fiter, fend, lastDimPositions, samples, false, threader.GetPointer() );
 
+    /** Add the variances over the last dimension to the measure. */
+    this->AccumulateLastDimensionSamples( samples, 0, numberOfEvaluations,
+      realNumLastDimPositions, measure, this->m_NumberOfPixelsCounted, nullptr );
   } // end for loop over the image sample container
 
   /** Check if enough samples were valid. */
@@ -394,9 +636,8 @@ VarianceOverLastDimensionImageMetric< TFixedImage, TMovingImage >
   ImageSampleContainerPointer sampleContainer = this->GetImageSampler()->GetOutput();
 
   /** Create iterator over the sample container. */
-  typename ImageSampleContainerType::ConstIterator fiter;
-  typename ImageSampleContainerType::ConstIterator fbegin = sampleContainer->Begin();
-  typename ImageSampleContainerType::ConstIterator fend   = sampleContainer->End();
+  typename ImageSampleContainerType::ConstIterator fiter = sampleContainer->Begin();
+  typename ImageSampleContainerType::ConstIterator fend  = sampleContainer->End();
 
   /** Retrieve slowest varying dimension and its size. */
   const unsigned int lastDim = this->GetFixedImage()->GetImageDimension() - 1;
@@ -415,124 +656,76 @@ VarianceOverLastDimensionImageMetric< TFixedImage, TMovingImage >
     }
   }
 
-  /** Create variables to store intermediate results in. */
-  TransformJacobianType jacobian;
-  DerivativeType        imageJacobian( this->m_AdvancedTransform->GetNumberOfNonZeroJacobianIndices() );
-
   /** Get real last dim samples. */
   const unsigned int realNumLastDimPositions
     = this->m_SampleLastDimensionRandomly
     ? this->m_NumSamplesLastDimension + this->m_NumAdditionalSamplesFixed
     : lastDimSize;
 
-  /** Variable to store and nzjis. */
-  std::vector< NonZeroJacobianIndicesType > nzjis(
-  realNumLastDimPositions, NonZeroJacobianIndicesType() );
-
-  std::vector< RealType >       MT( realNumLastDimPositions );
-  std::vector< DerivativeType > dMTdmu( realNumLastDimPositions );
+  /** The time series of a block are divided over the work units, each
+   * accumulating the value and derivative in its own variables.
+   */
+  MultiThreaderBase::Pointer threader;
+  ThreadIdType               numberOfWorkUnits = 1;
+  if( this->m_UseMultiThread )
+  {
+    threader          = MultiThreaderBase::New();
+    numberOfWorkUnits = Self::GetNumberOfWorkUnits();
+    threader->SetNumberOfWorkUnits( numberOfWorkUnits );
+  }
 
-  /** Loop over the fixed image samples to calculate the variance over time for every sample position. */
-  for( fiter = fbegin; fiter != fend; ++fiter )
+  /** Loop over blocks of fixed image samples to calculate the variance over time for every sample position. */
+  LastDimensionSampleContainerType samples;
+  while( fiter != fend )
   {
-    /** Read fixed coordinates. */
-    FixedImagePointType fixedPoint = ( *fiter ).Value().m_ImageCoordinates;
+    /** Compute M(T(x,t)) and dM/dx(T(x,t)) for the block. */
+    const std::size_t numberOfEvaluations = this->EvaluateLastDimensionSamples(
+      fiter, fend, lastDimPositions, samples, true, threader.GetPointer() );
 
-    /** Determine random last dimension positions if needed. */
-    if( this->m_SampleLastDimensionRandomly )
+    if( this->m_UseMultiThread )
     {
-      this->SampleRandom( this->m_NumSamplesLastDimension, lastDimSize, lastDimPositions );
+      const std::size_t numberOfTimeSeries = numberOfEvaluations / realNumLastDimPositions;
+      threader->ParallelizeArray( 0, numberOfWorkUnits,
+        [ this, &samples, numberOfTimeSeries, numberOfWorkUnits, realNumLastDimPositions ]( SizeValueType w )
+        {
+          const std::size_t beginSeries = numberOfTimeSeries * w / numberOfWorkUnits;
+          const std::size_t endSeries   = numberOfTimeSeries * ( w + 1 ) / numberOfWorkUnits;
+          this->AccumulateLastDimensionSamples( samples,
+            beginSeries * realNumLastDimPositions, endSeries * realNumLastDimPositions,
+            realNumLastDimPositions,
+            this->m_GetValueAndDerivativePerThreadVariables[ w ].st_Value,
+            this->m_GetValueAndDerivativePerThreadVariables[ w ].st_NumberOfPixelsCounted,
+            &this->m_GetValueAndDerivativePerThreadVariables[ w ].st_Derivative );
+        },
+        nullptr );
     }
-
-    /** Initialize MT vector. */
-    std::fill( MT.begin(), MT.end(), itk::NumericTraits< RealType >::ZeroValue() );
-
-    /** Transform sampled point to voxel coordinates. */
-    FixedImageContinuousIndexType voxelCoord;
-    this->GetFixedImage()->TransformPhysicalPointToContinuousIndex( fixedPoint, voxelCoord );
-
-    /** Loop over the slowest varying dimension. */
-    float        sumValues        = 0.0;
-    float        sumValuesSquared = 0.0;
-    unsigned int numSamplesOk     = 0;
-
-    /** First loop over t: compute M(T(x,t)), dM(T(x,t))/dmu, nzji and store. */
-    for( unsigned int d = 0; d < realNumLastDimPositions; ++d )
+    else
     {
-      /** Initialize some variables. */
-      RealType                  movingImageValue;
-      MovingImagePointType      mappedPoint;
-      MovingImageDerivativeType movingImageDerivative;
-
-      /** Set fixed point's last dimension to lastDimPosition. */
-      voxelCoord[ lastDim ] = lastDimPositions[ d ];
-      /** Transform sampled point back to world coordinates. */
-      this->GetFixedImage()->TransformContinuousIndexToPhysicalPoint( voxelCoord, fixedPoint );
-      /** Transform point and check if it is inside the B-spline support region. */
-      bool sampleOk = this->TransformPoint( fixedPoint, mappedPoint );
-
-      /** Check if point is inside mask. */
-      if( sampleOk )
-      {
-        sampleOk = this->IsInsideMovingMask( mappedPoint );
-      }
-
-      /** Compute the moving image value and check if the point is
-      * inside the moving image buffer. */
-      if( sampleOk )
-      {
-        sampleOk = this->EvaluateMovingImageValueAndDerivative(
-          mappedPoint, movingImageValue, &movingImageDerivative );
-      }
-
-      if( sampleOk )
-      {
-        /** Update value terms **/
-        numSamplesOk++;
-        sumValues        += movingImageValue;
-        sumValuesSquared += movingImageValue * movingImageValue;
-
-        /** Get the TransformJacobian dT/dmu. */
-        this->EvaluateTransformJacobian( fixedPoint, jacobian, nzjis[ d ] );
-
-        /** Compute the innerproduct (dM/dx)^T (dT/dmu). */
-        this->EvaluateTransformJacobianInnerProduct(
-          jacobian, movingImageDerivative, imageJacobian );
-
-        /** Store values. */
-        MT[ d ]     = movingImageValue;
-        dMTdmu[ d ] = imageJacobian;
-      }
-      else
-      {
-        dMTdmu[ d ] = DerivativeType( this->m_AdvancedTransform->GetNumberOfNonZeroJacobianIndices() );
-        dMTdmu[ d ].Fill( itk::NumericTraits< DerivativeValueType >::ZeroValue() );
-        nzjis[ d ] = NonZeroJacobianIndicesType( this->m_AdvancedTransform->GetNumberOfNonZeroJacobianIndices(), 0 );
-      } // end if sampleOk
+      this->AccumulateLastDimensionSamples( samples, 0, numberOfEvaluations,
+        realNumLastDimPositions, measure, this->m_NumberOfPixelsCounted, &derivative );
     }
+  } // end for loop over the image sample container
 
-    if( numSamplesOk > 0 )
+  /** Gather the results of the work units. */
+  if( this->m_UseMultiThread )
+  {
+    for( ThreadIdType i = 0; i < numberOfWorkUnits; ++i )
     {
-      this->m_NumberOfPixelsCounted++;
-
-      /** Compute average intensity value. */
-      const float expectedValue = sumValues / static_cast< float >( numSamplesOk );
-      /** Add this variance to the variance sum. */
-      const float expectedSquaredValue = sumValuesSquared / static_cast< float >( numSamplesOk );
-      measure += expectedSquaredValue - expectedValue * expectedValue;
-
-      /** Second loop over t: update derivative. */
-      for( unsigned int d = 0; d < realNumLastDimPositions; ++d )
-      {
-        for( unsigned int j = 0; j < nzjis[ d ].size(); ++j )
-        {
-          derivative[ nzjis[ d ][ j ] ] += ( 2.0 * ( MT[ d ] - expectedValue ) * dMTdmu[ d ][ j ] )
-            / static_cast< float >( numSamplesOk );
-        }
-      }
+      measure                       += this->m_GetValueAndDerivativePerThreadVariables[ i ].st_Value;
+      this->m_NumberOfPixelsCounted += this->m_GetValueAndDerivativePerThreadVariables[ i ].st_NumberOfPixelsCounted;
 
+      /** Reset these variables for the next iteration. */
+      this->m_GetValueAndDerivativePerThreadVariables[ i ].st_Value                 = NumericTraits< MeasureType >::Zero;
+      this->m_GetValueAndDerivativePerThreadVariables[ i ].st_NumberOfPixelsCounted = NumericTraits< SizeValueType >::Zero;
     }
-  } // end for loop over the image sample container
+
+    /** Accumulate the derivatives, which also resets them. */
+    this->m_ThreaderMetricParameters.st_DerivativePointer   = derivative.begin();
+    this->m_ThreaderMetricParameters.st_NormalizationFactor = 1.0;
+    this->m_Threader->SetSingleMethod( this->AccumulateDerivativesThreaderCallback,
+      const_cast< void * >( static_cast< const void * >( &this->m_ThreaderMetricParameters ) ) );
+    this->m_Threader->SingleMethodExecute();
+  }
 
   /** Check if enough samples were valid. */
   this->CheckNumberOfSamples(
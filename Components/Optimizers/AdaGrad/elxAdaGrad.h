@@ -390,6 +390,14 @@ protected :
    */
   virtual void AutomaticPreconditionerEstimation( void );
 
+  /** The gradient noise is estimated by SampleGradients() and every
+   * iteration, so the number of samples may be adapted.
+   */
+  bool GetProvidesGradientNoiseEstimates( void ) const override
+  {
+    return true;
+  }
+
   /** Measure some derivatives, exact and approximated. Returns
    * the squared magnitude of the gradient and approximation error.
    * Needed for the automatic parameter estimation.
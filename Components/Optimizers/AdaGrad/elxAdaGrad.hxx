@@ -29,6 +29,8 @@
 #include <utility>
 #include "itkAdvancedImageToImageMetric.h"
 #include "itkTimeProbe.h"
+#include "itkHotPathProfiler.h"
+#include "itkParameterVectorOperations.h"
 
 #ifdef ELASTIX_USE_OPENMP
 #include <omp.h>
@@ -324,6 +326,13 @@ AdaGrad< TElastix >
     xl::xout[ "iteration" ][ "4b:||SearchDirection||" ] << this->GetSearchDirection().magnitude();
   }
 
+  /** Stop after this iteration when the optimization has stalled. */
+  this->UpdateConvergenceMonitor( this, this->GetValue(), this->GetGradient(),
+    this->GetNumberOfIterations() );
+
+  /** Adapt the number of samples to the noise of the gradient. */
+  this->UpdateNumberOfSamples( this->GetGradient() );
+
   /** Select new spatial samples for the computation of the metric. */
   if( this->GetNewSamplesEveryIteration() )
   {
@@ -374,7 +383,7 @@ AdaGrad< TElastix >
   }
 
   /** Print the stopping condition. */
-  elxout << "Stopping condition: " << stopcondition << "." << std::endl;
+  this->PrintStopCondition( stopcondition );
 
   /** Store the used parameters, for later printing to screen. */
   SettingsType settings;
@@ -448,6 +457,8 @@ void
 AdaGrad< TElastix >
 ::AdvanceOneStep( void )
 {
+  elxProfileScope( OptimizerUpdatePhase );
+
   /** Get space dimension. */
   const unsigned int spaceDimension = this->GetScaledCostFunction()->GetNumberOfParameters();
 
@@ -467,14 +478,24 @@ AdaGrad< TElastix >
   const double eta = 1e-14;
   const double lamda2 = lamda * this->m_NoiseFactor;
 //  const double lamda2 = 0.01;
-  for( unsigned int j = 0; j < spaceDimension; ++j )
-  {
-    this->m_PreconditionVector[ j ] += this->m_Gradient[ j ] * this->m_Gradient[ j ];
-    searchDirection[ j ] = this->m_Gradient[ j ] / ( std::sqrt( this->m_PreconditionVector[ j ] + eta ) );
-    newPosition[ j ] = currentPosition[ j ] - lamda2 * searchDirection[ j ];
-  }
+  const double * gradient           = this->m_Gradient.data_block();
+  double *       preconditionVector = this->m_PreconditionVector.data_block();
+  double *       searchDir          = searchDirection.data_block();
+  const double * current            = currentPosition.data_block();
+  double *       next               = newPosition.data_block();
+  itk::ParameterVectorOperations::ParallelFor( spaceDimension,
+    [ = ]( const std::size_t first, const std::size_t last )
+    {
+      for( std::size_t j = first; j < last; ++j )
+      {
+        preconditionVector[ j ] += gradient[ j ] * gradient[ j ];
+        searchDir[ j ]           = gradient[ j ] / ( std::sqrt( preconditionVector[ j ] + eta ) );
+        next[ j ]                = current[ j ] - lamda2 * searchDir[ j ];
+      }
+    }, this->m_Threader );
 
   this->Superclass1::UpdateCurrentTime();
+  elxProfileScopeEnd();
   this->InvokeEvent( itk::IterationEvent() );
 
 } // end AdvanceOneStep()
@@ -705,6 +726,7 @@ AdaGrad< TElastix >
   double gg           = 0.0;
   double ee           = 0.0;
   this->SampleGradients( this->GetScaledCurrentPosition(), sigma4, gg, ee );
+  this->SetGradientNoiseEstimates( gg, ee );
   this->m_NoiseFactor = gg / ( gg + ee );
   timer_noise.Stop();
   elxout << "  The MaxJJ used for noisefactor is: " << maxJJ << std::endl;
@@ -182,6 +182,11 @@ namespace elastix
  *   The parameter can be specified for each resolution, or for all resolutions at once.\n
  *   example: <tt>(NoiseCompensation "true")</tt>\n
  *   Default/recommended: true.
+ * \parameter AdaptiveNumberOfSamples: Adapt the number of samples to the noise of the
+ *   gradient, see OptimizerBase. The noise estimates of the automatic parameter estimation
+ *   are used as the initial estimates.\n
+ *   example: <tt>(AdaptiveNumberOfSamples "true")</tt>\n
+ *   Default: false.
  *
  * \todo: this class contains a lot of functional code, which actually does not belong here.
  *
@@ -381,6 +386,14 @@ protected:
    */
   virtual void AutomaticParameterEstimationUsingDisplacementDistribution( void );
 
+  /** The gradient noise is estimated by SampleGradients() and every
+   * iteration, so the number of samples may be adapted.
+   */
+  bool GetProvidesGradientNoiseEstimates( void ) const override
+  {
+    return true;
+  }
+
   /** Measure some derivatives, exact and approximated. Returns
    * the squared magnitude of the gradient and approximation error.
    * Needed for the automatic parameter estimation.
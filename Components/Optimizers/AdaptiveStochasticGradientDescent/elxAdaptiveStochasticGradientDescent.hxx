@@ -298,6 +298,13 @@ AdaptiveStochasticGradientDescent< TElastix >
     xl::xout[ "iteration" ][ "4:||Gradient||" ] << this->GetGradient().magnitude();
   }
 
+  /** Stop after this iteration when the optimization has stalled. */
+  this->UpdateConvergenceMonitor( this, this->GetValue(), this->GetGradient(),
+    this->GetNumberOfIterations() );
+
+  /** Adapt the number of samples to the noise of the gradient. */
+  this->UpdateNumberOfSamples( this->GetGradient() );
+
   /** Select new spatial samples for the computation of the metric. */
   if( this->GetNewSamplesEveryIteration() )
   {
@@ -348,7 +355,7 @@ AdaptiveStochasticGradientDescent< TElastix >
   }
 
   /** Print the stopping condition. */
-  elxout << "Stopping condition: " << stopcondition << "." << std::endl;
+  this->PrintStopCondition( stopcondition );
 
   /** Store the used parameters, for later printing to screen. */
   SettingsType settings;
@@ -639,6 +646,7 @@ AdaptiveStochasticGradientDescent< TElastix >
   }
   this->SampleGradients(
     this->GetScaledCurrentPosition(), sigma4, gg, ee );
+  this->SetGradientNoiseEstimates( gg, ee );
   timer3.Stop();
   elxout << "  Sampling the gradients took "
          << this->ConvertSecondsToDHMS( timer3.GetMean(), 6 ) << std::endl;
@@ -789,6 +797,7 @@ AdaptiveStochasticGradientDescent< TElastix >
       sigma4 = sigma4factor * delta / std::sqrt( maxJJ );
     }
     this->SampleGradients( this->GetScaledCurrentPosition(), sigma4, gg, ee );
+    this->SetGradientNoiseEstimates( gg, ee );
 
     const double noisefactor = gg / ( gg + ee + 1e-14 );
     a =  delta * std::pow( A + 1.0, alpha ) / ( jacg + 1e-14 ) * noisefactor;
@@ -31,6 +31,8 @@
 #include "itkCommand.h"
 #include "itkEventObject.h"
 #include "itkMacro.h"
+#include "itkHotPathProfiler.h"
+#include "itkParameterVectorOperations.h"
 
 #ifdef ELASTIX_USE_OPENMP
 #include <omp.h>
@@ -382,6 +384,10 @@ AdaptiveStochasticLBFGS<TElastix>
   xl::xout["iteration"]["4a:||Gradient||"]   << this->GetGradient().magnitude();
   xl::xout["iteration"]["4b:||SearchDir||"]  << this->m_SearchDir.magnitude();
 
+  /** Stop after this iteration when the optimization has stalled. */
+  this->UpdateConvergenceMonitor( this, this->GetValue(), this->GetGradient(),
+    this->GetNumberOfIterations() );
+
   /** Select new spatial samples for the computation of the metric. */
   if( this->GetNewSamplesEveryIteration() )
   {
@@ -440,7 +446,7 @@ AdaptiveStochasticLBFGS<TElastix>
   }
 
   /** Print the stopping condition. */
-  elxout << "Stopping condition: " << stopcondition << "." << std::endl;
+  this->PrintStopCondition( stopcondition );
   this->m_CurrentTime = 0.0;
 
   /** Store the used parameters, for later printing to screen. */
@@ -560,22 +566,12 @@ AdaptiveStochasticLBFGS<TElastix>
 {
   itkDebugMacro( "LBFGSUpdate" );
 
-  /** Get space dimension. */
-  const unsigned int spaceDimension
-    = this->GetScaledCostFunction()->GetNumberOfParameters();
-
   /** Get a reference to the previously allocated newPosition. */
   ParametersType & newPosition = this->m_ScaledCurrentPosition;
 
-  /** Get a reference to the current position. */
-  const ParametersType & currentPosition = this->GetScaledCurrentPosition();
-
-  /** Update the new position. */
-  const double learningRate = this->GetLearningRate();
-  for( unsigned int j = 0; j < spaceDimension; ++j )
-  {
-    newPosition[ j ] = currentPosition[ j ] + learningRate * this->m_SearchDir[ j ];
-  }
+  /** Update the new position in place. */
+  itk::ParameterVectorOperations::AddScaled( newPosition,
+    this->GetLearningRate(), this->m_SearchDir, newPosition, this->m_Threader );
 
   this->InvokeEvent( itk::IterationEvent() );
 } // end LBFGSUpdate()
@@ -591,24 +587,16 @@ AdaptiveStochasticLBFGS<TElastix>
 ::AdvanceOneStep( void )
 {
   itkDebugMacro( "AdvanceOneStep" );
-
-  /** Get space dimension. */
-  const unsigned int spaceDimension
-    = this->GetScaledCostFunction()->GetNumberOfParameters();
+  elxProfileScope( OptimizerUpdatePhase );
 
   /** Get a reference to the previously allocated newPosition. */
   ParametersType & newPosition = this->m_ScaledCurrentPosition;
 
-  /** Get a reference to the current position. */
-  const ParametersType & currentPosition = this->GetScaledCurrentPosition();
-
-  /** Update the new position. */
-  const double learningRate = this->GetLearningRate();
-  for( unsigned int j = 0; j < spaceDimension; ++j )
-  {
-    newPosition[ j ] = currentPosition[ j ] - learningRate * this->m_Gradient[ j ];
-  }
+  /** Update the new position in place. */
+  itk::ParameterVectorOperations::AddScaled( newPosition,
+    -this->GetLearningRate(), this->m_Gradient, newPosition, this->m_Threader );
 
+  elxProfileScopeEnd();
   this->InvokeEvent( itk::IterationEvent() );
 
 } // end AdvanceOneStep()
@@ -1645,9 +1633,9 @@ AdaptiveStochasticLBFGS<TElastix>
 
 //   const double rho = 1.0 / inner_product( step, grad_dif ) ; // 1/ys
 //   const double  ys = 1.0 / rho;
-  const double  ys = inner_product( step, grad_dif ) ; // 1/ys;
+  const double  ys = itk::ParameterVectorOperations::Dot( step, grad_dif, this->m_Threader ) ; // 1/ys;
   const double rho = 1.0 / ys;
-  const double  yy = grad_dif.squared_magnitude();
+  const double  yy = itk::ParameterVectorOperations::SquaredNorm( grad_dif, this->m_Threader );
 
   double fill_value = ys / yy;
   if( fill_value < 0.0 )
@@ -1739,10 +1727,16 @@ AdaptiveStochasticLBFGS<TElastix>
   // copied to searchDir. The construction and copying can be avoided
   // as searchDir is already allocated.
   //searchDir = -gradient;
-  for( unsigned int j = 0; j < numberOfParameters; ++j )
-  {
-    searchDir[ j ] = -gradient[ j ];
-  }
+  const double * gradientData  = gradient.data_block();
+  double *       searchDirData = searchDir.data_block();
+  itk::ParameterVectorOperations::ParallelFor( numberOfParameters,
+    [ gradientData, searchDirData ]( const std::size_t first, const std::size_t last )
+    {
+      for( std::size_t j = first; j < last; ++j )
+      {
+        searchDirData[ j ] = -gradientData[ j ];
+      }
+    }, this->m_Threader );
 
   int cp = static_cast< int >( this->m_CurrentT );
 
@@ -1753,35 +1747,26 @@ AdaptiveStochasticLBFGS<TElastix>
     {
       cp = this->m_LBFGSMemory - 1;
     }
-    const double sq = inner_product( this->m_S[ cp ], searchDir );
+    const double sq = itk::ParameterVectorOperations::Dot( this->m_S[ cp ], searchDir, this->m_Threader );
     alpha[ cp ] = this->m_Rho[ cp ] * sq;
-    const double &         alpha_cp = alpha[ cp ];
-    const DerivativeType & y        = this->m_Y[ cp ];
-    for( unsigned int j = 0; j < numberOfParameters; ++j )
-    {
-      searchDir[ j ] -= alpha_cp * y[ j ];
-    }
+    itk::ParameterVectorOperations::Axpy( -alpha[ cp ], this->m_Y[ cp ], searchDir, this->m_Threader );
   }
 
+#if 0
   for( unsigned int j = 0; j < numberOfParameters; ++j )
   {
-#if 0
     searchDir[ j ] *= H0[ j ];
+  }
 #else
-    searchDir[ j ] *= fill_value;
+  itk::ParameterVectorOperations::Scale( fill_value, searchDir, this->m_Threader );
 #endif
-  }
 
   for( unsigned int i = 0; i < this->m_Bound; ++i )
   {
-    const double           yr             = inner_product( this->m_Y[ cp ], searchDir );
-    const double           beta           = this->m_Rho[ cp ] * yr;
-    const double           alpha_min_beta = alpha[ cp ] - beta;
-    const ParametersType & s              = this->m_S[ cp ];
-    for( unsigned int j = 0; j < numberOfParameters; ++j )
-    {
-      searchDir[ j ] += alpha_min_beta * s[ j ];
-    }
+    const double yr             = itk::ParameterVectorOperations::Dot( this->m_Y[ cp ], searchDir, this->m_Threader );
+    const double beta           = this->m_Rho[ cp ] * yr;
+    const double alpha_min_beta = alpha[ cp ] - beta;
+    itk::ParameterVectorOperations::Axpy( alpha_min_beta, this->m_S[ cp ], searchDir, this->m_Threader );
     ++cp;
     if( static_cast< unsigned int >( cp ) == this->m_LBFGSMemory )
     {
@@ -1792,7 +1777,8 @@ AdaptiveStochasticLBFGS<TElastix>
   /** Normalize if no information about previous steps is available yet */
   if( this->m_Bound == 0 )
   {
-    searchDir /= gradient.magnitude();
+    itk::ParameterVectorOperations::Scale( 1.0 / itk::ParameterVectorOperations::Norm( gradient, this->m_Threader ),
+      searchDir, this->m_Threader );
   }
 
 } // end ComputeSearchDirection()
@@ -31,6 +31,8 @@
 #include "itkCommand.h"
 #include "itkEventObject.h"
 #include "itkMacro.h"
+#include "itkHotPathProfiler.h"
+#include "itkParameterVectorOperations.h"
 
 #ifdef ELASTIX_USE_OPENMP
 #include <omp.h>
@@ -326,6 +328,13 @@ AdaptiveStochasticVarianceReducedGradient<TElastix>
     xl::xout["iteration"]["4:||Gradient||"] << this->GetGradient().magnitude();
   }
 
+  /** Stop after this iteration when the optimization has stalled. */
+  this->UpdateConvergenceMonitor( this, this->GetValue(), this->GetGradient(),
+    this->GetNumberOfIterations() );
+
+  /** Adapt the number of samples to the noise of the gradient. */
+  this->UpdateNumberOfSamples( this->GetGradient() );
+
   /** Select new spatial samples for the computation of the metric. */
   if ( this->GetNewSamplesEveryIteration() )
   {
@@ -372,7 +381,7 @@ AdaptiveStochasticVarianceReducedGradient<TElastix>
   }
 
   /** Print the stopping condition. */
-  elxout << "Stopping condition: " << stopcondition << "." << std::endl;
+  this->PrintStopCondition( stopcondition );
   this->m_CurrentTime = 0.0;
 
   /** Store the used parameters, for later printing to screen. */
@@ -474,24 +483,16 @@ AdaptiveStochasticVarianceReducedGradient<TElastix>
 ::AdvanceOneStep( void )
 {
   itkDebugMacro( "AdvancedOneStep" );
-
-  /** Get space dimension. */
-  const unsigned int spaceDimension
-    = this->GetScaledCostFunction()->GetNumberOfParameters();
+  elxProfileScope( OptimizerUpdatePhase );
 
   /** Get a reference to the previously allocated newPosition. */
   ParametersType &newPosition = this->m_ScaledCurrentPosition;
 
-  /** Get a reference to the current position. */
-  const ParametersType & currentPosition = this->GetScaledCurrentPosition();
-
-  /** Update the new position. */
-  const double learningRate = this->GetLearningRate();
-  for( unsigned int j = 0; j < spaceDimension; ++j )
-  {
-    newPosition[j] = currentPosition[j] - learningRate * this->m_Gradient[j];
-  }
+  /** Update the new position in place. */
+  itk::ParameterVectorOperations::AddScaled( newPosition,
+    -this->GetLearningRate(), this->m_Gradient, newPosition, this->m_Threader );
 
+  elxProfileScopeEnd();
   this->InvokeEvent( itk::IterationEvent() );
 }
 
@@ -661,25 +662,23 @@ AdaptiveStochasticVarianceReducedGradient<TElastix>
       this->GetConfiguration()->ReadParameter( this->m_UseNoiseFactor,
         "UseNoiseFactor", this->GetComponentLabel(), 0, 0 );
 
-      if ( this->m_UseNoiseFactor )
-      {
-//         for( unsigned int j = 0; j < spaceDimension; ++j )
-//         {
-//           this->m_Gradient[j] = this->m_NoiseFactor * (localCurrentGradient[j] - localPreviousGradient[j]) + this->m_PreviousGradient[j];
-//         }
-        for( unsigned int j = 0; j < spaceDimension; ++j )
+      /** gradient = noiseFactor * ( currentGradient - previousGradient ) + meanGradient,
+       * in one pass, multi-threaded for large numbers of parameters.
+       */
+      const double   noiseFactor      = this->m_UseNoiseFactor ? this->m_NoiseFactor : 1.0;
+      const double * currentGradient  = localCurrentGradient.data_block();
+      const double * previousGradient = localPreviousGradient.data_block();
+      const double * meanGradient     = this->m_MeanGradient.data_block();
+      double *       gradient         = this->m_Gradient.data_block();
+      itk::ParameterVectorOperations::ParallelFor( spaceDimension,
+        [ noiseFactor, currentGradient, previousGradient, meanGradient, gradient ](
+        const std::size_t first, const std::size_t last )
         {
-          this->m_Gradient[j] = this->m_NoiseFactor * (localCurrentGradient[j] - localPreviousGradient[j]) + this->m_MeanGradient[j];
-        }
-      }
-      else
-      {
-        for( unsigned int j = 0; j < spaceDimension; ++j )
-        {
-          this->m_Gradient[j] = (localCurrentGradient[j] - localPreviousGradient[j]) + this->m_MeanGradient[j];
-          //this->m_Gradient[j] = this->m_PreviousGradient[j];
-        }
-      }
+          for( std::size_t j = first; j < last; ++j )
+          {
+            gradient[ j ] = noiseFactor * ( currentGradient[ j ] - previousGradient[ j ] ) + meanGradient[ j ];
+          }
+        }, this->m_Threader );
 
       timeCollector.Stop( "gvr" );
 
@@ -911,6 +910,7 @@ AdaptiveStochasticVarianceReducedGradient<TElastix>
   }
   this->SampleGradients(
     this->GetScaledCurrentPosition(), sigma4, gg, ee );
+  this->SetGradientNoiseEstimates( gg, ee );
   timer3.Stop();
   elxout << "  Sampling the gradients took "
     << this->ConvertSecondsToDHMS( timer3.GetMean(), 6 )
@@ -1063,6 +1063,7 @@ AdaptiveStochasticVarianceReducedGradient<TElastix>
       sigma4 = sigma4factor * delta / std::sqrt( maxJJ );
     }
     this ->SampleGradients( this->GetScaledCurrentPosition(), sigma4, gg, ee );
+    this->SetGradientNoiseEstimates( gg, ee );
 
     double noisefactor = gg / ( gg + ee );
     this->m_NoiseFactor = noisefactor;
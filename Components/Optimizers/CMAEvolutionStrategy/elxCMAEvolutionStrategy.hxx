@@ -49,6 +49,9 @@ CMAEvolutionStrategy< TElastix >::StartOptimization( void )
     }
   }
 
+  /** Evaluate the cost function concurrently, if requested. */
+  this->SetCostFunctionContexts( this );
+
   /** Call the superclass */
   this->Superclass1::StartOptimization();
 
@@ -230,6 +233,10 @@ CMAEvolutionStrategy< TElastix >
   xout[ "iteration" ][ "5b:MaximumD" ] << this->GetCurrentMaximumD();
   xout[ "iteration" ][ "5c:MinimumD" ] << this->GetCurrentMinimumD();
 
+  /** Stop after this iteration when the optimization has stalled. */
+  this->UpdateConvergenceMonitor( this, this->GetCurrentValue(), itk::Array< double >(),
+    this->GetMaximumNumberOfIterations() );
+
   /** Select new samples if desired. These
    * will be used in the next iteration */
   if( this->GetNewSamplesEveryIteration() )
@@ -293,7 +300,10 @@ CMAEvolutionStrategy< TElastix >
   }
 
   /** Print the stopping condition */
-  elxout << "Stopping condition: " << stopcondition << "." << std::endl;
+  this->PrintStopCondition( stopcondition );
+
+  /** Release the cost function contexts of this resolution. */
+  this->RemoveCostFunctionContexts();
 
 } // end AfterEachResolution
 
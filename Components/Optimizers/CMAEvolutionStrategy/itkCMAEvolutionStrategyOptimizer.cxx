@@ -27,6 +27,7 @@
 #include "itkCommand.h"
 #include "itkEventObject.h"
 #include "itkMacro.h"
+#include "itkHotPathProfiler.h"
 
 namespace itk
 {
@@ -501,12 +502,7 @@ CMAEvolutionStrategyOptimizer::GenerateOffspring( void )
 {
   itkDebugMacro( "GenerateOffspring" );
 
-  /** Get the number of parameters from the cost function */
-  const unsigned int numberOfParameters
-    = this->GetScaledCostFunction()->GetNumberOfParameters();
-
   /** Some casts/aliases: */
-  const unsigned int N      = numberOfParameters;
   const unsigned int lambda = this->m_PopulationSize;
 
   /** Clear the old values */
@@ -517,23 +513,17 @@ CMAEvolutionStrategyOptimizer::GenerateOffspring( void )
   unsigned int nrOfFails = 0;
   while( lam < lambda )
   {
-    /** draw from distribution N(0,I) */
-    for( unsigned int par = 0; par < N; ++par )
+    /** Evaluate the rest of the population at once, if independent cost
+     * function contexts are available. The first member is evaluated here,
+     * so that the random numbers that the cost function may draw on its
+     * first evaluation (new samples) are drawn at the same point. */
+    if( lam > 0 && this->GetNumberOfCostFunctionContexts() > 0 )
     {
-      this->m_NormalizedSearchDirs[ lam ][ par ]
-        = this->m_RandomGenerator->GetNormalVariate();
+      this->GenerateOffspringConcurrently( lam );
+      return;
     }
-    /** Make like it was drawn from N(0,C) */
-    if( this->GetUseCovarianceMatrixAdaptation() )
-    {
-      this->m_SearchDirs[ lam ] = this->m_B * ( this->m_D * this->m_NormalizedSearchDirs[ lam ] );
-    }
-    else
-    {
-      this->m_SearchDirs[ lam ] = this->m_NormalizedSearchDirs[ lam ];
-    }
-    /** Make like it was drawn from N( 0, sigma^2 C ) */
-    this->m_SearchDirs[ lam ] *= this->m_CurrentSigma;
+
+    this->DrawSearchDirection( lam );
 
     /** Compute the cost function */
     MeasureType costFunctionValue = 0.0;
@@ -573,6 +563,110 @@ CMAEvolutionStrategyOptimizer::GenerateOffspring( void )
 } // end GenerateOffspring
 
 
+/**
+ * ****************** DrawSearchDirection *********************
+ */
+
+void
+CMAEvolutionStrategyOptimizer::DrawSearchDirection( unsigned int lam )
+{
+  /** Get the number of parameters from the cost function */
+  const unsigned int N = this->GetScaledCostFunction()->GetNumberOfParameters();
+
+  /** draw from distribution N(0,I) */
+  for( unsigned int par = 0; par < N; ++par )
+  {
+    this->m_NormalizedSearchDirs[ lam ][ par ]
+      = this->m_RandomGenerator->GetNormalVariate();
+  }
+  /** Make like it was drawn from N(0,C) */
+  if( this->GetUseCovarianceMatrixAdaptation() )
+  {
+    this->m_SearchDirs[ lam ] = this->m_B * ( this->m_D * this->m_NormalizedSearchDirs[ lam ] );
+  }
+  else
+  {
+    this->m_SearchDirs[ lam ] = this->m_NormalizedSearchDirs[ lam ];
+  }
+  /** Make like it was drawn from N( 0, sigma^2 C ) */
+  this->m_SearchDirs[ lam ] *= this->m_CurrentSigma;
+
+} // end DrawSearchDirection
+
+
+/**
+ * ****************** GenerateOffspringConcurrently *********************
+ *
+ * The members from firstMember on are drawn and evaluated speculatively,
+ * as if all evaluations succeed. Up to the first failed member, this gives
+ * exactly the members of GenerateOffspring(). That function would then
+ * redraw the failed member, and draw the members after it only afterwards,
+ * so the evaluations of those members are discarded and done again.
+ */
+
+void
+CMAEvolutionStrategyOptimizer::GenerateOffspringConcurrently( unsigned int firstMember )
+{
+  itkDebugMacro( "GenerateOffspringConcurrently" );
+
+  const unsigned int lambda = this->m_PopulationSize;
+
+  for( unsigned int lam = firstMember; lam < lambda; ++lam )
+  {
+    this->DrawSearchDirection( lam );
+  }
+
+  ParametersListType       positions;
+  MeasureListType          values;
+  EvaluationStatusListType succeeded;
+  ExceptionListType        errors;
+  unsigned int             first     = firstMember;
+  unsigned int             nrOfFails = 0;
+  while( first < lambda )
+  {
+    /** x_lam = m + d_lam */
+    positions.assign( lambda - first, this->GetScaledCurrentPosition() );
+    for( unsigned int k = 0; k < positions.size(); ++k )
+    {
+      positions[ k ] += this->m_SearchDirs[ first + k ];
+    }
+
+    /** Evaluate the batch concurrently on the cost function contexts */
+    this->GetScaledValues( positions, values, succeeded, errors );
+
+    /** Accept the members up to the first failure */
+    unsigned int k = 0;
+    for( ; k < positions.size() && succeeded[ k ]; ++k )
+    {
+      this->m_CostFunctionValues.push_back(
+        MeasureIndexPairType( values[ k ], first + k ) );
+    }
+    if( k == positions.size() )
+    {
+      break;
+    }
+
+    /** Count the failures of the same member, like GenerateOffspring */
+    nrOfFails = ( k == 0 ) ? nrOfFails + 1 : 1;
+    if( nrOfFails > 10 )
+    {
+      this->m_StopCondition = MetricError;
+      this->StopOptimization();
+      throw errors[ k ];
+    }
+
+    /** try another parameter vector for the failed member, and redraw
+     * the members after it */
+    first += k;
+    for( unsigned int lam = first; lam < lambda; ++lam )
+    {
+      this->DrawSearchDirection( lam );
+    }
+  }
+
+} // end GenerateOffspringConcurrently
+
+
 /**
  * ****************** SortCostFunctionValues *********************
  */
@@ -604,6 +698,7 @@ void
 CMAEvolutionStrategyOptimizer::AdvanceOneStep( void )
 {
   itkDebugMacro( "AdvanceOneStep" );
+  elxProfileScope( OptimizerUpdatePhase );
 
   /** Some casts/aliases: */
   const unsigned int mu = this->m_NumberOfParents;
@@ -625,6 +720,7 @@ CMAEvolutionStrategyOptimizer::AdvanceOneStep( void )
   ParametersType newPos = this->GetScaledCurrentPosition();
   newPos += this->GetCurrentScaledStep();
   this->SetScaledCurrentPosition( newPos );
+  elxProfileScopeEnd();
 
   /** Compute the cost function at the new position */
   try
@@ -760,36 +856,46 @@ CMAEvolutionStrategyOptimizer::UpdateC( void )
   }
   this->m_C *= oldCfactor;
 
-  /** Do rank-one update */
+  /** Collect the vectors of the rank-one and rank-mu updates as the rows of
+   * a single (mu+1) x N matrix V, scaled such that the update is V' * V:
+   * row 0 holds sqrt(rankonefactor) * p_c, row m+1 holds
+   * sqrt(rankmufactor * w_m) / sigma * d_m.
+   */
   const double rankonefactor = c_cov / mu_cov;
-  for( unsigned int i = 0; i < N; ++i )
+  const double rankmufactor  = c_cov * ( 1.0 - 1.0 / mu_cov );
+  vnl_matrix< double > updateVectors( mu + 1, N );
+  updateVectors.set_row( 0, this->m_EvolutionPath * std::sqrt( rankonefactor ) );
+  for( unsigned int m = 0; m < mu; ++m )
   {
-    const double evolutionPath_i = this->m_EvolutionPath[ i ];
-    for( unsigned int j = 0; j < N; ++j )
-    {
-      const double update = rankonefactor * evolutionPath_i * this->m_EvolutionPath[ j ];
-      this->m_C[ i ][ j ] += update;
-    }
+    const unsigned int lam = this->m_CostFunctionValues[ m ].second;
+    const double       factor
+      = std::sqrt( rankmufactor * this->m_RecombinationWeights[ m ] ) / sigma;
+    updateVectors.set_row( m + 1, this->m_SearchDirs[ lam ] * factor );
   }
 
-  /** Do rank-mu update */
-  const double rankmufactor = c_cov * ( 1.0 - 1.0 / mu_cov );
-  for( unsigned int m = 0; m < mu; ++m )
+  /** Do the rank-one and rank-mu update in a single pass over the upper
+   * triangle of C. The inner loop runs over contiguous memory, so the
+   * compiler can vectorize it. Mirror the result to the lower triangle. */
+  for( unsigned int m = 0; m <= mu; ++m )
   {
-    const unsigned int lam               = this->m_CostFunctionValues[ m ].second;
-    const double       sqrtweight        = std::sqrt( this->m_RecombinationWeights[ m ] );
-    ParametersType     weightedSearchDir = this->m_SearchDirs[ lam ];
-    weightedSearchDir *= ( sqrtweight / sigma );
+    const double * v = updateVectors[ m ];
     for( unsigned int i = 0; i < N; ++i )
     {
-      const double weightedSearchDir_i = weightedSearchDir[ i ];
-      for( unsigned int j = 0; j < N; ++j )
+      const double   v_i = v[ i ];
+      double * const c_i = this->m_C[ i ];
+      for( unsigned int j = i; j < N; ++j )
       {
-        const double update = rankmufactor * weightedSearchDir_i * weightedSearchDir[ j ];
-        this->m_C[ i ][ j ] += update;
+        c_i[ j ] += v_i * v[ j ];
       }
     }
-  } // end for m
+  }
+  for( unsigned int i = 0; i < N; ++i )
+  {
+    for( unsigned int j = 0; j < i; ++j )
+    {
+      this->m_C[ i ][ j ] = this->m_C[ j ][ i ];
+    }
+  }
 
 } // end UpdateC
 
@@ -43,6 +43,14 @@ namespace itk
  *   - See also the Matlab code, cmaes.m, which you can download from the
  *     website mentioned above.
  *
+ * When cost function contexts are added (see
+ * ScaledSingleValuedNonLinearOptimizer::AddCostFunctionContext()), the
+ * offspring of a generation is evaluated concurrently. The random search
+ * directions are drawn in the same order as in the sequential case, also
+ * when cost function evaluations fail, so for a fixed seed both modes give
+ * the same results. A failed member costs one wasted evaluation of each
+ * member after it, though.
+ *
  * \ingroup Numerics Optimizers
  */
 
@@ -358,6 +366,13 @@ protected:
    * and m_CostFunctionValues */
   virtual void GenerateOffspring( void );
 
+  /** Draw a new m_NormalizedSearchDirs[lam] and compute m_SearchDirs[lam] */
+  virtual void DrawSearchDirection( unsigned int lam );
+
+  /** Like GenerateOffspring, but evaluates the members from firstMember
+   * on concurrently, using the cost function contexts. */
+  virtual void GenerateOffspringConcurrently( unsigned int firstMember );
+
   /** Sort the m_CostFunctionValues vector and update m_MeasureHistory */
   virtual void SortCostFunctionValues( void );
 
@@ -383,6 +383,10 @@ ConjugateGradient< TElastix >
     this->m_LineOptimizer->SetInitialStepLengthEstimate(
       this->GetCurrentStepLength() );
 
+    /** Stop after this iteration when the optimization has stalled. */
+    this->UpdateConvergenceMonitor( this, this->GetCurrentValue(), this->GetCurrentGradient(),
+      this->GetMaximumNumberOfIterations() );
+
     /** If new samples: compute a new gradient and value. These
      * will be used in the computation of a new search direction */
     if( this->GetNewSamplesEveryIteration() )
@@ -468,7 +472,7 @@ ConjugateGradient< TElastix >
   } // end else
 
   /** Print the stopping condition */
-  elxout << "Stopping condition: " << stopcondition << "." << std::endl;
+  this->PrintStopCondition( stopcondition );
 
 } // end AfterEachResolution
 
@@ -41,6 +41,8 @@ namespace elastix
  * \note It prints out no stop conditions, since the itk superclass
  * does not generate them.
  * \note It considers line search iterations as elastix iterations.
+ * \note The UseConvergenceMonitor option is ignored, because the ValueTolerance
+ * already stops the optimization when the metric value stalls.
  *
  * \parameter Optimizer: Select this optimizer as follows:\n
  *    <tt>(Optimizer "ConjugateGradientFRPR")</tt>\n
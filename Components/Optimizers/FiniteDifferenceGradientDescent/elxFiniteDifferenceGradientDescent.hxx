@@ -137,6 +137,15 @@ FiniteDifferenceGradientDescent< TElastix >
   xl::xout[ "iteration" ][ "3:Gain a_k" ] << this->GetLearningRate();
   xl::xout[ "iteration" ][ "4:||Gradient||" ] << this->GetGradientMagnitude();
 
+  /** Stop after this iteration when the optimization has stalled. The
+   * convergence monitor needs the metric values.
+   */
+  if( this->m_ShowMetricValues )
+  {
+    this->UpdateConvergenceMonitor( this, this->GetValue(), this->m_Gradient,
+      this->GetNumberOfIterations() );
+  }
+
   /** Select new spatial samples for the computation of the metric
    * \todo You may also choose to select new samples after evaluation
    * of the metric value */
@@ -181,7 +190,10 @@ FiniteDifferenceGradientDescent< TElastix >
   }
   /** Print the stopping condition */
 
-  elxout << "Stopping condition: " << stopcondition << "." << std::endl;
+  this->PrintStopCondition( stopcondition );
+
+  /** Release the cost function contexts of this resolution. */
+  this->RemoveCostFunctionContexts();
 
 } // end AfterEachResolution
 
@@ -243,6 +255,9 @@ FiniteDifferenceGradientDescent< TElastix >
     }
   }
 
+  /** Evaluate the cost function concurrently, if requested. */
+  this->SetCostFunctionContexts( this );
+
   this->Superclass1::StartOptimization();
 
 }   //end StartOptimization
@@ -23,6 +23,7 @@
 #include "itkCommand.h"
 #include "itkEventObject.h"
 #include "itkMacro.h"
+#include "itkHotPathProfiler.h"
 
 #include "math.h"
 #include "vnl/vnl_math.h"
@@ -168,20 +169,27 @@ FiniteDifferenceGradientDescentOptimizer
     /** Calculate the derivative; this may take a while... */
     try
     {
-      for( unsigned int j = 0; j < spaceDimension; j++ )
+      if( this->GetNumberOfCostFunctionContexts() > 0 )
       {
-        param[ j ] += ck;
-        valueplus   = this->GetScaledValue( param );
-        param[ j ] -= 2.0 * ck;
-        valuemin    = this->GetScaledValue( param );
-        param[ j ] += ck;
+        sumOfSquaredGradients = this->ComputeGradientConcurrently( param, ck );
+      }
+      else
+      {
+        for( unsigned int j = 0; j < spaceDimension; j++ )
+        {
+          param[ j ] += ck;
+          valueplus   = this->GetScaledValue( param );
+          param[ j ] -= 2.0 * ck;
+          valuemin    = this->GetScaledValue( param );
+          param[ j ] += ck;
 
-        const double gradient = ( valueplus - valuemin ) / ( 2.0 * ck );
-        this->m_Gradient[ j ] = gradient;
+          const double gradient = ( valueplus - valuemin ) / ( 2.0 * ck );
+          this->m_Gradient[ j ] = gradient;
 
-        sumOfSquaredGradients += ( gradient * gradient );
+          sumOfSquaredGradients += ( gradient * gradient );
 
-      }   // for j = 0 .. spaceDimension
+        } // for j = 0 .. spaceDimension
+      }
     }
     catch( ExceptionObject & err )
     {
@@ -244,6 +252,7 @@ FiniteDifferenceGradientDescentOptimizer
 ::AdvanceOneStep( void )
 {
   itkDebugMacro( "AdvanceOneStep" );
+  elxProfileScope( OptimizerUpdatePhase );
 
   const unsigned int spaceDimension
     = this->GetScaledCostFunction()->GetNumberOfParameters();
@@ -264,11 +273,48 @@ FiniteDifferenceGradientDescentOptimizer
 
   this->SetScaledCurrentPosition( newPosition );
 
+  elxProfileScopeEnd();
   this->InvokeEvent( IterationEvent() );
 
 } // end AdvanceOneStep
 
 
+/**
+ * ****************** ComputeGradientConcurrently ***********************
+ */
+
+double
+FiniteDifferenceGradientDescentOptimizer
+::ComputeGradientConcurrently( const ParametersType & param, double ck )
+{
+  const unsigned int spaceDimension = param.GetSize();
+
+  /** Collect the positions param + ck e_j and param - ck e_j. */
+  ParametersListType positions( 2 * spaceDimension, param );
+  for( unsigned int j = 0; j < spaceDimension; j++ )
+  {
+    positions[ 2 * j ][ j ]     += ck;
+    positions[ 2 * j + 1 ][ j ] -= ck;
+  }
+
+  /** Evaluate them concurrently. The first error is passed on. */
+  MeasureListType values;
+  this->GetScaledValues( positions, values );
+
+  double sumOfSquaredGradients = 0.0;
+  for( unsigned int j = 0; j < spaceDimension; j++ )
+  {
+    const double gradient = ( values[ 2 * j ] - values[ 2 * j + 1 ] ) / ( 2.0 * ck );
+    this->m_Gradient[ j ] = gradient;
+
+    sumOfSquaredGradients += ( gradient * gradient );
+  }
+
+  return sumOfSquaredGradients;
+
+} // end ComputeGradientConcurrently
+
+
 /**
  * ************************** Compute_a *************************
  *
@@ -48,6 +48,10 @@ namespace itk
  * Note the similarities to the SimultaneousPerturbation optimizer and
  * the StandardGradientDescent optimizer.
  *
+ * When cost function contexts are added (see
+ * ScaledSingleValuedNonLinearOptimizer::AddCostFunctionContext()), the
+ * 2N perturbed positions of an iteration are evaluated concurrently.
+ *
  * \ingroup Optimizers
  * \sa FiniteDifferenceGradientDescent
  */
@@ -157,6 +161,11 @@ protected:
 
   virtual double Compute_c( unsigned long k ) const;
 
+  /** Compute m_Gradient by evaluating all perturbed positions
+   * concurrently on the cost function contexts. Returns the sum
+   * of the squared gradient components. */
+  virtual double ComputeGradientConcurrently( const ParametersType & param, double ck );
+
 private:
 
   FiniteDifferenceGradientDescentOptimizer( const Self & ); // purposely not implemented
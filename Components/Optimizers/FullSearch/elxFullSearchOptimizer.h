@@ -48,6 +48,16 @@ namespace elastix
  *   This varies the second transform parameter in the range [-4.0 3.0] with steps of 1.0
  *   and the third parameter in the range [-1.0 1.0] with steps of 0.5. The names are used
  *   as column headers in the screen output.
+ * \parameter NumberOfRefinementLevels: Scan the search space coarse-to-fine. At the coarsest
+ *   level every 2^L-th grid point is evaluated; the finer levels only densify the grid
+ *   around the best points found so far. Grid points that are never evaluated get
+ *   the value NaN in the optimization surface. Can be specified for each resolution.\n
+ *   example: <tt>(NumberOfRefinementLevels 3 3)</tt>\n
+ *   Default value: 0, which means that the full grid is scanned.
+ * \parameter NumberOfRefinementCandidates: The number of best points around which the grid is
+ *   densified at each refinement level. Can be specified for each resolution.\n
+ *   example: <tt>(NumberOfRefinementCandidates 5)</tt>\n
+ *   Default value: 3.
  *
  * \ingroup Optimizers
  * \sa FullSearchOptimizer
@@ -95,6 +105,7 @@ public:
   typedef Superclass1::SearchSpacePointType    SearchSpacePointType;
   typedef Superclass1::SearchSpaceIndexType    SearchSpaceIndexType;
   typedef Superclass1::SearchSpaceSizeType     SearchSpaceSizeType;
+  typedef Superclass1::SearchSpaceValuesType   SearchSpaceValuesType;
 
   /** Typedef's inherited from Elastix.*/
   typedef typename Superclass2::ElastixType          ElastixType;
@@ -124,6 +135,9 @@ public:
 
   void AfterRegistration( void ) override;
 
+  /** Add the cost function contexts and call the superclass' implementation. */
+  void StartOptimization( void ) override;
+
   /** \todo BeforeAll, checking parameters. */
 
   /** Get a pointer to the image containing the optimization surface. */
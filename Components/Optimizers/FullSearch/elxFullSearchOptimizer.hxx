@@ -23,6 +23,7 @@
 #include <sstream>
 #include <string>
 #include "vnl/vnl_math.h"
+#include "itkMultiThreaderBase.h"
 
 namespace elastix
 {
@@ -163,6 +164,17 @@ FullSearch< TElastix >
     }
   } // end while
 
+  /** Set the coarse-to-fine settings. */
+  unsigned int numberOfRefinementLevels = 0;
+  this->m_Configuration->ReadParameter( numberOfRefinementLevels,
+    "NumberOfRefinementLevels", this->GetComponentLabel(), level, 0 );
+  this->SetNumberOfRefinementLevels( numberOfRefinementLevels );
+
+  unsigned int numberOfRefinementCandidates = 3;
+  this->m_Configuration->ReadParameter( numberOfRefinementCandidates,
+    "NumberOfRefinementCandidates", this->GetComponentLabel(), level, 0 );
+  this->SetNumberOfRefinementCandidates( numberOfRefinementCandidates );
+
   if( realGood )
   {
     /** The number of dimensions. */
@@ -208,6 +220,23 @@ FullSearch< TElastix >
 } // end BeforeEachResolution()
 
 
+/**
+ * ******************* StartOptimization ***********************
+ */
+
+template< class TElastix >
+void
+FullSearch< TElastix >
+::StartOptimization( void )
+{
+  /** Evaluate the cost function concurrently, if requested. */
+  this->SetCostFunctionContexts( this );
+
+  this->Superclass1::StartOptimization();
+
+} // end StartOptimization()
+
+
 /**
  * ***************** AfterEachIteration *************************
  */
@@ -220,9 +249,6 @@ FullSearch< TElastix >
   /** Print some information. */
   xl::xout[ "iteration" ][ "2:Metric" ] << this->GetValue();
 
-  this->m_OptimizationSurface->SetPixel(
-    this->GetCurrentIndexInSearchSpace(), this->GetValue() );
-
   SearchSpacePointType currentPoint = this->GetCurrentPointInSearchSpace();
   unsigned int         nrOfSSDims   = currentPoint.GetSize();
   NameIteratorType     name_it      = this->m_SearchSpaceDimensionNames.begin();
@@ -266,6 +292,21 @@ FullSearch< TElastix >
   /** Print the stopping condition */
   elxout << "Stopping condition: " << stopcondition << "." << std::endl;
 
+  /** Fill the optimization surface with the values of the search. The
+   * values are stored in the same order as the pixels of the surface. */
+  const SearchSpaceValuesType & values = this->GetSearchSpaceValues();
+  float * surface = this->m_OptimizationSurface->GetBufferPointer();
+  if( values.size() == this->GetNumberOfIterations() )
+  {
+    itk::MultiThreaderBase::Pointer threader = itk::MultiThreaderBase::New();
+    threader->ParallelizeArray( 0, values.size(),
+      [ &values, surface ]( itk::SizeValueType i )
+      {
+        surface[ i ] = static_cast< float >( values[ i ] );
+      },
+      nullptr );
+  }
+
   /** Write the optimization surface to disk */
   bool writeSurfaceEachResolution = false;
   this->GetConfiguration()->ReadParameter( writeSurfaceEachResolution,
@@ -333,6 +374,9 @@ FullSearch< TElastix >
   /** Clear the full search ranges */
   this->SetSearchSpace( 0 );
 
+  /** Release the cost function contexts of this resolution. */
+  this->RemoveCostFunctionContexts();
+
 } // end AfterEachResolution()
 
 
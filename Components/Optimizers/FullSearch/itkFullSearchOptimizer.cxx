@@ -24,6 +24,9 @@
 #include "itkEventObject.h"
 #include "itkMacro.h"
 #include "itkNumericTraits.h"
+#include <algorithm>
+#include <limits>
+#include <set>
 
 namespace itk
 {
@@ -45,6 +48,12 @@ FullSearchOptimizer
   m_NumberOfSearchSpaceDimensions = 0;
   m_SearchSpace                   = 0;
   m_LastSearchSpaceChanges        = 0;
+  m_NumberOfRefinementLevels      = 0;
+  m_NumberOfRefinementCandidates  = 3;
+  m_BatchSize                     = 1024;
+  m_CurrentRefinementLevel        = 0;
+  m_NextPendingPoint              = 0;
+  m_CostFunctionEvaluator         = ConcurrentCostFunctionEvaluator::New();
 
 }   //end constructor
 
@@ -80,6 +89,17 @@ FullSearchOptimizer
     m_BestValue = NumericTraits< double >::max();
   }
 
+  /** Mark all grid points as not evaluated. */
+  m_SearchSpaceValues.assign( this->GetNumberOfIterations(),
+    std::numeric_limits< MeasureType >::quiet_NaN() );
+
+  /** Start at the coarsest level of the batched search. */
+  if( this->UseBatchedSearch() )
+  {
+    m_CurrentRefinementLevel = m_NumberOfRefinementLevels;
+    this->ComputePendingPoints();
+  }
+
   this->ResumeOptimization();
 
 }
@@ -98,6 +118,13 @@ FullSearchOptimizer
   m_Stop = false;
 
   InvokeEvent( StartEvent() );
+
+  if( this->UseBatchedSearch() )
+  {
+    this->ResumeBatchedOptimization();
+    return;
+  }
+
   while( !m_Stop )
   {
 
@@ -121,6 +148,9 @@ FullSearchOptimizer
       break;
     }
 
+    /** The iterations visit the grid in linear index order */
+    m_SearchSpaceValues[ m_CurrentIteration ] = m_Value;
+
     /** Check if the value is a minimum or maximum */
     if( ( m_Value < m_BestValue )  ^  m_Maximize )         // ^ = xor, yields true if only one of the expressions is true
     {
@@ -149,6 +179,239 @@ FullSearchOptimizer
 }   //end function ResumeOptimization
 
 
+/**
+ * ******************** UseBatchedSearch ******************
+ */
+bool
+FullSearchOptimizer
+::UseBatchedSearch( void ) const
+{
+  return m_CostFunctionEvaluator->GetNumberOfContexts() > 0 || m_NumberOfRefinementLevels > 0;
+
+} // end UseBatchedSearch()
+
+
+/**
+ * ******************** ResumeBatchedOptimization ******************
+ */
+void
+FullSearchOptimizer
+::ResumeBatchedOptimization( void )
+{
+  itkDebugMacro( "ResumeBatchedOptimization" );
+
+  std::vector< unsigned long > batch;
+  SearchSpaceValuesType        values;
+  while( !m_Stop )
+  {
+    /** Go to the next refinement level if this one is done. */
+    if( m_NextPendingPoint >= m_PendingPoints.size() )
+    {
+      if( m_CurrentRefinementLevel == 0 )
+      {
+        m_StopCondition = FullRangeSearched;
+        StopOptimization();
+        break;
+      }
+      --m_CurrentRefinementLevel;
+      this->ComputePendingPoints();
+      continue;
+    }
+
+    /** Evaluate the next batch of grid points. */
+    const std::size_t batchEnd = std::min< std::size_t >(
+      m_PendingPoints.size(), m_NextPendingPoint + m_BatchSize );
+    batch.assign( m_PendingPoints.begin() + m_NextPendingPoint,
+      m_PendingPoints.begin() + batchEnd );
+    this->EvaluateBatch( batch, values );
+
+    /** Process the results in order, as if they were evaluated one by one. */
+    for( std::size_t k = 0; k < batch.size() && !m_Stop; ++k )
+    {
+      m_Value                              = values[ k ];
+      m_SearchSpaceValues[ batch[ k ] ]    = m_Value;
+      m_CurrentIndexInSearchSpace          = this->LinearIndexToIndex( batch[ k ] );
+      m_CurrentPointInSearchSpace          = this->IndexToPoint( m_CurrentIndexInSearchSpace );
+      this->SetCurrentPosition( this->PointToPosition( m_CurrentPointInSearchSpace ) );
+      ++m_NextPendingPoint;
+
+      /** Check if the value is a minimum or maximum */
+      if( ( m_Value < m_BestValue )  ^  m_Maximize )
+      {
+        m_BestValue              = m_Value;
+        m_BestPointInSearchSpace = m_CurrentPointInSearchSpace;
+        m_BestIndexInSearchSpace = m_CurrentIndexInSearchSpace;
+      }
+
+      this->InvokeEvent( IterationEvent() );
+      m_CurrentIteration++;
+    }
+
+  } // end while
+
+} // end ResumeBatchedOptimization()
+
+
+/**
+ * ******************** ComputePendingPoints ******************
+ *
+ * At the coarsest level all grid points with indices that are a
+ * multiple of 2^level are scheduled. At the finer levels the grid
+ * points with a stride of 2^level within two strides (one cell of the
+ * previous level) of the best points found so far are scheduled.
+ */
+void
+FullSearchOptimizer
+::ComputePendingPoints( void )
+{
+  const unsigned int          dim    = this->GetNumberOfSearchSpaceDimensions();
+  const SearchSpaceSizeType & size   = this->GetSearchSpaceSize();
+  const IndexValueType        stride = static_cast< IndexValueType >( 1 ) << m_CurrentRefinementLevel;
+
+  /** The centres and the extent of the region(s) to scan. */
+  std::vector< SearchSpaceIndexType > centres;
+  IndexValueType                      radius = 0;
+  if( m_CurrentRefinementLevel == m_NumberOfRefinementLevels )
+  {
+    /** Scan the whole grid at the coarsest level. */
+    SearchSpaceIndexType centre( dim );
+    centre.Fill( 0 );
+    centres.push_back( centre );
+    radius = NumericTraits< IndexValueType >::max() / 2;
+  }
+  else
+  {
+    /** Select the best evaluated points so far. */
+    std::vector< std::pair< MeasureType, unsigned long > > evaluated;
+    for( unsigned long i = 0; i < m_SearchSpaceValues.size(); ++i )
+    {
+      const MeasureType value = m_SearchSpaceValues[ i ];
+      if( value == value )   // not NaN
+      {
+        evaluated.push_back( std::make_pair( m_Maximize ? -value : value, i ) );
+      }
+    }
+    const std::size_t numberOfCandidates = std::min< std::size_t >(
+      m_NumberOfRefinementCandidates, evaluated.size() );
+    std::partial_sort( evaluated.begin(), evaluated.begin() + numberOfCandidates,
+      evaluated.end() );
+    for( std::size_t c = 0; c < numberOfCandidates; ++c )
+    {
+      centres.push_back( this->LinearIndexToIndex( evaluated[ c ].second ) );
+    }
+    radius = 2 * stride;
+  }
+
+  /** Collect the not yet evaluated points on the stride grid around the
+   * centres, in linear index order. */
+  std::set< unsigned long > points;
+  SearchSpaceIndexType      first( dim );
+  SearchSpaceIndexType      last( dim );
+  SearchSpaceIndexType      index( dim );
+  for( std::size_t c = 0; c < centres.size(); ++c )
+  {
+    for( unsigned int d = 0; d < dim; ++d )
+    {
+      const IndexValueType maxIndex = static_cast< IndexValueType >( size[ d ] ) - 1;
+      first[ d ] = std::max< IndexValueType >( 0, centres[ c ][ d ] - radius );
+      first[ d ] = ( ( first[ d ] + stride - 1 ) / stride ) * stride;
+      last[ d ]  = std::min< IndexValueType >( maxIndex, centres[ c ][ d ] + radius );
+    }
+    index = first;
+    bool done = false;
+    while( !done )
+    {
+      const unsigned long linearIndex = this->IndexToLinearIndex( index );
+      if( m_SearchSpaceValues[ linearIndex ] != m_SearchSpaceValues[ linearIndex ] )
+      {
+        points.insert( linearIndex );
+      }
+
+      /** Next index, first dimension fastest. */
+      done = true;
+      for( unsigned int d = 0; d < dim; ++d )
+      {
+        index[ d ] += stride;
+        if( index[ d ] <= last[ d ] )
+        {
+          done = false;
+          break;
+        }
+        index[ d ] = first[ d ];
+      }
+    }
+  }
+
+  m_PendingPoints.assign( points.begin(), points.end() );
+  m_NextPendingPoint = 0;
+
+} // end ComputePendingPoints()
+
+
+/**
+ * ******************** EvaluateBatch ******************
+ */
+void
+FullSearchOptimizer
+::EvaluateBatch( const std::vector< unsigned long > & points,
+  SearchSpaceValuesType & values )
+{
+  /** Compute the positions in the main thread. */
+  std::vector< ParametersType > positions( points.size() );
+  for( std::size_t k = 0; k < points.size(); ++k )
+  {
+    positions[ k ] = this->IndexToPosition( this->LinearIndexToIndex( points[ k ] ) );
+  }
+
+  /** Evaluate them, and pass the first error to the caller. */
+  m_CostFunctionEvaluator->SetCostFunction( m_CostFunction );
+  try
+  {
+    m_CostFunctionEvaluator->GetValues( positions, values );
+  }
+  catch( ExceptionObject & err )
+  {
+    m_StopCondition = MetricError;
+    StopOptimization();
+    throw err;
+  }
+
+} // end EvaluateBatch()
+
+
+/**
+ * ******************** AddCostFunctionContext ******************
+ */
+void
+FullSearchOptimizer
+::AddCostFunctionContext( CostFunctionType * costFunction )
+{
+  if( costFunction == nullptr )
+  {
+    itkExceptionMacro( << "Cannot add a null cost function context." );
+  }
+  m_CostFunctionEvaluator->AddContext( costFunction );
+  this->Modified();
+
+} // end AddCostFunctionContext()
+
+
+/**
+ * ******************** RemoveCostFunctionContexts ******************
+ */
+void
+FullSearchOptimizer
+::RemoveCostFunctionContexts( void )
+{
+  if( m_CostFunctionEvaluator->GetNumberOfContexts() > 0 )
+  {
+    m_CostFunctionEvaluator->RemoveContexts();
+    this->Modified();
+  }
+
+} // end RemoveCostFunctionContexts()
+
+
 /**
  * ************************** Stop optimization ******************
  */
@@ -463,6 +726,51 @@ FullSearchOptimizer
 } // end IndexToPoint
 
 
+/**
+ * ********************* LinearIndexToIndex ***************************
+ */
+FullSearchOptimizer::SearchSpaceIndexType
+FullSearchOptimizer
+::LinearIndexToIndex( unsigned long linearIndex )
+{
+  const unsigned int          searchSpaceDimension = this->GetNumberOfSearchSpaceDimensions();
+  const SearchSpaceSizeType & searchSpaceSize      = this->GetSearchSpaceSize();
+  SearchSpaceIndexType        index( searchSpaceDimension );
+
+  /** The first dimension runs fastest. */
+  for( unsigned int ssdim = 0; ssdim < searchSpaceDimension; ssdim++ )
+  {
+    index[ ssdim ] = static_cast< IndexValueType >( linearIndex % searchSpaceSize[ ssdim ] );
+    linearIndex   /= searchSpaceSize[ ssdim ];
+  }
+
+  return index;
+
+} // end LinearIndexToIndex
+
+
+/**
+ * ********************* IndexToLinearIndex ***************************
+ */
+unsigned long
+FullSearchOptimizer
+::IndexToLinearIndex( const SearchSpaceIndexType & index )
+{
+  const unsigned int          searchSpaceDimension = this->GetNumberOfSearchSpaceDimensions();
+  const SearchSpaceSizeType & searchSpaceSize      = this->GetSearchSpaceSize();
+
+  unsigned long linearIndex = 0;
+  for( unsigned int ssdim = searchSpaceDimension; ssdim > 0; ssdim-- )
+  {
+    linearIndex = linearIndex * searchSpaceSize[ ssdim - 1 ]
+      + static_cast< unsigned long >( index[ ssdim - 1 ] );
+  }
+
+  return linearIndex;
+
+} // end IndexToLinearIndex
+
+
 } // end namespace itk
 
 #endif // #ifndef __itkFullSearchOptimizer_cxx
@@ -24,6 +24,9 @@
 #include "itkImage.h"
 #include "itkArray.h"
 #include "itkFixedArray.h"
+#include "itkNumericTraits.h"
+#include "itkConcurrentCostFunctionEvaluator.h"
+#include <vector>
 
 namespace itk
 {
@@ -35,6 +38,19 @@ namespace itk
  * Optimizer that scans a subspace of the parameter space
  * and searches for the best parameters.
  *
+ * By default the grid is scanned point by point with the cost function.
+ * When additional cost function contexts are added with
+ * AddCostFunctionContext(), the grid is evaluated in batches, concurrently
+ * on the cost function and the contexts. The contexts must compute the same
+ * function as the cost function and must not share mutable state with it.
+ *
+ * When NumberOfRefinementLevels is larger than zero, the grid is scanned
+ * coarse-to-fine: first every 2^L-th grid point is evaluated, after which
+ * only the neighbourhood of the NumberOfRefinementCandidates best points is
+ * densified, level by level, until the full grid resolution is reached.
+ * Grid points that are never evaluated have a NaN value in
+ * GetSearchSpaceValues().
+ *
  * \todo This optimizer has similar functionality as the recently added
  * itkExhaustiveOptimizer. See if we can replace it by that optimizer,
  * or inherit from it.
@@ -89,6 +105,10 @@ public:
   /** The size of each dimension to be searched ((max-min)/step)) */
   typedef Array< SizeValueType > SearchSpaceSizeType;
 
+  /** The cost function values of all grid points, ordered like the
+   * iterations of the full search (first search space dimension fastest). */
+  typedef std::vector< MeasureType > SearchSpaceValuesType;
+
   /** NB: The methods SetScales has no influence! */
 
   /** Methods to configure the cost function. */
@@ -191,6 +211,42 @@ public:
   /** Get Stop condition. */
   itkGetConstMacro( StopCondition, StopConditionType );
 
+  /** Get the values of all grid points of the last search. */
+  itkGetConstReferenceMacro( SearchSpaceValues, SearchSpaceValuesType );
+
+  /** Convert an iteration number to an index, and vice versa. */
+  virtual SearchSpaceIndexType LinearIndexToIndex( unsigned long linearIndex );
+
+  virtual unsigned long IndexToLinearIndex( const SearchSpaceIndexType & index );
+
+  /** Set/Get the number of coarse-to-fine refinement levels. Default: 0,
+   * which means that the full grid is searched. */
+  itkSetMacro( NumberOfRefinementLevels, unsigned int );
+  itkGetConstMacro( NumberOfRefinementLevels, unsigned int );
+
+  /** Set/Get the number of best points around which the grid is
+   * densified in the next refinement level. Default: 3. */
+  itkSetClampMacro( NumberOfRefinementCandidates, unsigned int,
+    1, NumericTraits< unsigned int >::max() );
+  itkGetConstMacro( NumberOfRefinementCandidates, unsigned int );
+
+  /** Set/Get the number of grid points that is evaluated concurrently,
+   * before the iteration events are invoked. Default: 1024. */
+  itkSetClampMacro( BatchSize, unsigned long,
+    1, NumericTraits< unsigned long >::max() );
+  itkGetConstMacro( BatchSize, unsigned long );
+
+  /** Add an independent cost function context, that may be evaluated
+   * concurrently with the cost function. */
+  virtual void AddCostFunctionContext( CostFunctionType * costFunction );
+
+  /** Remove all additional cost function contexts. */
+  virtual void RemoveCostFunctionContexts( void );
+
+  /** Get the number of additional cost function contexts. */
+  unsigned int GetNumberOfCostFunctionContexts( void ) const
+  { return this->m_CostFunctionEvaluator->GetNumberOfContexts(); }
+
 protected:
 
   FullSearchOptimizer();
@@ -215,6 +271,23 @@ protected:
   unsigned long m_LastSearchSpaceChanges;
   virtual void ProcessSearchSpaceChanges( void );
 
+  /** Whether the batched (concurrent and/or coarse-to-fine) search is used. */
+  virtual bool UseBatchedSearch( void ) const;
+
+  /** Resume the batched search. */
+  virtual void ResumeBatchedOptimization( void );
+
+  /** Fill m_PendingPoints with the grid points of the current
+   * refinement level, that have not been evaluated yet. */
+  virtual void ComputePendingPoints( void );
+
+  /** Evaluate the cost function at the given grid points, concurrently
+   * on the cost function and its contexts, see ConcurrentCostFunctionEvaluator. */
+  virtual void EvaluateBatch( const std::vector< unsigned long > & points,
+    SearchSpaceValuesType & values );
+
+  SearchSpaceValuesType m_SearchSpaceValues;
+
 private:
 
   FullSearchOptimizer( const Self & ); // purposely not implemented
@@ -222,6 +295,15 @@ private:
 
   unsigned long m_CurrentIteration;
 
+  unsigned int  m_NumberOfRefinementLevels;
+  unsigned int  m_NumberOfRefinementCandidates;
+  unsigned long m_BatchSize;
+  unsigned int  m_CurrentRefinementLevel;
+
+  ConcurrentCostFunctionEvaluator::Pointer m_CostFunctionEvaluator;
+  std::vector< unsigned long >             m_PendingPoints;
+  std::size_t                              m_NextPendingPoint;
+
 };
 
 } // end namespace itk
@@ -226,6 +226,10 @@ PreconditionedGradientDescent<TElastix>
   xl::xout["iteration"]["4a:||Gradient||"] << this->GetGradient().magnitude();
   xl::xout["iteration"]["4b:||SearchDir||"] << this->GetSearchDirection().magnitude();
 
+  /** Stop after this iteration when the optimization has stalled. */
+  this->UpdateConvergenceMonitor( this, this->GetValue(), this->GetGradient(),
+    this->GetNumberOfIterations() );
+
   /** Select new spatial samples for the computation of the metric. */
   if( this->GetNewSamplesEveryIteration() )
   {
@@ -266,7 +270,7 @@ PreconditionedGradientDescent<TElastix>
   }
 
   /** Print the stopping condition */
-  elxout << "Stopping condition: " << stopcondition << "." << std::endl;
+  this->PrintStopCondition( stopcondition );
 
   /** Store the used parameters, for later printing to screen. */
   SettingsType settings;
@@ -23,6 +23,8 @@
 #include "itkCommand.h"
 #include "itkEventObject.h"
 #include "itkMacro.h"
+#include "itkHotPathProfiler.h"
+#include "itkParameterVectorOperations.h"
 #include "vnl/vnl_math.h"
 #include "vnl/vnl_vector.h"
 #include "vnl/algo/vnl_sparse_symmetric_eigensystem.h"
@@ -59,6 +61,7 @@ PreconditionedGradientDescentOptimizer
   this->m_LargestEigenValue = 1.0;
   this->m_Sparsity = 1.0;
   this->m_ConditionNumber = 1.0;
+  this->m_Threader = MultiThreaderBase::New();
 
   /** Prepare cholmod */
   this->m_CholmodCommon = new cholmod_common;
@@ -261,6 +264,8 @@ PreconditionedGradientDescentOptimizer
   typedef DerivativeType::ValueType      DerivativeValueType;
   typedef DerivativeType::const_iterator DerivativeIteratorType;
 
+  elxProfileScope( OptimizerUpdatePhase );
+
   const unsigned int spaceDimension =
     this->GetScaledCostFunction()->GetNumberOfParameters();
 
@@ -272,13 +277,12 @@ PreconditionedGradientDescentOptimizer
 
   /** Compute the new position */
   ParametersType newPosition( spaceDimension );
-  for( unsigned int j = 0; j < spaceDimension; ++j )
-  {
-    newPosition[ j ] = currentPosition[ j ] - this->m_LearningRate * searchDirection[ j ];
-  }
+  ParameterVectorOperations::AddScaled( currentPosition, -this->m_LearningRate, searchDirection, newPosition,
+    this->m_Threader );
 
   this->SetScaledCurrentPosition( newPosition );
 
+  elxProfileScopeEnd();
   this->InvokeEvent( IterationEvent() );
 
 } // end AdvanceOneStep()
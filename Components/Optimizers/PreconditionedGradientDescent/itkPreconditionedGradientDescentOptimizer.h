@@ -20,6 +20,7 @@
 
 #include "itkScaledSingleValuedNonLinearOptimizer.h"
 #include "itkArray2D.h"
+#include "itkMultiThreaderBase.h"
 #include "vnl/vnl_sparse_matrix.h"
 #include "cholmod.h"
 
@@ -202,6 +203,9 @@ protected:
   cholmod_factor * m_CholmodFactor;
   cholmod_sparse * m_CholmodGradient;
 
+  /** The threader of the parameter vector operations. */
+  MultiThreaderBase::Pointer m_Threader;
+
   /** Solve Hx = g, using the Cholesky decomposition of the preconditioner.
    * Matlab notation: x = L'\(L\g) = Pg = searchDirection
    * The last argument can be used to also solve different systems, like L x = g.
@@ -29,6 +29,8 @@
 #include <utility>
 #include "itkAdvancedImageToImageMetric.h"
 #include "itkTimeProbe.h"
+#include "itkHotPathProfiler.h"
+#include "itkParameterVectorOperations.h"
 
 #ifdef ELASTIX_USE_OPENMP
 #include <omp.h>
@@ -328,6 +330,10 @@ PreconditionedStochasticGradientDescent< TElastix >
     xl::xout[ "iteration" ][ "4b:||SearchDirection||" ] << this->GetSearchDirection().magnitude();
   }
 
+  /** Stop after this iteration when the optimization has stalled. */
+  this->UpdateConvergenceMonitor( this, this->GetValue(), this->GetGradient(),
+    this->GetNumberOfIterations() );
+
   /** Select new spatial samples for the computation of the metric. */
   if( this->GetNewSamplesEveryIteration() )
   {
@@ -378,7 +384,7 @@ PreconditionedStochasticGradientDescent< TElastix >
   }
 
   /** Print the stopping condition. */
-  elxout << "Stopping condition: " << stopcondition << "." << std::endl;
+  this->PrintStopCondition( stopcondition );
 
   /** Store the used parameters, for later printing to screen. */
   SettingsType settings;
@@ -452,6 +458,8 @@ void
 PreconditionedStochasticGradientDescent< TElastix >
 ::AdvanceOneStep( void )
 {
+  elxProfileScope( OptimizerUpdatePhase );
+
   /** Get space dimension. */
   const unsigned int spaceDimension = this->GetScaledCostFunction()->GetNumberOfParameters();
 
@@ -468,14 +476,24 @@ PreconditionedStochasticGradientDescent< TElastix >
   const ParametersType & currentPosition = this->GetScaledCurrentPosition();
 
   /** Update the new position. */
-  const double lamda2 = lamda * this->m_NoiseFactor;
-  for( unsigned int j = 0; j < spaceDimension; ++j )
-  {
-    searchDirection[ j ] = this->m_PreconditionVector[ j ] * this->m_Gradient[ j ];
-    newPosition[ j ] = currentPosition[ j ] - lamda2 * searchDirection[ j ];
-  }
+  const double   lamda2             = lamda * this->m_NoiseFactor;
+  const double * gradient           = this->m_Gradient.data_block();
+  const double * preconditionVector = this->m_PreconditionVector.data_block();
+  double *       searchDir          = searchDirection.data_block();
+  const double * current            = currentPosition.data_block();
+  double *       next               = newPosition.data_block();
+  itk::ParameterVectorOperations::ParallelFor( spaceDimension,
+    [ = ]( const std::size_t first, const std::size_t last )
+    {
+      for( std::size_t j = first; j < last; ++j )
+      {
+        searchDir[ j ] = preconditionVector[ j ] * gradient[ j ];
+        next[ j ]      = current[ j ] - lamda2 * searchDir[ j ];
+      }
+    }, this->m_Threader );
 
   this->Superclass1::UpdateCurrentTime();
+  elxProfileScopeEnd();
   this->InvokeEvent( itk::IterationEvent() );
 
 } // end AdvanceOneStep()
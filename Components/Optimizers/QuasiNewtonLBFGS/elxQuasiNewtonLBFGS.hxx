@@ -368,6 +368,10 @@ QuasiNewtonLBFGS< TElastix >
 
   if( !( this->GetInLineSearch() ) )
   {
+    /** Stop after this iteration when the optimization has stalled. */
+    this->UpdateConvergenceMonitor( this, this->GetCurrentValue(), this->GetCurrentGradient(),
+      this->GetMaximumNumberOfIterations() );
+
     /** If new samples: compute a new gradient and value. These
      * will be used in the computation of a new search direction */
     if( this->GetNewSamplesEveryIteration() )
@@ -454,7 +458,7 @@ QuasiNewtonLBFGS< TElastix >
   }
 
   /** Print the stopping condition */
-  elxout << "Stopping condition: " << stopcondition << "." << std::endl;
+  this->PrintStopCondition( stopcondition );
 
 } // end AfterEachResolution
 
@@ -21,6 +21,7 @@
 
 #include "itkQuasiNewtonLBFGSOptimizer.h"
 #include "itkArray.h"
+#include "itkParameterVectorOperations.h"
 #include "vnl/vnl_math.h"
 
 namespace itk
@@ -43,6 +44,7 @@ QuasiNewtonLBFGSOptimizer::QuasiNewtonLBFGSOptimizer()
   this->m_Point             = 0;
   this->m_PreviousPoint     = 0;
   this->m_Bound             = 0;
+  this->m_Threader          = MultiThreaderBase::New();
 
   this->m_MaximumNumberOfIterations  = 100;
   this->m_GradientMagnitudeTolerance = 1e-5;
@@ -246,7 +248,7 @@ QuasiNewtonLBFGSOptimizer::ComputeDiagonalMatrix( DiagonalMatrixType & diag_H0 )
   {
     const DerivativeType & y  = this->m_Y[ this->m_PreviousPoint ];
     const double           ys = 1.0 / this->m_Rho[ this->m_PreviousPoint ];
-    const double           yy = y.squared_magnitude();
+    const double           yy = ParameterVectorOperations::SquaredNorm( y, this->m_Threader );
     fill_value = ys / yy;
     if( fill_value <= 0. )
     {
@@ -276,11 +278,11 @@ QuasiNewtonLBFGSOptimizer::ComputeSearchDirection(
   typedef Array< double > AlphaType;
   AlphaType alpha( this->GetMemory() );
 
-  const unsigned int numberOfParameters = gradient.GetSize();
   DiagonalMatrixType H0;
   this->ComputeDiagonalMatrix( H0 );
 
-  searchDir = -gradient;
+  searchDir = gradient;
+  ParameterVectorOperations::Scale( -1.0, searchDir, this->m_Threader );
 
   int cp = static_cast< int >( this->m_Point );
 
@@ -291,31 +293,19 @@ QuasiNewtonLBFGSOptimizer::ComputeSearchDirection(
     {
       cp = this->GetMemory() - 1;
     }
-    const double sq = inner_product( this->m_S[ cp ], searchDir );
+    const double sq = ParameterVectorOperations::Dot( this->m_S[ cp ], searchDir, this->m_Threader );
     alpha[ cp ] = this->m_Rho[ cp ] * sq;
-    const double &         alpha_cp = alpha[ cp ];
-    const DerivativeType & y        = this->m_Y[ cp ];
-    for( unsigned int j = 0; j < numberOfParameters; ++j )
-    {
-      searchDir[ j ] -= alpha_cp * y[ j ];
-    }
+    ParameterVectorOperations::Axpy( -alpha[ cp ], this->m_Y[ cp ], searchDir, this->m_Threader );
   }
 
-  for( unsigned int j = 0; j < numberOfParameters; ++j )
-  {
-    searchDir[ j ] *= H0[ j ];
-  }
+  ParameterVectorOperations::Multiply( H0, searchDir, this->m_Threader );
 
   for( unsigned int i = 0; i < this->m_Bound; ++i )
   {
-    const double           yr             = inner_product( this->m_Y[ cp ], searchDir );
-    const double           beta           = this->m_Rho[ cp ] * yr;
-    const double           alpha_min_beta = alpha[ cp ] - beta;
-    const ParametersType & s              = this->m_S[ cp ];
-    for( unsigned int j = 0; j < numberOfParameters; ++j )
-    {
-      searchDir[ j ] += alpha_min_beta * s[ j ];
-    }
+    const double yr             = ParameterVectorOperations::Dot( this->m_Y[ cp ], searchDir, this->m_Threader );
+    const double beta           = this->m_Rho[ cp ] * yr;
+    const double alpha_min_beta = alpha[ cp ] - beta;
+    ParameterVectorOperations::Axpy( alpha_min_beta, this->m_S[ cp ], searchDir, this->m_Threader );
     ++cp;
     if( static_cast< unsigned int >( cp ) == this->GetMemory() )
     {
@@ -326,7 +316,8 @@ QuasiNewtonLBFGSOptimizer::ComputeSearchDirection(
   /** Normalize if no information about previous steps is available yet */
   if( this->m_Bound == 0 )
   {
-    searchDir /= gradient.magnitude();
+    ParameterVectorOperations::Scale( 1.0 / ParameterVectorOperations::Norm( gradient, this->m_Threader ),
+      searchDir, this->m_Threader );
   }
 
 } // end ComputeSearchDirection
@@ -409,7 +400,7 @@ QuasiNewtonLBFGSOptimizer::StoreCurrentPoint(
 
   this->m_S[ this->m_Point ]   = step;                                  // s
   this->m_Y[ this->m_Point ]   = grad_dif;                              // y
-  this->m_Rho[ this->m_Point ] = 1.0 / inner_product( step, grad_dif ); // 1/ys
+  this->m_Rho[ this->m_Point ] = 1.0 / ParameterVectorOperations::Dot( step, grad_dif, this->m_Threader ); // 1/ys
 
 } // end StoreCurrentPoint
 
@@ -21,6 +21,7 @@
 
 #include "itkScaledSingleValuedNonLinearOptimizer.h"
 #include "itkLineSearchOptimizer.h"
+#include "itkMultiThreaderBase.h"
 #include <vector>
 
 namespace itk
@@ -155,6 +156,9 @@ protected:
   unsigned int m_PreviousPoint;
   unsigned int m_Bound;
 
+  /** The threader of the parameter vector operations. */
+  MultiThreaderBase::Pointer m_Threader;
+
   itkSetMacro( InLineSearch, bool );
 
   /** Compute H0
@@ -114,6 +114,10 @@ RSGDEachParameterApart< TElastix >
   xl::xout[ "iteration" ][ "3:StepSize" ] << this->GetCurrentStepLength();
   xl::xout[ "iteration" ][ "4:||Gradient||" ] << this->GetGradientMagnitude();
 
+  /** Stop after this iteration when the optimization has stalled. */
+  this->UpdateConvergenceMonitor( this, this->GetValue(), this->GetGradient(),
+    this->GetNumberOfIterations() );
+
 } // end AfterEachIteration
 
 
@@ -167,7 +171,7 @@ RSGDEachParameterApart< TElastix >
   }
   /** Print the stopping condition */
 
-  elxout << "Stopping condition: " << stopcondition << "." << std::endl;
+  this->PrintStopCondition( stopcondition );
 
 } // end AfterEachResolution
 
@@ -22,6 +22,7 @@
 #include "itkRSGDEachParameterApartBaseOptimizer.h"
 #include "itkCommand.h"
 #include "itkEventObject.h"
+#include "itkHotPathProfiler.h"
 #include "vnl/vnl_math.h"
 
 namespace itk
@@ -177,6 +178,7 @@ RSGDEachParameterApartBaseOptimizer
 {
 
   itkDebugMacro( "AdvanceOneStep" );
+  elxProfileScope( OptimizerUpdatePhase );
 
   const unsigned int spaceDimension
     = m_CostFunction->GetNumberOfParameters();
@@ -213,6 +215,7 @@ RSGDEachParameterApartBaseOptimizer
 
   if( m_GradientMagnitude < m_GradientMagnitudeTolerance )
   {
+    elxProfileScopeEnd();
     m_StopCondition = GradientMagnitudeTolerance;
     StopOptimization();
     return;
@@ -247,6 +250,7 @@ RSGDEachParameterApartBaseOptimizer
    */
   if( biggestCurrentStepLength < m_MinimumStepLength )
   {
+    elxProfileScopeEnd();
     m_StopCondition = StepTooSmall;
     StopOptimization();
     return;
@@ -273,6 +277,7 @@ RSGDEachParameterApartBaseOptimizer
   // be overloaded in non-vector spaces
   this->StepAlongGradient( factor, transformedGradient );
 
+  elxProfileScopeEnd();
   this->InvokeEvent( IterationEvent() );
 
 }
@@ -110,6 +110,10 @@ RegularStepGradientDescent< TElastix >
   xl::xout[ "iteration" ][ "2:Metric" ] << this->GetValue();
   xl::xout[ "iteration" ][ "3:StepSize" ] << this->GetCurrentStepLength();
   xl::xout[ "iteration" ][ "4:||Gradient||" ] << this->GetGradient().magnitude();
+
+  /** Stop after this iteration when the optimization has stalled. */
+  this->UpdateConvergenceMonitor( this, this->GetValue(), this->GetGradient(),
+    this->GetNumberOfIterations() );
 } // end AfterEachIteration
 
 
@@ -157,9 +161,10 @@ RegularStepGradientDescent< TElastix >
       break;
 
   }
+
   /** Print the stopping condition */
 
-  elxout << "Stopping condition: " << stopcondition << "." << std::endl;
+  this->PrintStopCondition( stopcondition );
 
 } // end AfterEachResolution
 
@@ -20,6 +20,7 @@
 
 #include "elxIncludes.h" // include first to avoid MSVS warning
 #include "itkSPSAOptimizer.h"
+#include "itkConcurrentCostFunctionEvaluator.h"
 
 namespace elastix
 {
@@ -32,6 +33,14 @@ namespace elastix
  *
  * This optimizer supports the NewSamplesEveryIteration parameter.
  *
+ * When cost function contexts are added with AddCostFunctionContext(),
+ * all positions of the perturbations of an iteration are evaluated
+ * concurrently, see ConcurrentCostFunctionEvaluator, also for a single
+ * perturbation. The perturbations are drawn in the same order as in the
+ * sequential case, and the samples are updated before the other
+ * perturbations are drawn, so for a fixed seed both modes give the same
+ * results.
+ *
  * The parameters used in this class are:
  * \parameter Optimizer: Select this optimizer as follows:\n
  *    <tt>(Optimizer "SimultaneousPerturbation")</tt>
@@ -111,6 +120,7 @@ public:
   typedef Superclass1::CostFunctionType    CostFunctionType;
   typedef Superclass1::CostFunctionPointer CostFunctionPointer;
   typedef Superclass1::StopConditionType   StopConditionType;
+  typedef Superclass1::ScalesType          ScalesType;
 
   /** Typedef's inherited from Elastix.*/
   typedef typename Superclass2::ElastixType          ElastixType;
@@ -123,6 +133,7 @@ public:
 
   /** Typedef for the ParametersType. */
   typedef typename Superclass1::ParametersType ParametersType;
+  typedef typename Superclass1::DerivativeType DerivativeType;
 
   /** Methods that take care of setting parameters and printing progress information.*/
   void BeforeRegistration( void ) override;
@@ -135,12 +146,28 @@ public:
 
   void AfterRegistration( void ) override;
 
+  /** Add the cost function contexts and call the superclass' implementation. */
+  void StartOptimization( void ) override;
+
   /** Override the SetInitialPosition.
    * Override the implementation in itkOptimizer.h, to
    * ensure that the scales array and the parameters
    * array have the same size. */
   void SetInitialPosition( const ParametersType & param ) override;
 
+  /** Add an independent cost function context, that may be evaluated
+   * concurrently with the cost function. The context must compute the
+   * same function as the cost function and must not share mutable
+   * state with it. */
+  virtual void AddCostFunctionContext( CostFunctionType * costFunction );
+
+  /** Remove all additional cost function contexts. */
+  virtual void RemoveCostFunctionContexts( void );
+
+  /** Get the number of additional cost function contexts. */
+  unsigned int GetNumberOfCostFunctionContexts( void ) const
+  { return this->m_CostFunctionEvaluator->GetNumberOfContexts(); }
+
 protected:
 
   SimultaneousPerturbation();
@@ -148,11 +175,19 @@ protected:
 
   bool m_ShowMetricValues;
 
+  /** Compute the gradient estimate. Evaluates the perturbations
+   * concurrently if cost function contexts are available. */
+  void ComputeGradient( const ParametersType & parameters,
+    DerivativeType & gradient ) override;
+
 private:
 
   SimultaneousPerturbation( const Self & );     // purposely not implemented
   void operator=( const Self & );               // purposely not implemented
 
+  typedef itk::ConcurrentCostFunctionEvaluator CostFunctionEvaluatorType;
+  CostFunctionEvaluatorType::Pointer m_CostFunctionEvaluator;
+
 };
 
 } // end namespace elastix
@@ -35,7 +35,12 @@ template< class TElastix >
 SimultaneousPerturbation< TElastix >
 ::SimultaneousPerturbation()
 {
-  this->m_ShowMetricValues = false;
+  this->m_ShowMetricValues      = false;
+  this->m_CostFunctionEvaluator = CostFunctionEvaluatorType::New();
+
+  /** All positions are evaluated concurrently; ComputeGradient() updates
+   * the samples first. */
+  this->m_CostFunctionEvaluator->EvaluateFirstPositionFirstOff();
 } // end Constructor
 
 
@@ -122,6 +127,23 @@ SimultaneousPerturbation< TElastix >
 } // end BeforeEachResolution
 
 
+/**
+ * ******************* StartOptimization ***********************
+ */
+
+template< class TElastix >
+void
+SimultaneousPerturbation< TElastix >
+::StartOptimization( void )
+{
+  /** Evaluate the cost function concurrently, if requested. */
+  this->SetCostFunctionContexts( this );
+
+  this->Superclass1::StartOptimization();
+
+} // end StartOptimization()
+
+
 /**
  * ***************** AfterEachIteration *************************
  */
@@ -135,7 +157,15 @@ SimultaneousPerturbation< TElastix >
 
   if( this->m_ShowMetricValues )
   {
-    xl::xout[ "iteration" ][ "2:Metric" ] << this->GetValue();
+    const double value = this->GetValue();
+    xl::xout[ "iteration" ][ "2:Metric" ] << value;
+
+    /** Stop after this iteration when the optimization has stalled. The
+     * perturbation gradient is random, also for fixed samples, so only the
+     * values and the parameter changes are monitored.
+     */
+    this->UpdateConvergenceMonitor( this, value, itk::Array< double >(),
+      this->GetMaximumNumberOfIterations() );
   }
   else
   {
@@ -191,7 +221,10 @@ SimultaneousPerturbation< TElastix >
   }
   /** Print the stopping condition */
 
-  elxout << "Stopping condition: " << stopcondition << "." << std::endl;
+  this->PrintStopCondition( stopcondition );
+
+  /** Release the cost function contexts of this resolution. */
+  this->RemoveCostFunctionContexts();
 
 } // end AfterEachResolution
 
@@ -251,6 +284,118 @@ SimultaneousPerturbation< TElastix >
 } // end SetInitialPosition
 
 
+/**
+ * ******************* AddCostFunctionContext ***********************
+ */
+
+template< class TElastix >
+void
+SimultaneousPerturbation< TElastix >
+::AddCostFunctionContext( CostFunctionType * costFunction )
+{
+  if( costFunction == nullptr )
+  {
+    itkExceptionMacro( << "Cannot add a null cost function context." );
+  }
+  this->m_CostFunctionEvaluator->AddContext( costFunction );
+  this->Modified();
+
+} // end AddCostFunctionContext()
+
+
+/**
+ * ******************* RemoveCostFunctionContexts ***********************
+ */
+
+template< class TElastix >
+void
+SimultaneousPerturbation< TElastix >
+::RemoveCostFunctionContexts( void )
+{
+  if( this->m_CostFunctionEvaluator->GetNumberOfContexts() > 0 )
+  {
+    this->m_CostFunctionEvaluator->RemoveContexts();
+    this->Modified();
+  }
+
+} // end RemoveCostFunctionContexts()
+
+
+/**
+ * ******************* ComputeGradient ***********************
+ */
+
+template< class TElastix >
+void
+SimultaneousPerturbation< TElastix >
+::ComputeGradient( const ParametersType & parameters, DerivativeType & gradient )
+{
+  /** Without contexts, use the sequential implementation. */
+  if( this->m_CostFunctionEvaluator->GetNumberOfContexts() == 0 )
+  {
+    this->Superclass1::ComputeGradient( parameters, gradient );
+    return;
+  }
+
+  const unsigned int spaceDimension        = parameters.GetSize();
+  const unsigned int numberOfPerturbations = this->GetNumberOfPerturbations();
+  const double       ck                    = this->Compute_c( this->GetCurrentIteration() );
+
+  /** Make sure the scales have been set properly. */
+  const ScalesType & scales = this->GetScales();
+  if( scales.size() != spaceDimension )
+  {
+    itkExceptionMacro( << "The size of Scales is " << scales.size()
+                       << ", but the NumberOfParameters for the CostFunction is "
+                       << spaceDimension << "." );
+  }
+
+  /** Draw the perturbations in the same order as the sequential implementation,
+   * and collect the positions theta + ck delta and theta - ck delta. The samples
+   * are updated after the first perturbation is drawn, so that the random
+   * numbers of new samples are drawn at the same point as in the first
+   * evaluation of the sequential implementation. */
+  std::vector< DerivativeType > deltas( numberOfPerturbations );
+  std::vector< ParametersType > positions( 2 * numberOfPerturbations, parameters );
+  std::vector< double >         values;
+  for( unsigned int p = 0; p < numberOfPerturbations; ++p )
+  {
+    this->GenerateDelta( spaceDimension );
+    deltas[ p ] = this->m_Delta;
+    for( unsigned int j = 0; j < spaceDimension; ++j )
+    {
+      positions[ 2 * p ][ j ]     = parameters[ j ] + ck * deltas[ p ][ j ];
+      positions[ 2 * p + 1 ][ j ] = parameters[ j ] - ck * deltas[ p ][ j ];
+    }
+    if( p == 0 )
+    {
+      this->UpdateImageSamplers();
+    }
+  }
+
+  /** Evaluate all positions concurrently. The first error is passed on. */
+  this->m_CostFunctionEvaluator->SetCostFunction( this->GetCostFunction() );
+  this->m_CostFunctionEvaluator->GetValues( positions, values );
+
+  /** Combine the results in perturbation order, like the sequential implementation. */
+  gradient.SetSize( spaceDimension );
+  gradient.Fill( 0.0 );
+  for( unsigned int p = 0; p < numberOfPerturbations; ++p )
+  {
+    const double valuediff = ( values[ 2 * p ] - values[ 2 * p + 1 ] ) / ( 2 * ck );
+    for( unsigned int j = 0; j < spaceDimension; ++j )
+    {
+      gradient[ j ] += valuediff / deltas[ p ][ j ];
+    }
+  }
+  for( unsigned int j = 0; j < spaceDimension; ++j )
+  {
+    gradient[ j ] /= ( vnl_math::sqr( scales[ j ] ) * static_cast< double >( numberOfPerturbations ) );
+  }
+
+} // end ComputeGradient()
+
+
 } // end namespace elastix
 
 #endif // end #ifndef __elxSimultaneousPerturbation_hxx
@@ -125,6 +125,10 @@ StandardGradientDescent< TElastix >
   xl::xout[ "iteration" ][ "3:StepSize" ] << this->GetLearningRate();
   xl::xout[ "iteration" ][ "4:||Gradient||" ] << this->GetGradient().magnitude();
 
+  /** Stop after this iteration when the optimization has stalled. */
+  this->UpdateConvergenceMonitor( this, this->GetValue(), this->GetGradient(),
+    this->GetNumberOfIterations() );
+
   /** Select new spatial samples for the computation of the metric */
   if( this->GetNewSamplesEveryIteration() )
   {
@@ -165,7 +169,7 @@ StandardGradientDescent< TElastix >
   }
 
   /** Print the stopping condition */
-  elxout << "Stopping condition: " << stopcondition << "." << std::endl;
+  this->PrintStopCondition( stopcondition );
 
 } // end AfterEachResolution()
 
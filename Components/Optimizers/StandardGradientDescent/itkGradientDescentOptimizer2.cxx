@@ -21,10 +21,8 @@
 #include "itkCommand.h"
 #include "itkEventObject.h"
 #include "itkMacro.h"
-
-#ifdef ELASTIX_USE_OPENMP
-#include <omp.h>
-#endif
+#include "itkHotPathProfiler.h"
+#include "itkParameterVectorOperations.h"
 
 
 namespace itk
@@ -45,6 +43,7 @@ GradientDescentOptimizer2
   this->m_CurrentIteration   = 0;
   this->m_Value              = 0.0;
   this->m_StopCondition      = MaximumNumberOfIterations;
+  this->m_Threader           = MultiThreaderBase::New();
 
   this->m_UseOpenMP      = false;
 #ifdef ELASTIX_USE_OPENMP
@@ -200,38 +199,16 @@ GradientDescentOptimizer2
 ::AdvanceOneStep( void )
 {
   itkDebugMacro( "AdvanceOneStep" );
+  elxProfileScope( OptimizerUpdatePhase );
 
-  /** Get space dimension. */
-  const unsigned int spaceDimension = this->GetScaledCostFunction()->GetNumberOfParameters();
-
-  /** Get a reference to the previously allocated newPosition. */
+  /** Update the new position in place: newPosition = currentPosition - learningRate * gradient.
+   * The update is only multi-threaded for large numbers of parameters.
+   */
   ParametersType & newPosition = this->m_ScaledCurrentPosition;
+  ParameterVectorOperations::AddScaled( newPosition, -this->m_LearningRate, this->m_Gradient, newPosition,
+    this->m_Threader );
 
-  /** Advance one step. */
-#if 1 // force single-threaded since it is fastest most of the times
-//#ifndef ELASTIX_USE_OPENMP // If no OpenMP detected then use single-threaded code
-  /** Get a reference to the current position. */
-  const ParametersType & currentPosition = this->GetScaledCurrentPosition();
-
-  /** Update the new position. */
-  for( unsigned int j = 0; j < spaceDimension; ++j )
-  {
-    newPosition[ j ] = currentPosition[ j ] - this->m_LearningRate * this->m_Gradient[ j ];
-  }
-#else // Otherwise use OpenMP
-  /** Get a reference to the current position. */
-  const ParametersType & currentPosition = this->GetScaledCurrentPosition();
-
-  /** Update the new position. */
-  const int nthreads = static_cast< int >( this->m_Threader->GetNumberOfWorkUnits() );
-  omp_set_num_threads( nthreads );
-  #pragma omp parallel for
-  for( int j = 0; j < static_cast< int >( spaceDimension ); j++ )
-  {
-    newPosition[ j ] = currentPosition[ j ] - this->m_LearningRate * this->m_Gradient[ j ];
-  }
-#endif
-
+  elxProfileScopeEnd();
   this->InvokeEvent( IterationEvent() );
 
 } // end AdvanceOneStep()
@@ -19,6 +19,7 @@
 #define __itkGradientDescentOptimizer2_h
 
 #include "itkScaledSingleValuedNonLinearOptimizer.h"
+#include "itkMultiThreaderBase.h"
 
 
 namespace itk
@@ -133,6 +134,12 @@ public:
   /** Set use OpenMP or not. */
   itkSetMacro( UseOpenMP, bool );
 
+  /** Set the number of threads used to update the parameters. */
+  void SetNumberOfWorkUnits( ThreadIdType numberOfThreads )
+  {
+    this->m_Threader->SetNumberOfWorkUnits( numberOfThreads );
+  }
+
 protected:
 
   GradientDescentOptimizer2();
@@ -150,6 +157,9 @@ protected:
   unsigned long m_NumberOfIterations;
   unsigned long m_CurrentIteration;
 
+  /** The threader of the parameter vector operations. */
+  MultiThreaderBase::Pointer m_Threader;
+
 private:
 
   GradientDescentOptimizer2( const Self & ); // purposely not implemented
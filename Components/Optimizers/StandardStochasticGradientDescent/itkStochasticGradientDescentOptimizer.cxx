@@ -20,6 +20,8 @@
 #include "itkCommand.h"
 #include "itkEventObject.h"
 #include "itkMacro.h"
+#include "itkHotPathProfiler.h"
+#include "itkParameterVectorOperations.h"
 
 #ifdef ELASTIX_USE_OPENMP
 #include <omp.h>
@@ -218,6 +220,7 @@ StochasticGradientDescentOptimizer
 ::AdvanceOneStep( void )
 {
   itkDebugMacro( "AdvanceOneStep" );
+  elxProfileScope( OptimizerUpdatePhase );
 
   /** Get space dimension. */
   const unsigned int spaceDimension
@@ -227,18 +230,13 @@ StochasticGradientDescentOptimizer
   ParametersType & newPosition = this->m_ScaledCurrentPosition;
 
   /** Advance one step. */
-  // single-threadedly
-  if( !this->m_UseMultiThread || true ) // for now force single-threaded since it is fastest most of the times
+  // with the shared vector operations, which only multi-thread large numbers of parameters
+  if( !this->m_UseMultiThread || true ) // for now force this, since it is fastest most of the times
   //if( !this->m_UseMultiThread && false ) // force multi-threaded
   {
-    /** Get a reference to the current position. */
-    const ParametersType & currentPosition = this->GetScaledCurrentPosition();
-
-    /** Update the new position. */
-    for( unsigned int j = 0; j < spaceDimension; j++ )
-    {
-      newPosition[ j ] = currentPosition[ j ] - this->m_LearningRate * this->m_Gradient[ j ];
-    }
+    /** Update the new position in place. */
+    ParameterVectorOperations::AddScaled( newPosition, -this->m_LearningRate, this->m_Gradient, newPosition,
+      this->m_Threader );
   }
 #ifdef ELASTIX_USE_OPENMP
   else if( this->m_UseOpenMP && !this->m_UseEigen )
@@ -320,6 +318,7 @@ StochasticGradientDescentOptimizer
     delete temp;
   }
 
+  elxProfileScopeEnd();
   this->InvokeEvent( IterationEvent() );
 
 } // end AdvanceOneStep()
@@ -89,6 +89,10 @@ namespace elastix
  *    example: <tt>(Metric1Use "true" "false")</tt> \n
  *    The default is "true".
  *
+ * Copies of the combined metric, to evaluate it concurrently, see
+ * CreateCostFunctionContext(), are supported when all metrics are
+ * image metrics of the AdvancedImageToImageMetric type.
+ *
  * \ingroup Registrations
  */
 
@@ -207,6 +211,11 @@ public:
    */
   void AfterEachIteration( void ) override;
 
+  /** Create an independent copy of the combination metric, that combines
+   * copies of the metrics with the same weights.
+   */
+  itk::SingleValuedCostFunction::Pointer CreateCostFunctionContext( void ) const override;
+
 protected:
 
   /** The constructor. */
@@ -561,6 +561,67 @@ MultiMetricMultiResolutionRegistration< TElastix >
 } // end UpdateMovingMasks()
 
 
+/**
+ * ******************* CreateCostFunctionContext ***********************
+ */
+
+template< class TElastix >
+itk::SingleValuedCostFunction::Pointer
+MultiMetricMultiResolutionRegistration< TElastix >
+::CreateCostFunctionContext( void ) const
+{
+  typename ITKBaseType::TransformPointer transform = this->CreateTransformContext();
+  if( transform.IsNull() )
+  {
+    return nullptr;
+  }
+
+  const CombinationMetricType * combinationMetric = this->GetCombinationMetric();
+  CombinationMetricPointer      context           = CombinationMetricType::New();
+  const unsigned int            nrOfMetrics       = combinationMetric->GetNumberOfMetrics();
+  context->SetNumberOfMetrics( nrOfMetrics );
+
+  /** Combine copies of the metrics, with the same weights. */
+  for( unsigned int i = 0; i < nrOfMetrics; ++i )
+  {
+    typename ElastixType::MetricBaseType::AdvancedMetricPointer metricContext
+      = this->GetElastix()->GetElxMetricBase( i )->CreateCostFunctionContext( transform, i );
+    if( metricContext.IsNull() )
+    {
+      return nullptr;
+    }
+    context->SetMetric( metricContext, i );
+    context->SetMetricWeight( combinationMetric->GetMetricWeight( i ), i );
+    context->SetMetricRelativeWeight( combinationMetric->GetMetricRelativeWeight( i ), i );
+    context->SetUseMetric( combinationMetric->GetUseMetric( i ), i );
+  }
+  context->SetUseRelativeWeights( this->GetCombinationMetric()->GetUseRelativeWeights() );
+  context->SetUseMultiThread( combinationMetric->GetUseMultiThread() );
+
+  /** Connect the same images, masks and interpolators. */
+  typedef typename CombinationMetricType::FixedImageMaskType  FixedImageMaskType;
+  typedef typename CombinationMetricType::MovingImageMaskType MovingImageMaskType;
+  typedef typename CombinationMetricType::InterpolatorType    MetricInterpolatorType;
+  context->SetTransform( transform );
+  for( unsigned int i = 0; i < nrOfMetrics; ++i )
+  {
+    context->SetFixedImage( combinationMetric->GetFixedImage( i ), i );
+    context->SetFixedImageRegion( combinationMetric->GetFixedImageRegion( i ), i );
+    context->SetFixedImageMask( const_cast< FixedImageMaskType * >(
+      combinationMetric->GetFixedImageMask( i ) ), i );
+    context->SetMovingImage( combinationMetric->GetMovingImage( i ), i );
+    context->SetMovingImageMask( const_cast< MovingImageMaskType * >(
+      combinationMetric->GetMovingImageMask( i ) ), i );
+    context->SetInterpolator( const_cast< MetricInterpolatorType * >(
+      combinationMetric->GetInterpolator( i ) ), i );
+  }
+
+  context->Initialize();
+  return context.GetPointer();
+
+} // end CreateCostFunctionContext()
+
+
 } // end namespace elastix
 
 #endif // end #ifndef __elxMultiMetricMultiResolutionRegistration_HXX__
@@ -369,7 +369,9 @@ public:
    */
   const SizeValueType & GetNumberOfPixelsCounted( void ) const override;
 
-  /** Pass initialization to all sub metrics. */
+  /** Pass initialization to all sub metrics. An image sampler that is shared
+   * by several sub metrics only uses lazy sampling if all of them support it.
+   */
   void Initialize( void ) override;
 
   /**
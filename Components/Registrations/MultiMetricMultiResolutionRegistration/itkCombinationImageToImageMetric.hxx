@@ -643,6 +643,21 @@ CombinationImageToImageMetric< TFixedImage, TMovingImage >
     }
   }
 
+  /** Metrics may share an image sampler, and each of them sets whether the
+   * sampler uses lazy sampling. Such a sampler only uses lazy sampling when
+   * all of its metrics can iterate over its sample grid, independent of the
+   * order in which the metrics were initialized.
+   */
+  for( unsigned int i = 0; i < this->GetNumberOfMetrics(); i++ )
+  {
+    const ImageMetricType * testPtr = dynamic_cast< const ImageMetricType * >( this->GetMetric( i ) );
+    if( testPtr && testPtr->GetUseImageSampler() && testPtr->GetImageSampler()
+      && !testPtr->CanUseLazyImageSampling() )
+    {
+      testPtr->GetImageSampler()->SetUseLazySampling( false );
+    }
+  }
+
 } // end Initialize()
 
 
@@ -0,0 +1,120 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __elxScanlineResampler_h
+#define __elxScanlineResampler_h
+
+#include "elxIncludes.h" // include first to avoid MSVS warning
+#include "itkScanlineResampleImageFilter.h"
+
+namespace elastix
+{
+
+/**
+ * \class ScanlineResampler
+ * \brief A resampler based on the itk::ScanlineResampleImageFilter.
+ *
+ * For linear transforms and B-spline transforms (optionally combined with
+ * a linear initial transform) this resampler steps along the output
+ * scanlines, instead of transforming every voxel separately. Other
+ * transforms are resampled as by the DefaultResampler.
+ *
+ * The parameters used in this class are:
+ * \parameter Resampler: Select this resampler as follows:\n
+ *    <tt>(Resampler "ScanlineResampler")</tt>
+ *
+ * \ingroup Resamplers
+ */
+
+template< class TElastix >
+class ScanlineResampler :
+  public itk::ScanlineResampleImageFilter<
+  typename ResamplerBase< TElastix >::InputImageType,
+  typename ResamplerBase< TElastix >::OutputImageType,
+  typename ResamplerBase< TElastix >::CoordRepType >,
+  public ResamplerBase< TElastix >
+{
+public:
+
+  /** Standard ITK-stuff. */
+  typedef ScanlineResampler Self;
+
+  typedef itk::ScanlineResampleImageFilter<
+    typename ResamplerBase< TElastix >::InputImageType,
+    typename ResamplerBase< TElastix >::OutputImageType,
+    typename ResamplerBase< TElastix >::CoordRepType > Superclass1;
+  typedef ResamplerBase< TElastix >       Superclass2;
+  typedef itk::SmartPointer< Self >       Pointer;
+  typedef itk::SmartPointer< const Self > ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( ScanlineResampler, ScanlineResampleImageFilter );
+
+  /** Name of this class.
+   * Use this name in the parameter file to select this specific resampler. \n
+   * example: <tt>(Resampler "ScanlineResampler")</tt>\n
+   */
+  elxClassNameMacro( "ScanlineResampler" );
+
+  /** Typedef's inherited from the superclass. */
+  typedef typename Superclass1::InputImageType        InputImageType;
+  typedef typename Superclass1::OutputImageType       OutputImageType;
+  typedef typename Superclass1::TransformType         TransformType;
+  typedef typename Superclass1::InterpolatorType      InterpolatorType;
+  typedef typename Superclass1::IndexType             IndexType;
+  typedef typename Superclass1::PointType             PointType;
+  typedef typename Superclass1::PixelType             PixelType;
+  typedef typename Superclass1::OutputImageRegionType OutputImageRegionType;
+
+  /** Typedef's from the ResamplerBase. */
+  typedef typename Superclass2::ElastixType          ElastixType;
+  typedef typename Superclass2::ElastixPointer       ElastixPointer;
+  typedef typename Superclass2::ConfigurationType    ConfigurationType;
+  typedef typename Superclass2::ConfigurationPointer ConfigurationPointer;
+  typedef typename Superclass2::RegistrationType     RegistrationType;
+  typedef typename Superclass2::RegistrationPointer  RegistrationPointer;
+  typedef typename Superclass2::ITKBaseType          ITKBaseType;
+
+protected:
+
+  /** The constructor. */
+  ScanlineResampler() {}
+  /** The destructor. */
+  ~ScanlineResampler() override {}
+
+  /** Resample, and report the resampling method to the log. */
+  void GenerateData( void ) override;
+
+private:
+
+  /** The private constructor. */
+  ScanlineResampler( const Self & );    // purposely not implemented
+  /** The private copy constructor. */
+  void operator=( const Self & );       // purposely not implemented
+
+};
+
+} // end namespace elastix
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "elxScanlineResampler.hxx"
+#endif
+
+#endif // end #ifndef __elxScanlineResampler_h
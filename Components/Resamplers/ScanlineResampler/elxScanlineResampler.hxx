@@ -0,0 +1,56 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __elxScanlineResampler_hxx
+#define __elxScanlineResampler_hxx
+
+#include "elxScanlineResampler.h"
+
+namespace elastix
+{
+
+/**
+ * ******************* GenerateData ***********************
+ */
+
+template< class TElastix >
+void
+ScanlineResampler< TElastix >
+::GenerateData( void )
+{
+  Superclass1::GenerateData();
+
+  if( this->GetResamplingMethod() == Superclass1::LinearResampling )
+  {
+    elxout << "  Applying final transform was performed along scanlines, for a linear transform." << std::endl;
+  }
+  else if( this->GetResamplingMethod() == Superclass1::BSplineResampling )
+  {
+    elxout << "  Applying final transform was performed along scanlines, for a B-spline transform." << std::endl;
+  }
+  else
+  {
+    elxout << "  Applying final transform was performed per voxel, as by the DefaultResampler." << std::endl;
+  }
+
+} // end GenerateData()
+
+
+} // end namespace elastix
+
+#endif // end #ifndef __elxScanlineResampler_hxx
@@ -70,6 +70,13 @@ namespace elastix
  * Default: 0.3. You cannot specify this parameter for each resolution differently.\n
  * Valid values are withing -1.0 and 0.5. 0.5 means incompressible.
  * Negative values are a bit odd, but possible. See Wikipedia on PoissonRatio.
+ * \parameter SplineFarFieldTolerance: evaluate the ThinPlateSpline with a
+ * tree code, which approximates the contribution of far away clusters of
+ * landmarks. The value is the guaranteed maximum error of each component of
+ * the deformation, in physical units. This speeds up resampling with large
+ * sets of landmarks. For other SplineKernelTypes this parameter is ignored.\n
+ *   example: <tt>(SplineFarFieldTolerance 0.01 )</tt>\n
+ * Default: 0.0, which means exact evaluation.
  *
  * \commandlinearg -fp: a file specifying a set of points that will serve
  * as fixed image landmarks.\n
@@ -104,6 +111,10 @@ namespace elastix
  *   example: <tt>(SplinePoissonRatio 0.3 )</tt>\n
  * Valid values are withing -1.0 and 0.5. 0.5 means incompressible.
  * Negative values are a bit odd, but possible. See Wikipedia on PoissonRatio.
+ * \transformparameter SplineFarFieldTolerance: the guaranteed maximum error
+ * of each component of the deformation, in physical units, when the
+ * ThinPlateSpline is evaluated with a tree code. 0.0 means exact evaluation.\n
+ *   example: <tt>(SplineFarFieldTolerance 0.01 )</tt>\n
  * \transformparameter FixedImageLandmarks: The landmark positions in the
  * fixed image, in world coordinates. Positions written as x1 y1 [z1] x2 y2 [z2] etc.\n
  *   example: <tt>(FixedImageLandmarks 10.0 11.0 12.0 4.0 4.0 4.0 6.0 6.0 6.0 )</tt>
@@ -195,6 +195,12 @@ SplineKernelTransform< TElastix >
     this->m_KernelTransform->SetPoissonRatio( poissonRatio );
   }
 
+  /** Set the far-field tolerance; default = 0 = exact. */
+  double farFieldTolerance = 0.0;
+  this->GetConfiguration()->ReadParameter(
+    farFieldTolerance, "SplineFarFieldTolerance", this->GetComponentLabel(), 0, -1 );
+  this->m_KernelTransform->SetFarFieldTolerance( farFieldTolerance );
+
   /** Set the matrix inversion method (one of {SVD, QR}). */
   std::string matrixInversionMethod = "SVD";
   this->GetConfiguration()->ReadParameter(
@@ -432,6 +438,12 @@ SplineKernelTransform< TElastix >
     poissonRatio, "SplinePoissonRatio", this->GetComponentLabel(), 0, -1 );
   this->m_KernelTransform->SetPoissonRatio( poissonRatio );
 
+  /** Set the far-field tolerance; default = 0 = exact. */
+  double farFieldTolerance = 0.0;
+  this->GetConfiguration()->ReadParameter(
+    farFieldTolerance, "SplineFarFieldTolerance", this->GetComponentLabel(), 0, -1 );
+  this->m_KernelTransform->SetFarFieldTolerance( farFieldTolerance );
+
   /** Read number of parameters. */
   unsigned int numberOfParameters = 0;
   this->GetConfiguration()->ReadParameter(
@@ -492,6 +504,8 @@ SplineKernelTransform< TElastix >
                          << this->m_KernelTransform->GetPoissonRatio() << ")" << std::endl;
   xl::xout[ "transpar" ] << "(SplineRelaxationFactor "
                          << this->m_KernelTransform->GetStiffness() << ")" << std::endl;
+  xl::xout[ "transpar" ] << "(SplineFarFieldTolerance "
+                         << this->m_KernelTransform->GetFarFieldTolerance() << ")" << std::endl;
 
   /** Write the fixed image landmarks. */
   const ParametersType & fixedParams = this->m_KernelTransform->GetFixedParameters();
@@ -40,6 +40,7 @@ PURPOSE.  See the above copyright notices for more information.
 #include "itkMatrix.h"
 #include "itkPointSet.h"
 #include <deque>
+#include <vector>
 #include <math.h>
 #include "vnl/vnl_matrix_fixed.h"
 #include "vnl/vnl_matrix.h"
@@ -279,6 +280,15 @@ public:
   virtual void SetAlpha( TScalarType itkNotUsed( Alpha ) ) {}
   virtual TScalarType GetAlpha( void ) const { return -1.0; }
 
+  /** Maximum absolute error of the approximate (far-field) evaluation of
+   * the deformation, in physical units. Zero means exact evaluation.
+   * This method makes only sense for the ThinPlateSpline. Declare here,
+   * so that you can always call it if you don't know the type of kernel
+   * beforehand. It will be overridden in the ThinPlateSplineKernelTransform.
+   */
+  virtual void SetFarFieldTolerance( double itkNotUsed( tolerance ) ) {}
+  virtual double GetFarFieldTolerance( void ) const { return 0.0; }
+
   /** This method makes only sense for the ElasticBody splines.
    * Declare here, so that you can always call it if you don't know
    * the type of kernel beforehand. It will be overridden in the
@@ -420,10 +430,22 @@ protected:
     const InputPointType & inputPoint,
     OutputPointType & result ) const;
 
+  /** Prepare the data used by ComputeDeformationContribution(), after
+   * the W matrix has been computed. The default implementation copies the
+   * source landmarks to m_SourceLandmarkCoordinates.
+   */
+  virtual void PrecomputeDeformationContribution( void );
+
   /** Compute K matrix. */
   void ComputeK( void );
 
-  /** Compute L matrix. */
+  /** Compute L matrix.
+   * If m_FastComputationPossible, then G = g * I and L equals, up to a
+   * permutation of rows and columns, the Kronecker product of a reduced
+   * (n + d + 1) x (n + d + 1) matrix with I_d. In that case only the reduced
+   * matrix is stored in m_LMatrix, and m_LMatrixInverse, m_YMatrix and
+   * m_WMatrix refer to the reduced system, which has d columns.
+   */
   void ComputeL( void );
 
   /** Compute P matrix. */
@@ -474,6 +496,12 @@ protected:
    */
   DMatrixType m_DMatrix;
 
+  /** The source landmarks stored per dimension, i.e. coordinate d of
+   * landmark i is at d * n + i. Together with the rows of m_DMatrix this
+   * gives contiguous data for the evaluation of the kernel sums.
+   */
+  std::vector< TScalarType > m_SourceLandmarkCoordinates;
+
   /** Rotational/Shearing part of the Affine component of the Transformation. */
   AMatrixType m_AMatrix;
 
@@ -35,6 +35,7 @@ PURPOSE.  See the above copyright notices for more information.
 #define _itkKernelTransform2_hxx
 
 #include "itkKernelTransform2.h"
+#include "itkMultiThreaderBase.h"
 
 namespace itk
 {
@@ -214,6 +215,31 @@ KernelTransform2< TScalarType, NDimensions >
 } // end ComputeDeformationContribution()
 
 
+/**
+ * ******************* PrecomputeDeformationContribution *******************
+ */
+
+template< class TScalarType, unsigned int NDimensions >
+void
+KernelTransform2< TScalarType, NDimensions >
+::PrecomputeDeformationContribution( void )
+{
+  const unsigned long numberOfLandmarks = this->m_SourceLandmarks->GetNumberOfPoints();
+  this->m_SourceLandmarkCoordinates.resize( NDimensions * numberOfLandmarks );
+
+  PointsIterator sp = this->m_SourceLandmarks->GetPoints()->Begin();
+  for( unsigned long lnd = 0; lnd < numberOfLandmarks; lnd++ )
+  {
+    for( unsigned int dim = 0; dim < NDimensions; dim++ )
+    {
+      this->m_SourceLandmarkCoordinates[ dim * numberOfLandmarks + lnd ] = sp->Value()[ dim ];
+    }
+    ++sp;
+  }
+
+} // end PrecomputeDeformationContribution()
+
+
 /**
  * ******************* ComputeD *******************
  */
@@ -299,6 +325,8 @@ KernelTransform2< TScalarType, NDimensions >
   this->ReorganizeW();
   this->m_WMatrixComputed = true;
 
+  this->PrecomputeDeformationContribution();
+
 } // end ComputeWMatrix()
 
 
@@ -346,7 +374,66 @@ void
 KernelTransform2< TScalarType, NDimensions >
 ::ComputeL( void )
 {
-  const unsigned long       numberOfLandmarks = this->m_SourceLandmarks->GetNumberOfPoints();
+  const unsigned long numberOfLandmarks = this->m_SourceLandmarks->GetNumberOfPoints();
+
+  /** For kernels with G = g * I only the reduced system is built, see the
+   * documentation in the header. Its size is d^2 times smaller, and the
+   * decomposition d^3 times cheaper, than that of the full system.
+   */
+  if( this->m_FastComputationPossible )
+  {
+    const unsigned long n = numberOfLandmarks;
+    this->m_LMatrix.set_size( n + NDimensions + 1, n + NDimensions + 1 );
+    this->m_LMatrix.fill( 0.0 );
+
+    /** The diagonal of K, and P. */
+    GMatrixType    G;
+    PointsIterator sp = this->m_SourceLandmarks->GetPoints()->Begin();
+    for( unsigned long i = 0; i < n; i++ )
+    {
+      this->ComputeReflexiveG( sp, G );
+      this->m_LMatrix( i, i ) = G( 0, 0 );
+      for( unsigned int j = 0; j < NDimensions; j++ )
+      {
+        this->m_LMatrix( i, n + j ) = this->m_LMatrix( n + j, i ) = sp->Value()[ j ];
+      }
+      this->m_LMatrix( i, n + NDimensions ) = this->m_LMatrix( n + NDimensions, i ) = 1.0;
+      ++sp;
+    }
+
+    /** The off-diagonal part of K, which is O(n^2), is computed in parallel.
+     * Each work item fills the upper triangular part of rows i and n - 1 - i
+     * (and the mirrored columns), so that all items have equal cost.
+     */
+    if( n > 1 )
+    {
+      const PointsContainer *    points   = this->m_SourceLandmarks->GetPoints();
+      LMatrixType &              lMatrix  = this->m_LMatrix;
+      MultiThreaderBase::Pointer threader = MultiThreaderBase::New();
+      threader->ParallelizeArray( 0, ( n + 1 ) / 2,
+        [ this, points, n, &lMatrix ]( SizeValueType k )
+        {
+          GMatrixType         G;
+          const unsigned long rows[ 2 ]    = { k, n - 1 - k };
+          const unsigned int  numberOfRows = ( rows[ 0 ] == rows[ 1 ] ) ? 1 : 2;
+          for( unsigned int r = 0; r < numberOfRows; r++ )
+          {
+            const unsigned long    i  = rows[ r ];
+            const InputPointType & pi = points->ElementAt( i );
+            for( unsigned long j = i + 1; j < n; j++ )
+            {
+              this->ComputeG( pi - points->ElementAt( j ), G );
+              lMatrix( i, j ) = lMatrix( j, i ) = G( 0, 0 );
+            }
+          }
+        }, nullptr );
+    }
+
+    this->m_LMatrixComputed              = true;
+    this->m_LMatrixDecompositionComputed = false;
+    return;
+  }
+
   vnl_matrix< TScalarType > O2( NDimensions * ( NDimensions + 1 ),
   NDimensions * ( NDimensions + 1 ), 0 );
 
@@ -462,6 +549,22 @@ KernelTransform2< TScalarType, NDimensions >
   typename VectorSetType::ConstIterator displacement = this->m_Displacements->Begin();
   const unsigned long numberOfLandmarks = this->m_SourceLandmarks->GetNumberOfPoints();
 
+  /** The reduced system has one right-hand side per dimension. */
+  if( this->m_FastComputationPossible )
+  {
+    this->m_YMatrix.set_size( numberOfLandmarks + NDimensions + 1, NDimensions );
+    this->m_YMatrix.fill( 0.0 );
+    for( unsigned long i = 0; i < numberOfLandmarks; i++ )
+    {
+      for( unsigned int j = 0; j < NDimensions; j++ )
+      {
+        this->m_YMatrix( i, j ) = displacement.Value()[ j ];
+      }
+      displacement++;
+    }
+    return;
+  }
+
   this->m_YMatrix.set_size( NDimensions * ( numberOfLandmarks + NDimensions + 1 ), 1 );
   this->m_YMatrix.fill( 0.0 );
 
@@ -495,6 +598,29 @@ KernelTransform2< TScalarType, NDimensions >
 
   // The deformable (non-affine) part of the registration goes here
   this->m_DMatrix.set_size( NDimensions, numberOfLandmarks );
+
+  // The reduced system: row i of W holds the coefficients of unknown i
+  // for all dimensions.
+  if( this->m_FastComputationPossible )
+  {
+    for( unsigned int dim = 0; dim < NDimensions; dim++ )
+    {
+      for( unsigned long lnd = 0; lnd < numberOfLandmarks; lnd++ )
+      {
+        this->m_DMatrix( dim, lnd ) = this->m_WMatrix( lnd, dim );
+      }
+      for( unsigned int j = 0; j < NDimensions; j++ )
+      {
+        this->m_AMatrix( dim, j ) = this->m_WMatrix( numberOfLandmarks + j, dim );
+      }
+      this->m_BVector( dim ) = this->m_WMatrix( numberOfLandmarks + NDimensions, dim );
+    }
+
+    this->m_WMatrix         = WMatrixType( 1, 1 );
+    this->m_WMatrixComputed = true;
+    return;
+  }
+
   unsigned int ci = 0;
 
   for( unsigned long lnd = 0; lnd < numberOfLandmarks; lnd++ )
@@ -806,79 +932,45 @@ KernelTransform2< TScalarType, NDimensions >
     //     i.e. G = G(0,0) * I_d, so it is fully defined by just 1 value G(0,0).
     // A1 and A2 together reduce the memory access to G from d x d to 1.
     //
-    // B1) Linv is an ( n x d + y )^2 block diagonal matrix:
-    //     it is very sparse, with 2/4 = 50%, resp. 3/9 = 33% non-zero values.
-    // B2) Linv is block diagonal, with identical values on the main diagonal
-    //     of each block, i.e. each block is fully defined by just 1 value.
-    // B1 and B2 together reduce the memory access to Linv also with a factor d x d.
+    // B) L is the Kronecker product of a reduced (n + d + 1)^2 matrix with I_d,
+    //    see ComputeL(), and so is Linv. Only the reduced inverse is stored,
+    //    which reduces the memory access to Linv by a factor d x d.
     //
-    // C) For all kernels, both Linv and G are symmetric.
-    //    Reduces memory access to Linv by a factor 2.
+    // Together, for every output dimension the non-zero Jacobian entries equal
+    // the landmark part of the vector s = c^T Linv, with c = [ g, p, 1 ].
+    // This is computed by accumulating whole rows of Linv, which are
+    // contiguous in memory.
   else
   {
-    // Precompute G's.
-    std::vector< ScalarType > gVector( numberOfLandmarks );
-    for( unsigned int lnd = 0; lnd < numberOfLandmarks; lnd++ )
-    {
-      // Property A: G = G(0,0) * I_d.
-      this->ComputeG( p - sp->Value(), Gmatrix );
-      gVector[ lnd ] = Gmatrix( 0, 0 );
-      ++sp;
-    }
-
-    // Deformation part of the transform:
-    sp = this->m_SourceLandmarks->GetPoints()->Begin();
-    for( unsigned int lnd = 0; lnd < numberOfLandmarks; lnd++ )
+    std::vector< ScalarType > sVector( numberOfLandmarks, 0.0 );
+    for( unsigned long lnd = 0; lnd < numberOfLandmarks + NDimensions + 1; lnd++ )
     {
-      // Property A: G = G(0,0) * I_d.
-      ScalarType g = gVector[ lnd ];
-
-      // Property C: First process the diagonal only
-      unsigned int lIdx = lnd * NDimensions;
-      ScalarType   linv = this->m_LMatrixInverse[ lIdx ][ lIdx ];
-      // Property B: only access non-zero values
-      for( unsigned int dim = 0; dim < NDimensions; dim++ )
+      ScalarType c = 1.0;
+      if( lnd < numberOfLandmarks )
       {
-        jac[ dim ][ lIdx + dim ] += g * linv;
+        // Property A: G = G(0,0) * I_d.
+        this->ComputeG( p - sp->Value(), Gmatrix );
+        c = Gmatrix( 0, 0 );
+        ++sp;
       }
-
-      // Property C: Then process right of diagonal
-      for( unsigned int lidx = lnd + 1; lidx < numberOfLandmarks; lidx++ )
+      else if( lnd < numberOfLandmarks + NDimensions )
       {
-        // Property C: Get G value at mirrored position
-        ScalarType gSym = gVector[ lidx ];
-
-        // Property B: only access non-zero values
-        unsigned int lIdx = lidx * NDimensions;
-        ScalarType   linv = this->m_LMatrixInverse[ lnd * NDimensions ][ lIdx ];
-
-        // Property B: only access non-zero values
-        for( unsigned int dim = 0; dim < NDimensions; dim++ )
-        {
-          jac[ dim ][ lIdx + dim ] += g * linv;
-          // Property C: mirroring
-          jac[ dim ][ lnd * NDimensions + dim ] += gSym * linv;
-        }
-      } // end for lidx
+        c = p[ lnd - numberOfLandmarks ];
+      }
 
-      // Next source landmark
-      ++sp;
+      const ScalarType * linv = this->m_LMatrixInverse[ lnd ];
+      for( unsigned long lidx = 0; lidx < numberOfLandmarks; lidx++ )
+      {
+        sVector[ lidx ] += c * linv[ lidx ];
+      }
     }
 
-    // Affine part of the transform:
-    for( unsigned int odim = 0; odim < NDimensions; odim++ )
+    // Property B: only the diagonal of each d x d block is non-zero.
+    for( unsigned long lidx = 0; lidx < numberOfLandmarks; lidx++ )
     {
-      const unsigned long index = ( numberOfLandmarks + NDimensions ) * NDimensions + odim;
-
-      for( unsigned long lidx = 0; lidx < numberOfLandmarks * NDimensions; lidx++ )
+      for( unsigned int dim = 0; dim < NDimensions; dim++ )
       {
-        ScalarType tmp = 0.0;
-        for( unsigned int dim = 0; dim < NDimensions; dim++ )
-        {
-          unsigned int indtmp = ( numberOfLandmarks + dim ) * NDimensions + odim;
-          tmp += p[ dim ] * this->m_LMatrixInverse[ indtmp ][ lidx ];
-        }
-        jac[ odim ][ lidx ] += tmp + this->m_LMatrixInverse[ index ][ lidx ];
+        jac[ dim ][ lidx * NDimensions + dim ] = sVector[ lidx ];
       }
     }
   } // end if this->m_FastComputationPossible
@@ -35,6 +35,8 @@
 #define _itkThinPlateR2LogRSplineKernelTransform2_hxx
 
 #include "itkThinPlateR2LogRSplineKernelTransform2.h"
+#include <algorithm>
+#include <cmath>
 
 namespace itk
 {
@@ -59,19 +61,32 @@ ThinPlateR2LogRSplineKernelTransform2< TScalarType, NDimensions >::ComputeDeform
 {
   const unsigned long numberOfLandmarks = this->m_SourceLandmarks->GetNumberOfPoints();
 
-  PointsIterator sp = this->m_SourceLandmarks->GetPoints()->Begin();
+  /** Use the contiguous landmark coordinates and the rows of D. */
+  const TScalarType * coordinates = this->m_SourceLandmarkCoordinates.data();
+  const TScalarType * weights     = this->m_DMatrix.data_block();
 
-  for( unsigned int lnd = 0; lnd < numberOfLandmarks; lnd++ )
+  TScalarType sum[ NDimensions ];
+  std::fill( sum, sum + NDimensions, NumericTraits< TScalarType >::ZeroValue() );
+  for( unsigned long lnd = 0; lnd < numberOfLandmarks; lnd++ )
   {
-    InputVectorType            position = thisPoint - sp->Value();
-    const TScalarType          r        = position.GetNorm();
-    const TScalarType          R2logR
-      = ( r > 1e-8 ) ? r * r * std::log( r ) : NumericTraits< TScalarType >::Zero;
+    TScalarType r2 = 0.0;
+    for( unsigned int dim = 0; dim < NDimensions; dim++ )
+    {
+      const TScalarType diff = thisPoint[ dim ] - coordinates[ dim * numberOfLandmarks + lnd ];
+      r2 += diff * diff;
+    }
+    // r^2 log(r) = 0.5 r^2 log(r^2), zero for r <= 1e-8
+    const TScalarType R2logR
+      = ( r2 > 1e-16 ) ? 0.5 * r2 * std::log( r2 ) : NumericTraits< TScalarType >::Zero;
     for( unsigned int odim = 0; odim < NDimensions; odim++ )
     {
-      result[ odim ] += R2logR * this->m_DMatrix( odim, lnd );
+      sum[ odim ] += R2logR * weights[ odim * numberOfLandmarks + lnd ];
     }
-    ++sp;
+  }
+
+  for( unsigned int odim = 0; odim < NDimensions; odim++ )
+  {
+    result[ odim ] += sum[ odim ];
   }
 
 }
@@ -38,6 +38,18 @@
 
 namespace itk
 {
+
+/** The number of monomials of at most the given degree in the given number
+ * of variables, i.e. the binomial coefficient ( degree + dimension ) over dimension.
+ */
+constexpr unsigned int
+ThinPlateSplineNumberOfExpansionTerms( unsigned int degree, unsigned int dimension )
+{
+  return dimension == 0 ? 1
+         : ThinPlateSplineNumberOfExpansionTerms( degree, dimension - 1 ) * ( degree + dimension ) / dimension;
+}
+
+
 /** \class ThinPlateSplineKernelTransform2
  * This class defines the thin plate spline (TPS) transformation.
  * It is implemented in as straightforward a manner as possible from
@@ -78,6 +90,13 @@ public:
   /** Dimension of the domain space. */
   itkStaticConstMacro( SpaceDimension, unsigned int, Superclass::SpaceDimension );
 
+  /** The order of the expansion used by the far-field approximation, and
+   * its number of terms.
+   */
+  itkStaticConstMacro( FarFieldExpansionOrder, unsigned int, 6 );
+  itkStaticConstMacro( NumberOfExpansionTerms, unsigned int,
+    ThinPlateSplineNumberOfExpansionTerms( FarFieldExpansionOrder, NDimensions ) );
+
   /** These (rather redundant) typedefs are needed because on SGI, typedefs
    * are not inherited.
    */
@@ -89,11 +108,31 @@ public:
   typedef typename Superclass::OutputCovariantVectorType OutputCovariantVectorType;
   typedef typename Superclass::PointsIterator            PointsIterator;
 
+  /** Set the maximum absolute error, in physical units, of each component
+   * of the deformation when it is evaluated with the far-field approximation.
+   * The landmarks are then organized in a tree of clusters (a kd-tree). The
+   * contribution of a cluster that is far enough from the evaluated point is
+   * computed from a Taylor expansion of the kernel around the cluster
+   * center, and the distance at which a cluster is far enough is chosen such
+   * that the total error is guaranteed to stay below the tolerance. Since
+   * this is a worst case bound, the actual error is usually much smaller.
+   * The default, 0, means exact evaluation.
+   */
+  void SetFarFieldTolerance( double tolerance ) override;
+
+  double GetFarFieldTolerance( void ) const override
+  {
+    return this->m_FarFieldTolerance;
+  }
+
+
 protected:
 
   ThinPlateSplineKernelTransform2()
   {
     this->m_FastComputationPossible = true;
+    this->m_FarFieldTolerance       = 0.0;
+    this->InitializeExpansionTerms();
   }
 
 
@@ -121,11 +160,67 @@ protected:
   void ComputeDeformationContribution(
     const InputPointType & inputPoint, OutputPointType & result ) const override;
 
+  /** Build the clusters needed for the far-field approximation. */
+  void PrecomputeDeformationContribution( void ) override;
+
+  /** Add the exact kernel sum of the landmarks in [begin, end) to result.
+   * Coordinate d of landmark i is at coordinates[ d * stride + i ], and its
+   * weight for output dimension k at weights[ k * stride + i ].
+   */
+  void EvaluateKernelSum( const TScalarType * point,
+    const TScalarType * coordinates, const TScalarType * weights,
+    const unsigned long stride, const unsigned long begin, const unsigned long end,
+    TScalarType * result ) const;
+
+  void PrintSelf( std::ostream & os, Indent indent ) const override;
+
 private:
 
   ThinPlateSplineKernelTransform2( const Self & ); // purposely not implemented
   void operator=( const Self & );                  // purposely not implemented
 
+  /** Fill the tables that describe the terms of the expansion. */
+  void InitializeExpansionTerms( void );
+
+  /** A node of the cluster tree: a range of landmarks, with the moments of
+   * their weights, M_ak = sum_i w_ik ( -x_i )^a for every multi-index a, with
+   * x_i the position of landmark i relative to the cluster center.
+   * The children of a node are stored at m_FirstChild and m_FirstChild + 1;
+   * m_FirstChild is zero for leaves.
+   */
+  struct ClusterType
+  {
+    TScalarType   m_Center[ NDimensions ];
+    TScalarType   m_FarFieldDistanceSquared;
+    unsigned long m_Begin;
+    unsigned long m_End;
+    unsigned long m_FirstChild;
+    TScalarType   m_Moments[ NumberOfExpansionTerms ][ NDimensions ];
+  };
+
+  /** The terms of the expansion are ordered by degree. For each term, store
+   * its degree and the index of the term with exponent a - e_d and a - 2 e_d
+   * for every dimension d, or NumberOfExpansionTerms (an extra coefficient that
+   * is zero) if that exponent is negative. The parent of a term is a - e_d
+   * for the first d with a_d > 0.
+   */
+  unsigned int m_ExpansionTermDegree[ NumberOfExpansionTerms ];
+  TScalarType  m_ExpansionTermInverseDegree[ NumberOfExpansionTerms ];
+  unsigned int m_ExpansionTermPrevious[ NumberOfExpansionTerms ][ NDimensions ];
+  unsigned int m_ExpansionTermSecondPrevious[ NumberOfExpansionTerms ][ NDimensions ];
+  unsigned int m_ExpansionTermParent[ NumberOfExpansionTerms ];
+  unsigned int m_ExpansionTermParentDimension[ NumberOfExpansionTerms ];
+
+  double m_FarFieldTolerance;
+
+  /** The landmark coordinates and weights ordered by cluster, with the
+   * same layout as m_SourceLandmarkCoordinates and m_DMatrix.
+   */
+  std::vector< TScalarType > m_ClusterCoordinates;
+  std::vector< TScalarType > m_ClusterWeights;
+  /** The cluster tree, with the root at index 0. */
+  std::vector< ClusterType > m_Clusters;
+
 };
 
 } // namespace itk
@@ -35,6 +35,8 @@
 #define _itkThinPlateSplineKernelTransform2_hxx
 
 #include "itkThinPlateSplineKernelTransform2.h"
+#include <algorithm>
+#include <cmath>
 
 namespace itk
 {
@@ -55,6 +57,171 @@ ThinPlateSplineKernelTransform2< TScalarType, NDimensions >
 } // end ComputeG()
 
 
+/**
+ * ******************* InitializeExpansionTerms *******************
+ */
+
+template< class TScalarType, unsigned int NDimensions >
+void
+ThinPlateSplineKernelTransform2< TScalarType, NDimensions >
+::InitializeExpansionTerms( void )
+{
+  /** Enumerate all exponents in [0, p]^d, ordered by degree. */
+  const unsigned int p    = FarFieldExpansionOrder;
+  const unsigned int none = NumberOfExpansionTerms;
+  unsigned int       numberOfCodes = 1;
+  for( unsigned int dim = 0; dim < NDimensions; dim++ )
+  {
+    numberOfCodes *= p + 1;
+  }
+
+  std::vector< int >          termOfCode( numberOfCodes, -1 );
+  std::vector< unsigned int > codeOfTerm;
+  for( unsigned int degree = 0; degree <= p; degree++ )
+  {
+    for( unsigned int code = 0; code < numberOfCodes; code++ )
+    {
+      unsigned int sum = 0;
+      for( unsigned int c = code; c > 0; c /= p + 1 )
+      {
+        sum += c % ( p + 1 );
+      }
+      if( sum == degree )
+      {
+        termOfCode[ code ] = codeOfTerm.size();
+        this->m_ExpansionTermDegree[ codeOfTerm.size() ]        = degree;
+        this->m_ExpansionTermInverseDegree[ codeOfTerm.size() ] = degree > 0 ? 1.0 / degree : 0.0;
+        codeOfTerm.push_back( code );
+      }
+    }
+  }
+
+  for( unsigned int term = 0; term < NumberOfExpansionTerms; term++ )
+  {
+    const unsigned int code = codeOfTerm[ term ];
+    this->m_ExpansionTermParent[ term ]          = 0;
+    this->m_ExpansionTermParentDimension[ term ] = 0;
+
+    unsigned int stride   = 1;
+    bool         isParent = true;
+    for( unsigned int dim = 0; dim < NDimensions; dim++ )
+    {
+      const unsigned int exponent = ( code / stride ) % ( p + 1 );
+      this->m_ExpansionTermPrevious[ term ][ dim ]
+        = exponent >= 1 ? termOfCode[ code - stride ] : none;
+      this->m_ExpansionTermSecondPrevious[ term ][ dim ]
+        = exponent >= 2 ? termOfCode[ code - 2 * stride ] : none;
+      if( exponent >= 1 && isParent )
+      {
+        this->m_ExpansionTermParent[ term ]          = termOfCode[ code - stride ];
+        this->m_ExpansionTermParentDimension[ term ] = dim;
+        isParent                                     = false;
+      }
+      stride *= p + 1;
+    }
+  }
+
+} // end InitializeExpansionTerms()
+
+
+/**
+ * ******************* SetFarFieldTolerance *******************
+ */
+
+template< class TScalarType, unsigned int NDimensions >
+void
+ThinPlateSplineKernelTransform2< TScalarType, NDimensions >
+::SetFarFieldTolerance( double tolerance )
+{
+  const double newTolerance = tolerance > 0.0 ? tolerance : 0.0;
+  if( this->m_FarFieldTolerance != newTolerance )
+  {
+    this->m_FarFieldTolerance = newTolerance;
+
+    /** The clusters depend on the weights, so only build them if W is known. */
+    if( this->m_WMatrixComputed )
+    {
+      this->PrecomputeDeformationContribution();
+    }
+    this->Modified();
+  }
+
+} // end SetFarFieldTolerance()
+
+
+/**
+ * ******************* EvaluateKernelSum *******************
+ */
+
+template< class TScalarType, unsigned int NDimensions >
+void
+ThinPlateSplineKernelTransform2< TScalarType, NDimensions >
+::EvaluateKernelSum( const TScalarType * point,
+  const TScalarType * coordinates, const TScalarType * weights,
+  const unsigned long stride, const unsigned long begin, const unsigned long end,
+  TScalarType * result ) const
+{
+  /** Landmarks are processed in blocks with independent accumulators,
+   * so that the compiler can evaluate a block with vector instructions.
+   */
+  const unsigned int BlockSize = 4;
+  TScalarType        sum[ NDimensions ][ BlockSize ];
+  for( unsigned int odim = 0; odim < NDimensions; odim++ )
+  {
+    std::fill( sum[ odim ], sum[ odim ] + BlockSize, NumericTraits< TScalarType >::ZeroValue() );
+  }
+
+  unsigned long lnd = begin;
+  for( ; lnd + BlockSize <= end; lnd += BlockSize )
+  {
+    TScalarType r[ BlockSize ];
+    for( unsigned int j = 0; j < BlockSize; j++ )
+    {
+      TScalarType r2 = 0.0;
+      for( unsigned int dim = 0; dim < NDimensions; dim++ )
+      {
+        const TScalarType diff = point[ dim ] - coordinates[ dim * stride + lnd + j ];
+        r2 += diff * diff;
+      }
+      r[ j ] = std::sqrt( r2 );
+    }
+    for( unsigned int odim = 0; odim < NDimensions; odim++ )
+    {
+      const TScalarType * w = weights + odim * stride + lnd;
+      for( unsigned int j = 0; j < BlockSize; j++ )
+      {
+        sum[ odim ][ j ] += r[ j ] * w[ j ];
+      }
+    }
+  }
+
+  /** The remaining landmarks. */
+  for( ; lnd < end; lnd++ )
+  {
+    TScalarType r2 = 0.0;
+    for( unsigned int dim = 0; dim < NDimensions; dim++ )
+    {
+      const TScalarType diff = point[ dim ] - coordinates[ dim * stride + lnd ];
+      r2 += diff * diff;
+    }
+    const TScalarType r = std::sqrt( r2 );
+    for( unsigned int odim = 0; odim < NDimensions; odim++ )
+    {
+      sum[ odim ][ 0 ] += r * weights[ odim * stride + lnd ];
+    }
+  }
+
+  for( unsigned int odim = 0; odim < NDimensions; odim++ )
+  {
+    for( unsigned int j = 0; j < BlockSize; j++ )
+    {
+      result[ odim ] += sum[ odim ][ j ];
+    }
+  }
+
+} // end EvaluateKernelSum()
+
+
 /**
  * ******************* ComputeDeformationContribution *******************
  */
@@ -66,23 +233,327 @@ ThinPlateSplineKernelTransform2< TScalarType, NDimensions >
   const InputPointType & thisPoint, OutputPointType & opp ) const
 {
   const unsigned long numberOfLandmarks = this->m_SourceLandmarks->GetNumberOfPoints();
-  PointsIterator      sp                = this->m_SourceLandmarks->GetPoints()->Begin();
+  if( numberOfLandmarks == 0 )
+  {
+    return;
+  }
 
-  for( unsigned long lnd = 0; lnd < numberOfLandmarks; lnd++ )
+  TScalarType point[ NDimensions ];
+  TScalarType result[ NDimensions ];
+  for( unsigned int dim = 0; dim < NDimensions; dim++ )
   {
-    InputVectorType   position = thisPoint - sp->Value();
-    const TScalarType r        = position.GetNorm();
+    point[ dim ]  = thisPoint[ dim ];
+    result[ dim ] = NumericTraits< TScalarType >::ZeroValue();
+  }
 
+  /** Exact evaluation. */
+  if( this->m_Clusters.empty() )
+  {
+    this->EvaluateKernelSum( point, this->m_SourceLandmarkCoordinates.data(),
+      this->m_DMatrix.data_block(), numberOfLandmarks, 0, numberOfLandmarks, result );
     for( unsigned int odim = 0; odim < NDimensions; odim++ )
     {
-      opp[ odim ] += r * this->m_DMatrix( odim, lnd );
+      opp[ odim ] += result[ odim ];
+    }
+    return;
+  }
+
+  /** Far-field evaluation, by traversing the cluster tree. With y the
+   * vector from the cluster center to the point, the contribution of a
+   * cluster that is far enough is sum_a c_a( y ) M_a, with c_a( y ) the Taylor
+   * coefficients of |y|. These follow from the recurrence
+   *   |a| |y|^2 c_a = sum_d ( 3 - 2|a| ) y_d c_{a - e_d} + ( 3 - |a| ) c_{a - 2 e_d},
+   * with c_0 = |y|. Other clusters are refined, or evaluated exactly if they
+   * are leaves, which are never expanded.
+   */
+  const TScalarType * coordinates = this->m_ClusterCoordinates.data();
+  const TScalarType * weights     = this->m_ClusterWeights.data();
+  TScalarType         coefficients[ NumberOfExpansionTerms + 1 ];
+  coefficients[ NumberOfExpansionTerms ] = 0.0;
+
+  /** The depth of the tree is limited by the number of bits of n. */
+  unsigned long stack[ 2 * sizeof( unsigned long ) * 8 ];
+  unsigned int  stackSize = 0;
+  stack[ stackSize++ ] = 0;
+  while( stackSize > 0 )
+  {
+    const ClusterType & cluster = this->m_Clusters[ stack[ --stackSize ] ];
+
+    TScalarType y[ NDimensions ];
+    TScalarType R2 = 0.0;
+    for( unsigned int dim = 0; dim < NDimensions; dim++ )
+    {
+      y[ dim ] = point[ dim ] - cluster.m_Center[ dim ];
+      R2      += y[ dim ] * y[ dim ];
+    }
+
+    if( cluster.m_FirstChild == 0 )
+    {
+      this->EvaluateKernelSum( point, coordinates, weights, numberOfLandmarks,
+        cluster.m_Begin, cluster.m_End, result );
+      continue;
+    }
+    if( R2 <= cluster.m_FarFieldDistanceSquared )
+    {
+      stack[ stackSize++ ] = cluster.m_FirstChild + 1;
+      stack[ stackSize++ ] = cluster.m_FirstChild;
+      continue;
+    }
+
+    const TScalarType invR2 = 1.0 / R2;
+    coefficients[ 0 ] = std::sqrt( R2 );
+    for( unsigned int term = 1; term < NumberOfExpansionTerms; term++ )
+    {
+      TScalarType first  = 0.0;
+      TScalarType second = 0.0;
+      for( unsigned int dim = 0; dim < NDimensions; dim++ )
+      {
+        first  += y[ dim ] * coefficients[ this->m_ExpansionTermPrevious[ term ][ dim ] ];
+        second += coefficients[ this->m_ExpansionTermSecondPrevious[ term ][ dim ] ];
+      }
+      const int degree = this->m_ExpansionTermDegree[ term ];
+      coefficients[ term ] = ( ( 3 - 2 * degree ) * first + ( 3 - degree ) * second )
+        * invR2 * this->m_ExpansionTermInverseDegree[ term ];
+    }
+
+    for( unsigned int term = 0; term < NumberOfExpansionTerms; term++ )
+    {
+      for( unsigned int odim = 0; odim < NDimensions; odim++ )
+      {
+        result[ odim ] += coefficients[ term ] * cluster.m_Moments[ term ][ odim ];
+      }
     }
-    ++sp;
+  }
+
+  for( unsigned int odim = 0; odim < NDimensions; odim++ )
+  {
+    opp[ odim ] += result[ odim ];
   }
 
 } // end ComputeDeformationContribution()
 
 
+/**
+ * ******************* PrecomputeDeformationContribution *******************
+ */
+
+template< class TScalarType, unsigned int NDimensions >
+void
+ThinPlateSplineKernelTransform2< TScalarType, NDimensions >
+::PrecomputeDeformationContribution( void )
+{
+  Superclass::PrecomputeDeformationContribution();
+
+  this->m_Clusters.clear();
+  this->m_ClusterCoordinates.clear();
+  this->m_ClusterWeights.clear();
+
+  const unsigned long numberOfLandmarks = this->m_SourceLandmarks->GetNumberOfPoints();
+  if( this->m_FarFieldTolerance <= 0.0 || numberOfLandmarks == 0 )
+  {
+    return;
+  }
+
+  const unsigned long n           = numberOfLandmarks;
+  const TScalarType * coordinates = this->m_SourceLandmarkCoordinates.data();
+  const TScalarType * weights     = this->m_DMatrix.data_block();
+
+  /** The largest total absolute weight over the output dimensions. The error
+   * of all far-field clusters together is bounded by this sum times the
+   * maximum error per unit weight.
+   */
+  TScalarType weightSum = 0.0;
+  for( unsigned int odim = 0; odim < NDimensions; odim++ )
+  {
+    TScalarType sum = 0.0;
+    for( unsigned long lnd = 0; lnd < n; lnd++ )
+    {
+      sum += std::abs( weights[ odim * n + lnd ] );
+    }
+    weightSum = std::max( weightSum, sum );
+  }
+
+  /** Build a kd-tree, by recursively splitting the landmarks at the median
+   * along the largest extent of their bounding box. Evaluating the expansion
+   * costs about as much as the exact kernel sum over NumberOfExpansionTerms
+   * landmarks, so clusters up to that size are leaves. Each cluster is a
+   * contiguous range of the permutation.
+   */
+  const unsigned long          maximumLeafSize = NumberOfExpansionTerms;
+  std::vector< unsigned long > permutation( n );
+  for( unsigned long lnd = 0; lnd < n; lnd++ )
+  {
+    permutation[ lnd ] = lnd;
+  }
+
+  ClusterType root;
+  root.m_Begin      = 0;
+  root.m_End        = n;
+  root.m_FirstChild = 0;
+  this->m_Clusters.push_back( root );
+  for( std::size_t c = 0; c < this->m_Clusters.size(); c++ )
+  {
+    const unsigned long begin = this->m_Clusters[ c ].m_Begin;
+    const unsigned long end   = this->m_Clusters[ c ].m_End;
+    if( end - begin <= maximumLeafSize )
+    {
+      continue;
+    }
+
+    unsigned int splitDimension = 0;
+    TScalarType  largestExtent  = -1.0;
+    for( unsigned int dim = 0; dim < NDimensions; dim++ )
+    {
+      TScalarType minimum = coordinates[ dim * n + permutation[ begin ] ];
+      TScalarType maximum = minimum;
+      for( unsigned long i = begin + 1; i < end; i++ )
+      {
+        const TScalarType x = coordinates[ dim * n + permutation[ i ] ];
+        minimum = std::min( minimum, x );
+        maximum = std::max( maximum, x );
+      }
+      if( maximum - minimum > largestExtent )
+      {
+        largestExtent  = maximum - minimum;
+        splitDimension = dim;
+      }
+    }
+
+    const unsigned long middle = begin + ( end - begin ) / 2;
+    const TScalarType * x      = coordinates + splitDimension * n;
+    std::nth_element( permutation.begin() + begin, permutation.begin() + middle,
+      permutation.begin() + end,
+      [ x ]( unsigned long i, unsigned long j ) { return x[ i ] < x[ j ]; } );
+
+    ClusterType child;
+    child.m_FirstChild = 0;
+    child.m_Begin      = begin;
+    child.m_End        = middle;
+    this->m_Clusters[ c ].m_FirstChild = this->m_Clusters.size();
+    this->m_Clusters.push_back( child );
+    child.m_Begin = middle;
+    child.m_End   = end;
+    this->m_Clusters.push_back( child );
+  }
+
+  /** Reorder the coordinates and weights by cluster. */
+  this->m_ClusterCoordinates.resize( NDimensions * n );
+  this->m_ClusterWeights.resize( NDimensions * n );
+  for( unsigned long lnd = 0; lnd < n; lnd++ )
+  {
+    for( unsigned int dim = 0; dim < NDimensions; dim++ )
+    {
+      this->m_ClusterCoordinates[ dim * n + lnd ] = coordinates[ dim * n + permutation[ lnd ] ];
+      this->m_ClusterWeights[ dim * n + lnd ]     = weights[ dim * n + permutation[ lnd ] ];
+    }
+  }
+
+  /** Compute the center, radius and moments of every cluster. For p at
+   * distance rho from the center and x at distance R, the remainder of the
+   * expansion of |x - p| of order P is at most
+   *   2 / ( 2P + 1 ) rho^(P+1) / ( R^(P-1) ( R - rho ) ),
+   * which follows from the expansion in Gegenbauer polynomials C_n^(-1/2),
+   * bounded by 2 / ( 2n - 1 ). A cluster is evaluated in the far field if
+   * this bound times weightSum is below the tolerance.
+   */
+  const unsigned int p           = FarFieldExpansionOrder;
+  const double       errorFactor = 2.0 / ( 2.0 * p + 1.0 ) * weightSum / this->m_FarFieldTolerance;
+  const TScalarType * x = this->m_ClusterCoordinates.data();
+  const TScalarType * w = this->m_ClusterWeights.data();
+  TScalarType         monomials[ NumberOfExpansionTerms ];
+  for( std::size_t c = 0; c < this->m_Clusters.size(); c++ )
+  {
+    ClusterType & cluster = this->m_Clusters[ c ];
+
+    for( unsigned int dim = 0; dim < NDimensions; dim++ )
+    {
+      const TScalarType * xd = x + dim * n;
+      cluster.m_Center[ dim ] = 0.5 * ( *std::min_element( xd + cluster.m_Begin, xd + cluster.m_End )
+        + *std::max_element( xd + cluster.m_Begin, xd + cluster.m_End ) );
+    }
+
+    for( unsigned int term = 0; term < NumberOfExpansionTerms; term++ )
+    {
+      std::fill( cluster.m_Moments[ term ], cluster.m_Moments[ term ] + NDimensions, 0.0 );
+    }
+
+    TScalarType radius2 = 0.0;
+    for( unsigned long lnd = cluster.m_Begin; lnd < cluster.m_End; lnd++ )
+    {
+      TScalarType delta[ NDimensions ];
+      TScalarType r2 = 0.0;
+      for( unsigned int dim = 0; dim < NDimensions; dim++ )
+      {
+        delta[ dim ] = cluster.m_Center[ dim ] - x[ dim * n + lnd ];
+        r2          += delta[ dim ] * delta[ dim ];
+      }
+      radius2 = std::max( radius2, r2 );
+
+      monomials[ 0 ] = 1.0;
+      for( unsigned int term = 1; term < NumberOfExpansionTerms; term++ )
+      {
+        monomials[ term ] = monomials[ this->m_ExpansionTermParent[ term ] ]
+          * delta[ this->m_ExpansionTermParentDimension[ term ] ];
+      }
+      for( unsigned int term = 0; term < NumberOfExpansionTerms; term++ )
+      {
+        for( unsigned int odim = 0; odim < NDimensions; odim++ )
+        {
+          cluster.m_Moments[ term ][ odim ] += w[ odim * n + lnd ] * monomials[ term ];
+        }
+      }
+    }
+
+    /** Find the far-field distance R = q rho, i.e. the smallest q > 1 with
+     * q^(P-1) ( q - 1 ) >= errorFactor rho, by bisection.
+     */
+    const double radius = std::sqrt( radius2 );
+    const double target = errorFactor * radius;
+    double       lower  = 1.0;
+    double       upper  = 2.0;
+    while( std::pow( upper, p - 1.0 ) * ( upper - 1.0 ) < target )
+    {
+      lower  = upper;
+      upper *= 2.0;
+    }
+    for( unsigned int i = 0; i < 50; i++ )
+    {
+      const double q = 0.5 * ( lower + upper );
+      if( std::pow( q, p - 1.0 ) * ( q - 1.0 ) < target )
+      {
+        lower = q;
+      }
+      else
+      {
+        upper = q;
+      }
+    }
+    const double farDistance = upper * radius;
+    cluster.m_FarFieldDistanceSquared = farDistance * farDistance;
+  }
+
+} // end PrecomputeDeformationContribution()
+
+
+/**
+ * ******************* PrintSelf *******************
+ */
+
+template< class TScalarType, unsigned int NDimensions >
+void
+ThinPlateSplineKernelTransform2< TScalarType, NDimensions >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "FarFieldTolerance: "
+     << this->m_FarFieldTolerance << std::endl;
+  os << indent << "NumberOfClusters: "
+     << this->m_Clusters.size() << std::endl;
+
+} // end PrintSelf()
+
+
 } // namespace itk
 
 #endif
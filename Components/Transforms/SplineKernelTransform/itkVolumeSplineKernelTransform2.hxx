@@ -35,6 +35,8 @@
 #define __itkVolumeSplineKernelTransform2_hxx
 
 #include "itkVolumeSplineKernelTransform2.h"
+#include <algorithm>
+#include <cmath>
 
 namespace itk
 {
@@ -63,19 +65,32 @@ VolumeSplineKernelTransform2< TScalarType, NDimensions >
   const InputPointType  & thisPoint, OutputPointType & opp ) const
 {
   const unsigned long numberOfLandmarks = this->m_SourceLandmarks->GetNumberOfPoints();
-  PointsIterator      sp                = this->m_SourceLandmarks->GetPoints()->Begin();
 
-  for( unsigned int lnd = 0; lnd < numberOfLandmarks; lnd++ )
+  /** Use the contiguous landmark coordinates and the rows of D. */
+  const TScalarType * coordinates = this->m_SourceLandmarkCoordinates.data();
+  const TScalarType * weights     = this->m_DMatrix.data_block();
+
+  TScalarType sum[ NDimensions ];
+  std::fill( sum, sum + NDimensions, NumericTraits< TScalarType >::ZeroValue() );
+  for( unsigned long lnd = 0; lnd < numberOfLandmarks; lnd++ )
   {
-    InputVectorType   position = thisPoint - sp->Value();
-    const TScalarType r        = position.GetNorm();
-    const TScalarType r3       = r * r * r;
+    TScalarType r2 = 0.0;
+    for( unsigned int dim = 0; dim < NDimensions; dim++ )
+    {
+      const TScalarType diff = thisPoint[ dim ] - coordinates[ dim * numberOfLandmarks + lnd ];
+      r2 += diff * diff;
+    }
+    const TScalarType r3 = r2 * std::sqrt( r2 );
 
     for( unsigned int odim = 0; odim < NDimensions; odim++ )
     {
-      opp[ odim ] += r3 * this->m_DMatrix( odim, lnd );
+      sum[ odim ] += r3 * weights[ odim * numberOfLandmarks + lnd ];
     }
-    ++sp;
+  }
+
+  for( unsigned int odim = 0; odim < NDimensions; odim++ )
+  {
+    opp[ odim ] += sum[ odim ];
   }
 
 } // end ComputeDeformationContribution()
@@ -36,6 +36,16 @@ namespace elastix
  *
  * This class contains all the common functionality for ImageSamplers.
  *
+ * The parameters used in this class are:
+ * \parameter SortSamplesByGridCell: Whether the samples are sorted by the cell
+ *    of the B-spline control point grid that they are in. The metric then
+ *    evaluates the samples of one cell consecutively, which reuses the same
+ *    B-spline coefficients, instead of in random order. The samples themselves
+ *    do not change. Only has effect with a B-spline transform.
+ *    Can be given for each resolution.\n
+ *    example: <tt>(SortSamplesByGridCell "true")</tt> \n
+ *    The default is "false".
+ *
  * \ingroup ImageSamplers
  * \ingroup ComponentBaseClasses
  */
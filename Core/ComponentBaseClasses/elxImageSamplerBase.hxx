@@ -64,6 +64,12 @@ ImageSamplerBase< TElastix >
   }
   else { this->GetAsITKBaseType()->SetUseMultiThread( false ); }
 
+  /** Sort the samples by the B-spline grid cells, or not. */
+  bool sortSamplesByGridCell = false;
+  this->m_Configuration->ReadParameter( sortSamplesByGridCell,
+    "SortSamplesByGridCell", this->GetComponentLabel(), level, 0 );
+  this->GetAsITKBaseType()->SetSortSamplesByGridCell( sortSamplesByGridCell );
+
 } // end BeforeEachResolutionBase()
 
 
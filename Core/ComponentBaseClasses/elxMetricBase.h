@@ -23,6 +23,7 @@
 
 #include "elxBaseComponentSE.h"
 #include "itkAdvancedImageToImageMetric.h"
+#include "itkImageCopySampler.h"
 #include "itkImageGridSampler.h"
 #include "itkPointSet.h"
 
@@ -63,6 +64,26 @@ namespace elastix
  *    CheckNumberOfSamples. \n
  *    example: <tt>(RequiredRatioOfValidSamples 0.1)</tt> \n
  *    The default is 0.25.
+ * \parameter UseReducedMemoryImageModel: Whether the metric stores its precomputed
+ *    moving image buffers in a memory-lean way: B-spline coefficients in float
+ *    and no precomputed gradient image. Can be given for each resolution. \n
+ *    example: <tt>(UseReducedMemoryImageModel "true")</tt> \n
+ *    The default is false.
+ * \parameter UseLazyImageSampling: Whether the Full and Grid image samplers only
+ *    describe the sample grid, instead of storing every sample, so that memory
+ *    does not grow with the number of samples. Only used by metrics that support
+ *    it, currently AdvancedMeanSquares. Can be given for each resolution. \n
+ *    example: <tt>(UseLazyImageSampling "true")</tt> \n
+ *    The default is false.
+ * \parameter UseBSplineSampleWeightsCache: Whether the metric stores the B-spline
+ *    interpolation weights of its fixed image samples, when a RecursiveBSplineTransform
+ *    is optimized and the same samples are used in consecutive iterations, for example
+ *    with the Full or Grid sampler, or with <tt>(NewSamplesEveryIteration "false")</tt>.
+ *    Costs (SplineOrder + 1) * Dimension doubles per sample. Only used by metrics that
+ *    support it, currently AdvancedMeanSquares, AdvancedMattesMutualInformation and
+ *    NormalizedMutualInformation. Can be given for each resolution. \n
+ *    example: <tt>(UseBSplineSampleWeightsCache "true")</tt> \n
+ *    The default is false.
  *
  * \ingroup Metrics
  * \ingroup ComponentBaseClasses
@@ -127,6 +148,10 @@ public:
   /** Typedefs for sampler support. */
   typedef typename AdvancedMetricType::ImageSamplerType ImageSamplerBaseType;
 
+  /** Typedefs for the cost function contexts. */
+  typedef typename AdvancedMetricType::Pointer               AdvancedMetricPointer;
+  typedef typename AdvancedMetricType::AdvancedTransformType AdvancedTransformType;
+
   /** Return type of GetValue */
   typedef typename ITKBaseType::MeasureType MeasureType;
 
@@ -177,6 +202,25 @@ public:
    */
   virtual ImageSamplerBaseType * GetAdvancedMetricImageSampler( void ) const;
 
+  /** Create an independent copy of this metric, which can be evaluated
+   * concurrently with it, see itk::ConcurrentCostFunctionEvaluator. The
+   * copy is configured by the same parameters as this metric, shares its
+   * images, masks and interpolator, uses the given transform, and copies
+   * the samples of the sampler of this metric, see itk::ImageCopySampler.
+   * The copy still has to be initialized. Returns null when this metric is
+   * not of AdvancedMetricType, or does not SupportsCostFunctionContexts().
+   */
+  virtual AdvancedMetricPointer CreateCostFunctionContext(
+    AdvancedTransformType * transform, const unsigned int metricIndex ) const;
+
+  /** Returns whether CreateCostFunctionContext() can copy this metric. This
+   * requires that the metric reads all its settings in
+   * ReadAdvancedMetricParameters(), and does not need the other
+   * BeforeRegistration() or BeforeEachResolution() steps. Default false.
+   */
+  virtual bool SupportsCostFunctionContexts( void ) const
+  { return false; }
+
   /** Get if the exact metric value is computed */
   virtual bool GetShowExactMetricValue( void ) const
   { return this->m_ShowExactMetricValue; }
@@ -213,6 +257,14 @@ protected:
 
   /** \todo the method GetExactDerivative could as well be added here. */
 
+  /** Read the settings of the AdvancedMetricType, like the required ratio
+   * of valid samples and the multi-threading. Called by
+   * BeforeEachResolutionBase(), and by CreateCostFunctionContext() to
+   * configure the copy. Metrics may override it to read their own settings
+   * as well, after calling this implementation.
+   */
+  virtual void ReadAdvancedMetricParameters( void );
+
   bool                             m_ShowExactMetricValue;
   ExactMetricImageSamplerPointer   m_ExactMetricSampler;
   MeasureType                      m_CurrentExactMetricValue;
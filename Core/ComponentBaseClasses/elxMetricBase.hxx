@@ -102,6 +102,25 @@ MetricBase< TElastix >
     this->m_ExactMetricEachXNumberOfIterations = eachXNumberOfIterations;
   }
 
+  /** Read the settings of advanced metrics. */
+  this->ReadAdvancedMetricParameters();
+
+} // end BeforeEachResolutionBase()
+
+
+/**
+ * ******************* ReadAdvancedMetricParameters ******************
+ */
+
+template< class TElastix >
+void
+MetricBase< TElastix >
+::ReadAdvancedMetricParameters( void )
+{
+  /** Get the current resolution level. */
+  unsigned int level
+    = this->m_Registration->GetAsITKBaseType()->GetCurrentLevel();
+
   /** Cast this to AdvancedMetricType. */
   AdvancedMetricType * thisAsAdvanced
     = dynamic_cast< AdvancedMetricType * >( this );
@@ -164,6 +183,24 @@ MetricBase< TElastix >
       thisAsAdvanced->SetScaleGradientWithRespectToMovingImageOrientation( wrtMoving );
     }
 
+    /** Should the metric use a memory-lean model of the moving image? */
+    bool useReducedMemoryImageModel = false;
+    this->GetConfiguration()->ReadParameter( useReducedMemoryImageModel,
+      "UseReducedMemoryImageModel", this->GetComponentLabel(), level, 0 );
+    thisAsAdvanced->SetUseReducedMemoryImageModel( useReducedMemoryImageModel );
+
+    /** Should the metric iterate over the full/grid sampler's grid directly? */
+    bool useLazyImageSampling = false;
+    this->GetConfiguration()->ReadParameter( useLazyImageSampling,
+      "UseLazyImageSampling", this->GetComponentLabel(), level, 0 );
+    thisAsAdvanced->SetUseLazyImageSampling( useLazyImageSampling );
+
+    /** Should the metric cache the B-spline weights of reused samples? */
+    bool useBSplineSampleWeightsCache = false;
+    this->GetConfiguration()->ReadParameter( useBSplineSampleWeightsCache,
+      "UseBSplineSampleWeightsCache", this->GetComponentLabel(), level, 0 );
+    thisAsAdvanced->SetUseBSplineSampleWeightsCache( useBSplineSampleWeightsCache );
+
     /** Should the metric use multi-threading? */
     bool useMultiThreading = true;
     this->GetConfiguration()->ReadParameter( useMultiThreading,
@@ -182,7 +219,7 @@ MetricBase< TElastix >
 
   } // end advanced metric
 
-} // end BeforeEachResolutionBase()
+} // end ReadAdvancedMetricParameters()
 
 
 /**
@@ -391,6 +428,71 @@ typename MetricBase< TElastix >::ImageSamplerBaseType
 
 } // end GetAdvancedMetricImageSampler()
 
+/**
+ * ******************* CreateCostFunctionContext ********************
+ */
+
+template< class TElastix >
+typename MetricBase< TElastix >::AdvancedMetricPointer
+MetricBase< TElastix >
+::CreateCostFunctionContext( AdvancedTransformType * transform,
+  const unsigned int metricIndex ) const
+{
+  /** Cast this to AdvancedMetricType. */
+  const AdvancedMetricType * thisAsAdvanced
+    = dynamic_cast< const AdvancedMetricType * >( this );
+  if( thisAsAdvanced == 0 || !this->SupportsCostFunctionContexts() )
+  {
+    return nullptr;
+  }
+
+  /** Create another metric of the same type. */
+  itk::LightObject::Pointer anotherMetric = this->GetAsITKBaseType()->CreateAnother();
+  Self *                    context       = dynamic_cast< Self * >( anotherMetric.GetPointer() );
+  AdvancedMetricPointer     contextAsAdvanced
+    = dynamic_cast< AdvancedMetricType * >( anotherMetric.GetPointer() );
+  if( context == 0 || contextAsAdvanced.IsNull() )
+  {
+    return nullptr;
+  }
+
+  /** Configure it like this metric, by the same parameters. Only the
+   * parameters are read: the other steps of BeforeRegistration() and
+   * BeforeEachResolution() may add columns to the iteration info.
+   */
+  context->SetElastix( this->GetElastix() );
+  context->SetComponentLabel( "Metric", metricIndex );
+  context->ReadAdvancedMetricParameters();
+
+  /** Share the images, masks, and interpolator. */
+  typedef typename AdvancedMetricType::FixedImageMaskType  FixedImageMaskType;
+  typedef typename AdvancedMetricType::MovingImageMaskType MovingImageMaskType;
+  typedef typename AdvancedMetricType::InterpolatorType    InterpolatorType;
+  contextAsAdvanced->SetFixedImage( thisAsAdvanced->GetFixedImage() );
+  contextAsAdvanced->SetFixedImageRegion( thisAsAdvanced->GetFixedImageRegion() );
+  contextAsAdvanced->SetFixedImageMask(
+    const_cast< FixedImageMaskType * >( thisAsAdvanced->GetFixedImageMask() ) );
+  contextAsAdvanced->SetMovingImage( thisAsAdvanced->GetMovingImage() );
+  contextAsAdvanced->SetMovingImageMask(
+    const_cast< MovingImageMaskType * >( thisAsAdvanced->GetMovingImageMask() ) );
+  contextAsAdvanced->SetInterpolator(
+    const_cast< InterpolatorType * >( thisAsAdvanced->GetInterpolator() ) );
+  contextAsAdvanced->SetTransform( transform );
+
+  /** Use the samples of this metric, without updating its sampler. */
+  if( thisAsAdvanced->GetUseImageSampler() )
+  {
+    typedef itk::ImageCopySampler< FixedImageType > CopySamplerType;
+    typename CopySamplerType::Pointer copySampler = CopySamplerType::New();
+    copySampler->SetSourceSampler( thisAsAdvanced->GetImageSampler() );
+    contextAsAdvanced->SetImageSampler( copySampler );
+  }
+
+  return contextAsAdvanced;
+
+} // end CreateCostFunctionContext()
+
+
 } // end namespace elastix
 
 #endif // end #ifndef __elxMetricBase_hxx
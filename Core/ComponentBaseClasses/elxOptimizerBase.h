@@ -24,6 +24,10 @@
 
 #include "elxBaseComponentSE.h"
 #include "itkOptimizer.h"
+#include "itkCommand.h"
+#include "itkConvergenceMonitor.h"
+
+#include <vector>
 
 namespace elastix
 {
@@ -44,6 +48,69 @@ namespace elastix
  *    Choose one from {"true", "false"} for every resolution.\n
  *    example: <tt>(NewSamplesEveryIteration "true" "true" "true")</tt> \n
  *    Default is "false" for every resolution.\n
+ * \parameter AdaptiveNumberOfSamples: if this flag is set to "true", optimizers that
+ *    support it (AdaptiveStochasticGradientDescent, AdaGrad and
+ *    AdaptiveStochasticVarianceReducedGradient) adapt the number of samples of the
+ *    random samplers every iteration, such that the estimated variance of the
+ *    gradient is about GradientNoiseRatio times its squared magnitude. Only used
+ *    in combination with NewSamplesEveryIteration. The number of samples is
+ *    written to the iteration info.\n
+ *    example: <tt>(AdaptiveNumberOfSamples "true")</tt> \n
+ *    Default is "false" for every resolution.\n
+ * \parameter GradientNoiseRatio: the desired ratio of the gradient variance and the
+ *    squared gradient magnitude. Smaller values result in more samples.\n
+ *    example: <tt>(GradientNoiseRatio 0.5)</tt> \n
+ *    Default is 1.0 for every resolution.\n
+ * \parameter MinimumNumberOfSamplesFactor: the lower bound of the number of samples,
+ *    relative to the NumberOfSpatialSamples of the sampler.\n
+ *    example: <tt>(MinimumNumberOfSamplesFactor 0.1)</tt> \n
+ *    Default is 0.25 for every resolution.\n
+ * \parameter MaximumNumberOfSamplesFactor: the upper bound of the number of samples,
+ *    relative to the NumberOfSpatialSamples of the sampler.\n
+ *    example: <tt>(MaximumNumberOfSamplesFactor 8.0)</tt> \n
+ *    Default is 4.0 for every resolution.\n
+ * \parameter UseConvergenceMonitor: if this flag is set to "true", the iterative
+ *    optimizers stop a resolution before MaximumNumberOfIterations when the
+ *    optimization has stalled, see itk::ConvergenceMonitor. The iterations are
+ *    divided in windows of ConvergenceWindowSize iterations. The optimization has
+ *    stalled when the mean metric value of a window did not decrease significantly
+ *    with respect to the previous window, and either the gradient has (nearly)
+ *    vanished or the parameters hardly changed during the window. For optimizers
+ *    with NewSamplesEveryIteration "true", the noise of the metric values and
+ *    gradients is taken into account. FiniteDifferenceGradientDescent and
+ *    SimultaneousPerturbation are only monitored with ShowMetricValues "true".
+ *    ConjugateGradientFRPR, Simplex, Powell and FullSearch are not monitored.\n
+ *    example: <tt>(UseConvergenceMonitor "true")</tt> \n
+ *    Default is "false" for every resolution.\n
+ * \parameter ConvergenceWindowSize: the number of iterations per window.\n
+ *    example: <tt>(ConvergenceWindowSize 100)</tt> \n
+ *    Default is 50 for every resolution.\n
+ * \parameter ConvergenceValueTolerance: the decrease of the mean metric value per
+ *    window, relative to its magnitude, below which the value has stalled.\n
+ *    example: <tt>(ConvergenceValueTolerance 1e-5)</tt> \n
+ *    Default is 1e-4 for every resolution.\n
+ * \parameter ConvergenceGradientTolerance: the gradient magnitude, relative to the
+ *    gradient magnitude of the first iteration, below which the gradient has vanished.\n
+ *    example: <tt>(ConvergenceGradientTolerance 1e-4)</tt> \n
+ *    Default is 1e-3 for every resolution.\n
+ * \parameter ConvergenceParameterChangeTolerance: the change of the parameters
+ *    during a window, relative to their total change in this resolution, below
+ *    which the parameters have stalled.\n
+ *    example: <tt>(ConvergenceParameterChangeTolerance 0.001)</tt> \n
+ *    Default is 0.01 for every resolution.\n
+ * \parameter NumberOfConcurrentEvaluations: the number of cost function values that
+ *    are computed concurrently, by the optimizers that evaluate the cost function at
+ *    many independent positions per iteration: CMAEvolutionStrategy,
+ *    FiniteDifferenceGradientDescent, FullSearch and SimultaneousPerturbation. Every
+ *    concurrent evaluation uses its own copy of the metric and the transform, which
+ *    share the images and the samples. The results are the same as with one
+ *    evaluation at a time. The metrics that can be copied are AdvancedKappaStatistic,
+ *    AdvancedMattesMutualInformation, AdvancedMeanSquares,
+ *    AdvancedNormalizedCorrelation and NormalizedMutualInformation. For other
+ *    metrics, a warning is given and the cost function is evaluated one position at
+ *    a time.\n
+ *    example: <tt>(NumberOfConcurrentEvaluations 4)</tt> \n
+ *    Default is 1 for every resolution.\n
  *
  * \ingroup Optimizers
  * \ingroup ComponentBaseClasses
@@ -92,11 +159,28 @@ public:
   /** Add empty SetCurrentPositionPublic, so this function is known in every inherited class. */
   virtual void SetCurrentPositionPublic( const ParametersType & param );
 
+  /** Execute stuff before the registration:
+   * \li Add a column for the number of samples to the iteration info, when
+   * the number of samples is adapted in any resolution, by an optimizer that
+   * provides gradient noise estimates.
+   * \li Observe the iterations, to stop when the optimization has stalled.
+   */
+  void BeforeRegistrationBase( void ) override;
+
   /** Execute stuff before each new pyramid resolution:
    * \li Find out if new samples are used every new iteration in this resolution.
+   * \li Find out if the number of samples is adapted in this resolution, which
+   * requires an optimizer that provides gradient noise estimates.
+   * \li Set up the convergence monitor.
    */
   void BeforeEachResolutionBase() override;
 
+  /** Execute stuff after each pyramid resolution:
+   * \li Restore the number of samples of the samplers.
+   * \li Report an early stop by the convergence monitor.
+   */
+  void AfterEachResolutionBase( void ) override;
+
   /** Execute stuff after registration:
    * \li Compute and print MD5 hash of the transform parameters.
    */
@@ -120,9 +204,109 @@ protected:
    */
   virtual void SelectNewSamples( void );
 
+  /** Bring the samples of the metrics up to date, like the first evaluation
+   * of the cost function in an iteration would. To be called before all
+   * positions of a batch are evaluated concurrently, see
+   * itk::ConcurrentCostFunctionEvaluator::SetEvaluateFirstPositionFirst().
+   */
+  virtual void UpdateImageSamplers( void );
+
   /** Check whether the user asked to select new samples every iteration. */
   virtual bool GetNewSamplesEveryIteration( void ) const;
 
+  /** Check whether the number of samples is adapted in this resolution. */
+  virtual bool GetAdaptiveNumberOfSamples( void ) const;
+
+  /** Check whether the optimizer calls SetGradientNoiseEstimates() and
+   * UpdateNumberOfSamples(), so that it supports AdaptiveNumberOfSamples.
+   * Returns false by default.
+   */
+  virtual bool GetProvidesGradientNoiseEstimates( void ) const
+  {
+    return false;
+  }
+
+  /** Initialize the estimates of the squared magnitude gg of the exact
+   * gradient, and the squared approximation error ee, as measured by the
+   * SampleGradients() of the stochastic optimizers, at the number of samples
+   * of the samplers.
+   */
+  virtual void SetGradientNoiseEstimates( const double gg, const double ee );
+
+  /** Update the gradient noise estimates with the gradient of this iteration,
+   * and adapt the number of samples of the random samplers to it. To be
+   * called in AfterEachIteration(), before SelectNewSamples().
+   *
+   * The variance of the gradient is estimated from the difference of two
+   * successive gradients, which are computed on independent sample sets, and
+   * the squared magnitude of the exact gradient from their inner product.
+   * The number of samples is then chosen such that the variance is
+   * GradientNoiseRatio times the squared magnitude, changing at most a factor
+   * two per iteration.
+   */
+  virtual void UpdateNumberOfSamples( const itk::Array< double > & gradient );
+
+  /** Add the value and gradient of this iteration, and the current position,
+   * to the convergence monitor, when UseConvergenceMonitor is "true". To be
+   * called in AfterEachIteration(), with the optimizer itself. The gradient
+   * may be empty for optimizers that do not compute it. When the optimization
+   * has stalled, it is stopped by optimizer->StopOptimization() after all
+   * observers of this iteration have been called, so that the iteration info
+   * is complete.
+   */
+  template< class TOptimizer >
+  void UpdateConvergenceMonitor( TOptimizer * optimizer, const double value,
+    const itk::Array< double > & gradient, const unsigned long maximumNumberOfIterations )
+  {
+    if( !this->m_UseConvergenceMonitor )
+    {
+      return;
+    }
+
+    if( this->m_StopOptimizationCommand.IsNull() )
+    {
+      typedef itk::SimpleMemberCommand< TOptimizer > StopOptimizationCommandType;
+      const typename StopOptimizationCommandType::Pointer command = StopOptimizationCommandType::New();
+      command->SetCallbackFunction( optimizer, &TOptimizer::StopOptimization );
+      this->m_StopOptimizationCommand = command;
+    }
+    this->AddIterationToConvergenceMonitor( value, gradient, maximumNumberOfIterations );
+  }
+
+
+  /** Check whether the convergence monitor stopped this resolution. */
+  virtual bool GetStoppedByConvergenceMonitor( void ) const;
+
+  /** Print the stopping condition of the optimizer, or that the convergence
+   * monitor stopped it. To be called in AfterEachResolution().
+   */
+  void PrintStopCondition( const std::string & stopcondition ) const;
+
+  /** Typedef for the independent copies of the cost function. */
+  typedef std::vector< itk::SingleValuedCostFunction::Pointer > CostFunctionContextListType;
+
+  /** Create NumberOfConcurrentEvaluations - 1 independent copies of the cost
+   * function of this resolution, see RegistrationBase::CreateCostFunctionContext().
+   * To be called in StartOptimization(), when the cost function is initialized.
+   * Returns an empty list when the cost function cannot be copied.
+   */
+  virtual CostFunctionContextListType CreateCostFunctionContexts( void ) const;
+
+  /** Replace the cost function contexts of an optimizer that supports
+   * concurrent evaluation by those of CreateCostFunctionContexts().
+   */
+  template< class TOptimizer >
+  void SetCostFunctionContexts( TOptimizer * optimizer ) const
+  {
+    optimizer->RemoveCostFunctionContexts();
+    const CostFunctionContextListType contexts = this->CreateCostFunctionContexts();
+    for( std::size_t i = 0; i < contexts.size(); ++i )
+    {
+      optimizer->AddCostFunctionContext( contexts[ i ] );
+    }
+  }
+
+
 private:
 
   /** The private constructor. */
@@ -135,6 +319,47 @@ private:
    */
   bool m_NewSamplesEveryIteration;
 
+  /** Set the number of samples of the random samplers to m_NumberOfSamplesFactor
+   * times their original number of samples.
+   */
+  void SetNumberOfSamplesOfSamplers( void );
+
+  /** Add the value, the gradient and the current position to the monitor. */
+  void AddIterationToConvergenceMonitor( const double value,
+    const itk::Array< double > & gradient, const unsigned long maximumNumberOfIterations );
+
+  /** Called after each iteration, after AfterEachIteration(). */
+  void StopOptimizationIfConverged( void );
+
+  /** Settings and state of the adaptive number of samples. The factors are
+   * relative to the original number of samples of each sampler, and the
+   * gradient variance is the variance at a factor 1.
+   */
+  bool                         m_AdaptiveNumberOfSamples;
+  bool                         m_LogNumberOfSamples;
+  double                       m_GradientNoiseRatio;
+  double                       m_MinimumNumberOfSamplesFactor;
+  double                       m_MaximumNumberOfSamplesFactor;
+  double                       m_NumberOfSamplesFactor;
+  double                       m_PreviousNumberOfSamplesFactor;
+  bool                         m_GradientNoiseEstimatesAreInitialized;
+  double                       m_GradientMagnitudeEstimate;
+  double                       m_GradientVarianceEstimate;
+  itk::Array< double >         m_PreviousSampledGradient;
+  std::vector< unsigned long > m_OriginalNumbersOfSamples;
+
+  /** The convergence monitor, and the number of iterations it may save. */
+  typedef itk::SimpleMemberCommand< Self > ConvergenceCommandType;
+  bool                                     m_UseConvergenceMonitor;
+  itk::ConvergenceMonitor                  m_ConvergenceMonitor;
+  unsigned long                            m_MaximumNumberOfIterationsOfMonitor;
+  bool                                     m_StoppedByConvergenceMonitor;
+  typename ConvergenceCommandType::Pointer m_ConvergenceCommand;
+  itk::Command::Pointer                    m_StopOptimizationCommand;
+
+  /** The number of cost function values computed concurrently. */
+  unsigned int m_NumberOfConcurrentEvaluations;
+
 };
 
 } // end namespace elastix
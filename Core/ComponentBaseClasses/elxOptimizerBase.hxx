@@ -23,6 +23,9 @@
 #include "itkSingleValuedNonLinearOptimizer.h"
 #include "itk_zlib.h"
 
+#include <algorithm>
+#include <cmath>
+
 namespace elastix
 {
 
@@ -36,6 +39,23 @@ OptimizerBase< TElastix >
 {
   this->m_NewSamplesEveryIteration = false;
 
+  this->m_AdaptiveNumberOfSamples              = false;
+  this->m_LogNumberOfSamples                   = false;
+  this->m_GradientNoiseRatio                   = 1.0;
+  this->m_MinimumNumberOfSamplesFactor         = 0.25;
+  this->m_MaximumNumberOfSamplesFactor         = 4.0;
+  this->m_NumberOfSamplesFactor                = 1.0;
+  this->m_PreviousNumberOfSamplesFactor        = 1.0;
+  this->m_GradientNoiseEstimatesAreInitialized = false;
+  this->m_GradientMagnitudeEstimate            = 0.0;
+  this->m_GradientVarianceEstimate             = 0.0;
+
+  this->m_UseConvergenceMonitor              = false;
+  this->m_MaximumNumberOfIterationsOfMonitor = 0;
+  this->m_StoppedByConvergenceMonitor        = false;
+
+  this->m_NumberOfConcurrentEvaluations = 1;
+
 } // end Constructor
 
 
@@ -61,6 +81,49 @@ OptimizerBase< TElastix >
 } // end SetCurrentPositionPublic()
 
 
+/**
+ * ****************** BeforeRegistrationBase **********************
+ */
+
+template< class TElastix >
+void
+OptimizerBase< TElastix >
+::BeforeRegistrationBase( void )
+{
+  /** Check if the number of samples is adapted in any resolution. Only
+   * optimizers that provide gradient noise estimates adapt it.
+   */
+  const std::size_t numberOfEntries = std::max( static_cast< std::size_t >( 1 ),
+    this->GetConfiguration()->CountNumberOfParameterEntries( "AdaptiveNumberOfSamples" ) );
+  this->m_LogNumberOfSamples = false;
+  for( unsigned int level = 0;
+    level < numberOfEntries && this->GetProvidesGradientNoiseEstimates(); ++level )
+  {
+    bool adaptiveNumberOfSamples = false;
+    this->GetConfiguration()->ReadParameter( adaptiveNumberOfSamples,
+      "AdaptiveNumberOfSamples", this->GetComponentLabel(), level, 0, false );
+    this->m_LogNumberOfSamples |= adaptiveNumberOfSamples;
+  }
+
+  /** If so, add a column for the number of samples to the iteration info. */
+  if( this->m_LogNumberOfSamples )
+  {
+    xl::xout[ "iteration" ].AddTargetCell( "5:NumberOfSamples" );
+  }
+
+  /** Observe the iterations after the elastix observer, which calls
+   * AfterEachIteration() and writes the iteration info.
+   */
+  if( this->m_ConvergenceCommand.IsNull() )
+  {
+    this->m_ConvergenceCommand = ConvergenceCommandType::New();
+    this->m_ConvergenceCommand->SetCallbackFunction( this, &Self::StopOptimizationIfConverged );
+    this->GetAsITKBaseType()->AddObserver( itk::IterationEvent(), this->m_ConvergenceCommand );
+  }
+
+} // end BeforeRegistrationBase()
+
+
 /**
  * ****************** BeforeEachResolutionBase **********************
  */
@@ -79,9 +142,114 @@ OptimizerBase< TElastix >
   this->GetConfiguration()->ReadParameter( this->m_NewSamplesEveryIteration,
     "NewSamplesEveryIteration", this->GetComponentLabel(), level, 0 );
 
+  /** Check if the number of samples should be adapted every iteration. */
+  this->m_AdaptiveNumberOfSamples = false;
+  this->GetConfiguration()->ReadParameter( this->m_AdaptiveNumberOfSamples,
+    "AdaptiveNumberOfSamples", this->GetComponentLabel(), level, 0, false );
+  if( this->m_AdaptiveNumberOfSamples && !this->GetProvidesGradientNoiseEstimates() )
+  {
+    xl::xout[ "warning" ]
+      << "WARNING: AdaptiveNumberOfSamples is turned off, "
+      << "because the optimizer does not estimate the gradient noise."
+      << std::endl;
+    this->m_AdaptiveNumberOfSamples = false;
+  }
+  else if( this->m_AdaptiveNumberOfSamples && !this->m_NewSamplesEveryIteration )
+  {
+    xl::xout[ "warning" ]
+      << "WARNING: AdaptiveNumberOfSamples is turned off, "
+      << "because NewSamplesEveryIteration is set to \"false\"."
+      << std::endl;
+    this->m_AdaptiveNumberOfSamples = false;
+  }
+
+  this->m_GradientNoiseRatio = 1.0;
+  this->GetConfiguration()->ReadParameter( this->m_GradientNoiseRatio,
+    "GradientNoiseRatio", this->GetComponentLabel(), level, 0, false );
+  this->m_MinimumNumberOfSamplesFactor = 0.25;
+  this->GetConfiguration()->ReadParameter( this->m_MinimumNumberOfSamplesFactor,
+    "MinimumNumberOfSamplesFactor", this->GetComponentLabel(), level, 0, false );
+  this->m_MaximumNumberOfSamplesFactor = 4.0;
+  this->GetConfiguration()->ReadParameter( this->m_MaximumNumberOfSamplesFactor,
+    "MaximumNumberOfSamplesFactor", this->GetComponentLabel(), level, 0, false );
+
+  /** Start every resolution with the original number of samples. */
+  this->m_NumberOfSamplesFactor                = 1.0;
+  this->m_PreviousNumberOfSamplesFactor        = 1.0;
+  this->m_GradientNoiseEstimatesAreInitialized = false;
+  this->m_PreviousSampledGradient.SetSize( 0 );
+  this->m_OriginalNumbersOfSamples.clear();
+
+  /** Set up the convergence monitor. */
+  this->m_UseConvergenceMonitor = false;
+  this->GetConfiguration()->ReadParameter( this->m_UseConvergenceMonitor,
+    "UseConvergenceMonitor", this->GetComponentLabel(), level, 0, false );
+  unsigned int windowSize = 50;
+  this->GetConfiguration()->ReadParameter( windowSize,
+    "ConvergenceWindowSize", this->GetComponentLabel(), level, 0, false );
+  double valueTolerance = 1e-4;
+  this->GetConfiguration()->ReadParameter( valueTolerance,
+    "ConvergenceValueTolerance", this->GetComponentLabel(), level, 0, false );
+  double gradientTolerance = 1e-3;
+  this->GetConfiguration()->ReadParameter( gradientTolerance,
+    "ConvergenceGradientTolerance", this->GetComponentLabel(), level, 0, false );
+  double parameterChangeTolerance = 0.01;
+  this->GetConfiguration()->ReadParameter( parameterChangeTolerance,
+    "ConvergenceParameterChangeTolerance", this->GetComponentLabel(), level, 0, false );
+
+  this->m_ConvergenceMonitor.SetWindowSize( windowSize );
+  this->m_ConvergenceMonitor.SetValueTolerance( valueTolerance );
+  this->m_ConvergenceMonitor.SetGradientTolerance( gradientTolerance );
+  this->m_ConvergenceMonitor.SetParameterChangeTolerance( parameterChangeTolerance );
+  this->m_ConvergenceMonitor.SetStochastic( this->m_NewSamplesEveryIteration );
+  this->m_ConvergenceMonitor.Initialize();
+  this->m_MaximumNumberOfIterationsOfMonitor = 0;
+  this->m_StoppedByConvergenceMonitor        = false;
+
+  /** Read the number of concurrent cost function evaluations. */
+  this->m_NumberOfConcurrentEvaluations = 1;
+  this->GetConfiguration()->ReadParameter( this->m_NumberOfConcurrentEvaluations,
+    "NumberOfConcurrentEvaluations", this->GetComponentLabel(), level, 0, false );
+
 } // end BeforeEachResolutionBase()
 
 
+/**
+ * ****************** AfterEachResolutionBase **********************
+ */
+
+template< class TElastix >
+void
+OptimizerBase< TElastix >
+::AfterEachResolutionBase( void )
+{
+  /** Restore the number of samples of the samplers. */
+  if( !this->m_OriginalNumbersOfSamples.empty() )
+  {
+    this->m_NumberOfSamplesFactor = 1.0;
+    this->SetNumberOfSamplesOfSamplers();
+    this->m_OriginalNumbersOfSamples.clear();
+  }
+
+  /** Report the iterations that were saved by the convergence monitor. */
+  if( this->GetStoppedByConvergenceMonitor() )
+  {
+    const unsigned long numberOfIterations = this->m_ConvergenceMonitor.GetNumberOfIterations();
+    elxout << "The convergence monitor stopped the optimization after "
+           << numberOfIterations << " iterations, because "
+           << this->m_ConvergenceMonitor.GetStopConditionDescription() << "." << std::endl;
+    if( this->m_MaximumNumberOfIterationsOfMonitor > numberOfIterations )
+    {
+      elxout << "  This saved "
+             << this->m_MaximumNumberOfIterationsOfMonitor - numberOfIterations
+             << " of the maximum of " << this->m_MaximumNumberOfIterationsOfMonitor
+             << " iterations." << std::endl;
+    }
+  }
+
+} // end AfterEachResolutionBase()
+
+
 /**
  * ****************** AfterRegistrationBase **********************
  */
@@ -136,6 +304,27 @@ OptimizerBase< TElastix >
 } // end SelectNewSamples()
 
 
+/**
+ * ****************** UpdateImageSamplers ****************************
+ */
+
+template< class TElastix >
+void
+OptimizerBase< TElastix >
+::UpdateImageSamplers( void )
+{
+  for( unsigned int i = 0; i < this->GetElastix()->GetNumberOfMetrics(); ++i )
+  {
+    const auto sampler = this->GetElastix()->GetElxMetricBase( i )->GetAdvancedMetricImageSampler();
+    if( sampler != nullptr )
+    {
+      sampler->Update();
+    }
+  }
+
+} // end UpdateImageSamplers()
+
+
 /**
  * ****************** GetNewSamplesEveryIteration ********************
  */
@@ -151,6 +340,285 @@ OptimizerBase< TElastix >
 } // end GetNewSamplesEveryIteration()
 
 
+/**
+ * ****************** GetAdaptiveNumberOfSamples ********************
+ */
+
+template< class TElastix >
+bool
+OptimizerBase< TElastix >
+::GetAdaptiveNumberOfSamples( void ) const
+{
+  return this->m_AdaptiveNumberOfSamples;
+
+} // end GetAdaptiveNumberOfSamples()
+
+
+/**
+ * ****************** SetGradientNoiseEstimates ********************
+ */
+
+template< class TElastix >
+void
+OptimizerBase< TElastix >
+::SetGradientNoiseEstimates( const double gg, const double ee )
+{
+  /** The samplers still have their original number of samples here. */
+  this->m_GradientMagnitudeEstimate            = gg;
+  this->m_GradientVarianceEstimate             = ee * this->m_NumberOfSamplesFactor;
+  this->m_GradientNoiseEstimatesAreInitialized = true;
+
+} // end SetGradientNoiseEstimates()
+
+
+/**
+ * ****************** UpdateNumberOfSamples ********************
+ */
+
+template< class TElastix >
+void
+OptimizerBase< TElastix >
+::UpdateNumberOfSamples( const itk::Array< double > & gradient )
+{
+  if( !this->m_AdaptiveNumberOfSamples )
+  {
+    if( this->m_LogNumberOfSamples )
+    {
+      xl::xout[ "iteration" ][ "5:NumberOfSamples" ] << "---";
+    }
+    return;
+  }
+
+  /** Update the estimates with the last two gradients, which are computed on
+   * independent sample sets. The expectation of || g_k - g_{k-1} ||^2 is the
+   * sum of their variances, and of g_k^T g_{k-1} the squared magnitude of the
+   * exact gradient, assuming that it changes little between iterations.
+   */
+  if( this->m_PreviousSampledGradient.GetSize() == gradient.GetSize() )
+  {
+    const double innerProduct = inner_product( gradient, this->m_PreviousSampledGradient );
+    const double variance     = ( gradient - this->m_PreviousSampledGradient ).squared_magnitude()
+      / ( 1.0 / this->m_NumberOfSamplesFactor + 1.0 / this->m_PreviousNumberOfSamplesFactor );
+
+    if( this->m_GradientNoiseEstimatesAreInitialized )
+    {
+      /** Exponential moving averages, to suppress the noise of the estimates. */
+      const double smoothing = 0.9;
+      this->m_GradientMagnitudeEstimate
+        = smoothing * this->m_GradientMagnitudeEstimate + ( 1.0 - smoothing ) * innerProduct;
+      this->m_GradientVarianceEstimate
+        = smoothing * this->m_GradientVarianceEstimate + ( 1.0 - smoothing ) * variance;
+    }
+    else
+    {
+      this->m_GradientMagnitudeEstimate            = innerProduct;
+      this->m_GradientVarianceEstimate             = variance;
+      this->m_GradientNoiseEstimatesAreInitialized = true;
+    }
+  }
+  this->m_PreviousSampledGradient              = gradient;
+  this->m_PreviousNumberOfSamplesFactor = this->m_NumberOfSamplesFactor;
+
+  /** Choose the number of samples at which the variance of the gradient is
+   * GradientNoiseRatio times its squared magnitude.
+   */
+  if( this->m_GradientNoiseEstimatesAreInitialized )
+  {
+    double factor = this->m_MaximumNumberOfSamplesFactor;
+    if( this->m_GradientMagnitudeEstimate > 1e-14 * this->m_GradientVarianceEstimate )
+    {
+      factor = this->m_GradientVarianceEstimate
+        / ( this->m_GradientNoiseRatio * this->m_GradientMagnitudeEstimate );
+    }
+    factor = std::min( std::max( factor, 0.5 * this->m_NumberOfSamplesFactor ),
+      2.0 * this->m_NumberOfSamplesFactor );
+    factor = std::min( std::max( factor, this->m_MinimumNumberOfSamplesFactor ),
+      this->m_MaximumNumberOfSamplesFactor );
+
+    /** Avoid resizing the sample containers for small changes. */
+    if( std::abs( factor - this->m_NumberOfSamplesFactor ) > 0.1 * this->m_NumberOfSamplesFactor )
+    {
+      this->m_NumberOfSamplesFactor = factor;
+      this->SetNumberOfSamplesOfSamplers();
+    }
+  }
+
+  /** Write the number of samples of the first random sampler. */
+  if( this->m_LogNumberOfSamples )
+  {
+    unsigned long numberOfSamples = 0;
+    for( unsigned int i = 0; i < this->GetElastix()->GetNumberOfMetrics(); ++i )
+    {
+      const auto sampler = this->GetElastix()->GetElxMetricBase( i )->GetAdvancedMetricImageSampler();
+      if( sampler != nullptr && sampler->SelectingNewSamplesOnUpdateSupported() )
+      {
+        numberOfSamples = sampler->GetNumberOfSamples();
+        break;
+      }
+    }
+    xl::xout[ "iteration" ][ "5:NumberOfSamples" ] << numberOfSamples;
+  }
+
+} // end UpdateNumberOfSamples()
+
+
+/**
+ * ****************** AddIterationToConvergenceMonitor ********************
+ */
+
+template< class TElastix >
+void
+OptimizerBase< TElastix >
+::AddIterationToConvergenceMonitor( const double value,
+  const itk::Array< double > & gradient, const unsigned long maximumNumberOfIterations )
+{
+  this->m_MaximumNumberOfIterationsOfMonitor = maximumNumberOfIterations;
+  this->m_ConvergenceMonitor.Update( value, gradient,
+    this->GetAsITKBaseType()->GetCurrentPosition() );
+
+} // end AddIterationToConvergenceMonitor()
+
+
+/**
+ * ****************** GetStoppedByConvergenceMonitor ********************
+ */
+
+template< class TElastix >
+bool
+OptimizerBase< TElastix >
+::GetStoppedByConvergenceMonitor( void ) const
+{
+  return this->m_StoppedByConvergenceMonitor;
+
+} // end GetStoppedByConvergenceMonitor()
+
+
+/**
+ * ****************** PrintStopCondition ********************
+ */
+
+template< class TElastix >
+void
+OptimizerBase< TElastix >
+::PrintStopCondition( const std::string & stopcondition ) const
+{
+  if( this->GetStoppedByConvergenceMonitor() )
+  {
+    elxout << "Stopping condition: "
+           << "The convergence monitor detected that the optimization stalled."
+           << std::endl;
+  }
+  else
+  {
+    elxout << "Stopping condition: " << stopcondition << "." << std::endl;
+  }
+
+} // end PrintStopCondition()
+
+
+/**
+ * ****************** CreateCostFunctionContexts ********************
+ */
+
+template< class TElastix >
+typename OptimizerBase< TElastix >::CostFunctionContextListType
+OptimizerBase< TElastix >
+::CreateCostFunctionContexts( void ) const
+{
+  CostFunctionContextListType contexts;
+  for( unsigned int i = 1; i < this->m_NumberOfConcurrentEvaluations; ++i )
+  {
+    itk::SingleValuedCostFunction::Pointer context;
+    try
+    {
+      context = this->GetRegistration()->CreateCostFunctionContext();
+    }
+    catch( itk::ExceptionObject & excp )
+    {
+      xl::xout[ "warning" ] << excp << std::endl;
+    }
+
+    /** Fall back to evaluating one position at a time. */
+    if( context.IsNull() )
+    {
+      xl::xout[ "warning" ]
+        << "WARNING: NumberOfConcurrentEvaluations is ignored, "
+        << "because the metric cannot be copied." << std::endl;
+      contexts.clear();
+      break;
+    }
+    contexts.push_back( context );
+  }
+
+  if( !contexts.empty() )
+  {
+    elxout << "The cost function is evaluated at up to "
+           << contexts.size() + 1 << " positions concurrently." << std::endl;
+  }
+  return contexts;
+
+} // end CreateCostFunctionContexts()
+
+
+/**
+ * ****************** StopOptimizationIfConverged ********************
+ */
+
+template< class TElastix >
+void
+OptimizerBase< TElastix >
+::StopOptimizationIfConverged( void )
+{
+  /** Stopping invokes the EndEvent, and thereby AfterEachResolution(). */
+  if( this->m_UseConvergenceMonitor && this->m_ConvergenceMonitor.GetConverged()
+    && !this->m_StoppedByConvergenceMonitor )
+  {
+    this->m_StoppedByConvergenceMonitor = true;
+    this->m_StopOptimizationCommand->Execute( this->GetAsITKBaseType(), itk::IterationEvent() );
+  }
+
+} // end StopOptimizationIfConverged()
+
+
+/**
+ * ****************** SetNumberOfSamplesOfSamplers ********************
+ */
+
+template< class TElastix >
+void
+OptimizerBase< TElastix >
+::SetNumberOfSamplesOfSamplers( void )
+{
+  const unsigned int numberOfMetrics = this->GetElastix()->GetNumberOfMetrics();
+
+  /** Store the original number of samples of the random samplers, or 0. */
+  if( this->m_OriginalNumbersOfSamples.empty() )
+  {
+    this->m_OriginalNumbersOfSamples.resize( numberOfMetrics, 0 );
+    for( unsigned int i = 0; i < numberOfMetrics; ++i )
+    {
+      const auto sampler = this->GetElastix()->GetElxMetricBase( i )->GetAdvancedMetricImageSampler();
+      if( sampler != nullptr && sampler->SelectingNewSamplesOnUpdateSupported() )
+      {
+        this->m_OriginalNumbersOfSamples[ i ] = sampler->GetNumberOfSamples();
+      }
+    }
+  }
+
+  for( unsigned int i = 0; i < numberOfMetrics; ++i )
+  {
+    if( this->m_OriginalNumbersOfSamples[ i ] > 0 )
+    {
+      const double numberOfSamples = std::floor( 0.5
+        + this->m_NumberOfSamplesFactor * static_cast< double >( this->m_OriginalNumbersOfSamples[ i ] ) );
+      this->GetElastix()->GetElxMetricBase( i )->GetAdvancedMetricImageSampler()
+        ->SetNumberOfSamples( static_cast< unsigned long >( std::max( 1.0, numberOfSamples ) ) );
+    }
+  }
+
+} // end SetNumberOfSamplesOfSamplers()
+
+
 /**
  * ****************** SetSinusScales ********************
  */
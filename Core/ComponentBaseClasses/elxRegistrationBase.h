@@ -28,6 +28,10 @@
 #include "itkImageMaskSpatialObject.h"
 #include "itkErodeMaskImageFilter.h"
 
+#include <map>
+#include <tuple>
+#include <vector>
+
 namespace elastix
 {
 
@@ -67,6 +71,19 @@ namespace elastix
  *    example: <tt>(ErodeMovingMask2 "true" "false")</tt>
  *    This setting overrules ErodeMask and ErodeMovingMask.\n
  *
+ * The eroded masks are cached per resolution level: when the same mask is
+ * used by several metrics, or as both fixed and moving mask with an identical
+ * amount of erosion, the erosion is computed only once. The eroded masks that
+ * are passed to the spatial objects are cropped to the bounding box of the
+ * nonzero voxels, so that the inside tests of the samplers touch less memory.
+ * Masks that are not eroded are used as is.
+ *
+ * Optimizers that evaluate the cost function at many independent positions
+ * can evaluate them concurrently on copies of the cost function, created by
+ * CreateCostFunctionContext(). This is supported for a single metric that
+ * compares one fixed and one moving image, and by the
+ * MultiMetricMultiResolutionRegistration.
+ *
  * \ingroup Registrations
  * \ingroup ComponentBaseClasses
  */
@@ -147,13 +164,30 @@ public:
     const std::string & whichMask,
     const unsigned int level ) const;
 
+  /** Release the cached masks of the last resolution level. */
+  void AfterRegistrationBase( void ) override;
+
+  /** Create an independent, initialized copy of the cost function of the
+   * current resolution level, with its own copy of the transform. It can be
+   * evaluated concurrently with the cost function, see
+   * itk::ConcurrentCostFunctionEvaluator. To be called after the cost
+   * function is initialized, for example in StartOptimization() of the
+   * optimizer. Returns null when copying the cost function is not supported.
+   */
+  virtual itk::SingleValuedCostFunction::Pointer CreateCostFunctionContext( void ) const;
+
 protected:
 
   /** The constructor. */
-  RegistrationBase() {}
+  RegistrationBase() : m_MaskCacheLevel( 0 ) {}
   /** The destructor. */
   ~RegistrationBase() override {}
 
+  /** Create a copy of the transform, whose parameters can be changed
+   * independently, for CreateCostFunctionContext().
+   */
+  virtual typename ITKBaseType::TransformPointer CreateTransformContext( void ) const;
+
   /** Typedef's for mask support. */
   typedef typename ElastixType::MaskPixelType   MaskPixelType;
   typedef typename ElastixType::FixedMaskType   FixedMaskImageType;
@@ -210,8 +244,32 @@ protected:
     const MovingMaskImageType * maskImage, bool useMaskErosion,
     const MovingImagePyramidType * pyramid, unsigned int level ) const;
 
+  /** Return the mask image that is given to the mask spatial objects. Without
+   * erosion, this is the input mask itself. Otherwise it is the eroded mask,
+   * cropped to the bounding box of its nonzero voxels. The eroded mask is
+   * cached, such that a mask that is requested more than once in the same
+   * resolution level, with the same amount of erosion, is only eroded once.
+   * The cache is cleared when the resolution level changes, and after the
+   * registration.
+   */
+  template< class TMaskImage, class TPyramid >
+  typename TMaskImage::Pointer GetPreparedMaskImage(
+    const TMaskImage * maskImage, bool useMaskErosion,
+    const TPyramid * pyramid, unsigned int level, bool isMovingMask ) const;
+
 private:
 
+  /** The key of the mask cache: the mask image, its modification time and
+   * the erosion scales.
+   */
+  typedef std::tuple< const itk::DataObject *,
+    itk::ModifiedTimeType, std::vector< double > >   MaskCacheKeyType;
+  typedef std::map< MaskCacheKeyType,
+    itk::DataObject::Pointer >                       MaskCacheType;
+
+  mutable MaskCacheType m_MaskCache;
+  mutable unsigned int  m_MaskCacheLevel;
+
   /** The private constructor. */
   RegistrationBase( const Self & );   // purposely not implemented
   /** The private copy constructor. */
@@ -19,6 +19,7 @@
 #define __elxRegistrationBase_hxx
 
 #include "elxRegistrationBase.h"
+#include "itkExtractImageFilter.h"
 
 namespace elastix
 {
@@ -94,61 +95,159 @@ RegistrationBase< TElastix >
 
 
 /**
- * ******************* GenerateFixedMaskSpatialObject **********************
+ * ******************* AfterRegistrationBase **********************
  */
 
 template< class TElastix >
-typename RegistrationBase< TElastix >::FixedMaskSpatialObjectPointer
+void
 RegistrationBase< TElastix >
-::GenerateFixedMaskSpatialObject(
-  const FixedMaskImageType * maskImage, bool useMaskErosion,
-  const FixedImagePyramidType * pyramid, unsigned int level ) const
+::AfterRegistrationBase( void )
 {
-  FixedMaskSpatialObjectPointer fixedMaskSpatialObject; // default-constructed (null)
-  if( !maskImage )
+  /** The eroded masks of the last resolution level are not needed anymore. */
+  this->m_MaskCache.clear();
+
+} // end AfterRegistrationBase()
+
+
+/**
+ * ******************* GetPreparedMaskImage **********************
+ */
+
+template< class TElastix >
+template< class TMaskImage, class TPyramid >
+typename TMaskImage::Pointer
+RegistrationBase< TElastix >
+::GetPreparedMaskImage(
+  const TMaskImage * maskImage, bool useMaskErosion,
+  const TPyramid * pyramid, unsigned int level, bool isMovingMask ) const
+{
+  typedef itk::ErodeMaskImageFilter< TMaskImage > ErodeFilterType;
+  typedef itk::ExtractImageFilter< TMaskImage, TMaskImage > ExtractFilterType;
+  typedef itk::ImageMaskSpatialObject< TMaskImage::ImageDimension > SpatialObjectType;
+  typedef typename TMaskImage::RegionType RegionType;
+
+  /** Results of a previous resolution level are not needed anymore. */
+  if( level != this->m_MaskCacheLevel )
   {
-    return fixedMaskSpatialObject;
+    this->m_MaskCache.clear();
+    this->m_MaskCacheLevel = level;
   }
-  fixedMaskSpatialObject = FixedMaskSpatialObjectType::New();
 
-  /** Just convert to spatial object if no erosion is needed. */
+  /** Without erosion, the input mask is used as is. */
   if( !useMaskErosion || !pyramid )
   {
-    fixedMaskSpatialObject->SetImage( maskImage );
-    fixedMaskSpatialObject->Update();
-    return fixedMaskSpatialObject;
+    return const_cast< TMaskImage * >( maskImage );
   }
 
-  /** Erode, and convert to spatial object. */
-  FixedMaskErodeFilterPointer erosion = FixedMaskErodeFilterType::New();
+  /** Setup the erosion. The erosion scales identify the result. */
+  typename ErodeFilterType::Pointer erosion = ErodeFilterType::New();
   erosion->SetInput( maskImage );
   erosion->SetSchedule( pyramid->GetSchedule() );
-  erosion->SetIsMovingMask( false );
+  erosion->SetIsMovingMask( isMovingMask );
   erosion->SetResolutionLevel( level );
+  const typename ErodeFilterType::RadiusType radius = erosion->ComputeErosionScales();
+  const std::vector< double > scales( radius.Begin(), radius.End() );
 
-  /** Set output of the erosion to fixedImageMaskAsImage. */
-  FixedMaskImagePointer erodedFixedMaskAsImage = erosion->GetOutput();
+  /** Return the cached mask, if any. */
+  const MaskCacheKeyType key( maskImage, maskImage->GetMTime(), scales );
+  const typename MaskCacheType::const_iterator found = this->m_MaskCache.find( key );
+  if( found != this->m_MaskCache.end() )
+  {
+    TMaskImage * cachedMask = dynamic_cast< TMaskImage * >( found->second.GetPointer() );
+    if( cachedMask )
+    {
+      return cachedMask;
+    }
+  }
 
-  /** Do the erosion. */
+  /** Erode the mask. */
+  typename TMaskImage::Pointer erodedMask = erosion->GetOutput();
   try
   {
-    erodedFixedMaskAsImage->Update();
+    erodedMask->Update();
   }
   catch( itk::ExceptionObject & excp )
   {
     /** Add information to the exception. */
     excp.SetLocation( "RegistrationBase - UpdateMasks()" );
     std::string err_str = excp.GetDescription();
-    err_str += "\nError while eroding the fixed mask.\n";
+    err_str += "\nError while eroding the ";
+    err_str += isMovingMask ? "moving" : "fixed";
+    err_str += " mask.\n";
     excp.SetDescription( err_str );
     /** Pass the exception to an higher level. */
     throw excp;
   }
 
   /** Release some memory. */
-  erodedFixedMaskAsImage->DisconnectPipeline();
+  erodedMask->DisconnectPipeline();
+
+  /** Determine the bounding box of the nonzero voxels. */
+  typename SpatialObjectType::Pointer boundingBoxMask = SpatialObjectType::New();
+  boundingBoxMask->SetImage( erodedMask );
+  boundingBoxMask->Update();
+  const RegionType boundingBox   = boundingBoxMask->ComputeMyBoundingBoxInIndexSpace();
+  const RegionType bufferedRegion = erodedMask->GetBufferedRegion();
+
+  /** Crop the eroded mask to the bounding box, if that actually makes it smaller. */
+  typename TMaskImage::Pointer preparedMask = erodedMask;
+  if( boundingBox.GetNumberOfPixels() > 0
+    && boundingBox.GetNumberOfPixels() < bufferedRegion.GetNumberOfPixels()
+    && bufferedRegion.IsInside( boundingBox ) )
+  {
+    typename ExtractFilterType::Pointer extract = ExtractFilterType::New();
+    extract->SetInput( erodedMask );
+    extract->SetExtractionRegion( boundingBox );
+    extract->SetDirectionCollapseToSubmatrix();
+    preparedMask = extract->GetOutput();
+    try
+    {
+      preparedMask->Update();
+    }
+    catch( itk::ExceptionObject & excp )
+    {
+      /** Add information to the exception. */
+      excp.SetLocation( "RegistrationBase - UpdateMasks()" );
+      std::string err_str = excp.GetDescription();
+      err_str += "\nError while cropping the ";
+      err_str += isMovingMask ? "moving" : "fixed";
+      err_str += " mask.\n";
+      excp.SetDescription( err_str );
+      /** Pass the exception to an higher level. */
+      throw excp;
+    }
+    preparedMask->DisconnectPipeline();
+  }
+
+  this->m_MaskCache[ key ] = preparedMask.GetPointer();
+  return preparedMask;
+
+} // end GetPreparedMaskImage()
+
+
+/**
+ * ******************* GenerateFixedMaskSpatialObject **********************
+ */
 
-  fixedMaskSpatialObject->SetImage( erodedFixedMaskAsImage );
+template< class TElastix >
+typename RegistrationBase< TElastix >::FixedMaskSpatialObjectPointer
+RegistrationBase< TElastix >
+::GenerateFixedMaskSpatialObject(
+  const FixedMaskImageType * maskImage, bool useMaskErosion,
+  const FixedImagePyramidType * pyramid, unsigned int level ) const
+{
+  FixedMaskSpatialObjectPointer fixedMaskSpatialObject; // default-constructed (null)
+  if( !maskImage )
+  {
+    return fixedMaskSpatialObject;
+  }
+  fixedMaskSpatialObject = FixedMaskSpatialObjectType::New();
+
+  /** Erode and crop if needed, and convert to spatial object. */
+  const FixedMaskImagePointer fixedMaskAsImage = this->GetPreparedMaskImage(
+    maskImage, useMaskErosion, pyramid, level, false );
+
+  fixedMaskSpatialObject->SetImage( fixedMaskAsImage );
   fixedMaskSpatialObject->Update();
   return fixedMaskSpatialObject;
 
@@ -173,48 +272,76 @@ RegistrationBase< TElastix >
   }
   movingMaskSpatialObject = MovingMaskSpatialObjectType::New();
 
-  /** Just convert to spatial object if no erosion is needed. */
-  if( !useMaskErosion || !pyramid )
-  {
-    movingMaskSpatialObject->SetImage( maskImage );
-    movingMaskSpatialObject->Update();
-    return movingMaskSpatialObject;
-  }
+  /** Erode and crop if needed, and convert to spatial object. */
+  const MovingMaskImagePointer movingMaskAsImage = this->GetPreparedMaskImage(
+    maskImage, useMaskErosion, pyramid, level, true );
 
-  /** Erode, and convert to spatial object. */
-  MovingMaskErodeFilterPointer erosion = MovingMaskErodeFilterType::New();
-  erosion->SetInput( maskImage );
-  erosion->SetSchedule( pyramid->GetSchedule() );
-  erosion->SetIsMovingMask( true );
-  erosion->SetResolutionLevel( level );
+  movingMaskSpatialObject->SetImage( movingMaskAsImage );
+  movingMaskSpatialObject->Update();
+  return movingMaskSpatialObject;
 
-  /** Set output of the erosion to movingImageMaskAsImage. */
-  MovingMaskImagePointer erodedMovingMaskAsImage = erosion->GetOutput();
+} // end GenerateMovingMaskSpatialObject()
 
-  /** Do the erosion. */
-  try
+
+/**
+ * ******************* CreateCostFunctionContext **********************
+ */
+
+template< class TElastix >
+itk::SingleValuedCostFunction::Pointer
+RegistrationBase< TElastix >
+::CreateCostFunctionContext( void ) const
+{
+  /** Only a single metric on a single pair of images is supported here. */
+  ElastixType * elastix = this->GetElastix();
+  if( elastix->GetNumberOfMetrics() != 1
+    || elastix->GetNumberOfFixedImages() != 1
+    || elastix->GetNumberOfMovingImages() != 1 )
   {
-    erodedMovingMaskAsImage->Update();
+    return nullptr;
   }
-  catch( itk::ExceptionObject & excp )
+
+  typename ITKBaseType::TransformPointer transform = this->CreateTransformContext();
+  if( transform.IsNull() )
   {
-    /** Add information to the exception. */
-    excp.SetLocation( "RegistrationBase - UpdateMasks()" );
-    std::string err_str = excp.GetDescription();
-    err_str += "\nError while eroding the moving mask.\n";
-    excp.SetDescription( err_str );
-    /** Pass the exception to an higher level. */
-    throw excp;
+    return nullptr;
   }
 
-  /** Release some memory */
-  erodedMovingMaskAsImage->DisconnectPipeline();
+  typename ElastixType::MetricBaseType::AdvancedMetricPointer context
+    = elastix->GetElxMetricBase()->CreateCostFunctionContext( transform, 0 );
+  if( context.IsNull() )
+  {
+    return nullptr;
+  }
+  context->Initialize();
+  return context.GetPointer();
 
-  movingMaskSpatialObject->SetImage( erodedMovingMaskAsImage );
-  movingMaskSpatialObject->Update();
-  return movingMaskSpatialObject;
+} // end CreateCostFunctionContext()
 
-} // end GenerateMovingMaskSpatialObject()
+
+/**
+ * ******************* CreateTransformContext **********************
+ */
+
+template< class TElastix >
+typename RegistrationBase< TElastix >::ITKBaseType::TransformPointer
+RegistrationBase< TElastix >
+::CreateTransformContext( void ) const
+{
+  typedef typename ITKBaseType::TransformType TransformType;
+  const TransformType * transform = this->GetAsITKBaseType()->GetTransform();
+  if( transform == nullptr )
+  {
+    return nullptr;
+  }
+
+  /** AdvancedCombinationTransform clones the current transform, and
+   * shares the initial transform, which is not optimized.
+   */
+  itk::LightObject::Pointer clone = transform->Clone().GetPointer();
+  return dynamic_cast< TransformType * >( clone.GetPointer() );
+
+} // end CreateTransformContext()
 
 
 } // end namespace elastix
@@ -23,6 +23,7 @@
 
 #include "elxBaseComponentSE.h"
 #include "itkResampleImageFilter.h"
+#include "itkDisplacementFieldTransform.h"
 #include "elxProgressCommand.h"
 
 namespace elastix
@@ -64,6 +65,24 @@ namespace elastix
  *    of the written image is desired.\n
  *    example: <tt>(CompressResultImage "true")</tt> \n
  *    The default is "false".
+ * \parameter ComposeTransformChain: flag to compose a chain of transforms
+ *    (a transform with initial transforms) into one dense displacement field
+ *    before resampling. Each voxel then needs one interpolation in the field,
+ *    instead of the evaluation of each transform in the chain. The difference
+ *    with the exact chain is estimated and printed to the log.\n
+ *    example: <tt>(ComposeTransformChain "true")</tt> \n
+ *    The default is "false".
+ * \parameter ComposedDisplacementFieldSubsamplingFactor: the grid spacing
+ *    of the composed displacement field, relative to the spacing of the
+ *    result image. A larger factor saves time and memory, at the cost of
+ *    accuracy.\n
+ *    example: <tt>(ComposedDisplacementFieldSubsamplingFactor 2)</tt> \n
+ *    The default is 1.
+ *
+ * The composed displacement field is kept, and reused as long as the
+ * transform chain and the output grid do not change. It is not streamed:
+ * the displacement field transform may look up any point of the field, so
+ * the whole field is kept in memory; use the subsampling factor to limit it.
  *
  * \ingroup Resamplers
  * \ingroup ComponentBaseClasses
@@ -191,6 +210,62 @@ protected:
   /** Method that sets the transform, the interpolator and the inputImage. */
   virtual void SetComponents( void );
 
+  /** Typedef's for the composed transform chain. */
+  typedef itk::DisplacementFieldTransform<
+    CoordRepType, itkGetStaticConstMacro( ImageDimension ) > DisplacementFieldTransformType;
+
+  /** Set a displacement field transform, composed from the transform
+   * chain, if ComposeTransformChain is "true". Returns the transform that
+   * it replaced, so it can be restored after resampling. */
+  virtual const TransformType * ComposeTransformChain( void );
+
+  /** Restores the transform chain of the resampler, after it was replaced
+   * by ComposeTransformChain(). The destructor restores it as well, so that
+   * the composed field is not left behind when resampling throws.
+   */
+  class TransformChainRestorer
+  {
+  public:
+
+    TransformChainRestorer( ITKBaseType * resampler, const TransformType * transformChain ) :
+      m_Resampler( resampler ),
+      m_TransformChain( transformChain ),
+      m_IsComposed( transformChain != resampler->GetTransform() )
+    {}
+
+    ~TransformChainRestorer()
+    {
+      this->Restore();
+    }
+
+
+    void Restore( void )
+    {
+      if( this->m_IsComposed )
+      {
+        this->m_Resampler->SetTransform( this->m_TransformChain );
+        this->m_IsComposed = false;
+      }
+    }
+
+
+    bool IsComposed( void ) const
+    {
+      return this->m_IsComposed;
+    }
+
+
+  private:
+
+    TransformChainRestorer( const TransformChainRestorer & ); // purposely not implemented
+    void operator=( const TransformChainRestorer & );         // purposely not implemented
+
+    ITKBaseType *                        m_Resampler;
+    typename TransformType::ConstPointer m_TransformChain;
+    bool                                 m_IsComposed;
+  };
+
+
   /** Variable that defines to print the progress or not. */
   bool m_ShowProgress;
 
@@ -204,6 +279,12 @@ private:
   /** Release memory. */
   void ReleaseMemory( void );
 
+  /** The composed transform chain of ComposeTransformChain(), with the
+   * chain and its modification time, to reuse the field. */
+  typename DisplacementFieldTransformType::Pointer m_ComposedTransform;
+  typename TransformType::ConstPointer             m_ComposedTransformChain;
+  itk::ModifiedTimeType                            m_ComposedTransformChainMTime;
+
 };
 
 } // end namespace elastix
@@ -23,8 +23,13 @@
 #include "itkImageFileCastWriter.h"
 #include "itkChangeInformationImageFilter.h"
 #include "itkAdvancedRayCastInterpolateImageFunction.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkTransformToDisplacementFieldFilter.h"
 #include "itkTimeProbe.h"
 
+#include <algorithm>
+#include <cmath>
+
 namespace elastix
 {
 
@@ -36,7 +41,8 @@ template< class TElastix >
 ResamplerBase< TElastix >
 ::ResamplerBase()
 {
-  this->m_ShowProgress = true;
+  this->m_ShowProgress                = true;
+  this->m_ComposedTransformChainMTime = 0;
 } // end Constructor
 
 
@@ -315,6 +321,163 @@ ResamplerBase< TElastix >
 } // end SetComponents()
 
 
+/**
+ * ******************* ComposeTransformChain ********************
+ */
+
+template< class TElastix >
+const typename ResamplerBase< TElastix >::TransformType *
+ResamplerBase< TElastix >
+::ComposeTransformChain( void )
+{
+  const TransformType * transform = this->GetAsITKBaseType()->GetTransform();
+
+  /** Check if the user asked for it, and if there is a chain to compose. */
+  bool composeTransformChain = false;
+  this->m_Configuration->ReadParameter( composeTransformChain,
+    "ComposeTransformChain", 0, false );
+  if( !composeTransformChain )
+  {
+    return transform;
+  }
+
+  typedef itk::AdvancedRayCastInterpolateImageFunction< InputImageType,
+    CoordRepType > RayCastInterpolatorType;
+  if( dynamic_cast< const RayCastInterpolatorType * >(
+    this->GetAsITKBaseType()->GetInterpolator() ) != nullptr )
+  {
+    xl::xout[ "warning" ] << "WARNING: ComposeTransformChain is not supported "
+                          << "by the RayCastResampleInterpolator, and is ignored." << std::endl;
+    return transform;
+  }
+  if( this->m_Elastix->GetElxTransformBase()->GetAsITKBaseType()
+    ->GetNumberOfTransforms() < 2 )
+  {
+    elxout << "  ComposeTransformChain is ignored, because there is only one transform." << std::endl;
+    return transform;
+  }
+
+  unsigned int factor = 1;
+  this->m_Configuration->ReadParameter( factor,
+    "ComposedDisplacementFieldSubsamplingFactor", 0, false );
+  factor = std::max( factor, 1u );
+
+  /** Typedef's. */
+  typedef typename DisplacementFieldTransformType::DisplacementFieldType DisplacementFieldType;
+  typedef itk::TransformToDisplacementFieldFilter<
+    DisplacementFieldType, CoordRepType >                   DisplacementFieldGeneratorType;
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator RandomGeneratorType;
+
+  /** The field covers the output grid, with the spacing multiplied by factor.
+   * Its last grid point is at or beyond the last output voxel, so each voxel
+   * is inside the field.
+   */
+  const ITKBaseType * resampler = this->GetAsITKBaseType();
+  SizeType    size    = resampler->GetSize();
+  SpacingType spacing = resampler->GetOutputSpacing();
+  for( unsigned int i = 0; i < ImageDimension; ++i )
+  {
+    size[ i ]     = ( size[ i ] + factor - 2 ) / factor + 1;
+    spacing[ i ] *= factor;
+  }
+  const DirectionType & direction = resampler->GetOutputDirection();
+  OriginPointType       origin    = resampler->GetOutputOrigin();
+  for( unsigned int i = 0; i < ImageDimension; ++i )
+  {
+    const double offset = resampler->GetOutputStartIndex()[ i ] * resampler->GetOutputSpacing()[ i ];
+    for( unsigned int j = 0; j < ImageDimension; ++j )
+    {
+      origin[ j ] += direction[ j ][ i ] * offset;
+    }
+  }
+
+  /** Reuse the previous field, if neither the grid nor the transforms of
+   * the chain have been modified since.
+   */
+  const auto * chain = this->m_Elastix->GetElxTransformBase()->GetAsITKBaseType();
+  itk::ModifiedTimeType chainMTime = transform->GetMTime();
+  for( itk::SizeValueType i = 0; i < chain->GetNumberOfTransforms(); ++i )
+  {
+    chainMTime = std::max( chainMTime, chain->GetNthTransform( i )->GetMTime() );
+  }
+  if( this->m_ComposedTransform.IsNotNull()
+    && this->m_ComposedTransformChain.GetPointer() == transform
+    && this->m_ComposedTransformChainMTime == chainMTime )
+  {
+    const DisplacementFieldType * field = this->m_ComposedTransform->GetDisplacementField();
+    if( field->GetLargestPossibleRegion().GetSize() == size
+      && field->GetSpacing() == spacing && field->GetOrigin() == origin
+      && field->GetDirection() == direction )
+    {
+      elxout << "  Reusing the displacement field of the composed transform chain." << std::endl;
+      this->GetAsITKBaseType()->SetTransform( this->m_ComposedTransform );
+      return transform;
+    }
+  }
+
+  /** Compute the field. The filter is multi-threaded over blocks of the
+   * field, and evaluates the full chain once per grid point. The field is
+   * not streamed, see the class documentation.
+   */
+  elxout << "  Composing the transform chain into a displacement field of size "
+         << size << " ..." << std::endl;
+  itk::TimeProbe timer;
+  timer.Start();
+
+  typename DisplacementFieldGeneratorType::Pointer generator
+    = DisplacementFieldGeneratorType::New();
+  generator->SetSize( size );
+  generator->SetOutputSpacing( spacing );
+  generator->SetOutputOrigin( origin );
+  generator->SetOutputDirection( direction );
+  generator->SetTransform( transform );
+  generator->Update();
+
+  typename DisplacementFieldTransformType::Pointer fieldTransform
+    = DisplacementFieldTransformType::New();
+  fieldTransform->SetDisplacementField( generator->GetOutput() );
+  timer.Stop();
+
+  /** Estimate the error against the exact chain, at random points
+   * in between the grid points of the field.
+   */
+  const unsigned int numberOfSamples = 1000;
+  typename RandomGeneratorType::Pointer randomGenerator = RandomGeneratorType::New();
+  randomGenerator->SetSeed( 1234 );
+  double meanError = 0.0;
+  double maxError  = 0.0;
+  for( unsigned int n = 0; n < numberOfSamples; ++n )
+  {
+    typename TransformType::InputPointType point = origin;
+    for( unsigned int i = 0; i < ImageDimension; ++i )
+    {
+      const double offset = randomGenerator->GetUniformVariate( 0.0, size[ i ] - 1.0 ) * spacing[ i ];
+      for( unsigned int j = 0; j < ImageDimension; ++j )
+      {
+        point[ j ] += direction[ j ][ i ] * offset;
+      }
+    }
+    const double error = transform->TransformPoint( point )
+      .EuclideanDistanceTo( fieldTransform->TransformPoint( point ) );
+    meanError += error / numberOfSamples;
+    maxError   = std::max( maxError, error );
+  }
+
+  elxout << "  Composing the transform chain took "
+         << this->ConvertSecondsToDHMS( timer.GetMean(), 2 ) << std::endl;
+  elxout << "  Estimated error of the composed transform: mean "
+         << meanError << ", max " << maxError << " (mm)" << std::endl;
+
+  this->m_ComposedTransform           = fieldTransform;
+  this->m_ComposedTransformChain      = transform;
+  this->m_ComposedTransformChainMTime = chainMTime;
+
+  this->GetAsITKBaseType()->SetTransform( fieldTransform );
+  return transform;
+
+} // end ComposeTransformChain()
+
+
 /**
  * ******************* ResampleAndWriteResultImage ********************
  */
@@ -327,6 +490,11 @@ ResamplerBase< TElastix >
   /** Make sure the resampler is updated. */
   this->GetAsITKBaseType()->Modified();
 
+  /** Possibly replace the transform chain by a composed displacement field,
+   * until this function returns. */
+  TransformChainRestorer transformChainRestorer(
+    this->GetAsITKBaseType(), this->ComposeTransformChain() );
+
   /** Add a progress observer to the resampler. */
   const auto progressObserver = BaseComponent::IsElastixLibrary() ?
     nullptr : ProgressCommandType::New();
@@ -357,6 +525,9 @@ ResamplerBase< TElastix >
   /** Perform the writing. */
   this->WriteResultImage( this->GetAsITKBaseType()->GetOutput(), filename, showProgress );
 
+  /** Restore the transform chain. */
+  transformChainRestorer.Restore();
+
   /** Disconnect from the resampler. */
   if( showProgress && (progressObserver != nullptr) )
   {
@@ -470,6 +641,11 @@ ResamplerBase< TElastix >
   /** Make sure the resampler is updated. */
   this->GetAsITKBaseType()->Modified();
 
+  /** Possibly replace the transform chain by a composed displacement field,
+   * until this function returns. */
+  TransformChainRestorer transformChainRestorer(
+    this->GetAsITKBaseType(), this->ComposeTransformChain() );
+
   const auto progressObserver = BaseComponent::IsElastixLibrary() ?
     nullptr : ProgressCommandType::CreateAndConnect(*(this->GetAsITKBaseType()));
 
@@ -627,6 +803,14 @@ ResamplerBase< TElastix >
       << "\"." );
   }
 
+  /** Restore the transform chain. The result image is disconnected first,
+   * so that it is not resampled again with the chain. */
+  if( transformChainRestorer.IsComposed() )
+  {
+    resultImage->DisconnectPipeline();
+    transformChainRestorer.Restore();
+  }
+
   //put image in container
   this->m_Elastix->SetResultImage( resultImage );
 
@@ -841,6 +1025,10 @@ ResamplerBase< TElastix >
    * elastix. Releasing some memory at this point helps a lot.
    */
 
+  /** Release the field of a composed transform chain. */
+  this->m_ComposedTransform      = nullptr;
+  this->m_ComposedTransformChain = nullptr;
+
   /** Release more memory, but only if this is the final elastix level. */
   if( this->GetConfiguration()->GetElastixLevel() + 1
     == this->GetConfiguration()->GetTotalNumberOfElastixLevels() )
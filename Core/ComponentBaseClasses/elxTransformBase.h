@@ -26,6 +26,7 @@
 #include "itkAdvancedCombinationTransform.h"
 #include "elxComponentDatabase.h"
 #include "elxProgressCommand.h"
+#include "itkMemoryMappedFile.h"
 
 #include <fstream>
 #include <iomanip>
@@ -278,6 +279,13 @@ public:
   /** Macro for reading and writing the transform parameters in WriteToFile or not. */
   virtual void SetReadWriteTransformParameters( const bool _arg );
 
+  /** Set whether the transform is read by transformix. Transformix maps a
+   * binary TransformParameters file into memory, instead of reading it.
+   * The setting is passed on to the initial transforms. Default: false. */
+  virtual void SetReadByTransformix( const bool _arg );
+
+  virtual bool GetReadByTransformix( void ) const;
+
   /** Function to read the initial transform parameters from a file. */
   virtual void ReadInitialTransformFromFile(
     const char * transformParameterFileName );
@@ -352,6 +360,10 @@ protected:
   std::string      m_TransformParametersFileName;
   ParametersType   m_FinalParameters;
 
+  /** The binary transform parameter file, mapped into memory. The memory
+   * is used as the data of m_TransformParametersPointer. */
+  itk::MemoryMappedFile m_TransformParametersFile;
+
 private:
 
   /** The private constructor. */
@@ -362,6 +374,9 @@ private:
   /** Boolean to decide whether or not the transform parameters are written. */
   bool m_ReadWriteTransformParameters;
 
+  /** Boolean to decide whether or not the transform is read by transformix. */
+  bool m_ReadByTransformix;
+
   std::string GetInitialTransformParametersFileName( void ) const
   {
     if( !this->GetInitialTransform() )
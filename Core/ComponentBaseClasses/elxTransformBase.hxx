@@ -112,6 +112,7 @@ TransformBase< TElastix >
   /** Initialize. */
   this->m_TransformParametersPointer   = 0;
   this->m_ReadWriteTransformParameters = true;
+  this->m_ReadByTransformix            = false;
   this->m_UseBinaryFormatForTransformationParameters = false;
 
 } // end Constructor()
@@ -416,19 +417,52 @@ TransformBase< TElastix >
     {
       delete this->m_TransformParametersPointer;
     }
-    this->m_TransformParametersPointer = new ParametersType( numberOfParameters );
+    this->m_TransformParametersFile.Unmap();
 
-    /** Read the TransformParameters. */
+    /** The array is sized when the parameters are read into it, and left
+     * empty when it is set to the memory mapped file.
+     */
+    this->m_TransformParametersPointer = new ParametersType();
+
+    /** Read the TransformParameters. Many parameters are stored as numbers
+     * by the parameter file parser, and are copied directly.
+     */
     std::size_t numberOfParametersFound = 0;
     std::vector< ValueType > vecPar;
+    const typename ConfigurationType::NumericParameterValuesType * numericPar
+      = this->m_Configuration->GetNumericParameterValues( "TransformParameters" );
     if( useBinaryFormatForTransformationParameters )
     {
       std::string dataFileName = "";
       this->m_Configuration->ReadParameter( dataFileName, "TransformParameters", 0 );
-      std::ifstream infile( dataFileName.c_str(), std::ios::in | std::ios::binary );
-      infile.read( reinterpret_cast<char *>( this->m_TransformParametersPointer->data_block() ), sizeof( ValueType ) * numberOfParameters );
-      numberOfParametersFound = infile.gcount() / sizeof( ValueType ); // for sanity check
-      infile.close();
+
+      /** When running transformix, map the file into memory and use it
+       * directly as parameter array, instead of reading it. The pages are
+       * loaded when first accessed. Elastix itself reads the file, because
+       * it may overwrite it (for an initial transform in the output directory).
+       */
+      if( this->m_ReadByTransformix && this->m_TransformParametersFile.Map( dataFileName ) )
+      {
+        numberOfParametersFound = std::min< std::size_t >( numberOfParameters,
+          this->m_TransformParametersFile.GetSize() / sizeof( ValueType ) ); // for sanity check
+        if( numberOfParametersFound == numberOfParameters )
+        {
+          this->m_TransformParametersPointer->SetData( static_cast< ValueType * >(
+            this->m_TransformParametersFile.GetPointer() ), numberOfParameters, false );
+        }
+      }
+      else
+      {
+        this->m_TransformParametersPointer->SetSize( numberOfParameters );
+        std::ifstream infile( dataFileName.c_str(), std::ios::in | std::ios::binary );
+        infile.read( reinterpret_cast<char *>( this->m_TransformParametersPointer->data_block() ), sizeof( ValueType ) * numberOfParameters );
+        numberOfParametersFound = infile.gcount() / sizeof( ValueType ); // for sanity check
+        infile.close();
+      }
+    }
+    else if( numericPar )
+    {
+      numberOfParametersFound = numericPar->size();
     }
     else
     {
@@ -459,6 +493,15 @@ TransformBase< TElastix >
 
     /** Copy to m_TransformParametersPointer. */
     if( !useBinaryFormatForTransformationParameters )
+    {
+      this->m_TransformParametersPointer->SetSize( numberOfParameters );
+    }
+    if( !useBinaryFormatForTransformationParameters && numericPar )
+    {
+      std::copy( numericPar->begin(), numericPar->end(),
+        this->m_TransformParametersPointer->data_block() );
+    }
+    else if( !useBinaryFormatForTransformationParameters )
     {
       // NOTE: we could avoid this by directly reading into the transform parameters,
       // e.g. by overloading ReadParameter(), or use swap (?).
@@ -583,6 +626,7 @@ TransformBase< TElastix >
     //elx_initialTransform->SetTransformParametersFileName(transformParametersFileName);
     elx_initialTransform->SetElastix( this->GetElastix() );
     elx_initialTransform->SetConfiguration( configurationInitialTransform );
+    elx_initialTransform->SetReadByTransformix( this->m_ReadByTransformix );
     elx_initialTransform->ReadFromFile();
 
     /** Set initial transform. */
@@ -645,6 +689,7 @@ TransformBase< TElastix >
     //elx_initialTransform->SetTransformParametersFileName(transformParametersFileName);
     elx_initialTransform->SetElastix( this->GetElastix() );
     elx_initialTransform->SetConfiguration( configurationInitialTransform );
+    elx_initialTransform->SetReadByTransformix( this->m_ReadByTransformix );
     elx_initialTransform->ReadFromFile();
 
     /** Set initial transform. */
@@ -1853,6 +1898,34 @@ TransformBase< TElastix >
 } // end SetReadWriteTransformParameters()
 
 
+/**
+ * ******************* SetReadByTransformix *********************
+ */
+
+template< class TElastix >
+void
+TransformBase< TElastix >
+::SetReadByTransformix( const bool _arg )
+{
+  this->m_ReadByTransformix = _arg;
+
+} // end SetReadByTransformix()
+
+
+/**
+ * ******************* GetReadByTransformix *********************
+ */
+
+template< class TElastix >
+bool
+TransformBase< TElastix >
+::GetReadByTransformix( void ) const
+{
+  return this->m_ReadByTransformix;
+
+} // end GetReadByTransformix()
+
+
 /**
  * ************** AutomaticScalesEstimation ***************
  */
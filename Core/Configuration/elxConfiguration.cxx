@@ -34,6 +34,10 @@ Configuration::Configuration()
   this->m_ParameterFileParser   = ParameterFileParserType::New();
   this->m_ParameterMapInterface = ParameterMapInterfaceType::New();
 
+  /** Store parameters with many values, like the TransformParameters of a
+   * B-spline transform, as numbers instead of strings. */
+  this->m_ParameterFileParser->SetNumericParameterThreshold( 1024 );
+
   this->m_IsInitialized              = false;
   this->m_ElastixLevel               = 0;
   this->m_TotalNumberOfElastixLevels = 1;
@@ -150,8 +154,10 @@ Configuration
     return 1;
   }
 
-  /** Read the ParameterFile. */
+  /** Read the ParameterFile. Transform parameter files are cached, since
+   * the same chain of initial transforms is often read many times. */
   this->m_ParameterFileParser->SetParameterFileName( this->m_ParameterFileName );
+  this->m_ParameterFileParser->SetUseCache( tp != "" );
   try
   {
     xl::xout[ "standard" ] << "Reading the elastix parameters from file ...\n" << std::endl;
@@ -167,6 +173,8 @@ Configuration
   /** Connect the parameter file reader to the interface. */
   this->m_ParameterMapInterface->SetParameterMap(
     this->m_ParameterFileParser->GetParameterMap() );
+  this->m_ParameterMapInterface->SetNumericParameterMap(
+    this->m_ParameterFileParser->GetNumericParameterMap() );
 
   /** Silently check in the parameter file if error messages should be printed. */
   this->m_ParameterMapInterface->SetPrintErrorMessages( false );
@@ -73,6 +73,8 @@ public:
   typedef ParameterFileParserType::Pointer   ParameterFileParserPointer;
   typedef itk::ParameterMapInterface         ParameterMapInterfaceType;
   typedef ParameterMapInterfaceType::Pointer ParameterMapInterfacePointer;
+  typedef ParameterMapInterfaceType::NumericParameterValuesType
+    NumericParameterValuesType;
 
   /** Get and Set CommandLine arguments into the argument map. */
   std::string GetCommandLineArgument( const std::string & key ) const;
@@ -141,6 +143,16 @@ public:
   }
 
 
+  /** Get the values of a parameter that is stored as numbers, or a null
+   * pointer if it is stored as strings. */
+  const NumericParameterValuesType * GetNumericParameterValues(
+    const std::string & parameterName ) const
+  {
+    return this->m_ParameterMapInterface->GetNumericParameterValues(
+      parameterName );
+  }
+
+
   /** Read a parameter from the parameter file. */
   template< class T >
   bool ReadParameter( T & parameterValue, const std::string & parameterName,
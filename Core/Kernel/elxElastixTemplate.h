@@ -39,6 +39,8 @@
 #include "elxTransformBase.h"
 
 #include "itkTimeProbe.h"
+#include "itkHotPathProfiler.h"
+#include "elxIterationInfoWriter.h"
 
 #include <sstream>
 #include <fstream>
@@ -94,6 +96,18 @@ namespace elastix
  *    example: <tt>(WriteTransformParametersEachResolution "true")</tt>\n
  *    This parameter can not be specified for each resolution separately.
  *    Default value: "false".
+ * \parameter IterationInfoFormat: The formats in which the iteration info table
+ *    is written to IterationInfo.<elastixlevel>.R<resolution>.<extension>.
+ *    Any combination of "text" (the tab-separated table, also shown on the
+ *    screen and in the log file), "jsonl" (one JSON object per iteration) and
+ *    "binary" (a compact typed format, see IterationInfoWriter).
+ *    The jsonl and binary files are written by a background thread.
+ *    Without "text" the table is not formatted at all, and not shown on the
+ *    screen.\n
+ *    example: <tt>(IterationInfoFormat "jsonl")</tt>\n
+ *    example: <tt>(IterationInfoFormat "text" "binary")</tt>\n
+ *    This parameter can not be specified for each resolution separately.
+ *    Default value: "text".
  * \parameter UseDirectionCosines: Controls whether to use or ignore the
  * direction cosines (world matrix, transform matrix) set in the images.
  * Voxel spacing and image origin are always taken into account, regardless
@@ -356,6 +370,12 @@ protected:
   TimerType m_IterationTimer;
   TimerType m_ResolutionTimer;
 
+#ifdef ELASTIX_USE_PROFILING
+  /** Profiler totals at the start of the current iteration and resolution. */
+  itk::HotPathProfiler::SnapshotType m_ProfilerIterationSnapshot;
+  itk::HotPathProfiler::SnapshotType m_ProfilerResolutionSnapshot;
+#endif
+
   /** Store the CurrentTransformParameterFileName. */
   std::string m_CurrentTransformParameterFileName;
 
@@ -383,6 +403,18 @@ protected:
 
   std::ofstream m_IterationInfoFile;
 
+  /** Open the jsonl and/or binary iteration info files of the IterationInfoWriter. */
+  virtual void OpenIterationInfoWriter( void );
+
+  /** The formats of the iteration info, see the IterationInfoFormat parameter. */
+  bool m_IterationInfoAsText;
+  bool m_IterationInfoAsJSONL;
+  bool m_IterationInfoAsBinary;
+
+  /** Writes the typed iteration info records on a background thread. */
+  IterationInfoWriter                        m_IterationInfoWriter;
+  xl::xoutbase_type::TypedValueContainerType m_IterationInfoRecord;
+
   /** Used by the callback functions, BeforeEachResolution() etc.).
    * This method calls a function in each component, in the following order:
    * \li Registration
@@ -60,6 +60,11 @@ ElastixTemplate< TFixedImage, TMovingImage >
   /** Initialize the this->m_IterationCounter. */
   this->m_IterationCounter = 0;
 
+  /** The iteration info is written as text by default. */
+  this->m_IterationInfoAsText   = true;
+  this->m_IterationInfoAsJSONL  = false;
+  this->m_IterationInfoAsBinary = false;
+
   /** Initialize CurrentTransformParameterFileName. */
   this->m_CurrentTransformParameterFileName = "";
   this->m_TransformParametersMap.clear();
@@ -416,6 +421,7 @@ ElastixTemplate< TFixedImage, TMovingImage >
   elxout << "Calling all ReadFromFile()'s ..." << std::endl;
   this->GetElxResampleInterpolatorBase()->ReadFromFile();
   this->GetElxResamplerBase()->ReadFromFile();
+  this->GetElxTransformBase()->SetReadByTransformix( true );
   this->GetElxTransformBase()->ReadFromFile();
 
   /** Tell the user. */
@@ -613,6 +619,65 @@ ElastixTemplate< TFixedImage, TMovingImage >
   xout[ "iteration" ].AddTargetCell( "Time[ms]" );
   xout[ "iteration" ][ "Time[ms]" ] << std::showpoint << std::fixed << std::setprecision( 1 );
 
+#ifdef ELASTIX_USE_PROFILING
+  /** Add columns with the time per phase and the counters. */
+  typedef itk::HotPathProfiler ProfilerType;
+  for( unsigned int i = 0; i < ProfilerType::NumberOfPhases; ++i )
+  {
+    const std::string column = std::string( "Prof:" )
+      + ProfilerType::GetPhaseName( static_cast< ProfilerType::PhaseType >( i ) ) + "[ms]";
+    xout[ "iteration" ].AddTargetCell( column.c_str() );
+    xout[ "iteration" ][ column.c_str() ] << std::showpoint << std::fixed << std::setprecision( 1 );
+  }
+  for( unsigned int i = 0; i < ProfilerType::NumberOfCounters; ++i )
+  {
+    const std::string column = std::string( "Prof:" )
+      + ProfilerType::GetCounterName( static_cast< ProfilerType::CounterType >( i ) );
+    xout[ "iteration" ].AddTargetCell( column.c_str() );
+  }
+#endif
+
+  /** Read the formats in which the iteration info is written. */
+  this->m_IterationInfoAsText   = false;
+  this->m_IterationInfoAsJSONL  = false;
+  this->m_IterationInfoAsBinary = false;
+  const std::size_t numberOfFormats
+    = this->GetConfiguration()->CountNumberOfParameterEntries( "IterationInfoFormat" );
+  for( std::size_t i = 0; i < numberOfFormats; ++i )
+  {
+    std::string format = "";
+    this->GetConfiguration()->ReadParameter( format,
+      "IterationInfoFormat", i, false );
+    if( format == "text" )
+    {
+      this->m_IterationInfoAsText = true;
+    }
+    else if( format == "jsonl" )
+    {
+      this->m_IterationInfoAsJSONL = true;
+    }
+    else if( format == "binary" )
+    {
+      this->m_IterationInfoAsBinary = true;
+    }
+    else
+    {
+      xout[ "warning" ] << "WARNING: unknown IterationInfoFormat \""
+                        << format << "\" is ignored." << std::endl;
+    }
+  }
+  if( !this->m_IterationInfoAsJSONL && !this->m_IterationInfoAsBinary )
+  {
+    this->m_IterationInfoAsText = true;
+  }
+
+  /** Capture the typed values of the iteration info for the jsonl and binary
+   * formats, and only format the cells when the table is written as text.
+   */
+  xout[ "iteration" ].SetCaptureTypedValues(
+    this->m_IterationInfoAsJSONL || this->m_IterationInfoAsBinary );
+  xout[ "iteration" ].SetFormatText( this->m_IterationInfoAsText );
+
   /** Print time for initializing. */
   this->m_Timer0.Stop();
   elxout << "Initialization of all components (before registration) took: "
@@ -661,10 +726,15 @@ ElastixTemplate< TFixedImage, TMovingImage >
   bool writeIterationInfo = true;
   this->GetConfiguration()->ReadParameter( writeIterationInfo,
     "WriteIterationInfo", 0, false );
-  if( writeIterationInfo )
+  if( writeIterationInfo && this->m_IterationInfoAsText )
   {
     this->OpenIterationInfoFile();
   }
+  if( writeIterationInfo
+    && ( this->m_IterationInfoAsJSONL || this->m_IterationInfoAsBinary ) )
+  {
+    this->OpenIterationInfoWriter();
+  }
 
   /** Call all the BeforeEachResolution() functions. */
   this->BeforeEachResolutionBase();
@@ -686,6 +756,11 @@ ElastixTemplate< TFixedImage, TMovingImage >
   this->m_IterationTimer.Reset();
   this->m_IterationTimer.Start();
 
+#ifdef ELASTIX_USE_PROFILING
+  this->m_ProfilerResolutionSnapshot = itk::HotPathProfiler::GetSnapshot();
+  this->m_ProfilerIterationSnapshot  = this->m_ProfilerResolutionSnapshot;
+#endif
+
 } // end BeforeEachResolution()
 
 
@@ -713,6 +788,55 @@ ElastixTemplate< TFixedImage, TMovingImage >
     << " s.\n";
   elxout << std::setprecision( this->GetDefaultOutputPrecision() );
 
+  /** Write the remaining iteration info records and close the files. */
+  if( this->m_IterationInfoWriter.IsOpen() )
+  {
+    const std::size_t numberOfDroppedRecords = this->m_IterationInfoWriter.Close();
+    if( numberOfDroppedRecords > 0 )
+    {
+      xout[ "warning" ] << "WARNING: " << numberOfDroppedRecords
+                        << " iteration info records were dropped, because they"
+                        << " could not be written fast enough." << std::endl;
+    }
+  }
+
+#ifdef ELASTIX_USE_PROFILING
+  /** Print a summary of the profiled phases and counters in this resolution.
+   * The phase times are summed over all threads.
+   */
+  typedef itk::HotPathProfiler ProfilerType;
+  const ProfilerType::SnapshotType profile
+    = ProfilerType::GetSnapshot() - this->m_ProfilerResolutionSnapshot;
+  const double resolutionTime = this->m_ResolutionTimer.GetMean();
+  const double iterations     = std::max( 1.0, static_cast< double >( this->m_IterationCounter ) );
+  elxout << "Profile of resolution " << level << " (thread time, summed over threads):\n"
+         << std::setw( 20 ) << std::left << "  phase"
+         << std::setw( 14 ) << std::right << "total[ms]"
+         << std::setw( 14 ) << "per it.[ms]"
+         << std::setw( 12 ) << "% of res." << "\n";
+  for( unsigned int i = 0; i < ProfilerType::NumberOfPhases; ++i )
+  {
+    const double seconds = profile.m_Seconds[ i ];
+    elxout << "  " << std::setw( 18 ) << std::left
+           << ProfilerType::GetPhaseName( static_cast< ProfilerType::PhaseType >( i ) )
+           << std::right << std::fixed << std::setprecision( 1 )
+           << std::setw( 14 ) << seconds * 1000.0
+           << std::setw( 14 ) << seconds * 1000.0 / iterations
+           << std::setw( 12 ) << ( resolutionTime > 0.0 ? 100.0 * seconds / resolutionTime : 0.0 )
+           << "\n";
+  }
+  for( unsigned int i = 0; i < ProfilerType::NumberOfCounters; ++i )
+  {
+    elxout << "  " << std::setw( 18 ) << std::left
+           << ProfilerType::GetCounterName( static_cast< ProfilerType::CounterType >( i ) )
+           << std::right << std::setw( 14 ) << profile.m_Counts[ i ]
+           << std::setw( 14 ) << std::setprecision( 1 ) << profile.m_Counts[ i ] / iterations
+           << "\n";
+  }
+  elxout << std::resetiosflags( std::ios_base::floatfield | std::ios_base::adjustfield )
+         << std::setprecision( this->GetDefaultOutputPrecision() ) << std::endl;
+#endif
+
   /** Call all the AfterEachResolution() functions. */
   this->AfterEachResolutionBase();
   CallInEachComponent( &BaseComponentType::AfterEachResolutionBase );
@@ -756,8 +880,11 @@ void
 ElastixTemplate< TFixedImage, TMovingImage >
 ::AfterEachIteration( void )
 {
+  /** The time spent here shows up in the Logging column of the next iteration. */
+  elxProfileScope( LoggingPhase );
+
   /** Write the headers of the columns that are printed each iteration. */
-  if( this->m_IterationCounter == 0 )
+  if( this->m_IterationCounter == 0 && this->m_IterationInfoAsText )
   {
     xout[ "iteration" ][ "WriteHeaders" ];
   }
@@ -774,8 +901,49 @@ ElastixTemplate< TFixedImage, TMovingImage >
   this->m_IterationTimer.Stop();
   xout[ "iteration" ][ "Time[ms]" ] << this->m_IterationTimer.GetMean() * 1000.0;
 
+#ifdef ELASTIX_USE_PROFILING
+  /** The profiled time per phase and the counters of this iteration. */
+  typedef itk::HotPathProfiler ProfilerType;
+  const ProfilerType::SnapshotType snapshot = ProfilerType::GetSnapshot();
+  const ProfilerType::SnapshotType profile  = snapshot - this->m_ProfilerIterationSnapshot;
+  this->m_ProfilerIterationSnapshot = snapshot;
+  for( unsigned int i = 0; i < ProfilerType::NumberOfPhases; ++i )
+  {
+    const std::string column = std::string( "Prof:" )
+      + ProfilerType::GetPhaseName( static_cast< ProfilerType::PhaseType >( i ) ) + "[ms]";
+    xout[ "iteration" ][ column.c_str() ] << profile.m_Seconds[ i ] * 1000.0;
+  }
+  for( unsigned int i = 0; i < ProfilerType::NumberOfCounters; ++i )
+  {
+    const std::string column = std::string( "Prof:" )
+      + ProfilerType::GetCounterName( static_cast< ProfilerType::CounterType >( i ) );
+    xout[ "iteration" ][ column.c_str() ] << profile.m_Counts[ i ];
+  }
+#endif
+
+  /** Hand over the typed iteration info of this iteration to the background
+   * writer. The values are always extracted, to empty the cells.
+   */
+  if( this->m_IterationInfoAsJSONL || this->m_IterationInfoAsBinary )
+  {
+    xout[ "iteration" ].GetTypedValues( this->m_IterationInfoRecord );
+    if( this->m_IterationInfoWriter.IsOpen() )
+    {
+      if( !this->m_IterationInfoWriter.IsStarted() )
+      {
+        IterationInfoWriter::NameContainerType columnNames;
+        xout[ "iteration" ].GetTargetCellNames( columnNames );
+        this->m_IterationInfoWriter.Start( columnNames );
+      }
+      this->m_IterationInfoWriter.Push( this->m_IterationInfoRecord );
+    }
+  }
+
   /** Write the iteration info of this iteration. */
-  xout[ "iteration" ].WriteBufferedData();
+  if( this->m_IterationInfoAsText )
+  {
+    xout[ "iteration" ].WriteBufferedData();
+  }
 
   /** Create a TransformParameter-file for the current iteration. */
   bool writeTansformParametersThisIteration = false;
@@ -876,6 +1044,10 @@ ElastixTemplate< TFixedImage, TMovingImage >
   CallInEachComponent( &BaseComponentType::AfterRegistrationBase );
   CallInEachComponent( &BaseComponentType::AfterRegistration );
 
+  /** Restore the default iteration info mode, for a next elastix level. */
+  xout[ "iteration" ].SetCaptureTypedValues( false );
+  xout[ "iteration" ].SetFormatText( true );
+
   /** Print the time spent on things after the registration. */
   this->m_Timer0.Stop();
   elxout << "Time spent on saving the results, applying the final transform etc.: "
@@ -1225,6 +1397,36 @@ ElastixTemplate< TFixedImage, TMovingImage >
 } // end OpenIterationInfoFile()
 
 
+/**
+ * ************** OpenIterationInfoWriter ***********************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+ElastixTemplate< TFixedImage, TMovingImage >
+::OpenIterationInfoWriter( void )
+{
+  using namespace xl;
+
+  /** Create the base of the IterationInfo filenames for this resolution. */
+  std::ostringstream makeFileName( "" );
+  makeFileName << this->m_Configuration->GetCommandLineArgument( "-out" )
+               << "IterationInfo."
+               << this->m_Configuration->GetElastixLevel()
+               << ".R" << this->GetElxRegistrationBase()->GetAsITKBaseType()->GetCurrentLevel();
+  std::string baseName = makeFileName.str();
+
+  /** Open the files; the background thread starts at the first iteration. */
+  if( !this->m_IterationInfoWriter.Open( baseName,
+    this->m_IterationInfoAsJSONL, this->m_IterationInfoAsBinary ) )
+  {
+    xout[ "error" ] << "ERROR: Iteration info file \"" << baseName
+                    << ".(jsonl|bin)\" could not be opened!" << std::endl;
+  }
+
+} // end OpenIterationInfoWriter()
+
+
 /**
  * ************** GetOriginalFixedImageDirection *********************
  * Determine the original fixed image direction (it might have been
@@ -0,0 +1,420 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "elxIterationInfoWriter.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+
+namespace elastix
+{
+
+namespace
+{
+
+/** Append text to line as a JSON string. */
+void
+AppendJSONString( std::string & line, const std::string & text )
+{
+  line += '"';
+  for( std::string::const_iterator it = text.begin(); it != text.end(); ++it )
+  {
+    const unsigned char c = static_cast< unsigned char >( *it );
+    if( c == '"' || c == '\\' )
+    {
+      line += '\\';
+      line += static_cast< char >( c );
+    }
+    else if( c < 0x20 )
+    {
+      char escaped[ 8 ];
+      std::snprintf( escaped, sizeof( escaped ), "\\u%04x", c );
+      line += escaped;
+    }
+    else
+    {
+      line += static_cast< char >( c );
+    }
+  }
+  line += '"';
+
+} // end AppendJSONString()
+
+
+/** Get the field of a column, or an empty field if the record is too short. */
+const IterationInfoWriter::FieldType &
+GetField( const IterationInfoWriter::RecordType & record, const std::size_t column )
+{
+  static const IterationInfoWriter::FieldType emptyField;
+  return column < record.size() ? record[ column ] : emptyField;
+
+} // end GetField()
+
+} // end namespace
+
+/**
+ * ********************* Constructor ****************************
+ */
+
+IterationInfoWriter::IterationInfoWriter( std::size_t capacity ) :
+  m_Head( 0 ),
+  m_Tail( 0 ),
+  m_NumberOfDroppedRecords( 0 ),
+  m_Stop( false ),
+  m_IsOpen( false )
+{
+  std::size_t size = 1;
+  while( size < capacity )
+  {
+    size *= 2;
+  }
+  this->m_Slots.resize( size );
+  this->m_Mask = size - 1;
+
+} // end Constructor
+
+
+/**
+ * ********************* Destructor *****************************
+ */
+
+IterationInfoWriter::~IterationInfoWriter()
+{
+  this->Close();
+
+} // end Destructor
+
+
+/**
+ * ************************* Open *******************************
+ */
+
+bool
+IterationInfoWriter::Open( const std::string & baseName, bool writeJSONL, bool writeBinary )
+{
+  this->Close();
+
+  bool success = true;
+  if( writeJSONL )
+  {
+    this->m_JSONLFile.open( ( baseName + ".jsonl" ).c_str() );
+    success &= this->m_JSONLFile.is_open();
+  }
+  if( writeBinary )
+  {
+    this->m_BinaryFile.open( ( baseName + ".bin" ).c_str(), std::ios::binary );
+    success &= this->m_BinaryFile.is_open();
+  }
+
+  this->m_NumberOfDroppedRecords = 0;
+  this->m_IsOpen = this->m_JSONLFile.is_open() || this->m_BinaryFile.is_open();
+  return success;
+
+} // end Open()
+
+
+/**
+ * ************************* Start ******************************
+ */
+
+void
+IterationInfoWriter::Start( const NameContainerType & columnNames )
+{
+  if( !this->m_IsOpen || this->IsStarted() )
+  {
+    return;
+  }
+
+  this->m_ColumnNames = columnNames;
+
+  /** Write the header of the binary file. */
+  if( this->m_BinaryFile.is_open() )
+  {
+    const std::uint32_t byteOrder       = 0x01020304;
+    const std::uint32_t numberOfColumns = static_cast< std::uint32_t >( columnNames.size() );
+    this->m_BinaryFile.write( "ELXITB01", 8 );
+    this->m_BinaryFile.write( reinterpret_cast< const char * >( &byteOrder ), sizeof( byteOrder ) );
+    this->m_BinaryFile.write( reinterpret_cast< const char * >( &numberOfColumns ), sizeof( numberOfColumns ) );
+    for( std::size_t i = 0; i < columnNames.size(); ++i )
+    {
+      this->WriteBinaryString( columnNames[ i ] );
+    }
+  }
+
+  /** Preallocate the slots, so pushing a record does not allocate. */
+  for( std::size_t i = 0; i < this->m_Slots.size(); ++i )
+  {
+    this->m_Slots[ i ].resize( columnNames.size() );
+  }
+
+  this->m_Head = 0;
+  this->m_Tail = 0;
+  this->m_Stop = false;
+  this->m_Thread = std::thread( &Self::ThreadedWrite, this );
+
+} // end Start()
+
+
+/**
+ * ************************* Push *******************************
+ */
+
+bool
+IterationInfoWriter::Push( RecordType & record )
+{
+  if( !this->IsStarted() )
+  {
+    ++this->m_NumberOfDroppedRecords;
+    return false;
+  }
+
+  /** The acquire on m_Tail makes sure the consumer is done with the slot. */
+  const std::size_t head = this->m_Head.load( std::memory_order_relaxed );
+  const std::size_t tail = this->m_Tail.load( std::memory_order_acquire );
+  if( head - tail >= this->m_Slots.size() )
+  {
+    ++this->m_NumberOfDroppedRecords;
+    return false;
+  }
+
+  this->m_Slots[ head & this->m_Mask ].swap( record );
+  this->m_Head.store( head + 1, std::memory_order_release );
+
+  /** Notifying without holding the mutex may be missed by the consumer;
+   * it then wakes up by its timeout. */
+  this->m_WakeCondition.notify_one();
+  return true;
+
+} // end Push()
+
+
+/**
+ * ************************* Close ******************************
+ */
+
+std::size_t
+IterationInfoWriter::Close( void )
+{
+  if( this->IsStarted() )
+  {
+    this->m_Stop.store( true, std::memory_order_release );
+    this->m_WakeCondition.notify_one();
+    this->m_Thread.join();
+  }
+
+  if( this->m_JSONLFile.is_open() )
+  {
+    this->m_JSONLFile.close();
+  }
+  if( this->m_BinaryFile.is_open() )
+  {
+    this->m_BinaryFile.close();
+  }
+  this->m_IsOpen = false;
+
+  return this->m_NumberOfDroppedRecords;
+
+} // end Close()
+
+
+/**
+ * ************************ IsOpen ******************************
+ */
+
+bool
+IterationInfoWriter::IsOpen( void ) const
+{
+  return this->m_IsOpen;
+
+} // end IsOpen()
+
+
+/**
+ * *********************** IsStarted ****************************
+ */
+
+bool
+IterationInfoWriter::IsStarted( void ) const
+{
+  return this->m_Thread.joinable();
+
+} // end IsStarted()
+
+
+/**
+ * ********************* ThreadedWrite **************************
+ */
+
+void
+IterationInfoWriter::ThreadedWrite( void )
+{
+  std::size_t tail = this->m_Tail.load( std::memory_order_relaxed );
+  while( true )
+  {
+    const std::size_t head = this->m_Head.load( std::memory_order_acquire );
+    if( head == tail )
+    {
+      /** The producer pushes before it stops, so after seeing m_Stop all
+       * records are visible. */
+      if( this->m_Stop.load( std::memory_order_acquire ) )
+      {
+        if( this->m_Head.load( std::memory_order_acquire ) == tail )
+        {
+          break;
+        }
+        continue;
+      }
+
+      std::unique_lock< std::mutex > lock( this->m_WakeMutex );
+      this->m_WakeCondition.wait_for( lock, std::chrono::milliseconds( 10 ) );
+      continue;
+    }
+
+    /** Write the available records and release their slots one by one. */
+    for( ; tail != head; ++tail )
+    {
+      this->WriteRecord( this->m_Slots[ tail & this->m_Mask ] );
+      this->m_Tail.store( tail + 1, std::memory_order_release );
+    }
+
+    /** Keep the files readable while the registration runs. */
+    if( this->m_JSONLFile.is_open() )
+    {
+      this->m_JSONLFile.flush();
+    }
+    if( this->m_BinaryFile.is_open() )
+    {
+      this->m_BinaryFile.flush();
+    }
+  }
+
+} // end ThreadedWrite()
+
+
+/**
+ * ********************** WriteRecord ***************************
+ */
+
+void
+IterationInfoWriter::WriteRecord( const RecordType & record )
+{
+  /** Both formats write exactly one field per column of the header.
+   * Fields of columns added after Start() are skipped, and missing
+   * fields are written as empty. */
+  if( this->m_JSONLFile.is_open() )
+  {
+    this->WriteJSONLRecord( record );
+  }
+  if( this->m_BinaryFile.is_open() )
+  {
+    this->WriteBinaryRecord( record );
+  }
+
+} // end WriteRecord()
+
+
+/**
+ * ******************* WriteJSONLRecord *************************
+ */
+
+void
+IterationInfoWriter::WriteJSONLRecord( const RecordType & record )
+{
+  std::string & line = this->m_LineBuffer;
+  line.clear();
+  line += '{';
+
+  const std::size_t numberOfColumns = this->m_ColumnNames.size();
+  for( std::size_t i = 0; i < numberOfColumns; ++i )
+  {
+    if( i > 0 )
+    {
+      line += ',';
+    }
+
+    AppendJSONString( line, this->m_ColumnNames[ i ] );
+    line += ':';
+
+    const FieldType & field = GetField( record, i );
+    if( field.m_Type == FieldType::TextValue )
+    {
+      AppendJSONString( line, field.m_Text );
+    }
+    else if( field.m_Type == FieldType::NumberValue && std::isfinite( field.m_Number ) )
+    {
+      char number[ 32 ];
+      std::snprintf( number, sizeof( number ), "%.17g", field.m_Number );
+      line += number;
+    }
+    else
+    {
+      /** JSON has no NaN or infinity. */
+      line += "null";
+    }
+  }
+
+  line += "}\n";
+  this->m_JSONLFile.write( line.data(), line.size() );
+
+} // end WriteJSONLRecord()
+
+
+/**
+ * ******************* WriteBinaryRecord ************************
+ */
+
+void
+IterationInfoWriter::WriteBinaryRecord( const RecordType & record )
+{
+  const std::uint32_t numberOfFields = static_cast< std::uint32_t >( this->m_ColumnNames.size() );
+  this->m_BinaryFile.write( reinterpret_cast< const char * >( &numberOfFields ), sizeof( numberOfFields ) );
+
+  for( std::size_t i = 0; i < numberOfFields; ++i )
+  {
+    const FieldType & field = GetField( record, i );
+    const char        type  = static_cast< char >( field.m_Type );
+    this->m_BinaryFile.put( type );
+    if( field.m_Type == FieldType::NumberValue )
+    {
+      this->m_BinaryFile.write( reinterpret_cast< const char * >( &field.m_Number ), sizeof( double ) );
+    }
+    else if( field.m_Type == FieldType::TextValue )
+    {
+      this->WriteBinaryString( field.m_Text );
+    }
+  }
+
+} // end WriteBinaryRecord()
+
+
+/**
+ * ******************* WriteBinaryString ************************
+ */
+
+void
+IterationInfoWriter::WriteBinaryString( const std::string & text )
+{
+  const std::uint32_t length = static_cast< std::uint32_t >( text.size() );
+  this->m_BinaryFile.write( reinterpret_cast< const char * >( &length ), sizeof( length ) );
+  this->m_BinaryFile.write( text.data(), text.size() );
+
+} // end WriteBinaryString()
+
+
+} // end namespace elastix
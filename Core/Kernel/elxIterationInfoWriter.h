@@ -0,0 +1,151 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __elxIterationInfoWriter_h
+#define __elxIterationInfoWriter_h
+
+#include "xoutmain.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace elastix
+{
+
+/**
+ * \class IterationInfoWriter
+ * \brief Writes the iteration info table on a background thread.
+ *
+ * The records of the iteration info table (the typed values of the cells
+ * of xout["iteration"]) are handed over to this class with Push(). They
+ * are stored in a lock-free single-producer/single-consumer ring buffer
+ * and serialized by a background thread, so the registration thread never
+ * waits for the file system. When the ring buffer is full, the record is
+ * dropped and counted; it is never blocked on.
+ *
+ * Both formats write one field per column of the header passed to
+ * Start(). Fields of columns that were added later are skipped, and
+ * missing fields are written as empty.
+ *
+ * Two formats are supported, which may be written simultaneously:
+ * \li JSONL: one JSON object per line, with the column names as keys.
+ *   Numbers are written with 17 significant digits; NaN, infinity and
+ *   empty cells are written as null.
+ * \li Binary: the 8 byte magic "ELXITB01", the uint32 0x01020304 (to
+ *   detect the byte order), the uint32 number of columns and for each
+ *   column a uint32 length and the characters of its name. Then each
+ *   record consists of a uint32 number of fields, which always equals
+ *   the number of columns, and per field a
+ *   type byte (0 = empty, 1 = number, 2 = text), followed by a double
+ *   for numbers, or a uint32 length and the characters for text. All
+ *   values are in native byte order.
+ *
+ * \ingroup Kernel
+ */
+
+class IterationInfoWriter
+{
+public:
+
+  /** Typedef's. */
+  typedef IterationInfoWriter                        Self;
+  typedef xl::xoutbase_type::TypedValueType          FieldType;
+  typedef xl::xoutbase_type::TypedValueContainerType RecordType;
+  typedef xl::xoutbase_type::NameContainerType       NameContainerType;
+
+  /** Constructor. The capacity is the number of records in the ring
+   * buffer; it is rounded up to a power of two. */
+  IterationInfoWriter( std::size_t capacity = 1024 );
+
+  /** Destructor; calls Close(). */
+  ~IterationInfoWriter();
+
+  /** Open the output files baseName + ".jsonl" and/or baseName + ".bin".
+   * A previously opened output is closed first. Returns false when a file
+   * could not be opened. */
+  bool Open( const std::string & baseName, bool writeJSONL, bool writeBinary );
+
+  /** Write the column names and start the background thread. Records
+   * are only accepted after Start(). */
+  void Start( const NameContainerType & columnNames );
+
+  /** Hand over a record to the background thread. The record is swapped
+   * with a preallocated slot, so after the call it holds an old record
+   * that can be refilled. Returns false (and counts the record as dropped)
+   * when the ring buffer is full or the writer is not started. Never blocks. */
+  bool Push( RecordType & record );
+
+  /** Write all remaining records, stop the background thread and close
+   * the files. Returns the number of dropped records since Open(). */
+  std::size_t Close( void );
+
+  /** Returns true between Open() and Close(). */
+  bool IsOpen( void ) const;
+
+  /** Returns true between Start() and Close(). */
+  bool IsStarted( void ) const;
+
+private:
+
+  IterationInfoWriter( const Self & ); // purposely not implemented
+  void operator=( const Self & );      // purposely not implemented
+
+  /** The function executed by the background thread. */
+  void ThreadedWrite( void );
+
+  /** Serialize a record to the opened files. */
+  void WriteRecord( const RecordType & record );
+
+  void WriteJSONLRecord( const RecordType & record );
+
+  void WriteBinaryRecord( const RecordType & record );
+
+  void WriteBinaryString( const std::string & text );
+
+  /** The ring buffer. m_Head is written by the producer only, m_Tail by
+   * the consumer only. Both count records and are masked to get a slot. */
+  std::vector< RecordType >  m_Slots;
+  std::size_t                m_Mask;
+  std::atomic< std::size_t > m_Head;
+  std::atomic< std::size_t > m_Tail;
+  std::size_t                m_NumberOfDroppedRecords;
+
+  /** The background thread, which sleeps on the condition variable when
+   * there is nothing to write. The producer only notifies it. */
+  std::thread             m_Thread;
+  std::atomic< bool >     m_Stop;
+  std::mutex              m_WakeMutex;
+  std::condition_variable m_WakeCondition;
+
+  NameContainerType m_ColumnNames;
+  std::ofstream     m_JSONLFile;
+  std::ofstream     m_BinaryFile;
+  bool              m_IsOpen;
+
+  /** Reused by the background thread to format a JSON line. */
+  std::string m_LineBuffer;
+
+};
+
+} // end namespace elastix
+
+#endif // end #ifndef __elxIterationInfoWriter_h
@@ -19,6 +19,7 @@
 
  // First include the header file to be tested:
 #include "elastixlib.h"
+#include "transformixlib.h"
 
 // ITK header files:
 #include <itkImage.h>
@@ -29,6 +30,159 @@
 
 #include <algorithm> // For transform.
 #include <array>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+  using ParameterMapType = std::map<std::string, std::vector<std::string>>;
+  using ITKImageType = itk::Image<float>;
+
+  // A smooth blob, centred at the specified position.
+  ITKImageType::Pointer CreateBlobImage(const double centreX, const double centreY)
+  {
+    const auto image = ITKImageType::New();
+    image->SetRegions(itk::Size<2>{ { 24, 20 } });
+    image->Allocate();
+    for (itk::ImageRegionIterator<ITKImageType> it(image, image->GetBufferedRegion()); !it.IsAtEnd(); ++it)
+    {
+      const auto index = it.GetIndex();
+      const double dx = index[0] - centreX;
+      const double dy = index[1] - centreY;
+      it.Set(static_cast<float>(100.0 * std::exp(-(dx * dx + 2.0 * dy * dy) / 18.0)));
+    }
+    return image;
+  }
+
+
+  // Adds the default parameters to register two blob images, without
+  // overriding the specified ones.
+  void AddDefaultBlobParameters(ParameterMapType& parameters)
+  {
+    const ParameterMapType defaultParameters =
+    {
+      { "FixedImageDimension", { "2" } },
+      { "FixedImagePyramid", { "FixedSmoothingImagePyramid" } },
+      { "FixedInternalImagePixelType", { "float" } },
+      { "ImageSampler", { "Full" } },
+      { "Interpolator", { "LinearInterpolator" } },
+      { "Metric", { "AdvancedMeanSquares" } },
+      { "MovingImageDimension", { "2" } },
+      { "MovingImagePyramid", { "MovingSmoothingImagePyramid" } },
+      { "MovingInternalImagePixelType", { "float" } },
+      { "NumberOfResolutions", { "1" } },
+      { "RandomSeed", { "1234" } },
+      { "Registration", { "MultiResolutionRegistration" } },
+      { "ResampleInterpolator", { "FinalLinearInterpolator" } },
+      { "Resampler", { "DefaultResampler" } },
+      { "Transform", { "EulerTransform" } },
+      { "WriteResultImage", { "false" } },
+    };
+    parameters.insert(defaultParameters.cbegin(), defaultParameters.cend());
+  }
+
+
+  // Registers the specified images, after adding the default parameters, and
+  // returns the final transform parameters as numbers.
+  std::vector<double> RegisterAndGetTransformParameters(ParameterMapType parameters,
+    const itk::DataObject::Pointer& fixedImage, const itk::DataObject::Pointer& movingImage)
+  {
+    AddDefaultBlobParameters(parameters);
+
+    elastix::ELASTIX elastix;
+    EXPECT_EQ(elastix.RegisterImages(fixedImage, movingImage, parameters, ".", false, false), 0);
+
+    std::vector<double> transformParameters;
+    const auto transformParameterMaps = elastix.GetTransformParameterMapList();
+    if (transformParameterMaps.size() == 1)
+    {
+      for (const auto& value : transformParameterMaps.front().at("TransformParameters"))
+      {
+        transformParameters.push_back(std::stod(value));
+      }
+    }
+    return transformParameters;
+  }
+
+
+  // Registers two blob images with the specified optimizer settings, and
+  // returns the final transform parameters.
+  std::vector<std::string> RegisterBlobs(ParameterMapType parameters, const unsigned int numberOfConcurrentEvaluations)
+  {
+    parameters["NumberOfConcurrentEvaluations"] = { std::to_string(numberOfConcurrentEvaluations) };
+    AddDefaultBlobParameters(parameters);
+
+    elastix::ELASTIX elastix;
+    const int error = elastix.RegisterImages(
+      static_cast<itk::DataObject::Pointer>(CreateBlobImage(11.0, 9.0).GetPointer()),
+      static_cast<itk::DataObject::Pointer>(CreateBlobImage(12.5, 8.0).GetPointer()),
+      parameters, ".", false, false);
+    EXPECT_EQ(error, 0);
+
+    const auto transformParameterMaps = elastix.GetTransformParameterMapList();
+    if (transformParameterMaps.size() != 1)
+    {
+      ADD_FAILURE() << "Expected one transform parameter map";
+      return {};
+    }
+    const auto found = transformParameterMaps.front().find("TransformParameters");
+    if (found == transformParameterMaps.front().cend())
+    {
+      ADD_FAILURE() << "No TransformParameters";
+      return {};
+    }
+    return found->second;
+  }
+
+
+  // Reads the tab separated cells of the iteration info file of the first
+  // resolution, written by the last registration with WriteIterationInfo.
+  std::vector<std::vector<std::string>> ReadIterationInfo()
+  {
+    std::ifstream file("./IterationInfo.0.R0.txt");
+    std::vector<std::vector<std::string>> rows;
+    std::string line;
+    while (std::getline(file, line))
+    {
+      std::istringstream stream(line);
+      std::vector<std::string> cells;
+      std::string cell;
+      while (std::getline(stream, cell, '\t'))
+      {
+        cells.push_back(cell);
+      }
+      rows.push_back(cells);
+    }
+    return rows;
+  }
+
+
+  // Returns the index of the NumberOfSamples column of the iteration info,
+  // or the number of columns when there is none.
+  std::size_t FindNumberOfSamplesColumn(const std::vector<std::string>& header)
+  {
+    return std::find(header.cbegin(), header.cend(), "5:NumberOfSamples") - header.cbegin();
+  }
+
+
+  // The Euler transform has non-unit scales by default, so these tests also
+  // check that the scales are applied equally by the concurrent evaluations.
+  void Expect_concurrent_evaluations_do_not_change_the_result(const ParameterMapType& optimizerParameters)
+  {
+    const auto expectedTransformParameters = RegisterBlobs(optimizerParameters, 1);
+    ASSERT_EQ(expectedTransformParameters.size(), 3);
+
+    for (const unsigned int numberOfConcurrentEvaluations : { 2u, 4u })
+    {
+      EXPECT_EQ(RegisterBlobs(optimizerParameters, numberOfConcurrentEvaluations), expectedTransformParameters);
+    }
+  }
+}
 
 
 // Tests registering two small (5x6) binary images, using the example code from
@@ -200,3 +354,306 @@ GTEST_TEST(ElastixLib, ExampleFromManualRunningElastix)
 
   EXPECT_EQ(roundedTranslationOffset, translationOffset);
 }
+
+
+GTEST_TEST(ElastixLib, ConcurrentEvaluationsOfCMAEvolutionStrategy)
+{
+  Expect_concurrent_evaluations_do_not_change_the_result({
+    { "Optimizer", { "CMAEvolutionStrategy" } },
+    { "MaximumNumberOfIterations", { "8" } },
+    { "PopulationSize", { "6" } },
+    { "StepLength", { "0.5" } } });
+}
+
+
+GTEST_TEST(ElastixLib, ConcurrentEvaluationsOfFiniteDifferenceGradientDescent)
+{
+  Expect_concurrent_evaluations_do_not_change_the_result({
+    { "Optimizer", { "FiniteDifferenceGradientDescent" } },
+    { "MaximumNumberOfIterations", { "5" } } });
+}
+
+
+GTEST_TEST(ElastixLib, ConcurrentEvaluationsOfFullSearch)
+{
+  Expect_concurrent_evaluations_do_not_change_the_result({
+    { "Optimizer", { "FullSearch" } },
+    { "FullSearchSpace0", { "translation_x", "1", "-3", "3", "0.5", "translation_y", "2", "-3", "3", "0.5" } } });
+
+  Expect_concurrent_evaluations_do_not_change_the_result({
+    { "Optimizer", { "FullSearch" } },
+    { "FullSearchSpace0", { "translation_x", "1", "-3", "3", "0.25", "translation_y", "2", "-3", "3", "0.25" } },
+    { "NumberOfRefinementLevels", { "2" } } });
+}
+
+
+GTEST_TEST(ElastixLib, ConcurrentEvaluationsOfSimultaneousPerturbation)
+{
+  Expect_concurrent_evaluations_do_not_change_the_result({
+    { "Optimizer", { "SimultaneousPerturbation" } },
+    { "MaximumNumberOfIterations", { "5" } },
+    { "NumberOfPerturbations", { "3" } } });
+}
+
+
+// Tests that the gradients of SimultaneousPerturbation with a single
+// perturbation, of which both positions are evaluated concurrently, equal the
+// sequential gradients, with explicit non-unit scales and new samples every
+// iteration.
+GTEST_TEST(ElastixLib, ConcurrentSimultaneousPerturbationGradientsEqualSequentialGradientsWithScales)
+{
+  const ParameterMapType optimizerParameters =
+  {
+    { "Optimizer", { "SimultaneousPerturbation" } },
+    { "MaximumNumberOfIterations", { "6" } },
+    { "NumberOfPerturbations", { "1" } },
+    { "Scales", { "5000", "2", "0.5" } },
+    { "ImageSampler", { "RandomCoordinate" } },
+    { "NumberOfSpatialSamples", { "200" } },
+    { "NewSamplesEveryIteration", { "true" } },
+    { "WriteIterationInfo", { "true" } },
+  };
+
+  // Reads the gradient magnitude of every iteration.
+  const auto readGradientMagnitudes = []
+  {
+    const auto rows = ReadIterationInfo();
+    std::vector<std::string> gradientMagnitudes;
+    if (rows.empty())
+    {
+      ADD_FAILURE() << "No iteration info";
+      return gradientMagnitudes;
+    }
+    const auto& header = rows.front();
+    const std::size_t column = std::find(header.cbegin(), header.cend(), "4:||Gradient||") - header.cbegin();
+    EXPECT_LT(column, header.size());
+    for (std::size_t i = 1; i < rows.size(); ++i)
+    {
+      gradientMagnitudes.push_back(column < rows[i].size() ? rows[i][column] : std::string());
+    }
+    return gradientMagnitudes;
+  };
+
+  const auto expectedTransformParameters = RegisterBlobs(optimizerParameters, 1);
+  ASSERT_EQ(expectedTransformParameters.size(), 3);
+  const auto expectedGradientMagnitudes = readGradientMagnitudes();
+  ASSERT_EQ(expectedGradientMagnitudes.size(), 6);
+
+  for (const unsigned int numberOfConcurrentEvaluations : { 2u, 3u })
+  {
+    EXPECT_EQ(RegisterBlobs(optimizerParameters, numberOfConcurrentEvaluations), expectedTransformParameters);
+    EXPECT_EQ(readGradientMagnitudes(), expectedGradientMagnitudes);
+  }
+}
+
+
+// Tests that resampling with a transform chain that is composed into a
+// displacement field gives the same result image as the chain itself.
+GTEST_TEST(ElastixLib, ComposedTransformChainResamplesLikeTheChain)
+{
+  std::vector<ParameterMapType> parameterMaps(2);
+  parameterMaps[0] = { { "Transform", { "TranslationTransform" } } };
+  parameterMaps[1] = { { "Transform", { "AffineTransform" } } };
+  for (auto& parameters : parameterMaps)
+  {
+    parameters["Optimizer"] = { "RegularStepGradientDescent" };
+    parameters["MaximumNumberOfIterations"] = { "10" };
+    AddDefaultBlobParameters(parameters);
+  }
+
+  elastix::ELASTIX elastix;
+  ASSERT_EQ(elastix.RegisterImages(
+    static_cast<itk::DataObject::Pointer>(CreateBlobImage(11.0, 9.0).GetPointer()),
+    static_cast<itk::DataObject::Pointer>(CreateBlobImage(12.5, 8.0).GetPointer()),
+    parameterMaps, ".", false, false), 0);
+  auto transformParameterMaps = elastix.GetTransformParameterMapList();
+  ASSERT_EQ(transformParameterMaps.size(), 2u);
+  for (auto& transformParameters : transformParameterMaps)
+  {
+    transformParameters["ResultImagePixelType"] = { "float" };
+  }
+
+  // The chain of a translation and an affine transform is affine, so a
+  // linearly interpolated displacement field represents it exactly, also
+  // when the field is subsampled.
+  const auto transformImage = [&transformParameterMaps](const std::string& composeTransformChain)
+  {
+    transformParameterMaps.back()["ComposeTransformChain"] = { composeTransformChain };
+    transformParameterMaps.back()["ComposedDisplacementFieldSubsamplingFactor"] = { "3" };
+    transformix::TRANSFORMIX transformix;
+    EXPECT_EQ(transformix.TransformImage(
+      static_cast<itk::DataObject::Pointer>(CreateBlobImage(12.5, 8.0).GetPointer()),
+      transformParameterMaps, ".", false, false), 0);
+    return ITKImageType::Pointer(dynamic_cast<ITKImageType*>(transformix.GetResultImage().GetPointer()));
+  };
+
+  const auto expectedImage = transformImage("false");
+  const auto composedImage = transformImage("true");
+  ASSERT_NE(expectedImage, nullptr);
+  ASSERT_NE(composedImage, nullptr);
+  ASSERT_EQ(composedImage->GetBufferedRegion(), expectedImage->GetBufferedRegion());
+
+  itk::ImageRegionConstIterator<ITKImageType> expectedIt(expectedImage, expectedImage->GetBufferedRegion());
+  itk::ImageRegionConstIterator<ITKImageType> composedIt(composedImage, composedImage->GetBufferedRegion());
+  for (; !expectedIt.IsAtEnd(); ++expectedIt, ++composedIt)
+  {
+    EXPECT_NEAR(composedIt.Get(), expectedIt.Get(), 1e-3) << "at index " << expectedIt.GetIndex();
+  }
+}
+
+
+// Tests that the groupwise metrics, which evaluate their samples grouped by
+// the sub-transform of the stack transform, give the same registration
+// result single-threaded and multi-threaded.
+GTEST_TEST(ElastixLib, GroupwiseMetricsAreIndependentOfMultiThreading)
+{
+  using StackImageType = itk::Image<float, 3>;
+
+  // A stack of five blobs, moving along the slices.
+  const auto image = StackImageType::New();
+  image->SetRegions(itk::Size<3>{ { 16, 14, 5 } });
+  image->Allocate();
+  for (itk::ImageRegionIterator<StackImageType> it(image, image->GetBufferedRegion()); !it.IsAtEnd(); ++it)
+  {
+    const auto index = it.GetIndex();
+    const double dx = index[0] - 7.0 - 0.3 * index[2];
+    const double dy = index[1] - 6.0 + 0.2 * index[2];
+    it.Set(static_cast<float>(100.0 * std::exp(-(dx * dx + 2.0 * dy * dy) / 12.0)));
+  }
+
+  const auto registerStack = [&image](const std::string& metric, const std::string& useMultiThreading)
+  {
+    ParameterMapType parameters =
+    {
+      { "FixedImageDimension", { "3" } },
+      { "MovingImageDimension", { "3" } },
+      { "FixedImagePyramid", { "FixedSmoothingImagePyramid" } },
+      { "MovingImagePyramid", { "MovingSmoothingImagePyramid" } },
+      { "ImagePyramidSchedule", { "0", "0", "0" } },
+      { "Metric", { metric } },
+      { "Transform", { "BSplineStackTransform" } },
+      { "FinalGridSpacingInVoxels", { "6", "6", "1" } },
+      { "Optimizer", { "RegularStepGradientDescent" } },
+      { "MaximumNumberOfIterations", { "3" } },
+      { "UseMultiThreadingForMetrics", { useMultiThreading } },
+      { "SampleLastDimensionRandomly", { "false" } },
+      { "SubtractMean", { "true" } },
+    };
+    return RegisterAndGetTransformParameters(parameters,
+      static_cast<itk::DataObject::Pointer>(image.GetPointer()),
+      static_cast<itk::DataObject::Pointer>(image.GetPointer()));
+  };
+
+  for (const std::string metric : { "VarianceOverLastDimensionMetric", "PCAMetric", "PCAMetric2" })
+  {
+    const auto expectedTransformParameters = registerStack(metric, "false");
+    const auto transformParameters = registerStack(metric, "true");
+    ASSERT_FALSE(expectedTransformParameters.empty()) << metric;
+    ASSERT_EQ(transformParameters.size(), expectedTransformParameters.size()) << metric;
+
+    // Only the order of the summations differs.
+    for (std::size_t i = 0; i < transformParameters.size(); ++i)
+    {
+      EXPECT_NEAR(transformParameters[i], expectedTransformParameters[i], 1e-4) << metric << " parameter " << i;
+    }
+  }
+}
+
+
+// Tests that AdvancedMattesMutualInformation gives the same registration
+// result with sparse pdf derivatives as with the low memory ones, for a
+// multi-threaded B-spline registration.
+GTEST_TEST(ElastixLib, MattesSparsePDFDerivativesRegisterLikeLowMemoryDerivatives)
+{
+  const auto registerBlobs = [](const std::string& useSparsePDFDerivatives)
+  {
+    ParameterMapType parameters =
+    {
+      { "Metric", { "AdvancedMattesMutualInformation" } },
+      { "NumberOfHistogramBins", { "16" } },
+      { "UseFastAndLowMemoryVersion", { "true" } },
+      { "UseSparsePDFDerivatives", { useSparsePDFDerivatives } },
+      { "UseMultiThreadingForMetrics", { "true" } },
+      { "Transform", { "BSplineTransform" } },
+      { "FinalGridSpacingInVoxels", { "8" } },
+      { "Optimizer", { "RegularStepGradientDescent" } },
+      { "MaximumNumberOfIterations", { "5" } },
+    };
+    return RegisterAndGetTransformParameters(parameters,
+      static_cast<itk::DataObject::Pointer>(CreateBlobImage(11.0, 9.0).GetPointer()),
+      static_cast<itk::DataObject::Pointer>(CreateBlobImage(12.5, 8.0).GetPointer()));
+  };
+
+  const auto expectedTransformParameters = registerBlobs("false");
+  const auto transformParameters = registerBlobs("true");
+  ASSERT_FALSE(expectedTransformParameters.empty());
+  ASSERT_EQ(transformParameters.size(), expectedTransformParameters.size());
+  for (std::size_t i = 0; i < transformParameters.size(); ++i)
+  {
+    EXPECT_NEAR(transformParameters[i], expectedTransformParameters[i], 1e-6) << "parameter " << i;
+  }
+}
+
+
+// Tests that UpdateNumberOfSamples() adapts the number of samples of the
+// random sampler within the specified bounds, and writes it to the
+// iteration info.
+GTEST_TEST(ElastixLib, AdaptiveNumberOfSamplesStaysWithinItsBounds)
+{
+  const unsigned int numberOfSpatialSamples = 200;
+  RegisterBlobs({
+    { "Optimizer", { "AdaptiveStochasticGradientDescent" } },
+    { "MaximumNumberOfIterations", { "30" } },
+    { "ImageSampler", { "RandomCoordinate" } },
+    { "NumberOfSpatialSamples", { std::to_string(numberOfSpatialSamples) } },
+    { "NewSamplesEveryIteration", { "true" } },
+    { "AdaptiveNumberOfSamples", { "true" } },
+    { "MinimumNumberOfSamplesFactor", { "0.5" } },
+    { "MaximumNumberOfSamplesFactor", { "2.0" } },
+    { "WriteIterationInfo", { "true" } } }, 1);
+
+  const auto rows = ReadIterationInfo();
+  ASSERT_EQ(rows.size(), 31u);
+  const std::size_t column = FindNumberOfSamplesColumn(rows.front());
+  ASSERT_LT(column, rows.front().size());
+
+  for (std::size_t i = 1; i < rows.size(); ++i)
+  {
+    ASSERT_LT(column, rows[i].size()) << "at iteration " << i - 1;
+    const unsigned long numberOfSamples = std::stoul(rows[i][column]);
+    EXPECT_GE(numberOfSamples, numberOfSpatialSamples / 2) << "at iteration " << i - 1;
+    EXPECT_LE(numberOfSamples, 2 * numberOfSpatialSamples) << "at iteration " << i - 1;
+  }
+}
+
+
+// Tests that the iteration info only has a NumberOfSamples column when the
+// optimizer adapts the number of samples.
+GTEST_TEST(ElastixLib, NumberOfSamplesIsOnlyWrittenByOptimizersWithNoiseEstimates)
+{
+  const ParameterMapType parameters =
+  {
+    { "MaximumNumberOfIterations", { "5" } },
+    { "ImageSampler", { "RandomCoordinate" } },
+    { "NumberOfSpatialSamples", { "200" } },
+    { "NewSamplesEveryIteration", { "true" } },
+    { "WriteIterationInfo", { "true" } },
+  };
+
+  // Without noise estimates, AdaptiveNumberOfSamples is turned off.
+  auto optimizerParameters = parameters;
+  optimizerParameters["Optimizer"] = { "RegularStepGradientDescent" };
+  optimizerParameters["AdaptiveNumberOfSamples"] = { "true" };
+  EXPECT_EQ(RegisterBlobs(optimizerParameters, 1).size(), 3u);
+  auto rows = ReadIterationInfo();
+  ASSERT_FALSE(rows.empty());
+  EXPECT_EQ(FindNumberOfSamplesColumn(rows.front()), rows.front().size());
+
+  // Nor is it written when the number of samples is not adapted.
+  optimizerParameters = parameters;
+  optimizerParameters["Optimizer"] = { "AdaptiveStochasticGradientDescent" };
+  EXPECT_EQ(RegisterBlobs(optimizerParameters, 1).size(), 3u);
+  rows = ReadIterationInfo();
+  ASSERT_EQ(rows.size(), 6u);
+  EXPECT_EQ(FindNumberOfSamplesColumn(rows.front()), rows.front().size());
+}
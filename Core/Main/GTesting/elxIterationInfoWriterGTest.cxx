@@ -0,0 +1,321 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+ // First include the header file to be tested:
+#include "elxIterationInfoWriter.h"
+
+#include "xoutmain.h"
+
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+  using WriterType = elastix::IterationInfoWriter;
+  using FieldType = WriterType::FieldType;
+  using RecordType = WriterType::RecordType;
+  using NameContainerType = WriterType::NameContainerType;
+
+
+  FieldType NumberField(const double number)
+  {
+    FieldType field;
+    field.m_Type = FieldType::NumberValue;
+    field.m_Number = number;
+    return field;
+  }
+
+
+  FieldType TextField(const std::string& text)
+  {
+    FieldType field;
+    field.m_Type = FieldType::TextValue;
+    field.m_Text = text;
+    return field;
+  }
+
+
+  std::vector<std::string> ReadLines(const std::string& fileName)
+  {
+    std::ifstream file(fileName);
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(file, line))
+    {
+      lines.push_back(line);
+    }
+    return lines;
+  }
+
+
+  // The contents of a binary iteration info file.
+  struct BinaryFileContents
+  {
+    NameContainerType m_ColumnNames;
+    std::vector<RecordType> m_Records;
+  };
+
+
+  template <typename T>
+  T ReadBinary(std::istream& stream)
+  {
+    T value{};
+    stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+    return value;
+  }
+
+
+  std::string ReadBinaryString(std::istream& stream)
+  {
+    std::string text(ReadBinary<std::uint32_t>(stream), '\0');
+    stream.read(&text[0], text.size());
+    return text;
+  }
+
+
+  BinaryFileContents ReadBinaryFile(const std::string& fileName)
+  {
+    std::ifstream file(fileName, std::ios::binary);
+    BinaryFileContents contents;
+
+    std::string magic(8, '\0');
+    file.read(&magic[0], 8);
+    EXPECT_EQ(magic, "ELXITB01");
+    EXPECT_EQ(ReadBinary<std::uint32_t>(file), 0x01020304u);
+
+    const auto numberOfColumns = ReadBinary<std::uint32_t>(file);
+    for (std::uint32_t i = 0; i < numberOfColumns; ++i)
+    {
+      contents.m_ColumnNames.push_back(ReadBinaryString(file));
+    }
+
+    while (file.peek() != std::char_traits<char>::eof())
+    {
+      RecordType record(ReadBinary<std::uint32_t>(file));
+      for (auto& field : record)
+      {
+        field.m_Type = static_cast<unsigned char>(file.get());
+        if (field.m_Type == FieldType::NumberValue)
+        {
+          field.m_Number = ReadBinary<double>(file);
+        }
+        else if (field.m_Type == FieldType::TextValue)
+        {
+          field.m_Text = ReadBinaryString(file);
+        }
+      }
+      EXPECT_TRUE(file.good());
+      contents.m_Records.push_back(record);
+    }
+    return contents;
+  }
+}
+
+
+GTEST_TEST(IterationInfoWriter, WritesJSONLAndBinary)
+{
+  const std::string baseName = "IterationInfoWriterGTest.WritesJSONLAndBinary";
+  const NameContainerType columnNames{ "1:ItNr", "2:Metric", "3:Text \"quoted\"" };
+
+  WriterType writer;
+  ASSERT_TRUE(writer.Open(baseName, true, true));
+  EXPECT_TRUE(writer.IsOpen());
+  EXPECT_FALSE(writer.IsStarted());
+  writer.Start(columnNames);
+  EXPECT_TRUE(writer.IsStarted());
+
+  RecordType record{ NumberField(0), NumberField(0.125), TextField("a\tb") };
+  EXPECT_TRUE(writer.Push(record));
+  record = { NumberField(1), NumberField(std::numeric_limits<double>::quiet_NaN()), FieldType() };
+  EXPECT_TRUE(writer.Push(record));
+  EXPECT_EQ(writer.Close(), 0u);
+  EXPECT_FALSE(writer.IsOpen());
+  EXPECT_FALSE(writer.IsStarted());
+
+  const auto lines = ReadLines(baseName + ".jsonl");
+  ASSERT_EQ(lines.size(), 2u);
+  EXPECT_EQ(lines[0], R"({"1:ItNr":0,"2:Metric":0.125,"3:Text \"quoted\"":"a\u0009b"})");
+  EXPECT_EQ(lines[1], R"({"1:ItNr":1,"2:Metric":null,"3:Text \"quoted\"":null})");
+
+  const auto contents = ReadBinaryFile(baseName + ".bin");
+  EXPECT_EQ(contents.m_ColumnNames, columnNames);
+  ASSERT_EQ(contents.m_Records.size(), 2u);
+  const auto& first = contents.m_Records[0];
+  ASSERT_EQ(first.size(), 3u);
+  EXPECT_EQ(first[0].m_Type, FieldType::NumberValue);
+  EXPECT_EQ(first[0].m_Number, 0.0);
+  EXPECT_EQ(first[1].m_Number, 0.125);
+  EXPECT_EQ(first[2].m_Type, FieldType::TextValue);
+  EXPECT_EQ(first[2].m_Text, "a\tb");
+  const auto& second = contents.m_Records[1];
+  ASSERT_EQ(second.size(), 3u);
+  EXPECT_EQ(second[1].m_Type, FieldType::NumberValue);
+  EXPECT_NE(second[1].m_Number, second[1].m_Number);
+  EXPECT_EQ(second[2].m_Type, FieldType::EmptyValue);
+}
+
+
+GTEST_TEST(IterationInfoWriter, BothFormatsWriteOneFieldPerColumn)
+{
+  const std::string baseName = "IterationInfoWriterGTest.BothFormatsWriteOneFieldPerColumn";
+
+  WriterType writer;
+  ASSERT_TRUE(writer.Open(baseName, true, true));
+  writer.Start({ "1:ItNr", "2:Metric" });
+
+  // A record with a field of a column that was added after Start(), and
+  // one that misses a field.
+  RecordType record{ NumberField(0), NumberField(1.5), NumberField(2.5) };
+  EXPECT_TRUE(writer.Push(record));
+  record = { NumberField(1) };
+  EXPECT_TRUE(writer.Push(record));
+  writer.Close();
+
+  const auto lines = ReadLines(baseName + ".jsonl");
+  ASSERT_EQ(lines.size(), 2u);
+  EXPECT_EQ(lines[0], R"({"1:ItNr":0,"2:Metric":1.5})");
+  EXPECT_EQ(lines[1], R"({"1:ItNr":1,"2:Metric":null})");
+
+  const auto contents = ReadBinaryFile(baseName + ".bin");
+  ASSERT_EQ(contents.m_Records.size(), 2u);
+  for (const auto& binaryRecord : contents.m_Records)
+  {
+    EXPECT_EQ(binaryRecord.size(), contents.m_ColumnNames.size());
+  }
+  EXPECT_EQ(contents.m_Records[0][1].m_Number, 1.5);
+  EXPECT_EQ(contents.m_Records[1][1].m_Type, FieldType::EmptyValue);
+}
+
+
+GTEST_TEST(IterationInfoWriter, RecordsAreWrittenInOrderOrCountedAsDropped)
+{
+  const std::string baseName = "IterationInfoWriterGTest.RecordsAreWrittenInOrderOrCountedAsDropped";
+  const unsigned int numberOfRecords = 20000;
+
+  // A small ring buffer, so that records may be dropped.
+  WriterType writer(8);
+
+  // Records pushed before Start() are dropped.
+  ASSERT_TRUE(writer.Open(baseName, true, false));
+  RecordType record{ NumberField(-1) };
+  EXPECT_FALSE(writer.Push(record));
+
+  writer.Start({ "1:ItNr" });
+  unsigned int numberOfPushedRecords = 0;
+  for (unsigned int i = 0; i < numberOfRecords; ++i)
+  {
+    // Push() swaps the record with an old one, so it is refilled.
+    record.assign(1, NumberField(i));
+    numberOfPushedRecords += writer.Push(record) ? 1 : 0;
+  }
+  const std::size_t numberOfDroppedRecords = writer.Close();
+  EXPECT_EQ(numberOfDroppedRecords, 1 + numberOfRecords - numberOfPushedRecords);
+
+  // The accepted records are all written, in the order of pushing.
+  const auto lines = ReadLines(baseName + ".jsonl");
+  ASSERT_EQ(lines.size(), numberOfPushedRecords);
+  double previous = -1.0;
+  for (const auto& line : lines)
+  {
+    std::istringstream stream(line.substr(std::string(R"({"1:ItNr":)").size()));
+    double current = 0.0;
+    stream >> current;
+    EXPECT_GT(current, previous);
+    previous = current;
+  }
+}
+
+
+GTEST_TEST(xoutrow, CapturesTypedValuesPerCell)
+{
+  std::ostringstream output;
+  xl::xoutrow_type row;
+  row.AddOutput("output", &output);
+  row.AddTargetCell("1:ItNr");
+  row.AddTargetCell("2:Metric");
+  row.AddTargetCell("3:Text");
+  row.SetCaptureTypedValues(true);
+  row.SetFormatText(false);
+
+  // Cells that are added later get the same modes.
+  row.AddTargetCell("4:Empty");
+
+  // Manipulators are ignored, a second value turns a cell into text.
+  row["1:ItNr"] << 7u;
+  row["2:Metric"] << std::setprecision(3) << 0.1;
+  row["3:Text"] << 0.5 << "s";
+
+  NameContainerType names;
+  row.GetTargetCellNames(names);
+  EXPECT_EQ(names, NameContainerType({ "1:ItNr", "2:Metric", "3:Text", "4:Empty" }));
+
+  RecordType values;
+  row.GetTypedValues(values);
+  ASSERT_EQ(values.size(), 4u);
+  EXPECT_EQ(values[0].m_Type, FieldType::NumberValue);
+  EXPECT_EQ(values[0].m_Number, 7.0);
+  EXPECT_EQ(values[1].m_Type, FieldType::NumberValue);
+  EXPECT_EQ(values[1].m_Number, 0.1);
+  EXPECT_EQ(values[2].m_Type, FieldType::TextValue);
+  EXPECT_EQ(values[2].m_Text, "0.5s");
+  EXPECT_EQ(values[3].m_Type, FieldType::EmptyValue);
+
+  // Without text formatting nothing reaches the outputs, and the values
+  // are taken out of the cells.
+  row.WriteBufferedData();
+  EXPECT_EQ(output.str().find_first_not_of("\t\n"), std::string::npos);
+  row.GetTypedValues(values);
+  for (const auto& value : values)
+  {
+    EXPECT_EQ(value.m_Type, FieldType::EmptyValue);
+  }
+}
+
+
+GTEST_TEST(xoutrow, FormatsTextAndCapturesCharactersAsText)
+{
+  std::ostringstream output;
+  xl::xoutrow_type row;
+  row.AddOutput("output", &output);
+  row.AddTargetCell("1:a");
+  row.AddTargetCell("2:b");
+  row.SetCaptureTypedValues(true);
+
+  row["1:a"] << 2.5;
+  row["2:b"] << 'x';
+
+  RecordType values;
+  row.GetTypedValues(values);
+  ASSERT_EQ(values.size(), 2u);
+  EXPECT_EQ(values[0].m_Type, FieldType::NumberValue);
+  EXPECT_EQ(values[0].m_Number, 2.5);
+  EXPECT_EQ(values[1].m_Type, FieldType::TextValue);
+  EXPECT_EQ(values[1].m_Text, "x");
+
+  // The text is still written to the outputs.
+  row.WriteBufferedData();
+  EXPECT_EQ(output.str(), "2.5\tx\n");
+}
@@ -0,0 +1,175 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+ // First include the header file to be tested:
+#include "FullSearch/itkFullSearchOptimizer.h"
+
+#include <cmath>
+#include <cstdlib>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+  using OptimizerType = itk::FullSearchOptimizer;
+  using ParametersType = OptimizerType::ParametersType;
+  using IndexType = OptimizerType::SearchSpaceIndexType;
+
+  // A quadratic with its minimum at (1.3, -0.7), closest to the grid
+  // point (1.25, -0.75) of the search space below.
+  class QuadraticCostFunction : public itk::SingleValuedCostFunction
+  {
+  public:
+    using Self = QuadraticCostFunction;
+    using Pointer = itk::SmartPointer<Self>;
+
+    itkNewMacro(Self);
+
+    MeasureType GetValue(const ParametersType& parameters) const override
+    {
+      return (parameters[0] - 1.3) * (parameters[0] - 1.3) + 2.0 * (parameters[1] + 0.7) * (parameters[1] + 0.7);
+    }
+
+    void GetDerivative(const ParametersType&, DerivativeType&) const override
+    {
+      itkExceptionMacro("Not implemented");
+    }
+
+    unsigned int GetNumberOfParameters() const override
+    {
+      return 3;
+    }
+  };
+
+
+  // Creates an optimizer over [-4, 4] x [-4, 4] with step 0.25 (33 x 33 points).
+  OptimizerType::Pointer CreateOptimizer(const unsigned int numberOfContexts,
+    const unsigned int numberOfRefinementLevels)
+  {
+    const auto optimizer = OptimizerType::New();
+    optimizer->SetCostFunction(QuadraticCostFunction::New());
+    optimizer->SetInitialPosition(ParametersType(3, 0.0));
+    optimizer->AddSearchDimension(0, -4.0, 4.0, 0.25);
+    optimizer->AddSearchDimension(1, -4.0, 4.0, 0.25);
+    optimizer->SetNumberOfRefinementLevels(numberOfRefinementLevels);
+    optimizer->SetNumberOfRefinementCandidates(1);
+    optimizer->SetBatchSize(10);
+    for (unsigned int i = 0; i < numberOfContexts; ++i)
+    {
+      optimizer->AddCostFunctionContext(QuadraticCostFunction::New());
+    }
+    return optimizer;
+  }
+
+
+  void Expect_equal_search_results(OptimizerType& optimizer1, OptimizerType& optimizer2)
+  {
+    const auto& values1 = optimizer1.GetSearchSpaceValues();
+    const auto& values2 = optimizer2.GetSearchSpaceValues();
+    ASSERT_EQ(values1.size(), values2.size());
+    for (std::size_t i = 0; i < values1.size(); ++i)
+    {
+      EXPECT_EQ(std::isnan(values1[i]), std::isnan(values2[i]));
+      if (!std::isnan(values1[i]))
+      {
+        EXPECT_EQ(values1[i], values2[i]);
+      }
+    }
+    EXPECT_EQ(optimizer1.GetBestIndexInSearchSpace(), optimizer2.GetBestIndexInSearchSpace());
+    EXPECT_EQ(optimizer1.GetBestValue(), optimizer2.GetBestValue());
+    EXPECT_EQ(optimizer1.GetCurrentIteration(), optimizer2.GetCurrentIteration());
+    EXPECT_EQ(optimizer1.GetCurrentPosition(), optimizer2.GetCurrentPosition());
+  }
+}
+
+
+GTEST_TEST(FullSearchOptimizer, ConcurrentSearchEqualsSequentialSearch)
+{
+  const auto sequentialOptimizer = CreateOptimizer(0, 0);
+  sequentialOptimizer->StartOptimization();
+  EXPECT_EQ(sequentialOptimizer->GetStopCondition(), OptimizerType::FullRangeSearched);
+  EXPECT_EQ(sequentialOptimizer->GetCurrentIteration(), 33u * 33u);
+
+  const auto concurrentOptimizer = CreateOptimizer(3, 0);
+  concurrentOptimizer->StartOptimization();
+  EXPECT_EQ(concurrentOptimizer->GetStopCondition(), OptimizerType::FullRangeSearched);
+  EXPECT_EQ(concurrentOptimizer->GetCurrentIteration(), 33u * 33u);
+  EXPECT_EQ(concurrentOptimizer->GetSearchSpaceValues(), sequentialOptimizer->GetSearchSpaceValues());
+  EXPECT_EQ(concurrentOptimizer->GetBestIndexInSearchSpace(), sequentialOptimizer->GetBestIndexInSearchSpace());
+  EXPECT_EQ(concurrentOptimizer->GetCurrentPosition(), sequentialOptimizer->GetCurrentPosition());
+}
+
+
+GTEST_TEST(FullSearchOptimizer, ComputePendingPointsRefinesAroundTheBestPoint)
+{
+  const auto optimizer = CreateOptimizer(0, 2);
+  optimizer->StartOptimization();
+
+  // The minimum of the full grid is found.
+  const auto& bestIndex = optimizer->GetBestIndexInSearchSpace();
+  ASSERT_EQ(bestIndex.GetSize(), 2u);
+  EXPECT_EQ(bestIndex[0], 21);
+  EXPECT_EQ(bestIndex[1], 13);
+
+  const auto& position = optimizer->GetCurrentPosition();
+  EXPECT_EQ(position[0], 1.25);
+  EXPECT_EQ(position[1], -0.75);
+  EXPECT_EQ(position[2], 0.0);
+
+  // The coarsest level covers the whole grid with a stride of 4. The finer
+  // levels only visit points within two strides of the best point so far,
+  // which stay close to the final best point.
+  const auto& values = optimizer->GetSearchSpaceValues();
+  ASSERT_EQ(values.size(), 33u * 33u);
+  std::size_t numberOfEvaluatedPoints = 0;
+  for (unsigned long i = 0; i < values.size(); ++i)
+  {
+    const IndexType index = optimizer->LinearIndexToIndex(i);
+    const bool isCoarsePoint = (index[0] % 4 == 0) && (index[1] % 4 == 0);
+    if (isCoarsePoint)
+    {
+      EXPECT_FALSE(std::isnan(values[i])) << "Coarse grid point " << i << " is not evaluated";
+    }
+    if (!std::isnan(values[i]))
+    {
+      ++numberOfEvaluatedPoints;
+      if (!isCoarsePoint)
+      {
+        EXPECT_LE(std::abs(index[0] - bestIndex[0]), 8);
+        EXPECT_LE(std::abs(index[1] - bestIndex[1]), 8);
+      }
+    }
+  }
+  EXPECT_LT(numberOfEvaluatedPoints, values.size() / 2);
+  EXPECT_EQ(optimizer->GetCurrentIteration(), numberOfEvaluatedPoints);
+}
+
+
+GTEST_TEST(FullSearchOptimizer, ConcurrentCoarseToFineSearchEqualsSequentialSearch)
+{
+  const auto sequentialOptimizer = CreateOptimizer(0, 2);
+  sequentialOptimizer->StartOptimization();
+
+  for (const unsigned int numberOfContexts : { 1u, 3u })
+  {
+    const auto concurrentOptimizer = CreateOptimizer(numberOfContexts, 2);
+    concurrentOptimizer->StartOptimization();
+    Expect_equal_search_results(*concurrentOptimizer, *sequentialOptimizer);
+  }
+}
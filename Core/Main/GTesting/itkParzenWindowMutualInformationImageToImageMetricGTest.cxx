@@ -0,0 +1,158 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+ // First include the header file to be tested:
+#include "AdvancedMattesMutualInformation/itkParzenWindowMutualInformationImageToImageMetric.h"
+
+#include "itkAdvancedBSplineDeformableTransform.h"
+#include "itkBSplineInterpolateImageFunction.h"
+#include "itkExponentialLimiterFunction.h"
+#include "itkHardLimiterFunction.h"
+#include "itkImageFullSampler.h"
+
+#include <itkImage.h>
+#include <itkImageRegionIterator.h>
+
+#include <cmath>
+#include <random>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+  using ImageType = itk::Image<float, 2>;
+  using MetricType = itk::ParzenWindowMutualInformationImageToImageMetric<ImageType, ImageType>;
+  using TransformType = itk::AdvancedBSplineDeformableTransform<double, 2, 3>;
+  using ParametersType = MetricType::ParametersType;
+  using DerivativeType = MetricType::DerivativeType;
+  using MeasureType = MetricType::MeasureType;
+
+
+  // A smooth blob with a ramp, centred at the specified position.
+  ImageType::Pointer CreateImage(const double centreX, const double centreY)
+  {
+    const auto image = ImageType::New();
+    image->SetRegions(itk::Size<2>{ { 24, 20 } });
+    image->Allocate();
+    for (itk::ImageRegionIterator<ImageType> it(image, image->GetBufferedRegion()); !it.IsAtEnd(); ++it)
+    {
+      const auto index = it.GetIndex();
+      const double dx = index[0] - centreX;
+      const double dy = index[1] - centreY;
+      it.Set(static_cast<float>(100.0 * std::exp(-(dx * dx + 2.0 * dy * dy) / 18.0) + 2.0 * index[0]));
+    }
+    return image;
+  }
+
+
+  // A cubic B-spline transform with a grid spacing of 6 pixels, which
+  // supports the whole image, with random coefficients.
+  TransformType::Pointer CreateTransform(ParametersType& parameters)
+  {
+    const auto transform = TransformType::New();
+    TransformType::OriginType gridOrigin;
+    gridOrigin.Fill(-6.0);
+    TransformType::SpacingType gridSpacing;
+    gridSpacing.Fill(6.0);
+    TransformType::DirectionType gridDirection;
+    gridDirection.SetIdentity();
+    TransformType::RegionType gridRegion;
+    gridRegion.SetSize(itk::Size<2>{ { 8, 7 } });
+    transform->SetGridOrigin(gridOrigin);
+    transform->SetGridSpacing(gridSpacing);
+    transform->SetGridDirection(gridDirection);
+    transform->SetGridRegion(gridRegion);
+
+    std::mt19937 randomNumberEngine(1);
+    std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+    parameters.SetSize(transform->GetNumberOfParameters());
+    for (unsigned int i = 0; i < parameters.GetSize(); ++i)
+    {
+      parameters[i] = distribution(randomNumberEngine);
+    }
+    transform->SetParameters(parameters);
+    return transform;
+  }
+
+
+  // Creates a multi-threaded metric that computes the derivative of the
+  // joint histogram in the low memory way, or with sparse pdf derivatives.
+  MetricType::Pointer CreateMetric(TransformType* const transform, const bool useSparsePDFDerivatives)
+  {
+    const auto fixedImage = CreateImage(11.0, 9.0);
+    const auto metric = MetricType::New();
+    metric->SetFixedImage(fixedImage);
+    metric->SetFixedImageRegion(fixedImage->GetBufferedRegion());
+    metric->SetMovingImage(CreateImage(12.5, 8.0));
+    metric->SetTransform(transform);
+    metric->SetInterpolator(itk::BSplineInterpolateImageFunction<ImageType, double, double>::New());
+    metric->SetImageSampler(itk::ImageFullSampler<ImageType>::New());
+    metric->SetFixedImageLimiter(itk::HardLimiterFunction<MetricType::RealType, 2>::New());
+    metric->SetMovingImageLimiter(itk::ExponentialLimiterFunction<MetricType::RealType, 2>::New());
+    metric->SetNumberOfFixedHistogramBins(16);
+    metric->SetNumberOfMovingHistogramBins(16);
+    metric->SetUseDerivative(true);
+    metric->SetUseExplicitPDFDerivatives(false);
+    metric->SetUseSparsePDFDerivatives(useSparsePDFDerivatives);
+    metric->SetUseMultiThread(true);
+    metric->SetNumberOfWorkUnits(4);
+    metric->Initialize();
+    return metric;
+  }
+}
+
+
+// Tests that the sparse pdf derivatives give the same value and derivative
+// as the low memory pdf derivatives, for a B-spline transform.
+GTEST_TEST(ParzenWindowMutualInformationImageToImageMetric, SparsePDFDerivativesEqualLowMemoryDerivatives)
+{
+  ParametersType parameters;
+  const auto transform = CreateTransform(parameters);
+
+  const auto lowMemoryMetric = CreateMetric(transform, false);
+  MeasureType expectedValue = 0.0;
+  DerivativeType expectedDerivative;
+  lowMemoryMetric->GetValueAndDerivative(parameters, expectedValue, expectedDerivative);
+  ASSERT_EQ(expectedDerivative.GetSize(), parameters.GetSize());
+  ASSERT_GT(expectedDerivative.two_norm(), 0.0);
+
+  const auto sparseMetric = CreateMetric(transform, true);
+  MeasureType value = 0.0;
+  DerivativeType derivative;
+  sparseMetric->GetValueAndDerivative(parameters, value, derivative);
+  ASSERT_EQ(derivative.GetSize(), expectedDerivative.GetSize());
+
+  // Only the order of the summations may differ.
+  EXPECT_NEAR(value, expectedValue, 1e-10 * std::abs(expectedValue));
+  const double maxDerivative = expectedDerivative.inf_norm();
+  for (unsigned int i = 0; i < derivative.GetSize(); ++i)
+  {
+    EXPECT_NEAR(derivative[i], expectedDerivative[i], 1e-10 * maxDerivative) << "at parameter " << i;
+  }
+
+  // And at other parameters, evaluated by the same metrics again.
+  parameters *= 0.5;
+  lowMemoryMetric->GetValueAndDerivative(parameters, expectedValue, expectedDerivative);
+  sparseMetric->GetValueAndDerivative(parameters, value, derivative);
+  EXPECT_NEAR(value, expectedValue, 1e-10 * std::abs(expectedValue));
+  for (unsigned int i = 0; i < derivative.GetSize(); ++i)
+  {
+    EXPECT_NEAR(derivative[i], expectedDerivative[i], 1e-10 * expectedDerivative.inf_norm()) << "at parameter " << i;
+  }
+}
@@ -0,0 +1,217 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkBSplineDecompositionImageFilter.h"
+#include "itkMultiOrderBSplineDecompositionImageFilter.h"
+#include "itkUpsampleBSplineParametersFilter.h"
+#include "itkMultiThreaderBase.h"
+
+#include "itkImage.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+
+// Report timings
+#include "itkTimeProbe.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+//-------------------------------------------------------------------------------------
+// This test compares the multi-threaded MultiOrderBSplineDecompositionImageFilter
+// with the BSplineDecompositionImageFilter of ITK, both in terms of results and
+// timings. In addition, the UpsampleBSplineParametersFilter is timed for
+// a single and for the default number of threads.
+
+int
+main( int argc, char * argv[] )
+{
+  /** Some basic type definitions. */
+  const unsigned int Dimension   = 3;
+  const unsigned int SplineOrder = 3;
+  typedef float                                 InputPixelType;
+  typedef double                                CoefficientPixelType;
+  typedef itk::Image< InputPixelType, Dimension >       InputImageType;
+  typedef itk::Image< CoefficientPixelType, Dimension > CoefficientImageType;
+  typedef InputImageType::SizeType                      SizeType;
+  typedef InputImageType::RegionType                    RegionType;
+
+  typedef itk::BSplineDecompositionImageFilter<
+    InputImageType, CoefficientImageType >              ITKDecompositionFilterType;
+  typedef itk::MultiOrderBSplineDecompositionImageFilter<
+    InputImageType, CoefficientImageType >              MultiOrderDecompositionFilterType;
+
+  /** The image size. Distinguish between Debug and Release mode. */
+#ifndef NDEBUG
+  const unsigned int N = 32;
+#else
+  const unsigned int N = 160;
+#endif
+  std::cerr << "Image size = " << N << "^" << Dimension << std::endl;
+
+  /** Create a random input image. */
+  SizeType size; size.Fill( N );
+  RegionType region; region.SetSize( size );
+  InputImageType::Pointer inputImage = InputImageType::New();
+  inputImage->SetRegions( region );
+  inputImage->Allocate();
+
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator RandomGeneratorType;
+  RandomGeneratorType::Pointer randomGenerator = RandomGeneratorType::GetInstance();
+  randomGenerator->Initialize( 121212 );
+  itk::ImageRegionIterator< InputImageType > it( inputImage, region );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+  {
+    it.Set( static_cast< InputPixelType >( randomGenerator->GetUniformVariate( 0.0, 1000.0 ) ) );
+  }
+
+  /** Time the ITK decomposition filter. */
+  ITKDecompositionFilterType::Pointer itkFilter = ITKDecompositionFilterType::New();
+  itkFilter->SetSplineOrder( SplineOrder );
+  itkFilter->SetInput( inputImage );
+  itk::TimeProbe timeProbeITK;
+  timeProbeITK.Start();
+  itkFilter->Update();
+  timeProbeITK.Stop();
+
+  /** Time the multi-order decomposition filter, single-threaded. */
+  MultiOrderDecompositionFilterType::Pointer multiOrderFilter1 = MultiOrderDecompositionFilterType::New();
+  multiOrderFilter1->SetSplineOrder( SplineOrder );
+  multiOrderFilter1->SetNumberOfWorkUnits( 1 );
+  multiOrderFilter1->SetInput( inputImage );
+  itk::TimeProbe timeProbeMO1;
+  timeProbeMO1.Start();
+  multiOrderFilter1->Update();
+  timeProbeMO1.Stop();
+
+  /** Time the multi-order decomposition filter, multi-threaded. */
+  MultiOrderDecompositionFilterType::Pointer multiOrderFilterN = MultiOrderDecompositionFilterType::New();
+  multiOrderFilterN->SetSplineOrder( SplineOrder );
+  multiOrderFilterN->SetInput( inputImage );
+  itk::TimeProbe timeProbeMON;
+  timeProbeMON.Start();
+  multiOrderFilterN->Update();
+  timeProbeMON.Stop();
+
+  /** Compare the results. */
+  itk::ImageRegionConstIterator< CoefficientImageType > itITK( itkFilter->GetOutput(), region );
+  itk::ImageRegionConstIterator< CoefficientImageType > itMO1( multiOrderFilter1->GetOutput(), region );
+  itk::ImageRegionConstIterator< CoefficientImageType > itMON( multiOrderFilterN->GetOutput(), region );
+  double maxDiffITK = 0.0, maxDiffThreads = 0.0;
+  for( ; !itITK.IsAtEnd(); ++itITK, ++itMO1, ++itMON )
+  {
+    maxDiffITK     = std::max( maxDiffITK, std::abs( itITK.Get() - itMON.Get() ) );
+    maxDiffThreads = std::max( maxDiffThreads, std::abs( itMO1.Get() - itMON.Get() ) );
+  }
+
+  /** Report timings. */
+  std::cerr << std::setprecision( 4 );
+  std::cerr << "Number of threads = " << multiOrderFilterN->GetNumberOfWorkUnits() << std::endl;
+  std::cerr << "Time ITK BSplineDecomposition            = "
+            << timeProbeITK.GetMean() << " " << timeProbeITK.GetUnit() << std::endl;
+  std::cerr << "Time MultiOrderBSplineDecomposition (1)  = "
+            << timeProbeMO1.GetMean() << " " << timeProbeMO1.GetUnit() << std::endl;
+  std::cerr << "Time MultiOrderBSplineDecomposition (N)  = "
+            << timeProbeMON.GetMean() << " " << timeProbeMON.GetUnit() << std::endl;
+  std::cerr << "Speedup factor w.r.t. ITK = "
+            << timeProbeITK.GetMean() / timeProbeMON.GetMean() << std::endl;
+  std::cerr << "Max difference w.r.t. ITK = " << maxDiffITK << std::endl;
+  std::cerr << "Max difference 1 vs N threads = " << maxDiffThreads << std::endl;
+
+  /** The threaded result should be identical to the single-threaded result,
+   * and very close to the result of ITK.
+   */
+  if( maxDiffThreads != 0.0 )
+  {
+    std::cerr << "ERROR: the multi-threaded result differs from the single-threaded result." << std::endl;
+    return 1;
+  }
+  if( maxDiffITK > 1e-4 )
+  {
+    std::cerr << "ERROR: the result differs from the ITK BSplineDecompositionImageFilter." << std::endl;
+    return 1;
+  }
+
+  /** Time the upsampling of B-spline parameters from a coarse to a fine grid. */
+  typedef itk::Array< double >                     ParametersType;
+  typedef itk::Image< double, Dimension >          GridImageType;
+  typedef itk::UpsampleBSplineParametersFilter<
+    ParametersType, GridImageType >                UpsampleFilterType;
+
+  SizeType coarseSize; coarseSize.Fill( N / 4 );
+  SizeType fineSize; fineSize.Fill( N / 2 - 2 );
+  RegionType coarseRegion; coarseRegion.SetSize( coarseSize );
+  RegionType fineRegion; fineRegion.SetSize( fineSize );
+  GridImageType::SpacingType coarseSpacing; coarseSpacing.Fill( 2.0 );
+  GridImageType::SpacingType fineSpacing; fineSpacing.Fill( 1.0 );
+  GridImageType::PointType coarseOrigin; coarseOrigin.Fill( 0.0 );
+  GridImageType::PointType fineOrigin; fineOrigin.Fill( 1.0 );
+  GridImageType::DirectionType direction; direction.SetIdentity();
+
+  ParametersType coarseParameters( coarseRegion.GetNumberOfPixels() * Dimension );
+  for( unsigned int i = 0; i < coarseParameters.GetSize(); ++i )
+  {
+    coarseParameters[ i ] = randomGenerator->GetUniformVariate( -1.0, 1.0 );
+  }
+
+  ParametersType fineParameters[ 2 ];
+  itk::TimeProbe timeProbeUpsample[ 2 ];
+  const itk::ThreadIdType numberOfWorkUnits[ 2 ] = {
+    1, itk::MultiThreaderBase::GetGlobalDefaultNumberOfThreads() };
+  for( unsigned int k = 0; k < 2; ++k )
+  {
+    UpsampleFilterType::Pointer upsampler = UpsampleFilterType::New();
+    upsampler->SetCurrentGridOrigin( coarseOrigin );
+    upsampler->SetCurrentGridSpacing( coarseSpacing );
+    upsampler->SetCurrentGridDirection( direction );
+    upsampler->SetCurrentGridRegion( coarseRegion );
+    upsampler->SetRequiredGridOrigin( fineOrigin );
+    upsampler->SetRequiredGridSpacing( fineSpacing );
+    upsampler->SetRequiredGridDirection( direction );
+    upsampler->SetRequiredGridRegion( fineRegion );
+    upsampler->SetBSplineOrder( SplineOrder );
+    upsampler->SetNumberOfWorkUnits( numberOfWorkUnits[ k ] );
+
+    timeProbeUpsample[ k ].Start();
+    upsampler->UpsampleParameters( coarseParameters, fineParameters[ k ] );
+    timeProbeUpsample[ k ].Stop();
+  }
+
+  double maxDiffUpsample = 0.0;
+  for( unsigned int i = 0; i < fineParameters[ 0 ].GetSize(); ++i )
+  {
+    maxDiffUpsample = std::max( maxDiffUpsample,
+      std::abs( fineParameters[ 0 ][ i ] - fineParameters[ 1 ][ i ] ) );
+  }
+
+  std::cerr << "Time UpsampleBSplineParameters (1)  = "
+            << timeProbeUpsample[ 0 ].GetMean() << " " << timeProbeUpsample[ 0 ].GetUnit() << std::endl;
+  std::cerr << "Time UpsampleBSplineParameters (" << numberOfWorkUnits[ 1 ] << ")  = "
+            << timeProbeUpsample[ 1 ].GetMean() << " " << timeProbeUpsample[ 1 ].GetUnit() << std::endl;
+  std::cerr << "Max difference 1 vs N threads = " << maxDiffUpsample << std::endl;
+
+  if( maxDiffUpsample > 1e-10 )
+  {
+    std::cerr << "ERROR: the multi-threaded upsampling differs from the single-threaded one." << std::endl;
+    return 1;
+  }
+
+  /** Return a value. */
+  return 0;
+
+} // end main
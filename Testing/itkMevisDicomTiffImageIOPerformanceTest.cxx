@@ -0,0 +1,216 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkUseMevisDicomTiff.h"
+
+#include "itkImage.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkMultiThreaderBase.h"
+
+// Report timings
+#include "itkTimeProbe.h"
+
+#include <iomanip>
+#include <string>
+
+//-------------------------------------------------------------------------------------
+// This test measures the read throughput of the itkMevisDicomTiffImageIO library.
+// A 3D short image is written using streaming, and read back using a single and
+// the default number of threads. In addition, a requested region is read using
+// streaming, which only decodes the tiles that intersect the region. All results
+// are compared to the original image.
+
+namespace
+{
+
+typedef short                             PixelType;
+typedef itk::Image< PixelType, 3 >        ImageType;
+typedef itk::ImageFileReader< ImageType > ReaderType;
+
+/** Compare the region of the image with the same region of the original. */
+bool
+RegionIsEqual( const ImageType * original, const ImageType * image, const ImageType::RegionType & region )
+{
+  itk::ImageRegionConstIterator< ImageType > itOriginal( original, region );
+  itk::ImageRegionConstIterator< ImageType > it( image, region );
+  for( ; !it.IsAtEnd(); ++it, ++itOriginal )
+  {
+    if( it.Get() != itOriginal.Get() )
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // end namespace
+
+
+int
+main( int argc, char * argv[] )
+{
+  /** Support Mevis Dicom Tiff (if selected in cmake) */
+  RegisterMevisDicomTiff();
+
+#ifdef _ELASTIX_USE_MEVISDICOMTIFF
+
+  typedef itk::ImageFileWriter< ImageType > WriterType;
+
+  /** The image size. Distinguish between Debug and Release mode.
+   * The sizes are no multiple of the tile size (128), to include
+   * the boundary tiles.
+   */
+#ifndef NDEBUG
+  const unsigned int N = 100;
+#else
+  const unsigned int N = 300;
+#endif
+  ImageType::SizeType size;
+  size[ 0 ] = N; size[ 1 ] = N + 20; size[ 2 ] = N / 2;
+  std::cerr << "Image size = " << size << std::endl;
+
+  ImageType::Pointer inputImage = ImageType::New();
+  inputImage->SetRegions( size );
+  inputImage->Allocate();
+
+  /** Fill with a pattern that is not constant within a tile. */
+  itk::ImageRegionIterator< ImageType > it( inputImage, inputImage->GetLargestPossibleRegion() );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+  {
+    const ImageType::IndexType index = it.GetIndex();
+    it.Set( static_cast< PixelType >( ( index[ 0 ] * 7 + index[ 1 ] * 13 + index[ 2 ] * 31 ) % 4000 - 1000 ) );
+  }
+
+  /** Write the image using streaming. */
+  const std::string testfile( "testimageMevisDicomTiffPerformance.tif" );
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetFileName( testfile );
+  writer->SetInput( inputImage );
+  writer->SetNumberOfStreamDivisions( 4 );
+  itk::TimeProbe timeProbeWrite;
+  try
+  {
+    timeProbeWrite.Start();
+    writer->Update();
+    timeProbeWrite.Stop();
+  }
+  catch( itk::ExceptionObject & err )
+  {
+    std::cerr << "ERROR: Writing mevis dicomtiff failed." << std::endl;
+    std::cerr << err << std::endl;
+    return 1;
+  }
+
+  /** Read the complete image with a single and the default number of threads. */
+  const itk::ThreadIdType defaultNumberOfThreads = itk::MultiThreaderBase::GetGlobalDefaultNumberOfThreads();
+  const itk::ThreadIdType numberOfThreads[ 2 ]   = { 1, defaultNumberOfThreads };
+  itk::TimeProbe timeProbeRead[ 2 ];
+  for( unsigned int k = 0; k < 2; ++k )
+  {
+    itk::MultiThreaderBase::SetGlobalDefaultNumberOfThreads( numberOfThreads[ k ] );
+    ReaderType::Pointer reader = ReaderType::New();
+    reader->SetFileName( testfile );
+    try
+    {
+      timeProbeRead[ k ].Start();
+      reader->Update();
+      timeProbeRead[ k ].Stop();
+    }
+    catch( itk::ExceptionObject & err )
+    {
+      std::cerr << "ERROR: Reading mevis dicomtiff failed." << std::endl;
+      std::cerr << err << std::endl;
+      return 1;
+    }
+
+    if( !RegionIsEqual( inputImage, reader->GetOutput(), inputImage->GetLargestPossibleRegion() ) )
+    {
+      std::cerr << "ERROR: the pixel values are not correct after write/read" << std::endl;
+      return 1;
+    }
+  }
+  itk::MultiThreaderBase::SetGlobalDefaultNumberOfThreads( defaultNumberOfThreads );
+
+  /** Read a region that does not start or end at tile boundaries. */
+  ImageType::RegionType requestedRegion;
+  requestedRegion.SetIndex( 0, N / 3 );
+  requestedRegion.SetIndex( 1, N / 5 );
+  requestedRegion.SetIndex( 2, N / 7 );
+  requestedRegion.SetSize( 0, N / 2 );
+  requestedRegion.SetSize( 1, N / 2 );
+  requestedRegion.SetSize( 2, N / 10 );
+
+  ReaderType::Pointer regionReader = ReaderType::New();
+  regionReader->SetFileName( testfile );
+  itk::TimeProbe timeProbeRegion;
+  try
+  {
+    regionReader->UpdateOutputInformation();
+    regionReader->GetOutput()->SetRequestedRegion( requestedRegion );
+    timeProbeRegion.Start();
+    regionReader->Update();
+    timeProbeRegion.Stop();
+  }
+  catch( itk::ExceptionObject & err )
+  {
+    std::cerr << "ERROR: Streamed reading of mevis dicomtiff failed." << std::endl;
+    std::cerr << err << std::endl;
+    return 1;
+  }
+
+  if( regionReader->GetOutput()->GetBufferedRegion() != requestedRegion )
+  {
+    std::cerr << "ERROR: only the requested region should have been read, but got "
+              << regionReader->GetOutput()->GetBufferedRegion() << std::endl;
+    return 1;
+  }
+  if( !RegionIsEqual( inputImage, regionReader->GetOutput(), requestedRegion ) )
+  {
+    std::cerr << "ERROR: the pixel values of the requested region are not correct" << std::endl;
+    return 1;
+  }
+
+  /** Report timings. */
+  const double megaBytes = inputImage->GetLargestPossibleRegion().GetNumberOfPixels()
+    * sizeof( PixelType ) / ( 1024.0 * 1024.0 );
+  std::cerr << std::setprecision( 4 );
+  std::cerr << "Time write (streamed)           = "
+            << timeProbeWrite.GetMean() << " " << timeProbeWrite.GetUnit() << std::endl;
+  std::cerr << "Read throughput (1 thread)      = "
+            << megaBytes / timeProbeRead[ 0 ].GetMean() << " MB/s" << std::endl;
+  std::cerr << "Read throughput (" << numberOfThreads[ 1 ] << " threads)     = "
+            << megaBytes / timeProbeRead[ 1 ].GetMean() << " MB/s" << std::endl;
+  std::cerr << "Speedup factor = "
+            << timeProbeRead[ 0 ].GetMean() / timeProbeRead[ 1 ].GetMean() << std::endl;
+  std::cerr << "Time read requested region      = "
+            << timeProbeRegion.GetMean() << " " << timeProbeRegion.GetUnit() << std::endl;
+
+  /** Return a value. */
+  return 0;
+
+#else
+
+  std::cerr << "Elastix was not built with Mevis DicomTiff support, so this test is not relevant." << std::endl;
+  return 0;
+
+#endif
+
+} // end main
@@ -0,0 +1,231 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkParzenWindowHistogramImageToImageMetric.h"
+#include "itkMultiThreaderBase.h"
+
+#include "itkImage.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+
+// Report timings
+#include "itkTimeProbe.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <vector>
+
+//-------------------------------------------------------------------------------------
+// This test measures the number of samples per second per thread that are added
+// to the Parzen window joint histogram, using the generic UpdateJointPDFAndDerivatives()
+// and the kernel order specific UpdateJointPDFBuffer(), for the common
+// combinations of fixed and moving kernel B-spline orders. It also checks that
+// both give the same joint histogram.
+
+namespace itk
+{
+
+/** A minimal metric that exposes the joint histogram updates. */
+template< class TImage >
+class ParzenWindowHistogramBenchmarkMetric :
+  public ParzenWindowHistogramImageToImageMetric< TImage, TImage >
+{
+public:
+
+  typedef ParzenWindowHistogramBenchmarkMetric                      Self;
+  typedef ParzenWindowHistogramImageToImageMetric< TImage, TImage > Superclass;
+  typedef SmartPointer< Self >                                      Pointer;
+
+  itkNewMacro( Self );
+  itkTypeMacro( ParzenWindowHistogramBenchmarkMetric, ParzenWindowHistogramImageToImageMetric );
+
+  typedef typename Superclass::MeasureType    MeasureType;
+  typedef typename Superclass::ParametersType ParametersType;
+  typedef typename Superclass::PDFValueType   PDFValueType;
+  typedef typename Superclass::JointPDFType   JointPDFType;
+
+  MeasureType GetValue( const ParametersType & ) const override { return 0.0; }
+
+  /** Set up the histograms and kernels for values in [minimum, maximum]. */
+  void InitializeHistogramsAndKernels( const double minimum, const double maximum )
+  {
+    this->m_FixedImageMinLimit  = minimum;
+    this->m_FixedImageMaxLimit  = maximum;
+    this->m_MovingImageMinLimit = minimum;
+    this->m_MovingImageMaxLimit = maximum;
+    this->InitializeHistograms();
+    this->InitializeKernels();
+  }
+
+
+  /** Add value pairs to a joint pdf image, using UpdateJointPDFAndDerivatives(). */
+  void UpdateJointPDFGeneric( const double * fixedValues, const double * movingValues,
+    const SizeValueType numberOfValues, JointPDFType * jointPDF ) const
+  {
+    for( SizeValueType i = 0; i < numberOfValues; ++i )
+    {
+      this->UpdateJointPDFAndDerivatives( fixedValues[ i ], movingValues[ i ], nullptr, nullptr, jointPDF );
+    }
+  }
+
+
+  /** Add value pairs to a joint pdf buffer, using UpdateJointPDFBuffer(). */
+  void UpdateJointPDFBuffer( const double * fixedValues, const double * movingValues,
+    const SizeValueType numberOfValues, PDFValueType * jointPDF ) const
+  {
+    const typename Superclass::UpdateJointPDFBufferFunctionType updateJointPDF
+      = this->GetUpdateJointPDFBufferFunction();
+    for( SizeValueType i = 0; i < numberOfValues; ++i )
+    {
+      ( this->*updateJointPDF )( fixedValues[ i ], movingValues[ i ], jointPDF );
+    }
+  }
+
+
+  /** Create a zero joint pdf image of the right size. */
+  typename JointPDFType::Pointer CreateJointPDF( void ) const
+  {
+    typename JointPDFType::Pointer jointPDF = JointPDFType::New();
+    jointPDF->CopyInformation( this->m_JointPDF );
+    jointPDF->SetRegions( this->m_JointPDF->GetLargestPossibleRegion() );
+    jointPDF->Allocate();
+    jointPDF->FillBuffer( 0.0 );
+    return jointPDF;
+  }
+
+
+protected:
+
+  ParzenWindowHistogramBenchmarkMetric() {}
+  ~ParzenWindowHistogramBenchmarkMetric() override {}
+
+};
+
+} // end namespace itk
+
+
+int
+main( int argc, char * argv[] )
+{
+  typedef itk::Image< float, 3 >                                 ImageType;
+  typedef itk::ParzenWindowHistogramBenchmarkMetric< ImageType > MetricType;
+  typedef MetricType::PDFValueType                               PDFValueType;
+  typedef MetricType::JointPDFType                               JointPDFType;
+
+  /** The number of samples. Distinguish between Debug and Release mode. */
+#ifndef NDEBUG
+  const unsigned int numberOfSamplesPerThread = 20000;
+#else
+  const unsigned int numberOfSamplesPerThread = 2000000;
+#endif
+  const itk::ThreadIdType numberOfThreads
+    = itk::MultiThreaderBase::GetGlobalDefaultNumberOfThreads();
+  const unsigned int numberOfSamples = numberOfSamplesPerThread * numberOfThreads;
+  std::cerr << "Number of samples per thread = " << numberOfSamplesPerThread << std::endl;
+  std::cerr << "Number of threads = " << numberOfThreads << std::endl;
+
+  /** Create random value pairs. */
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator RandomGeneratorType;
+  RandomGeneratorType::Pointer randomGenerator = RandomGeneratorType::GetInstance();
+  randomGenerator->Initialize( 121212 );
+  std::vector< double > fixedValues( numberOfSamples );
+  std::vector< double > movingValues( numberOfSamples );
+  for( unsigned int i = 0; i < numberOfSamples; ++i )
+  {
+    fixedValues[ i ]  = randomGenerator->GetUniformVariate( 0.0, 1000.0 );
+    movingValues[ i ] = 0.5 * fixedValues[ i ] + randomGenerator->GetUniformVariate( 0.0, 500.0 );
+  }
+
+  std::cerr << std::setprecision( 4 );
+  const unsigned int kernelOrders[ 3 ][ 2 ] = { { 0, 3 }, { 1, 3 }, { 3, 3 } };
+  for( unsigned int k = 0; k < 3; ++k )
+  {
+    MetricType::Pointer metric = MetricType::New();
+    metric->SetFixedKernelBSplineOrder( kernelOrders[ k ][ 0 ] );
+    metric->SetMovingKernelBSplineOrder( kernelOrders[ k ][ 1 ] );
+    metric->InitializeHistogramsAndKernels( 0.0, 1000.0 );
+
+    /** Time the generic update, single-threaded. */
+    JointPDFType::Pointer genericJointPDF = metric->CreateJointPDF();
+    itk::TimeProbe        timeProbeGeneric;
+    timeProbeGeneric.Start();
+    metric->UpdateJointPDFGeneric( fixedValues.data(), movingValues.data(),
+      numberOfSamplesPerThread, genericJointPDF );
+    timeProbeGeneric.Stop();
+
+    /** Time the kernel order specific update, single-threaded. */
+    const std::size_t           numberOfBins = genericJointPDF->GetBufferedRegion().GetNumberOfPixels();
+    std::vector< PDFValueType > bufferJointPDF( numberOfBins, 0.0 );
+    itk::TimeProbe              timeProbeBuffer;
+    timeProbeBuffer.Start();
+    metric->UpdateJointPDFBuffer( fixedValues.data(), movingValues.data(),
+      numberOfSamplesPerThread, bufferJointPDF.data() );
+    timeProbeBuffer.Stop();
+
+    /** Time the kernel order specific update, with a joint pdf per thread. */
+    std::vector< std::vector< PDFValueType > > threadJointPDFs( numberOfThreads,
+      std::vector< PDFValueType >( numberOfBins, 0.0 ) );
+    itk::MultiThreaderBase::Pointer threader = itk::MultiThreaderBase::New();
+    threader->SetNumberOfWorkUnits( numberOfThreads );
+    itk::TimeProbe timeProbeThreads;
+    timeProbeThreads.Start();
+    threader->ParallelizeArray( 0, numberOfThreads,
+      [ &metric, &fixedValues, &movingValues, &threadJointPDFs, numberOfSamplesPerThread ]( itk::SizeValueType t )
+      {
+        const std::size_t begin = t * numberOfSamplesPerThread;
+        metric->UpdateJointPDFBuffer( fixedValues.data() + begin, movingValues.data() + begin,
+          numberOfSamplesPerThread, threadJointPDFs[ t ].data() );
+      },
+      nullptr );
+    timeProbeThreads.Stop();
+
+    /** Compare the joint histograms of the first samples. */
+    double maxDifference = 0.0;
+    double maxValue      = 0.0;
+    for( std::size_t i = 0; i < numberOfBins; ++i )
+    {
+      const double genericValue = genericJointPDF->GetBufferPointer()[ i ];
+      maxValue      = std::max( maxValue, std::abs( genericValue ) );
+      maxDifference = std::max( maxDifference, std::abs( genericValue - bufferJointPDF[ i ] ) );
+      maxDifference = std::max( maxDifference, std::abs( genericValue - threadJointPDFs[ 0 ][ i ] ) );
+    }
+
+    /** Report samples per second per thread. */
+    const double samplesPerThread = static_cast< double >( numberOfSamplesPerThread );
+    std::cerr << "Fixed / moving kernel order = "
+              << kernelOrders[ k ][ 0 ] << " / " << kernelOrders[ k ][ 1 ] << std::endl;
+    std::cerr << "  Generic update (1 thread)  = "
+              << samplesPerThread / timeProbeGeneric.GetMean() << " samples/s/thread" << std::endl;
+    std::cerr << "  Buffer update (1 thread)   = "
+              << samplesPerThread / timeProbeBuffer.GetMean() << " samples/s/thread" << std::endl;
+    std::cerr << "  Buffer update (" << numberOfThreads << " threads)  = "
+              << samplesPerThread / timeProbeThreads.GetMean() << " samples/s/thread" << std::endl;
+    std::cerr << "  Speedup factor = "
+              << timeProbeGeneric.GetMean() / timeProbeBuffer.GetMean() << std::endl;
+    std::cerr << "  Max difference = " << maxDifference << std::endl;
+
+    if( maxDifference > 1e-12 * maxValue )
+    {
+      std::cerr << "ERROR: the buffer update differs from the generic update." << std::endl;
+      return 1;
+    }
+  }
+
+  /** Return a value. */
+  return 0;
+
+} // end main
@@ -22,6 +22,8 @@
 #include "itkTimeProbe.h"
 #include "itkTimeProbesCollectorBase.h"
 
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <iomanip>
 
@@ -72,7 +74,33 @@ public:
   }
 
 
+  /** Return the full L matrix. For the TPS only the reduced matrix is
+   * stored, see KernelTransform2::ComputeL(), so expand it here.
+   */
   LMatrixType GetLMatrix( void ) const
+  {
+    if( !this->m_FastComputationPossible )
+    {
+      return this->m_LMatrix;
+    }
+
+    const unsigned int size = this->m_LMatrix.rows();
+    LMatrixType        lMatrix( size * NDimensions, size * NDimensions, 0.0 );
+    for( unsigned int i = 0; i < size; ++i )
+    {
+      for( unsigned int j = 0; j < size; ++j )
+      {
+        for( unsigned int dim = 0; dim < NDimensions; ++dim )
+        {
+          lMatrix( i * NDimensions + dim, j * NDimensions + dim ) = this->m_LMatrix( i, j );
+        }
+      }
+    }
+    return lMatrix;
+  }
+
+
+  LMatrixType GetReducedLMatrix( void ) const
   {
     return this->m_LMatrix;
   }
@@ -102,6 +130,7 @@ main( int argc, char * argv[] )
   // ScalarType double needed for Cholesky. Double is used in elastix.
   typedef double ScalarType;
   const unsigned long maxTestedLandmarksForSVD = 401;
+  const unsigned long maxTestedLandmarksForFarField = 1000;
   const ScalarType    tolerance                = 1e-8; // for double
 
   /** Check. */
@@ -199,8 +228,8 @@ main( int argc, char * argv[] )
     timeCollector.Start( "ComputeL" );
     kernelTransform->SetSourceLandmarksPublic( usedLandmarks );
     kernelTransform->ComputeLPublic();
-    LMatrixType lMatrix = kernelTransform->GetLMatrix();
     timeCollector.Stop( "ComputeL" );
+    LMatrixType lMatrix = kernelTransform->GetLMatrix();
 
     /** Task 2: Compute L inverse. */
     if( numberOfLandmarks < maxTestedLandmarksForSVD )
@@ -220,6 +249,12 @@ main( int argc, char * argv[] )
     lMatrixInverse2 = vnl_qr< ScalarType >( lMatrix ).inverse();
     timeCollector.Stop( "ComputeLInverseByQR" );
 
+    // The reduced system, as used by the transform
+    timeCollector.Start( "ComputeReducedLInverseByQR" );
+    LMatrixType reducedLMatrixInverse
+      = vnl_qr< ScalarType >( kernelTransform->GetReducedLMatrix() ).inverse();
+    timeCollector.Stop( "ComputeReducedLInverseByQR" );
+
     // Method 3: Cholesky decomposition
     // Cholesky decomposition does not work due to lMatrix not being positive definite.
     //   startClock = clock();
@@ -281,6 +316,30 @@ main( int argc, char * argv[] )
       std::cerr << "Frobenius difference of method 2,4 with SVD: unknown" << std::endl;
     }
 
+    /** Compare the inverse of the reduced system with that of the full system. */
+    double diff_reduced = 0.0;
+    for( unsigned int r = 0; r < reducedLMatrixInverse.rows(); r++ )
+    {
+      for( unsigned int c = 0; c < reducedLMatrixInverse.cols(); c++ )
+      {
+        for( unsigned int dim = 0; dim < Dimension; dim++ )
+        {
+          const double diff = reducedLMatrixInverse( r, c )
+            - lMatrixInverse2( r * Dimension + dim, c * Dimension + dim );
+          diff_reduced += diff * diff;
+        }
+      }
+    }
+    diff_reduced = std::sqrt( diff_reduced );
+    std::cerr << "Frobenius difference of the reduced system with method 2: "
+              << diff_reduced << std::endl;
+    if( diff_reduced > tolerance )
+    {
+      std::cerr << "ERROR: Frobenius difference of the reduced system too big: "
+                << diff_reduced << std::endl;
+      return 1;
+    }
+
     //   startClock = clock();
     //   LMatrixType lMatrixInverse3 = vnl_lu<ScalarType>( kernelTransform->GetLMatrix() ).inverse();
     //   std::cerr << "L matrix inversion (method 2, lu ) took: "
@@ -369,6 +428,126 @@ main( int argc, char * argv[] )
 
   } // end loop
 
+  //
+  // Test TransformPoint performance, exact and with the far-field approximation
+
+  const unsigned long numberOfLandmarks
+    = std::min( maxTestedLandmarksForFarField, sourceLandmarks->GetNumberOfPoints() );
+  std::cerr << "----------------------------------------
+";
+  std::cerr << "TransformPoint with " << numberOfLandmarks << " landmarks" << std::endl;
+
+  /** Get subset, and a smooth displacement of it. */
+  PointsContainerPointer usedLandmarkPoints = PointsContainerType::New();
+  PointSetType::Pointer  usedLandmarks      = PointSetType::New();
+  TransformType::ParametersType targetParameters( numberOfLandmarks * Dimension );
+  PointType minimum = ( *sourceLandmarks->GetPoints() )[ 0 ];
+  PointType maximum = minimum;
+  for( unsigned long j = 0; j < numberOfLandmarks; j++ )
+  {
+    PointType tmp = ( *sourceLandmarks->GetPoints() )[ j ];
+    usedLandmarkPoints->push_back( tmp );
+    for( unsigned int dim = 0; dim < Dimension; dim++ )
+    {
+      minimum[ dim ] = std::min( minimum[ dim ], tmp[ dim ] );
+      maximum[ dim ] = std::max( maximum[ dim ], tmp[ dim ] );
+      targetParameters[ j * Dimension + dim ]
+        = tmp[ dim ] + 2.0 * std::sin( tmp[ ( dim + 1 ) % Dimension ] / 30.0 );
+    }
+  }
+  usedLandmarks->SetPoints( usedLandmarkPoints );
+
+  itk::TimeProbesCollectorBase timeCollector;
+  TransformType::Pointer       tpsTransform = TransformType::New();
+  tpsTransform->SetStiffness( 0.0 );
+  tpsTransform->SetMatrixInversionMethod( "QR" );
+  timeCollector.Start( "ComputeWMatrix" );
+  tpsTransform->SetSourceLandmarks( usedLandmarks );
+  tpsTransform->SetParameters( targetParameters );
+  timeCollector.Stop( "ComputeWMatrix" );
+
+  /** The points on a grid over the bounding box of the landmarks. */
+  const unsigned int       pointsPerDimension = 30;
+  std::vector< PointType > points;
+  for( unsigned int k = 0; k < pointsPerDimension; k++ )
+  {
+    for( unsigned int j = 0; j < pointsPerDimension; j++ )
+    {
+      for( unsigned int i = 0; i < pointsPerDimension; i++ )
+      {
+        const unsigned int index[ 3 ] = { i, j, k };
+        PointType          p;
+        for( unsigned int dim = 0; dim < Dimension; dim++ )
+        {
+          p[ dim ] = minimum[ dim ] + ( maximum[ dim ] - minimum[ dim ] )
+            * index[ dim ] / ( pointsPerDimension - 1.0 );
+        }
+        points.push_back( p );
+      }
+    }
+  }
+
+  std::vector< PointType > exactPoints( points.size() );
+  timeCollector.Start( "TransformPointExact" );
+  for( std::size_t i = 0; i < points.size(); ++i )
+  {
+    exactPoints[ i ] = tpsTransform->TransformPoint( points[ i ] );
+  }
+  timeCollector.Stop( "TransformPointExact" );
+
+  /** Check the exact result at the landmarks. */
+  double maximumLandmarkError = 0.0;
+  for( unsigned long j = 0; j < numberOfLandmarks; j++ )
+  {
+    const PointType q = tpsTransform->TransformPoint( usedLandmarkPoints->ElementAt( j ) );
+    for( unsigned int dim = 0; dim < Dimension; dim++ )
+    {
+      maximumLandmarkError = std::max( maximumLandmarkError,
+        std::abs( q[ dim ] - targetParameters[ j * Dimension + dim ] ) );
+    }
+  }
+  std::cerr << "Maximum error at the landmarks: " << maximumLandmarkError << std::endl;
+  if( maximumLandmarkError > 1e-6 )
+  {
+    std::cerr << "ERROR: the TPS does not interpolate the landmarks." << std::endl;
+    return 1;
+  }
+
+  const double farFieldTolerances[ 3 ] = { 0.01, 0.1, 1.0 };
+  for( unsigned int t = 0; t < 3; ++t )
+  {
+    tpsTransform->SetFarFieldTolerance( farFieldTolerances[ t ] );
+
+    std::ostringstream probeName( "" );
+    probeName << "TransformPointFarField" << farFieldTolerances[ t ];
+    std::vector< PointType > farFieldPoints( points.size() );
+    timeCollector.Start( probeName.str().c_str() );
+    for( std::size_t i = 0; i < points.size(); ++i )
+    {
+      farFieldPoints[ i ] = tpsTransform->TransformPoint( points[ i ] );
+    }
+    timeCollector.Stop( probeName.str().c_str() );
+
+    double maximumError = 0.0;
+    for( std::size_t i = 0; i < points.size(); ++i )
+    {
+      for( unsigned int dim = 0; dim < Dimension; dim++ )
+      {
+        maximumError = std::max( maximumError,
+          std::abs( farFieldPoints[ i ][ dim ] - exactPoints[ i ][ dim ] ) );
+      }
+    }
+    std::cerr << "Far-field tolerance " << farFieldTolerances[ t ]
+              << ", maximum error: " << maximumError << std::endl;
+    if( maximumError > farFieldTolerances[ t ] )
+    {
+      std::cerr << "ERROR: far-field error exceeds the tolerance." << std::endl;
+      return 1;
+    }
+  }
+
+  timeCollector.Report();
+
   /** Return a value. */
   return 0;
 